@@ -0,0 +1,157 @@
+#ifndef BENCH_DATA_SHAPE_H
+#define BENCH_DATA_SHAPE_H
+
+#include <benchmark/benchmark.h>
+#include <vkdb/time_series_key.h>
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Directory that benchmarks write their LSM trees to.
+ *
+ */
+static const std::filesystem::path BENCH_DIRECTORY{"bench_lsm_tree"};
+
+/**
+ * @brief Seed of every generated data set, so that runs are reproducible.
+ *
+ */
+static constexpr uint64_t BENCH_SEED{42};
+
+/**
+ * @brief Max distance, in entries, that an out-of-order entry is moved back.
+ *
+ */
+static constexpr uint64_t BENCH_MAX_LATENESS{64};
+
+/**
+ * @brief Metric of every generated key.
+ *
+ */
+static const Metric BENCH_METRIC{"cpu"};
+
+/**
+ * @brief Tag key of the series of every generated key.
+ *
+ */
+static const TagKey BENCH_TAG_KEY{"host"};
+
+/**
+ * @brief Shape of a generated data set.
+ *
+ */
+struct DataShape {
+  /**
+   * @brief Number of series the entries are spread over.
+   *
+   */
+  uint64_t series{1};
+
+  /**
+   * @brief Percentage of entries that arrive out of order.
+   *
+   */
+  uint64_t out_of_order{0};
+};
+
+/**
+ * @brief Get the data shape of a benchmark, from its first two arguments.
+ *
+ * @param state Benchmark state.
+ * @return DataShape Series cardinality and out-of-order percentage.
+ */
+[[nodiscard]] inline DataShape dataShape(const benchmark::State& state) {
+  return {
+    static_cast<uint64_t>(state.range(0)),
+    static_cast<uint64_t>(state.range(1))
+  };
+}
+
+/**
+ * @brief Register the data shapes of a benchmark, as its first two
+ * arguments.
+ * @details Covers one, a hundred and ten thousand series, each in order and
+ * with a tenth of the entries out of order.
+ *
+ * @param benchmark Benchmark.
+ */
+inline void dataShapes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"series", "ooo%"});
+  benchmark->ArgsProduct({{1, 100, 10'000}, {0, 10}});
+}
+
+/**
+ * @brief Get the key of a series at a timestamp.
+ *
+ * @param series Series index.
+ * @param timestamp Timestamp.
+ * @return TimeSeriesKey Key.
+ */
+[[nodiscard]] inline TimeSeriesKey benchKey(
+  uint64_t series,
+  Timestamp timestamp
+) {
+  return TimeSeriesKey{
+    timestamp,
+    BENCH_METRIC,
+    {{BENCH_TAG_KEY, "host_" + std::to_string(series)}}
+  };
+}
+
+/**
+ * @brief Generate the keys of a data set, in arrival order.
+ * @details Entries are dealt between the series in turn, one timestamp per
+ * round, so timestamps are increasing in arrival order. Each entry is then
+ * moved back by up to BENCH_MAX_LATENESS entries with a probability of the
+ * out-of-order percentage. Keys are unique, and the same for the same
+ * arguments.
+ *
+ * @param count Number of keys.
+ * @param shape Data shape.
+ * @param start First timestamp.
+ * @return std::vector<TimeSeriesKey> Keys.
+ */
+[[nodiscard]] inline std::vector<TimeSeriesKey> makeKeys(
+  uint64_t count,
+  DataShape shape,
+  Timestamp start = 0
+) {
+  std::vector<uint64_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 gen{BENCH_SEED};
+  std::uniform_int_distribution<uint64_t> percent{0, 99};
+  std::uniform_int_distribution<uint64_t> lateness{1, BENCH_MAX_LATENESS};
+  for (uint64_t i{1}; i < count; ++i) {
+    if (percent(gen) < shape.out_of_order) {
+      const auto back{std::min(i, lateness(gen))};
+      std::rotate(
+        order.begin() + (i - back),
+        order.begin() + i,
+        order.begin() + i + 1
+      );
+    }
+  }
+  std::vector<TimeSeriesKey> keys;
+  keys.reserve(count);
+  for (const auto i : order) {
+    keys.push_back(benchKey(i % shape.series, start + i / shape.series));
+  }
+  return keys;
+}
+
+/**
+ * @brief Remove the benchmark directory.
+ *
+ */
+inline void removeBenchDirectory() {
+  std::filesystem::remove_all(BENCH_DIRECTORY);
+}
+}  // namespace vkdb
+
+#endif // BENCH_DATA_SHAPE_H
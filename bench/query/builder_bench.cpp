@@ -0,0 +1,67 @@
+#include "data_shape.h"
+#include <vkdb/builder.h>
+
+using namespace vkdb;
+
+static constexpr uint64_t AGGREGATE_ENTRY_COUNT{100'000};
+
+/**
+ * @brief Run an aggregate over every entry of an LSM tree, or over those of
+ * its first series.
+ *
+ * @tparam TAggregate Aggregate type.
+ * @param aggregate Aggregate, which takes a query builder.
+ * @param by_tag Whether to only aggregate the first series.
+ */
+template <typename TAggregate>
+static void BM_QueryBuilderAggregate(
+  benchmark::State& state,
+  TAggregate aggregate,
+  bool by_tag
+) {
+  removeBenchDirectory();
+  const auto shape{dataShape(state)};
+  LSMTreeOptions options;
+  options.sync_sstables = false;
+  LSMTree<double> lsm_tree{BENCH_DIRECTORY, options};
+  const auto keys{makeKeys(AGGREGATE_ENTRY_COUNT, shape)};
+  for (uint64_t i{0}; i < keys.size(); ++i) {
+    lsm_tree.put(keys[i], static_cast<double>(i), false);
+  }
+  const TagColumns tag_columns{BENCH_TAG_KEY};
+  const TimeSeriesKey start{0, "", {}};
+  const TimeSeriesKey end{AGGREGATE_ENTRY_COUNT / shape.series, "", {}};
+  for (auto _ : state) {
+    QueryBuilder<double> query{lsm_tree, tag_columns};
+    auto& range{query.range(start, end)};
+    benchmark::DoNotOptimize(aggregate(
+      by_tag ? range.filterByTag(BENCH_TAG_KEY, "host_0") : range
+    ));
+  }
+  state.SetItemsProcessed(
+    state.iterations() * static_cast<int64_t>(
+      by_tag ? AGGREGATE_ENTRY_COUNT / shape.series : AGGREGATE_ENTRY_COUNT
+    )
+  );
+  lsm_tree.clear();
+  removeBenchDirectory();
+}
+
+static constexpr auto COUNT{[](auto& query) { return query.count(); }};
+static constexpr auto SUM{[](auto& query) { return query.sum(); }};
+static constexpr auto AVG{[](auto& query) { return query.avg(); }};
+static constexpr auto MIN{[](auto& query) { return query.min(); }};
+static constexpr auto MAX{[](auto& query) { return query.max(); }};
+
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, count, COUNT, false)
+  ->Apply(dataShapes);
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, sum, SUM, false)
+  ->Apply(dataShapes);
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, avg, AVG, false)
+  ->Apply(dataShapes);
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, min, MIN, false)
+  ->Apply(dataShapes);
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, max, MAX, false)
+  ->Apply(dataShapes);
+BENCHMARK_CAPTURE(BM_QueryBuilderAggregate, sum_by_tag, SUM, true)
+  ->Apply(dataShapes);
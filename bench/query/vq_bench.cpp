@@ -0,0 +1,80 @@
+#include "data_shape.h"
+#include <vkdb/lexer.h>
+#include <vkdb/parser.h>
+#include <string>
+
+using namespace vkdb;
+
+static constexpr uint64_t VQ_SERIES{100};
+
+/**
+ * @brief Generate a vq source of statements over a data shape's series.
+ * @details Every fifth statement is a select, and the rest are puts.
+ *
+ * @param count Number of statements.
+ * @param shape Data shape.
+ * @return std::string Source.
+ */
+static std::string make_source(uint64_t count, DataShape shape) {
+  const auto keys{makeKeys(count, shape)};
+  std::string source;
+  for (uint64_t i{0}; i < count; ++i) {
+    const auto timestamp{std::to_string(keys[i].timestamp())};
+    const auto& host{keys[i].tags().at(BENCH_TAG_KEY)};
+    if (i % 5 == 4) {
+      source += "SELECT AVG " + BENCH_METRIC + " FROM bench BETWEEN 0 AND "
+        + timestamp + " WHERE " + BENCH_TAG_KEY + "=" + host + ";\n";
+    } else {
+      source += "PUT " + BENCH_METRIC + " " + timestamp + " "
+        + std::to_string(i) + ".5 INTO bench TAGS " + BENCH_TAG_KEY + "="
+        + host + ";\n";
+    }
+  }
+  return source;
+}
+
+/**
+ * @brief Tokenize a vq source of a number of statements.
+ *
+ */
+static void BM_LexerTokenize(benchmark::State& state) {
+  const auto source{make_source(
+    static_cast<uint64_t>(state.range(0)),
+    {VQ_SERIES, 10}
+  )};
+  for (auto _ : state) {
+    Lexer lexer{source};
+    benchmark::DoNotOptimize(lexer.tokenize());
+  }
+  state.SetBytesProcessed(
+    state.iterations() * static_cast<int64_t>(source.size())
+  );
+}
+BENCHMARK(BM_LexerTokenize)->RangeMultiplier(100)->Range(1, 10'000)
+  ->ArgName("statements");
+
+/**
+ * @brief Parse the tokens of a vq source of a number of statements.
+ *
+ */
+static void BM_ParserParse(benchmark::State& state) {
+  const auto source{make_source(
+    static_cast<uint64_t>(state.range(0)),
+    {VQ_SERIES, 10}
+  )};
+  const auto tokens{Lexer{source}.tokenize()};
+  for (auto _ : state) {
+    Parser parser{tokens};
+    auto expr{parser.parse()};
+    if (!expr.has_value()) {
+      state.SkipWithError("Source did not parse.");
+      break;
+    }
+    benchmark::DoNotOptimize(expr);
+  }
+  state.SetBytesProcessed(
+    state.iterations() * static_cast<int64_t>(source.size())
+  );
+}
+BENCHMARK(BM_ParserParse)->RangeMultiplier(100)->Range(1, 10'000)
+  ->ArgName("statements");
@@ -0,0 +1,232 @@
+#include "data_shape.h"
+#include <vkdb/lsm_tree.h>
+#include <vkdb/key_filter.h>
+#include <memory>
+
+using namespace vkdb;
+
+static constexpr uint64_t PUT_KEY_COUNT{1 << 16};
+static constexpr uint64_t READ_ENTRY_COUNT{10'000};
+static constexpr uint64_t RANGE_ENTRY_COUNT{100'000};
+static constexpr uint64_t REPLAY_ENTRY_COUNT{100'000};
+static constexpr uint64_t READ_SERIES{100};
+static constexpr uint64_t LAYER_COUNT{LSMTreeOptions::LAYER_COUNT};
+
+/**
+ * @brief Get the options of an LSM tree whose entries all end up at a depth.
+ * @details Depth 0 is the memtable, which is then large enough to hold every
+ * entry, and depth k + 1 is the Ck layer, above which every layer is
+ * compacted as soon as it has an SSTable. The read cache holds a single
+ * entry, so reads of distinct keys go through to the depth.
+ *
+ * @param depth Depth.
+ * @param entry_count Number of entries that will be put.
+ * @return LSMTreeOptions Options.
+ */
+static LSMTreeOptions depth_options(uint64_t depth, uint64_t entry_count) {
+  LSMTreeOptions options;
+  options.cache_capacity = 1;
+  options.sync_sstables = false;
+  if (depth == 0) {
+    options.mem_table_max_entries = entry_count + 1;
+    return options;
+  }
+  for (uint64_t k{0}; k + 1 < depth; ++k) {
+    options.layer_table_counts[k] = 0;
+  }
+  return options;
+}
+
+/**
+ * @brief Put entries into an LSM tree, with a value of their index.
+ *
+ * @param lsm_tree LSM tree.
+ * @param keys Keys.
+ * @param log Whether to log the entries in the WAL.
+ */
+static void put_keys(
+  LSMTree<double>& lsm_tree,
+  const std::vector<TimeSeriesKey>& keys,
+  bool log
+) {
+  for (uint64_t i{0}; i < keys.size(); ++i) {
+    lsm_tree.put(keys[i], static_cast<double>(i), log);
+  }
+}
+
+/**
+ * @brief Put single entries, flushing and compacting as they fill the
+ * memtable.
+ *
+ * @tparam Log Whether to log the entries in the WAL.
+ */
+template <bool Log>
+static void BM_LSMTreePut(benchmark::State& state) {
+  removeBenchDirectory();
+  const auto shape{dataShape(state)};
+  LSMTree<double> lsm_tree{BENCH_DIRECTORY};
+  auto keys{makeKeys(PUT_KEY_COUNT, shape)};
+  Timestamp start{0};
+  uint64_t i{0};
+  for (auto _ : state) {
+    if (i == keys.size()) {
+      state.PauseTiming();
+      start += PUT_KEY_COUNT / shape.series + 1;
+      keys = makeKeys(PUT_KEY_COUNT, shape, start);
+      i = 0;
+      state.ResumeTiming();
+    }
+    lsm_tree.put(keys[i], static_cast<double>(i), Log);
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+  lsm_tree.clear();
+  removeBenchDirectory();
+}
+BENCHMARK_TEMPLATE(BM_LSMTreePut, false)->Name("BM_LSMTreePutWithoutWAL")
+  ->Apply(dataShapes);
+BENCHMARK_TEMPLATE(BM_LSMTreePut, true)->Name("BM_LSMTreePutWithWAL")
+  ->Apply(dataShapes);
+
+/**
+ * @brief Flush a full memtable, compacting every layer above the Ck layer
+ * into the next so that the flushed entries end up in the Ck layer.
+ * @details Only the put that fills the memtable is timed, so the time of
+ * layer k less that of layer k - 1 is the cost of compacting into layer k.
+ *
+ */
+static void BM_LSMTreeFlushAndCompact(benchmark::State& state) {
+  removeBenchDirectory();
+  const auto k{static_cast<uint64_t>(state.range(0))};
+  auto options{depth_options(k + 1, 0)};
+  options.sync_sstables = true;
+  LSMTree<double> lsm_tree{BENCH_DIRECTORY, options};
+  const DataShape shape{READ_SERIES, 10};
+  std::vector<TimeSeriesKey> keys;
+  Timestamp start{0};
+  for (auto _ : state) {
+    state.PauseTiming();
+    keys = makeKeys(options.mem_table_max_entries, shape, start);
+    start += options.mem_table_max_entries / shape.series;
+    for (uint64_t i{0}; i + 1 < keys.size(); ++i) {
+      lsm_tree.put(keys[i], static_cast<double>(i), false);
+    }
+    state.ResumeTiming();
+    lsm_tree.put(keys.back(), 0.0, false);
+  }
+  state.SetItemsProcessed(
+    state.iterations() * static_cast<int64_t>(options.mem_table_max_entries)
+  );
+  state.counters["sstables"] = static_cast<double>(lsm_tree.sstableCount(k));
+  lsm_tree.clear();
+  removeBenchDirectory();
+}
+BENCHMARK(BM_LSMTreeFlushAndCompact)->DenseRange(0, LAYER_COUNT - 1)
+  ->ArgName("layer")->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Get single keys from an LSM tree whose entries are all at a depth,
+ * as given by depth_options().
+ *
+ * @tparam Hit Whether the keys are in the LSM tree. Missing keys are of a
+ * series with no entries, at timestamps that other series have entries at.
+ */
+template <bool Hit>
+static void BM_LSMTreeGet(benchmark::State& state) {
+  removeBenchDirectory();
+  const auto depth{static_cast<uint64_t>(state.range(0))};
+  const DataShape shape{READ_SERIES, 10};
+  LSMTree<double> lsm_tree{
+    BENCH_DIRECTORY,
+    depth_options(depth, READ_ENTRY_COUNT)
+  };
+  const auto keys{makeKeys(READ_ENTRY_COUNT, shape)};
+  put_keys(lsm_tree, keys, false);
+  if (depth > 0 && lsm_tree.sstableCount(depth - 1) == 0) {
+    state.SkipWithError("Entries did not reach the layer.");
+  }
+  std::vector<TimeSeriesKey> lookups;
+  lookups.reserve(keys.size());
+  for (const auto& key : keys) {
+    lookups.push_back(
+      Hit ? key : benchKey(shape.series, key.timestamp())
+    );
+  }
+  uint64_t i{0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lsm_tree.get(lookups[i]));
+    i = i + 1 == lookups.size() ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  lsm_tree.clear();
+  removeBenchDirectory();
+}
+BENCHMARK_TEMPLATE(BM_LSMTreeGet, true)->Name("BM_LSMTreeGetHit")
+  ->DenseRange(0, LAYER_COUNT)->ArgName("depth");
+BENCHMARK_TEMPLATE(BM_LSMTreeGet, false)->Name("BM_LSMTreeGetMiss")
+  ->DenseRange(0, LAYER_COUNT)->ArgName("depth");
+
+/**
+ * @brief Get the entries of every series in a timestamp range of a width.
+ * @details Ranges start at every timestamp in turn, so they are spread over
+ * the memtable and the layers that the entries were flushed and compacted
+ * into.
+ *
+ */
+static void BM_LSMTreeGetRange(benchmark::State& state) {
+  removeBenchDirectory();
+  const auto width{static_cast<Timestamp>(state.range(0))};
+  const DataShape shape{READ_SERIES, 10};
+  LSMTreeOptions options;
+  options.sync_sstables = false;
+  LSMTree<double> lsm_tree{BENCH_DIRECTORY, options};
+  put_keys(lsm_tree, makeKeys(RANGE_ENTRY_COUNT, shape), false);
+  const auto timestamps{RANGE_ENTRY_COUNT / shape.series};
+  Timestamp start{0};
+  int64_t entries{0};
+  for (auto _ : state) {
+    const auto result{lsm_tree.getRange(
+      TimeSeriesKey{start, "", {}},
+      TimeSeriesKey{start + width, "", {}},
+      AnyKey{}
+    )};
+    entries += static_cast<int64_t>(result.size());
+    start = start + width >= timestamps ? 0 : start + 1;
+  }
+  state.SetItemsProcessed(entries);
+  lsm_tree.clear();
+  removeBenchDirectory();
+}
+BENCHMARK(BM_LSMTreeGetRange)->RangeMultiplier(10)->Range(1, 1'000)
+  ->ArgName("width");
+
+/**
+ * @brief Replay a WAL of entries that fit in the memtable, in a format.
+ * @details Replaying into memtables that are not full leaves the WAL as it
+ * was, so every iteration replays the same records.
+ *
+ */
+static void BM_WALReplay(benchmark::State& state) {
+  removeBenchDirectory();
+  const auto shape{dataShape(state)};
+  LSMTreeOptions options;
+  options.mem_table_max_entries = REPLAY_ENTRY_COUNT + 1;
+  options.wal.format = static_cast<WALFormat>(state.range(2));
+  {
+    LSMTree<double> lsm_tree{BENCH_DIRECTORY, options};
+    put_keys(lsm_tree, makeKeys(REPLAY_ENTRY_COUNT, shape), true);
+    lsm_tree.syncWAL();
+  }
+  for (auto _ : state) {
+    LSMTree<double> lsm_tree{BENCH_DIRECTORY, options};
+    lsm_tree.replayWAL();
+  }
+  state.SetItemsProcessed(
+    state.iterations() * static_cast<int64_t>(REPLAY_ENTRY_COUNT)
+  );
+  removeBenchDirectory();
+}
+BENCHMARK(BM_WALReplay)
+  ->ArgNames({"series", "ooo%", "binary"})
+  ->ArgsProduct({{1, 100, 10'000}, {0, 10}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
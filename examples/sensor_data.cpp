@@ -1,6 +1,7 @@
 #include <vkdb/database.h>
 #include <vkdb/random.h>
 #include <iostream>
+#include <vector>
 
 int main() {
   vkdb::Database db{"sensor_data"};
@@ -17,16 +18,15 @@ int main() {
   table.addTagColumn("region");
   table.addTagColumn("city");
   
+  vkdb::TagTable tags{region_eu_tag, city_london_tag};
+  std::vector<vkdb::DataPoint<double>> datapoints;
   for (vkdb::Timestamp t{0}; t < 10'000; ++t) {
     double temperature{vkdb::random<double>(0.0, 40.0)};
     double humidity{vkdb::random<double>(0.0, 100.0)};
-    table.query()
-      .put(t, temp_metric, {region_eu_tag, city_london_tag}, temperature)
-      .execute();
-    table.query()
-      .put(t, humidity_metric, {region_eu_tag, city_london_tag}, humidity)
-      .execute();
+    datapoints.push_back({t, temp_metric, tags, temperature});
+    datapoints.push_back({t, humidity_metric, tags, humidity});
   }
+  table.putBatch(datapoints);
 
   auto average_temperature{table.query()
     .whereTimestampBetween(2'500, 7'500)
@@ -3,6 +3,17 @@
 
 #include <vkdb/vq.h>
 #include <vkdb/table.h>
+#include <vkdb/statement.h>
+#include <vkdb/result_writer.h>
+#include <vkdb/lru_cache.h>
+#include <vkdb/task.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <thread>
 
 namespace vkdb {
 /**
@@ -13,6 +24,83 @@ static const FilePath DATABASE_DIRECTORY{
   std::filesystem::path(getenv("HOME")) / ".vkdb"
 };
 
+/**
+ * @brief Options for a database.
+ * 
+ */
+struct DatabaseOptions {
+  /**
+   * @brief Budget of the block cache shared by all tables, in bytes.
+   * @details The cache holds decoded SSTable blocks, so repeated range
+   * queries over recent data are served from memory. 0 disables it.
+   * 
+   */
+  uint64_t block_cache_bytes{64 << 20};
+
+  /**
+   * @brief Number of threads that write compacted SSTables, shared by all
+   * tables.
+   * @details Each time window of a compaction is written as its own SSTable,
+   * so large compactions write many at once. 0 writes them on the compacting
+   * thread.
+   * 
+   */
+  uint64_t compaction_threads{std::thread::hardware_concurrency()};
+
+  /**
+   * @brief Number of threads that read SSTables for range queries, shared by
+   * all tables.
+   * @details A range query over many SSTables reads them concurrently. 0
+   * reads them on the querying thread.
+   * 
+   */
+  uint64_t read_threads{0};
+
+  /**
+   * @brief Options of the I/O scheduler shared by all tables.
+   * @details Every table's WAL appends, flushes and compactions draw on one
+   * token bucket when a rate is set. A rate of 0 leaves I/O unlimited, and
+   * no scheduler is made.
+   * 
+   */
+  IOSchedulerOptions io_scheduler{};
+
+  /**
+   * @brief Budget of the memory held by all tables, in bytes.
+   * @details Counts the memtables, read caches, SSTable indexes and Bloom
+   * filters of the opened tables. Over budget, the largest memtables are
+   * flushed early, and then the read caches and Bloom filters of the tables
+   * used least recently are released. 0 leaves memory unbounded, and no
+   * memory manager is made.
+   * 
+   */
+  uint64_t memory_budget_bytes{0};
+
+  /**
+   * @brief Number of threads that run asynchronous queries, shared by all
+   * tables.
+   * @details 0 runs them on the awaiting thread.
+   * 
+   */
+  uint64_t query_threads{std::thread::hardware_concurrency()};
+
+  /**
+   * @brief Number of parsed statements cached by their source string.
+   * @details Both run() and prepare() look the source up before lexing and
+   * parsing it, so repeated queries skip straight to interpretation. 0
+   * disables the cache.
+   * 
+   */
+  uint64_t statement_cache_size{128};
+
+  /**
+   * @brief Format of the data points written by run() and execute().
+   * @details Results other than data points are always written as text.
+   * 
+   */
+  OutputFormat output_format{OutputFormat::TEXT};
+};
+
 /**
  * @brief Represents a database in vkdb.
  * 
@@ -45,17 +133,37 @@ public:
     runtime_error_callback runtime_error = VQ::runtimeError
   );
 
+  /**
+   * @brief Construct a new Database object with options.
+   * @details The constructor will load the database if it exists.
+   * 
+   * @param name Name of the database.
+   * @param options Options.
+   * @param error Error callback.
+   * @param runtime_error Runtime error callback.
+   * 
+   * @throw std::runtime_error If loading the database fails.
+   */
+  Database(
+    DatabaseName name,
+    DatabaseOptions options,
+    error_callback error = VQ::error,
+    runtime_error_callback runtime_error = VQ::runtimeError
+  );
+
   /**
    * @brief Move-construct a new Database object.
+   * @details No query may be running on the other database.
    * 
    */
-  Database(Database&&) noexcept = default;
+  Database(Database&& other) noexcept;
 
   /**
    * @brief Move-assign a new Database object.
+   * @details No query may be running on either database.
    * 
    */
-  Database& operator=(Database&&) noexcept = default;
+  Database& operator=(Database&& other) noexcept;
 
   /**
    * @brief Deleted copy constructor.
@@ -71,9 +179,10 @@ public:
 
   /**
    * @brief Destroy the Database object.
+   * @details Stops the memory manager tracking the tables first.
    * 
    */
-  ~Database() noexcept = default;
+  ~Database() noexcept;
 
   /**
    * @brief Create a Table object.
@@ -81,26 +190,40 @@ public:
    * directory for the table.
    * 
    * @param table_name Name of the table.
+   * @param options Options of the table, which are saved with it. The table
+   * draws on the database's block cache and compaction pool unless it is
+   * given its own.
+   * @param value_type Value type of the table, which is saved with it.
    * @return Table& Reference to the created table.
    * 
-   * @throw std::runtime_error If the table already exists.
+   * @throw std::runtime_error If the table already exists, or if saving its
+   * options fails.
+   * @throw std::invalid_argument If any option is out of range.
    */
-  Table& createTable(const TableName& table_name);
+  Table& createTable(
+    const TableName& table_name,
+    TableOptions options = {},
+    ValueType value_type = ValueType::DOUBLE
+  );
 
   /**
    * @brief Get the Table object.
+   * @details A table left unopened by load() is opened here, on first use,
+   * which loads its SSTables and replays its WAL. The reference stays valid
+   * until the table is dropped.
    * 
    * @param table_name Name of the table.
    * @return Table& Reference to the table.
    * 
-   * @throw std::runtime_error If the table does not exist.
+   * @throw std::runtime_error If the table does not exist, or if opening it
+   * fails.
    */
   [[nodiscard]] Table& getTable(const TableName& table_name);
 
   /**
    * @brief Drop the Table object.
    * @details Removes the table directory and erases the table from the table
-   * map.
+   * map. A table that was never opened is dropped without opening it.
    * 
    * @param table_name Name of the table.
    * 
@@ -123,6 +246,22 @@ public:
    */
   [[nodiscard]] DatabaseName name() const noexcept;
 
+  /**
+   * @brief Get the block cache shared by the tables.
+   * 
+   * @return std::shared_ptr<const BlockCache> Block cache, or null if it is
+   * disabled.
+   */
+  [[nodiscard]] std::shared_ptr<const BlockCache> blockCache() const noexcept;
+
+  /**
+   * @brief Get the memory manager shared by the tables.
+   * 
+   * @return std::shared_ptr<MemoryManager> Memory manager, or null if memory
+   * is unbounded.
+   */
+  [[nodiscard]] std::shared_ptr<MemoryManager> memoryManager() const noexcept;
+
   /**
    * @brief Get the path to the database directory.
    * 
@@ -132,11 +271,41 @@ public:
 
   /**
    * @brief Get the names of the tables in the database.
+   * @details Includes the tables that have not been opened yet.
    * 
    * @return std::vector<TableName> Names of the tables.
    */
   [[nodiscard]] std::vector<TableName> tables() const noexcept;
 
+  /**
+   * @brief Get the storage stats of the tables in the database.
+   * @details Only includes the tables that have been opened, since the
+   * others have done no work.
+   * 
+   * @return std::map<TableName, StorageStats> Stats of each table, by name.
+   */
+  [[nodiscard]] std::map<TableName, StorageStats> stats() const;
+
+  /**
+   * @brief Write a checkpoint of the database, from which it can be opened
+   * as it was.
+   * @details Each opened table is checkpointed as given by
+   * Table::checkpoint(), without stopping writes to it. The tables that have
+   * not been opened are not written to, so their files are copied as they
+   * are, with their SSTables hard-linked. A checkpoint made under the
+   * database directory opens as the database named after it. No table may
+   * be dropped while the checkpoint is written.
+   * 
+   * @param directory Directory of the checkpoint, which is created if it
+   * does not exist.
+   * 
+   * @throw std::runtime_error If the directory is not empty, or if a file
+   * cannot be written or copied.
+   * @throw std::filesystem::filesystem_error If a directory cannot be
+   * created, or a file can be neither linked nor copied.
+   */
+  void checkpoint(const FilePath& directory);
+
   /**
    * @brief Run a source string.
    * @details The source string is lexed, parsed, and interpreted.
@@ -150,6 +319,40 @@ public:
     std::ostream& stream = std::cout
   ) noexcept;
 
+  /**
+   * @brief Prepare a source string.
+   * @details The source string is lexed and parsed once, or taken from the
+   * statement cache, and may contain placeholders ('?') for timestamps,
+   * values, and tag values.
+   * 
+   * @param source Source string.
+   * @return std::shared_ptr<const PreparedStatement> Prepared statement.
+   * 
+   * @throw std::runtime_error If parsing the source string fails.
+   */
+  [[nodiscard]] std::shared_ptr<const PreparedStatement> prepare(
+    const std::string& source
+  );
+
+  /**
+   * @brief Execute a prepared statement.
+   * @details The parameters are bound to the placeholders in order, and the
+   * statement is interpreted. Runtime errors are reported as with run().
+   * 
+   * @param statement Prepared statement.
+   * @param parameters Parameters.
+   * @param stream Output stream.
+   * @return Database& Reference to this Database object.
+   * 
+   * @throw std::invalid_argument If the number of parameters does not match
+   * the number of placeholders.
+   */
+  Database& execute(
+    const PreparedStatement& statement,
+    std::span<const Parameter> parameters,
+    std::ostream& stream = std::cout
+  );
+
   /**
    * @brief Run a file.
    * @details The file is read, lexed, parsed, and interpreted.
@@ -163,6 +366,24 @@ public:
     std::ostream& stream = std::cout
   ) noexcept;
 
+  /**
+   * @brief Run a source string on the query pool, as a coroutine.
+   * @details Once awaited, the run moves onto the query pool, and the
+   * awaiting coroutine is resumed on the pool's thread when it is done. The
+   * output is buffered and written to the stream in one go, so overlapping
+   * runs do not interleave, but they must not share a stream that is unsafe
+   * to write to concurrently. Runs that create or drop tables must not
+   * overlap with any other.
+   * 
+   * @param source Source string.
+   * @param stream Output stream.
+   * @return Task<> Run.
+   */
+  [[nodiscard]] Task<> runAsync(
+    std::string source,
+    std::ostream& stream = std::cout
+  );
+
   /**
    * @brief Run the prompt.
    * @details The user can enter queries and commands interactively.
@@ -178,6 +399,31 @@ private:
    */
   using TableMap = std::unordered_map<TableName, Table>;
 
+  /**
+   * @brief Type alias for a cache from source strings to prepared
+   * statements.
+   * 
+   */
+  using StatementCache = LRUCache<
+    std::string,
+    std::shared_ptr<const PreparedStatement>
+  >;
+
+  /**
+   * @brief Compile a source string into a prepared statement.
+   * @details Looks the source string up in the statement cache first, and
+   * caches it once it parses.
+   * 
+   * @param source Source string.
+   * @param callback Callback for parse errors.
+   * @return std::shared_ptr<const PreparedStatement> Prepared statement, or
+   * null if parsing fails.
+   */
+  [[nodiscard]] std::shared_ptr<const PreparedStatement> compile(
+    const std::string& source,
+    const error_callback& callback
+  );
+
   /**
    * @brief Handle an error.
    * @details Reports the error and sets the had_error_ flag.
@@ -210,36 +456,146 @@ private:
 
   /**
    * @brief Load the database.
-   * @details If the database directory does not exist, it is created. Each
-   * existing table is loaded into the table map.
+   * @details If the database directory does not exist, it is created. The
+   * existing tables are only listed, and each is opened by getTable() on
+   * first use, so that opening a database with many tables does not wait on
+   * every table's SSTables and WAL.
    * 
-   * @throw std::runtime_error If loading the tables fails.
+   * @throw std::filesystem::filesystem_error If the database directory
+   * cannot be created or listed.
    */
   void load();
 
+  /**
+   * @brief Open a table, with the options of the database.
+   * @details Must be called with the table mutex held. The table is tracked
+   * by its memory manager, if any, which is then rebalanced, since opening
+   * the table loads the indexes and Bloom filters of its SSTables.
+   * 
+   * @param table_name Name of the table.
+   * @param options Options of the table.
+   * @param value_type Value type of the table, if it is new.
+   * @return Table& Reference to the opened table.
+   * 
+   * @throw std::runtime_error If opening the table fails.
+   */
+  Table& open_table(
+    const TableName& table_name,
+    TableOptions options,
+    ValueType value_type = ValueType::DOUBLE
+  );
+
+  /**
+   * @brief Copy a table that has not been opened into a checkpoint.
+   * @details Must be called with the table mutex held, so that the table is
+   * not opened meanwhile. SSTable files are hard-linked, and the rest, which
+   * are written again once the table is opened, are copied.
+   * 
+   * @param table_name Name of the table.
+   * @param directory Directory of the checkpoint.
+   * 
+   * @throw std::filesystem::filesystem_error If a directory cannot be
+   * created, or a file can be neither linked nor copied.
+   */
+  void checkpoint_unopened_table(
+    const TableName& table_name,
+    const FilePath& directory
+  ) const;
+
+  /**
+   * @brief Block cache shared by the tables, or null if it is disabled.
+   * 
+   */
+  std::shared_ptr<BlockCache> block_cache_;
+
+  /**
+   * @brief Compaction pool shared by the tables, or null if it is disabled.
+   * @details Declared before the tables, so that it outlives them.
+   * 
+   */
+  std::shared_ptr<ThreadPool> compaction_pool_;
+
+  /**
+   * @brief Read pool shared by the tables, or null if it is disabled.
+   * @details Declared before the tables, so that it outlives them.
+   * 
+   */
+  std::shared_ptr<ThreadPool> read_pool_;
+
+  /**
+   * @brief I/O scheduler shared by the tables, or null if I/O is unlimited.
+   * @details Declared before the tables, so that it outlives them.
+   * 
+   */
+  std::shared_ptr<IOScheduler> io_scheduler_;
+
+  /**
+   * @brief Memory manager shared by the tables, or null if memory is
+   * unbounded.
+   * @details Declared before the tables, so that it outlives them.
+   * 
+   */
+  std::shared_ptr<MemoryManager> memory_manager_;
+
+  /**
+   * @brief Cache of prepared statements, or null if it is disabled.
+   * 
+   */
+  std::shared_ptr<StatementCache> statement_cache_;
+
   /**
    * @brief Map from table names to Table objects.
    * 
    */
   TableMap table_map_;
 
+  /**
+   * @brief Names of the tables on disk that have not been opened yet.
+   * 
+   */
+  std::set<TableName> unopened_tables_;
+
+  /**
+   * @brief ID of each opened table tracked by the memory manager.
+   * 
+   */
+  std::unordered_map<TableName, MemoryManager::consumer_id> memory_consumers_;
+
+  /**
+   * @brief Mutex of the table map and the unopened tables.
+   * @details Held while a table is opened, so that concurrent queries open it
+   * once.
+   * 
+   */
+  std::unique_ptr<std::mutex> table_mutex_;
+
   /**
    * @brief Name of the database.
    * 
    */
   DatabaseName name_;
 
+  /**
+   * @brief Query pool shared by the tables, or null if it is disabled.
+   * @details Declared after the tables, so that the queries still queued
+   * run before the tables are destroyed.
+   * 
+   */
+  std::shared_ptr<ThreadPool> query_pool_;
+
   /**
    * @brief Flag for errors.
+   * @details Atomic, since asynchronous runs set it from the query pool.
    * 
    */
-  bool had_error_;
+  std::atomic<bool> had_error_;
 
   /**
    * @brief Flag for runtime errors.
+   * @details Atomic, since asynchronous runs set it from the query pool.
    * 
    */
-  bool had_runtime_error_;
+  std::atomic<bool> had_runtime_error_;
 
   /**
    * @brief Error callback.
@@ -252,6 +608,12 @@ private:
    * 
    */
   runtime_error_callback runtime_callback_;
+
+  /**
+   * @brief Format of the data points in the output.
+   * 
+   */
+  OutputFormat output_format_;
 };
 }  // namespace vkdb
 
@@ -0,0 +1,233 @@
+#ifndef DATABASE_IMPORTER_H
+#define DATABASE_IMPORTER_H
+
+#include <vkdb/table.h>
+#include <vkdb/thread_pool.h>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Format of imported data.
+ * 
+ */
+enum class ImportFormat {
+  /**
+   * @brief InfluxDB line protocol, as
+   * 'measurement[,tag=value...] field=value[,field=value...] timestamp'.
+   * @details Each field is its own metric, named 'measurement_field', or
+   * just 'measurement' for a field named 'value'. Float, integer ('i' or 'u'
+   * suffix), and boolean fields are imported, and string fields are an
+   * error. Escaped characters are not supported.
+   * 
+   */
+  LINE_PROTOCOL,
+
+  /**
+   * @brief CSV as written with OutputFormat::CSV, with a
+   * 'timestamp,metric,tags,value' header and tags as 'key=value' separated
+   * by ';'.
+   * 
+   */
+  CSV
+};
+
+/**
+ * @brief Options for an import.
+ * 
+ */
+struct ImportOptions {
+  /**
+   * @brief Format of the data.
+   * 
+   */
+  ImportFormat format{ImportFormat::LINE_PROTOCOL};
+
+  /**
+   * @brief Number of entries parsed before they are sorted and written.
+   * @details A chunk of at least a memtable's worth of entries is
+   * bulk-loaded straight into SSTables.
+   * 
+   */
+  uint64_t chunk_entries{1 << 20};
+
+  /**
+   * @brief Number of threads that sort each chunk. 0 or 1 sorts on the
+   * importing thread.
+   * 
+   */
+  uint64_t sort_threads{std::thread::hardware_concurrency()};
+};
+
+/**
+ * @brief Counts of an import.
+ * 
+ */
+struct ImportStats {
+  /**
+   * @brief Number of lines read, including blank lines, comments, and the
+   * header.
+   * 
+   */
+  uint64_t lines{0};
+
+  /**
+   * @brief Number of entries written.
+   * 
+   */
+  uint64_t entries{0};
+};
+
+/**
+ * @brief Streams line protocol or CSV into a table.
+ * @details Lines are parsed with std::from_chars into chunks of entries.
+ * Each chunk is split into runs that are sorted concurrently and merged,
+ * keeping the last of any duplicate keys, then written with
+ * Table::putBatch, so that full chunks skip the WAL and the memtable and go
+ * straight into SSTables.
+ * 
+ */
+class Importer {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  Importer() = delete;
+
+  /**
+   * @brief Construct a new Importer object.
+   * 
+   * @param table Table, which must outlive the importer. Its tag columns
+   * must already hold every tag key in the data.
+   * @param options Options.
+   * 
+   * @throw std::invalid_argument If the chunk size is 0.
+   */
+  explicit Importer(Table& table, ImportOptions options = {});
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  Importer(Importer&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  Importer& operator=(Importer&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  Importer(const Importer&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  Importer& operator=(const Importer&) = delete;
+
+  /**
+   * @brief Destroy the Importer object.
+   * 
+   */
+  ~Importer() noexcept = default;
+
+  /**
+   * @brief Import a stream.
+   * @details The chunks before a malformed line are already written when
+   * it is reached.
+   * 
+   * @param input Input stream.
+   * @return ImportStats Counts of the import.
+   * 
+   * @throw std::runtime_error If a line is malformed, or if writing to the
+   * table fails.
+   */
+  ImportStats run(std::istream& input);
+
+  /**
+   * @brief Import a file.
+   * 
+   * @param path Path to the file.
+   * @return ImportStats Counts of the import.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, if a line is
+   * malformed, or if writing to the table fails.
+   */
+  ImportStats runFile(const std::filesystem::path& path);
+
+private:
+  /**
+   * @brief Parse a line of line protocol into the chunk.
+   * 
+   * @param line Line.
+   * 
+   * @throw std::runtime_error If the line is malformed.
+   */
+  void parse_line_protocol(std::string_view line);
+
+  /**
+   * @brief Parse a line of CSV into the chunk.
+   * 
+   * @param line Line.
+   * 
+   * @throw std::runtime_error If the line is malformed.
+   */
+  void parse_csv(std::string_view line);
+
+  /**
+   * @brief Sort the chunk by key and drop all but the last of any duplicate
+   * keys.
+   * 
+   */
+  void sort_chunk();
+
+  /**
+   * @brief Sort and write the chunk, then clear it.
+   * 
+   * @param stats Counts of the import.
+   * 
+   * @throw std::runtime_error If writing to the table fails.
+   */
+  void write_chunk(ImportStats& stats);
+
+  /**
+   * @brief Table.
+   * 
+   */
+  Table& table_;
+
+  /**
+   * @brief Options.
+   * 
+   */
+  ImportOptions options_;
+
+  /**
+   * @brief Threads that sort the chunks, or null if they are sorted on the
+   * importing thread.
+   * 
+   */
+  std::unique_ptr<ThreadPool> sort_pool_;
+
+  /**
+   * @brief Entries parsed but not yet written.
+   * 
+   */
+  std::vector<std::pair<TimeSeriesKey, double>> chunk_;
+};
+}  // namespace vkdb
+
+#endif // DATABASE_IMPORTER_H
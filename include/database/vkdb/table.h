@@ -3,8 +3,14 @@
 
 #include <vkdb/concepts.h>
 #include <vkdb/lsm_tree.h>
+#include <vkdb/sharded_lsm_tree.h>
 #include <vkdb/friendly_builder.h>
 #include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
 
 namespace vkdb {
 /**
@@ -13,6 +19,55 @@ namespace vkdb {
  */
 static const FilePath TAG_COLUMNS_FILENAME{"tag_columns.metadata"};
 
+/**
+ * @brief The name of the file that stores the options for a table.
+ * 
+ */
+static const FilePath TABLE_OPTIONS_FILENAME{"table_options.metadata"};
+
+/**
+ * @brief Options for a table, which are those of its LSM trees.
+ * @details Saved when the table is created, and loaded with it from then on,
+ * except for the block cache and compaction pool, which are given by whoever
+ * opens the table. The series of a table with more than one shard are
+ * hash-partitioned across that many LSM trees.
+ * 
+ */
+using TableOptions = LSMTreeOptions;
+
+/**
+ * @brief Type of the values of a table.
+ * @details Chosen when the table is created, and saved with its options. The
+ * storage engine is instantiated for each type, so values are stored at
+ * their own width, and integer values are delta-encoded in SSTable blocks.
+ * 
+ */
+enum class ValueType : uint8_t {
+  DOUBLE,
+  INT64,
+  INT32,
+  FLOAT,
+  BOOL
+};
+
+/**
+ * @brief Get the name of a value type, as written in VQ.
+ * 
+ * @param value_type Value type.
+ * @return std::string Name.
+ */
+[[nodiscard]] std::string valueTypeToString(ValueType value_type) noexcept;
+
+/**
+ * @brief Get the value type of a name, as written in VQ.
+ * 
+ * @param name Name.
+ * @return ValueType Value type.
+ * 
+ * @throw std::invalid_argument If the name is not that of a value type.
+ */
+[[nodiscard]] ValueType valueTypeFromString(const std::string& name);
+
 /**
  * @brief Type alias for a string.
  * 
@@ -39,14 +94,28 @@ public:
     
     /**
      * @brief Construct a new Table object.
-     * @details Loads the table if it exists.
+     * @details Loads the table if it exists, in which case its saved options
+     * and value type replace the given ones. Otherwise, the given options
+     * and value type are saved.
      * 
      * @param db_path Path to the database directory.
      * @param name Name of the table.
+     * @param options Options.
+     * @param query_pool Pool that runs asynchronous queries, which must
+     * outlive the table, or null to run them on the awaiting thread.
+     * @param value_type Value type.
      * 
-     * @throw std::runtime_error If loading the table fails.
+     * @throw std::runtime_error If loading the table, or loading or saving
+     * its options, fails.
+     * @throw std::invalid_argument If any option is out of range.
      */
-    explicit Table(const FilePath& db_path, const TableName& name);
+    explicit Table(
+      const FilePath& db_path,
+      const TableName& name,
+      TableOptions options = {},
+      ThreadPool* query_pool = nullptr,
+      ValueType value_type = ValueType::DOUBLE
+    );
     
     /**
      * @brief Move-construct a new Table object.
@@ -116,11 +185,221 @@ public:
     void clear() const noexcept;
     
     /**
-     * @brief Get a FriendlyQueryBuilder object.
+     * @brief Put a batch of datapoints into the table.
+     * @details Tags are validated once per distinct tag set, and values are
+     * converted to the value type, before anything is written. The
+     * datapoints are then written with LSMTree::putBatch, so a batch sorted
+     * by key is bulk-loaded straight into SSTables.
+     * 
+     * @param datapoints Datapoints.
+     * 
+     * @throw std::runtime_error If a tag is not in the tag columns, if a
+     * value is not one of the value type, or if writing the batch fails.
+     */
+    void putBatch(std::span<const DataPoint<double>> datapoints);
+
+    /**
+     * @brief Put a batch of rows of one series into the table.
+     * @details The tags are validated and the series is resolved once for
+     * the whole batch, then the rows are written with LSMTree::putBatch.
+     * 
+     * @param metric Metric.
+     * @param tags Tags.
+     * @param rows Timestamp and value of each row.
+     * 
+     * @throw std::runtime_error If a tag is not in the tag columns, if a
+     * value is not one of the value type, or if writing the batch fails.
+     */
+    void putBatch(
+      const Metric& metric,
+      const TagTable& tags,
+      std::span<const std::pair<Timestamp, double>> rows
+    );
+
+    /**
+     * @brief Put a batch of entries into the table.
+     * @details Tags are validated once per distinct series, before anything
+     * is written. The entries are then written with LSMTree::putBatch as
+     * they are, so a batch sorted by key is bulk-loaded.
+     * 
+     * @param entries Entries.
+     * 
+     * @throw std::runtime_error If a tag is not in the tag columns, if a
+     * value is not one of the value type, or if writing the batch fails.
+     */
+    void putBatch(std::span<const TimeSeriesEntry<double>> entries);
+
+    /**
+     * @brief Get a FriendlyQueryBuilder object for a table of doubles.
+     * @details Its executeAsync() runs on the table's query pool.
      * 
      * @return FriendlyQueryBuilder<double> Friendly query builder.
+     * 
+     * @throw std::runtime_error If the value type is not DOUBLE.
+     */
+    [[nodiscard]] FriendlyQueryBuilder<double> query();
+
+    /**
+     * @brief Get a FriendlyQueryBuilder object for the value type.
+     * @details Its executeAsync() runs on the table's query pool.
+     * 
+     * @tparam TValue Value type.
+     * @return FriendlyQueryBuilder<TValue> Friendly query builder.
+     * 
+     * @throw std::runtime_error If TValue is not the value type.
+     */
+    template <ArithmeticNoCVRefQuals TValue>
+    [[nodiscard]] FriendlyQueryBuilder<TValue> query() {
+      auto storage_engine{std::get_if<ShardedLSMTree<TValue>>(
+        &storage_engine_
+      )};
+      if (storage_engine == nullptr) {
+        throw std::runtime_error{
+          "Table::query(): Table '" + name_ + "' holds "
+          + valueTypeToString(value_type_) + " values."
+        };
+      }
+      return FriendlyQueryBuilder<TValue>(
+        *storage_engine,
+        tag_columns_,
+        query_pool_
+      );
+    }
+
+    /**
+     * @brief Call a visitor with a FriendlyQueryBuilder object for the value
+     * type.
+     * @details Lets code that does not know the value type query the table,
+     * with the visitor instantiated for every value type.
+     * 
+     * @tparam TVisitor Visitor type.
+     * @param visitor Visitor, which must return the same type for every
+     * FriendlyQueryBuilder.
+     * @return decltype(auto) Result of the visitor.
+     */
+    template <typename TVisitor>
+    decltype(auto) visitQuery(TVisitor&& visitor) {
+      return std::visit(
+        [this, &visitor](auto& storage_engine) -> decltype(auto) {
+          using TValue = typename std::remove_cvref_t<
+            decltype(storage_engine)
+          >::mapped_type::value_type;
+          return std::forward<TVisitor>(visitor)(FriendlyQueryBuilder<TValue>(
+            storage_engine,
+            tag_columns_,
+            query_pool_
+          ));
+        },
+        storage_engine_
+      );
+    }
+
+    /**
+     * @brief Get the value type of the table.
+     * 
+     * @return ValueType Value type.
      */
-    [[nodiscard]] FriendlyQueryBuilder<double> query() noexcept;
+    [[nodiscard]] ValueType valueType() const noexcept;
+
+    /**
+     * @brief Get the number of shards of the table.
+     * 
+     * @return uint64_t Number of shards.
+     */
+    [[nodiscard]] uint64_t shardCount() const noexcept;
+
+    /**
+     * @brief Get the storage stats of the table.
+     * 
+     * @return StorageStats Sum of the stats of its shards.
+     */
+    [[nodiscard]] StorageStats stats() const;
+
+    /**
+     * @brief Get the memory held by the table.
+     * 
+     * @return MemoryUsage Sum of the usage of its shards.
+     */
+    [[nodiscard]] MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief Get the callbacks through which a memory manager accounts for
+     * the table.
+     * @details The callbacks refer to the table, which must outlive its
+     * tracking by the manager.
+     * 
+     * @return MemoryConsumer Consumer.
+     */
+    [[nodiscard]] MemoryConsumer memoryConsumer();
+
+    /**
+     * @brief Read the WAL records of a shard from a log sequence number on,
+     * for a follower.
+     * @details Only complete while the WAL is archived, as given by
+     * WALOptions::archive.
+     * 
+     * @param shard Shard index.
+     * @param lsn LSN of the first record to read.
+     * @param max_bytes Number of bytes of records after which reading stops.
+     * @return WALChunk Records, and the LSN to read from next.
+     * 
+     * @throw std::out_of_range If the shard index is out of range.
+     * @throw std::runtime_error If the WAL cannot be read, or if records from
+     * the LSN on are no longer kept.
+     */
+    [[nodiscard]] WALChunk readWAL(
+      uint64_t shard,
+      uint64_t lsn,
+      uint64_t max_bytes
+    );
+
+    /**
+     * @brief Remove the archived WAL segments of a shard that every follower
+     * has read.
+     * 
+     * @param shard Shard index.
+     * @param lsn LSN that every follower has read up to.
+     * 
+     * @throw std::out_of_range If the shard index is out of range.
+     * @throw std::filesystem::filesystem_error If an archive cannot be
+     * removed.
+     */
+    void acknowledgeWAL(uint64_t shard, uint64_t lsn);
+
+    /**
+     * @brief Apply WAL records read from the same shard of a leader's table.
+     * @details The shard's WAL is synced before returning, so the records
+     * are durable.
+     * 
+     * @param shard Shard index.
+     * @param records Records, as given by readWAL().
+     * @return uint64_t Number of records applied.
+     * 
+     * @throw std::out_of_range If the shard index is out of range.
+     * @throw std::invalid_argument If a record is malformed.
+     * @throw std::runtime_error If writing a record or syncing the WAL
+     * fails.
+     */
+    uint64_t applyWAL(uint64_t shard, const std::string& records);
+
+    /**
+     * @brief Write a checkpoint of the table, from which it can be opened as
+     * it was.
+     * @details The storage engine is checkpointed as given by
+     * ShardedLSMTree::checkpoint(), and the tag columns and options are
+     * copied alongside it.
+     * 
+     * @param directory Directory of the checkpoint, which is created if it
+     * does not exist.
+     * @return std::vector<uint64_t> LSN of the next WAL record of each
+     * shard.
+     * 
+     * @throw std::runtime_error If the directory is not empty, or if a file
+     * cannot be written or copied.
+     * @throw std::filesystem::filesystem_error If a directory cannot be
+     * created, or a file can be neither linked nor copied.
+     */
+    std::vector<uint64_t> checkpoint(const FilePath& directory);
 
     /**
      * @brief Get the name of the table.
@@ -136,6 +415,13 @@ public:
      */
     [[nodiscard]] TagColumns tagColumns() const noexcept;
 
+    /**
+     * @brief Get the options of the table.
+     * 
+     * @return TableOptions Options.
+     */
+    [[nodiscard]] TableOptions options() const noexcept;
+
     /**
      * @brief Get the path to the table directory.
      * 
@@ -145,10 +431,29 @@ public:
 
 private:
     /**
-     * @brief Type alias for the storage engine.
+     * @brief Type alias for the storage engine, one for each value type, in
+     * the order of ValueType.
      * 
      */
-    using StorageEngine = LSMTree<double>;
+    using StorageEngine = std::variant<
+      ShardedLSMTree<double>,
+      ShardedLSMTree<int64_t>,
+      ShardedLSMTree<int32_t>,
+      ShardedLSMTree<float>,
+      ShardedLSMTree<bool>
+    >;
+
+    /**
+     * @brief Load the options and value type, then open the storage engine
+     * for the value type.
+     * 
+     * @param options Options, as given to load_options().
+     * @return StorageEngine Storage engine.
+     * 
+     * @throw std::runtime_error If loading or saving the options fails.
+     * @throw std::invalid_argument If any option is out of range.
+     */
+    [[nodiscard]] StorageEngine open_storage_engine(TableOptions options);
 
     /**
      * @brief Check if the table has been populated.
@@ -163,7 +468,7 @@ private:
      * @brief Save the tag columns to a file.
      * @details Writes the tag columns to a file.
      * 
-     * @throw std::runtime_error If the file cannot be opened.
+     * @throw std::runtime_error If the file cannot be opened or written.
      */
     void save_tag_columns() const;
 
@@ -181,6 +486,39 @@ private:
      * @return FilePath Path to the file.
      */
     [[nodiscard]] FilePath tag_columns_path() const noexcept;
+
+    /**
+     * @brief Save the options to a file.
+     * @details Writes one option per line, as its name and value, followed
+     * by the value type. The block cache and compaction pool are not saved.
+     * 
+     * @param options Options.
+     * 
+     * @throw std::runtime_error If the file cannot be opened.
+     */
+    void save_options(const TableOptions& options) const;
+
+    /**
+     * @brief Load the options from a file, or save them if there is none.
+     * @details Options missing from the file keep their given values, and
+     * unknown options are ignored. A saved value type replaces the table's,
+     * and a table saved before value types were saved holds doubles.
+     * 
+     * @param options Options, whose block cache and compaction pool are
+     * kept.
+     * @return TableOptions Loaded options.
+     * 
+     * @throw std::runtime_error If the file cannot be opened, or if an option
+     * is malformed.
+     */
+    [[nodiscard]] TableOptions load_options(TableOptions options);
+
+    /**
+     * @brief Get the path to the file that stores the options.
+     * 
+     * @return FilePath Path to the file.
+     */
+    [[nodiscard]] FilePath options_path() const noexcept;
     
     /**
      * @brief Load the table.
@@ -210,11 +548,23 @@ private:
      */
     TagColumns tag_columns_;
 
+    /**
+     * @brief Value type, which picks the storage engine.
+     * 
+     */
+    ValueType value_type_;
+
     /**
      * @brief Storage engine.
      * 
      */
     StorageEngine storage_engine_;
+
+    /**
+     * @brief Pool that runs asynchronous queries, or null.
+     * 
+     */
+    ThreadPool* query_pool_;
 };
 
 } // namespace vkdb
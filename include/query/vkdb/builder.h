@@ -3,10 +3,17 @@
 
 #include <vkdb/concepts.h>
 #include <vkdb/lsm_tree.h>
+#include <vkdb/sharded_lsm_tree.h>
+#include <vkdb/planner.h>
+#include <vkdb/sketch.h>
+#include <vkdb/task.h>
+#include <vkdb/thread_pool.h>
+#include <vkdb/query_arena.h>
 #include <variant>
 #include <ranges>
-#include <ranges>
 #include <algorithm>
+#include <memory_resource>
+#include <optional>
 #include <unordered_set>
 
 namespace vkdb {
@@ -16,6 +23,31 @@ namespace vkdb {
  */
 using TagColumns = std::unordered_set<TagKey>;
 
+/**
+ * @brief Aggregate function applied to each bucket of a bucketed aggregate.
+ * 
+ */
+enum class AggregateFunction { COUNT, SUM, AVG, MIN, MAX };
+
+/**
+ * @brief Order of the entries returned by a query.
+ * @details Ties between equal values are broken by key order.
+ * 
+ */
+enum class QueryOrder { TIMESTAMP_ASC, TIMESTAMP_DESC, VALUE_ASC, VALUE_DESC };
+
+/**
+ * @brief Type alias for the start timestamp and aggregate value of a bucket.
+ * 
+ */
+using TimeBucket = std::pair<Timestamp, double>;
+
+/**
+ * @brief Type alias for the start timestamp and aggregate values of a bucket.
+ * 
+ */
+using TimeBucketAggregates = std::pair<Timestamp, std::vector<double>>;
+
 /**
  * @brief Query builder for querying a Table.
  * 
@@ -38,8 +70,7 @@ public:
 
   /**
    * @brief Construct a new QueryBuilder object.
-   * @details Query type is set to NONE and filters are initialised with a
-   * filter that always returns true.
+   * @details Query type is set to NONE and the predicate matches every key.
    * 
    * @param lsm_tree Reference to the LSMTree to query.
    * @param tag_columns Reference to the tag columns of the Table.
@@ -48,10 +79,27 @@ public:
     LSMTree<TValue>& lsm_tree,
     const TagColumns& tag_columns
   ) noexcept
-    : lsm_tree_{lsm_tree}
+    : shards_{&lsm_tree}
+    , tag_columns_{tag_columns}
+    , query_type_{QueryType::NONE} {}
+
+  /**
+   * @brief Construct a new QueryBuilder object over the shards of a sharded
+   * LSM tree.
+   * @details Point reads and writes go to the shard of their series, range
+   * removals go to every shard, and range reads fan out to the shards and
+   * merge their results.
+   * 
+   * @param lsm_tree Reference to the sharded LSM tree to query.
+   * @param tag_columns Reference to the tag columns of the Table.
+   */
+  explicit QueryBuilder(
+    ShardedLSMTree<TValue>& lsm_tree,
+    const TagColumns& tag_columns
+  ) noexcept
+    : shards_{lsm_tree.shards()}
     , tag_columns_{tag_columns}
-    , query_type_{QueryType::NONE}
-    , filters_{TRUE_TIME_SERIES_KEY_FILTER} {}
+    , query_type_{QueryType::NONE} {}
   
   /**
    * @brief Move-construct a QueryBuilder object.
@@ -136,9 +184,7 @@ public:
     const TagValue& value
   ) {
     validate_tags(Tag{key, value});
-    add_filter([key, value](const auto& k) {
-      return k.tags().contains(key) && k.tags().at(key) == value;
-    });
+    predicate_.requireAnyTag({Tag{key, value}});
     return *this;
   }
 
@@ -156,17 +202,14 @@ public:
   template <AllConvertibleToNoCVRefQuals<Tag>... Tags>
   [[nodiscard]] QueryBuilder& filterByAnyTags(const Tags&... tags) {
     validate_tags(tags...);
-    add_filter([tags...](const auto& k) {
-      return ((k.tags().contains(tags.first) &&
-               k.tags().at(tags.first) == tags.second) || ...);
-    });
+    predicate_.requireAnyTag({Tag{tags}...});
     return *this;
   }
 
   /**
    * @brief Filter the TimeSeriesKeys by multiple tags.
    * @details Adds a filter that checks if the TimeSeriesKey has all of the
-   * specified tags.
+   * specified tags, as one clause per tag.
    * 
    * @tparam Tags Variadic template parameter for tags to filter by.
    * @param tags Tags to filter by.
@@ -177,10 +220,7 @@ public:
   template <AllConvertibleToNoCVRefQuals<Tag>... Tags>
   [[nodiscard]] QueryBuilder& filterByAllTags(const Tags&... tags) {
     validate_tags(tags...);
-    add_filter([tags...](const auto& k) {
-      return ((k.tags().contains(tags.first) &&
-               k.tags().at(tags.first) == tags.second) && ...);
-    });
+    (predicate_.requireAnyTag({Tag{tags}}), ...);
     return *this;
   }
 
@@ -195,9 +235,7 @@ public:
    * @throw std::runtime_error If adding the filter fails.
    */
   [[nodiscard]] QueryBuilder& filterByMetric(const Metric& metric) {
-    add_filter([metric](const auto& k) {
-      return k.metric() == metric;
-    });
+    predicate_.requireAnyMetric({metric});
     return *this;
   }
 
@@ -214,9 +252,7 @@ public:
    */
   template <AllConvertibleToNoCVRefQuals<Metric>... Metrics>
   [[nodiscard]] QueryBuilder& filterByAnyMetrics(const Metrics&... metrics) {
-    add_filter([metrics...](const auto& k) {
-      return ((k.metric() == metrics) || ...);
-    });
+    predicate_.requireAnyMetric({Metric{metrics}...});
     return *this;
   }
 
@@ -231,9 +267,7 @@ public:
    * @throw std::runtime_error If adding the filter fails.
    */
   [[nodiscard]] QueryBuilder& filterByTimestamp(const Timestamp& timestamp) {
-    add_filter([timestamp](const auto& k) {
-      return k.timestamp() == timestamp;
-    });
+    predicate_.requireAnyTimestamp({timestamp});
     return *this;
   }
 
@@ -252,9 +286,35 @@ public:
   [[nodiscard]] QueryBuilder& filterByAnyTimestamps(
     const Timestamps&... timestamps
   ) {
-    add_filter([timestamps...](const auto& k) {
-      return ((k.timestamp() == timestamps) || ...);
-    });
+    predicate_.requireAnyTimestamp({static_cast<Timestamp>(timestamps)...});
+    return *this;
+  }
+
+  /**
+   * @brief Order the entries returned by the query.
+   * @details Entries are returned in key order, oldest first, by default.
+   * Only applies to execute().
+   * 
+   * @param order Order.
+   * @return QueryBuilder& Reference to this QueryBuilder object.
+   */
+  [[nodiscard]] QueryBuilder& orderBy(QueryOrder order) noexcept {
+    order_ = order;
+    return *this;
+  }
+
+  /**
+   * @brief Limit the number of entries returned by the query.
+   * @details The first entries in the query's order are kept. In timestamp
+   * order, the scan stops as soon as it has them, reading newest-first for
+   * descending order. In value order, the range is streamed through a heap
+   * of the best entries so far. Only applies to execute().
+   * 
+   * @param limit Maximum number of entries.
+   * @return QueryBuilder& Reference to this QueryBuilder object.
+   */
+  [[nodiscard]] QueryBuilder& limit(size_type limit) noexcept {
+    limit_ = limit;
     return *this;
   }
 
@@ -291,6 +351,35 @@ public:
     return *this;
   }
 
+  /**
+   * @brief Remove the keys of a series over a timestamp range from the
+   * LSMTree.
+   * @details A single range tombstone is written, which removes every key
+   * with the metric and at least the given tags in the range.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param metric Metric of the keys.
+   * @param tag_table Tags that the keys must have.
+   * @return QueryBuilder& Reference to this QueryBuilder object.
+   * 
+   * @throw std::runtime_error If any of the tags are not in the tag columns.
+   * @throw std::invalid_argument If the start is after the end.
+   */
+  [[nodiscard]] QueryBuilder& removeRange(
+    Timestamp start,
+    Timestamp end,
+    const Metric& metric,
+    const TagTable& tag_table = {}
+  ) {
+    validate_tags(tag_table);
+    set_query_type(QueryType::REMOVE_RANGE);
+    query_params_ = QueryParams{
+      RemoveRangeParams{RangeTombstone{start, end, metric, tag_table}}
+    };
+    return *this;
+  }
+
   /**
    * @brief Count the number of entries in the range.
    * @details Sets up the QueryBuilder for aggregation and returns the number
@@ -301,8 +390,9 @@ public:
    * @throw std::runtime_error If the aggregate setup fails.
    */
   [[nodiscard]] size_type count() {
+    const ReadArena arena{*this};
     setup_aggregate();
-    return std::ranges::distance(get_filtered_range());
+    return aggregate_filtered_range().count;
   }
 
   /**
@@ -310,18 +400,17 @@ public:
    * @details Sets up the QueryBuilder for aggregation and returns the sum of
    * the values in the range.
    * 
-   * @return TValue Sum of the values in the range.
+   * @return StatsSum<TValue> Sum of the values in the range.
    * 
    * @throw std::runtime_error If the aggregate setup fails or the range is
    * empty.
    */
-  [[nodiscard]] TValue sum() {
+  [[nodiscard]] StatsSum<TValue> sum() {
+    const ReadArena arena{*this};
     setup_aggregate();
-    auto range{get_nonempty_filtered_range()};
-    return std::accumulate(range.begin(), range.end(), TValue{},
-      [](const TValue& acc, const valuetype& entry) {
-        return acc + entry.second.value();
-      });
+    const auto stats{aggregate_filtered_range()};
+    check_nonempty(stats.count);
+    return stats.sum;
   }
 
   /**
@@ -335,13 +424,11 @@ public:
    * empty.
    */
   [[nodiscard]] double avg() {
+    const ReadArena arena{*this};
     setup_aggregate();
-    auto range{get_nonempty_filtered_range()};
-    auto sum{std::accumulate(range.begin(), range.end(), TValue{},
-      [](const auto& acc, const auto& entry) {
-        return acc + entry.second.value();
-      })};
-    return static_cast<double>(sum) / std::ranges::distance(range);
+    const auto stats{aggregate_filtered_range()};
+    check_nonempty(stats.count);
+    return static_cast<double>(stats.sum) / stats.count;
   }
 
   /**
@@ -355,11 +442,11 @@ public:
    * empty.
    */
   [[nodiscard]] TValue min() {
+    const ReadArena arena{*this};
     setup_aggregate();
-    auto range{get_nonempty_filtered_range()};
-    return std::ranges::min_element(range, {}, [](const auto& entry) {
-      return entry.second.value();
-    })->second.value();
+    const auto stats{aggregate_filtered_range()};
+    check_nonempty(stats.count);
+    return stats.min;
   }
 
   /**
@@ -373,11 +460,242 @@ public:
    * empty.
    */
   [[nodiscard]] TValue max() {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    const auto stats{aggregate_filtered_range()};
+    check_nonempty(stats.count);
+    return stats.max;
+  }
+
+  /**
+   * @brief Get the newest entry of each series in the range.
+   * @details Sets up the QueryBuilder like an aggregation. Range queries are
+   * answered from the LSM tree's latest-value index, without scanning the
+   * range; see LSMTree::latest(). The entries are put in the query's order
+   * and cut to its limit.
+   * 
+   * @return result_type Newest entry of each series.
+   * 
+   * @throw std::runtime_error If the query type is not a range or point
+   * query, or if reading the LSM tree fails.
+   */
+  [[nodiscard]] result_type latest() {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    if (limit_ == 0) {
+      return {};
+    }
+    if (query_type_ == QueryType::POINT) {
+      return order_and_limit(execute_point_query());
+    }
+    const auto& params{std::get<RangeParams>(query_params_)};
+    return order_and_limit(
+      latest_of_shards(params.start, params.end)
+    );
+  }
+
+  /**
+   * @brief Compute several aggregates of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation, and computes every
+   * aggregate from the same streaming pass over the range.
+   * 
+   * @param functions Aggregate functions.
+   * @return std::vector<double> Value of each aggregate function, in order.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails, no functions are
+   * given, or the range is empty and a function other than COUNT is given.
+   */
+  [[nodiscard]] std::vector<double> aggregate(
+    const std::vector<AggregateFunction>& functions
+  ) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    check_functions(functions);
+    const auto stats{aggregate_filtered_range()};
+    if (
+      std::ranges::any_of(functions, [](const auto function) {
+        return function != AggregateFunction::COUNT;
+      })
+    ) {
+      check_nonempty(stats.count);
+    }
+    return aggregate_values(functions, stats);
+  }
+
+  /**
+   * @brief Estimate a percentile of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation. See percentiles().
+   * 
+   * @param percentile Percentile, in [0, 100].
+   * @return double Estimate of the value at the percentile.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails or the range is
+   * empty.
+   * @throw std::invalid_argument If the percentile is not in [0, 100].
+   */
+  [[nodiscard]] double percentile(double percentile) {
+    return percentiles({percentile}).front();
+  }
+
+  /**
+   * @brief Estimate several percentiles of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation, and streams the range
+   * once into a QuantileSketch, so each estimate is within 1% of the true
+   * value at the percentile.
+   * 
+   * @param percentiles Percentiles, each in [0, 100].
+   * @return std::vector<double> Estimate of the value at each percentile, in
+   * order.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails, no percentiles
+   * are given, or the range is empty.
+   * @throw std::invalid_argument If a percentile is not in [0, 100].
+   */
+  [[nodiscard]] std::vector<double> percentiles(
+    const std::vector<double>& percentiles
+  ) {
+    const ReadArena arena{*this};
     setup_aggregate();
-    auto range{get_nonempty_filtered_range()};
-    return std::ranges::max_element(range, {}, [](const auto& entry) {
-      return entry.second.value();
-    })->second.value();
+    if (percentiles.empty()) {
+      throw std::runtime_error{
+        "QueryBuilder::percentiles(): No percentiles given."
+      };
+    }
+    for (const auto percentile : percentiles) {
+      if (!(percentile >= 0.0 && percentile <= 100.0)) {
+        throw std::invalid_argument{
+          "QueryBuilder::percentiles(): Percentiles must be in [0, 100]."
+        };
+      }
+    }
+    QuantileSketch sketch;
+    for_each_filtered([&sketch](const auto&, TValue value) {
+      sketch.add(static_cast<double>(value));
+    });
+    check_nonempty(sketch.count());
+    std::vector<double> estimates;
+    estimates.reserve(percentiles.size());
+    for (const auto percentile : percentiles) {
+      estimates.push_back(sketch.quantile(percentile / 100.0));
+    }
+    return estimates;
+  }
+
+  /**
+   * @brief Estimate the number of distinct values in the range.
+   * @details Sets up the QueryBuilder for aggregation, and streams the range
+   * once into a DistinctSketch.
+   * 
+   * @return size_type Estimate of the number of distinct values.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails.
+   */
+  [[nodiscard]] size_type approxCountDistinct() {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    DistinctSketch sketch;
+    for_each_filtered([&sketch](const auto&, TValue value) {
+      sketch.add(static_cast<double>(value));
+    });
+    return sketch.estimate();
+  }
+
+  /**
+   * @brief Estimate the number of distinct values of a tag in the range.
+   * @details Sets up the QueryBuilder for aggregation, and streams the range
+   * once into a DistinctSketch. Keys without the tag are skipped.
+   * 
+   * @param tag_key Tag key.
+   * @return size_type Estimate of the number of distinct values of the tag.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails or the tag key is
+   * not in the tag columns.
+   */
+  [[nodiscard]] size_type approxCountDistinct(const TagKey& tag_key) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    if (!tag_columns_.contains(tag_key)) {
+      throw std::runtime_error{
+        "QueryBuilder::approxCountDistinct(): Tag '"
+        + tag_key + "' not in tag columns."
+      };
+    }
+    DistinctSketch sketch;
+    for_each_filtered([&sketch, &tag_key](const auto& key, TValue) {
+      const auto& tags{key.tags()};
+      if (const auto it{tags.find(tag_key)}; it != tags.end()) {
+        sketch.add(it->second);
+      }
+    });
+    return sketch.estimate();
+  }
+
+  /**
+   * @brief Aggregate the values in the range in fixed-width time buckets.
+   * @details Sets up the QueryBuilder for aggregation. Buckets are aligned
+   * to multiples of the width, and all of them are computed in one streaming
+   * pass over the range, taking whole blocks from their statistics where
+   * they fall in a single bucket. Empty buckets are omitted.
+   * 
+   * @param function Aggregate function.
+   * @param width Width of each bucket.
+   * @return std::vector<TimeBucket> Start and value of each non-empty bucket,
+   * in time order.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails or the width is
+   * zero.
+   */
+  [[nodiscard]] std::vector<TimeBucket> aggregateEvery(
+    AggregateFunction function,
+    Timestamp width
+  ) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    if (width == 0) {
+      throw std::runtime_error{
+        "QueryBuilder::aggregateEvery(): Bucket width must be positive."
+      };
+    }
+    std::vector<TimeBucket> buckets;
+    for (const auto& [start, stats] : aggregate_buckets(width)) {
+      buckets.emplace_back(start, aggregate_value(function, stats));
+    }
+    return buckets;
+  }
+
+  /**
+   * @brief Compute several aggregates of the values in the range in
+   * fixed-width time buckets.
+   * @details Sets up the QueryBuilder for aggregation, and computes every
+   * aggregate of every bucket from the same streaming pass over the range.
+   * Buckets are aligned to multiples of the width, and empty buckets are
+   * omitted.
+   * 
+   * @param functions Aggregate functions.
+   * @param width Width of each bucket.
+   * @return std::vector<TimeBucketAggregates> Start and value of each
+   * aggregate function of each non-empty bucket, in time order.
+   * 
+   * @throw std::runtime_error If the aggregate setup fails, no functions are
+   * given, or the width is zero.
+   */
+  [[nodiscard]] std::vector<TimeBucketAggregates> aggregateEvery(
+    const std::vector<AggregateFunction>& functions,
+    Timestamp width
+  ) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    check_functions(functions);
+    if (width == 0) {
+      throw std::runtime_error{
+        "QueryBuilder::aggregateEvery(): Bucket width must be positive."
+      };
+    }
+    std::vector<TimeBucketAggregates> buckets;
+    for (const auto& [start, stats] : aggregate_buckets(width)) {
+      buckets.emplace_back(start, aggregate_values(functions, stats));
+    }
+    return buckets;
   }
 
   /**
@@ -390,9 +708,10 @@ public:
    * filters or if executing the query fails.
    */
   result_type execute() {
+    const ReadArena arena{*this};
     switch (query_type_) {
     case QueryType::NONE:
-      if (filters_.size() == 1) {
+      if (predicate_.empty()) {
         throw std::runtime_error{
           "QueryBuilder::execute(): No query type specified."
         };
@@ -400,22 +719,113 @@ public:
       set_default_range_if_none();
       return get_filtered_range();
     case QueryType::POINT:
-      return execute_point_query();
+      return order_and_limit(execute_point_query());
     case QueryType::RANGE:
       return execute_range_query();
     case QueryType::PUT:
       return execute_put_query();
     case QueryType::REMOVE:
       return execute_remove_query();
+    case QueryType::REMOVE_RANGE:
+      return execute_remove_range_query();
+    }
+  }
+
+  /**
+   * @brief Visit every live entry of the query as it is read.
+   * @details Sets up the QueryBuilder like an aggregation. Without an order
+   * or a limit, range queries are streamed from LSMTree::scan(), so the
+   * entries are never held in memory together; otherwise they are read as
+   * by execute() and then visited.
+   * 
+   * @tparam OnEntry Entry visitor type.
+   * @param on_entry Called with the key and value of each entry, in the
+   * query's order.
+   * 
+   * @throw std::runtime_error If the query type is not a range or point
+   * query, or if getting the range fails.
+   */
+  template <typename OnEntry>
+  void forEach(OnEntry&& on_entry) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    if (order_ == QueryOrder::TIMESTAMP_ASC && !limit_) {
+      for_each_filtered(on_entry);
+      return;
+    }
+    for (const auto& [key, value] : get_filtered_range()) {
+      on_entry(key, value.value());
     }
   }
 
+  /**
+   * @brief Visit every live entry of the query that also matches a
+   * compile-time filter, as it is read.
+   * @details As with forEach(), but the filter is checked against each key
+   * inline, with the builder's own filters checked after it only if there
+   * are any. The filter joins them in planning the reads, so its clauses
+   * narrow the SSTables and blocks read, or turn the range into point
+   * lookups, as a filter added to the builder would.
+   * 
+   * @tparam TFilter Filter type.
+   * @tparam OnEntry Entry visitor type.
+   * @param filter Filter, such as `MetricEq{"cpu"} && TagEq{"region", "eu"}`.
+   * @param on_entry Called with the key and value of each entry, in the
+   * query's order.
+   * 
+   * @throw std::runtime_error If the query type is not a range or point
+   * query, or if getting the range fails.
+   */
+  template <KeyFilter TFilter, typename OnEntry>
+  void forEach(TFilter filter, OnEntry&& on_entry) {
+    const ReadArena arena{*this};
+    setup_aggregate();
+    if (predicate_.empty()) {
+      for_each_matching(std::move(filter), on_entry);
+    } else {
+      for_each_matching(
+        std::move(filter) && MatchesPredicate{predicate_},
+        on_entry
+      );
+    }
+  }
+
+  /**
+   * @brief Execute the query on a pool, as a coroutine.
+   * @details The query is copied into the coroutine, which moves onto the
+   * pool once awaited, so the awaiting thread never blocks on reading
+   * SSTables. The awaiting coroutine is resumed on the pool's thread. The
+   * LSM tree and the pool must outlive the coroutine.
+   * 
+   * @param pool Pool.
+   * @return Task<result_type> Result of the query.
+   * 
+   * @throw std::runtime_error If executing the query fails, once awaited.
+   */
+  [[nodiscard]] Task<result_type> executeAsync(ThreadPool& pool) const {
+    return execute_async(*this, pool);
+  }
+
 private:
   /**
    * @brief Type of query.
    * 
    */
-  enum class QueryType { NONE, POINT, RANGE, PUT, REMOVE };
+  enum class QueryType { NONE, POINT, RANGE, PUT, REMOVE, REMOVE_RANGE };
+
+  /**
+   * @brief Execute a query on a pool.
+   * 
+   * @param query Query.
+   * @param pool Pool.
+   * @return Task<result_type> Result of the query.
+   * 
+   * @throw std::runtime_error If executing the query fails.
+   */
+  static Task<result_type> execute_async(QueryBuilder query, ThreadPool& pool) {
+    co_await pool.schedule();
+    co_return query.execute();
+  }
 
   /**
    * @brief Parameters for a point query.
@@ -477,9 +887,22 @@ private:
     keytype key;
   };
 
+  /**
+   * @brief Parameters for a range remove query.
+   * 
+   */
+  struct RemoveRangeParams {
+    /**
+     * @brief Range tombstone to write.
+     * 
+     */
+    RangeTombstone range_tombstone;
+  };
+
   /**
    * @brief Query parameters.
-   * @details Variant of point, range, put, and remove parameters.
+   * @details Variant of point, range, put, remove, and range remove
+   * parameters.
    * 
    */
   using QueryParams = std::variant<
@@ -487,7 +910,8 @@ private:
     PointParams,
     RangeParams,
     PutParams,
-    RemoveParams
+    RemoveParams,
+    RemoveRangeParams
   >;
 
   /**
@@ -550,50 +974,661 @@ private:
   }
 
   /**
-   * @brief Add a filter to the filters vector.
+   * @brief Get the filtered range.
+   * @details Reads the range as planned by plan_range(), and filters it
+   * based on the filters, in the query's order and up to its limit.
    * 
-   * @param filter TimeSeriesKeyFilter to add.
+   * @return result_type Filtered range.
    */
-  void add_filter(TimeSeriesKeyFilter&& filter) {
-    filters_.push_back(std::move(filter));
+  [[nodiscard]] result_type get_filtered_range() const {
+    if (limit_ == 0) {
+      return {};
+    }
+    if (query_type_ == QueryType::POINT) {
+      return order_and_limit(execute_point_query());
+    }
+    return std::visit([this](const auto& plan) -> result_type {
+      using P = std::decay_t<decltype(plan)>;
+      if constexpr (std::is_same_v<P, EmptyPlan>) {
+        return {};
+      } else if constexpr (std::is_same_v<P, PointPlan>) {
+        return order_and_limit(lookup_points(plan));
+      } else {
+        return read_range(plan);
+      }
+    }, plan_range());
   }
 
   /**
-   * @brief Get the filtered range.
-   * @details Filters the range based on the filters and returns it.
+   * @brief Type alias for an entry being ordered.
    * 
-   * @return result_type Filtered range.
    */
-  [[nodiscard]] result_type get_filtered_range() const {
-    if (query_type_ == QueryType::POINT) {
-      return execute_point_query();
+  using ordered_entry = std::pair<keytype, TValue>;
+
+  /**
+   * @brief Get the comparison of entries for the query's order.
+   * 
+   * @return auto Comparison, true if its first entry comes first.
+   */
+  [[nodiscard]] auto entry_order() const noexcept {
+    return [order = order_](const auto& lhs, const auto& rhs) {
+      switch (order) {
+      case QueryOrder::TIMESTAMP_DESC:
+        return rhs.first < lhs.first;
+      case QueryOrder::VALUE_ASC:
+        if (lhs.second != rhs.second) {
+          return lhs.second < rhs.second;
+        }
+        break;
+      case QueryOrder::VALUE_DESC:
+        if (lhs.second != rhs.second) {
+          return lhs.second > rhs.second;
+        }
+        break;
+      case QueryOrder::TIMESTAMP_ASC:
+        break;
+      }
+      return lhs.first < rhs.first;
+    };
+  }
+
+  /**
+   * @brief Check if the limit of the query is reached.
+   * 
+   * @param size Number of entries.
+   * @return true if the query has a limit and size has reached it.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool limit_reached(size_type size) const noexcept {
+    return limit_.has_value() && size >= *limit_;
+  }
+
+  /**
+   * @brief Put entries in the query's order and cut them to its limit.
+   * 
+   * @param entries Live entries.
+   * @return result_type Entries, ordered and limited.
+   */
+  [[nodiscard]] result_type order_and_limit(const result_type& entries) const {
+    if (order_ == QueryOrder::TIMESTAMP_ASC && !limit_reached(entries.size())) {
+      return entries;
+    }
+    std::pmr::vector<ordered_entry> ordered{resource()};
+    ordered.reserve(entries.size());
+    for (const auto& [key, value] : entries) {
+      ordered.emplace_back(key, value.value());
     }
+    std::ranges::sort(ordered, entry_order());
+    if (limit_reached(ordered.size())) {
+      ordered.resize(*limit_);
+    }
+    return {ordered.begin(), ordered.end()};
+  }
+
+  /**
+   * @brief Read a planned range in the query's order and up to its limit.
+   * 
+   * @param plan Range plan.
+   * @return result_type Entries.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  [[nodiscard]] result_type read_range(const RangePlan& plan) const {
+    if (!limit_) {
+      return order_and_limit(
+        get_range_of_shards(plan.start, plan.end)
+      );
+    }
+    switch (order_) {
+    case QueryOrder::TIMESTAMP_ASC: {
+      result_type result;
+      auto scan{scan_shards(plan.start, plan.end)};
+      while (!limit_reached(result.size())) {
+        auto entry{scan.next()};
+        if (!entry) {
+          break;
+        }
+        result.emplace_back(std::move(*entry));
+      }
+      return result;
+    }
+    case QueryOrder::TIMESTAMP_DESC:
+      return read_newest(plan);
+    default:
+      return read_top_values(plan);
+    }
+  }
+
+  /**
+   * @brief Read the newest entries of a planned range, newest first, up to
+   * the query's limit.
+   * @details Scans move forward in time, so the range is read in windows
+   * going back from the newest timestamp written, each twice as wide as the
+   * last, until the limit is reached or the range is exhausted. The history
+   * behind the newest entries is never read.
+   * 
+   * @param plan Range plan.
+   * @return result_type Entries, in descending key order.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  [[nodiscard]] result_type read_newest(const RangePlan& plan) const {
+    const auto lowest{plan.start.timestamp()};
+    auto highest{std::min(plan.end.timestamp(), newest_timestamp())};
+    result_type result;
+    if (highest < lowest) {
+      return result;
+    }
+    auto width{std::max<Timestamp>(*limit_, 1)};
+    while (true) {
+      const auto window_start{
+        highest - lowest < width ? lowest : highest - width + 1
+      };
+      const auto window{get_range_of_shards(
+        window_start == lowest
+          ? plan.start
+          : keytype{window_start, MIN_METRIC, {}},
+        highest == plan.end.timestamp()
+          ? plan.end
+          : keytype{highest, MAX_METRIC, {}}
+      )};
+      for (
+        auto it{window.rbegin()};
+        it != window.rend() && !limit_reached(result.size());
+        ++it
+      ) {
+        result.push_back(*it);
+      }
+      if (limit_reached(result.size()) || window_start == lowest) {
+        return result;
+      }
+      highest = window_start - 1;
+      width = width > std::numeric_limits<Timestamp>::max() / 2
+        ? std::numeric_limits<Timestamp>::max()
+        : width * 2;
+    }
+  }
+
+  /**
+   * @brief Read the entries of a planned range with the best values, up to
+   * the query's limit.
+   * @details The range is streamed through a bounded heap whose top is the
+   * worst entry kept, so only the limit's worth of entries is held at once.
+   * 
+   * @param plan Range plan.
+   * @return result_type Entries, in the query's order.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  [[nodiscard]] result_type read_top_values(const RangePlan& plan) const {
+    const auto precedes{entry_order()};
+    std::pmr::vector<ordered_entry> heap{resource()};
+    heap.reserve(*limit_);
+    auto scan{scan_shards(plan.start, plan.end)};
+    while (const auto entry{scan.next()}) {
+      ordered_entry candidate{entry->first, entry->second.value()};
+      if (heap.size() < *limit_) {
+        heap.push_back(std::move(candidate));
+        std::ranges::push_heap(heap, precedes);
+      } else if (precedes(candidate, heap.front())) {
+        std::ranges::pop_heap(heap, precedes);
+        heap.back() = std::move(candidate);
+        std::ranges::push_heap(heap, precedes);
+      }
+    }
+    std::ranges::sort_heap(heap, precedes);
+    return {heap.begin(), heap.end()};
+  }
+
+  /**
+   * @brief Plan the reads of the range query.
+   * @details Folds the predicate's timestamp, metric, and tag clauses into
+   * tighter bounds, or into point lookups, before the LSM tree is touched,
+   * using the tag indexes of the shards to find the series that match.
+   * 
+   * @return QueryPlan Plan.
+   */
+  [[nodiscard]] QueryPlan plan_range() const {
     const auto& params{std::get<RangeParams>(query_params_)};
-    return lsm_tree_.getRange(params.start, params.end,
-      [this](const auto& k) {
-        return std::ranges::all_of(filters_, [&k](const auto& filter) {
-          return filter(k);
-        });
-      });
+    std::vector<const TagIndex*> tag_indexes;
+    tag_indexes.reserve(shards_.size());
+    for (const auto* shard : shards_) {
+      tag_indexes.push_back(&shard->tagIndex());
+    }
+    return planQuery(
+      params.start,
+      params.end,
+      predicate_,
+      tag_columns_,
+      DEFAULT_MAX_PLANNED_POINTS,
+      std::span<const TagIndex* const>{tag_indexes}
+    );
+  }
+
+  /**
+   * @brief Get the shard that holds the series of a key.
+   * 
+   * @param key Key.
+   * @return LSMTree<TValue>& Shard.
+   */
+  [[nodiscard]] LSMTree<TValue>& shard_of(const keytype& key) const noexcept {
+    return *shards_[ShardedLSMTree<TValue>::shardIndex(key, shards_.size())];
+  }
+
+  /**
+   * @brief Scan a range of every shard lazily with the predicate.
+   * @details The sources of each shard go into a partition of their own, so
+   * the range tombstones of one shard never delete keys of another.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @return MergeIterator<TValue> Scan, in key order.
+   * 
+   * @throw std::exception If reading an SSTable fails.
+   */
+  [[nodiscard]] MergeIterator<TValue> scan_shards(
+    const keytype& start,
+    const keytype& end
+  ) const {
+    if (shards_.size() == 1) {
+      return shards_.front()->scan(start, end, predicate_, resource());
+    }
+    MergeIterator<TValue> merge{predicate_, resource()};
+    for (const auto* shard : shards_) {
+      merge.beginPartition();
+      shard->addScanSources(merge, start, end);
+    }
+    return merge;
+  }
+
+  /**
+   * @brief Scan a range of every shard lazily with a compile-time filter.
+   * @details As with scan_shards() given the builder's predicate.
+   * 
+   * @tparam TFilter Filter type.
+   * @param start Start key.
+   * @param end End key.
+   * @param filter Filter.
+   * @return MergeIterator<TValue, TFilter> Scan, in key order.
+   * 
+   * @throw std::exception If reading an SSTable fails.
+   */
+  template <KeyFilter TFilter>
+  [[nodiscard]] MergeIterator<TValue, TFilter> scan_shards(
+    const keytype& start,
+    const keytype& end,
+    TFilter filter
+  ) const {
+    if (shards_.size() == 1) {
+      return shards_.front()->scan(start, end, std::move(filter), resource());
+    }
+    MergeIterator<TValue, TFilter> merge{std::move(filter), resource()};
+    for (const auto* shard : shards_) {
+      merge.beginPartition();
+      shard->addScanSources(merge, start, end);
+    }
+    return merge;
+  }
+
+  /**
+   * @brief Get the entries of every shard in a range that match the
+   * predicate.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @return result_type Entries, in key order.
+   * 
+   * @throw std::exception If getting the entries fails.
+   */
+  [[nodiscard]] result_type get_range_of_shards(
+    const keytype& start,
+    const keytype& end
+  ) const {
+    if (shards_.size() == 1) {
+      return shards_.front()->getRange(start, end, predicate_, resource());
+    }
+    std::pmr::vector<result_type> runs{resource()};
+    runs.reserve(shards_.size());
+    for (const auto* shard : shards_) {
+      runs.push_back(shard->getRange(start, end, predicate_, resource()));
+    }
+    return merge_runs(std::move(runs));
+  }
+
+  /**
+   * @brief Get the newest live entry of each series of every shard in a
+   * range that matches the predicate.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @return result_type Newest entry of each series, in key order.
+   * 
+   * @throw std::exception If reading a shard fails.
+   */
+  [[nodiscard]] result_type latest_of_shards(
+    const keytype& start,
+    const keytype& end
+  ) const {
+    if (shards_.size() == 1) {
+      return shards_.front()->latest(start, end, predicate_);
+    }
+    std::pmr::vector<result_type> runs{resource()};
+    runs.reserve(shards_.size());
+    for (const auto* shard : shards_) {
+      runs.push_back(shard->latest(start, end, predicate_));
+    }
+    return merge_runs(std::move(runs));
+  }
+
+  /**
+   * @brief Merge sorted runs of disjoint keys into one.
+   * 
+   * @param runs Runs.
+   * @return result_type Entries of every run, in key order.
+   */
+  [[nodiscard]] result_type merge_runs(
+    std::pmr::vector<result_type>&& runs
+  ) const {
+    MergeIterator<TValue> merge{TRUE_TIME_SERIES_KEY_FILTER, resource()};
+    for (auto& run : runs) {
+      merge.addRun(std::move(run));
+    }
+    result_type result;
+    while (auto entry{merge.next()}) {
+      result.push_back(std::move(*entry));
+    }
+    return result;
+  }
+
+  /**
+   * @brief Get the newest timestamp written to any shard.
+   * 
+   * @return Timestamp Newest timestamp, or 0 if nothing was written.
+   */
+  [[nodiscard]] Timestamp newest_timestamp() const noexcept {
+    Timestamp newest{0};
+    for (const auto* shard : shards_) {
+      newest = std::max(newest, shard->newestTimestamp());
+    }
+    return newest;
+  }
+
+  /**
+   * @brief Look up the keys of a point plan.
+   * 
+   * @param plan Point plan.
+   * @return result_type Keys that exist, in key order.
+   * 
+   * @throw std::runtime_error If getting a value fails.
+   */
+  [[nodiscard]] result_type lookup_points(const PointPlan& plan) const {
+    result_type result;
+    for (const auto& key : plan.keys) {
+      auto value{shard_of(key).get(key)};
+      if (value.has_value()) {
+        result.emplace_back(key, std::move(value));
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @brief Aggregate the values of the filtered range.
+   * @details Range queries are planned by plan_range(), then streamed from
+   * LSMTree::scan(), so the range is never materialised. The blocks that the
+   * scan can take whole are answered from their statistics without being
+   * decoded, and decoded entries are aggregated a batch at a time.
+   * 
+   * @return SeriesStats<TValue> Count, sum, minimum, and maximum.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  [[nodiscard]] SeriesStats<TValue> aggregate_filtered_range() const {
+    SeriesStats<TValue> stats;
+    if (query_type_ == QueryType::POINT) {
+      for (const auto& entry : execute_point_query()) {
+        stats.add(entry.second.value());
+      }
+      return stats;
+    }
+    const auto plan{plan_range()};
+    if (const auto points{std::get_if<PointPlan>(&plan)}) {
+      for (const auto& entry : lookup_points(*points)) {
+        stats.add(entry.second.value());
+      }
+      return stats;
+    }
+    const auto range{std::get_if<RangePlan>(&plan)};
+    if (range == nullptr) {
+      return stats;
+    }
+    auto scan{scan_shards(range->start, range->end)};
+    scan.forEachBatch(
+      [&stats](const auto& batch) {
+        stats.merge(aggregateValues(batch.values()));
+      },
+      [&stats](const auto& block_stats, Timestamp) { stats.merge(block_stats); }
+    );
+    return stats;
+  }
+
+  /**
+   * @brief Visit every live entry of the filtered range.
+   * @details Range queries are planned by plan_range() and streamed from
+   * LSMTree::scan(), decoding every block, since sketches are not kept in
+   * the block statistics.
+   * 
+   * @tparam OnEntry Entry visitor type.
+   * @param on_entry Called with the key and value of each entry.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  template <typename OnEntry>
+  void for_each_filtered(OnEntry&& on_entry) const {
+    if (query_type_ == QueryType::POINT) {
+      for (const auto& [key, value] : execute_point_query()) {
+        on_entry(key, value.value());
+      }
+      return;
+    }
+    const auto plan{plan_range()};
+    if (const auto points{std::get_if<PointPlan>(&plan)}) {
+      for (const auto& [key, value] : lookup_points(*points)) {
+        on_entry(key, value.value());
+      }
+      return;
+    }
+    const auto range{std::get_if<RangePlan>(&plan)};
+    if (range == nullptr) {
+      return;
+    }
+    auto scan{scan_shards(range->start, range->end)};
+    while (const auto entry{scan.next()}) {
+      on_entry(entry->first, entry->second.value());
+    }
   }
 
   /**
-   * @brief Get the non-empty filtered range.
-   * @details Gets the filtered range and ensures it is non-empty.
+   * @brief Visit every live entry of the query that matches a compile-time
+   * filter, which stands in for the builder's own filters.
+   * @details Ordered or limited queries, and point queries, are read with
+   * the filter's predicate as by forEach().
    * 
-   * @return result_type Non-empty filtered range.
+   * @tparam TFilter Filter type.
+   * @tparam OnEntry Entry visitor type.
+   * @param filter Filter.
+   * @param on_entry Called with the key and value of each entry.
    * 
-   * @throw std::runtime_error If the filtered range is empty.
+   * @throw std::runtime_error If getting the range fails.
+   */
+  template <KeyFilter TFilter, typename OnEntry>
+  void for_each_matching(TFilter filter, OnEntry& on_entry) const {
+    auto query{*this};
+    query.predicate_ = toPredicate(filter);
+    if (
+      query_type_ == QueryType::POINT ||
+      order_ != QueryOrder::TIMESTAMP_ASC ||
+      limit_
+    ) {
+      query.forEach(on_entry);
+      return;
+    }
+    const auto plan{query.plan_range()};
+    if (const auto points{std::get_if<PointPlan>(&plan)}) {
+      for (const auto& [key, value] : query.lookup_points(*points)) {
+        on_entry(key, value.value());
+      }
+      return;
+    }
+    const auto range{std::get_if<RangePlan>(&plan)};
+    if (range == nullptr) {
+      return;
+    }
+    auto scan{scan_shards(range->start, range->end, std::move(filter))};
+    while (const auto entry{scan.next()}) {
+      on_entry(entry->first, entry->second.value());
+    }
+  }
+
+  /**
+   * @brief Aggregate the values of the filtered range in time buckets.
+   * @details The scan is in key order, which is timestamp order, so buckets
+   * are only ever appended to or extended at the back, and each batch of
+   * decoded entries splits into runs that fall in the same bucket, which
+   * are aggregated a column at a time.
+   * 
+   * @param width Width of each bucket.
+   * @return std::vector<std::pair<Timestamp, SeriesStats<TValue>>> Start and
+   * statistics of each non-empty bucket, in time order.
+   * 
+   * @throw std::runtime_error If getting the range fails.
+   */
+  [[nodiscard]] std::vector<std::pair<Timestamp, SeriesStats<TValue>>>
+  aggregate_buckets(Timestamp width) const {
+    std::vector<std::pair<Timestamp, SeriesStats<TValue>>> buckets;
+    const auto bucket = [&buckets, width](Timestamp timestamp) -> auto& {
+      const auto start{timestamp - timestamp % width};
+      if (buckets.empty() || buckets.back().first != start) {
+        buckets.emplace_back(start, SeriesStats<TValue>{});
+      }
+      return buckets.back().second;
+    };
+
+    if (query_type_ == QueryType::POINT) {
+      for (const auto& [key, value] : execute_point_query()) {
+        bucket(key.timestamp()).add(value.value());
+      }
+      return buckets;
+    }
+    const auto plan{plan_range()};
+    if (const auto points{std::get_if<PointPlan>(&plan)}) {
+      for (const auto& [key, value] : lookup_points(*points)) {
+        bucket(key.timestamp()).add(value.value());
+      }
+      return buckets;
+    }
+    const auto range{std::get_if<RangePlan>(&plan)};
+    if (range == nullptr) {
+      return buckets;
+    }
+    auto scan{scan_shards(range->start, range->end)};
+    scan.forEachBatch(
+      [&](const auto& batch) {
+        const auto timestamps{batch.timestamps()};
+        const auto values{batch.values()};
+        for (size_type run{0}; run < batch.size();) {
+          const auto start{timestamps[run] - timestamps[run] % width};
+          auto end{run + 1};
+          while (end < batch.size() && timestamps[end] - start < width) {
+            ++end;
+          }
+          bucket(start).merge(aggregateValues(values.subspan(run, end - run)));
+          run = end;
+        }
+      },
+      [&](const auto& block_stats, Timestamp block_start) {
+        bucket(block_start).merge(block_stats);
+      },
+      [width](const TimeRange& time_range) {
+        return time_range.lower() / width == time_range.upper() / width;
+      }
+    );
+    return buckets;
+  }
+
+  /**
+   * @brief Get the value of an aggregate function from statistics.
+   * 
+   * @param function Aggregate function.
+   * @param stats Non-empty statistics.
+   * @return double Value.
    */
-  [[nodiscard]] result_type get_nonempty_filtered_range() const {
-    auto filtered_range{get_filtered_range()};
-    if (filtered_range.empty()) {
+  [[nodiscard]] static double aggregate_value(
+    AggregateFunction function,
+    const SeriesStats<TValue>& stats
+  ) noexcept {
+    switch (function) {
+    case AggregateFunction::COUNT:
+      return static_cast<double>(stats.count);
+    case AggregateFunction::SUM:
+      return static_cast<double>(stats.sum);
+    case AggregateFunction::AVG:
+      return static_cast<double>(stats.sum) / stats.count;
+    case AggregateFunction::MIN:
+      return static_cast<double>(stats.min);
+    case AggregateFunction::MAX:
+      return static_cast<double>(stats.max);
+    }
+    return 0.0;
+  }
+
+  /**
+   * @brief Get the values of several aggregate functions from statistics.
+   * 
+   * @param functions Aggregate functions.
+   * @param stats Statistics, non-empty unless every function is COUNT.
+   * @return std::vector<double> Values, in order.
+   */
+  [[nodiscard]] static std::vector<double> aggregate_values(
+    const std::vector<AggregateFunction>& functions,
+    const SeriesStats<TValue>& stats
+  ) {
+    std::vector<double> values;
+    values.reserve(functions.size());
+    for (const auto function : functions) {
+      values.push_back(aggregate_value(function, stats));
+    }
+    return values;
+  }
+
+  /**
+   * @brief Ensure that at least one aggregate function was given.
+   * 
+   * @param functions Aggregate functions.
+   * 
+   * @throw std::runtime_error If no functions are given.
+   */
+  static void check_functions(const std::vector<AggregateFunction>& functions) {
+    if (functions.empty()) {
       throw std::runtime_error{
-        "QueryBuilder::get_nonempty_filtered_range(): "
-        "Cannot aggregate on empty range."
+        "QueryBuilder::check_functions(): No aggregate functions given."
+      };
+    }
+  }
+
+  /**
+   * @brief Ensure that an aggregated range was non-empty.
+   * 
+   * @param count Number of entries in the range.
+   * 
+   * @throw std::runtime_error If the range is empty.
+   */
+  static void check_nonempty(size_type count) {
+    if (count == 0) {
+      throw std::runtime_error{
+        "QueryBuilder::check_nonempty(): Cannot aggregate on empty range."
       };
     }
-    return filtered_range;
   }
 
   /**
@@ -605,7 +1640,7 @@ private:
    */
   [[nodiscard]] result_type execute_point_query() const {
     const auto& params{std::get<PointParams>(query_params_)};
-    auto value{lsm_tree_.get(params.key)};
+    auto value{shard_of(params.key).get(params.key)};
     if (!value.has_value()) {
       return {};
     }
@@ -633,7 +1668,7 @@ private:
    */
   [[nodiscard]] result_type execute_put_query() {
     const auto& params{std::get<PutParams>(query_params_)};
-    lsm_tree_.put(params.key, params.value);
+    shard_of(params.key).put(params.key, params.value);
     return {};
   }
 
@@ -646,10 +1681,95 @@ private:
    */
   [[nodiscard]] result_type execute_remove_query() {
     const auto& params{std::get<RemoveParams>(query_params_)};
-    lsm_tree_.remove(params.key);
+    shard_of(params.key).remove(params.key);
+    return {};
+  }
+
+  /**
+   * @brief Execute a range remove query.
+   * 
+   * @return result_type Result of the range remove query.
+   * 
+   * @throw std::runtime_error If writing the range tombstone fails.
+   */
+  [[nodiscard]] result_type execute_remove_range_query() {
+    const auto& params{std::get<RemoveRangeParams>(query_params_)};
+    for (auto* shard : shards_) {
+      shard->removeRange(params.range_tombstone);
+    }
     return {};
   }
 
+  /**
+   * @brief Arena of a read, which the query's scratch containers are taken
+   * from while it lives.
+   * @details Only the outermost of nested reads sets up an arena. Results
+   * are never taken from it, since they outlive the read.
+   * 
+   */
+  class ReadArena {
+  public:
+    /**
+     * @brief Construct a new ReadArena object.
+     * 
+     * @param query Query.
+     */
+    explicit ReadArena(const QueryBuilder& query) noexcept : query_{query} {
+      if (query_.arena_resource_ == nullptr) {
+        query_.arena_resource_ = arena_.emplace().resource();
+      }
+    }
+
+    /**
+     * @brief Deleted copy constructor.
+     * 
+     */
+    ReadArena(const ReadArena&) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator.
+     * 
+     */
+    ReadArena& operator=(const ReadArena&) = delete;
+
+    /**
+     * @brief Destroy the ReadArena object.
+     * @details Frees the scratch containers of the read, if it set up the
+     * arena.
+     * 
+     */
+    ~ReadArena() noexcept {
+      if (arena_) {
+        query_.arena_resource_ = nullptr;
+      }
+    }
+
+  private:
+    /**
+     * @brief Query.
+     * 
+     */
+    const QueryBuilder& query_;
+
+    /**
+     * @brief Arena, if this is the outermost read.
+     * 
+     */
+    std::optional<QueryArena> arena_;
+  };
+
+  /**
+   * @brief Get the resource of the query's scratch containers.
+   * 
+   * @return std::pmr::memory_resource* Resource of the current read's arena,
+   * or the default resource outside of a read.
+   */
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+    return arena_resource_ == nullptr
+      ? std::pmr::get_default_resource()
+      : arena_resource_;
+  }
+
   /**
    * @brief Validate tags.
    * @details Checks if all the tag keys are in the tag columns.
@@ -678,7 +1798,7 @@ private:
    * 
    * @throw std::runtime_error If a tag key is not in the tag columns.
    */
-  template <AllSameNoCVRefQuals<Tag>... Tags>
+  template <AllConvertibleToNoCVRefQuals<Tag>... Tags>
   void validate_tags(const Tags&... tags) const {
     for (const auto& [key, value] : std::initializer_list<Tag>{tags...}) {
       if (!tag_columns_.contains(key)) {
@@ -691,10 +1811,10 @@ private:
   }
 
   /**
-   * @brief Reference to the LSMTree to query.
+   * @brief Shards of the LSMTree to query, in order of shard index.
    * 
    */
-  LSMTree<TValue>& lsm_tree_;
+  std::vector<LSMTree<TValue>*> shards_;
 
   /**
    * @brief Tag columns of the Table.
@@ -715,10 +1835,29 @@ private:
   QueryParams query_params_;
 
   /**
-   * @brief Filters for the TimeSeriesKeys.
+   * @brief Predicate on the TimeSeriesKeys, pushed down into the scans.
+   * 
+   */
+  KeyPredicate predicate_;
+
+  /**
+   * @brief Order of the entries returned.
+   * 
+   */
+  QueryOrder order_{QueryOrder::TIMESTAMP_ASC};
+
+  /**
+   * @brief Maximum number of entries returned, if any.
+   * 
+   */
+  std::optional<size_type> limit_;
+
+  /**
+   * @brief Resource of the arena of the current read, or null outside of a
+   * read.
    * 
    */
-  std::vector<TimeSeriesKeyFilter> filters_;
+  mutable std::pmr::memory_resource* arena_resource_{nullptr};
 };
 }  // namespace vkdb
 
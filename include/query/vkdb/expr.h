@@ -8,6 +8,14 @@
 #include <variant>
 
 namespace vkdb {
+/**
+ * @brief Parameter bound to a placeholder of a prepared statement.
+ * @details Timestamps take an integer, values an integer or a double, and tag
+ * values a string.
+ * 
+ */
+using Parameter = std::variant<int64_t, double, std::string>;
+
 /**
  * @brief Metric expression.
  * 
@@ -80,6 +88,18 @@ struct TagColumnsExpr {
   std::vector<TagKeyExpr> keys;
 };
 
+/**
+ * @brief Value type expression.
+ * 
+ */
+struct ValueTypeExpr {
+  /**
+   * @brief Token.
+   * 
+   */
+  Token token;
+};
+
 /**
  * @brief Tag value expression.
  * 
@@ -134,6 +154,48 @@ struct WhereClause {
   TagListExpr tag_list;
 };
 
+/**
+ * @brief Every clause.
+ * 
+ */
+struct EveryClause {
+  /**
+   * @brief Bucket width expression.
+   * 
+   */
+  TimestampExpr width;
+};
+
+/**
+ * @brief Order clause.
+ * 
+ */
+struct OrderClause {
+  /**
+   * @brief Token of what to order by, TIMESTAMP or VALUE.
+   * 
+   */
+  Token key;
+
+  /**
+   * @brief Optional token of the direction, ASC or DESC.
+   * 
+   */
+  std::optional<Token> direction;
+};
+
+/**
+ * @brief Limit clause.
+ * 
+ */
+struct LimitClause {
+  /**
+   * @brief Token of the maximum number of entries.
+   * 
+   */
+  Token count;
+};
+
 /**
  * @brief All clause.
  * 
@@ -168,6 +230,12 @@ struct BetweenClause {
    * 
    */
   std::optional<WhereClause> where_clause;
+
+  /**
+   * @brief Optional every clause.
+   * 
+   */
+  std::optional<EveryClause> every_clause;
 };
 
 /**
@@ -200,6 +268,18 @@ struct SelectTypeDataExpr {
   Token token;
 };
 
+/**
+ * @brief Select type last expression.
+ * 
+ */
+struct SelectTypeLastExpr {
+  /**
+   * @brief Token for the select type last.
+   * 
+   */
+  Token token;
+};
+
 /**
  * @brief Select type count expression.
  * 
@@ -260,19 +340,73 @@ struct SelectTypeMaxExpr {
   Token token;
 };
 
+/**
+ * @brief Select type percentile expression.
+ * 
+ */
+struct SelectTypePercentileExpr {
+  /**
+   * @brief Token for the select type percentile.
+   * 
+   */
+  Token token;
+
+  /**
+   * @brief Tokens for the percentiles, in order.
+   * 
+   */
+  std::vector<Token> percentiles;
+};
+
+/**
+ * @brief Select type approximate distinct count expression.
+ * 
+ */
+struct SelectTypeApproxCountDistinctExpr {
+  /**
+   * @brief Token for the select type approximate distinct count.
+   * 
+   */
+  Token token;
+};
+
+/**
+ * @brief Select type aggregates expression.
+ * @details Several aggregates, computed together in one pass.
+ * 
+ */
+struct SelectTypeAggregatesExpr {
+  /**
+   * @brief Token for the first aggregate function.
+   * 
+   */
+  Token token;
+
+  /**
+   * @brief Tokens for the aggregate functions, in order.
+   * 
+   */
+  std::vector<Token> functions;
+};
+
 /**
  * @brief Select type.
- * @details Variant of select type data, count, average, sum, minimum, and
- * maximum expressions.
+ * @details Variant of select type data, last, count, average, sum,
+ * minimum, maximum, percentile, approximate distinct count, and aggregates
+ * expressions.
  * 
  */
 using SelectType = std::variant<
   SelectTypeDataExpr,
+  SelectTypeLastExpr,
   SelectTypeCountExpr,
   SelectTypeAvgExpr,
   SelectTypeSumExpr,
   SelectTypeMinExpr,
-  SelectTypeMaxExpr
+  SelectTypeMaxExpr,
+  SelectTypePercentileExpr,
+  SelectTypeApproxCountDistinctExpr,
+  SelectTypeAggregatesExpr
 >;  
 
 /**
@@ -314,6 +448,18 @@ struct SelectQuery {
    * 
    */
   SelectClause clause;
+
+  /**
+   * @brief Optional order clause.
+   * 
+   */
+  std::optional<OrderClause> order_clause;
+
+  /**
+   * @brief Optional limit clause.
+   * 
+   */
+  std::optional<LimitClause> limit_clause;
 };
 
 
@@ -353,8 +499,59 @@ struct PutQuery {
   std::optional<TagListExpr> tag_list;
 };
 
+/**
+ * @brief Row of a put values query.
+ * 
+ */
+struct ValueRowExpr {
+  /**
+   * @brief Timestamp expression.
+   * 
+   */
+  TimestampExpr timestamp;
+
+  /**
+   * @brief Value expression.
+   * 
+   */
+  ValueExpr value;
+};
+
+/**
+ * @brief Put values query.
+ * @details Puts many rows of one series at once.
+ * 
+ */
+struct PutValuesQuery {
+  /**
+   * @brief Metric expression.
+   * 
+   */
+  MetricExpr metric;
+
+  /**
+   * @brief Table name expression.
+   * 
+   */
+  TableNameExpr table_name;
+
+  /**
+   * @brief Optional tag list expression.
+   * 
+   */
+  std::optional<TagListExpr> tag_list;
+
+  /**
+   * @brief Rows.
+   * 
+   */
+  std::vector<ValueRowExpr> rows;
+};
+
 /**
  * @brief Delete query.
+ * @details Deletes a single key, or every key of a series over a timestamp
+ * range if an end timestamp is given.
  * 
  */
 struct DeleteQuery {
@@ -365,7 +562,7 @@ struct DeleteQuery {
   MetricExpr metric;
 
   /**
-   * @brief Timestamp expression.
+   * @brief Timestamp expression, or the start of the range.
    * 
    */
   TimestampExpr timestamp;
@@ -381,6 +578,12 @@ struct DeleteQuery {
    * 
    */
   std::optional<TagListExpr> tag_list;
+
+  /**
+   * @brief Optional end timestamp expression of the range.
+   * 
+   */
+  std::optional<TimestampExpr> end_timestamp{};
 };
 
 /**
@@ -399,6 +602,12 @@ struct CreateQuery {
    * 
    */
   std::optional<TagColumnsExpr> tag_columns;
+
+  /**
+   * @brief Optional value type expression.
+   * 
+   */
+  std::optional<ValueTypeExpr> value_type;
 };
 
 /**
@@ -461,17 +670,35 @@ struct TablesQuery {
   Token token;
 };
 
+/**
+ * @brief Stats query.
+ * 
+ */
+struct StatsQuery {
+  /**
+   * @brief Token for the stats query.
+   * 
+   */
+  Token token;
+
+  /**
+   * @brief Table name expression, if the stats are of one table.
+   * 
+   */
+  std::optional<TableNameExpr> table_name;
+};
+
 /**
  * @brief Query expression.
- * @details Variant of select, put, delete, create, drop, add, remove, and
- * tables queries.
+ * @details Variant of select, put, delete, create, drop, add, remove,
+ * tables, and stats queries.
  * 
  */
 using Query = std::variant<
-  SelectQuery, PutQuery, DeleteQuery,
+  SelectQuery, PutQuery, PutValuesQuery, DeleteQuery,
   CreateQuery, DropQuery, 
   AddQuery, RemoveQuery,
-  TablesQuery
+  TablesQuery, StatsQuery
 >;
 
 /**
@@ -28,12 +28,33 @@ public:
    * 
    * @param lsm_tree Reference to the LSMTree to query.
    * @param tag_columns Reference to the tag columns of the Table.
+   * @param query_pool Pool that runs asynchronous queries, or null to run
+   * them on the awaiting thread.
    */
   explicit FriendlyQueryBuilder(
     LSMTree<TValue>& lsm_tree,
-    const TagColumns& tag_columns
+    const TagColumns& tag_columns,
+    ThreadPool* query_pool = nullptr
   ) noexcept
-   : query_builder_{QueryBuilder<TValue>(lsm_tree, tag_columns)} {}
+   : query_builder_{QueryBuilder<TValue>(lsm_tree, tag_columns)}
+   , query_pool_{query_pool} {}
+
+  /**
+   * @brief Construct a new FriendlyQueryBuilder object over the shards of a
+   * sharded LSM tree.
+   * 
+   * @param lsm_tree Reference to the sharded LSM tree to query.
+   * @param tag_columns Reference to the tag columns of the Table.
+   * @param query_pool Pool that runs asynchronous queries, or null to run
+   * them on the awaiting thread.
+   */
+  explicit FriendlyQueryBuilder(
+    ShardedLSMTree<TValue>& lsm_tree,
+    const TagColumns& tag_columns,
+    ThreadPool* query_pool = nullptr
+  ) noexcept
+   : query_builder_{QueryBuilder<TValue>(lsm_tree, tag_columns)}
+   , query_pool_{query_pool} {}
 
   /**
    * @brief Construct a new FriendlyQueryBuilder object.
@@ -234,6 +255,35 @@ public:
     return *this;
   }
 
+  /**
+   * @brief Order the data points returned by the query.
+   * @details Data points are returned in key order, oldest first, by
+   * default. Only applies to execute().
+   * 
+   * @param order Order.
+   * @return FriendlyQueryBuilder& Reference to this FriendlyQueryBuilder
+   * object.
+   */
+  [[nodiscard]] FriendlyQueryBuilder& orderBy(QueryOrder order) noexcept {
+    std::ignore = query_builder_.orderBy(order);
+    return *this;
+  }
+
+  /**
+   * @brief Limit the number of data points returned by the query.
+   * @details The first data points in the query's order are kept, and the
+   * range is read no further than needed to find them. Only applies to
+   * execute().
+   * 
+   * @param limit Maximum number of data points.
+   * @return FriendlyQueryBuilder& Reference to this FriendlyQueryBuilder
+   * object.
+   */
+  [[nodiscard]] FriendlyQueryBuilder& limit(size_type limit) noexcept {
+    std::ignore = query_builder_.limit(limit);
+    return *this;
+  }
+
   /**
    * @brief Configure builder for put query.
    * @details Adds a put query to the query builder.
@@ -287,6 +337,30 @@ public:
     return *this;
   }
 
+  /**
+   * @brief Configure builder for range remove query.
+   * @details Adds a range remove query to the query builder, which removes
+   * every key of the series in the timestamp range.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param metric Metric of the keys.
+   * @param tag_table Tags that the keys must have.
+   * @return FriendlyQueryBuilder& Reference to this FriendlyQueryBuilder
+   * object.
+   * 
+   * @throw std::exception If the range remove query fails.
+   */
+  [[nodiscard]] FriendlyQueryBuilder& removeRange(
+    Timestamp start,
+    Timestamp end,
+    const Metric& metric,
+    const TagTable& tag_table = {}
+  ) {
+    std::ignore = query_builder_.removeRange(start, end, metric, tag_table);
+    return *this;
+  }
+
   /**
    * @brief Count the number of entries in the range.
    * @details Sets up the QueryBuilder for aggregation and returns the number
@@ -305,11 +379,11 @@ public:
    * @details Sets up the QueryBuilder for aggregation and returns the sum of
    * the values in the range.
    * 
-   * @return TValue Sum of the values in the range.
+   * @return StatsSum<TValue> Sum of the values in the range.
    * 
    * @throw std::runtime_error If the sum query fails.
    */
-  [[nodiscard]] TValue sum() {
+  [[nodiscard]] StatsSum<TValue> sum() {
     return query_builder_.sum();
   }
 
@@ -352,6 +426,132 @@ public:
     return query_builder_.max();
   }
 
+  /**
+   * @brief Aggregate the values in the range in fixed-width time buckets.
+   * @details Sets up the QueryBuilder for aggregation and returns the start
+   * and value of each non-empty bucket, in time order.
+   * 
+   * @param function Aggregate function.
+   * @param width Width of each bucket.
+   * @return std::vector<TimeBucket> Buckets.
+   * 
+   * @throw std::runtime_error If the bucketed query fails.
+   */
+  [[nodiscard]] std::vector<TimeBucket> aggregateEvery(
+    AggregateFunction function,
+    Timestamp width
+  ) {
+    return query_builder_.aggregateEvery(function, width);
+  }
+
+  /**
+   * @brief Estimate a percentile of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation and streams the range
+   * into a quantile sketch.
+   * 
+   * @param percentile Percentile, in [0, 100].
+   * @return double Estimate of the value at the percentile.
+   * 
+   * @throw std::runtime_error If the percentile query fails.
+   * @throw std::invalid_argument If the percentile is not in [0, 100].
+   */
+  [[nodiscard]] double percentile(double percentile) {
+    return query_builder_.percentile(percentile);
+  }
+
+  /**
+   * @brief Estimate several percentiles of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation and streams the range
+   * once into a quantile sketch.
+   * 
+   * @param percentiles Percentiles, each in [0, 100].
+   * @return std::vector<double> Estimate of the value at each percentile, in
+   * order.
+   * 
+   * @throw std::runtime_error If the percentile query fails.
+   * @throw std::invalid_argument If a percentile is not in [0, 100].
+   */
+  [[nodiscard]] std::vector<double> percentiles(
+    const std::vector<double>& percentiles
+  ) {
+    return query_builder_.percentiles(percentiles);
+  }
+
+  /**
+   * @brief Estimate the number of distinct values in the range.
+   * @details Sets up the QueryBuilder for aggregation and streams the range
+   * into a distinct sketch.
+   * 
+   * @return size_type Estimate of the number of distinct values.
+   * 
+   * @throw std::runtime_error If the distinct count query fails.
+   */
+  [[nodiscard]] size_type approxCountDistinct() {
+    return query_builder_.approxCountDistinct();
+  }
+
+  /**
+   * @brief Estimate the number of distinct values of a tag in the range.
+   * @details Sets up the QueryBuilder for aggregation and streams the range
+   * into a distinct sketch.
+   * 
+   * @param tag_key Tag key.
+   * @return size_type Estimate of the number of distinct values of the tag.
+   * 
+   * @throw std::runtime_error If the distinct count query fails.
+   */
+  [[nodiscard]] size_type approxCountDistinct(const TagKey& tag_key) {
+    return query_builder_.approxCountDistinct(tag_key);
+  }
+
+  /**
+   * @brief Compute several aggregates of the values in the range.
+   * @details Sets up the QueryBuilder for aggregation and computes every
+   * aggregate in one pass over the range.
+   * 
+   * @param functions Aggregate functions.
+   * @return std::vector<double> Value of each aggregate function, in order.
+   * 
+   * @throw std::runtime_error If the aggregate query fails.
+   */
+  [[nodiscard]] std::vector<double> aggregate(
+    const std::vector<AggregateFunction>& functions
+  ) {
+    return query_builder_.aggregate(functions);
+  }
+
+  /**
+   * @brief Compute several aggregates of the values in the range in
+   * fixed-width time buckets.
+   * @details Sets up the QueryBuilder for aggregation and returns the start
+   * and aggregate values of each non-empty bucket, in time order.
+   * 
+   * @param functions Aggregate functions.
+   * @param width Width of each bucket.
+   * @return std::vector<TimeBucketAggregates> Buckets.
+   * 
+   * @throw std::runtime_error If the bucketed query fails.
+   */
+  [[nodiscard]] std::vector<TimeBucketAggregates> aggregateEvery(
+    const std::vector<AggregateFunction>& functions,
+    Timestamp width
+  ) {
+    return query_builder_.aggregateEvery(functions, width);
+  }
+
+  /**
+   * @brief Get the newest data point of each series in the range.
+   * @details Answered from the latest-value index without scanning the
+   * range.
+   * 
+   * @return result_type Newest data point of each series.
+   * 
+   * @throw std::runtime_error If the latest-value query fails.
+   */
+  [[nodiscard]] result_type latest() {
+    return to_data_points(query_builder_.latest());
+  }
+
   /**
    * @brief Execute the query.
    * @details Executes the query and returns the result.
@@ -361,8 +561,82 @@ public:
    * @throw std::runtime_error If executing the query fails.
    */
   result_type execute(){
-    auto result{query_builder_.execute() |
-    std::views::transform([](const auto& entry) {
+    return to_data_points(query_builder_.execute());
+  }
+
+  /**
+   * @brief Visit every entry of the query as it is read.
+   * @details See QueryBuilder::forEach(). Entries are visited as keys, not
+   * data points, so that streaming them does not copy their tags.
+   * 
+   * @tparam OnEntry Entry visitor type.
+   * @param on_entry Called with the key and value of each entry.
+   * 
+   * @throw std::runtime_error If the query fails.
+   */
+  template <typename OnEntry>
+  void forEach(OnEntry&& on_entry) {
+    query_builder_.forEach(std::forward<OnEntry>(on_entry));
+  }
+
+  /**
+   * @brief Execute the query on a pool, as a coroutine.
+   * @details The query is copied into the coroutine, which moves onto the
+   * pool once awaited, so the awaiting thread never blocks on reading
+   * SSTables. The awaiting coroutine is resumed on the pool's thread. The
+   * table and the pool must outlive the coroutine.
+   * 
+   * @param pool Pool.
+   * @return Task<result_type> Result of the query.
+   * 
+   * @throw std::runtime_error If executing the query fails, once awaited.
+   */
+  [[nodiscard]] Task<result_type> executeAsync(ThreadPool& pool) const {
+    return execute_async(*this, &pool);
+  }
+
+  /**
+   * @brief Execute the query on the table's query pool, as a coroutine.
+   * @details Runs on the awaiting thread if the table has no query pool.
+   * 
+   * @return Task<result_type> Result of the query.
+   * 
+   * @throw std::runtime_error If executing the query fails, once awaited.
+   */
+  [[nodiscard]] Task<result_type> executeAsync() const {
+    return execute_async(*this, query_pool_);
+  }
+
+private:
+  /**
+   * @brief Execute a query on a pool.
+   * 
+   * @param query Query.
+   * @param pool Pool, or null to run on the awaiting thread.
+   * @return Task<result_type> Result of the query.
+   * 
+   * @throw std::runtime_error If executing the query fails.
+   */
+  static Task<result_type> execute_async(
+    FriendlyQueryBuilder query,
+    ThreadPool* pool
+  ) {
+    if (pool != nullptr) {
+      co_await pool->schedule();
+    }
+    co_return query.execute();
+  }
+
+  /**
+   * @brief Convert entries to data points.
+   * 
+   * @param entries Live entries.
+   * @return result_type Data points.
+   */
+  [[nodiscard]] static result_type to_data_points(
+    const typename QueryBuilder<TValue>::result_type& entries
+  ) {
+    auto result{entries | std::views::transform([](const auto& entry) {
       return DataPoint<TValue>{
         entry.first.timestamp(),
         entry.first.metric(),
@@ -373,12 +647,17 @@ public:
     return {result.begin(), result.end()};
   }
 
-private:
   /**
    * @brief Underlying QueryBuilder.
    * 
    */
   QueryBuilder<TValue> query_builder_;
+
+  /**
+   * @brief Pool that runs asynchronous queries, or null.
+   * 
+   */
+  ThreadPool* query_pool_{nullptr};
 };
 }  // namespace vkdb
 
@@ -2,9 +2,13 @@
 #define QUERY_INTERPRETER_H
 
 #include <vkdb/friendly_builder.h>
+#include <vkdb/table.h>
 #include <vkdb/expr.h>
+#include <vkdb/result_writer.h>
 #include <sstream>
 #include <iostream>
+#include <map>
+#include <span>
 #include <string>
 #include <variant>
 
@@ -65,6 +69,12 @@ using TagListExprResult = TagTable;
  */
 using TagColumnsExprResult = TagColumns;
 
+/**
+ * @brief Type alias for ValueType.
+ * 
+ */
+using ValueTypeExprResult = ValueType;
+
 /**
  * @brief Type alias for a vector of DataPoint<double>.
  * 
@@ -83,15 +93,37 @@ using SelectDoubleResult = double;
  */
 using SelectCountResult = uint64_t;
 
+/**
+ * @brief Type alias for a vector of TimeBucket.
+ * 
+ */
+using SelectBucketsResult = std::vector<TimeBucket>;
+
+/**
+ * @brief Type alias for a vector of double.
+ * 
+ */
+using SelectAggregatesResult = std::vector<double>;
+
+/**
+ * @brief Type alias for a vector of TimeBucketAggregates.
+ * 
+ */
+using SelectAggregateBucketsResult = std::vector<TimeBucketAggregates>;
+
 /**
  * @brief Select result.
- * @details Variant of select data, double, and count results.
+ * @details Variant of select data, double, count, buckets, aggregates, and
+ * aggregate buckets results.
  * 
  */
 using SelectResult = std::variant<
   SelectDataResult,
   SelectDoubleResult,
-  SelectCountResult
+  SelectCountResult,
+  SelectBucketsResult,
+  SelectAggregatesResult,
+  SelectAggregateBucketsResult
 >;
 
 /**
@@ -112,16 +144,35 @@ using WhereClauseResult = TagListExprResult;
  */
 using AllClauseResult = std::optional<WhereClauseResult>;
 
+/**
+ * @brief Type alias for TimestampExprResult.
+ * 
+ */
+using EveryClauseResult = TimestampExprResult;
+
+/**
+ * @brief Type alias for QueryOrder.
+ * 
+ */
+using OrderClauseResult = QueryOrder;
+
+/**
+ * @brief Type alias for the maximum number of entries.
+ * 
+ */
+using LimitClauseResult = uint64_t;
+
 /**
  * @brief Between clause result.
- * @details Tuple of start timestamp, end timestamp, and optional where clause
- * result.
+ * @details Tuple of start timestamp, end timestamp, optional where clause
+ * result, and optional every clause result.
  * 
  */
 using BetweenClauseResult = std::tuple<
   TimestampExprResult,
   TimestampExprResult,
-  std::optional<WhereClauseResult>
+  std::optional<WhereClauseResult>,
+  std::optional<EveryClauseResult>
 >;
 
 /**
@@ -188,23 +239,23 @@ using RemoveResult = void;
 using TablesResult = std::vector<std::string>;
 
 /**
- * @brief Output result.
- * @details Variant of select and tables results.
+ * @brief Type alias for a map from table names to storage stats.
  * 
  */
-using OutputResult = std::variant<SelectResult, TablesResult>;
+using StatsResult = std::map<TableName, StorageStats>;
 
 /**
- * @brief Type alias for optional OutputResult.
+ * @brief Output result.
+ * @details Variant of select, tables, and stats results.
  * 
  */
-using Result = std::optional<OutputResult>;
+using OutputResult = std::variant<SelectResult, TablesResult, StatsResult>;
 
 /**
- * @brief Type alias for vector of results.
+ * @brief Type alias for optional OutputResult.
  * 
  */
-using Results = std::vector<Result>;
+using Result = std::optional<OutputResult>;
 
 /**
  * @brief Database name used by standalone interpreter.
@@ -268,15 +319,25 @@ public:
    * 
    * @param database Database.
    * @param callback Error callback.
+   * @param parameters Parameters bound to the placeholders, which must
+   * outlive the interpreter.
+   * @param format Format of the data points in the output.
    */
   explicit Interpreter(
     Database& database,
-    error_callback callback = [](const RuntimeError&) {}
+    error_callback callback = [](const RuntimeError&) {},
+    std::span<const Parameter> parameters = {},
+    OutputFormat format = OutputFormat::TEXT
   ) noexcept;
 
   /**
    * @brief Interpret the expression.
-   * @details Defaults the output stream to std::cout.
+   * @details Defaults the output stream to std::cout. Each query's result is
+   * written through a ResultWriter as soon as the query runs, and the data
+   * points of a SELECT DATA query without an order or a limit are written
+   * as they are scanned, so they are never held in memory together. A
+   * runtime error stops the expression, once the output of the queries
+   * before it is written.
    * 
    * @param expr Expression.
    * @param stream Stream.
@@ -287,6 +348,16 @@ public:
   ) const noexcept;
 
 private:
+  /**
+   * @brief Write the output result.
+   * @details Data points are written in the output format, and every other
+   * result as a line of text.
+   * 
+   * @param result Output result.
+   * @param writer Result writer.
+   */
+  void write(const OutputResult& result, ResultWriter& writer) const;
+
   /**
    * @brief Convert the output result to a string.
    * 
@@ -303,6 +374,16 @@ private:
    */
   [[nodiscard]] std::string to_string(const SelectResult& result) const;
 
+  /**
+   * @brief Convert aggregate values to a comma-separated string.
+   * 
+   * @param values Aggregate values.
+   * @return std::string String.
+   */
+  [[nodiscard]] static std::string aggregates_to_string(
+    const std::vector<double>& values
+  );
+
   /**
    * @brief Convert the tables result to a string.
    * 
@@ -312,13 +393,35 @@ private:
   [[nodiscard]] std::string to_string(const TablesResult& result) const;
 
   /**
-   * @brief Visit the expression.
-   * @details Interprets the expression.
+   * @brief Convert the stats result to a string.
+   * @details One stat per line, as its table, name, and value.
    * 
-   * @param expr Expression.
-   * @return Results Results.
+   * @param result Stats result.
+   * @return std::string String.
+   */
+  [[nodiscard]] std::string to_string(const StatsResult& result) const;
+
+  /**
+   * @brief Interpret the query and write its result.
+   * 
+   * @param query Query.
+   * @param writer Result writer.
+   * 
+   * @throws RuntimeError If the query fails.
    */
-  [[nodiscard]] Results visit(const Expr& expr) const;
+  void stream(const Query& query, ResultWriter& writer) const;
+
+  /**
+   * @brief Interpret the select query and write its result.
+   * @details The data points of a SELECT DATA query are written as the
+   * query builder visits them.
+   * 
+   * @param query Select query.
+   * @param writer Result writer.
+   * 
+   * @throws RuntimeError If the select query fails.
+   */
+  void stream(const SelectQuery& query, ResultWriter& writer) const;
 
   /**
    * @brief Visit the query.
@@ -332,29 +435,66 @@ private:
   /**
    * @brief Add an optional tag list to the query builder.
    * 
+   * @tparam TValue Value type of the table.
    * @param query_builder Query builder.
    * @param tag_list Optional tag list.
    */
+  template <ArithmeticNoCVRefQuals TValue>
   static void add_optional_tag_list(
-    FriendlyQueryBuilder<double> &query_builder,
+    FriendlyQueryBuilder<TValue> &query_builder,
     const std::optional<TagListExprResult>& tag_list
   ) noexcept;
   
+  /**
+   * @brief Get the aggregate functions of a select type aggregates
+   * expression.
+   * 
+   * @param type Select type aggregates expression.
+   * @return std::vector<AggregateFunction> Aggregate functions, in order.
+   */
+  [[nodiscard]] static std::vector<AggregateFunction> aggregate_functions(
+    const SelectTypeAggregatesExpr& type
+  );
+
   /**
    * @brief Handle the select type.
+   * @details Values of tables of other types than doubles are converted to
+   * doubles.
    * 
+   * @tparam TValue Value type of the table.
    * @param query_builder Query builder.
    * @param type Select type.
    * @return SelectResult Select result.
    * 
    * @throws RuntimeError If select query fails.
    */
+  template <ArithmeticNoCVRefQuals TValue>
   [[nodiscard]]
   static SelectResult handle_select_type(
-    FriendlyQueryBuilder<double> &query_builder,
+    FriendlyQueryBuilder<TValue> &query_builder,
     SelectType type
   );
 
+  /**
+   * @brief Handle the select type of a bucketed select query.
+   * 
+   * @tparam TValue Value type of the table.
+   * @param query_builder Query builder.
+   * @param type Select type.
+   * @param width Bucket width.
+   * @return SelectResult Select result.
+   * 
+   * @throws RuntimeError If the select type cannot be bucketed or the select
+   * query fails.
+   */
+  template <ArithmeticNoCVRefQuals TValue>
+  [[nodiscard]]
+  static SelectResult handle_bucketed_select_type(
+    FriendlyQueryBuilder<TValue> &query_builder,
+    SelectType type,
+    Timestamp width
+  );
+
   /**
    * @brief Visit the select query.
    * @details Interprets the select query.
@@ -366,6 +506,45 @@ private:
    */
   [[nodiscard]] SelectResult visit(const SelectQuery& query) const;
 
+  /**
+   * @brief Set up the query builder of a select query, and call a visitor
+   * with it.
+   * @details Applies the metric, the select clause, and the order and limit
+   * clauses of the query, to a query builder of the value type of the
+   * table, as given by Table::visitQuery().
+   * 
+   * @tparam TVisitor Visitor type.
+   * @param query Select query.
+   * @param visitor Visitor, called with the query builder, and the bucket
+   * width if the query has an EVERY clause.
+   * @return decltype(auto) Result of the visitor.
+   * 
+   * @throws RuntimeError If a clause is invalid or the table does not exist.
+   */
+  template <typename TVisitor>
+  decltype(auto) visit_select_builder(
+    const SelectQuery& query,
+    TVisitor&& visitor
+  ) const;
+
+  /**
+   * @brief Apply the metric, the select clause, and the order and limit
+   * clauses of a select query to a query builder.
+   * 
+   * @tparam TValue Value type of the table.
+   * @param query_builder Query builder.
+   * @param query Select query.
+   * @return std::optional<EveryClauseResult> Bucket width, if the query has
+   * an EVERY clause.
+   * 
+   * @throws RuntimeError If a clause is invalid.
+   */
+  template <ArithmeticNoCVRefQuals TValue>
+  [[nodiscard]] std::optional<EveryClauseResult> select_clauses(
+    FriendlyQueryBuilder<TValue>& query_builder,
+    const SelectQuery& query
+  ) const;
+
   /**
    * @brief Visit the put query.
    * @details Interprets the put query.
@@ -376,6 +555,17 @@ private:
    */
   PutResult visit(const PutQuery& query) const;
 
+  /**
+   * @brief Visit the put values query.
+   * @details Resolves the table and the series once, then writes every row
+   * as one batch.
+   * 
+   * @param query Put values query.
+   * 
+   * @throws RuntimeError If put values query fails.
+   */
+  PutResult visit(const PutValuesQuery& query) const;
+
   /**
    * @brief Visit the delete query.
    * @details Interprets the delete query.
@@ -437,6 +627,18 @@ private:
    */
   [[nodiscard]] TablesResult visit(const TablesQuery& query) const;
 
+  /**
+   * @brief Visit the stats query.
+   * @details Gets the storage stats of the table, or of every opened table
+   * if none is given.
+   * 
+   * @param query Stats query.
+   * @return StatsResult Stats result.
+   * 
+   * @throws RuntimeError If the table does not exist.
+   */
+  [[nodiscard]] StatsResult visit(const StatsQuery& query) const;
+
   /**
    * @brief Visit the all clause.
    * @details Interprets the all clause.
@@ -470,6 +672,37 @@ private:
    */
   [[nodiscard]] AtClauseResult visit(const AtClause& clause) const;
 
+  /**
+   * @brief Visit the every clause.
+   * 
+   * @param clause Every clause.
+   * @return EveryClauseResult Every clause result.
+   * 
+   * @throws RuntimeError If the bucket width is invalid.
+   */
+  [[nodiscard]] EveryClauseResult visit(const EveryClause& clause) const;
+
+  /**
+   * @brief Visit the order clause.
+   * @details Ascending if no direction is given.
+   * 
+   * @param clause Order clause.
+   * @return OrderClauseResult Order clause result.
+   */
+  [[nodiscard]] OrderClauseResult visit(
+    const OrderClause& clause
+  ) const noexcept;
+
+  /**
+   * @brief Visit the limit clause.
+   * 
+   * @param clause Limit clause.
+   * @return LimitClauseResult Limit clause result.
+   * 
+   * @throws RuntimeError If the limit is not a non-negative integer.
+   */
+  [[nodiscard]] LimitClauseResult visit(const LimitClause& clause) const;
+
   /**
    * @brief Visit the where clause.
    * 
@@ -523,18 +756,23 @@ private:
    * 
    * @param tag_value Tag value expression.
    * @return TagValueExprResult Tag value expression result.
+   * 
+   * @throws RuntimeError If the parameter is unbound or is not a string.
    */
   [[nodiscard]] TagValueExprResult visit(
     const TagValueExpr& tag_value
-  ) const noexcept;
+  ) const;
 
   /**
    * @brief Visit the tag expression.
    * 
    * @param tag Tag expression.
    * @return TagExprResult Tag expression result.
+   * 
+   * @throws RuntimeError If the tag value's parameter is unbound or is not
+   * a string.
    */
-  [[nodiscard]] TagExprResult visit(const TagExpr& tag) const noexcept;
+  [[nodiscard]] TagExprResult visit(const TagExpr& tag) const;
 
   /**
    * @brief Visit the tag list expression.
@@ -580,6 +818,28 @@ private:
    */
   [[nodiscard]] ValueExprResult visit(const ValueExpr& value) const;
 
+  /**
+   * @brief Visit the value type expression.
+   * 
+   * @param value_type Value type expression.
+   * @return ValueTypeExprResult Value type expression result.
+   * 
+   * @throws RuntimeError If the token is not the name of a value type.
+   */
+  [[nodiscard]] ValueTypeExprResult visit(
+    const ValueTypeExpr& value_type
+  ) const;
+
+  /**
+   * @brief Get the parameter bound to a placeholder.
+   * 
+   * @param token Placeholder token.
+   * @return const Parameter& Parameter.
+   * 
+   * @throws RuntimeError If no parameter is bound to the placeholder.
+   */
+  [[nodiscard]] const Parameter& parameter(const Token& token) const;
+
   /**
    * @brief Error callback.
    * 
@@ -591,6 +851,18 @@ private:
    * 
    */
   Database& database_;
+
+  /**
+   * @brief Parameters bound to the placeholders.
+   * 
+   */
+  std::span<const Parameter> parameters_;
+
+  /**
+   * @brief Format of the data points in the output.
+   * 
+   */
+  OutputFormat format_;
 };
 
 }  // namespace vkdb
@@ -2,42 +2,153 @@
 #define QUERY_LEXER_H
 
 #include <vkdb/token.h>
-#include <vector>
-#include <unordered_map>
+#include <array>
 #include <concepts>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace vkdb {
 /**
- * @brief Mapping of reserved words to their corresponding token types.
+ * @brief Reserved words and their corresponding token types.
  * 
  */
-static const std::unordered_map<Lexeme, TokenType> WORD_TO_TOKEN_TYPE{
-	{"SELECT", TokenType::SELECT},
-	{"PUT", TokenType::PUT},
-	{"DELETE", TokenType::DELETE},
-	{"CREATE", TokenType::CREATE},
-	{"DROP", TokenType::DROP},
-	{"ADD", TokenType::ADD},
-	{"REMOVE", TokenType::REMOVE},
-	{"TABLES", TokenType::TABLES},
-	{"DATA", TokenType::DATA},
-	{"AVG", TokenType::AVG},
-	{"SUM", TokenType::SUM},
-	{"COUNT", TokenType::COUNT},
-	{"MIN", TokenType::MIN},
-	{"MAX", TokenType::MAX},
-	{"TABLE", TokenType::TABLE},
-	{"TAGS", TokenType::TAGS},
-	{"ALL", TokenType::ALL},
-	{"BETWEEN", TokenType::BETWEEN},
-	{"AND", TokenType::AND},
-	{"AT", TokenType::AT},
-	{"WHERE", TokenType::WHERE},
-	{"FROM", TokenType::FROM},
-	{"INTO", TokenType::INTO},
-	{"TO", TokenType::TO}
+inline constexpr auto RESERVED_WORDS{
+  std::to_array<std::pair<std::string_view, TokenType>>({
+  {"SELECT", TokenType::SELECT},
+  {"PUT", TokenType::PUT},
+  {"DELETE", TokenType::DELETE},
+  {"CREATE", TokenType::CREATE},
+  {"DROP", TokenType::DROP},
+  {"ADD", TokenType::ADD},
+  {"REMOVE", TokenType::REMOVE},
+  {"TABLES", TokenType::TABLES},
+  {"SHOW", TokenType::SHOW},
+  {"DATA", TokenType::DATA},
+  {"LAST", TokenType::LAST},
+  {"AVG", TokenType::AVG},
+  {"SUM", TokenType::SUM},
+  {"COUNT", TokenType::COUNT},
+  {"MIN", TokenType::MIN},
+  {"MAX", TokenType::MAX},
+  {"PERCENTILE", TokenType::PERCENTILE},
+  {"APPROX_COUNT_DISTINCT", TokenType::APPROX_COUNT_DISTINCT},
+  {"TABLE", TokenType::TABLE},
+  {"STATS", TokenType::STATS},
+  {"TAGS", TokenType::TAGS},
+  {"ALL", TokenType::ALL},
+  {"BETWEEN", TokenType::BETWEEN},
+  {"AND", TokenType::AND},
+  {"AT", TokenType::AT},
+  {"EVERY", TokenType::EVERY},
+  {"WHERE", TokenType::WHERE},
+  {"FROM", TokenType::FROM},
+  {"INTO", TokenType::INTO},
+  {"TO", TokenType::TO},
+  {"ORDER", TokenType::ORDER},
+  {"BY", TokenType::BY},
+  {"TIMESTAMP", TokenType::TIMESTAMP},
+  {"VALUE", TokenType::VALUE},
+  {"ASC", TokenType::ASC},
+  {"DESC", TokenType::DESC},
+  {"LIMIT", TokenType::LIMIT},
+  {"VALUES", TokenType::VALUES},
+  {"TYPE", TokenType::TYPE}
+  })
 };
 
+/**
+ * @brief Number of slots in the reserved word table.
+ * 
+ */
+inline constexpr uint64_t RESERVED_WORD_SLOTS{128};
+
+/**
+ * @brief Hash a word into the reserved word table.
+ * @details FNV-1a, with a seed mixed into the offset basis.
+ * 
+ * @param word Word.
+ * @param seed Seed.
+ * @return uint64_t Slot of the word.
+ */
+constexpr uint64_t reservedWordSlot(
+  std::string_view word,
+  uint64_t seed
+) noexcept {
+  auto hash{0xcbf29ce484222325 ^ seed};
+  for (const auto ch : word) {
+    hash ^= static_cast<unsigned char>(ch);
+    hash *= 0x100000001b3;
+  }
+  return (hash ^ (hash >> 32)) % RESERVED_WORD_SLOTS;
+}
+
+/**
+ * @brief Find the first seed that hashes every reserved word into its own
+ * slot.
+ * 
+ * @return uint64_t Seed, or RESERVED_WORD_SLOTS * 1024 if none was found.
+ */
+consteval uint64_t findReservedWordSeed() noexcept {
+  for (uint64_t seed{0}; seed < RESERVED_WORD_SLOTS * 1024; ++seed) {
+    std::array<bool, RESERVED_WORD_SLOTS> taken{};
+    auto perfect{true};
+    for (const auto& [word, type] : RESERVED_WORDS) {
+      auto& slot{taken[reservedWordSlot(word, seed)]};
+      if (slot) {
+        perfect = false;
+        break;
+      }
+      slot = true;
+    }
+    if (perfect) {
+      return seed;
+    }
+  }
+  return RESERVED_WORD_SLOTS * 1024;
+}
+
+/**
+ * @brief Seed of the perfect hash of the reserved words.
+ * 
+ */
+inline constexpr uint64_t RESERVED_WORD_SEED{findReservedWordSeed()};
+
+static_assert(
+  RESERVED_WORD_SEED < RESERVED_WORD_SLOTS * 1024,
+  "No perfect hash of the reserved words was found."
+);
+
+/**
+ * @brief Reserved word table, with each word in the slot it hashes to.
+ * 
+ */
+inline constexpr auto RESERVED_WORD_TABLE{[] {
+  std::array<std::pair<std::string_view, TokenType>, RESERVED_WORD_SLOTS>
+    table{};
+  for (const auto& entry : RESERVED_WORDS) {
+    table[reservedWordSlot(entry.first, RESERVED_WORD_SEED)] = entry;
+  }
+  return table;
+}()};
+
+/**
+ * @brief Look up the token type of a word.
+ * @details One hash and one comparison, through the perfect hash of the
+ * reserved words, without allocating.
+ * 
+ * @param word Word.
+ * @return TokenType Token type of the reserved word, or IDENTIFIER if it is
+ * not reserved.
+ */
+constexpr TokenType wordTokenType(std::string_view word) noexcept {
+  const auto& [reserved, type]{
+    RESERVED_WORD_TABLE[reservedWordSlot(word, RESERVED_WORD_SEED)]
+  };
+  return !reserved.empty() && reserved == word ? type : TokenType::IDENTIFIER;
+}
+
 /**
  * @brief Lexer for vq.
  * 
@@ -54,10 +165,11 @@ public:
 
   /**
    * @brief Construct a new Lexer object.
+   * @details The input is not copied, and tokens are cut straight out of it.
    * 
-   * @param input The input string to tokenize.
+   * @param input The input string to tokenize, which must outlive the lexer.
    */
-	explicit Lexer(const std::string& input) noexcept;
+	explicit Lexer(std::string_view input) noexcept;
 
   /**
    * @brief Move-construct a new Lexer object.
@@ -149,18 +261,15 @@ private:
   /**
    * @brief Peek at the current character.
    * 
-   * @return char The current character.
-   * 
-   * @throw std::out_of_range If there are no characters remaining.
+   * @return char The current character, or '\0' if there are no characters
+   * remaining.
    */
   [[nodiscard]] char peek() const;
 
   /**
    * @brief Peek at the next character.
    * 
-   * @return char The next character.
-   * 
-   * @throw std::out_of_range If there are no characters remaining.
+   * @return char The next character, or '\0' if there is none.
    */
   [[nodiscard]] char peek_next() const;
 
@@ -235,6 +344,27 @@ private:
    */
 	[[nodiscard]] Token lex_semicolon() noexcept;
 
+  /**
+   * @brief Lex a left parenthesis.
+   * 
+   * @return Token The token representing the left parenthesis.
+   */
+	[[nodiscard]] Token lex_left_paren() noexcept;
+
+  /**
+   * @brief Lex a right parenthesis.
+   * 
+   * @return Token The token representing the right parenthesis.
+   */
+	[[nodiscard]] Token lex_right_paren() noexcept;
+
+  /**
+   * @brief Lex a placeholder for a parameter.
+   * 
+   * @return Token The token representing the placeholder.
+   */
+	[[nodiscard]] Token lex_placeholder() noexcept;
+
   /**
    * @brief Lex an unknown character.
    * 
@@ -253,11 +383,11 @@ private:
    * @brief Make a lexeme from a starting position.
    * 
    * @param start The starting position.
-   * @return Lexeme The lexeme.
-   * 
-   * @throw std::exception If the substring is out of range.
+   * @return std::string_view The lexeme, as a view into the input.
    */
-	[[nodiscard]] Lexeme make_lexeme_from(size_type start) const;
+	[[nodiscard]] std::string_view make_lexeme_from(
+    size_type start
+  ) const noexcept;
 
   /**
    * @brief Make a token from a token type and lexeme.
@@ -268,14 +398,14 @@ private:
    */
 	[[nodiscard]] Token make_token(
     TokenType type,
-    const Lexeme& lexeme
+    std::string_view lexeme
   ) noexcept;
 
   /**
    * @brief The input string.
    * 
    */
-	std::string input_;
+	std::string_view input_;
 
   /**
    * @brief The current position in the input string.
@@ -37,7 +37,7 @@ public:
    * @param callback The error callback function.
    */
   Parser(
-    const std::vector<Token>& tokens,
+    std::vector<Token> tokens,
     error_callback callback = [](const Token&, const std::string&) {}
   ) noexcept;
 
@@ -48,6 +48,15 @@ public:
    */
   [[nodiscard]] std::optional<Expr> parse() noexcept;
 
+  /**
+   * @brief Gets the number of placeholders parsed so far.
+   * @details Placeholders stand in for timestamps, values, and tag values,
+   * and are numbered in the order they appear.
+   * 
+   * @return The number of placeholders.
+   */
+  [[nodiscard]] size_type parameterCount() const noexcept;
+
 private:
   /**
    * @brief Creates a ParseError with the given token and message.
@@ -56,7 +65,10 @@ private:
    * @param message The error message.
    * @return The ParseError object.
    */
-  [[nodiscard]] ParseError error(Token token, const std::string& message);
+  [[nodiscard]] ParseError error(
+    const Token& token,
+    const std::string& message
+  );
 
   /**
    * @brief Synchronizes the parser state after an error.
@@ -77,7 +89,7 @@ private:
    * 
    * @throws std::exception If there are no previous tokens.
    */
-  [[nodiscard]] Token peek_back() const;
+  [[nodiscard]] const Token& peek_back() const;
 
   /**
    * @brief Peeks at the current token.
@@ -86,14 +98,14 @@ private:
    * 
    * @throws std::exception If there are no tokens to peek.
    */
-  [[nodiscard]] Token peek() const;
+  [[nodiscard]] const Token& peek() const;
 
   /**
    * @brief Advances to the next token.
    * 
    * @return The current token before advancing.
    */
-  Token advance() noexcept;
+  const Token& advance() noexcept;
 
   /**
    * @brief Checks if the current token matches the given type.
@@ -124,6 +136,22 @@ private:
    */
   Token consume(TokenType type, const std::string& message);
 
+  /**
+   * @brief Consumes a token of the given type, or a placeholder.
+   * @details A placeholder is numbered with the index of its parameter.
+   * 
+   * @param type The token type to consume.
+   * @param message The error message if the token type does not match.
+   * @return The consumed token.
+   * 
+   * @throws ParseError If the token is neither of the given type nor a
+   * placeholder.
+   */
+  Token consume_or_placeholder(
+    TokenType type,
+    const std::string& message
+  );
+
   /**
    * @brief Parses an expression.
    * 
@@ -152,13 +180,33 @@ private:
   [[nodiscard]] SelectQuery parse_select_query();
 
   /**
-   * @brief Parses a put query.
+   * @brief Parses a put query, or a put values query if the metric is
+   * followed by INTO.
    * 
-   * @return The parsed put query.
+   * @return The parsed put or put values query.
    * 
    * @throws ParseError If the put query cannot be parsed.
    */
-  [[nodiscard]] PutQuery parse_put_query();
+  [[nodiscard]] Query parse_put_query();
+
+  /**
+   * @brief Parses the rest of a put values query, after its metric.
+   * 
+   * @param metric The metric of the query.
+   * @return The parsed put values query.
+   * 
+   * @throws ParseError If the put values query cannot be parsed.
+   */
+  [[nodiscard]] PutValuesQuery parse_put_values_query(MetricExpr metric);
+
+  /**
+   * @brief Parses a row of a put values query.
+   * 
+   * @return The parsed row.
+   * 
+   * @throws ParseError If the row cannot be parsed.
+   */
+  [[nodiscard]] ValueRowExpr parse_value_row();
 
   /**
    * @brief Parses a delete query.
@@ -214,6 +262,15 @@ private:
    */
   [[nodiscard]] TablesQuery parse_tables_query();
 
+  /**
+   * @brief Parses a stats query.
+   * 
+   * @return The parsed stats query.
+   * 
+   * @throws ParseError If the stats query cannot be parsed.
+   */
+  [[nodiscard]] StatsQuery parse_stats_query();
+
   /**
    * @brief Parses a select type.
    * 
@@ -258,6 +315,33 @@ private:
    */
   [[nodiscard]] AtClause parse_at_clause();
 
+  /**
+   * @brief Parses an every clause.
+   * 
+   * @return The parsed every clause.
+   * 
+   * @throws ParseError If the every clause cannot be parsed.
+   */
+  [[nodiscard]] EveryClause parse_every_clause();
+
+  /**
+   * @brief Parses an order clause.
+   * 
+   * @return The parsed order clause.
+   * 
+   * @throws ParseError If the order clause cannot be parsed.
+   */
+  [[nodiscard]] OrderClause parse_order_clause();
+
+  /**
+   * @brief Parses a limit clause.
+   * 
+   * @return The parsed limit clause.
+   * 
+   * @throws ParseError If the limit clause cannot be parsed.
+   */
+  [[nodiscard]] LimitClause parse_limit_clause();
+
   /**
    * @brief Parses a where clause.
    * 
@@ -362,6 +446,11 @@ private:
    * @brief The current position in the token list.
    */
   size_type position_;
+
+  /**
+   * @brief The number of placeholders parsed so far.
+   */
+  size_type parameter_count_;
 };
 
 }  // namespace vkdb
@@ -0,0 +1,120 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include <vkdb/key_predicate.h>
+#include <vkdb/tag_index.h>
+#include <vkdb/time_series_key.h>
+#include <span>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+namespace vkdb {
+/**
+ * @brief Default maximum number of point lookups in a plan.
+ * @details Past this, a bounded range scan is cheaper than the lookups.
+ * 
+ */
+static constexpr uint64_t DEFAULT_MAX_PLANNED_POINTS{64};
+
+/**
+ * @brief Plan for a query that matches no key.
+ * 
+ */
+struct EmptyPlan {};
+
+/**
+ * @brief Plan for a query that reads a known set of keys.
+ * 
+ */
+struct PointPlan {
+  /**
+   * @brief Keys to look up, in key order.
+   * 
+   */
+  std::vector<TimeSeriesKey> keys;
+};
+
+/**
+ * @brief Plan for a query that scans a range of keys.
+ * 
+ */
+struct RangePlan {
+  /**
+   * @brief Start of the range.
+   * 
+   */
+  TimeSeriesKey start;
+
+  /**
+   * @brief End of the range.
+   * 
+   */
+  TimeSeriesKey end;
+};
+
+/**
+ * @brief Plan for reading the keys of a query.
+ * @details Variant of empty, point, and range plans.
+ * 
+ */
+using QueryPlan = std::variant<EmptyPlan, PointPlan, RangePlan>;
+
+/**
+ * @brief Plan the reads of a range query with a predicate.
+ * @details Keys are ordered by timestamp first, so the timestamps the
+ * predicate allows tighten the range to the ones between the earliest and
+ * latest of them. If the predicate also pins down the metrics and a value for
+ * every tag column, each matching key is fully known, since keys only have
+ * tags in the tag columns, and the plan looks them up one by one instead of
+ * scanning. Clauses the plan cannot fold in are still applied by the
+ * predicate during the scan.
+ * 
+ * Given a tag index, a predicate on metrics or tags is first resolved to
+ * the written series that match it. If there are none, nothing is read, and
+ * if the predicate also pins the timestamps, the keys of those series are
+ * looked up even when not every tag column is pinned. The index cannot
+ * narrow a range scan, whose keys are ordered by timestamp first.
+ * 
+ * @param start Start of the range.
+ * @param end End of the range.
+ * @param predicate Predicate.
+ * @param tag_columns Tag columns of the table.
+ * @param max_points Maximum number of point lookups.
+ * @param tag_index Tag index listing every series written, or nullptr.
+ * @return QueryPlan Plan.
+ */
+[[nodiscard]] QueryPlan planQuery(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::unordered_set<TagKey>& tag_columns,
+  uint64_t max_points = DEFAULT_MAX_PLANNED_POINTS,
+  const TagIndex* tag_index = nullptr
+);
+
+/**
+ * @brief Plan the reads of a range query with a predicate over the tag
+ * indexes of several LSM trees.
+ * @details As with a single tag index, where the series of the LSM trees
+ * are disjoint and the series written are those of any of the indexes.
+ * 
+ * @param start Start of the range.
+ * @param end End of the range.
+ * @param predicate Predicate.
+ * @param tag_columns Tag columns of the table.
+ * @param max_points Maximum number of point lookups.
+ * @param tag_indexes Tag indexes listing every series written, or none.
+ * @return QueryPlan Plan.
+ */
+[[nodiscard]] QueryPlan planQuery(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::unordered_set<TagKey>& tag_columns,
+  uint64_t max_points,
+  std::span<const TagIndex* const> tag_indexes
+);
+}  // namespace vkdb
+
+#endif // QUERY_PLANNER_H
@@ -43,6 +43,13 @@ private:
    */
   void visit(const PutQuery& query) noexcept;
 
+  /**
+   * @brief Visits a put values query.
+   * 
+   * @param query The put values query to visit.
+   */
+  void visit(const PutValuesQuery& query) noexcept;
+
   /**
    * @brief Visits a delete query.
    * 
@@ -85,6 +92,13 @@ private:
    */
   void visit(const TablesQuery& query) noexcept;
 
+  /**
+   * @brief Visits a stats query.
+   * 
+   * @param query The stats query to visit.
+   */
+  void visit(const StatsQuery& query) noexcept;
+
   /**
    * @brief Visits an all clause.
    * 
@@ -106,6 +120,27 @@ private:
    */
   void visit(const AtClause& clause) noexcept;
 
+  /**
+   * @brief Visits an every clause.
+   * 
+   * @param clause The every clause to visit.
+   */
+  void visit(const EveryClause& clause) noexcept;
+
+  /**
+   * @brief Visits an order clause.
+   * 
+   * @param clause The order clause to visit.
+   */
+  void visit(const OrderClause& clause) noexcept;
+
+  /**
+   * @brief Visits a limit clause.
+   * 
+   * @param clause The limit clause to visit.
+   */
+  void visit(const LimitClause& clause) noexcept;
+
   /**
    * @brief Visits a where clause.
    * 
@@ -0,0 +1,183 @@
+#ifndef QUERY_RESULT_WRITER_H
+#define QUERY_RESULT_WRITER_H
+
+#include <vkdb/time_series_key.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Format of the data points in query output.
+ * 
+ */
+enum class OutputFormat {
+  /**
+   * @brief One line of '[key|value]' entries separated by ';', as parsed by
+   * datapointsFromString().
+   * 
+   */
+  TEXT,
+
+  /**
+   * @brief A 'timestamp,metric,tags,value' header, then one line per data
+   * point, with tags written as 'key=value' separated by ';'.
+   * 
+   */
+  CSV,
+
+  /**
+   * @brief RESULT_MAGIC, then each data point as a 1 byte and its
+   * binary-encoded key and value, then a 0 byte.
+   * 
+   */
+  BINARY
+};
+
+/**
+ * @brief Writes query results to a stream in chunks.
+ * @details Data points are formatted into a buffer that is written to the
+ * stream whenever it reaches CHUNK_BYTES, so a result can be written as it
+ * is produced, without being held in memory. Results other than data points
+ * are written as lines of text in every format.
+ * 
+ */
+class ResultWriter {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Size the buffer is written to the stream at.
+   * 
+   */
+  static constexpr size_type CHUNK_BYTES{64 * 1024};
+
+  /**
+   * @brief Magic string at the start of each binary data point result.
+   * 
+   */
+  static constexpr std::string_view RESULT_MAGIC{"VKDBROWS"};
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  ResultWriter() = delete;
+
+  /**
+   * @brief Construct a new ResultWriter object.
+   * 
+   * @param stream Output stream, which must outlive the writer.
+   * @param format Format of the data points.
+   */
+  explicit ResultWriter(
+    std::ostream& stream,
+    OutputFormat format = OutputFormat::TEXT
+  );
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  ResultWriter(ResultWriter&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  ResultWriter& operator=(ResultWriter&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  ResultWriter(const ResultWriter&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  ResultWriter& operator=(const ResultWriter&) = delete;
+
+  /**
+   * @brief Destroy the ResultWriter object.
+   * @details Writes whatever is buffered to the stream.
+   * 
+   */
+  ~ResultWriter() noexcept;
+
+  /**
+   * @brief Start a result of data points.
+   * 
+   */
+  void beginDataPoints();
+
+  /**
+   * @brief Write a data point of the current result.
+   * 
+   * @param key Key.
+   * @param value Value.
+   */
+  void writeDataPoint(const TimeSeriesKey& key, double value);
+
+  /**
+   * @brief Write a data point of the current result.
+   * 
+   * @param datapoint Data point.
+   */
+  void writeDataPoint(const DataPoint<double>& datapoint);
+
+  /**
+   * @brief End the current result of data points.
+   * 
+   */
+  void endDataPoints();
+
+  /**
+   * @brief Write a result as a line of text.
+   * 
+   * @param line Line, without the newline.
+   */
+  void writeLine(std::string_view line);
+
+  /**
+   * @brief Write whatever is buffered to the stream.
+   * 
+   */
+  void flush();
+
+private:
+  /**
+   * @brief Write the buffer to the stream if it has reached CHUNK_BYTES.
+   * 
+   */
+  void flush_if_full();
+
+  /**
+   * @brief Output stream.
+   * 
+   */
+  std::ostream& stream_;
+
+  /**
+   * @brief Format of the data points.
+   * 
+   */
+  OutputFormat format_;
+
+  /**
+   * @brief Output not yet written to the stream.
+   * 
+   */
+  std::string buffer_;
+
+  /**
+   * @brief Whether no data point of the current result is written yet.
+   * 
+   */
+  bool first_{true};
+};
+}  // namespace vkdb
+
+#endif // QUERY_RESULT_WRITER_H
@@ -0,0 +1,93 @@
+#ifndef QUERY_STATEMENT_H
+#define QUERY_STATEMENT_H
+
+#include <vkdb/expr.h>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Represents a prepared vq statement.
+ * @details Holds the parsed expression of a source string, so it can be
+ * interpreted many times without being lexed and parsed again. Timestamps,
+ * values, and tag values may be written as placeholders ('?'), which are
+ * bound to parameters, in order, each time the statement is executed.
+ * 
+ */
+class PreparedStatement {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  PreparedStatement() = delete;
+
+  /**
+   * @brief Construct a new PreparedStatement object.
+   * 
+   * @param expr Parsed expression.
+   * @param parameter_count Number of placeholders in the expression.
+   */
+  explicit PreparedStatement(Expr expr, size_type parameter_count) noexcept;
+
+  /**
+   * @brief Move-construct a PreparedStatement object.
+   * 
+   */
+  PreparedStatement(PreparedStatement&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a PreparedStatement object.
+   * 
+   */
+  PreparedStatement& operator=(PreparedStatement&&) noexcept = default;
+
+  /**
+   * @brief Copy-construct a PreparedStatement object.
+   * 
+   */
+  PreparedStatement(const PreparedStatement&) = default;
+
+  /**
+   * @brief Copy-assign a PreparedStatement object.
+   * 
+   */
+  PreparedStatement& operator=(const PreparedStatement&) = default;
+
+  /**
+   * @brief Destroy the PreparedStatement object.
+   * 
+   */
+  ~PreparedStatement() noexcept = default;
+
+  /**
+   * @brief Get the parsed expression.
+   * 
+   * @return const Expr& Parsed expression.
+   */
+  [[nodiscard]] const Expr& expr() const noexcept;
+
+  /**
+   * @brief Get the number of placeholders.
+   * 
+   * @return size_type Number of placeholders.
+   */
+  [[nodiscard]] size_type parameterCount() const noexcept;
+
+private:
+  /**
+   * @brief Parsed expression.
+   * 
+   */
+  Expr expr_;
+
+  /**
+   * @brief Number of placeholders.
+   * 
+   */
+  size_type parameter_count_;
+};
+}  // namespace vkdb
+
+#endif // QUERY_STATEMENT_H
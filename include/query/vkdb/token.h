@@ -2,6 +2,7 @@
 #define QUERY_TOKEN_H
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -19,10 +20,11 @@ using Lexeme = std::string;
  */
 enum class TokenType {
   SELECT, PUT, DELETE, CREATE, DROP, ADD, REMOVE,
-  DATA, AVG, SUM, COUNT, MIN, MAX,
-  TABLE, TABLES, TAGS, ALL, BETWEEN, AND, AT, WHERE, FROM, INTO, TO,
-  EQUAL, COMMA, SEMICOLON,
-  IDENTIFIER, NUMBER,
+  DATA, LAST, AVG, SUM, COUNT, MIN, MAX, PERCENTILE, APPROX_COUNT_DISTINCT,
+  TABLE, TABLES, SHOW, STATS, TAGS, ALL, BETWEEN, AND, AT, EVERY, WHERE, FROM, INTO, TO,
+  ORDER, BY, TIMESTAMP, VALUE, ASC, DESC, LIMIT, VALUES, TYPE,
+  EQUAL, COMMA, SEMICOLON, LEFT_PAREN, RIGHT_PAREN,
+  IDENTIFIER, NUMBER, PLACEHOLDER,
   END_OF_FILE, UNKNOWN
 };
 
@@ -33,7 +35,7 @@ enum class TokenType {
 static const std::unordered_set<TokenType> QUERY_BASE_WORDS{
   TokenType::SELECT, TokenType::PUT, TokenType::DELETE,
   TokenType::CREATE, TokenType::DROP, TokenType::ADD, TokenType::REMOVE,
-  TokenType::TABLES
+  TokenType::TABLES, TokenType::SHOW
 };
 
 /**
@@ -49,27 +51,45 @@ static const std::unordered_map<TokenType, std::string> TOKEN_TYPE_TO_STRING{
   {TokenType::ADD, "ADD"},
   {TokenType::REMOVE, "REMOVE"},
   {TokenType::TABLES, "TABLES"},
+  {TokenType::SHOW, "SHOW"},
   {TokenType::DATA, "DATA"},
+  {TokenType::LAST, "LAST"},
   {TokenType::AVG, "AVG"},
   {TokenType::SUM, "SUM"},
   {TokenType::COUNT, "COUNT"},
   {TokenType::MIN, "MIN"},
   {TokenType::MAX, "MAX"},
+  {TokenType::PERCENTILE, "PERCENTILE"},
+  {TokenType::APPROX_COUNT_DISTINCT, "APPROX_COUNT_DISTINCT"},
   {TokenType::TABLE, "TABLE"},
+  {TokenType::STATS, "STATS"},
   {TokenType::TAGS, "TAGS"},
   {TokenType::ALL, "ALL"},
   {TokenType::BETWEEN, "BETWEEN"},
   {TokenType::AND, "AND"},
   {TokenType::AT, "AT"},
+  {TokenType::EVERY, "EVERY"},
   {TokenType::WHERE, "WHERE"},
   {TokenType::FROM, "FROM"},
   {TokenType::INTO, "INTO"},
   {TokenType::TO, "TO"},
+  {TokenType::ORDER, "ORDER"},
+  {TokenType::BY, "BY"},
+  {TokenType::TIMESTAMP, "TIMESTAMP"},
+  {TokenType::VALUE, "VALUE"},
+  {TokenType::ASC, "ASC"},
+  {TokenType::DESC, "DESC"},
+  {TokenType::LIMIT, "LIMIT"},
+  {TokenType::VALUES, "VALUES"},
+  {TokenType::TYPE, "TYPE"},
   {TokenType::EQUAL, "EQUAL"},
   {TokenType::COMMA, "COMMA"},
   {TokenType::SEMICOLON, "SEMICOLON"},
+  {TokenType::LEFT_PAREN, "LEFT_PAREN"},
+  {TokenType::RIGHT_PAREN, "RIGHT_PAREN"},
   {TokenType::IDENTIFIER, "IDENTIFIER"},
   {TokenType::NUMBER, "NUMBER"},
+  {TokenType::PLACEHOLDER, "PLACEHOLDER"},
   {TokenType::END_OF_FILE, "END_OF_FILE"},
   {TokenType::UNKNOWN, "UNKNOWN"}
 };
@@ -99,11 +119,27 @@ public:
    */
   explicit Token(
     TokenType type,
-    const Lexeme& lexeme,
+    Lexeme lexeme,
     size_type line,
     size_type column
   ) noexcept;
 
+  /**
+   * @brief Construct a placeholder Token object from the given lexeme, line,
+   * column, and index of its parameter.
+   * 
+   * @param lexeme The lexeme of the token.
+   * @param line The line number of the token.
+   * @param column The column number of the token.
+   * @param parameter The index of the parameter bound in place of the token.
+   */
+  explicit Token(
+    Lexeme lexeme,
+    size_type line,
+    size_type column,
+    size_type parameter
+  ) noexcept;
+
   /**
    * @brief Move-construct a Token object.
    * 
@@ -153,9 +189,9 @@ public:
   /**
    * @brief Get the lexeme of the token.
    * 
-   * @return Lexeme The lexeme of the token.
+   * @return const Lexeme& The lexeme of the token.
    */
-  [[nodiscard]] Lexeme lexeme() const noexcept;
+  [[nodiscard]] const Lexeme& lexeme() const noexcept;
 
   /**
    * @brief Get the line number of the token.
@@ -171,6 +207,14 @@ public:
    */
   [[nodiscard]] size_type column() const noexcept;
 
+  /**
+   * @brief Get the index of the parameter bound in place of the token.
+   * @details Only placeholders that have been parsed have one.
+   * 
+   * @return std::optional<size_type> The index of the parameter, if any.
+   */
+  [[nodiscard]] std::optional<size_type> parameter() const noexcept;
+
   /**
    * @brief Get the string representation of the token.
    * 
@@ -202,6 +246,12 @@ private:
    * 
    */
   size_type column_;
+
+  /**
+   * @brief The index of the parameter bound in place of the token, if any.
+   * 
+   */
+  std::optional<size_type> parameter_;
 };
 }  // namespace vkdb
 
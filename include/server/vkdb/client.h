@@ -0,0 +1,169 @@
+#ifndef SERVER_CLIENT_H
+#define SERVER_CLIENT_H
+
+#include <vkdb/protocol.h>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Blocking client of a Server.
+ * @details Requests can be pipelined, by sending several before receiving
+ * their responses, which come back in the order they were sent.
+ * 
+ */
+class Client {
+public:
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  Client() = delete;
+
+  /**
+   * @brief Construct a new Client object, connected to a server.
+   * 
+   * @param host Address of the server.
+   * @param port Port of the server.
+   * 
+   * @throw std::system_error If connecting fails.
+   */
+  Client(const std::string& host, uint16_t port);
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  Client(Client&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  Client& operator=(Client&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  Client(const Client&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  Client& operator=(const Client&) = delete;
+
+  /**
+   * @brief Destroy the Client object.
+   * @details Closes the connection.
+   * 
+   */
+  ~Client() noexcept;
+
+  /**
+   * @brief Send a request without waiting for its response.
+   * 
+   * @param type Type.
+   * @param payload Payload.
+   * @return uint32_t Request ID, echoed by its response.
+   * 
+   * @throw std::system_error If sending fails.
+   */
+  uint32_t send(MessageType type, std::string_view payload);
+
+  /**
+   * @brief Wait for the next response.
+   * 
+   * @return Frame Response, whose type is a ResponseStatus.
+   * 
+   * @throw std::system_error If receiving fails.
+   * @throw std::runtime_error If the connection is closed.
+   */
+  [[nodiscard]] Frame receive();
+
+  /**
+   * @brief Run VQ source and wait for its output.
+   * 
+   * @param source VQ source.
+   * @param format Format of the data points in the output.
+   * @return std::string Output.
+   * 
+   * @throw std::runtime_error If the source fails to parse or run, or if
+   * the request fails.
+   */
+  std::string query(
+    std::string_view source,
+    OutputFormat format = OutputFormat::TEXT
+  );
+
+  /**
+   * @brief Write a batch of rows and wait for it to be written.
+   * 
+   * @param request Batch.
+   * 
+   * @throw std::runtime_error If writing the batch or the request fails.
+   */
+  void putBatch(const PutBatchRequest& request);
+
+  /**
+   * @brief Read WAL records of a shard of a table from a leader, which
+   * also acknowledges every record before them.
+   * 
+   * @param request Table, shard, and LSN to read from.
+   * @return ReplicateResponse Records, with what a follower needs to set up
+   * its table.
+   * 
+   * @throw std::runtime_error If the records are no longer kept, or if the
+   * request fails.
+   */
+  [[nodiscard]] ReplicateResponse replicate(const ReplicateRequest& request);
+
+  /**
+   * @brief Check that the server is alive.
+   * 
+   * @throw std::runtime_error If the request fails.
+   */
+  void ping();
+
+  /**
+   * @brief Get the storage stats of the tables opened by the server.
+   * 
+   * @return std::string Stats, in the Prometheus text exposition format.
+   * 
+   * @throw std::runtime_error If the request fails.
+   */
+  [[nodiscard]] std::string stats();
+
+private:
+  /**
+   * @brief Wait for the next response, and check that it succeeded.
+   * 
+   * @return std::string Payload of the response.
+   * 
+   * @throw std::runtime_error If the response is an error.
+   */
+  std::string expect_ok();
+
+  /**
+   * @brief File descriptor of the socket.
+   * 
+   */
+  int fd_{-1};
+
+  /**
+   * @brief ID of the next request.
+   * 
+   */
+  uint32_t next_request_id_{0};
+
+  /**
+   * @brief Bytes received but not yet framed.
+   * 
+   */
+  std::string input_;
+};
+}  // namespace vkdb
+
+#endif // SERVER_CLIENT_H
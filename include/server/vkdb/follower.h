@@ -0,0 +1,288 @@
+#ifndef SERVER_FOLLOWER_H
+#define SERVER_FOLLOWER_H
+
+#include <vkdb/database.h>
+#include <vkdb/client.h>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Name of the file, in a followed table's directory, that stores the
+ * LSN each shard has been applied up to.
+ * 
+ */
+static const std::string FOLLOWER_LSN_FILENAME{"follower.lsn"};
+
+/**
+ * @brief Options for a follower.
+ * 
+ */
+struct FollowerOptions {
+  /**
+   * @brief Address of the leader.
+   * 
+   */
+  std::string host{"127.0.0.1"};
+
+  /**
+   * @brief Port of the leader.
+   * 
+   */
+  uint16_t port{7070};
+
+  /**
+   * @brief Name of the follower, unique among the followers of the leader.
+   * @details The leader keeps each archived WAL segment until every
+   * follower it has heard from has read it.
+   * 
+   */
+  std::string name{"follower"};
+
+  /**
+   * @brief Tables to follow, which should have WALOptions::archive set on
+   * the leader.
+   * 
+   */
+  std::vector<TableName> tables;
+
+  /**
+   * @brief Time between polls once caught up, when started.
+   * 
+   */
+  std::chrono::milliseconds poll_interval{100};
+};
+
+/**
+ * @brief Keeps tables of a database up to date with a leader's, by reading
+ * their WAL records over the protocol of protocol.h.
+ * @details Each shard of each table is read from the LSN it was last
+ * applied up to, which also tells the leader that those before it can be
+ * removed. A table missing from the database is created with the shard
+ * count, tag columns and value type of the leader's. Records are applied in
+ * order, and a shard's LSN is saved only once its records are synced, so
+ * after a crash some records may be applied again, which puts and removals
+ * allow.
+ * 
+ * Followed tables should only be read locally, as local writes to them are
+ * not sent to the leader.
+ * 
+ */
+class Follower {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  Follower() = delete;
+
+  /**
+   * @brief Construct a new Follower object.
+   * @details The follower does not connect until it polls.
+   * 
+   * @param database Database, which must outlive the follower.
+   * @param options Options.
+   * 
+   * @throw std::invalid_argument If there are no tables to follow.
+   */
+  explicit Follower(Database& database, FollowerOptions options);
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  Follower(Follower&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  Follower& operator=(Follower&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  Follower(const Follower&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  Follower& operator=(const Follower&) = delete;
+
+  /**
+   * @brief Destroy the Follower object.
+   * @details Stops the follower.
+   * 
+   */
+  ~Follower() noexcept;
+
+  /**
+   * @brief Read and apply every record the leader has, for every table.
+   * 
+   * @return size_type Number of records applied.
+   * 
+   * @throw std::system_error If connecting to the leader fails.
+   * @throw std::runtime_error If a request fails, if the leader no longer
+   * keeps the records needed, or if a local table has a different number
+   * of shards or value type from the leader's.
+   */
+  size_type poll();
+
+  /**
+   * @brief Poll in the background, every poll interval.
+   * @details A failed poll is retried on a new connection after the next
+   * interval, and its error is kept, as given by lastError().
+   * 
+   * @throw std::runtime_error If the follower is already started.
+   */
+  void start();
+
+  /**
+   * @brief Stop polling in the background.
+   * @details A poll already running finishes first.
+   * 
+   */
+  void stop() noexcept;
+
+  /**
+   * @brief Get the error of the last background poll.
+   * 
+   * @return std::exception_ptr Error, or null if the last poll succeeded.
+   */
+  [[nodiscard]] std::exception_ptr lastError() const noexcept;
+
+private:
+  /**
+   * @brief Read and apply every record the leader has, for every table,
+   * with the mutex held.
+   * 
+   * @return size_type Number of records applied.
+   * 
+   * @throw std::system_error If connecting to the leader fails.
+   * @throw std::runtime_error If a request fails, if the leader no longer
+   * keeps the records needed, or if a local table has a different number
+   * of shards from the leader's.
+   */
+  size_type poll_tables();
+
+  /**
+   * @brief Read and apply every record the leader has for a table.
+   * 
+   * @param client Client connected to the leader.
+   * @param table_name Table name.
+   * @return size_type Number of records applied.
+   * 
+   * @throw std::runtime_error If a request fails, or if the local table
+   * has a different number of shards from the leader's.
+   */
+  size_type poll_table(Client& client, const TableName& table_name);
+
+  /**
+   * @brief Get the local table, creating it like the leader's if missing.
+   * 
+   * @param table_name Table name.
+   * @param response Response of the leader for the table's first shard.
+   * @return Table& Table.
+   * 
+   * @throw std::runtime_error If the table has a different number of
+   * shards or value type from the leader's.
+   */
+  Table& local_table(
+    const TableName& table_name,
+    const ReplicateResponse& response
+  );
+
+  /**
+   * @brief Load the LSN each shard of a table has been applied up to.
+   * 
+   * @param table Table.
+   * @return std::vector<uint64_t> LSN of each shard.
+   */
+  [[nodiscard]] static std::vector<uint64_t> load_lsns(const Table& table);
+
+  /**
+   * @brief Save the LSN each shard of a table has been applied up to.
+   * 
+   * @param table Table.
+   * @param lsns LSN of each shard.
+   * 
+   * @throw std::runtime_error If the file cannot be written.
+   */
+  static void save_lsns(const Table& table, const std::vector<uint64_t>& lsns);
+
+  /**
+   * @brief Poll every poll interval until stopped.
+   * 
+   */
+  void run() noexcept;
+
+  /**
+   * @brief Database.
+   * 
+   */
+  Database& database_;
+
+  /**
+   * @brief Options.
+   * 
+   */
+  FollowerOptions options_;
+
+  /**
+   * @brief Client connected to the leader, or null if not yet connected or
+   * if the last poll failed.
+   * 
+   */
+  std::unique_ptr<Client> client_;
+
+  /**
+   * @brief LSN each shard of each table has been applied up to.
+   * 
+   */
+  std::map<TableName, std::vector<uint64_t>> lsns_;
+
+  /**
+   * @brief Mutex of the client, LSNs, and background state.
+   * 
+   */
+  mutable std::mutex mutex_;
+
+  /**
+   * @brief Condition variable woken to stop the background thread.
+   * 
+   */
+  std::condition_variable stop_cv_;
+
+  /**
+   * @brief Whether the background thread should stop.
+   * 
+   */
+  bool stopping_{false};
+
+  /**
+   * @brief Error of the last background poll.
+   * 
+   */
+  std::exception_ptr last_error_;
+
+  /**
+   * @brief Background thread, if started.
+   * 
+   */
+  std::thread thread_;
+};
+}  // namespace vkdb
+
+#endif // SERVER_FOLLOWER_H
@@ -0,0 +1,334 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <vkdb/table.h>
+#include <vkdb/result_writer.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Type of a request frame.
+ * 
+ */
+enum class MessageType : uint8_t {
+  /**
+   * @brief Check that the server is alive. The payload is empty.
+   * 
+   */
+  PING = 1,
+
+  /**
+   * @brief Run VQ source. The payload is an OutputFormat byte, then the
+   * source.
+   * 
+   */
+  QUERY = 2,
+
+  /**
+   * @brief Write a batch of rows, as encoded by putBatchToBinary().
+   * 
+   */
+  PUT_BATCH = 3,
+
+  /**
+   * @brief Read the WAL records of a shard of a table, as encoded by
+   * replicateRequestToBinary().
+   * 
+   */
+  REPLICATE = 4,
+
+  /**
+   * @brief Get the storage stats of the opened tables, in the Prometheus
+   * text exposition format. The payload is empty.
+   * 
+   */
+  STATS = 5
+};
+
+/**
+ * @brief Status of a response frame.
+ * @details The payload of an OK response is the output of the request, and
+ * that of any other response is an error message.
+ * 
+ */
+enum class ResponseStatus : uint8_t {
+  OK = 0,
+  PARSE_ERROR = 1,
+  RUNTIME_ERROR = 2,
+  PROTOCOL_ERROR = 3
+};
+
+/**
+ * @brief Frame of the wire protocol.
+ * @details A frame is encoded as its payload length (4 bytes), its type
+ * (1 byte), and its request ID (4 bytes), then the payload. The type of a
+ * request frame is a MessageType, and that of a response frame is a
+ * ResponseStatus. Responses on a connection come in the order of its
+ * requests, with their request IDs echoed, so requests can be pipelined.
+ * 
+ */
+struct Frame {
+  /**
+   * @brief Type.
+   * 
+   */
+  uint8_t type{0};
+
+  /**
+   * @brief Request ID.
+   * 
+   */
+  uint32_t request_id{0};
+
+  /**
+   * @brief Payload.
+   * 
+   */
+  std::string payload;
+};
+
+/**
+ * @brief Number of bytes in the header of a frame.
+ * 
+ */
+static constexpr uint64_t FRAME_HEADER_BYTES{
+  sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t)
+};
+
+/**
+ * @brief Append a frame to a buffer.
+ * 
+ * @param buffer Buffer.
+ * @param type Type.
+ * @param request_id Request ID.
+ * @param payload Payload.
+ * 
+ * @throw std::length_error If the payload is too long to encode.
+ */
+void appendFrame(
+  std::string& buffer,
+  uint8_t type,
+  uint32_t request_id,
+  std::string_view payload
+);
+
+/**
+ * @brief Read a frame from the start of a buffer, if it is all there.
+ * 
+ * @param buffer Buffer.
+ * @param frame Frame read.
+ * @param max_payload_bytes Largest payload allowed.
+ * @return uint64_t Number of bytes the frame takes up, or 0 if the buffer
+ * holds only part of it.
+ * 
+ * @throw std::runtime_error If the payload is larger than allowed.
+ */
+[[nodiscard]] uint64_t readFrame(
+  std::string_view buffer,
+  Frame& frame,
+  uint64_t max_payload_bytes
+);
+
+/**
+ * @brief Rows of one series in a batch.
+ * 
+ */
+struct SeriesRows {
+  /**
+   * @brief Metric.
+   * 
+   */
+  Metric metric;
+
+  /**
+   * @brief Tags.
+   * 
+   */
+  TagTable tags;
+
+  /**
+   * @brief Timestamp and value of each row.
+   * 
+   */
+  std::vector<std::pair<Timestamp, double>> rows;
+};
+
+/**
+ * @brief Batch of rows written to a table.
+ * 
+ */
+struct PutBatchRequest {
+  /**
+   * @brief Name of the table.
+   * 
+   */
+  TableName table_name;
+
+  /**
+   * @brief Rows, grouped by series.
+   * 
+   */
+  std::vector<SeriesRows> series;
+};
+
+/**
+ * @brief Append a binary-encoded batch to a buffer.
+ * @details The batch is encoded as the table name and the number of series,
+ * then, for each series, its metric, its tags, the number of its rows, and
+ * each row as the zigzag varint delta of its timestamp from the row before
+ * and its fixed-width value. Strings are length-prefixed, as with
+ * appendBinary().
+ * 
+ * @param buffer Buffer.
+ * @param request Batch.
+ * 
+ * @throw std::length_error If a string is too long to encode.
+ */
+void putBatchToBinary(std::string& buffer, const PutBatchRequest& request);
+
+/**
+ * @brief Read a binary-encoded batch.
+ * 
+ * @param payload Payload.
+ * @return PutBatchRequest Batch.
+ * 
+ * @throw std::runtime_error If the payload is malformed.
+ */
+[[nodiscard]] PutBatchRequest putBatchFromBinary(std::string_view payload);
+
+/**
+ * @brief Request of a follower for the WAL records of a shard of a table.
+ * @details Asking for the records from an LSN on acknowledges every record
+ * before it.
+ * 
+ */
+struct ReplicateRequest {
+  /**
+   * @brief Name of the follower, which identifies its acknowledgements.
+   * 
+   */
+  std::string follower;
+
+  /**
+   * @brief Name of the table.
+   * 
+   */
+  TableName table_name;
+
+  /**
+   * @brief Shard index.
+   * 
+   */
+  uint64_t shard{0};
+
+  /**
+   * @brief LSN of the first record to read.
+   * 
+   */
+  uint64_t lsn{0};
+};
+
+/**
+ * @brief Response of a leader to a ReplicateRequest.
+ * 
+ */
+struct ReplicateResponse {
+  /**
+   * @brief Number of shards of the table.
+   * 
+   */
+  uint64_t shards{1};
+
+  /**
+   * @brief Tag columns of the table.
+   * 
+   */
+  std::vector<TagKey> tag_columns;
+
+  /**
+   * @brief Records read, and the LSN to read from next.
+   * 
+   */
+  WALChunk chunk;
+
+  /**
+   * @brief Value type of the table.
+   * 
+   */
+  ValueType value_type{ValueType::DOUBLE};
+};
+
+/**
+ * @brief Append a binary-encoded replicate request to a buffer.
+ * @details The request is encoded as the follower and table names, then
+ * the shard index and the LSN as varints.
+ * 
+ * @param buffer Buffer.
+ * @param request Request.
+ * 
+ * @throw std::length_error If a string is too long to encode.
+ */
+void replicateRequestToBinary(
+  std::string& buffer,
+  const ReplicateRequest& request
+);
+
+/**
+ * @brief Read a binary-encoded replicate request.
+ * 
+ * @param payload Payload.
+ * @return ReplicateRequest Request.
+ * 
+ * @throw std::runtime_error If the payload is malformed.
+ */
+[[nodiscard]] ReplicateRequest replicateRequestFromBinary(
+  std::string_view payload
+);
+
+/**
+ * @brief Append a binary-encoded replicate response to a buffer.
+ * @details The response is encoded as the number of shards as a varint,
+ * the tag columns as a count and strings, the value type as a byte, and the
+ * next LSN as a varint, then the records, which take up the rest of the
+ * payload.
+ * 
+ * @param buffer Buffer.
+ * @param response Response.
+ * 
+ * @throw std::length_error If a string is too long to encode.
+ */
+void replicateResponseToBinary(
+  std::string& buffer,
+  const ReplicateResponse& response
+);
+
+/**
+ * @brief Read a binary-encoded replicate response.
+ * 
+ * @param payload Payload.
+ * @return ReplicateResponse Response.
+ * 
+ * @throw std::runtime_error If the payload is malformed.
+ */
+[[nodiscard]] ReplicateResponse replicateResponseFromBinary(
+  std::string_view payload
+);
+
+/**
+ * @brief Get the payload of a query request.
+ * 
+ * @param source VQ source.
+ * @param format Format of the data points in the response.
+ * @return std::string Payload.
+ */
+[[nodiscard]] std::string queryPayload(
+  std::string_view source,
+  OutputFormat format
+);
+}  // namespace vkdb
+
+#endif // SERVER_PROTOCOL_H
@@ -0,0 +1,355 @@
+#ifndef SERVER_SERVER_H
+#define SERVER_SERVER_H
+
+#include <vkdb/database.h>
+#include <vkdb/protocol.h>
+#include <vkdb/thread_pool.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Largest number of bytes of WAL records in a replicate response.
+ * 
+ */
+static constexpr uint64_t REPLICATE_CHUNK_BYTES{1 << 20};
+
+/**
+ * @brief Options for a server.
+ * 
+ */
+struct ServerOptions {
+  /**
+   * @brief Address to listen on.
+   * 
+   */
+  std::string host{"127.0.0.1"};
+
+  /**
+   * @brief Port to listen on. 0 picks a free port, as given by port().
+   * 
+   */
+  uint16_t port{7070};
+
+  /**
+   * @brief Number of threads that handle requests, shared by all
+   * connections.
+   * 
+   */
+  uint64_t worker_threads{std::thread::hardware_concurrency()};
+
+  /**
+   * @brief Largest payload of a request frame, in bytes.
+   * @details A connection that sends a larger one is closed.
+   * 
+   */
+  uint64_t max_frame_bytes{64 << 20};
+};
+
+/**
+ * @brief Serves a database over TCP, with the protocol of protocol.h.
+ * @details One thread waits on every socket with epoll, reading requests
+ * and writing responses, and a fixed pool of worker threads handles the
+ * requests, so connections share the pool rather than each having a thread.
+ * The requests of a connection are handled one at a time, in order, while
+ * those of different connections run concurrently. Queries that create,
+ * drop, or change the tags of tables run on their own.
+ * 
+ */
+class Server {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  Server() = delete;
+
+  /**
+   * @brief Construct a new Server object.
+   * @details The server does not listen until it is started.
+   * 
+   * @param database Database, which must outlive the server.
+   * @param options Options.
+   * 
+   * @throw std::invalid_argument If the number of worker threads is 0.
+   */
+  explicit Server(Database& database, ServerOptions options = {});
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  Server(Server&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  Server& operator=(Server&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  Server(const Server&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  Server& operator=(const Server&) = delete;
+
+  /**
+   * @brief Destroy the Server object.
+   * @details Stops the server.
+   * 
+   */
+  ~Server() noexcept;
+
+  /**
+   * @brief Listen on the host and port, and start serving.
+   * 
+   * @throw std::runtime_error If the server is already started.
+   * @throw std::system_error If the socket cannot be set up.
+   */
+  void start();
+
+  /**
+   * @brief Stop serving, and close every connection.
+   * @details Requests already being handled finish first.
+   * 
+   */
+  void stop() noexcept;
+
+  /**
+   * @brief Get the port the server listens on.
+   * 
+   * @return uint16_t Port, or 0 if the server is not started.
+   */
+  [[nodiscard]] uint16_t port() const noexcept;
+
+private:
+  /**
+   * @brief Connection of a client.
+   * 
+   */
+  struct Connection;
+
+  /**
+   * @brief Wait on the sockets until the server is stopped.
+   * 
+   */
+  void run_loop() noexcept;
+
+  /**
+   * @brief Accept every pending connection.
+   * 
+   */
+  void accept_connections() noexcept;
+
+  /**
+   * @brief Read what a connection has sent, and queue its requests.
+   * 
+   * @param connection Connection.
+   * @return true if the connection is still open.
+   * @return false if it was closed.
+   */
+  bool read_from(const std::shared_ptr<Connection>& connection) noexcept;
+
+  /**
+   * @brief Write as much of a connection's responses as it will take.
+   * 
+   * @param connection Connection.
+   */
+  void write_to(const std::shared_ptr<Connection>& connection) noexcept;
+
+  /**
+   * @brief Close a connection.
+   * 
+   * @param connection Connection.
+   */
+  void close(const std::shared_ptr<Connection>& connection) noexcept;
+
+  /**
+   * @brief Handle a connection's queued requests on a worker thread.
+   * @details Runs until the queue is empty, then marks the connection idle.
+   * 
+   * @param connection Connection.
+   */
+  void drain(std::shared_ptr<Connection> connection) noexcept;
+
+  /**
+   * @brief Handle a request.
+   * 
+   * @param request Request frame.
+   * @param response Buffer the response frame is appended to.
+   */
+  void handle(const Frame& request, std::string& response) noexcept;
+
+  /**
+   * @brief Handle a query request.
+   * 
+   * @param payload Payload.
+   * @param output Output or error message.
+   * @return ResponseStatus Status.
+   */
+  [[nodiscard]] ResponseStatus handle_query(
+    std::string_view payload,
+    std::string& output
+  );
+
+  /**
+   * @brief Handle a put batch request.
+   * 
+   * @param payload Payload.
+   * @param output Error message.
+   * @return ResponseStatus Status.
+   */
+  [[nodiscard]] ResponseStatus handle_put_batch(
+    std::string_view payload,
+    std::string& output
+  );
+
+  /**
+   * @brief Handle a replicate request.
+   * 
+   * @param payload Payload.
+   * @param output Response or error message.
+   * @return ResponseStatus Status.
+   */
+  [[nodiscard]] ResponseStatus handle_replicate(
+    std::string_view payload,
+    std::string& output
+  );
+
+  /**
+   * @brief Record that a follower has read a shard of a table up to an LSN.
+   * 
+   * @param table_name Table name.
+   * @param shard Shard index.
+   * @param follower Follower name.
+   * @param lsn LSN that the follower has read up to.
+   * @return uint64_t LSN that every follower of the shard has read up to.
+   */
+  [[nodiscard]] uint64_t acknowledge(
+    const TableName& table_name,
+    uint64_t shard,
+    const std::string& follower,
+    uint64_t lsn
+  );
+
+  /**
+   * @brief Ask the loop to write a connection's responses.
+   * 
+   * @param connection Connection.
+   */
+  void notify(const std::shared_ptr<Connection>& connection) noexcept;
+
+  /**
+   * @brief Database.
+   * 
+   */
+  Database& database_;
+
+  /**
+   * @brief Options.
+   * 
+   */
+  ServerOptions options_;
+
+  /**
+   * @brief Lock taken exclusively by queries that change tables, and
+   * shared by every other request.
+   * 
+   */
+  std::shared_mutex schema_mutex_;
+
+  /**
+   * @brief Mutex of the LSNs acknowledged by followers.
+   * 
+   */
+  std::mutex replication_mutex_;
+
+  /**
+   * @brief LSN each follower has read up to, by table and shard.
+   * 
+   */
+  std::map<
+    std::pair<TableName, uint64_t>,
+    std::map<std::string, uint64_t>
+  > acknowledged_;
+
+  /**
+   * @brief File descriptor of the listening socket, or -1.
+   * 
+   */
+  int listen_fd_{-1};
+
+  /**
+   * @brief File descriptor of the epoll instance, or -1.
+   * 
+   */
+  int epoll_fd_{-1};
+
+  /**
+   * @brief File descriptor of the eventfd that wakes the loop, or -1.
+   * 
+   */
+  int wake_fd_{-1};
+
+  /**
+   * @brief Port listened on.
+   * 
+   */
+  std::atomic<uint16_t> port_{0};
+
+  /**
+   * @brief Flag for stopping the loop.
+   * 
+   */
+  std::atomic<bool> stopping_{false};
+
+  /**
+   * @brief Open connections by file descriptor, only touched by the loop.
+   * 
+   */
+  std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+
+  /**
+   * @brief Mutex for the connections with responses to write.
+   * 
+   */
+  std::mutex ready_mutex_;
+
+  /**
+   * @brief Connections with responses to write.
+   * 
+   */
+  std::vector<std::weak_ptr<Connection>> ready_;
+
+  /**
+   * @brief Worker threads, or null if the server is not started.
+   * 
+   */
+  std::unique_ptr<ThreadPool> workers_;
+
+  /**
+   * @brief Loop thread.
+   * 
+   */
+  std::thread loop_;
+};
+}  // namespace vkdb
+
+#endif // SERVER_SERVER_H
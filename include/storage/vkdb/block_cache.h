@@ -0,0 +1,215 @@
+#ifndef STORAGE_BLOCK_CACHE_H
+#define STORAGE_BLOCK_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief A thread-safe cache of decoded SSTable blocks, bounded in bytes.
+ * @details Blocks are keyed by the ID of the SSTable that owns them and
+ * their offset in its data file. Each SSTable takes a fresh ID, so blocks of
+ * removed SSTables are never hit again and simply age out. Blocks are held
+ * type-erased, so one cache can be shared by LSM trees of any value type.
+ * The cache is split into independently locked shards, each evicting its
+ * least recently used blocks once over its share of the budget.
+ * 
+ */
+class BlockCache {
+public:
+  using size_type = uint64_t;
+  using owner_type = uint64_t;
+
+  /**
+   * @brief Type alias for a cached block.
+   * 
+   */
+  using Block = std::shared_ptr<const void>;
+
+  /**
+   * @brief Default number of shards.
+   * 
+   */
+  static constexpr size_type DEFAULT_SHARD_COUNT{16};
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  BlockCache() = delete;
+
+  /**
+   * @brief Construct a new BlockCache object given a budget.
+   * 
+   * @param capacity Budget in bytes.
+   * @param shard_count Number of shards.
+   * 
+   * @throw std::invalid_argument If the budget or the number of shards is 0.
+   */
+  explicit BlockCache(
+    size_type capacity,
+    size_type shard_count = DEFAULT_SHARD_COUNT
+  );
+
+  /**
+   * @brief Move-construct a BlockCache object.
+   * 
+   */
+  BlockCache(BlockCache&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a BlockCache object.
+   * 
+   */
+  BlockCache& operator=(BlockCache&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  BlockCache(const BlockCache&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  BlockCache& operator=(const BlockCache&) = delete;
+
+  /**
+   * @brief Destroy the BlockCache object.
+   * 
+   */
+  ~BlockCache() noexcept = default;
+
+  /**
+   * @brief Get a fresh owner ID.
+   * @details IDs are unique within the process.
+   * 
+   * @return owner_type Owner ID.
+   */
+  [[nodiscard]] static owner_type newOwner() noexcept;
+
+  /**
+   * @brief Look up a block and mark it as recently used.
+   * 
+   * @param owner Owner ID.
+   * @param offset Offset of the block.
+   * @return Block The block if it is cached, null otherwise.
+   */
+  [[nodiscard]] Block tryGet(owner_type owner, size_type offset) const;
+
+  /**
+   * @brief Put a block into the cache.
+   * @details Evicts least recently used blocks of the same shard until the
+   * shard is within its budget. Blocks larger than the budget of a shard are
+   * not cached.
+   * 
+   * @param owner Owner ID.
+   * @param offset Offset of the block.
+   * @param block Block.
+   * @param charge Size of the block in bytes.
+   */
+  void put(owner_type owner, size_type offset, Block block, size_type charge);
+
+  /**
+   * @brief Get the budget of the cache.
+   * 
+   * @return size_type Budget in bytes.
+   */
+  [[nodiscard]] size_type capacity() const noexcept;
+
+  /**
+   * @brief Get the bytes charged by the cached blocks.
+   * 
+   * @return size_type Usage in bytes.
+   */
+  [[nodiscard]] size_type usage() const noexcept;
+
+  /**
+   * @brief Get the number of cached blocks.
+   * 
+   * @return size_type Number of blocks.
+   */
+  [[nodiscard]] size_type size() const noexcept;
+
+  /**
+   * @brief Clear the cache.
+   * 
+   */
+  void clear() noexcept;
+
+private:
+  /**
+   * @brief Key of a cached block.
+   * 
+   */
+  struct Key {
+    owner_type owner;
+    size_type offset;
+
+    [[nodiscard]] bool operator==(const Key&) const noexcept = default;
+  };
+
+  /**
+   * @brief Hash of the key of a cached block.
+   * 
+   */
+  struct KeyHash {
+    [[nodiscard]] size_t operator()(const Key& key) const noexcept;
+  };
+
+  /**
+   * @brief Cached block with its key and charge.
+   * 
+   */
+  struct Entry {
+    Key key;
+    Block block;
+    size_type charge;
+  };
+
+  /**
+   * @brief Independently locked part of the cache.
+   * @details The list is ordered from most to least recently used.
+   * 
+   */
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> positions;
+    size_type usage{0};
+  };
+
+  /**
+   * @brief Get the shard of a key.
+   * 
+   * @param key Key.
+   * @return Shard& Shard.
+   */
+  [[nodiscard]] Shard& shard_for(const Key& key) const noexcept;
+
+  /**
+   * @brief Budget in bytes.
+   * 
+   */
+  size_type capacity_;
+
+  /**
+   * @brief Budget of each shard in bytes.
+   * 
+   */
+  size_type shard_capacity_;
+
+  /**
+   * @brief Shards.
+   * 
+   */
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_BLOCK_CACHE_H
@@ -0,0 +1,393 @@
+#ifndef STORAGE_BLOCK_CODEC_H
+#define STORAGE_BLOCK_CODEC_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <vkdb/concepts.h>
+#include <vkdb/binary.h>
+#include <bit>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Unsigned integer type with the same width as a value type.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+using ValueBits = std::conditional_t<sizeof(TValue) == 1, uint8_t,
+  std::conditional_t<sizeof(TValue) == 2, uint16_t,
+  std::conditional_t<sizeof(TValue) == 4, uint32_t, uint64_t>>>;
+
+/**
+ * @brief Whether the values of a type are stored in a columnar block as
+ * deltas from the previous value of their series, rather than as XORs.
+ * @details Integer counters and gauges change by small amounts whose bit
+ * patterns can still differ in many places, as when a carry ripples
+ * through, so their zigzag deltas have more leading zero bytes.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+inline constexpr bool DELTA_ENCODED_VALUES{
+  std::is_integral_v<TValue> && !std::is_same_v<TValue, bool>
+};
+
+/**
+ * @brief Get the residual of a value against the previous value of its
+ * series, as stored in a columnar block.
+ * @details The residual is the zigzag delta of integer values, wrapping on
+ * overflow, and the XOR of any other values.
+ * 
+ * @tparam TValue Value type.
+ * @param bits Bits of the value.
+ * @param previous Bits of the previous value.
+ * @return ValueBits<TValue> Residual.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+[[nodiscard]] constexpr ValueBits<TValue> valueResidual(
+  ValueBits<TValue> bits,
+  ValueBits<TValue> previous
+) noexcept {
+  using Bits = ValueBits<TValue>;
+  if constexpr (DELTA_ENCODED_VALUES<TValue>) {
+    const auto delta{static_cast<Bits>(bits - previous)};
+    const auto sign{static_cast<Bits>(-(delta >> (8 * sizeof(Bits) - 1)))};
+    return static_cast<Bits>(static_cast<Bits>(delta << 1) ^ sign);
+  } else {
+    return static_cast<Bits>(bits ^ previous);
+  }
+}
+
+/**
+ * @brief Invert valueResidual().
+ * 
+ * @tparam TValue Value type.
+ * @param residual Residual.
+ * @param previous Bits of the previous value.
+ * @return ValueBits<TValue> Bits of the value.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+[[nodiscard]] constexpr ValueBits<TValue> applyValueResidual(
+  ValueBits<TValue> residual,
+  ValueBits<TValue> previous
+) noexcept {
+  using Bits = ValueBits<TValue>;
+  if constexpr (DELTA_ENCODED_VALUES<TValue>) {
+    const auto sign{static_cast<Bits>(-(residual & 1))};
+    const auto delta{static_cast<Bits>((residual >> 1) ^ sign)};
+    return static_cast<Bits>(previous + delta);
+  } else {
+    return static_cast<Bits>(residual ^ previous);
+  }
+}
+
+/**
+ * @brief Control byte of a tombstone in a columnar block.
+ * 
+ */
+inline constexpr uint8_t BLOCK_CODEC_TOMBSTONE{0x80};
+
+/**
+ * @brief Encoder of a columnar SSTable block.
+ * @details A block starts with a dictionary of the series in it, each stored
+ * once. Every entry is then the dictionary index of its series, the
+ * zigzag varint delta-of-delta of its timestamp against the previous
+ * entries of its series, and the residual of its value against the previous
+ * value of its series, as given by valueResidual(). The residual is stored
+ * as a control byte, giving the number of trailing zero bytes and of
+ * meaningful bytes, followed by the meaningful bytes, so regular timestamps
+ * and slowly-changing values take a few bytes per entry. Values are stored
+ * at the width of their type, so a bool takes at most one byte.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class BlockEncoder {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Add an entry.
+   * @details Entries must be added in key order.
+   * 
+   * @param key Key.
+   * @param value Value, or std::nullopt for a tombstone.
+   * 
+   * @throw std::length_error If a string in the key is too long to encode.
+   */
+  void add(const TimeSeriesKey& key, const std::optional<TValue>& value) {
+    auto [it, inserted]{
+      series_indices_.try_emplace(key.seriesId(), series_states_.size())
+    };
+    if (inserted) {
+      append_series(key);
+      series_states_.push_back({key});
+    }
+    auto& state{series_states_[it->second]};
+    appendVarint(entries_, it->second);
+
+    const auto delta{key.timestamp() - state.timestamp};
+    appendVarint(entries_, zigzagEncode(static_cast<int64_t>(delta - state.delta)));
+    state.timestamp = key.timestamp();
+    state.delta = delta;
+
+    if (!value.has_value()) {
+      entries_.push_back(static_cast<char>(BLOCK_CODEC_TOMBSTONE));
+    } else {
+      const auto bits{std::bit_cast<ValueBits<TValue>>(value.value())};
+      append_residual(valueResidual<TValue>(bits, state.bits));
+      state.bits = bits;
+    }
+    ++entry_count_;
+  }
+
+  /**
+   * @brief Get the number of entries added.
+   * 
+   * @return uint32_t Number of entries.
+   */
+  [[nodiscard]] uint32_t entryCount() const noexcept {
+    return entry_count_;
+  }
+
+  /**
+   * @brief Get the size of the encoded block so far.
+   * 
+   * @return size_type Size in bytes.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    return dictionary_.size() + entries_.size();
+  }
+
+  /**
+   * @brief Append the encoded block to a buffer, and reset the encoder.
+   * 
+   * @param buffer Buffer.
+   */
+  void finish(std::string& buffer) {
+    appendVarint(buffer, series_states_.size());
+    buffer.append(dictionary_);
+    buffer.append(entries_);
+    dictionary_.clear();
+    entries_.clear();
+    series_indices_.clear();
+    series_states_.clear();
+    entry_count_ = 0;
+  }
+
+private:
+  /**
+   * @brief State of a series within the block.
+   * @details Holds a key of the series, so that the series keeps its ID
+   * while the block is encoded.
+   * 
+   */
+  struct SeriesState {
+    TimeSeriesKey series_key;
+    Timestamp timestamp{0};
+    Timestamp delta{0};
+    ValueBits<TValue> bits{0};
+  };
+
+  /**
+   * @brief Append the metric and tags of a key to the dictionary.
+   * 
+   * @param key Key.
+   * 
+   * @throw std::length_error If a string in the key is too long to encode.
+   */
+  void append_series(const TimeSeriesKey& key) {
+    appendBinary(dictionary_, std::string_view{key.metric()});
+    appendBinary(dictionary_, static_cast<BinaryLength>(key.tags().size()));
+    for (const auto& [tag_key, tag_value] : key.tags()) {
+      appendBinary(dictionary_, std::string_view{tag_key});
+      appendBinary(dictionary_, std::string_view{tag_value});
+    }
+  }
+
+  /**
+   * @brief Append the residual of a value against the previous value of its
+   * series.
+   * 
+   * @param bits Residual.
+   */
+  void append_residual(ValueBits<TValue> bits) {
+    if (bits == 0) {
+      entries_.push_back(0);
+      return;
+    }
+    const auto trailing{std::countr_zero(bits) / 8};
+    const auto leading{std::countl_zero(bits) / 8};
+    const auto meaningful{static_cast<int>(sizeof(bits)) - trailing - leading};
+    entries_.push_back(static_cast<char>((trailing << 4) | meaningful));
+    auto shifted{static_cast<uint64_t>(bits) >> (8 * trailing)};
+    for (auto i{0}; i < meaningful; ++i) {
+      entries_.push_back(static_cast<char>(shifted & 0xFF));
+      shifted >>= 8;
+    }
+  }
+
+  /**
+   * @brief Encoded series dictionary.
+   * 
+   */
+  std::string dictionary_;
+
+  /**
+   * @brief Encoded entries.
+   * 
+   */
+  std::string entries_;
+
+  /**
+   * @brief Dictionary index of each series.
+   * 
+   */
+  std::unordered_map<SeriesId, size_type> series_indices_;
+
+  /**
+   * @brief State of each series, by dictionary index.
+   * 
+   */
+  std::vector<SeriesState> series_states_;
+
+  /**
+   * @brief Number of entries.
+   * 
+   */
+  uint32_t entry_count_{0};
+};
+
+/**
+ * @brief Decoder of a columnar SSTable block, as written by BlockEncoder.
+ * @details The series dictionary is read up front, and entries are decoded
+ * one at a time.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class BlockDecoder {
+public:
+  using value_type = std::pair<const TimeSeriesKey, std::optional<TValue>>;
+
+  /**
+   * @brief Construct a new BlockDecoder object at the start of a block.
+   * @details Interns the series of the dictionary.
+   * 
+   * @param pos Start of the block payload.
+   * @param end End of the buffer.
+   * 
+   * @throw std::runtime_error If the dictionary is malformed.
+   */
+  BlockDecoder(const char* pos, const char* end) : pos_{pos}, end_{end} {
+    const auto no_of_series{readVarint(pos_, end_)};
+    for (uint64_t i{0}; i < no_of_series; ++i) {
+      Metric metric{readBinaryString(pos_, end_)};
+      const auto no_of_tags{readBinary<BinaryLength>(pos_, end_)};
+      TagTable tags;
+      for (BinaryLength j{0}; j < no_of_tags; ++j) {
+        TagKey tag_key{readBinaryString(pos_, end_)};
+        TagValue tag_value{readBinaryString(pos_, end_)};
+        tags.emplace(std::move(tag_key), std::move(tag_value));
+      }
+      series_states_.push_back({
+        TimeSeriesKey{0, std::move(metric), std::move(tags)}
+      });
+    }
+  }
+
+  /**
+   * @brief Decode the next entry.
+   * 
+   * @return value_type Entry.
+   * 
+   * @throw std::runtime_error If the entry is malformed.
+   */
+  [[nodiscard]] value_type next() {
+    const auto index{readVarint(pos_, end_)};
+    if (index >= series_states_.size()) {
+      throw std::runtime_error{"BlockDecoder::next(): Invalid series index."};
+    }
+    auto& state{series_states_[index]};
+
+    const auto delta_of_delta{zigzagDecode(readVarint(pos_, end_))};
+    state.delta += static_cast<Timestamp>(delta_of_delta);
+    state.timestamp += state.delta;
+    TimeSeriesKey key{state.timestamp, state.series_key.series()};
+
+    const auto control{readBinary<uint8_t>(pos_, end_)};
+    if (control == BLOCK_CODEC_TOMBSTONE) {
+      return {std::move(key), std::nullopt};
+    }
+    state.bits = applyValueResidual<TValue>(
+      read_residual(control), state.bits
+    );
+    return {std::move(key), std::bit_cast<TValue>(state.bits)};
+  }
+
+private:
+  /**
+   * @brief State of a series within the block.
+   * 
+   */
+  struct SeriesState {
+    TimeSeriesKey series_key;
+    Timestamp timestamp{0};
+    Timestamp delta{0};
+    ValueBits<TValue> bits{0};
+  };
+
+  /**
+   * @brief Read the residual of a value against the previous value of its
+   * series.
+   * 
+   * @param control Control byte.
+   * @return ValueBits<TValue> Residual.
+   * 
+   * @throw std::runtime_error If the residual is malformed.
+   */
+  [[nodiscard]] ValueBits<TValue> read_residual(uint8_t control) {
+    const auto trailing{control >> 4};
+    const auto meaningful{control & 0x0F};
+    if (trailing + meaningful > static_cast<int>(sizeof(ValueBits<TValue>))) {
+      throw std::runtime_error{"BlockDecoder::read_residual(): Invalid control byte."};
+    }
+    if (end_ - pos_ < meaningful) {
+      throw std::runtime_error{"BlockDecoder::read_residual(): Unexpected end of buffer."};
+    }
+    uint64_t bits{0};
+    for (auto i{0}; i < meaningful; ++i) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(pos_[i])) << (8 * i);
+    }
+    pos_ += meaningful;
+    return static_cast<ValueBits<TValue>>(bits << (8 * trailing));
+  }
+
+  /**
+   * @brief Position of the next entry.
+   * 
+   */
+  const char* pos_;
+
+  /**
+   * @brief End of the buffer.
+   * 
+   */
+  const char* end_;
+
+  /**
+   * @brief State of each series, by dictionary index.
+   * 
+   */
+  std::vector<SeriesState> series_states_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_BLOCK_CODEC_H
@@ -0,0 +1,249 @@
+#ifndef STORAGE_BLOCK_STATS_H
+#define STORAGE_BLOCK_STATS_H
+
+#include <vkdb/concepts.h>
+#include <vkdb/binary.h>
+#include <algorithm>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Type of the sum of a set of values.
+ * @details Integer and bool values are summed in 64 bits of their
+ * signedness, so sums of narrow counters do not overflow, and sums of bools
+ * count the true values. Floating-point values are summed as doubles.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+using StatsSum = std::conditional_t<std::is_floating_point_v<TValue>, double,
+  std::conditional_t<std::is_signed_v<TValue>, int64_t, uint64_t>>;
+
+/**
+ * @brief Count, sum, minimum, and maximum of a set of values.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+struct SeriesStats {
+  using size_type = uint64_t;
+
+  /**
+   * @brief Add a value.
+   * 
+   * @param value Value.
+   */
+  void add(TValue value) noexcept {
+    if (count == 0) {
+      min = value;
+      max = value;
+    } else {
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+    sum += static_cast<StatsSum<TValue>>(value);
+    ++count;
+  }
+
+  /**
+   * @brief Merge the statistics of another set of values.
+   * 
+   * @param other Statistics.
+   */
+  void merge(const SeriesStats& other) noexcept {
+    if (other.count == 0) {
+      return;
+    }
+    if (count == 0) {
+      *this = other;
+      return;
+    }
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+    count += other.count;
+  }
+
+  /**
+   * @brief Append the binary encoding of the statistics to a buffer.
+   * 
+   * @param buffer Buffer.
+   */
+  void toBinary(std::string& buffer) const {
+    appendBinary(buffer, count);
+    appendBinary(buffer, sum);
+    appendBinary(buffer, min);
+    appendBinary(buffer, max);
+  }
+
+  /**
+   * @brief Read binary-encoded statistics from a buffer.
+   * @details Advances the position past the statistics.
+   * 
+   * @param pos Position in the buffer.
+   * @param end End of the buffer.
+   * @return SeriesStats Statistics.
+   * 
+   * @throw std::runtime_error If the buffer is too short.
+   */
+  [[nodiscard]] static SeriesStats fromBinary(const char*& pos, const char* end) {
+    SeriesStats stats;
+    stats.count = readBinary<size_type>(pos, end);
+    stats.sum = readBinary<StatsSum<TValue>>(pos, end);
+    stats.min = readBinary<TValue>(pos, end);
+    stats.max = readBinary<TValue>(pos, end);
+    return stats;
+  }
+
+  /**
+   * @brief Number of values.
+   * 
+   */
+  size_type count{0};
+
+  /**
+   * @brief Sum of the values.
+   * 
+   */
+  StatsSum<TValue> sum{};
+
+  /**
+   * @brief Minimum value, if there are any values.
+   * 
+   */
+  TValue min{};
+
+  /**
+   * @brief Maximum value, if there are any values.
+   * 
+   */
+  TValue max{};
+};
+
+/**
+ * @brief Statistics of the values of each series in a block of an SSTable.
+ * @details Series are referred to by their index in the SSTable. Tombstones
+ * are not counted. Blocks holding more than MAX_SERIES series keep no
+ * statistics, and have to be read.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class BlockStats {
+public:
+  using size_type = uint64_t;
+  using series_index = uint32_t;
+
+  /**
+   * @brief Type alias for the statistics of a series.
+   * 
+   */
+  using Entry = std::pair<series_index, SeriesStats<TValue>>;
+
+  /**
+   * @brief Maximum number of series whose statistics are kept.
+   * 
+   */
+  static constexpr size_type MAX_SERIES{8};
+
+  /**
+   * @brief Add a value of a series.
+   * 
+   * @param series Series index.
+   * @param value Value.
+   */
+  void add(series_index series, TValue value) {
+    if (!available_) {
+      return;
+    }
+    auto it{std::ranges::find(entries_, series, &Entry::first)};
+    if (it == entries_.end()) {
+      if (entries_.size() == MAX_SERIES) {
+        available_ = false;
+        entries_.clear();
+        return;
+      }
+      it = entries_.insert(it, Entry{series, {}});
+    }
+    it->second.add(value);
+  }
+
+  /**
+   * @brief Check if the block has statistics.
+   * 
+   * @return true if the block has statistics.
+   * @return false if the block holds too many series.
+   */
+  [[nodiscard]] bool available() const noexcept {
+    return available_;
+  }
+
+  /**
+   * @brief Get the statistics of each series.
+   * 
+   * @return std::span<const Entry> Statistics.
+   */
+  [[nodiscard]] std::span<const Entry> entries() const noexcept {
+    return entries_;
+  }
+
+  /**
+   * @brief Append the binary encoding of the statistics to a buffer.
+   * @details The statistics are encoded as an availability flag, followed by
+   * the counted series indices and their raw statistics.
+   * 
+   * @param buffer Buffer.
+   */
+  void toBinary(std::string& buffer) const {
+    appendBinary(buffer, static_cast<uint8_t>(available_));
+    appendBinary(buffer, static_cast<uint32_t>(entries_.size()));
+    for (const auto& [series, stats] : entries_) {
+      appendBinary(buffer, series);
+      stats.toBinary(buffer);
+    }
+  }
+
+  /**
+   * @brief Read binary-encoded statistics from a buffer.
+   * @details Advances the position past the statistics.
+   * 
+   * @param pos Position in the buffer.
+   * @param end End of the buffer.
+   * @return BlockStats Statistics.
+   * 
+   * @throw std::runtime_error If the buffer is too short.
+   */
+  [[nodiscard]] static BlockStats fromBinary(const char*& pos, const char* end) {
+    BlockStats block_stats;
+    block_stats.available_ = readBinary<uint8_t>(pos, end) != 0;
+    const auto no_of_entries{readBinary<uint32_t>(pos, end)};
+    for (uint32_t i{0}; i < no_of_entries; ++i) {
+      const auto series{readBinary<series_index>(pos, end)};
+      block_stats.entries_.emplace_back(
+        series, SeriesStats<TValue>::fromBinary(pos, end)
+      );
+    }
+    return block_stats;
+  }
+
+private:
+  /**
+   * @brief Statistics of each series.
+   * 
+   */
+  std::vector<Entry> entries_;
+
+  /**
+   * @brief Whether the block has statistics.
+   * 
+   */
+  bool available_{true};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_BLOCK_STATS_H
@@ -1,22 +1,30 @@
 #ifndef STORAGE_BLOOM_FILTER_H
 #define STORAGE_BLOOM_FILTER_H
 
-#include <vkdb/murmur_hash_3.h>
 #include <vkdb/time_series_key.h>
-#include <vkdb/random.h>
+#include <vkdb/series_dictionary.h>
+#include <vkdb/binary.h>
+#include <array>
+#include <span>
 #include <vector>
+#include <string>
 #include <stdexcept>
 #include <cmath>
 
 namespace vkdb {
 /**
- * @brief Bloom filter for time series keys.
+ * @brief Blocked Bloom filter for time series keys.
+ * @details The bits are split into cache-line-sized blocks. Each key is
+ * hashed once; the hash picks a block, and every probe for the key is
+ * derived from the same hash by double hashing and falls within that block,
+ * so a lookup touches a single cache line.
  * 
  */
 class BloomFilter {
 public:
   using key_type = TimeSeriesKey;
   using size_type = uint64_t;
+  using hash_type = uint64_t;
 
   /**
    * @brief Minimum (exclusive) false positive rate.
@@ -31,17 +39,25 @@ public:
   static constexpr double MAX_FALSE_POSITIVE_RATE{1.0};
 
   /**
-   * @brief Deleted default constructor.
+   * @brief Number of bits per block.
    * 
    */
-  BloomFilter() = delete;
+  static constexpr size_type BLOCK_BITS{512};
 
   /**
-   * @brief Construct a new BloomFilter object from the given string.
+   * @brief Factor by which the filter is oversized.
+   * @details Keys are not spread evenly across blocks, so a blocked filter
+   * needs slightly more bits than a classic one for the same false positive
+   * rate.
    * 
-   * @param str The string representation of the Bloom filter.
    */
-  BloomFilter(std::string&& str) noexcept;
+  static constexpr double BLOCKING_OVERHEAD{1.15};
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  BloomFilter() = delete;
 
   /**
    * @brief Construct a new BloomFilter object from the given expected number of
@@ -89,6 +105,31 @@ public:
    */
   BloomFilter& operator=(const BloomFilter&) = delete;
 
+  /**
+   * @brief Read a binary-encoded Bloom filter from a buffer.
+   * @details Advances the position past the Bloom filter.
+   * 
+   * @param pos Position in the buffer.
+   * @param end End of the buffer.
+   * @return BloomFilter Bloom filter.
+   * 
+   * @throw std::runtime_error If the buffer is too short or the encoding is
+   * invalid.
+   */
+  [[nodiscard]] static BloomFilter fromBinary(
+    const char*& pos,
+    const char* end
+  );
+
+  /**
+   * @brief Append the binary encoding of the Bloom filter to a buffer.
+   * @details The Bloom filter is encoded as the number of blocks and probes,
+   * followed by the raw bytes of the blocks.
+   * 
+   * @param buffer Buffer.
+   */
+  void toBinary(std::string& buffer) const;
+
   /**
    * @brief Insert a key into the Bloom filter.
    * 
@@ -106,50 +147,106 @@ public:
   [[nodiscard]] bool mayContain(const key_type& key) const noexcept;
 
   /**
-   * @brief Get the string representation of the Bloom filter.
+   * @brief Check if the Bloom filter may contain a pre-hashed key.
    * 
-   * @return std::string The string representation of the Bloom filter.
+   * @param hash The hash of the key, as given by hash().
+   * @return true if the Bloom filter may contain the key.
+   * @return false if the Bloom filter does not contain the key.
    */
-  [[nodiscard]] std::string str() const noexcept;
+  [[nodiscard]] bool mayContain(hash_type hash) const noexcept;
+
+  /**
+   * @brief Check if the Bloom filter may contain each of a batch of
+   * pre-hashed keys.
+   * @details The block of each key is prefetched a few keys ahead of the
+   * one being tested, so the cache misses of the batch overlap. The probes
+   * of a key are tested together with AVX2 or NEON where available, and
+   * one by one otherwise.
+   * 
+   * @param hashes The hashes of the keys, as given by hash().
+   * @param results Whether the Bloom filter may contain each key. Only the
+   * first min(hashes.size(), results.size()) results are written.
+   */
+  void mayContainBatch(
+    std::span<const hash_type> hashes,
+    std::span<bool> results
+  ) const noexcept;
+
+  /**
+   * @brief Hash a key.
+   * @details Mixes the interned hash of the key's series with its timestamp,
+   * so no strings are hashed. The hash is stable across processes.
+   * 
+   * @param key Key.
+   * @return hash_type Hash value.
+   */
+  [[nodiscard]] static hash_type hash(const key_type& key) noexcept;
+
+  /**
+   * @brief Get the number of blocks.
+   * 
+   * @return size_type Number of blocks.
+   */
+  [[nodiscard]] size_type blockCount() const noexcept;
+
+  /**
+   * @brief Get the number of probes per key.
+   * 
+   * @return uint32_t Number of probes.
+   */
+  [[nodiscard]] uint32_t probeCount() const noexcept;
 
 private:
   /**
-   * @brief Type alias for uint32_t.
+   * @brief Block of bits, aligned to a cache line.
    * 
    */
-  using HashValue = uint32_t;
+  struct alignas(64) Block {
+    std::array<uint64_t, BLOCK_BITS / 64> words{};
+  };
 
   /**
-   * @brief Initialise the seeds for the hash functions.
+   * @brief Construct a new BloomFilter object with the given number of blocks
+   * and probes.
    * 
-   * @param no_of_hashes Number of hash functions.
+   * @param no_of_blocks Number of blocks.
+   * @param no_of_probes Number of probes.
    */
-  void initialise_seeds(size_type no_of_hashes) noexcept;
+  BloomFilter(size_type no_of_blocks, uint32_t no_of_probes);
 
   /**
-   * @brief Hash a key with the given seed index.
+   * @brief Get the block a hash maps to.
    * 
-   * @param key Key.
-   * @param i Seed index.
-   * @return HashValue Hash value.
+   * @param hash Hash value.
+   * @return size_type Block index.
+   */
+  [[nodiscard]] size_type block_index(hash_type hash) const noexcept;
+
+  /**
+   * @brief Test the probes of a pre-hashed key against its block.
+   * 
+   * @param block Block.
+   * @param hash Hash value.
+   * @return true if every probed bit is set.
+   * @return false if a probed bit is not set.
    */
-  [[nodiscard]] HashValue hash(
-    const key_type& key,
-    size_type i
+  [[nodiscard]] bool test_block(
+    const Block& block,
+    hash_type hash
   ) const noexcept;
 
   /**
-   * @brief Seeds.
+   * @brief Number of probes per key.
    * 
    */
-  std::vector<size_type> seeds_;
+  uint32_t no_of_probes_;
 
   /**
-   * @brief Bit vector.
+   * @brief Blocks.
    * 
    */
-  std::vector<bool> bits_;
+  std::vector<Block> blocks_;
 };
 }  // namespace vkdb
 
-#endif // STORAGE_BLOOM_FILTER_H
\ No newline at end of file
+#endif // STORAGE_BLOOM_FILTER_H
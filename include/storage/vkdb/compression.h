@@ -0,0 +1,57 @@
+#ifndef STORAGE_COMPRESSION_H
+#define STORAGE_COMPRESSION_H
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief General-purpose compression codec.
+ * @details LZ4 is built in, and favours speed. Zstd compresses further, and
+ * is only available if vkdb was built against libzstd.
+ * 
+ */
+enum class Compression : uint8_t {
+  NONE,
+  LZ4,
+  ZSTD
+};
+
+/**
+ * @brief Check if a codec is available in this build.
+ * 
+ * @param codec Codec.
+ * @return true if data can be compressed and decompressed with the codec.
+ * @return false otherwise.
+ */
+[[nodiscard]] bool compressionAvailable(Compression codec) noexcept;
+
+/**
+ * @brief Compress data.
+ * @details The output does not record the size of the data, which has to be
+ * kept alongside it for decompression. NONE returns the data as is.
+ * 
+ * @param codec Codec.
+ * @param data Data.
+ * @return std::string Compressed data.
+ * 
+ * @throw std::invalid_argument If the codec is not available.
+ */
+[[nodiscard]] std::string compress(Compression codec, std::string_view data);
+
+/**
+ * @brief Decompress data into a buffer of its exact decompressed size.
+ * 
+ * @param codec Codec.
+ * @param data Compressed data.
+ * @param out Buffer.
+ * 
+ * @throw std::runtime_error If the codec is not available, or if the data is
+ * malformed or does not decompress to exactly the size of the buffer.
+ */
+void decompress(Compression codec, std::string_view data, std::span<char> out);
+}  // namespace vkdb
+
+#endif // STORAGE_COMPRESSION_H
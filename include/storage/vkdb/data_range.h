@@ -176,6 +176,16 @@ public:
     return range_.second;
   }
 
+  /**
+   * @brief Check if the range is set.
+   * 
+   * @return true if the range is set.
+   * @return false if the range is not set.
+   */
+  [[nodiscard]] bool isSet() const noexcept {
+    return is_set_;
+  }
+
   /**
    * @brief Clear the range.
    * 
@@ -207,7 +217,7 @@ private:
    * @brief Flag to indicate if the range is set.
    * 
    */
-  bool is_set_;
+  bool is_set_{false};
 
   /**
    * @brief The lower and upper bounds of the range.
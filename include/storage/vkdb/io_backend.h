@@ -0,0 +1,101 @@
+#ifndef STORAGE_IO_BACKEND_H
+#define STORAGE_IO_BACKEND_H
+
+#include <filesystem>
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Backend that writes files.
+ * @details POSIX writes with blocking system calls, and is always available.
+ * IO_URING submits each write, and the sync that follows it, as linked
+ * operations on an io_uring owned by the calling thread, and is only
+ * available on Linux builds whose kernel allows io_uring. Requesting an
+ * unavailable backend falls back to POSIX.
+ * 
+ */
+enum class IOBackend : uint8_t {
+  POSIX,
+  IO_URING
+};
+
+/**
+ * @brief Result of a write.
+ * 
+ */
+struct IOResult {
+  /**
+   * @brief Number of bytes written.
+   * 
+   */
+  uint64_t written{0};
+
+  /**
+   * @brief Error number of the failure, or 0 if the write succeeded.
+   * 
+   */
+  int error{0};
+
+  /**
+   * @brief Check if the write succeeded.
+   * 
+   * @return true if every byte was written, and synced if asked to.
+   * @return false otherwise.
+   */
+  [[nodiscard]] explicit operator bool() const noexcept {
+    return error == 0;
+  }
+};
+
+/**
+ * @brief Check if a backend is available.
+ * @details The io_uring backend is probed once, by setting up a ring.
+ * 
+ * @param backend Backend.
+ * @return true if writes go through the backend.
+ * @return false if they fall back to POSIX.
+ */
+[[nodiscard]] bool ioBackendAvailable(IOBackend backend) noexcept;
+
+/**
+ * @brief Write data to a file descriptor at an offset, and optionally sync
+ * the data to disk.
+ * @details Short writes are retried until everything is written or an error
+ * occurs.
+ * 
+ * @param backend Backend.
+ * @param fd File descriptor, open for writing.
+ * @param offset Offset.
+ * @param data Data.
+ * @param sync Whether to sync the file's data once it is written.
+ * @return IOResult Result.
+ */
+[[nodiscard]] IOResult writeAt(
+  IOBackend backend,
+  int fd,
+  uint64_t offset,
+  std::string_view data,
+  bool sync
+) noexcept;
+
+/**
+ * @brief Replace the contents of a file, and optionally sync it to disk.
+ * @details The file is created if it does not exist.
+ * 
+ * @param backend Backend.
+ * @param path Path of the file.
+ * @param data Data.
+ * @param sync Whether to sync the file's data once it is written.
+ * 
+ * @throw std::runtime_error If the file cannot be opened, written or synced.
+ */
+void writeFile(
+  IOBackend backend,
+  const std::filesystem::path& path,
+  std::string_view data,
+  bool sync
+);
+}  // namespace vkdb
+
+#endif // STORAGE_IO_BACKEND_H
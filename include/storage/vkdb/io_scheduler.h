@@ -0,0 +1,345 @@
+#ifndef STORAGE_IO_SCHEDULER_H
+#define STORAGE_IO_SCHEDULER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Priority class of an I/O request, highest first.
+ * @details WAL appends are on the write path of every logged write, and
+ * foreground reads on that of every query, so both go before flushes, which
+ * only have to keep up with the memtables, and compactions, which can always
+ * wait.
+ *
+ */
+enum class IOPriority : uint8_t {
+  WAL,
+  READ,
+  FLUSH,
+  COMPACTION
+};
+
+/**
+ * @brief Options for an I/O scheduler.
+ *
+ */
+struct IOSchedulerOptions {
+  /**
+   * @brief Rate at which bytes may be written, or 0 for no limit.
+   *
+   */
+  uint64_t bytes_per_second{0};
+
+  /**
+   * @brief Capacity of the token bucket, in bytes.
+   * @details Bounds both the burst let through after an idle spell and the
+   * size of each grant, since larger requests are granted a chunk at a time.
+   * A request of higher priority therefore never waits behind more than one
+   * chunk of a lower one. It must be at least 1.
+   *
+   */
+  uint64_t burst_bytes{1 << 20};
+
+  /**
+   * @brief Foreground latency above which compaction backs off, or 0 never
+   * to back off.
+   * @details Foreground latency is a moving average of the point reads and
+   * the waits of WAL appends reported to the scheduler. While it is above
+   * the target, the share of the rate left to compaction is halved at each
+   * compaction request, down to min_compaction_share, and otherwise it grows
+   * back by a tenth of the rate.
+   *
+   */
+  std::chrono::nanoseconds foreground_latency_target{
+    std::chrono::milliseconds{5}
+  };
+
+  /**
+   * @brief Smallest share of the rate that compaction backs off to.
+   * @details It must be greater than 0 and at most 1.
+   *
+   */
+  double min_compaction_share{0.1};
+};
+
+/**
+ * @brief Token-bucket rate limiter that grants storage I/O by priority.
+ * @details Tokens are bytes, and refill continuously at the configured rate
+ * up to the bucket's capacity. A request waits while any request of higher
+ * priority is waiting, so when the bucket runs dry, WAL appends are served
+ * first, then foreground reads, then flushes, then compactions. Compaction
+ * requests cost more tokens per byte as the scheduler backs compaction off,
+ * which slows compaction without touching the other classes. May be shared
+ * by every LSM tree of a database, so that they all draw on one budget.
+ *
+ */
+class IOScheduler {
+public:
+  using size_type = uint64_t;
+  using clock_type = std::chrono::steady_clock;
+  using duration_type = std::chrono::nanoseconds;
+
+  /**
+   * @brief Number of priority classes.
+   *
+   */
+  static constexpr size_type PRIORITY_COUNT{4};
+
+  /**
+   * @brief Time after which a foreground latency no longer counts towards
+   * backing compaction off.
+   * @details Keeps compaction from staying backed off once the foreground
+   * has gone quiet.
+   *
+   */
+  static constexpr duration_type FOREGROUND_LATENCY_WINDOW{
+    std::chrono::seconds{1}
+  };
+
+  /**
+   * @brief Construct a new IOScheduler object with a full bucket.
+   *
+   * @param options Options.
+   *
+   * @throw std::invalid_argument If any option is out of range, as given by
+   * IOSchedulerOptions.
+   */
+  explicit IOScheduler(IOSchedulerOptions options = {});
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  IOScheduler(IOScheduler&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  IOScheduler& operator=(IOScheduler&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  IOScheduler(const IOScheduler&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  IOScheduler& operator=(const IOScheduler&) = delete;
+
+  /**
+   * @brief Destroy the IOScheduler object.
+   * @details No request may be waiting.
+   *
+   */
+  ~IOScheduler() noexcept = default;
+
+  /**
+   * @brief Block until a number of bytes may be read or written.
+   * @details Returns at once if there is no rate limit. WAL and read
+   * requests report how long they waited as foreground latency.
+   *
+   * @param priority Priority class.
+   * @param bytes Number of bytes.
+   */
+  void request(IOPriority priority, size_type bytes);
+
+  /**
+   * @brief Report the latency of a foreground operation.
+   * @details Lock-free, so it can be called on every point read.
+   *
+   * @param latency Latency.
+   */
+  void recordForegroundLatency(duration_type latency) noexcept;
+
+  /**
+   * @brief Get the share of the rate currently left to compaction.
+   *
+   * @return double Share, between min_compaction_share and 1.
+   */
+  [[nodiscard]] double compactionShare() const noexcept;
+
+  /**
+   * @brief Get the number of bytes granted to a priority class.
+   *
+   * @param priority Priority class.
+   * @return size_type Bytes granted since the scheduler was constructed.
+   */
+  [[nodiscard]] size_type grantedBytes(IOPriority priority) const noexcept;
+
+  /**
+   * @brief Get the options of the scheduler.
+   *
+   * @return IOSchedulerOptions Options.
+   */
+  [[nodiscard]] IOSchedulerOptions options() const noexcept;
+
+private:
+  /**
+   * @brief Add the tokens accrued since the last refill.
+   * @details Must be called with the mutex held.
+   *
+   * @param now Current time.
+   */
+  void refill(clock_type::time_point now) noexcept;
+
+  /**
+   * @brief Back compaction off if the foreground is slow, and let it
+   * recover otherwise.
+   * @details Must be called with the mutex held.
+   *
+   * @param now Current time.
+   */
+  void adapt(clock_type::time_point now) noexcept;
+
+  /**
+   * @brief Check if a request of higher priority is waiting.
+   * @details Must be called with the mutex held.
+   *
+   * @param priority Priority class.
+   * @return true if one is waiting.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool outranked(IOPriority priority) const noexcept;
+
+  /**
+   * @brief Options.
+   *
+   */
+  IOSchedulerOptions options_;
+
+  /**
+   * @brief Mutex guarding the bucket and the waiting requests.
+   *
+   */
+  std::mutex mutex_;
+
+  /**
+   * @brief Notified whenever a request is granted.
+   *
+   */
+  std::condition_variable granted_;
+
+  /**
+   * @brief Tokens in the bucket, which may go below 0 when a grant costs
+   * more than the bucket holds.
+   *
+   */
+  double tokens_;
+
+  /**
+   * @brief Time of the last refill.
+   *
+   */
+  clock_type::time_point refilled_;
+
+  /**
+   * @brief Number of waiting requests of each priority class.
+   *
+   */
+  std::array<size_type, PRIORITY_COUNT> waiting_{};
+
+  /**
+   * @brief Share of the rate left to compaction.
+   *
+   */
+  std::atomic<double> compaction_share_{1.0};
+
+  /**
+   * @brief Moving average of the foreground latency, in nanoseconds.
+   *
+   */
+  std::atomic<size_type> foreground_latency_{0};
+
+  /**
+   * @brief Time since the clock's epoch of the last foreground latency, in
+   * nanoseconds.
+   *
+   */
+  std::atomic<duration_type::rep> foreground_sampled_{0};
+
+  /**
+   * @brief Bytes granted to each priority class.
+   *
+   */
+  std::array<std::atomic<size_type>, PRIORITY_COUNT> granted_bytes_{};
+};
+
+/**
+ * @brief Reports the time from its construction to its destruction to an
+ * I/O scheduler as foreground latency.
+ *
+ */
+class ForegroundTimer {
+public:
+  using clock_type = IOScheduler::clock_type;
+
+  /**
+   * @brief Construct a new ForegroundTimer object, starting the timer.
+   *
+   * @param io_scheduler Scheduler, which must outlive the timer, or null to
+   * report nothing.
+   */
+  explicit ForegroundTimer(IOScheduler* io_scheduler) noexcept
+    : io_scheduler_{io_scheduler}
+    , start_{io_scheduler == nullptr ? clock_type::time_point{}
+                                     : clock_type::now()} {}
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  ForegroundTimer(ForegroundTimer&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  ForegroundTimer& operator=(ForegroundTimer&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  ForegroundTimer(const ForegroundTimer&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  ForegroundTimer& operator=(const ForegroundTimer&) = delete;
+
+  /**
+   * @brief Destroy the ForegroundTimer object, reporting the time elapsed.
+   *
+   */
+  ~ForegroundTimer() noexcept {
+    if (io_scheduler_ != nullptr) {
+      io_scheduler_->recordForegroundLatency(clock_type::now() - start_);
+    }
+  }
+
+private:
+  /**
+   * @brief Scheduler, or null.
+   *
+   */
+  IOScheduler* io_scheduler_;
+
+  /**
+   * @brief Time the timer started.
+   *
+   */
+  clock_type::time_point start_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_IO_SCHEDULER_H
@@ -0,0 +1,186 @@
+#ifndef STORAGE_KEY_FILTER_H
+#define STORAGE_KEY_FILTER_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/key_predicate.h>
+#include <concepts>
+#include <tuple>
+#include <utility>
+
+namespace vkdb {
+/**
+ * @brief Concept for a filter on a TimeSeriesKey whose type is known at
+ * compile time.
+ * @details Unlike a TimeSeriesKeyFilter, a key filter is not type-erased, so
+ * checking a key against it can be inlined into the scan. It can also add
+ * its clauses to a KeyPredicate, which must match exactly the keys it does,
+ * so that SSTables and blocks it rules out are skipped, and blocks it
+ * matches wholly are taken from their statistics.
+ * 
+ * @tparam T Type.
+ */
+template <typename T>
+concept KeyFilter = requires(
+  const T& filter,
+  const TimeSeriesKey& key,
+  KeyPredicate& predicate
+) {
+  { filter(key) } -> std::same_as<bool>;
+  filter.addTo(predicate);
+};
+
+/**
+ * @brief Key filter that matches every key.
+ * 
+ */
+struct AnyKey {
+  [[nodiscard]] bool operator()(const TimeSeriesKey&) const noexcept {
+    return true;
+  }
+
+  void addTo(KeyPredicate&) const noexcept {}
+};
+
+/**
+ * @brief Key filter that matches the keys with a metric.
+ * 
+ */
+struct MetricEq {
+  Metric metric;
+
+  [[nodiscard]] bool operator()(const TimeSeriesKey& key) const noexcept {
+    return key.metric() == metric;
+  }
+
+  void addTo(KeyPredicate& predicate) const {
+    predicate.requireAnyMetric({metric});
+  }
+};
+
+/**
+ * @brief Key filter that matches the keys with a tag.
+ * 
+ */
+struct TagEq {
+  TagKey key;
+  TagValue value;
+
+  [[nodiscard]] bool operator()(
+    const TimeSeriesKey& time_series_key
+  ) const noexcept {
+    const auto& tags{time_series_key.tags()};
+    const auto it{tags.find(key)};
+    return it != tags.end() && it->second == value;
+  }
+
+  void addTo(KeyPredicate& predicate) const {
+    predicate.requireAnyTag({Tag{key, value}});
+  }
+};
+
+/**
+ * @brief Key filter that matches the keys with a timestamp.
+ * 
+ */
+struct TimestampEq {
+  Timestamp timestamp;
+
+  [[nodiscard]] bool operator()(const TimeSeriesKey& key) const noexcept {
+    return key.timestamp() == timestamp;
+  }
+
+  void addTo(KeyPredicate& predicate) const {
+    predicate.requireAnyTimestamp({timestamp});
+  }
+};
+
+/**
+ * @brief Key filter that matches the keys matching a KeyPredicate.
+ * @details Brings a predicate built at runtime into a composed filter, at
+ * the cost of checking its clauses at runtime.
+ * 
+ */
+struct MatchesPredicate {
+  KeyPredicate predicate;
+
+  [[nodiscard]] bool operator()(const TimeSeriesKey& key) const noexcept {
+    return predicate.matches(key);
+  }
+
+  void addTo(KeyPredicate& other) const {
+    other.requireAll(predicate);
+  }
+};
+
+/**
+ * @brief Key filter that matches the keys matching all of its filters.
+ * @details Filters are checked in order, and checking stops at the first
+ * that fails.
+ * 
+ * @tparam TFilters Filter types.
+ */
+template <KeyFilter... TFilters>
+struct AllOf {
+  std::tuple<TFilters...> filters;
+
+  [[nodiscard]] bool operator()(const TimeSeriesKey& key) const noexcept {
+    return std::apply([&key](const auto&... filter) {
+      return (filter(key) && ...);
+    }, filters);
+  }
+
+  void addTo(KeyPredicate& predicate) const {
+    std::apply([&predicate](const auto&... filter) {
+      (filter.addTo(predicate), ...);
+    }, filters);
+  }
+};
+
+/**
+ * @brief Compose two key filters into one that matches the keys matching
+ * both.
+ * 
+ * @tparam TLeft Left filter type.
+ * @tparam TRight Right filter type.
+ * @param left Left filter.
+ * @param right Right filter.
+ * @return AllOf<TLeft, TRight> Composed filter.
+ */
+template <KeyFilter TLeft, KeyFilter TRight>
+[[nodiscard]] AllOf<TLeft, TRight> operator&&(TLeft left, TRight right) {
+  return {{std::move(left), std::move(right)}};
+}
+
+/**
+ * @brief Compose a conjunction with a key filter, flattening it.
+ * 
+ * @tparam TFilters Filter types of the conjunction.
+ * @tparam TRight Right filter type.
+ * @param left Conjunction.
+ * @param right Right filter.
+ * @return AllOf<TFilters..., TRight> Composed filter.
+ */
+template <KeyFilter... TFilters, KeyFilter TRight>
+[[nodiscard]] AllOf<TFilters..., TRight> operator&&(
+  AllOf<TFilters...> left,
+  TRight right
+) {
+  return {std::tuple_cat(std::move(left.filters), std::tuple{std::move(right)})};
+}
+
+/**
+ * @brief Get the KeyPredicate equivalent to a key filter.
+ * 
+ * @tparam TFilter Filter type.
+ * @param filter Filter.
+ * @return KeyPredicate Predicate.
+ */
+template <KeyFilter TFilter>
+[[nodiscard]] KeyPredicate toPredicate(const TFilter& filter) {
+  KeyPredicate predicate;
+  filter.addTo(predicate);
+  return predicate;
+}
+}  // namespace vkdb
+
+#endif // STORAGE_KEY_FILTER_H
@@ -0,0 +1,201 @@
+#ifndef STORAGE_KEY_PREDICATE_H
+#define STORAGE_KEY_PREDICATE_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <vkdb/series_summary.h>
+#include <vkdb/data_range.h>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace vkdb {
+/**
+ * @brief Structured predicate on a TimeSeriesKey.
+ * @details A conjunction of clauses, each of which requires a key to have
+ * any one of a set of metrics, tags, or timestamps. Unlike an opaque
+ * filter, the predicate can be checked against the summary of an SSTable
+ * and the token mask of a block, so a scan can skip both without reading
+ * their entries. The empty predicate matches every key.
+ * 
+ */
+class KeyPredicate {
+public:
+  using mask_type = SeriesSummary::mask_type;
+
+  /**
+   * @brief Construct a new KeyPredicate object matching every key.
+   * 
+   */
+  KeyPredicate() noexcept = default;
+
+  /**
+   * @brief Require a key to have any of the given metrics.
+   * 
+   * @param metrics Metrics.
+   * @return KeyPredicate& Reference to the predicate.
+   */
+  KeyPredicate& requireAnyMetric(std::vector<Metric> metrics);
+
+  /**
+   * @brief Require a key to have any of the given tags.
+   * 
+   * @param tags Tags.
+   * @return KeyPredicate& Reference to the predicate.
+   */
+  KeyPredicate& requireAnyTag(std::vector<Tag> tags);
+
+  /**
+   * @brief Require a key to have any of the given timestamps.
+   * 
+   * @param timestamps Timestamps.
+   * @return KeyPredicate& Reference to the predicate.
+   */
+  KeyPredicate& requireAnyTimestamp(std::vector<Timestamp> timestamps);
+
+  /**
+   * @brief Require a key to match every clause of another predicate.
+   * 
+   * @param other Other predicate.
+   * @return KeyPredicate& Reference to the predicate.
+   */
+  KeyPredicate& requireAll(const KeyPredicate& other);
+
+  /**
+   * @brief Check if the predicate has no clauses.
+   * 
+   * @return true if the predicate has no clauses and matches every key.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool empty() const noexcept;
+
+  /**
+   * @brief Check if the predicate has a timestamp clause.
+   * @details A predicate without one matches either every key of a series or
+   * none of them.
+   * 
+   * @return true if the predicate has a timestamp clause.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool constrainsTimestamps() const noexcept;
+
+  /**
+   * @brief Check if the predicate has a metric or tag clause.
+   * 
+   * @return true if the predicate has a metric or tag clause.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool constrainsSeries() const noexcept;
+
+  /**
+   * @brief Get the timestamps that a matching key may have.
+   * @details The intersection of the timestamp clauses.
+   * 
+   * @return std::optional<std::vector<Timestamp>> Sorted, unique timestamps,
+   * or std::nullopt if there are no timestamp clauses.
+   */
+  [[nodiscard]] std::optional<std::vector<Timestamp>> timestamps() const;
+
+  /**
+   * @brief Get the metrics that a matching key may have.
+   * @details The intersection of the metric clauses.
+   * 
+   * @return std::optional<std::vector<Metric>> Sorted, unique metrics, or
+   * std::nullopt if there are no metric clauses.
+   */
+  [[nodiscard]] std::optional<std::vector<Metric>> metrics() const;
+
+  /**
+   * @brief Get the tags that every matching key must have.
+   * @details The tags of the clauses that require a single tag. Clauses
+   * that allow any of several tags are left out.
+   * 
+   * @return std::optional<TagTable> Required tags, or std::nullopt if two
+   * clauses require different values of the same tag key, so that no key
+   * matches.
+   */
+  [[nodiscard]] std::optional<TagTable> requiredTags() const;
+
+  /**
+   * @brief Check if a key matches the predicate.
+   * 
+   * @param key Key.
+   * @return true if the key matches every clause.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool matches(const TimeSeriesKey& key) const noexcept;
+
+  /**
+   * @brief Check if the keys of a series may match the predicate.
+   * @details Timestamp clauses are ignored.
+   * 
+   * @param series Series.
+   * @return true if the series matches every metric and tag clause.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool matchesSeries(const Series& series) const noexcept;
+
+  /**
+   * @brief Check if any key of an SSTable may match the predicate.
+   * 
+   * @param summary Summary of the SSTable.
+   * @param time_range Time range of the SSTable.
+   * @return true if a key may match.
+   * @return false if no key matches.
+   */
+  [[nodiscard]] bool mayMatch(
+    const SeriesSummary& summary,
+    const TimeRange& time_range
+  ) const noexcept;
+
+  /**
+   * @brief Check if any key of a block may match the predicate.
+   * 
+   * @param block_mask Token mask of the block.
+   * @return true if a key may match.
+   * @return false if no key matches.
+   */
+  [[nodiscard]] bool mayMatch(mask_type block_mask) const noexcept;
+
+private:
+  /**
+   * @brief Clause requiring any of a set of metrics.
+   * 
+   */
+  struct MetricClause {
+    std::vector<Metric> metrics;
+    mask_type mask;
+  };
+
+  /**
+   * @brief Clause requiring any of a set of tags.
+   * 
+   */
+  struct TagClause {
+    std::vector<Tag> tags;
+    mask_type mask;
+  };
+
+  /**
+   * @brief Clause requiring any of a set of timestamps.
+   * 
+   */
+  struct TimestampClause {
+    std::vector<Timestamp> timestamps;
+  };
+
+  /**
+   * @brief Clause.
+   * 
+   */
+  using Clause = std::variant<MetricClause, TagClause, TimestampClause>;
+
+  /**
+   * @brief Clauses, all of which must hold.
+   * 
+   */
+  std::vector<Clause> clauses_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_KEY_PREDICATE_H
@@ -0,0 +1,253 @@
+#ifndef STORAGE_LATEST_INDEX_H
+#define STORAGE_LATEST_INDEX_H
+
+#include <vkdb/concepts.h>
+#include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <vkdb/range_tombstone.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Newest timestamp and value of a series.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+struct LatestValue {
+  /**
+   * @brief Timestamp.
+   * 
+   */
+  Timestamp timestamp;
+
+  /**
+   * @brief Value.
+   * 
+   */
+  TValue value;
+};
+
+/**
+ * @brief In-memory index of the newest value of each series.
+ * @details Puts keep the newest value of their series up to date, so it is
+ * answered without reading the LSM tree. A series is resolved once its
+ * entry, or the lack of one, is known to be its newest live entry. Series
+ * are unresolved when the index starts empty, or when the newest value is
+ * removed, since the value before it is not kept; they are resolved by
+ * reading the LSM tree. Removals bump an epoch, so a resolution that raced
+ * with a removal is discarded rather than bringing the removed value back.
+ * It is thread-safe.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class LatestIndex {
+public:
+  using size_type = uint64_t;
+  using latest_type = LatestValue<TValue>;
+
+  /**
+   * @brief Construct a new, empty LatestIndex object.
+   * 
+   */
+  LatestIndex() : mutex_{std::make_unique<std::shared_mutex>()} {}
+
+  /**
+   * @brief Move-construct a LatestIndex object.
+   * 
+   */
+  LatestIndex(LatestIndex&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a LatestIndex object.
+   * 
+   */
+  LatestIndex& operator=(LatestIndex&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  LatestIndex(const LatestIndex&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  LatestIndex& operator=(const LatestIndex&) = delete;
+
+  /**
+   * @brief Destroy the LatestIndex object.
+   * 
+   */
+  ~LatestIndex() noexcept = default;
+
+  /**
+   * @brief Record a put.
+   * @details Kept only if it is at least as new as the value already known.
+   * 
+   * @param key Key.
+   * @param value Value.
+   */
+  void put(const TimeSeriesKey& key, TValue value) {
+    std::unique_lock lock{*mutex_};
+    const auto [it, inserted]{latest_.try_emplace(
+      key.seriesId(), latest_type{key.timestamp(), value}
+    )};
+    if (!inserted && it->second.timestamp <= key.timestamp()) {
+      it->second = {key.timestamp(), value};
+    }
+  }
+
+  /**
+   * @brief Record a removal.
+   * @details Unresolves the series if the newest value is removed.
+   * 
+   * @param key Key.
+   */
+  void remove(const TimeSeriesKey& key) {
+    std::unique_lock lock{*mutex_};
+    ++epoch_;
+    const auto it{latest_.find(key.seriesId())};
+    if (it != latest_.end() && it->second.timestamp == key.timestamp()) {
+      latest_.erase(it);
+      resolved_.erase(key.seriesId());
+    }
+  }
+
+  /**
+   * @brief Record a range removal.
+   * @details Unresolves every series whose newest value it covers.
+   * 
+   * @param range_tombstone Range tombstone.
+   */
+  void removeRange(const RangeTombstone& range_tombstone) {
+    std::unique_lock lock{*mutex_};
+    ++epoch_;
+    const auto& dictionary{SeriesDictionary::instance()};
+    std::erase_if(latest_, [&](const auto& entry) {
+      const auto& [id, latest]{entry};
+      if (
+        !range_tombstone.covers(
+          TimeSeriesKey{latest.timestamp, dictionary.at(id)}
+        )
+      ) {
+        return false;
+      }
+      resolved_.erase(id);
+      return true;
+    });
+  }
+
+  /**
+   * @brief Get the epoch, bumped by every removal.
+   * 
+   * @return size_type Epoch.
+   */
+  [[nodiscard]] size_type epoch() const noexcept {
+    std::shared_lock lock{*mutex_};
+    return epoch_;
+  }
+
+  /**
+   * @brief Get the newest value of a series, if it is resolved.
+   * 
+   * @param id Series ID.
+   * @return std::optional<std::optional<latest_type>> Newest value, or an
+   * empty value if the series has no live entry, or std::nullopt if the
+   * series is unresolved.
+   */
+  [[nodiscard]] std::optional<std::optional<latest_type>> find(
+    SeriesId id
+  ) const {
+    std::shared_lock lock{*mutex_};
+    if (!resolved_.contains(id)) {
+      return std::nullopt;
+    }
+    const auto it{latest_.find(id)};
+    if (it == latest_.end()) {
+      return std::optional<latest_type>{};
+    }
+    return std::optional<latest_type>{it->second};
+  }
+
+  /**
+   * @brief Resolve series with the newest values read from the LSM tree.
+   * @details Ignored if there was a removal since the epoch, in which case
+   * the series stay unresolved. Values put meanwhile are kept if newer.
+   * 
+   * @param series IDs of the series that were read.
+   * @param found Newest value of each series that had a live entry.
+   * @param epoch Epoch before reading.
+   * @return true if the series were resolved.
+   * @return false if there was a removal since the epoch.
+   */
+  bool resolve(
+    std::span<const SeriesId> series,
+    const std::unordered_map<SeriesId, latest_type>& found,
+    size_type epoch
+  ) {
+    std::unique_lock lock{*mutex_};
+    if (epoch != epoch_) {
+      return false;
+    }
+    for (const auto id : series) {
+      if (const auto it{found.find(id)}; it != found.end()) {
+        const auto [latest, inserted]{latest_.try_emplace(id, it->second)};
+        if (!inserted && latest->second.timestamp < it->second.timestamp) {
+          latest->second = it->second;
+        }
+      }
+      resolved_.insert(id);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Remove every series.
+   * 
+   */
+  void clear() noexcept {
+    std::unique_lock lock{*mutex_};
+    ++epoch_;
+    latest_.clear();
+    resolved_.clear();
+  }
+
+private:
+  /**
+   * @brief Mutex guarding the index.
+   * 
+   */
+  std::unique_ptr<std::shared_mutex> mutex_;
+
+  /**
+   * @brief Newest value known of each series.
+   * 
+   */
+  std::unordered_map<SeriesId, latest_type> latest_;
+
+  /**
+   * @brief IDs of the resolved series.
+   * 
+   */
+  std::unordered_set<SeriesId> resolved_;
+
+  /**
+   * @brief Number of removals so far.
+   * 
+   */
+  size_type epoch_{0};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_LATEST_INDEX_H
@@ -0,0 +1,134 @@
+#ifndef STORAGE_LAYER_INDEX_H
+#define STORAGE_LAYER_INDEX_H
+
+#include <vkdb/data_range.h>
+#include <vkdb/time_series_key.h>
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Interval index over the time ranges of the SSTables of a layer.
+ * @details The bounds are kept in flat, sorted arrays, so planning a query
+ * never touches an SSTable. Layers whose ranges are disjoint and in order
+ * are searched with two binary searches. Other layers, such as C0, are
+ * searched as an interval tree: the ranges are sorted by lower bound, and
+ * the implicit balanced tree over them is augmented with the greatest upper
+ * bound of each subtree.
+ * 
+ */
+class LayerIndex {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Type alias for positions of SSTables within a layer.
+   * 
+   */
+  using Positions = std::vector<size_type>;
+
+  /**
+   * @brief Construct a new, empty LayerIndex object.
+   * 
+   */
+  LayerIndex() noexcept = default;
+
+  /**
+   * @brief Construct a new LayerIndex object from the time ranges of the
+   * SSTables of a layer.
+   * @details Ranges that are not set never overlap with anything.
+   * 
+   * @param ranges Time range of each SSTable, in layer order.
+   */
+  explicit LayerIndex(std::span<const TimeRange> ranges);
+
+  /**
+   * @brief Get the positions of the SSTables overlapping a time range.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @return Positions Positions in ascending order.
+   */
+  [[nodiscard]] Positions overlapping(
+    Timestamp start,
+    Timestamp end
+  ) const;
+
+  /**
+   * @brief Check if the ranges are disjoint and in layer order.
+   * 
+   * @return true if the ranges are disjoint and in layer order.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool disjoint() const noexcept;
+
+  /**
+   * @brief Get the number of indexed ranges.
+   * 
+   * @return size_type Number of indexed ranges.
+   */
+  [[nodiscard]] size_type size() const noexcept;
+
+private:
+  /**
+   * @brief Build the greatest upper bound of each subtree of [lo, hi).
+   * 
+   * @param lo First index.
+   * @param hi One past the last index.
+   * @return Timestamp Greatest upper bound of the subtree.
+   */
+  Timestamp build_tree(size_type lo, size_type hi) noexcept;
+
+  /**
+   * @brief Collect the positions of the ranges in [lo, hi) overlapping a
+   * time range.
+   * 
+   * @param lo First index.
+   * @param hi One past the last index.
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param positions Positions.
+   */
+  void collect(
+    size_type lo,
+    size_type hi,
+    Timestamp start,
+    Timestamp end,
+    Positions& positions
+  ) const;
+
+  /**
+   * @brief Lower bounds, sorted.
+   * 
+   */
+  std::vector<Timestamp> lowers_;
+
+  /**
+   * @brief Upper bounds, in the order of the lower bounds.
+   * 
+   */
+  std::vector<Timestamp> uppers_;
+
+  /**
+   * @brief Greatest upper bound of the subtree rooted at each index.
+   * @details Only used if the ranges are not disjoint.
+   * 
+   */
+  std::vector<Timestamp> max_uppers_;
+
+  /**
+   * @brief Layer position of each range, in the order of the lower bounds.
+   * 
+   */
+  Positions positions_;
+
+  /**
+   * @brief Whether the ranges are disjoint and in layer order.
+   * 
+   */
+  bool disjoint_{true};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_LAYER_INDEX_H
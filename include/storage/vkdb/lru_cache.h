@@ -122,6 +122,24 @@ public:
     return it->second->second;
   }
 
+  /**
+   * @brief Look up a key and mark it as recently used.
+   * @details Takes the lock once, unlike contains() followed by get().
+   * 
+   * @param key Key.
+   * @return std::optional<mapped_type> The cached value if the cache contains
+   * the key, std::nullopt otherwise.
+   */
+  [[nodiscard]] std::optional<mapped_type> tryGet(const key_type& key) {
+    std::lock_guard lock{*mutex_};
+    const auto it{map_.find(key)};
+    if (it == map_.end()) {
+      return std::nullopt;
+    }
+    list_.splice(list_.begin(), list_, it->second);
+    return it->second->second;
+  }
+
   /**
    * @brief Check if the cache contains a key.
    * 
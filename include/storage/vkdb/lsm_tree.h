@@ -3,30 +3,287 @@
 
 #include <vkdb/concepts.h>
 #include <vkdb/sstable.h>
+#include <vkdb/layer_index.h>
+#include <vkdb/manifest.h>
+#include <vkdb/tag_index.h>
+#include <vkdb/latest_index.h>
+#include <vkdb/merge_iterator.h>
 #include <vkdb/mem_table.h>
 #include <vkdb/write_ahead_log.h>
-#include <vkdb/lru_cache.h>
+#include <vkdb/sharded_cache.h>
 #include <vkdb/wal_lsm.h>
+#include <vkdb/background_worker.h>
+#include <vkdb/thread_pool.h>
+#include <vkdb/file_sync.h>
+#include <vkdb/io_backend.h>
+#include <vkdb/storage_stats.h>
+#include <vkdb/memory_manager.h>
 #include <ranges>
+#include <atomic>
+#include <iterator>
+#include <functional>
+#include <algorithm>
 #include <deque>
+#include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <utility>
+#include <span>
+#include <array>
+#include <concepts>
+#include <limits>
 
 namespace vkdb {
 /**
- * @brief Type alias for a predicate on a TimeSeriesKey.
+ * @brief Filename of the tag index of an LSM tree.
  * 
  */
-using TimeSeriesKeyFilter = std::function<bool(const TimeSeriesKey&)>;
+static const FilePath TAG_INDEX_FILENAME{"tag_index.metadata"};
 
 /**
- * @brief A predicate on a TimeSeriesKey that always returns true.
+ * @brief Options for an LSM tree.
  * 
  */
-static const TimeSeriesKeyFilter TRUE_TIME_SERIES_KEY_FILTER =
-  [](const TimeSeriesKey&) { return true; };
+struct LSMTreeOptions {
+  /**
+   * @brief Number of Ck layers.
+   * 
+   */
+  static constexpr uint64_t LAYER_COUNT{8};
+
+  /**
+   * @brief Max number of entries in the memtable.
+   * @details A full memtable is flushed to a C0 SSTable, so this is also the
+   * size of a C0 SSTable. It must be at least 1.
+   * 
+   */
+  uint64_t mem_table_max_entries{1'000};
+
+  /**
+   * @brief Max number of entries in the read cache.
+   * @details It must be at least 1.
+   * 
+   */
+  uint64_t cache_capacity{10'000};
+
+  /**
+   * @brief Time window sizes of each Ck layer.
+   * @details The time window sizes are in seconds. C0 takes any overlap, so
+   * its size is ignored. Every other size must be at least the size of the
+   * layer above it, and at least 1.
+   * - C0: 0 (any overlap)
+   * - C1: 30 minutes
+   * - C2: 1 hour
+   * - C3: 1 day
+   * - C4: 1 week
+   * - C5: 1 month
+   * - C6: 3 months
+   * - C7: 1 year
+   * 
+   */
+  std::array<uint64_t, LAYER_COUNT> layer_window_sizes{
+    0,
+    1800,
+    3600,
+    86400,
+    604800,
+    2592000,
+    7776000,
+    31536000
+  };
+
+  /**
+   * @brief Number of SSTables in each Ck layer.
+   * @details A layer with more SSTables than this is compacted into the next
+   * one. The last layer is never compacted, so its count is ignored.
+   * 
+   */
+  std::array<uint64_t, LAYER_COUNT> layer_table_counts{
+    10,
+    100,
+    100,
+    1000,
+    1000,
+    1000,
+    10000,
+    10000
+  };
+
+  /**
+   * @brief False positive rate of the Bloom filters of written SSTables.
+   * @details It must be strictly between 0 and 1.
+   * 
+   */
+  double bloom_filter_false_positive_rate{0.01};
+
+  /**
+   * @brief Whether written SSTables are synced to disk before they are
+   * committed to the manifest.
+   * @details Without it, the manifest may refer to SSTables that were lost
+   * in a power failure.
+   * 
+   */
+  bool sync_sstables{true};
+
+  /**
+   * @brief How far back from the newest timestamp written to keep data, or
+   * 0 to keep everything.
+   * @details In the same units as the timestamps. Reads never return entries
+   * older than the newest timestamp minus the retention, and SSTables that
+   * hold only such entries are removed whole, without being read.
+   * 
+   */
+  Timestamp retention{0};
+
+  /**
+   * @brief Whether compaction runs on a background thread.
+   * @details When disabled, compaction runs on the writer's thread whenever
+   * the memtable is flushed.
+   * 
+   */
+  bool background_compaction{false};
+
+  /**
+   * @brief Number of C0 SSTables at which writers block.
+   * @details Only applies to background compaction. Immutable memtables
+   * count towards C0, since they are about to be flushed to it. A flush that
+   * would push C0 to this size waits until the background compaction has
+   * caught up. It must be greater than the number of SSTables in C0.
+   * 
+   */
+  uint64_t c0_stall_threshold{20};
+
+  /**
+   * @brief Number of immutable memtables at which writers block.
+   * @details Only applies to background compaction. A full memtable is frozen
+   * and queued for flushing while a fresh one takes writes, unless this many
+   * are already queued. It must be at least 1.
+   * 
+   */
+  uint64_t max_immutable_mem_tables{2};
+
+  /**
+   * @brief Layout of the memtables.
+   * @details SORTED_RUN suits writes that arrive mostly in key order.
+   * 
+   */
+  MemTableFormat mem_table_format{MemTableFormat::TREE};
+
+  /**
+   * @brief Whether compaction keeps a rollup of each time window.
+   * @details Every SSTable in C1 and below holds a single time window, and
+   * its rollup is the count, sum, minimum and maximum of each series in it.
+   * Aggregates over a range read the rollups of the windows wholly inside
+   * it instead of their entries.
+   * 
+   */
+  bool rollups{false};
+
+  /**
+   * @brief Codec of the data blocks of SSTables.
+   * @details Applies to SSTables written from then on. SSTables already on
+   * disk keep the codec they were written with.
+   * 
+   */
+  Compression compression{Compression::NONE};
+
+  /**
+   * @brief Backend that writes SSTables.
+   * @details Falls back to POSIX where io_uring is unavailable. The WAL has
+   * a backend of its own.
+   * 
+   */
+  IOBackend io_backend{IOBackend::POSIX};
+
+  /**
+   * @brief Number of LSM trees that a ShardedLSMTree hash-partitions its
+   * series across.
+   * @details Each shard has its own memtable, WAL and layers. It must be at
+   * least 1, and is ignored by a lone LSM tree.
+   * 
+   */
+  uint64_t shards{1};
+
+  /**
+   * @brief Cache of decoded SSTable blocks, or null for none.
+   * @details May be shared with other LSM trees, so that they all draw on
+   * the same memory budget.
+   * 
+   */
+  std::shared_ptr<BlockCache> block_cache{};
+
+  /**
+   * @brief Pool on which compaction writes its SSTables, or null to write
+   * them on the compacting thread.
+   * @details May be shared with other LSM trees.
+   * 
+   */
+  std::shared_ptr<ThreadPool> compaction_pool{};
+
+  /**
+   * @brief Pool on which range reads fetch the overlapping SSTables
+   * concurrently, or null to read them on the calling thread.
+   * @details Each SSTable is read into a sorted run by a task of its own, and
+   * the runs are merged as the SSTables would have been, so the results are
+   * the same either way. Lazy scans still read on the calling thread. May be
+   * shared with other LSM trees, but not with compaction_pool.
+   * 
+   */
+  std::shared_ptr<ThreadPool> read_pool{};
+
+  /**
+   * @brief Scheduler that rate-limits the writes of the LSM tree, or null
+   * for no limit.
+   * @details Flushes are granted at flush priority and compactions at
+   * compaction priority, and the WAL at WAL priority unless its options
+   * name a scheduler of their own. Point reads that miss the read cache
+   * report their latency to it, so that compaction backs off while they
+   * slow down. May be shared with other LSM trees, so that they all draw on
+   * the same budget.
+   * 
+   */
+  std::shared_ptr<IOScheduler> io_scheduler{};
+
+  /**
+   * @brief Memory manager that writes are charged to, or null for none.
+   * @details Writes are charged once the write lock is released, and note
+   * the manager's epoch as the time of the LSM tree's last access, as do
+   * reads. Tracking the LSM tree, so that the manager can flush and release
+   * it, is left to its owner. May be shared with other LSM trees, so that
+   * they all draw on the same budget.
+   * 
+   */
+  std::shared_ptr<MemoryManager> memory_manager{};
+
+  /**
+   * @brief Options for the write-ahead log.
+   * 
+   */
+  WALOptions wal{};
+};
 
 /**
  * @brief LSM tree on TimeSeriesKey.
+ * @details Writes go to the active memtable. A full memtable is frozen into an
+ * immutable memtable and flushed to C0, on a background worker if background
+ * compaction is enabled. Readers work on an immutable snapshot of the frozen
+ * memtables and SSTable layers, so flushes and compactions only become
+ * visible once they have been fully written.
+ * 
+ * The LSM tree is safe to use from multiple threads. Writers are serialized,
+ * and any number of readers can run alongside them. Point reads hold a shared
+ * lock on the active memtable, while range reads only hold it long enough to
+ * copy the active memtable's range and take a snapshot, so they never block
+ * ingestion while scanning SSTables. Replaying the WAL must not run
+ * concurrently with writes.
  * 
  * @tparam TValue Value type.
  */
@@ -39,41 +296,61 @@ public:
   using size_type = uint64_t;
   using table_type = typename MemTable<TValue>::table_type;
 
-  static constexpr size_type LAYER_COUNT{8};
+  static constexpr size_type LAYER_COUNT{LSMTreeOptions::LAYER_COUNT};
 
   /**
-   * @brief Max number of entries in the cache.
+   * @brief Estimated memory of an entry of a memtable or the read cache.
+   * @details The entry itself, and the pointers of the node that holds it.
    * 
    */
-  static constexpr size_type CACHE_CAPACITY{10'000};
+  static constexpr size_type ENTRY_BYTES{
+    sizeof(value_type) + 4 * sizeof(void*)
+  };
 
   /**
    * @brief Construct a new LSMTree object.
-   * @details Loads SSTables from disk.
+   * @details Loads SSTables from disk, along with the tag index, which is
+   * rebuilt from the SSTables if it is missing or malformed.
    * 
    * @param path Path of the LSM tree.
+   * @param options Options.
+   * 
+   * @throw std::invalid_argument If any option is out of range, as given by
+   * LSMTreeOptions, or if a codec is not available.
    */
-  explicit LSMTree(FilePath path) noexcept
-    : wal_{path}
+  explicit LSMTree(FilePath path, LSMTreeOptions options = {})
+    : options_{validate_options(std::move(options))}
+    , write_mutex_{std::make_unique<std::mutex>()}
+    , mem_table_mutex_{std::make_unique<std::shared_mutex>()}
+    , mem_table_{options_.mem_table_format, options_.mem_table_max_entries}
+    , newest_timestamp_{std::make_unique<std::atomic<Timestamp>>(0)}
+    , snapshot_{make_snapshot({{}, CkLayers{LAYER_COUNT}})}
+    , snapshot_mutex_{std::make_unique<std::mutex>()}
+    , snapshot_changed_{std::make_unique<std::condition_variable>()}
+    , wal_{path, wal_options(options_)}
+    , manifest_{path, LAYER_COUNT}
+    , manifest_mutex_{std::make_unique<std::mutex>()}
     , path_{std::move(path)}
     , sstable_id_{0}
-    , ck_layers_{LAYER_COUNT}
-    , cache_{CACHE_CAPACITY} {
+    , cache_{options_.cache_capacity} {
       std::filesystem::create_directories(path_);
       load_sstables();
+      load_tag_index();
     }
 
   /**
    * @brief Move-construct a LSMTree object.
+   * @details Waits for any background compaction of the other LSM tree.
    * 
    */
   LSMTree(LSMTree&&) noexcept = default;
   
   /**
    * @brief Move-assign a LSMTree object.
+   * @details Waits for any background compaction of either LSM tree.
    * 
    */
-  LSMTree& operator=(LSMTree&&) noexcept = default;  
+  LSMTree& operator=(LSMTree&&) noexcept = default;
 
   /**
    * @brief Deleted copy constructor.
@@ -89,9 +366,12 @@ public:
 
   /**
    * @brief Destroy the LSMTree object.
+   * @details Waits for any background compaction to finish.
    * 
    */
-  ~LSMTree() noexcept = default;
+  ~LSMTree() noexcept {
+    compaction_worker_.stop();
+  }
 
   /**
    * @brief Put a key-value pair into the LSM tree.
@@ -100,18 +380,19 @@ public:
    * @param value Value.
    * @param log Whether to log the operation in the WAL.
    * 
-   * @throw std::runtime_error If the memtable is flushed when the C1
-   * layer is full.
+   * @throw std::runtime_error If flushing the memtable fails, or if a
+   * background compaction failed.
    */
   void put(const key_type& key, const TValue& value, bool log = true) {
-    mem_table_.put(key, value);
-    dirty_table_[key] = true;
-    if (mem_table_.size() == MemTable<TValue>::C0_LAYER_SSTABLE_MAX_ENTRIES) {
-      flush();
-    }
-    if (log) {
-      wal_.append({WALRecordType::PUT, {key, value}});
+    {
+      std::lock_guard write_lock{*write_mutex_};
+      if (log) {
+        LatencyTimer timer{metrics_->wal_append_latency};
+        wal_.append({WALRecordType::PUT, {key, value}});
+      }
+      apply(key, value);
     }
+    charge_memory(1);
   }
 
   /**
@@ -120,43 +401,130 @@ public:
    * @param key Key.
    * @param log Whether to log the operation in the WAL.
    * 
-   * @throw std::runtime_error If the memtable is flushed when the C1
-   * layer is full.
+   * @throw std::runtime_error If flushing the memtable fails, or if a
+   * background compaction failed.
    */
   void remove(const key_type& key, bool log = true) {
-    mem_table_.put(key, std::nullopt);
-    dirty_table_[key] = true;
-    if (mem_table_.size() == MemTable<TValue>::C0_LAYER_SSTABLE_MAX_ENTRIES) {
-      flush();
+    {
+      std::lock_guard write_lock{*write_mutex_};
+      if (log) {
+        LatencyTimer timer{metrics_->wal_append_latency};
+        wal_.append({WALRecordType::REMOVE, {key, std::nullopt}});
+      }
+      apply(key, std::nullopt);
     }
+    charge_memory(1);
+  }
+
+  /**
+   * @brief Remove a range of keys from the LSM tree.
+   * @details The range tombstone is kept once in the memtable, rather than
+   * as a tombstone per key, and deletes the keys it covers that were
+   * written before it. Keys written afterwards are not affected.
+   * 
+   * @param range_tombstone Range tombstone.
+   * @param log Whether to log the operation in the WAL.
+   * 
+   * @throw std::runtime_error If writing the WAL fails.
+   */
+  void removeRange(const RangeTombstone& range_tombstone, bool log = true) {
+    std::lock_guard write_lock{*write_mutex_};
     if (log) {
-      wal_.append({WALRecordType::REMOVE, {key, std::nullopt}});
+      LatencyTimer timer{metrics_->wal_append_latency};
+      wal_.appendRangeTombstone(range_tombstone);
+    }
+    {
+      std::unique_lock lock{*mem_table_mutex_};
+      mem_table_.removeRange(range_tombstone);
+      cache_.clear();
+    }
+    latest_index_.removeRange(range_tombstone);
+  }
+
+  /**
+   * @brief Write a batch of entries into the LSM tree.
+   * @details Entries with a value are put, and entries without one are
+   * removed, in order. Entries are logged as one WAL record group per
+   * memtable they land in, and each group is applied under a single lock.
+   * 
+   * A batch that is sorted by key, free of duplicates and holds at least a
+   * memtable's worth of entries is treated as a bulk load. The memtable is
+   * flushed first, then the entries are written straight to C0 SSTables,
+   * skipping the WAL and the memtable altogether. Batches are never bulk
+   * loaded while the WAL is archived for followers, which only see what is
+   * logged.
+   * 
+   * @param entries Entries.
+   * @param log Whether to log the entries in the WAL.
+   * 
+   * @throw std::runtime_error If writing the WAL or an SSTable fails, or if
+   * a background compaction failed.
+   */
+  void putBatch(
+    std::span<const TimeSeriesEntry<TValue>> entries,
+    bool log = true
+  ) {
+    {
+      std::lock_guard write_lock{*write_mutex_};
+      if (is_bulk_load(entries)) {
+        bulk_load(entries);
+        entries = {};
+      }
+      for (auto rest{entries}; !rest.empty();) {
+        const auto room{options_.mem_table_max_entries - mem_table_.size()};
+        const auto group{rest.first(std::min<size_type>(room, rest.size()))};
+        rest = rest.subspan(group.size());
+        if (log) {
+          LatencyTimer timer{metrics_->wal_append_latency};
+          wal_.appendGroup(group);
+        }
+        apply_group(group);
+      }
     }
+    charge_memory(entries.size());
   }
 
   /**
    * @brief Get a value from the LSM tree.
    * 
    * @param key Key.
-   * @return mapped_type The value if it exists.
+   * @return mapped_type The value if it exists and is within the retention.
+   * 
+   * @throw std::runtime_error If an SSTable cannot be mapped or an entry is
+   * malformed.
    */
-  [[nodiscard]] mapped_type get(const key_type& key) const noexcept {
-    if (!dirty_table_[key] && cache_.contains(key)) {
-      return cache_.get(key);
+  [[nodiscard]] mapped_type get(const key_type& key) const {
+    if (key.timestamp() < retention_cutoff()) {
+      return std::nullopt;
+    }
+    touch();
+    std::shared_lock lock{*mem_table_mutex_};
+    if (auto cached{cache_.tryGet(key)}) {
+      metrics_->cache_hits.add();
+      return *cached;
     }
+    metrics_->cache_misses.add();
 
     try {
       return search_memtable(key);
     } catch (const std::invalid_argument& e) {
-      const auto c0_value{iterative_layer_search(0, key)};
-      if (c0_value.has_value()) {
-        return c0_value;
+      if (mem_table_.isRangeDeleted(key)) {
+        return std::nullopt;
+      }
+      const auto version{snapshot()};
+      const auto frozen_value{
+        search_immutable_memtables(version->immutable_mem_tables, key)
+      };
+      if (frozen_value.has_value()) {
+        return frozen_value.value();
       }
 
-      for (size_type k{1}; k < LAYER_COUNT; ++k) {
-        const auto ck_value{binary_layer_search(k, key)};
+      ForegroundTimer timer{options_.io_scheduler.get()};
+      const auto depth{searchable_depth(*version, key)};
+      for (size_type k{0}; k <= depth; ++k) {
+        const auto ck_value{search_layer(*version, k, key)};
         if (ck_value.has_value()) {
-          return ck_value;
+          return ck_value.value();
         }
       }
 
@@ -165,134 +533,859 @@ public:
   }
 
   /**
-   * @brief Get a filtered set of entries in a timestamp range.
-   * 
-   * @param start Start timestamp.
-   * @param end End timestamp.
-   * @param filter Filter.
-   * @return std::vector<value_type> Entries.
+   * @brief Get the values of a batch of keys from the LSM tree.
+   * @details Equivalent to calling get() for each key. The keys that are not
+   * in memory are hashed once, and tested against the Bloom filter of each
+   * C0 SSTable overlapping their time span as a single batch, so the
+   * filter's memory traffic is shared across the keys.
    * 
-   * @throw std::exception If getting the entries fails.
+   * @param keys Keys.
+   * @return std::vector<mapped_type> The value of each key if it exists.
+   * @throw std::runtime_error If an SSTable cannot be mapped or an entry is
+   * malformed.
    */
-  [[nodiscard]] std::vector<value_type> getRange(
-    const key_type& start,
-    const key_type& end,
-    TimeSeriesKeyFilter&& filter
+  [[nodiscard]] std::vector<mapped_type> multiGet(
+    std::span<const key_type> keys
   ) const {
-    table_type entry_table;
-    for (size_type k{LAYER_COUNT - 1}; k > 0; --k) {
-      binary_layer_search_range(k, start, end, filter, entry_table);
-    }
-    for (const auto& sstable : ck_layers_[0]) {
-      update_entries_with_sstable_range(
-        sstable, start, end, filter, entry_table
-      );
+    std::vector<mapped_type> values(keys.size());
+    std::vector<size_type> pending;
+    const auto cutoff{retention_cutoff()};
+    touch();
+    std::shared_lock lock{*mem_table_mutex_};
+    for (size_type i{0}; i < keys.size(); ++i) {
+      const auto& key{keys[i]};
+      if (key.timestamp() < cutoff) {
+        continue;
+      }
+      auto cached{cache_.tryGet(key)};
+      (cached ? metrics_->cache_hits : metrics_->cache_misses).add();
+      if (cached) {
+        values[i] = std::move(*cached);
+      } else if (mem_table_.contains(key)) {
+        values[i] = search_memtable(key);
+      } else if (!mem_table_.isRangeDeleted(key)) {
+        pending.push_back(i);
+      }
     }
-    for (const auto& [key, value] : mem_table_.getRange(start, end)) {
-      update_entries_with_filtered_key(key, value, filter, entry_table);
+    if (pending.empty()) {
+      return values;
     }
-    return {entry_table.begin(), entry_table.end()};
-  }
 
-  /**
-   * @brief Replay the write-ahead log.
-   * 
-   */
-  void replayWAL() {
-    wal_.replay(*this);
-  }
+    const auto version{snapshot()};
+    std::erase_if(pending, [&](const auto i) {
+      const auto frozen_value{
+        search_immutable_memtables(version->immutable_mem_tables, keys[i])
+      };
+      if (frozen_value.has_value()) {
+        values[i] = frozen_value.value();
+      }
+      return frozen_value.has_value();
+    });
 
-  /**
-   * @brief Clear the LSM tree.
-   * @details Remove all SSTable files and the WAL file.
-   * 
-   */
-  void clear() noexcept {
-    for (const auto& ck_layer : ck_layers_) {
-      for (const auto& sstable : ck_layer) {
-        std::filesystem::remove(sstable.path());
-        std::filesystem::remove(sstable.metadataPath());
+    std::vector<BloomFilter::hash_type> hashes;
+    hashes.reserve(pending.size());
+    for (const auto i : pending) {
+      hashes.push_back(BloomFilter::hash(keys[i]));
+    }
+    const auto [min_key, max_key]{std::ranges::minmax(
+      pending, {}, [&](const auto i) { return keys[i].timestamp(); }
+    )};
+    const auto c0_positions{version->layer_indices[0].overlapping(
+      keys[min_key].timestamp(), keys[max_key].timestamp()
+    )};
+    const auto results{std::make_unique<bool[]>(pending.size())};
+    for (const auto position : c0_positions | std::views::reverse) {
+      if (pending.empty()) {
+        break;
+      }
+      const auto& sstable{version->ck_layers[0][position]};
+      sstable->mayContainBatch(hashes, {results.get(), pending.size()});
+      size_type remaining{0};
+      for (size_type j{0}; j < pending.size(); ++j) {
+        const auto i{pending[j]};
+        if (!results[j]) {
+          metrics_->bloom_negatives.add();
+        } else {
+          const auto sstable_value{sstable->find(keys[i], metrics_.get())};
+          if (sstable_value.has_value()) {
+            cache_value(keys[i], sstable_value.value());
+            values[i] = sstable_value.value();
+            continue;
+          }
+        }
+        if (sstable->isRangeDeleted(keys[i])) {
+          cache_value(keys[i], std::nullopt);
+          continue;
+        }
+        pending[remaining] = i;
+        hashes[remaining] = hashes[j];
+        ++remaining;
       }
+      pending.resize(remaining);
+      hashes.resize(remaining);
     }
-    std::filesystem::remove(wal_.path());
-    mem_table_.clear();
-    ck_layers_ = CkLayers{LAYER_COUNT};
-    wal_.clear();
-    sstable_id_ = std::array<size_type, LAYER_COUNT>{0};
-    cache_.clear();
-    dirty_table_.clear();
-  }
 
-  /**
-   * @brief Convert the LSM tree to a string.
-   * 
-   * @return std::string The string representation of the LSM tree.
-   */
-  [[nodiscard]] std::string str() const noexcept {
-    std::stringstream ss;
-    ss << mem_table_.str();
-    for (const auto& ck_layer : ck_layers_) {
-      for (const auto& sstable : ck_layer) {
-        ss << sstable.str();
+    for (const auto i : pending) {
+      const auto depth{searchable_depth(*version, keys[i])};
+      for (size_type k{1}; k <= depth; ++k) {
+        const auto ck_value{search_layer(*version, k, keys[i])};
+        if (ck_value.has_value()) {
+          values[i] = ck_value.value();
+          break;
+        }
       }
     }
-    return ss.str();
+    return values;
   }
 
   /**
-   * @brief Get the number of SSTables in the LSM tree.
+   * @brief Scan a filtered range of entries lazily.
+   * @details The memtables and the overlapping SSTables are k-way merged as
+   * the scan is pulled, newest value first, and tombstones are skipped. Only
+   * the range of the active memtable is copied up front; SSTable entries are
+   * decoded one at a time. The scan holds on to a snapshot, so it is not
+   * affected by later writes, flushes, or compactions.
    * 
-   * @return size_type The number of SSTables.
+   * @param start Start key.
+   * @param end End key.
+   * @param filter Filter.
+   * @param resource Resource of the scan's bookkeeping, as given by
+   * MergeIterator::MergeIterator().
+   * @return MergeIterator<TValue> Scan, in key order.
+   * 
+   * @throw std::exception If reading an SSTable fails.
    */
-  [[nodiscard]] size_type sstableCount() const noexcept {
-    size_type count{0};
-    for (const auto& ck_layer : ck_layers_) {
-      count += ck_layer.size();
-    }
-    return count;
+  [[nodiscard]] MergeIterator<TValue> scan(
+    const key_type& start,
+    const key_type& end,
+    TimeSeriesKeyFilter filter = TRUE_TIME_SERIES_KEY_FILTER,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) const {
+    MergeIterator<TValue> merge{std::move(filter), resource};
+    addScanSources(merge, start, end);
+    return merge;
   }
 
   /**
-   * @brief Get the number of SSTables in a Ck layer.
+   * @brief Scan a range of entries matching a predicate lazily.
+   * @details As with a filtered scan, but the SSTables and blocks that the
+   * predicate rules out are skipped without being read.
    * 
-   * @param k Ck layer index.
-   * @return size_type The number of SSTables.
+   * @param start Start key.
+   * @param end End key.
+   * @param predicate Predicate.
+   * @param resource Resource of the scan's bookkeeping, as given by
+   * MergeIterator::MergeIterator().
+   * @return MergeIterator<TValue> Scan, in key order.
    * 
-   * @throw std::out_of_range If the layer index is out of range.
+   * @throw std::exception If reading an SSTable fails.
    */
-  [[nodiscard]] size_type sstableCount(size_type k) const {
-    if (k < 0 || k >= LAYER_COUNT) {
-      throw std::out_of_range{
-        "LSMTree::sstableCount(): Layer index out of range."
-      };
-    }
-    return ck_layers_[k].size();
+  [[nodiscard]] MergeIterator<TValue> scan(
+    const key_type& start,
+    const key_type& end,
+    KeyPredicate predicate,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) const {
+    MergeIterator<TValue> merge{std::move(predicate), resource};
+    addScanSources(merge, start, end);
+    return merge;
   }
 
   /**
-   * @brief Check if the LSM tree is empty.
+   * @brief Scan a range of entries matching a compile-time filter lazily.
+   * @details As with a predicate scan, but each key is checked against the
+   * filter inline, and the SSTables and blocks that its predicate rules out
+   * are skipped without being read.
    * 
-   * @return true if the LSM tree is empty.
-   * @return false if the LSM tree is not empty.
+   * @tparam TFilter Filter type.
+   * @param start Start key.
+   * @param end End key.
+   * @param filter Filter, such as `MetricEq{"cpu"} && TagEq{"region", "eu"}`.
+   * @param resource Resource of the scan's bookkeeping, as given by
+   * MergeIterator::MergeIterator().
+   * @return MergeIterator<TValue, TFilter> Scan, in key order.
+   * 
+   * @throw std::exception If reading an SSTable fails.
    */
-  [[nodiscard]] bool empty() const noexcept {
-    auto empty{mem_table_.empty()};
-    for (const auto& ck_layer : ck_layers_) {
-      empty = empty && ck_layer.empty();
-      if (!empty) {
-        break;
-      }
-    }
-    return empty;
+  template <KeyFilter TFilter>
+  [[nodiscard]] MergeIterator<TValue, TFilter> scan(
+    const key_type& start,
+    const key_type& end,
+    TFilter filter,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) const {
+    MergeIterator<TValue, TFilter> merge{std::move(filter), resource};
+    addScanSources(merge, start, end);
+    return merge;
   }
 
-private:
   /**
-   * @brief Type alias for a deque of SSTables.
+   * @brief Get the newest live entry of each series in a range that
+   * matches a predicate.
+   * @details Answered from the latest-value index without reading the LSM
+   * tree, for every series whose newest entry is in the range and matches
+   * the predicate. Series whose newest entry is past the range, or on a
+   * timestamp the predicate rules out, are read back from the end of the
+   * range. Series the index has not resolved yet, as after a restart or a
+   * removal of their newest entry, are resolved by reading back from the
+   * newest timestamp written, once.
    * 
+   * @param start Start key.
+   * @param end End key.
+   * @param predicate Predicate.
+   * @return std::vector<value_type> Newest entry of each series, in key
+   * order.
+   * 
+   * @throw std::exception If reading the LSM tree fails.
    */
-  using SSTables = std::deque<SSTable<TValue>>;
-
+  [[nodiscard]] std::vector<value_type> latest(
+    const key_type& start,
+    const key_type& end,
+    const KeyPredicate& predicate
+  ) const {
+    const auto tags{predicate.requiredTags()};
+    if (end < start || !tags) {
+      return {};
+    }
+    const auto& dictionary{SeriesDictionary::instance()};
+    const auto cutoff{retention_cutoff()};
+    std::vector<std::pair<key_type, TValue>> newest;
+    std::unordered_set<SeriesId> past_range;
+    const auto add{[&](
+      const Series& series,
+      const LatestValue<TValue>& latest
+    ) {
+      const key_type key{latest.timestamp, series};
+      if (latest.timestamp < cutoff || key < start) {
+        return;
+      }
+      if (key <= end && predicate.matches(key)) {
+        newest.emplace_back(key, latest.value);
+      } else {
+        past_range.insert(series.id);
+      }
+    }};
+
+    std::vector<SeriesId> unresolved;
+    for (const auto id : tag_index_.seriesWithTags(*tags)) {
+      const auto& series{dictionary.at(id)};
+      if (!predicate.matchesSeries(series)) {
+        continue;
+      }
+      const auto cached{latest_index_.find(id)};
+      if (!cached) {
+        unresolved.push_back(id);
+      } else if (cached->has_value()) {
+        add(series, cached->value());
+      }
+    }
+    if (!unresolved.empty()) {
+      const auto epoch{latest_index_.epoch()};
+      const auto found{read_latest(
+        MIN_TIME_SERIES_KEY,
+        MAX_TIME_SERIES_KEY,
+        predicate.constrainsTimestamps() ? KeyPredicate{} : predicate,
+        {unresolved.begin(), unresolved.end()}
+      )};
+      latest_index_.resolve(unresolved, found, epoch);
+      for (const auto& [id, latest] : found) {
+        add(dictionary.at(id), latest);
+      }
+    }
+    if (!past_range.empty()) {
+      for (const auto& [id, latest] : read_latest(
+        start, end, predicate, std::move(past_range)
+      )) {
+        newest.emplace_back(
+          key_type{latest.timestamp, dictionary.at(id)}, latest.value
+        );
+      }
+    }
+    std::ranges::sort(newest);
+    return {newest.begin(), newest.end()};
+  }
+
+  /**
+   * @brief Get a filtered set of entries in a timestamp range.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param filter Filter.
+   * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::exception If getting the entries fails.
+   */
+  [[nodiscard]] std::vector<value_type> getRange(
+    const key_type& start,
+    const key_type& end,
+    TimeSeriesKeyFilter&& filter
+  ) const {
+    MergeIterator<TValue> merge{std::move(filter)};
+    addScanSources(merge, start, end, options_.read_pool.get());
+    return drain(std::move(merge));
+  }
+
+  /**
+   * @brief Get the entries in a timestamp range that match a predicate.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param predicate Predicate.
+   * @param resource Resource of the merge's bookkeeping, as given by
+   * MergeIterator::MergeIterator(). The entries themselves are not taken
+   * from it.
+   * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::exception If getting the entries fails.
+   */
+  [[nodiscard]] std::vector<value_type> getRange(
+    const key_type& start,
+    const key_type& end,
+    const KeyPredicate& predicate,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) const {
+    MergeIterator<TValue> merge{predicate, resource};
+    addScanSources(merge, start, end, options_.read_pool.get());
+    return drain(std::move(merge));
+  }
+
+  /**
+   * @brief Get the entries in a timestamp range that match a compile-time
+   * filter.
+   * 
+   * @tparam TFilter Filter type.
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param filter Filter.
+   * @param resource Resource of the merge's bookkeeping, as given by
+   * MergeIterator::MergeIterator().
+   * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::exception If getting the entries fails.
+   */
+  template <KeyFilter TFilter>
+  [[nodiscard]] std::vector<value_type> getRange(
+    const key_type& start,
+    const key_type& end,
+    TFilter filter,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) const {
+    MergeIterator<TValue, TFilter> merge{std::move(filter), resource};
+    addScanSources(merge, start, end, options_.read_pool.get());
+    return drain(std::move(merge));
+  }
+
+  /**
+   * @brief Replay the write-ahead log.
+   * @details Memtables filled by the replay are flushed straight to C0, and
+   * compaction is held back until the replay is done, so that restarting
+   * costs little more than decoding and rewriting the unflushed memtables.
+   * 
+   * @throw std::runtime_error If the WAL cannot be read, if writing an
+   * SSTable fails, or if the compaction after the replay fails.
+   */
+  void replayWAL() {
+    replaying_ = true;
+    try {
+      wal_.replay(*this);
+    } catch (...) {
+      replaying_ = false;
+      throw;
+    }
+    replaying_ = false;
+    if (snapshot()->ck_layers[0].empty()) {
+      return;
+    }
+    if (options_.background_compaction) {
+      compaction_worker_.start([this] { run_background_compaction(); });
+      compaction_worker_.schedule();
+    } else {
+      compact();
+    }
+  }
+
+  /**
+   * @brief Read the WAL records from a log sequence number on, for a
+   * follower.
+   * 
+   * @param lsn LSN of the first record to read.
+   * @param max_bytes Number of bytes of records after which reading stops.
+   * @return WALChunk Records, and the LSN to read from next.
+   * 
+   * @throw std::runtime_error If the WAL cannot be read, or if records from
+   * the LSN on are no longer kept.
+   */
+  [[nodiscard]] WALChunk readWAL(uint64_t lsn, uint64_t max_bytes) {
+    return wal_.readFrom(lsn, max_bytes);
+  }
+
+  /**
+   * @brief Remove the archived WAL segments that followers have read.
+   * 
+   * @param lsn LSN that every follower has read up to.
+   * 
+   * @throw std::filesystem::filesystem_error If an archive cannot be
+   * removed.
+   */
+  void acknowledgeWAL(uint64_t lsn) {
+    wal_.acknowledge(lsn);
+  }
+
+  /**
+   * @brief Get the log sequence number of the next WAL record.
+   * 
+   * @return uint64_t LSN.
+   */
+  [[nodiscard]] uint64_t nextLSN() const noexcept {
+    return wal_.nextLSN();
+  }
+
+  /**
+   * @brief Apply WAL records read from another LSM tree.
+   * @details The records are logged in this LSM tree's WAL as they would be
+   * if written directly.
+   * 
+   * @param records Records, as given by readWAL().
+   * @return uint64_t Number of records applied.
+   * 
+   * @throw std::invalid_argument If a record is malformed.
+   * @throw std::runtime_error If writing a record fails.
+   */
+  uint64_t applyWAL(const std::string& records) {
+    return WriteAheadLog<TValue>::applyRecords(records, *this);
+  }
+
+  /**
+   * @brief Commit any buffered WAL records and sync them to disk.
+   *
+   * @throw std::runtime_error If the WAL cannot be written or synced.
+   */
+  void syncWAL() {
+    wal_.sync();
+  }
+
+  /**
+   * @brief Write a checkpoint of the LSM tree, from which it can be opened
+   * as it was.
+   * @details Writes are held back only until the current SSTables are
+   * pinned, and WAL appends until the sealed segments of the memtables not
+   * yet flushed are linked. The pinned SSTables are then hard-linked into
+   * the directory along with a manifest of their own, so a checkpoint costs
+   * little more than copying the active WAL, whatever the size of the data.
+   * Compaction carries on meanwhile, and the SSTables it replaces keep their
+   * files until they are linked.
+   * 
+   * @param directory Directory of the checkpoint, which is created if it
+   * does not exist.
+   * @return uint64_t LSN of the next WAL record, before which every record
+   * is in the checkpoint.
+   * 
+   * @throw std::runtime_error If the directory is not empty, or if a file
+   * cannot be written or copied.
+   * @throw std::filesystem::filesystem_error If the directory cannot be
+   * created, or a file can be neither linked nor copied.
+   */
+  uint64_t checkpoint(const FilePath& directory) {
+    std::filesystem::create_directories(directory);
+    if (!std::filesystem::is_empty(directory)) {
+      throw std::runtime_error{
+        "LSMTree::checkpoint(): Directory " + std::string(directory)
+        + " is not empty."
+      };
+    }
+
+    std::shared_ptr<const Snapshot> version;
+    std::unique_lock write_lock{*write_mutex_};
+    const auto lsn{wal_.checkpoint(directory, [this, &version, &write_lock] {
+      version = snapshot();
+      write_lock.unlock();
+      std::set<FilePath> segments;
+      for (const auto& immutable : version->immutable_mem_tables) {
+        segments.insert(immutable.wal_path);
+      }
+      return segments;
+    })};
+
+    for (const auto& ck_layer : version->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        linkFile(sstable->path(), directory / sstable->path().filename());
+        linkFile(
+          sstable->metadataPath(),
+          directory / sstable->metadataPath().filename()
+        );
+      }
+    }
+    std::array<size_type, LAYER_COUNT> next_ids;
+    {
+      std::lock_guard lock{*manifest_mutex_};
+      next_ids = sstable_id_;
+    }
+    Manifest manifest{directory, LAYER_COUNT};
+    commit_manifest(manifest, *version, next_ids);
+
+    save_tag_index();
+    if (std::filesystem::exists(tag_index_path())) {
+      std::filesystem::copy_file(
+        tag_index_path(),
+        directory / TAG_INDEX_FILENAME
+      );
+    }
+    syncDirectory(directory);
+    return lsn;
+  }
+
+  /**
+   * @brief Wait for the background compaction to catch up.
+   * @details This includes flushing any immutable memtables. Returns
+   * immediately if background compaction is disabled.
+   * 
+   * @throw std::exception If a background compaction failed.
+   */
+  void waitForCompaction() {
+    compaction_worker_.waitUntilIdle();
+    rethrow_compaction_error();
+  }
+
+  /**
+   * @brief Clear the LSM tree.
+   * @details Stops any background compaction, then removes all SSTable files,
+   * the manifest, the tag index and the WAL files. SSTable files still held by a reader's
+   * snapshot are removed once the snapshot is released.
+   * 
+   */
+  void clear() noexcept {
+    std::lock_guard write_lock{*write_mutex_};
+    std::unique_lock mem_table_lock{*mem_table_mutex_};
+    compaction_worker_.stop();
+    {
+      std::lock_guard lock{*snapshot_mutex_};
+      for (const auto& ck_layer : snapshot_->ck_layers) {
+        for (const auto& sstable : ck_layer) {
+          sstable->markObsolete();
+        }
+      }
+      snapshot_ = make_snapshot({{}, CkLayers{LAYER_COUNT}});
+      compaction_error_ = nullptr;
+    }
+    std::filesystem::remove(wal_.path());
+    mem_table_.clear();
+    newest_timestamp_->store(0, std::memory_order_relaxed);
+    wal_.clear();
+    {
+      std::lock_guard lock{*manifest_mutex_};
+      manifest_.clear();
+      sstable_id_ = std::array<size_type, LAYER_COUNT>{0};
+    }
+    cache_.clear();
+    tag_index_.clear();
+    latest_index_.clear();
+    std::error_code ec;
+    std::filesystem::remove(tag_index_path(), ec);
+  }
+
+  /**
+   * @brief Convert the LSM tree to a string.
+   * 
+   * @return std::string The string representation of the LSM tree.
+   */
+  [[nodiscard]] std::string str() const noexcept {
+    std::stringstream ss;
+    std::shared_lock lock{*mem_table_mutex_};
+    ss << mem_table_.str();
+    const auto version{snapshot()};
+    for (const auto& immutable : version->immutable_mem_tables) {
+      ss << immutable.mem_table->str();
+    }
+    for (const auto& ck_layer : version->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        ss << sstable->str();
+      }
+    }
+    return ss.str();
+  }
+
+  /**
+   * @brief Get the stats of the LSM tree.
+   * @details Counters cover the time since the LSM tree was opened, and
+   * SSTable counts and memory are those of the current snapshot.
+   * 
+   * @return StorageStats Stats.
+   */
+  [[nodiscard]] StorageStats stats() const {
+    auto stats{metrics_->snapshot()};
+    for (const auto& ck_layer : snapshot()->ck_layers) {
+      stats.sstables.push_back(ck_layer.size());
+    }
+    stats.memory = memoryUsage();
+    return stats;
+  }
+
+  /**
+   * @brief Get the memory held by the LSM tree.
+   * @details Memtables and the read cache are counted by their entries,
+   * SSTables by their sparse indexes and Bloom filters, as of the current
+   * snapshot, and series by the tag index that holds them.
+   * 
+   * @return MemoryUsage Usage.
+   */
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    MemoryUsage usage;
+    std::shared_ptr<const Snapshot> version;
+    {
+      std::shared_lock lock{*mem_table_mutex_};
+      usage.mem_table_bytes = mem_table_.size() * ENTRY_BYTES;
+      version = snapshot();
+    }
+    for (const auto& immutable : version->immutable_mem_tables) {
+      usage.mem_table_bytes += immutable.mem_table->size() * ENTRY_BYTES;
+    }
+    usage.cache_bytes = cache_.size() * ENTRY_BYTES;
+    for (const auto& ck_layer : version->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        usage.index_bytes += sstable->indexBytes();
+        usage.filter_bytes += sstable->filterBytes();
+      }
+    }
+    usage.series_bytes = tag_index_.bytes();
+    return usage;
+  }
+
+  /**
+   * @brief Get the epoch of the memory manager at the last read or write.
+   * 
+   * @return size_type Epoch, or 0 if there is no memory manager or the LSM
+   * tree has not been accessed.
+   */
+  [[nodiscard]] size_type lastAccess() const noexcept {
+    return last_access_->load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Flush the memtable before it is full.
+   * @details Does nothing if it is empty. With background compaction, the
+   * flush is handed off to the worker, as for a full memtable.
+   * 
+   * @throw std::runtime_error If writing the SSTable or compaction fails.
+   */
+  void flushMemTable() {
+    std::lock_guard write_lock{*write_mutex_};
+    if (!mem_table_.empty()) {
+      flush();
+    }
+  }
+
+  /**
+   * @brief Release the read cache and the Bloom filters of the SSTables.
+   * @details The cache fills again with later reads, and each Bloom filter
+   * is loaded again from its metadata file on the next point read of its
+   * SSTable.
+   * 
+   */
+  void releaseMemory() const noexcept {
+    cache_.clear();
+    for (const auto& ck_layer : snapshot()->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        sstable->releaseFilter();
+      }
+    }
+  }
+
+  /**
+   * @brief Get the number of SSTables in the LSM tree.
+   * 
+   * @return size_type The number of SSTables.
+   */
+  [[nodiscard]] size_type sstableCount() const noexcept {
+    size_type count{0};
+    for (const auto& ck_layer : snapshot()->ck_layers) {
+      count += ck_layer.size();
+    }
+    return count;
+  }
+
+  /**
+   * @brief Get the number of SSTables in a Ck layer.
+   * 
+   * @param k Ck layer index.
+   * @return size_type The number of SSTables.
+   * 
+   * @throw std::out_of_range If the layer index is out of range.
+   */
+  [[nodiscard]] size_type sstableCount(size_type k) const {
+    if (k < 0 || k >= LAYER_COUNT) {
+      throw std::out_of_range{
+        "LSMTree::sstableCount(): Layer index out of range."
+      };
+    }
+    return snapshot()->ck_layers[k].size();
+  }
+
+  /**
+   * @brief Check if the LSM tree is empty.
+   * 
+   * @return true if the LSM tree is empty.
+   * @return false if the LSM tree is not empty.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    std::shared_lock lock{*mem_table_mutex_};
+    const auto version{snapshot()};
+    auto empty{mem_table_.empty() && version->immutable_mem_tables.empty()};
+    for (const auto& ck_layer : version->ck_layers) {
+      empty = empty && ck_layer.empty();
+      if (!empty) {
+        break;
+      }
+    }
+    return empty;
+  }
+
+  /**
+   * @brief Get the options of the LSM tree.
+   * 
+   * @return LSMTreeOptions Options.
+   */
+  [[nodiscard]] LSMTreeOptions options() const noexcept {
+    return options_;
+  }
+
+  /**
+   * @brief Get the newest timestamp written to the LSM tree.
+   * @details Removals do not lower it.
+   * 
+   * @return Timestamp Newest timestamp, or 0 if nothing was written.
+   */
+  [[nodiscard]] Timestamp newestTimestamp() const noexcept {
+    return newest_timestamp_->load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the tag index of the LSM tree.
+   * @details Lists every series ever written to the LSM tree.
+   * 
+   * @return const TagIndex& Tag index.
+   */
+  [[nodiscard]] const TagIndex& tagIndex() const noexcept {
+    return tag_index_;
+  }
+
+  /**
+   * @brief Add the sources of a scan over a range of keys to a merge.
+   * @details Adds the overlapping SSTables from the deepest layer up, each
+   * layer after the leveled range tombstones of its level, then the
+   * immutable memtables, oldest first, then the active memtable. Given a
+   * pool and more than one overlapping SSTable, the SSTables are read into
+   * sorted runs on the pool, and each run takes the place of its SSTable.
+   * The sources of several LSM trees can be added to the same merge, each
+   * after MergeIterator::beginPartition(), if their series are disjoint.
+   * 
+   * @tparam TFilter Filter type of the merge.
+   * @param merge Merge.
+   * @param start Start key.
+   * @param end End key.
+   * @param pool Pool to read the SSTables on, or null to leave them to be
+   * read lazily by the merge.
+   * 
+   * @throw std::exception If reading an SSTable fails.
+   */
+  template <typename TFilter>
+  void addScanSources(
+    MergeIterator<TValue, TFilter>& merge,
+    const key_type& range_start,
+    const key_type& end,
+    ThreadPool* pool = nullptr
+  ) const {
+    const auto cutoff{retention_cutoff()};
+    if (end.timestamp() < cutoff) {
+      return;
+    }
+    touch();
+    const auto start{
+      range_start.timestamp() < cutoff
+        ? key_type{cutoff, MIN_METRIC, {}}
+        : range_start
+    };
+    std::vector<value_type> active_entries;
+    std::vector<RangeTombstone> active_range_tombstones;
+    std::shared_ptr<const Snapshot> version;
+    {
+      std::shared_lock lock{*mem_table_mutex_};
+      active_entries = mem_table_.getRange(start, end);
+      active_range_tombstones = mem_table_.rangeTombstones();
+      version = snapshot();
+    }
+
+    std::pmr::vector<std::pair<size_type, SSTablePtr>> candidates{
+      merge.resource()
+    };
+    for (size_type k{LAYER_COUNT}; k > 0; --k) {
+      for (const auto position : version->layer_indices[k - 1].overlapping(
+             start.timestamp(), end.timestamp()
+           )) {
+        candidates.emplace_back(k - 1, version->ck_layers[k - 1][position]);
+      }
+    }
+    std::pmr::vector<std::future<Run>> runs{merge.resource()};
+    if (pool != nullptr && candidates.size() > 1) {
+      runs.reserve(candidates.size());
+      for (const auto& [layer, sstable] : candidates) {
+        runs.push_back(pool->submit(
+          [sstable, start, end, predicate = merge.predicate()] {
+            return read_sstable_range(*sstable, start, end, predicate);
+          }
+        ));
+      }
+    }
+
+    auto candidate{candidates.begin()};
+    for (size_type k{LAYER_COUNT}; k > 0; --k) {
+      for (const auto& [range_tombstone, level] : version->range_tombstones) {
+        if (level == k - 1) {
+          merge.addRangeTombstone(range_tombstone);
+        }
+      }
+      for (; candidate != candidates.end() && candidate->first == k - 1;
+           ++candidate) {
+        const auto& sstable{candidate->second};
+        if (runs.empty()) {
+          merge.addSSTable(sstable, start, end);
+        } else {
+          merge.addRun(
+            runs[candidate - candidates.begin()].get(),
+            sstable->rangeTombstones()
+          );
+        }
+      }
+    }
+    for (const auto& immutable : version->immutable_mem_tables) {
+      merge.addRun(
+        immutable.mem_table->getRange(start, end),
+        immutable.mem_table->rangeTombstones()
+      );
+    }
+    merge.addRun(std::move(active_entries), active_range_tombstones);
+  }
+
+private:
+  /**
+   * @brief Type alias for a shared pointer to an SSTable.
+   * @details SSTables are shared between layer snapshots, and their files
+   * are only removed once the last snapshot holding them is released.
+   * 
+   */
+  using SSTablePtr = std::shared_ptr<const SSTable<TValue>>;
+
+  /**
+   * @brief Type alias for an in-memory sorted run.
+   * 
+   */
+  using Run = typename MergeIterator<TValue>::Run;
+
+  /**
+   * @brief Type alias for a deque of SSTables.
+   * 
+   */
+  using SSTables = std::deque<SSTablePtr>;
+
   /**
    * @brief Type alias for SSTables.
    * 
@@ -306,108 +1399,255 @@ private:
   using CkLayers = std::vector<CkLayer>;
 
   /**
-   * @brief Type alias for time range.
-   * 
-   */
-  using TimeWindow = TimeRange;
-
-  /**
-   * @brief Type alias for LRU cache.
+   * @brief Frozen memtable waiting to be flushed to C0.
    * 
    */
-  using Cache = LRUCache<key_type, TValue>;
+  struct ImmutableMemTable {
+    /**
+     * @brief Memtable.
+     * 
+     */
+    std::shared_ptr<const MemTable<TValue>> mem_table;
+
+    /**
+     * @brief Path of the sealed WAL segment holding its records.
+     * 
+     */
+    FilePath wal_path;
+  };
 
   /**
-   * @brief Type alias for mapping from key to bool.
+   * @brief Type alias for a deque of immutable memtables, oldest first.
    * 
    */
-  using DirtyTable = std::unordered_map<key_type, bool>;
+  using ImmutableMemTables = std::deque<ImmutableMemTable>;
 
   /**
-   * @brief Type alias for mapping from time window to entries.
+   * @brief Range tombstone that has been compacted out of C0.
+   * @details It deletes the keys it covers in the layers deeper than its
+   * level. Everything it covers in its level and above was written after
+   * it, since the overlapping SSTables of its level were merged with it when
+   * it reached that level.
    * 
    */
-  using TimeWindowToEntriesMap = std::map<TimeWindow, table_type, std::greater<>>;
+  struct LeveledRangeTombstone {
+    /**
+     * @brief Range tombstone.
+     * 
+     */
+    RangeTombstone range_tombstone;
+
+    /**
+     * @brief Deepest layer it has been compacted into.
+     * 
+     */
+    size_type level;
+  };
 
   /**
-   * @brief Time window sizes of each Ck layer.
-   * @details The time window sizes are in seconds.
-   * - C0: 0 (any overlap)
-   * - C1: 30 minutes
-   * - C2: 1 hour
-   * - C3: 1 day
-   * - C4: 1 week
-   * - C5: 1 month
-   * - C6: 3 months
-   * - C7: 1 year
+   * @brief Immutable snapshot of the frozen memtables and SSTable layers.
    * 
    */
-  static constexpr std::array<size_type, LAYER_COUNT> CK_LAYER_WINDOW_SIZE{
-    0,
-    1800,
-    3600,
-    86400,
-    604800,
-    2592000,
-    7776000,
-    31536000
+  struct Snapshot {
+    /**
+     * @brief Immutable memtables, oldest first.
+     * 
+     */
+    ImmutableMemTables immutable_mem_tables;
+
+    /**
+     * @brief SSTable layers.
+     * 
+     */
+    CkLayers ck_layers;
+
+    /**
+     * @brief Index of each SSTable layer.
+     * @details Built by make_snapshot(), so it always matches the layers.
+     * 
+     */
+    std::vector<LayerIndex> layer_indices{};
+
+    /**
+     * @brief Range tombstones that have been compacted out of C0.
+     * 
+     */
+    std::vector<LeveledRangeTombstone> range_tombstones{};
   };
 
   /**
-   * @brief Number of SSTables in each Ck layer.
-   * @details The number of SSTables in each Ck layer is monotonically
-   * non-decreasing, either multiplying by a factor of 10 or staying the same.
+   * @brief Type alias for the read cache.
    * 
    */
-  static constexpr std::array<size_type, LAYER_COUNT> CK_LAYER_TABLE_COUNT{
-    10,
-    100,
-    100,
-    1000,
-    1000,
-    1000,
-    10000,
-    10000
-  };
+  using Cache = ShardedCache<key_type, TValue>;
 
   /**
    * @brief Get the next SSTable file path for a given layer.
+   * @details Takes the manifest mutex, so that the IDs committed to the
+   * manifest are never behind a file that has been written.
    * 
    * @param k Layer index.
    * @return FilePath SSTable file path.
    */
   [[nodiscard]] FilePath get_next_file_path(size_type k) noexcept {
+    std::lock_guard lock{*manifest_mutex_};
     return path_ / ("sstable_l" + std::to_string(k) + "_"
       + std::to_string(sstable_id_[k]++) + ".sst");
   }
 
   /**
    * @brief Load the SSTables from disk.
+   * @details The layers are read from the manifest, and any SSTable files it
+   * does not list are left over from an interrupted compaction, so they are
+   * removed. An LSM tree written before the manifest is loaded by scanning
+   * its directory instead, and a manifest is then committed for it. Loading
+   * does not compact, so that opening the tree is not held up by layers
+   * over their limits: with background compaction, the worker is scheduled
+   * to catch up, and otherwise the next flush compacts.
    * 
-   * @throw std::runtime_error If loading of any SSTable fails.
+   * @throw std::runtime_error If loading the manifest or any SSTable fails.
    */
   void load_sstables() {
-    std::array<std::set<FilePath>, LAYER_COUNT> sstable_files;
-    for (const auto& file : std::filesystem::directory_iterator(path_)) {
-      if (!file.is_regular_file() || file.path().extension() != ".sst") {
-        continue;
+    Snapshot version{{}, CkLayers{LAYER_COUNT}};
+    if (manifest_.load()) {
+      const auto& layers{manifest_.layers()};
+      std::set<std::string> live_files;
+      for (size_type k{0}; k < LAYER_COUNT; ++k) {
+        sstable_id_[k] = manifest_.nextIds()[k];
+        for (const auto& filename : layers[k]) {
+          version.ck_layers[k].push_back(
+            std::make_shared<const SSTable<TValue>>(
+              path_ / filename, options_.block_cache
+            )
+          );
+          live_files.insert(filename);
+        }
       }
-      const auto l_pos{file.path().filename().string().find("_l")};
-      const auto layer_idx{
-        std::stoull(file.path().filename().string().substr(l_pos + 2))
-      };
-      sstable_files[layer_idx].insert(file.path());
-      const auto id{
-        std::stoull(file.path().filename().string().substr(l_pos + 4))
-      };
-      sstable_id_[layer_idx] = std::max(sstable_id_[layer_idx], id + 1);
+      for (const auto& [level, range_tombstone] : manifest_.rangeTombstones()) {
+        validate_layer_index(level);
+        version.range_tombstones.push_back({
+          RangeTombstone{range_tombstone}, level
+        });
+      }
+      remove_unlisted_sstable_files(live_files);
+      publish(std::move(version));
+    } else {
+      std::array<std::map<size_type, FilePath>, LAYER_COUNT> sstable_files;
+      for (const auto& file : std::filesystem::directory_iterator(path_)) {
+        if (!file.is_regular_file() || file.path().extension() != ".sst") {
+          continue;
+        }
+        const auto filename{file.path().filename().string()};
+        const auto l_pos{filename.find("_l")};
+        const auto id_pos{filename.find('_', l_pos + 2)};
+        const auto layer_idx{std::stoull(filename.substr(l_pos + 2))};
+        const size_type id{std::stoull(filename.substr(id_pos + 1))};
+        validate_layer_index(layer_idx);
+        sstable_files[layer_idx].emplace(id, file.path());
+        sstable_id_[layer_idx] = std::max(sstable_id_[layer_idx], id + 1);
+      }
+      for (size_type k{0}; k < LAYER_COUNT; ++k) {
+        for (const auto& [id, sstable_file] : sstable_files[k]) {
+          version.ck_layers[k].push_back(
+            std::make_shared<const SSTable<TValue>>(
+              sstable_file, options_.block_cache
+            )
+          );
+        }
+      }
+      const auto lock{commit_layers([&version](auto& new_version) {
+        new_version.ck_layers = version.ck_layers;
+      })};
+      publish(std::move(version));
     }
-    for (size_type k{0}; k < LAYER_COUNT; ++k) {
-      for (const auto& sstable_file : sstable_files[k]) {
-        ck_layers_[k].emplace_back(std::move(sstable_file));
+    for (const auto& ck_layer : snapshot()->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        if (sstable->timeRange().isSet()) {
+          advance_newest_timestamp(sstable->timeRange().upper());
+        }
+      }
+    }
+    if (options_.background_compaction) {
+      compaction_worker_.start([this] { run_background_compaction(); });
+      compaction_worker_.schedule();
+    }
+  }
+
+  /**
+   * @brief Get the path of the tag index file.
+   * 
+   * @return FilePath Path.
+   */
+  [[nodiscard]] FilePath tag_index_path() const noexcept {
+    return path_ / TAG_INDEX_FILENAME;
+  }
+
+  /**
+   * @brief Load the tag index from disk.
+   * @details If the file is missing or malformed, as for an LSM tree written
+   * before the tag index, the index is rebuilt from the series of each
+   * SSTable and saved. Series only in the WAL are indexed as it is replayed.
+   * 
+   * @throw std::runtime_error If an SSTable cannot be read, or if saving a
+   * rebuilt index fails.
+   */
+  void load_tag_index() {
+    if (tag_index_.load(tag_index_path())) {
+      return;
+    }
+    for (const auto& ck_layer : snapshot()->ck_layers) {
+      for (const auto& sstable : ck_layer) {
+        if (!sstable->seriesKeys().empty()) {
+          for (const auto& series_key : sstable->seriesKeys()) {
+            tag_index_.insert(series_key);
+          }
+          continue;
+        }
+        for (const auto& [key, value] : sstable->entries()) {
+          tag_index_.insert(key);
+        }
+      }
+    }
+    save_tag_index();
+  }
+
+  /**
+   * @brief Save the tag index to disk, if it has unsaved series.
+   * @details Called once SSTables are committed, so that every series with
+   * data outside the WAL is in the saved index.
+   * 
+   * @throw std::runtime_error If the file cannot be written.
+   */
+  void save_tag_index() const {
+    if (tag_index_.dirty()) {
+      tag_index_.save(tag_index_path(), options_.io_backend);
+    }
+  }
+
+  /**
+   * @brief Remove the SSTable files that are not listed in the manifest.
+   * 
+   * @param live_files File names of the listed SSTables.
+   */
+  void remove_unlisted_sstable_files(
+    const std::set<std::string>& live_files
+  ) const noexcept {
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(path_, ec)) {
+      const auto& file_path{file.path()};
+      const auto extension{file_path.extension()};
+      if (
+        !file_path.filename().string().starts_with("sstable_l") ||
+        (extension != ".sst" && extension != ".metadata")
+      ) {
+        continue;
+      }
+      auto sstable_file{file_path.filename()};
+      sstable_file.replace_extension(".sst");
+      if (!live_files.contains(sstable_file.string())) {
+        std::filesystem::remove(file_path, ec);
       }
     }
-    compact();
   }
 
   /**
@@ -425,78 +1665,591 @@ private:
   }
 
   /**
-   * @brief Reset a layer.
-   * @details Clear the layer and reset the SSTable ID.
+   * @brief Get the current snapshot of the frozen memtables and layers.
    * 
-   * @param k Layer index.
-   * @throw std::out_of_range If the layer index is out of range.
+   * @return std::shared_ptr<const Snapshot> Snapshot.
+   */
+  [[nodiscard]] std::shared_ptr<const Snapshot> snapshot() const noexcept {
+    std::lock_guard lock{*snapshot_mutex_};
+    return snapshot_;
+  }
+
+  /**
+   * @brief Index the layers of a snapshot and make it immutable.
+   * @details SSTables are indexed by the time range of their entries and
+   * range tombstones.
+   * 
+   * @param version Snapshot.
+   * @return std::shared_ptr<const Snapshot> Indexed snapshot.
+   */
+  [[nodiscard]] static std::shared_ptr<const Snapshot> make_snapshot(
+    Snapshot&& version
+  ) {
+    version.layer_indices.clear();
+    version.layer_indices.reserve(version.ck_layers.size());
+    std::vector<TimeRange> time_ranges;
+    for (const auto& ck_layer : version.ck_layers) {
+      time_ranges.clear();
+      for (const auto& sstable : ck_layer) {
+        time_ranges.push_back(sstable->coveredTimeRange());
+      }
+      version.layer_indices.emplace_back(time_ranges);
+    }
+    return std::make_shared<const Snapshot>(std::move(version));
+  }
+
+  /**
+   * @brief Replace the snapshot of the frozen memtables and layers.
+   * 
+   * @param version New snapshot.
+   */
+  void publish(Snapshot&& version) {
+    {
+      std::lock_guard lock{*snapshot_mutex_};
+      snapshot_ = make_snapshot(std::move(version));
+    }
+    snapshot_changed_->notify_all();
+  }
+
+  /**
+   * @brief Publish a modified copy of the current snapshot.
+   * @details The copy is taken and published under the snapshot mutex, so
+   * that a concurrent flush or compaction is never overwritten.
+   * 
+   * @tparam Fn Function type.
+   * @param update Function that modifies the copy.
+   */
+  template <std::invocable<Snapshot&> Fn>
+  void update_snapshot(Fn&& update) {
+    {
+      std::lock_guard lock{*snapshot_mutex_};
+      auto version{*snapshot_};
+      update(version);
+      snapshot_ = make_snapshot(std::move(version));
+    }
+    snapshot_changed_->notify_all();
+  }
+
+  /**
+   * @brief Commit a change to the layers to the manifest.
+   * @details The change is applied to a copy of the current snapshot to find
+   * the new layers, whose SSTables must all be written. They are committed
+   * to the manifest along with the leveled range tombstones, and the manifest mutex is returned held, so that the
+   * caller can publish the same change with update_snapshot() before any
+   * other change to the layers. The change is applied again when it is
+   * published, so it must not move out of anything it captures.
+   * 
+   * @tparam Fn Function type.
+   * @param update Function that modifies the copy.
+   * @return std::unique_lock<std::mutex> Lock on the manifest mutex.
+   * 
+   * @throw std::runtime_error If the manifest cannot be written or synced.
+   */
+  template <std::invocable<Snapshot&> Fn>
+  [[nodiscard]] std::unique_lock<std::mutex> commit_layers(Fn&& update) {
+    std::unique_lock lock{*manifest_mutex_};
+    auto version{*snapshot()};
+    update(version);
+    if (options_.sync_sstables) {
+      syncDirectory(path_);
+    }
+    commit_manifest(manifest_, version, sstable_id_);
+    return lock;
+  }
+
+  /**
+   * @brief Commit the layers and leveled range tombstones of a snapshot to
+   * a manifest.
+   * 
+   * @param manifest Manifest.
+   * @param version Snapshot.
+   * @param next_ids Next SSTable ID of each layer.
+   * 
+   * @throw std::runtime_error If the manifest cannot be written or synced.
+   */
+  static void commit_manifest(
+    Manifest& manifest,
+    const Snapshot& version,
+    std::span<const size_type> next_ids
+  ) {
+    Manifest::Layers layers(LAYER_COUNT);
+    for (size_type k{0}; k < LAYER_COUNT; ++k) {
+      for (const auto& sstable : version.ck_layers[k]) {
+        layers[k].push_back(sstable->path().filename().string());
+      }
+    }
+    Manifest::RangeTombstones range_tombstones;
+    for (const auto& [range_tombstone, level] : version.range_tombstones) {
+      range_tombstones.emplace_back(level, range_tombstone.str());
+    }
+    manifest.commit(layers, next_ids, range_tombstones);
+  }
+
+  /**
+   * @brief Rethrow the error of a failed background compaction, if any.
+   * @details The error is cleared, so it is only rethrown once.
+   * 
+   * @throw std::exception If a background compaction failed.
+   */
+  void rethrow_compaction_error() {
+    std::exception_ptr error;
+    {
+      std::lock_guard lock{*snapshot_mutex_};
+      error = std::exchange(compaction_error_, nullptr);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * @brief Block until another memtable can be frozen.
+   * @details Waits while the immutable memtable queue is full, or while C0
+   * and the queue together are at the stall threshold. Returns early if the
+   * background compaction fails.
+   * 
+   */
+  void wait_for_capacity() const noexcept {
+    std::unique_lock lock{*snapshot_mutex_};
+    snapshot_changed_->wait(lock, [this] {
+      const auto frozen{snapshot_->immutable_mem_tables.size()};
+      return compaction_error_ != nullptr || (
+        frozen < options_.max_immutable_mem_tables &&
+        snapshot_->ck_layers[0].size() + frozen + 1
+          < options_.c0_stall_threshold
+      );
+    });
+  }
+
+  /**
+   * @brief Note an access at the memory manager's current epoch.
+   * @details Only stores the epoch when it has moved on, so that concurrent
+   * reads rarely write to the same cache line.
+   * 
+   */
+  void touch() const noexcept {
+    if (!options_.memory_manager) {
+      return;
+    }
+    const auto epoch{options_.memory_manager->epoch()};
+    if (last_access_->load(std::memory_order_relaxed) != epoch) {
+      last_access_->store(epoch, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Charge written entries to the memory manager, if any.
+   * @details Must be called without the write mutex held, since the memory
+   * manager may flush this LSM tree.
+   * 
+   * @param entry_count Number of entries written to the memtable.
+   * 
+   * @throw std::exception If an early flush fails.
+   */
+  void charge_memory(size_type entry_count) {
+    if (!options_.memory_manager) {
+      return;
+    }
+    touch();
+    options_.memory_manager->charge(entry_count * ENTRY_BYTES);
+  }
+
+  /**
+   * @brief Apply a write to the active memtable.
+   * @details Flushes the memtable if it is full. Must be called with the
+   * write mutex held.
+   * 
+   * @param key Key.
+   * @param value Value, or std::nullopt for a removal.
+   * 
+   * @throw std::runtime_error If flushing the memtable fails.
+   */
+  void apply(const key_type& key, const mapped_type& value) {
+    advance_newest_timestamp(key.timestamp());
+    tag_index_.insert(key);
+    {
+      std::unique_lock lock{*mem_table_mutex_};
+      mem_table_.put(key, value);
+      cache_.erase(key);
+    }
+    record_latest(key, value);
+    if (mem_table_.size() == options_.mem_table_max_entries) {
+      flush();
+    }
+  }
+
+  /**
+   * @brief Apply a group of writes to the active memtable.
+   * @details The group must fit in the memtable. Flushes the memtable if it
+   * is full afterwards. Must be called with the write mutex held.
+   * 
+   * @param group Entries.
+   * 
+   * @throw std::runtime_error If flushing the memtable fails.
+   */
+  void apply_group(std::span<const TimeSeriesEntry<TValue>> group) {
+    for (const auto& [key, value] : group) {
+      advance_newest_timestamp(key.timestamp());
+      tag_index_.insert(key);
+    }
+    {
+      std::unique_lock lock{*mem_table_mutex_};
+      for (const auto& [key, value] : group) {
+        mem_table_.put(key, value);
+        cache_.erase(key);
+      }
+    }
+    for (const auto& [key, value] : group) {
+      record_latest(key, value);
+    }
+    if (mem_table_.size() == options_.mem_table_max_entries) {
+      flush();
+    }
+  }
+
+  /**
+   * @brief Record a write in the latest-value index.
+   * @details Must be called once the write is visible to reads, so that a
+   * resolution that read the LSM tree before a removal is discarded.
+   * 
+   * @param key Key.
+   * @param value Value, or std::nullopt for a removal.
+   */
+  void record_latest(const key_type& key, const mapped_type& value) {
+    if (value.has_value()) {
+      latest_index_.put(key, value.value());
+    } else {
+      latest_index_.remove(key);
+    }
+  }
+
+  /**
+   * @brief Read the newest live entry of each of a set of series in a range.
+   * @details The range is read in windows going back from its end, or from
+   * the newest timestamp written, each twice as wide as the last, until
+   * every series is found or the range is exhausted.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @param predicate Predicate.
+   * @param wanted IDs of the series to find.
+   * @return std::unordered_map<SeriesId, LatestValue<TValue>> Newest value
+   * of each series found.
+   * 
+   * @throw std::exception If getting the entries fails.
+   */
+  [[nodiscard]] std::unordered_map<SeriesId, LatestValue<TValue>> read_latest(
+    const key_type& start,
+    const key_type& end,
+    const KeyPredicate& predicate,
+    std::unordered_set<SeriesId> wanted
+  ) const {
+    std::unordered_map<SeriesId, LatestValue<TValue>> found;
+    const auto lowest{std::max(start.timestamp(), retention_cutoff())};
+    auto highest{std::min(end.timestamp(), newestTimestamp())};
+    if (wanted.empty() || highest < lowest) {
+      return found;
+    }
+    Timestamp width{1};
+    while (true) {
+      const auto window_start{
+        highest - lowest < width ? lowest : highest - width + 1
+      };
+      const auto window{getRange(
+        window_start == start.timestamp()
+          ? start
+          : key_type{window_start, MIN_METRIC, {}},
+        highest == end.timestamp() ? end : key_type{highest, MAX_METRIC, {}},
+        predicate
+      )};
+      for (auto it{window.rbegin()}; it != window.rend(); ++it) {
+        const auto& [key, value]{*it};
+        if (wanted.erase(key.seriesId()) > 0) {
+          found.emplace(
+            key.seriesId(),
+            LatestValue<TValue>{key.timestamp(), value.value()}
+          );
+        }
+      }
+      if (wanted.empty() || window_start == lowest) {
+        return found;
+      }
+      highest = window_start - 1;
+      width = width > std::numeric_limits<Timestamp>::max() / 2
+        ? std::numeric_limits<Timestamp>::max()
+        : width * 2;
+    }
+  }
+
+  /**
+   * @brief Check if a batch should be bulk-loaded.
+   * 
+   * @param entries Entries.
+   * @return true if the batch fills at least one memtable and its keys are
+   * strictly increasing, outside of a replay.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool is_bulk_load(
+    std::span<const TimeSeriesEntry<TValue>> entries
+  ) const noexcept {
+    return !options_.wal.archive && !replaying_ &&
+      entries.size() >= options_.mem_table_max_entries &&
+      std::adjacent_find(
+        entries.begin(),
+        entries.end(),
+        [](const auto& lhs, const auto& rhs) {
+          return !(lhs.first < rhs.first);
+        }
+      ) == entries.end();
+  }
+
+  /**
+   * @brief Write a sorted batch straight to C0 SSTables.
+   * @details Flushes the memtable and waits for the immutable memtables to
+   * reach C0 first, so that the new SSTables are newer than everything
+   * already in the tree. Each SSTable is published on its own, compacting in
+   * between so that C0 stays within its limits. Must be called with the
+   * write mutex held.
+   * 
+   * @param entries Entries, sorted by key without duplicates.
+   * 
+   * @throw std::runtime_error If writing an SSTable or compaction fails, or
+   * if a background compaction failed.
+   */
+  void bulk_load(std::span<const TimeSeriesEntry<TValue>> entries) {
+    if (mem_table_.size() > 0 || !mem_table_.rangeTombstones().empty()) {
+      flush();
+    }
+    wait_for_immutable_mem_tables();
+
+    const auto chunk_size{options_.mem_table_max_entries};
+    while (!entries.empty()) {
+      const auto chunk{entries.first(std::min(chunk_size, entries.size()))};
+      entries = entries.subspan(chunk.size());
+
+      MemTable<TValue> sorted{MemTableFormat::SORTED_RUN, chunk.size()};
+      for (const auto& [key, value] : chunk) {
+        sorted.put(key, value);
+        tag_index_.insert(key);
+      }
+      advance_newest_timestamp(chunk.back().first.timestamp());
+
+      if (options_.background_compaction) {
+        wait_for_capacity();
+        rethrow_compaction_error();
+      }
+      auto sstable{std::make_shared<const SSTable<TValue>>(
+        get_next_file_path(0),
+        sorted,
+        sorted.size(),
+        sstable_options(false, IOPriority::FLUSH)
+      )};
+      metrics_->flushes.add();
+      metrics_->bytes_written[0].add(sstable_bytes(*sstable));
+      const auto add_sstable{[&sstable](auto& version) {
+        version.ck_layers[0].push_back(sstable);
+      }};
+      {
+        const auto manifest_lock{commit_layers(add_sstable)};
+        std::unique_lock lock{*mem_table_mutex_};
+        for (const auto& [key, value] : chunk) {
+          cache_.erase(key);
+        }
+        update_snapshot(add_sstable);
+      }
+      for (const auto& [key, value] : chunk) {
+        record_latest(key, value);
+      }
+
+      save_tag_index();
+
+      if (options_.background_compaction) {
+        compaction_worker_.schedule();
+      } else {
+        compact();
+      }
+    }
+  }
+
+  /**
+   * @brief Get the size of an SSTable's files.
+   * 
+   * @param sstable SSTable.
+   * @return size_type Bytes of its data and metadata, counting a file that
+   * cannot be read as empty.
+   */
+  [[nodiscard]] static size_type sstable_bytes(
+    const SSTable<TValue>& sstable
+  ) noexcept {
+    std::error_code ec;
+    size_type bytes{0};
+    for (const auto& path : {sstable.path(), sstable.metadataPath()}) {
+      const auto size{std::filesystem::file_size(path, ec)};
+      if (!ec) {
+        bytes += size;
+      }
+    }
+    return bytes;
+  }
+
+  /**
+   * @brief Block until every immutable memtable has been flushed to C0.
+   * @details Returns immediately with synchronous compaction, since
+   * memtables are flushed as soon as they are frozen.
+   * 
+   * @throw std::exception If a background compaction failed.
+   */
+  void wait_for_immutable_mem_tables() {
+    if (!options_.background_compaction) {
+      return;
+    }
+    {
+      std::unique_lock lock{*snapshot_mutex_};
+      snapshot_changed_->wait(lock, [this] {
+        return compaction_error_ != nullptr ||
+          snapshot_->immutable_mem_tables.empty();
+      });
+    }
+    rethrow_compaction_error();
+  }
+
+  /**
+   * @brief Cache a value that was just read.
+   * @details Must be called with the memtable lock held, which keeps writes
+   * out until the read is done. Writes evict the keys they touch from the
+   * cache under the exclusive lock, so a cached value is never stale.
+   * 
+   * @param key Key.
+   * @param value Value.
+   */
+  void cache_value(const key_type& key, const mapped_type& value) const {
+    cache_.put(key, value);
+  }
+
+  /**
+   * @brief Flush the memtable.
+   * @details Freezes the memtable so that a fresh one takes writes. With
+   * background compaction, flushing it to C0 and compacting is handed off to
+   * the worker thread, and this blocks only while the worker is backed up.
+   * Otherwise, both happen before returning. During a replay, it is flushed
+   * to C0 before returning, and compaction waits for the replay to finish.
+   * 
+   * @throw std::runtime_error If writing the SSTable or compaction fails.
    */
-  void reset_layer(size_type k) noexcept {
-    validate_layer_index(k);
-    ck_layers_[k].clear();
-    sstable_id_[k] = 0;
+  void flush() {
+    if (replaying_) {
+      freeze_mem_table();
+      flush_immutable_mem_tables();
+      return;
+    }
+    if (options_.background_compaction) {
+      rethrow_compaction_error();
+      compaction_worker_.start([this] { run_background_compaction(); });
+      wait_for_capacity();
+      rethrow_compaction_error();
+    }
+
+    freeze_mem_table();
+
+    if (options_.background_compaction) {
+      compaction_worker_.schedule();
+      return;
+    }
+    flush_immutable_mem_tables();
+    compact();
   }
 
   /**
-   * @brief Flush the memtable to an SSTable.
+   * @brief Freeze the memtable into an immutable memtable.
+   * @details Seals the WAL along with it, so that the segment can be removed
+   * once the memtable has been flushed. A sorted run's side buffer is merged
+   * first, so reads of the frozen memtable only search one run.
    * 
-   * @throw std::runtime_error if the C1 layer is full.
+   * @throw std::filesystem::filesystem_error If the WAL cannot be sealed.
    */
-  void flush() {
-    FilePath sstable_file_path{get_next_file_path(0)};
-    ck_layers_[0].emplace_back(
-      sstable_file_path,
-      std::move(mem_table_),
-      mem_table_.size()
-    );
-    compact();
-    mem_table_.clear();
-    wal_.clear();
+  void freeze_mem_table() {
+    auto wal_path{wal_.seal()};
+    std::unique_lock lock{*mem_table_mutex_};
+    mem_table_.mergeSideBuffer();
+    ImmutableMemTable immutable{
+      std::make_shared<const MemTable<TValue>>(std::move(mem_table_)),
+      std::move(wal_path)
+    };
+    mem_table_ = MemTable<TValue>{
+      options_.mem_table_format,
+      options_.mem_table_max_entries
+    };
+
+    update_snapshot([&immutable](auto& version) {
+      version.immutable_mem_tables.push_back(std::move(immutable));
+    });
   }
 
   /**
-   * @brief Update entries with a filtered key-value pair.
+   * @brief Flush the immutable memtables to C0, oldest first.
+   * @details Each flushed memtable is swapped for its SSTable in a single
+   * snapshot, once the SSTable has been committed to the manifest, and its
+   * WAL segment is removed afterwards, once the tag index has been saved
+   * with the series it wrote.
    * 
-   * @param key Key.
-   * @param value Value.
-   * @param filter Filter.
-   * @param entry_table Entries.
+   * @throw std::runtime_error If writing an SSTable fails.
    */
-  void update_entries_with_filtered_key(
-    const key_type& key,
-    const mapped_type& value,
-    const TimeSeriesKeyFilter& filter,
-    table_type& entry_table
-  ) const noexcept {
-    if (!filter(key)) {
-      return;
-    }
-    if (!value.has_value()) {
-      entry_table.erase(key);
-      return;
+  void flush_immutable_mem_tables() {
+    while (true) {
+      const auto version{snapshot()};
+      if (version->immutable_mem_tables.empty()) {
+        return;
+      }
+      const auto& oldest{version->immutable_mem_tables.front()};
+      LatencyTimer timer{metrics_->flush_latency};
+      auto sstable{std::make_shared<const SSTable<TValue>>(
+        get_next_file_path(0),
+        *oldest.mem_table,
+        std::max<size_type>(oldest.mem_table->size(), 1),
+        sstable_options(false, IOPriority::FLUSH)
+      )};
+      metrics_->flushes.add();
+      metrics_->bytes_written[0].add(sstable_bytes(*sstable));
+
+      const auto swap_in_sstable{[&sstable](auto& new_version) {
+        new_version.immutable_mem_tables.pop_front();
+        new_version.ck_layers[0].push_back(sstable);
+      }};
+      {
+        const auto lock{commit_layers(swap_in_sstable)};
+        update_snapshot(swap_in_sstable);
+      }
+      save_tag_index();
+      wal_.release(oldest.wal_path);
     }
-    entry_table[key] = value;
   }
 
   /**
-   * @brief Update entries with a filtered SSTable range.
+   * @brief Searches immutable memtables for a key, newest first.
    * 
-   * @param sstable SSTable.
-   * @param start Start key.
-   * @param end End key.
-   * @param filter Filter.
-   * @param entry_table Entries.
+   * @param immutable_mem_tables Immutable memtables.
+   * @param key Key.
+   * @return std::optional<mapped_type> The stored value if the key is in an
+   * immutable memtable, a removal if a range tombstone of one covers it, and
+   * std::nullopt otherwise.
    */
-  void update_entries_with_sstable_range(
-    const SSTable<TValue>& sstable,
-    const key_type& start,
-    const key_type& end,
-    const TimeSeriesKeyFilter& filter,
-    table_type& entry_table
-  ) const noexcept {
-    for (const auto& [key, value] : sstable.getRange(start, end)) {
-      update_entries_with_filtered_key(key, value, filter, entry_table);
+  std::optional<mapped_type> search_immutable_memtables(
+    const ImmutableMemTables& immutable_mem_tables,
+    const key_type& key
+  ) const {
+    for (const auto& immutable : immutable_mem_tables | std::views::reverse) {
+      if (!immutable.mem_table->contains(key)) {
+        if (immutable.mem_table->isRangeDeleted(key)) {
+          cache_value(key, std::nullopt);
+          return mapped_type{std::nullopt};
+        }
+        continue;
+      }
+      const auto value{immutable.mem_table->get(key)};
+      cache_value(key, value);
+      return value;
     }
+    return std::nullopt;
   }
 
   /**
@@ -508,322 +2261,646 @@ private:
    */
   mapped_type search_memtable(const key_type& key) const {
     const auto mem_table_value{mem_table_.get(key)};
-    cache_.put(key, mem_table_value);
-    dirty_table_[key] = false;
+    cache_value(key, mem_table_value);
     return mem_table_value;
   }
 
   /**
-   * @brief Iteratively searches SSTables of a layer for a key.
+   * @brief Searches the SSTables of a layer for a key, newest first.
+   * @details Only the SSTables whose time range contains the key's timestamp
+   * are searched, as given by the layer index.
    * 
+   * @param version Snapshot of the layers.
    * @param k Layer index.
    * @param key Key.
-   * @return mapped_type The value if it is found, std::nullopt otherwise.
+   * @return std::optional<mapped_type> The value if it is found, a removal if
+   * the newest SSTable holding the key holds a tombstone of it or a range
+   * tombstone of an SSTable covers it, and std::nullopt otherwise.
    * 
-   * @throw std::out_of_range If the layer index is out of range.
+   * @throw std::exception If searching for the key fails.
    */
-  mapped_type iterative_layer_search(
+  std::optional<mapped_type> search_layer(
+    const Snapshot& version,
     size_type k,
     const key_type& key
   ) const {
-    validate_layer_index(k);
-    for (const auto& sstable : ck_layers_[k] | std::views::reverse) {
-      const auto sstable_value{sstable.get(key)};
-      if (!sstable_value.has_value()) {
-        continue;
+    const auto& ck_layer{version.ck_layers[k]};
+    const auto timestamp{key.timestamp()};
+    const auto positions{
+      version.layer_indices[k].overlapping(timestamp, timestamp)
+    };
+    for (const auto position : positions | std::views::reverse) {
+      const auto& sstable{ck_layer[position]};
+      const auto sstable_value{sstable->find(key, metrics_.get())};
+      if (sstable_value.has_value()) {
+        cache_value(key, sstable_value.value());
+        return sstable_value;
+      }
+      if (sstable->isRangeDeleted(key)) {
+        cache_value(key, std::nullopt);
+        return mapped_type{std::nullopt};
       }
-      cache_.put(key, sstable_value);
-      dirty_table_[key] = false;
-      return sstable_value;
     }
     return std::nullopt;
   }
 
   /**
-   * @brief Binary searches SSTables of a layer for a key.
+   * @brief Get the deepest layer that may hold a live value of a key.
+   * @details A leveled range tombstone that covers the key deletes it in
+   * the layers deeper than its level.
    * 
-   * @param k Layer index.
+   * @param version Snapshot of the layers.
    * @param key Key.
-   * @return mapped_type The value if it is found, std::nullopt otherwise.
-   * 
-   * @throw std::exception If searching for the key fails.
+   * @return size_type Layer index.
    */
-  mapped_type binary_layer_search(
-    size_type k,
+  [[nodiscard]] static size_type searchable_depth(
+    const Snapshot& version,
     const key_type& key
-  ) const {
-    const auto timestamp{key.timestamp()};
-    const auto& ck_layer{ck_layers_[k]};
-    auto sstable_it{std::lower_bound(
-      ck_layer.begin(),
-      ck_layer.end(),
-      timestamp,
-      [](const auto& sstable, const auto target_time) {
-        return target_time < sstable.timeRange().lower();
-      }
-    )};
-
-    if (
-      sstable_it != ck_layer.end() && 
-      sstable_it->timeRange().lower() <= timestamp && 
-      timestamp <= sstable_it->timeRange().upper()
-    ) {
-      const auto sstable_value{sstable_it->get(key)};
-      if (sstable_value.has_value()) {
-        cache_.put(key, sstable_value);
-        dirty_table_[key] = false;
-        return sstable_value;
+  ) noexcept {
+    auto depth{LAYER_COUNT - 1};
+    for (const auto& [range_tombstone, level] : version.range_tombstones) {
+      if (level < depth && range_tombstone.covers(key)) {
+        depth = level;
       }
-      return std::nullopt;
     }
-    return std::nullopt;
+    return depth;
   }
 
-
   /**
-   * @brief Binary searches SSTables of a layer for a filtered range of keys.
-   * @details Updates entry table with the range of key-value pairs.
+   * @brief Read the entries of an SSTable in a range of keys into a sorted
+   * run.
+   * @details Reads the same entries, tombstones included, as a merge would
+   * have taken from the SSTable.
    * 
-   * @param k Layer index.
+   * @param sstable SSTable.
    * @param start Start key.
    * @param end End key.
-   * @param filter Filter.
-   * @param entry_table Entries.
+   * @param predicate Predicate, or null to read every block.
+   * @return Run Entries, in key order.
    * 
-   * @throw std::exception If searching for the keys fails.
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
    */
-  void binary_layer_search_range(
-    size_type k,
+  [[nodiscard]] static Run read_sstable_range(
+    const SSTable<TValue>& sstable,
     const key_type& start,
     const key_type& end,
-    const TimeSeriesKeyFilter& filter,
-    table_type& entry_table
-  ) const {
-    const auto& ck_layer{ck_layers_[k]};
-    auto start_it{std::lower_bound(
-      ck_layer.begin(),
-      ck_layer.end(),
-      start.timestamp(),
-      [](const auto& sstable, const auto target_time) {
-        return sstable.timeRange().upper() < target_time;
-      }
-    )};
-    
-    auto end_it{std::upper_bound(
-      start_it,
-      ck_layer.end(),
-      end.timestamp(),
-      [](const auto target_time, const auto& sstable) {
-        return target_time < sstable.timeRange().lower();
-      }
-    )};
+    const std::shared_ptr<const KeyPredicate>& predicate
+  ) {
+    Run run;
+    if (predicate && !sstable.mayMatch(*predicate)) {
+      return run;
+    }
+    for (auto cursor{sstable.cursor(start, end, predicate)}; cursor.valid();
+         cursor.advance()) {
+      run.push_back(cursor.entry());
+    }
+    return run;
+  }
 
-    for (
-      const auto& sstable :
-      std::ranges::subrange(start_it, end_it) | std::views::reverse
-    ) {
-      update_entries_with_sstable_range(
-        sstable, start, end, filter, entry_table
-      );
+  /**
+   * @brief Drain a scan into a vector.
+   * 
+   * @tparam TFilter Filter type of the scan.
+   * @param merge Scan.
+   * @return std::vector<value_type> Entries, in key order.
+   * 
+   * @throw std::exception If reading an SSTable fails.
+   */
+  template <typename TFilter>
+  [[nodiscard]] static std::vector<value_type> drain(
+    MergeIterator<TValue, TFilter>&& merge
+  ) {
+    std::vector<value_type> entries;
+    while (auto entry{merge.next()}) {
+      entries.push_back(std::move(*entry));
     }
+    return entries;
   }
 
   /**
-   * @brief Compact the LSM tree.
-   * @details Compact the C0 layer if needed, which will compact the C1 layer
-   * if needed after the compaction, and so on.
+   * @brief Get the oldest timestamp within the retention.
    * 
-   * @throw std::exception If the compaction fails.
+   * @return Timestamp Retention cutoff, or 0 if everything is kept.
    */
-  void compact() {
-    compact_layer_if_needed(0);
+  [[nodiscard]] Timestamp retention_cutoff() const noexcept {
+    const auto newest{newest_timestamp_->load(std::memory_order_relaxed)};
+    return options_.retention == 0 || newest < options_.retention
+      ? 0
+      : newest - options_.retention;
   }
 
   /**
-   * @brief Compact a layer if needed.
+   * @brief Raise the newest timestamp written to the LSM tree.
    * 
-   * @param k Layer index.
+   * @param timestamp Timestamp.
+   */
+  void advance_newest_timestamp(Timestamp timestamp) noexcept {
+    auto newest{newest_timestamp_->load(std::memory_order_relaxed)};
+    while (
+      newest < timestamp &&
+      !newest_timestamp_->compare_exchange_weak(
+        newest, timestamp, std::memory_order_relaxed
+      )
+    ) {}
+  }
+
+  /**
+   * @brief Remove the SSTables that hold only entries past the retention.
+   * @details Only their time ranges are looked at. They are committed out of
+   * the layers in a single version, along with the leveled range tombstones
+   * past the retention, and their files are removed once no snapshot holds
+   * them.
    * 
-   * @throw std::out_of_range If the layer index is out of range.
+   * @throw std::runtime_error If the manifest cannot be written.
    */
-  void compact_layer_if_needed(size_type k) {
-    validate_layer_index(k);
-    if (k == LAYER_COUNT - 1) {
+  void drop_expired_sstables() {
+    const auto cutoff{retention_cutoff()};
+    if (cutoff == 0) {
       return;
     }
-    if (ck_layers_[k].size() <= CK_LAYER_TABLE_COUNT[k]) {
+    const auto is_expired{[cutoff](const auto& sstable) {
+      return sstable->coveredTimeRange().upper() < cutoff;
+    }};
+    const auto is_expired_range_tombstone{[cutoff](const auto& leveled) {
+      return leveled.range_tombstone.end() < cutoff;
+    }};
+    const auto version{snapshot()};
+    CkLayers expired{LAYER_COUNT};
+    for (size_type k{0}; k < LAYER_COUNT; ++k) {
+      std::ranges::copy_if(
+        version->ck_layers[k], std::back_inserter(expired[k]), is_expired
+      );
+    }
+    if (
+      std::ranges::all_of(expired, &CkLayer::empty) &&
+      std::ranges::none_of(
+        version->range_tombstones, is_expired_range_tombstone
+      )
+    ) {
       return;
     }
-    compact_layer(k);
-    compact_layer_if_needed(k + 1);
+
+    const auto drop_expired{[&](auto& new_version) {
+      for (auto& ck_layer : new_version.ck_layers) {
+        std::erase_if(ck_layer, is_expired);
+      }
+      std::erase_if(new_version.range_tombstones, is_expired_range_tombstone);
+    }};
+    {
+      const auto lock{commit_layers(drop_expired)};
+      update_snapshot(drop_expired);
+    }
+    for (const auto& ck_layer : expired) {
+      for (const auto& sstable : ck_layer) {
+        sstable->markObsolete();
+      }
+    }
   }
 
   /**
-   * @brief Compact a layer.
-   * 
-   * @param k Layer index.
+   * @brief Compact the LSM tree.
+   * @details Drops the SSTables past the retention, then compacts the C0
+   * layer if needed, which will compact the C1 layer if needed after the
+   * compaction, and so on.
    * 
-   * @throw std::out_of_range If the layer index is out of range.
+   * @throw std::exception If the compaction fails.
    */
-  void compact_layer(size_type k) {
-    if (k == 0) {
-      merge_all_in_layer(k);
-      return;
-    }
-    while (ck_layers_[k].size() > CK_LAYER_TABLE_COUNT[k]) {
-      merge_oldest_in_layer(k);
+  void compact() {
+    drop_expired_sstables();
+    for (size_type k{0}; k < LAYER_COUNT - 1; ++k) {
+      const auto version{snapshot()};
+      if (version->ck_layers[k].size() <= options_.layer_table_counts[k]) {
+        return;
+      }
+      compact_layer(k, *version);
     }
   }
 
   /**
-   * @brief Update the entries with the SSTable.
-   * @details Adds all SSTable entries to the map based on their time windows,
-   * and adds the SSTable files to the vector of files to remove.
+   * @brief Run a flush and compaction on the background worker.
+   * @details Errors are stored and rethrown on the next flush or wait.
    * 
-   * @param sstable SSTable.
-   * @param window_size Window size.
-   * @param time_window_to_entries Time window to entries map.
-   * @param files_to_remove Files to remove vector.
-   */
-  void update_entries_with_sstable(
-    SSTable<TValue>&& sstable,
-    size_type window_size,
-    TimeWindowToEntriesMap& time_window_to_entries,
-    std::vector<FilePath>& files_to_remove
-  ) const noexcept {
-    for (const auto& [key, value] : sstable.entries()) {
-      const auto start{(key.timestamp() / window_size) * window_size};
-      const auto time_window{TimeWindow{start, start + window_size}};
-      time_window_to_entries[time_window][key] = value;
+   */
+  void run_background_compaction() noexcept {
+    try {
+      flush_immutable_mem_tables();
+      compact();
+    } catch (...) {
+      std::lock_guard lock{*snapshot_mutex_};
+      compaction_error_ = std::current_exception();
     }
-    files_to_remove.push_back(sstable.path());
-    files_to_remove.push_back(sstable.metadataPath());
+    snapshot_changed_->notify_all();
   }
 
   /**
-   * @brief Merge all SSTables in a layer with the next layer's SSTables.
+   * @brief Compact a layer into the next layer.
+   * @details C0 is merged into C1 all at once, while for other layers only
+   * the oldest, excess SSTables are merged. Only the SSTables of the next
+   * layer whose time windows overlap with the inputs are merged with them,
+   * and the rest of the next layer is left in place. The windows of an input
+   * are those its entries fall in, rather than every window its time range
+   * spans, so late entries flushed alongside recent ones only pull in the
+   * SSTables of their own windows. The inputs are k-way merged in key
+   * order, so each time window is handed off to be written as soon as the
+   * merge moves past it. With a compaction pool, windows are written in
+   * parallel, with at most twice as many in memory as the pool has
+   * threads. The merged SSTables are written from a snapshot, and only
+   * committed to the manifest and published in place of their inputs once
+   * all of them have been written. The files of the inputs are removed once
+   * no snapshot holds them. SSTables flushed to C0 in the meantime are kept.
+   * 
+   * Range tombstones drop the keys they cover from older inputs as they are
+   * merged. Those of C0 become leveled range tombstones of C1, and those of
+   * layer k are carried down to the next layer, together with the SSTables
+   * of the next layer that they overlap. A leveled range tombstone is
+   * dropped once no deeper SSTable overlaps with it.
    * 
    * @param k Layer index.
+   * @param version Snapshot of the layers.
+   * 
+   * @throw std::exception If merging the SSTables fails.
    */
-  void merge_all_in_layer(size_type k) {
-    auto& curr_layer{ck_layers_[k]};
-    auto& next_layer{ck_layers_[k + 1]};
-    const auto window_size{CK_LAYER_WINDOW_SIZE[k + 1]};
-
-    TimeWindowToEntriesMap time_window_to_entries;
-    std::vector<FilePath> files_to_remove;
-
-    for (auto&& sstable : next_layer) {
-      update_entries_with_sstable(
-        std::move(sstable), window_size,
-        time_window_to_entries,
-        files_to_remove
-      );
+  void compact_layer(size_type k, const Snapshot& version) {
+    LatencyTimer timer{metrics_->compaction_latency};
+    const auto& curr_layer{version.ck_layers[k]};
+    const auto& next_layer{version.ck_layers[k + 1]};
+    const auto window_size{options_.layer_window_sizes[k + 1]};
+    const auto input_count{
+      k == 0
+        ? curr_layer.size()
+        : curr_layer.size() - options_.layer_table_counts[k]
+    };
+
+    std::vector<bool> overlapping(next_layer.size(), false);
+    const auto mark_overlapping{[&](Timestamp lower, Timestamp upper) {
+      const auto first_window{window_start(lower, window_size)};
+      const auto last_window{window_start(upper, window_size)};
+      const auto window_end{
+        last_window + std::min<Timestamp>(
+          window_size - 1, std::numeric_limits<Timestamp>::max() - last_window
+        )
+      };
+      for (const auto position : version.layer_indices[k + 1].overlapping(
+        first_window, window_end
+      )) {
+        overlapping[position] = true;
+      }
+    }};
+    for (size_type i{0}; i < input_count; ++i) {
+      const auto& sstable{curr_layer[i]};
+      const auto time_range{sstable->timeRange()};
+      if (time_range.isSet()) {
+        if (
+          window_start(time_range.lower(), window_size) ==
+          window_start(time_range.upper(), window_size)
+        ) {
+          mark_overlapping(time_range.lower(), time_range.upper());
+        } else {
+          for (const auto window : sstable->timeWindows(window_size)) {
+            mark_overlapping(window, window);
+          }
+        }
+      }
+      for (const auto& range_tombstone : sstable->rangeTombstones()) {
+        mark_overlapping(range_tombstone.start(), range_tombstone.end());
+      }
+    }
+    std::vector<RangeTombstone> carried_range_tombstones;
+    for (const auto& [range_tombstone, level] : version.range_tombstones) {
+      if (level == k) {
+        mark_overlapping(range_tombstone.start(), range_tombstone.end());
+        carried_range_tombstones.push_back(range_tombstone);
+      }
     }
-    reset_layer(k + 1);
 
-    for (auto&& sstable : curr_layer) {
-      update_entries_with_sstable(
-        std::move(sstable), window_size,
-        time_window_to_entries,
-        files_to_remove
+    MergeIterator<TValue> merge{TRUE_TIME_SERIES_KEY_FILTER};
+    for (size_type j{0}; j < next_layer.size(); ++j) {
+      if (overlapping[j]) {
+        merge.addSSTable(
+          next_layer[j], MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, false
+        );
+      }
+    }
+    for (const auto& range_tombstone : carried_range_tombstones) {
+      merge.addRangeTombstone(range_tombstone);
+    }
+    for (size_type i{0}; i < input_count; ++i) {
+      merge.addSSTable(
+        curr_layer[i], MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, false
       );
     }
-    reset_layer(k);
 
-    for (const auto& file : files_to_remove) {
-      if (!std::filesystem::remove(file)) {
-        throw std::runtime_error{
-          "LSMTree::merge_all_in_layer(): Failed to remove file: '"
-          + std::string{file} + "' after compaction."
+    CkLayer merged_layer;
+    std::deque<std::future<SSTablePtr>> writes;
+    const auto& pool{options_.compaction_pool};
+    const auto write_window{[&](table_type&& entries) {
+      if (!pool) {
+        merged_layer.push_back(
+          merge_entries(std::move(entries), get_next_file_path(k + 1))
+        );
+        return;
+      }
+      if (writes.size() >= 2 * pool->threadCount()) {
+        merged_layer.push_back(writes.front().get());
+        writes.pop_front();
+      }
+      writes.push_back(pool->submit(
+        [this, entries = std::move(entries), path = get_next_file_path(k + 1)]
+        () mutable {
+          return merge_entries(std::move(entries), std::move(path));
+        }
+      ));
+    }};
+
+    try {
+      table_type window_entries;
+      Timestamp window{0};
+      while (auto entry{merge.nextWithTombstones()}) {
+        const auto entry_window{
+          window_start(entry->first.timestamp(), window_size)
         };
+        if (!window_entries.empty() && entry_window != window) {
+          write_window(std::move(window_entries));
+          window_entries.clear();
+        }
+        window = entry_window;
+        window_entries.emplace_hint(
+          window_entries.end(), entry->first, std::move(entry->second)
+        );
+      }
+      if (!window_entries.empty()) {
+        write_window(std::move(window_entries));
+      }
+      for (; !writes.empty(); writes.pop_front()) {
+        merged_layer.push_back(writes.front().get());
+      }
+    } catch (...) {
+      for (const auto& write : writes) {
+        if (write.valid()) {
+          write.wait();
+        }
+      }
+      throw;
+    }
+    metrics_->compactions[k].add();
+    for (const auto& sstable : merged_layer) {
+      metrics_->bytes_written[k + 1].add(sstable_bytes(*sstable));
+    }
+
+    for (size_type j{0}; j < next_layer.size(); ++j) {
+      if (!overlapping[j]) {
+        merged_layer.push_back(next_layer[j]);
       }
     }
+    std::ranges::stable_sort(merged_layer, {}, [](const auto& sstable) {
+      const auto time_range{sstable->timeRange()};
+      return time_range.isSet() ? time_range.lower() : Timestamp{0};
+    });
+
+    const auto swap_in_layer{[&](auto& new_version) {
+      auto& new_layers{new_version.ck_layers};
+      new_layers[k].erase(
+        new_layers[k].begin(),
+        new_layers[k].begin() + input_count
+      );
+      new_layers[k + 1] = merged_layer;
 
-    for (auto& [time_window, entries] : time_window_to_entries) {
-      auto sstable{merge_entries(std::move(entries), k)};
-      next_layer.push_back(std::move(sstable));
+      auto& range_tombstones{new_version.range_tombstones};
+      for (auto& leveled : range_tombstones) {
+        if (leveled.level == k) {
+          leveled.level = k + 1;
+        }
+      }
+      if (k == 0) {
+        for (size_type i{0}; i < input_count; ++i) {
+          for (const auto& range_tombstone : curr_layer[i]->rangeTombstones()) {
+            range_tombstones.push_back({range_tombstone, 1});
+          }
+        }
+      }
+      std::erase_if(range_tombstones, [&new_layers](const auto& leveled) {
+        return std::ranges::none_of(
+          new_layers | std::views::drop(leveled.level + 1),
+          [&leveled](const auto& ck_layer) {
+            return std::ranges::any_of(ck_layer, [&](const auto& sstable) {
+              return leveled.range_tombstone.overlaps(
+                sstable->coveredTimeRange()
+              );
+            });
+          }
+        );
+      });
+    }};
+    const auto lock{commit_layers(swap_in_layer)};
+    update_snapshot(swap_in_layer);
+    for (size_type i{0}; i < input_count; ++i) {
+      curr_layer[i]->markObsolete();
+    }
+    for (size_type j{0}; j < next_layer.size(); ++j) {
+      if (overlapping[j]) {
+        next_layer[j]->markObsolete();
+      }
     }
   }
 
   /**
-   * @brief Merge the oldest SSTables in a layer with the next layer's.
-   * @details Take the oldest SSTables in the layer, and merge it with the
-   * next layer's SSTables by time window.
+   * @brief Get the start of the time window holding a timestamp.
    * 
-   * @param k Layer index.
+   * @param timestamp Timestamp.
+   * @param window_size Window size.
+   * @return Timestamp Start of the time window.
+   */
+  [[nodiscard]] static Timestamp window_start(
+    Timestamp timestamp,
+    size_type window_size
+  ) noexcept {
+    return (timestamp / window_size) * window_size;
+  }
+
+  /**
+   * @brief Merge entries into an SSTable.
+   * @details The SSTable keeps a rollup of its window if rollups are
+   * enabled, and its blocks are compressed with the codec of the LSM tree.
+   * May run on the compaction pool.
+   * 
+   * @param entries Entries to merge.
+   * @param path Path of the SSTable.
+   * @return SSTablePtr Merged SSTable.
    */
-  void merge_oldest_in_layer(size_type k) {
-    auto& curr_layer{ck_layers_[k]};
-    auto& next_layer{ck_layers_[k + 1]};
-    const auto window_size{CK_LAYER_WINDOW_SIZE[k + 1]};
+  [[nodiscard]] SSTablePtr merge_entries(
+    table_type&& entries,
+    FilePath path
+  ) const {
+    auto memtable{MemTable<TValue>{std::move(entries)}};
+    const auto memtable_size{memtable.size()};
+    return std::make_shared<const SSTable<TValue>>(
+      std::move(path),
+      memtable,
+      memtable_size,
+      sstable_options(options_.rollups, IOPriority::COMPACTION)
+    );
+  }
 
-    TimeWindowToEntriesMap time_window_to_entries;
-    std::vector<FilePath> files_to_remove;
+  /**
+   * @brief Get the options for writing an SSTable.
+   * 
+   * @param keep_rollup Whether the SSTable keeps a rollup.
+   * @param io_priority Priority class of the SSTable's writes.
+   * @return SSTableOptions Options.
+   */
+  [[nodiscard]] SSTableOptions sstable_options(
+    bool keep_rollup,
+    IOPriority io_priority
+  ) const {
+    return {
+      .keep_rollup = keep_rollup,
+      .compression = options_.compression,
+      .block_cache = options_.block_cache,
+      .bloom_filter_false_positive_rate =
+        options_.bloom_filter_false_positive_rate,
+      .sync = options_.sync_sstables,
+      .io_backend = options_.io_backend,
+      .io_scheduler = options_.io_scheduler,
+      .io_priority = io_priority
+    };
+  }
 
-    for (auto&& sstable : next_layer) {
-      update_entries_with_sstable(
-        std::move(sstable), window_size,
-        time_window_to_entries,
-        files_to_remove
-      );
+  /**
+   * @brief Get the options for the write-ahead log.
+   * 
+   * @param options Options of the LSM tree.
+   * @return WALOptions Options of its WAL, given the LSM tree's I/O
+   * scheduler unless they have one.
+   */
+  [[nodiscard]] static WALOptions wal_options(const LSMTreeOptions& options) {
+    auto wal_options{options.wal};
+    if (!wal_options.io_scheduler) {
+      wal_options.io_scheduler = options.io_scheduler;
     }
-    reset_layer(k + 1);
+    return wal_options;
+  }
 
-    while (curr_layer.size() > CK_LAYER_TABLE_COUNT[k]) {
-      auto& oldest_sstable{curr_layer.front()};
-      update_entries_with_sstable(
-        std::move(oldest_sstable), window_size,
-        time_window_to_entries,
-        files_to_remove
-      );
-      curr_layer.pop_front();
+  /**
+   * @brief Validate the options of an LSM tree.
+   * 
+   * @param options Options.
+   * @return LSMTreeOptions The options.
+   * 
+   * @throw std::invalid_argument If any option is out of range, or if a
+   * codec is not available.
+   */
+  [[nodiscard]] static LSMTreeOptions validate_options(LSMTreeOptions options) {
+    if (options.mem_table_max_entries == 0) {
+      throw std::invalid_argument{
+        "LSMTree(): Maximum number of memtable entries must be at least 1."
+      };
     }
-
-    for (const auto& file : files_to_remove) {
-      if (!std::filesystem::remove(file)) {
-        throw std::runtime_error{
-          "LSMTree::merge_oldest_in_layer(): Failed to remove file: '"
-          + std::string{file} + "' after compaction."
+    if (options.cache_capacity == 0) {
+      throw std::invalid_argument{
+        "LSMTree(): Cache capacity must be at least 1."
+      };
+    }
+    for (size_type k{1}; k < LAYER_COUNT; ++k) {
+      const auto window_size{options.layer_window_sizes[k]};
+      if (window_size == 0 || window_size < options.layer_window_sizes[k - 1]) {
+        throw std::invalid_argument{
+          "LSMTree(): Time window size of C" + std::to_string(k)
+          + " must be at least 1 and at least that of the layer above."
         };
       }
     }
-
-    for (auto& [time_window, entries] : time_window_to_entries) {
-      auto sstable{merge_entries(std::move(entries), k)};
-      next_layer.push_back(std::move(sstable));
+    if (
+      !(options.bloom_filter_false_positive_rate > 0.0) ||
+      !(options.bloom_filter_false_positive_rate < 1.0)
+    ) {
+      throw std::invalid_argument{
+        "LSMTree(): Bloom filter false positive rate must be between 0 and 1."
+      };
+    }
+    if (options.c0_stall_threshold <= options.layer_table_counts[0]) {
+      throw std::invalid_argument{
+        "LSMTree(): C0 stall threshold must be greater than "
+        + std::to_string(options.layer_table_counts[0]) + "."
+      };
+    }
+    if (options.max_immutable_mem_tables == 0) {
+      throw std::invalid_argument{
+        "LSMTree(): Maximum number of immutable memtables must be at least 1."
+      };
+    }
+    if (!compressionAvailable(options.compression)) {
+      throw std::invalid_argument{
+        "LSMTree(): SSTable codec is not available."
+      };
     }
+    return options;
   }
 
   /**
-   * @brief Merge entries into an SSTable.
+   * @brief Background compaction worker.
+   * @details Declared first, so that moving the LSM tree stops the worker
+   * before any of the state it uses is moved.
    * 
-   * @param entries Entries to merge.
-   * @param k Layer index.
-   * @return SSTable Merged SSTable.
    */
-  SSTable<TValue> merge_entries(table_type&& entries, size_type k) {
-    auto memtable{MemTable<TValue>{std::move(entries)}};
-    const auto memtable_size{memtable.size()};
-    auto sstable{SSTable<TValue>{
-      get_next_file_path(k + 1),
-      std::move(memtable),
-      memtable_size
-    }};
-    return sstable;
-  }
+  BackgroundWorker compaction_worker_;
+
+  /**
+   * @brief Options.
+   * 
+   */
+  LSMTreeOptions options_;
+
+  /**
+   * @brief Mutex serializing writers.
+   * 
+   */
+  std::unique_ptr<std::mutex> write_mutex_;
+
+  /**
+   * @brief Mutex guarding the active memtable.
+   * @details Also held while a memtable is frozen, so that readers see the
+   * active memtable and snapshot consistently.
+   * 
+   */
+  std::unique_ptr<std::shared_mutex> mem_table_mutex_;
 
   /**
-   * @brief Memtable.
+   * @brief Active memtable.
    * 
    */
   MemTable<TValue> mem_table_;
 
   /**
-   * @brief SSTable layers.
+   * @brief Newest timestamp written to the LSM tree.
+   * @details Only ever increases, so that the retention cutoff does too.
+   * 
+   */
+  std::unique_ptr<std::atomic<Timestamp>> newest_timestamp_;
+
+  /**
+   * @brief Current snapshot of the frozen memtables and SSTable layers.
+   * 
+   */
+  std::shared_ptr<const Snapshot> snapshot_;
+
+  /**
+   * @brief Mutex guarding the snapshot and compaction error.
+   * 
+   */
+  std::unique_ptr<std::mutex> snapshot_mutex_;
+
+  /**
+   * @brief Notified whenever the snapshot changes.
+   * 
+   */
+  std::unique_ptr<std::condition_variable> snapshot_changed_;
+
+  /**
+   * @brief Error of a failed background compaction.
    * 
    */
-  CkLayers ck_layers_;
+  std::exception_ptr compaction_error_;
 
   /**
    * @brief Write-ahead log.
@@ -831,6 +2908,20 @@ private:
    */
   WriteAheadLog<TValue> wal_;
 
+  /**
+   * @brief Manifest of the SSTables in each layer.
+   * 
+   */
+  Manifest manifest_;
+
+  /**
+   * @brief Mutex serializing changes to the layers and the manifest.
+   * @details Also guards the next SSTable IDs. Taken before the memtable and
+   * snapshot mutexes.
+   * 
+   */
+  std::unique_ptr<std::mutex> manifest_mutex_;
+
   /**
    * @brief Path.
    * 
@@ -839,6 +2930,8 @@ private:
 
   /**
    * @brief Next SSTable ID for each layer.
+   * @details IDs are never reused while the LSM tree is alive, since files of
+   * obsolete SSTables may still be held by a snapshot.
    * 
    */
   std::array<size_type, LAYER_COUNT> sstable_id_;
@@ -850,10 +2943,40 @@ private:
   mutable Cache cache_;
 
   /**
-   * @brief Dirty table.
+   * @brief Index of the series with each tag.
+   * 
+   */
+  TagIndex tag_index_;
+
+  /**
+   * @brief Index of the newest value of each series.
+   * 
+   */
+  mutable LatestIndex<TValue> latest_index_;
+
+  /**
+   * @brief Metrics.
+   * @details Behind a pointer, since counters cannot be moved.
+   * 
+   */
+  std::unique_ptr<StorageMetrics> metrics_{
+    std::make_unique<StorageMetrics>(LAYER_COUNT)
+  };
+
+  /**
+   * @brief Epoch of the memory manager at the last read or write.
+   * @details Behind a pointer, since atomics cannot be moved.
+   * 
+   */
+  std::unique_ptr<std::atomic<size_type>> last_access_{
+    std::make_unique<std::atomic<size_type>>(0)
+  };
+
+  /**
+   * @brief Whether the WAL is being replayed.
    * 
    */
-  mutable DirtyTable dirty_table_;
+  bool replaying_{false};
 };
 }  // namespace vkdb
 
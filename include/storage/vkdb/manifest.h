@@ -0,0 +1,288 @@
+#ifndef STORAGE_MANIFEST_H
+#define STORAGE_MANIFEST_H
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Versioned edit log of the SSTables in each layer of an LSM tree.
+ * @details Each commit appends one edit, which holds the next SSTable ID
+ * of each layer and the full membership of each layer that changed since
+ * the previous version, along with the range tombstones held by the layers
+ * if they changed, and is checksummed and synced before the commit
+ * returns. Replaying the edits in order gives the latest version. An edit
+ * torn by a crash fails its checksum, and is dropped along with anything
+ * after it. Once the log holds enough edits, it is rewritten as a single
+ * edit into a temporary file, which is then renamed over the log.
+ * 
+ */
+class Manifest {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Type alias for the SSTable file names of a layer, in layer order.
+   * 
+   */
+  using Layer = std::vector<std::string>;
+
+  /**
+   * @brief Type alias for the layers.
+   * 
+   */
+  using Layers = std::vector<Layer>;
+
+  /**
+   * @brief Type alias for range tombstones, each as the deepest layer it
+   * has been compacted into and its string form, which has no whitespace.
+   * 
+   */
+  using RangeTombstones = std::vector<std::pair<size_type, std::string>>;
+
+  /**
+   * @brief Name of the manifest file.
+   * 
+   */
+  static constexpr std::string_view FILENAME{"MANIFEST"};
+
+  /**
+   * @brief Magic word at the start of the manifest file.
+   * 
+   */
+  static constexpr std::string_view MAGIC{"VKDBMANIFEST"};
+
+  /**
+   * @brief Version of the manifest format.
+   * 
+   */
+  static constexpr size_type FORMAT_VERSION{1};
+
+  /**
+   * @brief Number of edits after which the manifest is rewritten.
+   * 
+   */
+  static constexpr size_type MAX_EDITS{1'000};
+
+  /**
+   * @brief Token that starts the range tombstones of an edit.
+   * 
+   */
+  static constexpr std::string_view RANGE_TOMBSTONES_TOKEN{"T"};
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  Manifest() = delete;
+
+  /**
+   * @brief Construct a new Manifest object in a directory.
+   * @details Nothing is read or written until load() or commit() is called.
+   * 
+   * @param directory Directory of the LSM tree.
+   * @param layer_count Number of layers.
+   */
+  Manifest(std::filesystem::path directory, size_type layer_count);
+
+  /**
+   * @brief Move-construct a Manifest object.
+   * 
+   */
+  Manifest(Manifest&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a Manifest object.
+   * 
+   */
+  Manifest& operator=(Manifest&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  Manifest(const Manifest&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  Manifest& operator=(const Manifest&) = delete;
+
+  /**
+   * @brief Destroy the Manifest object.
+   * 
+   */
+  ~Manifest() noexcept = default;
+
+  /**
+   * @brief Load the latest version from the manifest file.
+   * @details If the log ends in a torn edit, it is rewritten without it.
+   * 
+   * @return true if the manifest file exists.
+   * @return false if it does not, in which case the layers are empty.
+   * 
+   * @throw std::runtime_error If the file cannot be read or rewritten, or if
+   * it is not a manifest of this format.
+   */
+  [[nodiscard]] bool load();
+
+  /**
+   * @brief Commit a new version.
+   * @details Returns once the edit is durable. The layers that did not
+   * change are not written.
+   * 
+   * @param layers SSTable file names of each layer.
+   * @param next_ids Next SSTable ID of each layer.
+   * @param range_tombstones Range tombstones held by the layers.
+   * 
+   * @throw std::invalid_argument If the number of layers or IDs is wrong.
+   * @throw std::runtime_error If the edit cannot be written or synced.
+   */
+  void commit(
+    const Layers& layers,
+    std::span<const size_type> next_ids,
+    const RangeTombstones& range_tombstones = {}
+  );
+
+  /**
+   * @brief Remove the manifest file and reset to an empty version.
+   * 
+   */
+  void clear() noexcept;
+
+  /**
+   * @brief Get the SSTable file names of each layer.
+   * 
+   * @return const Layers& Layers.
+   */
+  [[nodiscard]] const Layers& layers() const noexcept;
+
+  /**
+   * @brief Get the next SSTable ID of each layer.
+   * 
+   * @return const std::vector<size_type>& Next IDs.
+   */
+  [[nodiscard]] const std::vector<size_type>& nextIds() const noexcept;
+
+  /**
+   * @brief Get the latest version.
+   * @details Version 0 is the empty version before any commit.
+   * 
+   * @return size_type Version.
+   */
+  [[nodiscard]] size_type version() const noexcept;
+
+  /**
+   * @brief Get the path of the manifest file.
+   * 
+   * @return std::filesystem::path Path.
+   */
+  [[nodiscard]] std::filesystem::path path() const noexcept;
+
+  /**
+   * @brief Get the range tombstones held by the layers.
+   * 
+   * @return const RangeTombstones& Range tombstones.
+   */
+  [[nodiscard]] const RangeTombstones& rangeTombstones() const noexcept;
+
+private:
+  /**
+   * @brief Encode an edit.
+   * 
+   * @param version Version.
+   * @param layers Layers.
+   * @param next_ids Next IDs.
+   * @param changed Whether each layer is written.
+   * @param range_tombstones Range tombstones, or null if they are not
+   * written.
+   * @return std::string Edit line, with its checksum and newline.
+   */
+  [[nodiscard]] static std::string encode_edit(
+    size_type version,
+    const Layers& layers,
+    std::span<const size_type> next_ids,
+    const std::vector<bool>& changed,
+    const RangeTombstones* range_tombstones
+  );
+
+  /**
+   * @brief Decode and apply an edit.
+   * 
+   * @param line Edit line, without its newline.
+   * @return true if the edit is intact and was applied.
+   * @return false if it is torn or malformed, in which case nothing changes.
+   */
+  [[nodiscard]] bool apply_edit(std::string_view line);
+
+  /**
+   * @brief Append an edit to the manifest file and sync it.
+   * 
+   * @param edit Edit line.
+   * 
+   * @throw std::runtime_error If the file cannot be written or synced.
+   */
+  void append(const std::string& edit) const;
+
+  /**
+   * @brief Rewrite the manifest file as a single edit of a version.
+   * 
+   * @param version Version.
+   * @param layers Layers.
+   * @param next_ids Next IDs.
+   * @param range_tombstones Range tombstones.
+   * 
+   * @throw std::runtime_error If the file cannot be written or synced.
+   */
+  void rewrite(
+    size_type version,
+    const Layers& layers,
+    std::span<const size_type> next_ids,
+    const RangeTombstones& range_tombstones
+  ) const;
+
+  /**
+   * @brief Path of the directory.
+   * 
+   */
+  std::filesystem::path directory_;
+
+  /**
+   * @brief Latest version.
+   * 
+   */
+  size_type version_{0};
+
+  /**
+   * @brief SSTable file names of each layer.
+   * 
+   */
+  Layers layers_;
+
+  /**
+   * @brief Next SSTable ID of each layer.
+   * 
+   */
+  std::vector<size_type> next_ids_;
+
+  /**
+   * @brief Range tombstones held by the layers.
+   * 
+   */
+  RangeTombstones range_tombstones_;
+
+  /**
+   * @brief Number of edits in the manifest file.
+   * 
+   */
+  size_type edit_count_{0};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_MANIFEST_H
@@ -0,0 +1,107 @@
+#ifndef STORAGE_MAPPED_FILE_H
+#define STORAGE_MAPPED_FILE_H
+
+#include <filesystem>
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Read-only memory mapping of a file.
+ * @details The mapping is created on construction and released on
+ * destruction, so the bytes are only valid while the object is alive.
+ *
+ */
+class MappedFile {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   *
+   */
+  MappedFile() = delete;
+
+  /**
+   * @brief Construct a new MappedFile object by mapping the given file.
+   *
+   * @param path Path of the file.
+   *
+   * @throw std::runtime_error If the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::filesystem::path& path);
+
+  /**
+   * @brief Move-construct a MappedFile object.
+   *
+   */
+  MappedFile(MappedFile&& other) noexcept;
+
+  /**
+   * @brief Move-assign a MappedFile object.
+   *
+   */
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  MappedFile(const MappedFile&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Destroy the MappedFile object.
+   * @details Unmaps the file.
+   *
+   */
+  ~MappedFile() noexcept;
+
+  /**
+   * @brief Get a pointer to the start of the mapped bytes.
+   *
+   * @return const char* Start of the mapped bytes.
+   */
+  [[nodiscard]] const char* data() const noexcept;
+
+  /**
+   * @brief Get the number of mapped bytes.
+   *
+   * @return size_type Number of mapped bytes.
+   */
+  [[nodiscard]] size_type size() const noexcept;
+
+  /**
+   * @brief Get a view over the mapped bytes.
+   *
+   * @return std::string_view View over the mapped bytes.
+   */
+  [[nodiscard]] std::string_view view() const noexcept;
+
+private:
+  /**
+   * @brief Unmap the file if it is mapped.
+   *
+   */
+  void unmap() noexcept;
+
+  /**
+   * @brief Start of the mapped bytes.
+   *
+   */
+  char* data_;
+
+  /**
+   * @brief Number of mapped bytes.
+   *
+   */
+  size_type size_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_MAPPED_FILE_H
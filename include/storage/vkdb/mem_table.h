@@ -5,8 +5,26 @@
 #include <vkdb/string.h>
 #include <vkdb/time_series_key.h>
 #include <vkdb/data_range.h>
+#include <vkdb/range_tombstone.h>
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <vector>
 
 namespace vkdb {
+/**
+ * @brief Layout of a memtable.
+ * @details TREE keeps entries in a balanced tree, allocating a node per
+ * entry. SORTED_RUN keeps them in a single sorted array reserved up front,
+ * so in-order writes are plain appends. Out-of-order writes go to a small
+ * sorted side buffer, which is merged into the array once it fills up, or
+ * when the memtable is frozen.
+ * 
+ */
+enum class MemTableFormat {
+  TREE,
+  SORTED_RUN
+};
 
 /**
  * @brief In-memory table for storing key-value pairs.
@@ -21,14 +39,46 @@ public:
   using value_type = std::pair<const key_type, mapped_type>;
   using size_type = uint64_t;
   using table_type = std::map<const key_type, mapped_type>;
+  using run_type = std::vector<std::pair<key_type, mapped_type>>;
 
+  /**
+   * @brief Default max number of entries before a flush.
+   * @details The LSM tree's limit is set by LSMTreeOptions.
+   * 
+   */
   static constexpr size_type C0_LAYER_SSTABLE_MAX_ENTRIES{1'000};
 
+  /**
+   * @brief Max number of out-of-order entries kept aside before they are
+   * merged into the sorted run.
+   * 
+   */
+  static constexpr size_type SIDE_BUFFER_MAX_ENTRIES{256};
+
   /**
    * @brief Construct a new MemTable object.
    */
   MemTable() noexcept = default;
 
+  /**
+   * @brief Construct a new MemTable object with the given layout.
+   * @details A sorted run reserves room for a full memtable.
+   * 
+   * @param format The layout of the table.
+   * @param max_entries Max number of entries before the memtable is flushed.
+   * 
+   * @throw std::bad_alloc If reserving the sorted run fails.
+   */
+  explicit MemTable(
+    MemTableFormat format,
+    size_type max_entries = C0_LAYER_SSTABLE_MAX_ENTRIES
+  )
+    : format_{format} {
+      if (format_ == MemTableFormat::SORTED_RUN) {
+        run_.reserve(max_entries);
+      }
+    }
+
   /**
    * @brief Construct a new MemTable object from a map of entries.
    * 
@@ -73,10 +123,93 @@ public:
    * @throw std::exception If inserting or updating the key-value pair fails.
    */
   void put(const key_type& key, const mapped_type& value) {
-    table_.insert_or_assign(key, value);
+    if (format_ == MemTableFormat::TREE) {
+      table_.insert_or_assign(key, value);
+    } else if (run_.empty() || run_.back().first < key) {
+      run_.emplace_back(key, value);
+    } else if (
+      const auto it{find_in_run(run_, key)};
+      it != run_.end() && it->first == key
+    ) {
+      it->second = value;
+    } else {
+      put_aside(key, value);
+    }
     update_ranges(key);
   }
 
+  /**
+   * @brief Merges the side buffer into the sorted run.
+   * @details Called when the memtable is frozen, so that reads of the frozen
+   * memtable only search the sorted run.
+   * 
+   * @throw std::bad_alloc If growing the sorted run fails.
+   */
+  void mergeSideBuffer() {
+    if (side_.empty()) {
+      return;
+    }
+    const auto middle{static_cast<std::ptrdiff_t>(run_.size())};
+    run_.insert(
+      run_.end(),
+      std::make_move_iterator(side_.begin()),
+      std::make_move_iterator(side_.end())
+    );
+    std::ranges::inplace_merge(
+      run_, run_.begin() + middle, {}, &run_type::value_type::first
+    );
+    side_.clear();
+  }
+
+  /**
+   * @brief Deletes a range of keys.
+   * @details The entries the tombstone covers are erased, and the tombstone
+   * is kept to delete the keys it covers in older tables. Entries put
+   * afterwards are not affected.
+   * 
+   * @param tombstone The range tombstone.
+   * 
+   * @throw std::exception If keeping the tombstone fails.
+   */
+  void removeRange(const RangeTombstone& tombstone) {
+    if (format_ == MemTableFormat::TREE) {
+      std::erase_if(table_, [&tombstone](const auto& entry) {
+        return tombstone.covers(entry.first);
+      });
+    } else {
+      const auto is_covered{[&tombstone](const auto& entry) {
+        return tombstone.covers(entry.first);
+      }};
+      std::erase_if(run_, is_covered);
+      std::erase_if(side_, is_covered);
+    }
+    range_tombstones_.push_back(tombstone);
+  }
+
+  /**
+   * @brief Checks if a range tombstone of the table covers a key.
+   * 
+   * @param key The key to check.
+   * @return true If the key is deleted in older tables.
+   * @return false Otherwise.
+   */
+  [[nodiscard]] bool isRangeDeleted(const key_type& key) const noexcept {
+    return std::ranges::any_of(
+      range_tombstones_,
+      [&key](const auto& tombstone) { return tombstone.covers(key); }
+    );
+  }
+
+  /**
+   * @brief Returns the range tombstones of the table, oldest first.
+   * 
+   * @return const std::vector<RangeTombstone>& The range tombstones.
+   */
+  [[nodiscard]] const std::vector<RangeTombstone>&
+  rangeTombstones() const noexcept {
+    return range_tombstones_;
+  }
+
   /**
    * @brief Checks if the table contains a key.
    * 
@@ -85,7 +218,13 @@ public:
    * @return false Otherwise.
    */
   [[nodiscard]] bool contains(const key_type& key) const noexcept {
-    return in_range(key) && table_.contains(key);
+    if (!in_range(key)) {
+      return false;
+    }
+    if (format_ == MemTableFormat::TREE) {
+      return table_.contains(key);
+    }
+    return find_in_runs(key) != nullptr;
   }
 
   /**
@@ -102,7 +241,10 @@ public:
         "MemTable::get(): Key '" + key.str() + "' not in the memtable."
       };
     }
-    return table_.at(key);
+    if (format_ == MemTableFormat::TREE) {
+      return table_.at(key);
+    }
+    return find_in_runs(key)->second;
   }
 
   /**
@@ -122,10 +264,20 @@ public:
       return {};
     }
     std::vector<value_type> entries;
-    for (auto it{table_.lower_bound(start)};
-         it != table_.end() && it->first < end; ++it) {
-      entries.push_back(*it);
+    if (format_ == MemTableFormat::TREE) {
+      for (auto it{table_.lower_bound(start)};
+           it != table_.end() && it->first < end; ++it) {
+        entries.push_back(*it);
+      }
+      return entries;
     }
+    merge_runs(
+      find_in_run(run_, start), find_in_run(run_, end),
+      find_in_run(side_, start), find_in_run(side_, end),
+      [&entries](const auto& key, const auto& value) {
+        entries.emplace_back(key, value);
+      }
+    );
     return entries;
   }
 
@@ -135,17 +287,38 @@ public:
    */
   void clear() noexcept {
     table_.clear();
+    run_.clear();
+    side_.clear();
+    range_tombstones_.clear();
     time_range_.clear();
     key_range_.clear();
   }
 
   /**
-   * @brief Returns the table.
+   * @brief Calls a function on each key-value pair, in key order.
+   * 
+   * @tparam Fn Function type.
+   * @param fn The function to call with each key and value.
+   */
+  template <typename Fn>
+    requires std::invocable<Fn&, const key_type&, const mapped_type&>
+  void forEach(Fn&& fn) const {
+    if (format_ == MemTableFormat::TREE) {
+      for (const auto& [key, value] : table_) {
+        fn(key, value);
+      }
+      return;
+    }
+    merge_runs(run_.begin(), run_.end(), side_.begin(), side_.end(), fn);
+  }
+
+  /**
+   * @brief Returns the layout of the table.
    * 
-   * @return table_type The table.
+   * @return MemTableFormat The layout.
    */
-  [[nodiscard]] table_type table() const noexcept {
-    return table_;
+  [[nodiscard]] MemTableFormat format() const noexcept {
+    return format_;
   }
 
   /**
@@ -154,17 +327,20 @@ public:
    * @return size_type The size of the table.
    */
   [[nodiscard]] size_type size() const noexcept {
-    return table_.size();
+    return format_ == MemTableFormat::TREE
+      ? table_.size()
+      : run_.size() + side_.size();
   }
 
   /**
    * @brief Checks if the table is empty.
+   * @details A table with range tombstones but no entries is empty.
    * 
    * @return true If the table is empty.
    * @return false Otherwise.
    */
   [[nodiscard]] bool empty() const noexcept {
-    return table_.empty();
+    return size() == 0;
   }
 
   /**
@@ -175,9 +351,9 @@ public:
   [[nodiscard]] std::string str() const noexcept {
     std::stringstream ss;
     ss << size();
-    for (const auto& entry : table()) {
-      ss << entryToString<TValue>(entry);
-    }
+    forEach([&ss](const auto& key, const auto& value) {
+      ss << entryToString<TValue>({key, value});
+    });
     return ss.str();
   }
 
@@ -205,6 +381,97 @@ public:
   }
 
 private:
+  /**
+   * @brief Finds the first entry of a sorted run not less than a key.
+   * 
+   * @tparam Run Run type, const or not.
+   * @param run The sorted run.
+   * @param key The key to search for.
+   * @return auto Iterator to the entry, or the end of the run.
+   */
+  template <typename Run>
+  [[nodiscard]] static auto find_in_run(
+    Run& run,
+    const key_type& key
+  ) noexcept {
+    return std::ranges::lower_bound(
+      run, key, {}, &run_type::value_type::first
+    );
+  }
+
+  /**
+   * @brief Finds the entry of a key in the sorted run or the side buffer.
+   * 
+   * @param key The key to search for.
+   * @return const run_type::value_type* The entry, or null if there is none.
+   */
+  [[nodiscard]] const run_type::value_type* find_in_runs(
+    const key_type& key
+  ) const noexcept {
+    for (const auto* run : {&run_, &side_}) {
+      const auto it{find_in_run(*run, key)};
+      if (it != run->end() && it->first == key) {
+        return &*it;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Puts an out-of-order entry in the side buffer.
+   * @details Merges the side buffer into the sorted run once it is full.
+   * 
+   * @param key The key, which is not in the sorted run.
+   * @param value The value.
+   * 
+   * @throw std::bad_alloc If growing the side buffer or sorted run fails.
+   */
+  void put_aside(const key_type& key, const mapped_type& value) {
+    const auto it{find_in_run(side_, key)};
+    if (it != side_.end() && it->first == key) {
+      it->second = value;
+      return;
+    }
+    side_.emplace(it, key, value);
+    if (side_.size() >= SIDE_BUFFER_MAX_ENTRIES) {
+      mergeSideBuffer();
+    }
+  }
+
+  /**
+   * @brief Calls a function on the entries of two disjoint sorted runs, in
+   * key order.
+   * 
+   * @tparam It Iterator type.
+   * @tparam Fn Function type.
+   * @param run_it Start of the first run.
+   * @param run_end End of the first run.
+   * @param side_it Start of the second run.
+   * @param side_end End of the second run.
+   * @param fn The function to call with each key and value.
+   */
+  template <typename It, typename Fn>
+  static void merge_runs(
+    It run_it,
+    It run_end,
+    It side_it,
+    It side_end,
+    Fn&& fn
+  ) {
+    while (run_it != run_end || side_it != side_end) {
+      if (
+        side_it == side_end ||
+        (run_it != run_end && run_it->first < side_it->first)
+      ) {
+        fn(run_it->first, run_it->second);
+        ++run_it;
+      } else {
+        fn(side_it->first, side_it->second);
+        ++side_it;
+      }
+    }
+  }
+
   /**
    * @brief Checks if a key is within the valid range.
    * 
@@ -253,10 +520,35 @@ private:
   KeyRange key_range_;
 
   /**
-   * @brief The table.
+   * @brief The layout.
+   * 
+   */
+  MemTableFormat format_{MemTableFormat::TREE};
+
+  /**
+   * @brief The table, if the layout is TREE.
    * 
    */
   table_type table_;
+
+  /**
+   * @brief The sorted run, if the layout is SORTED_RUN.
+   * 
+   */
+  run_type run_;
+
+  /**
+   * @brief The out-of-order entries not yet merged into the sorted run, in
+   * key order, if the layout is SORTED_RUN.
+   * 
+   */
+  run_type side_;
+
+  /**
+   * @brief The range tombstones, oldest first.
+   * 
+   */
+  std::vector<RangeTombstone> range_tombstones_;
 };
 
 /**
@@ -0,0 +1,299 @@
+#ifndef STORAGE_MEMORY_MANAGER_H
+#define STORAGE_MEMORY_MANAGER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Memory held by an LSM tree, or by several.
+ * @details Estimates, which count the entries and structures held rather
+ * than every allocation made for them.
+ *
+ */
+struct MemoryUsage {
+  using size_type = uint64_t;
+
+  /**
+   * @brief Bytes of the active and immutable memtables.
+   *
+   */
+  size_type mem_table_bytes{0};
+
+  /**
+   * @brief Bytes of the read cache.
+   *
+   */
+  size_type cache_bytes{0};
+
+  /**
+   * @brief Bytes of the sparse indexes of the SSTables.
+   *
+   */
+  size_type index_bytes{0};
+
+  /**
+   * @brief Bytes of the Bloom filters of the SSTables.
+   *
+   */
+  size_type filter_bytes{0};
+
+  /**
+   * @brief Bytes of the tag index, and of its series in the series
+   * dictionary.
+   */
+  size_type series_bytes{0};
+
+  /**
+   * @brief Get the total number of bytes.
+   *
+   * @return size_type Bytes.
+   */
+  [[nodiscard]] size_type total() const noexcept;
+
+  /**
+   * @brief Add the usage of another LSM tree.
+   *
+   * @param other Usage.
+   * @return MemoryUsage& Reference to this usage.
+   */
+  MemoryUsage& operator+=(const MemoryUsage& other) noexcept;
+};
+
+/**
+ * @brief Callbacks through which a memory manager accounts for, and frees,
+ * the memory of a consumer, such as a table.
+ *
+ */
+struct MemoryConsumer {
+  using size_type = MemoryUsage::size_type;
+
+  /**
+   * @brief Get the memory held.
+   *
+   */
+  std::function<MemoryUsage()> usage;
+
+  /**
+   * @brief Get the epoch of the memory manager at the last read or write.
+   *
+   */
+  std::function<size_type()> last_access;
+
+  /**
+   * @brief Flush the memtables early.
+   *
+   */
+  std::function<void()> flush;
+
+  /**
+   * @brief Release the read cache and Bloom filters, which are filled or
+   * loaded again on demand.
+   *
+   */
+  std::function<void()> release;
+};
+
+/**
+ * @brief Keeps the memory of a set of consumers within a global budget.
+ * @details Writers charge the bytes they add to their memtables, and every
+ * time a slice of the budget has been charged, the manager adds up what each
+ * consumer holds. Over budget, it flushes the largest memtables first, and
+ * then releases the caches and Bloom filters of the consumers accessed least
+ * recently, until the total is back within budget. Sparse indexes are
+ * counted, but stay in memory, since every read of an SSTable walks them,
+ * and so do the tag indexes and the series they hold.
+ *
+ * Recency is kept in epochs, which advance at each rebalance, so that
+ * consumers can note an access with a relaxed store rather than a clock
+ * read.
+ *
+ */
+class MemoryManager {
+public:
+  using size_type = MemoryUsage::size_type;
+  using consumer_id = uint64_t;
+
+  /**
+   * @brief Number of slices the budget is split into, one of which is
+   * charged between rebalances.
+   *
+   */
+  static constexpr size_type CHARGE_SLICES{64};
+
+  /**
+   * @brief Construct a new MemoryManager object.
+   *
+   * @param budget_bytes Budget in bytes.
+   *
+   * @throw std::invalid_argument If the budget is 0.
+   */
+  explicit MemoryManager(size_type budget_bytes);
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  MemoryManager(MemoryManager&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  MemoryManager& operator=(MemoryManager&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  MemoryManager(const MemoryManager&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  MemoryManager& operator=(const MemoryManager&) = delete;
+
+  /**
+   * @brief Destroy the MemoryManager object.
+   *
+   */
+  ~MemoryManager() noexcept = default;
+
+  /**
+   * @brief Start accounting for a consumer.
+   * @details The callbacks are called with the manager's lock held, so they
+   * must not call back into the manager.
+   *
+   * @param consumer Consumer.
+   * @return consumer_id ID, with which to stop accounting for it.
+   */
+  consumer_id track(MemoryConsumer consumer);
+
+  /**
+   * @brief Stop accounting for a consumer.
+   * @details Waits for any rebalance to finish, so the consumer may be
+   * destroyed as soon as this returns.
+   *
+   * @param id ID.
+   */
+  void untrack(consumer_id id) noexcept;
+
+  /**
+   * @brief Charge bytes added to a memtable.
+   * @details Rebalances once a slice of the budget has been charged, unless
+   * another thread is already rebalancing. Must not be called with any lock
+   * held that a consumer's callbacks take.
+   *
+   * @param bytes Bytes.
+   *
+   * @throw std::exception If flushing a memtable fails.
+   */
+  void charge(size_type bytes);
+
+  /**
+   * @brief Bring the consumers back within budget.
+   * @details Does nothing while they are within budget.
+   *
+   * @throw std::exception If flushing a memtable fails.
+   */
+  void rebalance();
+
+  /**
+   * @brief Get the memory held by the consumers.
+   *
+   * @return MemoryUsage Usage.
+   */
+  [[nodiscard]] MemoryUsage usage() const;
+
+  /**
+   * @brief Get the budget.
+   *
+   * @return size_type Budget in bytes.
+   */
+  [[nodiscard]] size_type budget() const noexcept;
+
+  /**
+   * @brief Get the current epoch.
+   *
+   * @return size_type Epoch.
+   */
+  [[nodiscard]] size_type epoch() const noexcept;
+
+  /**
+   * @brief Get the number of memtables flushed early.
+   *
+   * @return size_type Number of early flushes.
+   */
+  [[nodiscard]] size_type earlyFlushes() const noexcept;
+
+  /**
+   * @brief Get the number of times a consumer's cache and Bloom filters
+   * were released.
+   *
+   * @return size_type Number of releases.
+   */
+  [[nodiscard]] size_type releases() const noexcept;
+
+private:
+  /**
+   * @brief Bring the consumers back within budget.
+   * @details Must be called with the mutex held.
+   *
+   */
+  void rebalance_locked();
+
+  /**
+   * @brief Budget in bytes.
+   *
+   */
+  size_type budget_;
+
+  /**
+   * @brief Mutex guarding the consumers, held while rebalancing.
+   *
+   */
+  mutable std::mutex mutex_;
+
+  /**
+   * @brief Consumers, by ID.
+   *
+   */
+  std::map<consumer_id, MemoryConsumer> consumers_;
+
+  /**
+   * @brief ID of the next consumer.
+   *
+   */
+  consumer_id next_id_{0};
+
+  /**
+   * @brief Bytes charged since the last rebalance.
+   *
+   */
+  std::atomic<size_type> charged_{0};
+
+  /**
+   * @brief Current epoch.
+   *
+   */
+  std::atomic<size_type> epoch_{1};
+
+  /**
+   * @brief Number of early flushes.
+   *
+   */
+  std::atomic<size_type> early_flushes_{0};
+
+  /**
+   * @brief Number of releases.
+   *
+   */
+  std::atomic<size_type> releases_{0};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_MEMORY_MANAGER_H
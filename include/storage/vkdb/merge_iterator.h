@@ -0,0 +1,763 @@
+#ifndef STORAGE_MERGE_ITERATOR_H
+#define STORAGE_MERGE_ITERATOR_H
+
+#include <vkdb/sstable.h>
+#include <vkdb/key_predicate.h>
+#include <vkdb/key_filter.h>
+#include <vkdb/block_stats.h>
+#include <vkdb/value_batch.h>
+#include <vkdb/concepts.h>
+#include <functional>
+#include <algorithm>
+#include <concepts>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace vkdb {
+/**
+ * @brief Type alias for a predicate on a TimeSeriesKey.
+ * 
+ */
+using TimeSeriesKeyFilter = std::function<bool(const TimeSeriesKey&)>;
+
+/**
+ * @brief A predicate on a TimeSeriesKey that always returns true.
+ * 
+ */
+static const TimeSeriesKeyFilter TRUE_TIME_SERIES_KEY_FILTER =
+  [](const TimeSeriesKey&) { return true; };
+
+/**
+ * @brief Pull-based k-way merge over sorted runs of entries.
+ * @details Each source is a sorted run, given from oldest to newest. The
+ * sources are merged with a heap on their current keys, so only one entry
+ * per source is held at a time. Of the entries sharing a key, the one from
+ * the newest source wins; the key is skipped if that entry is a tombstone
+ * or fails the filter, or if a range tombstone of a newer source covers it.
+ * Given a structured predicate, the whole SSTables and blocks that it rules
+ * out are never read.
+ * 
+ * Sources can be split into partitions, in which range tombstones only delete
+ * keys of sources in their own partition, so that LSM trees holding disjoint
+ * sets of series can be merged as one, each in a partition of its own.
+ * 
+ * The filter is type-erased by default, as the interpreter needs. Given a
+ * KeyFilter type instead, the check of each key is inlined into the merge,
+ * and the filter's predicate is used to skip SSTables and blocks.
+ * 
+ * @tparam TValue Value type.
+ * @tparam TFilter Filter type, either TimeSeriesKeyFilter or a KeyFilter.
+ */
+template <
+  ArithmeticNoCVRefQuals TValue,
+  typename TFilter = TimeSeriesKeyFilter
+>
+requires std::same_as<TFilter, TimeSeriesKeyFilter> || KeyFilter<TFilter>
+class MergeIterator {
+public:
+  using key_type = TimeSeriesKey;
+  using mapped_type = std::optional<TValue>;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = uint64_t;
+
+  /**
+   * @brief Type alias for an in-memory sorted run.
+   * 
+   */
+  using Run = std::vector<value_type>;
+
+  /**
+   * @brief Type alias for a shared pointer to an SSTable.
+   * 
+   */
+  using SSTablePtr = std::shared_ptr<const SSTable<TValue>>;
+
+  /**
+   * @brief Block acceptor that accepts every block.
+   * 
+   */
+  struct AcceptAnyBlock {
+    [[nodiscard]] bool operator()(const TimeRange&) const noexcept {
+      return true;
+    }
+  };
+
+  /**
+   * @brief Construct a new MergeIterator object with the given filter.
+   * @details A KeyFilter also gives the predicate that SSTables and blocks
+   * are skipped by.
+   * 
+   * @param filter Filter.
+   * @param resource Resource of the merge's bookkeeping, such as a
+   * QueryArena's, which must outlive the merge.
+   */
+  explicit MergeIterator(
+    TFilter filter,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  )
+    : predicate_{typed_predicate(filter)}
+    , filter_{std::move(filter)}
+    , sources_{resource}
+    , ranks_{resource}
+    , range_tombstones_{resource}
+    , heap_{resource} {}
+
+  /**
+   * @brief Construct a new MergeIterator object with the given predicate.
+   * 
+   * @param predicate Predicate.
+   * @param resource Resource of the merge's bookkeeping, such as a
+   * QueryArena's, which must outlive the merge.
+   */
+  explicit MergeIterator(
+    KeyPredicate predicate,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+  ) requires std::same_as<TFilter, TimeSeriesKeyFilter>
+    : predicate_{std::make_shared<const KeyPredicate>(std::move(predicate))}
+    , sources_{resource}
+    , ranks_{resource}
+    , range_tombstones_{resource}
+    , heap_{resource} {}
+
+  /**
+   * @brief Add an in-memory sorted run, newer than the sources so far.
+   * 
+   * @param run Run.
+   * @param range_tombstones Range tombstones of the memtable the run is
+   * taken from, which delete keys in older sources.
+   */
+  void addRun(
+    Run&& run,
+    const std::vector<RangeTombstone>& range_tombstones = {}
+  ) {
+    const auto rank{next_rank_++};
+    add_range_tombstones(rank, range_tombstones);
+    if (run.empty()) {
+      return;
+    }
+    sources_.push_back({RunSource{std::move(run), 0}});
+    ranks_.push_back(rank);
+    push(sources_.size() - 1);
+  }
+
+  /**
+   * @brief Add a range tombstone, newer than the sources so far.
+   * @details It deletes the keys it covers in the sources so far, but not in
+   * the sources added after it.
+   * 
+   * @param range_tombstone Range tombstone.
+   */
+  void addRangeTombstone(const RangeTombstone& range_tombstone) {
+    range_tombstones_.push_back(
+      {partition_start_, next_rank_++, range_tombstone}
+    );
+  }
+
+  /**
+   * @brief Start a new partition, into which the sources and range
+   * tombstones added from now on go.
+   * @details Range tombstones of earlier partitions do not delete keys in
+   * the new one, and its range tombstones do not delete keys in theirs.
+   * 
+   */
+  void beginPartition() noexcept {
+    partition_start_ = next_rank_;
+  }
+
+  /**
+   * @brief Add the entries of an SSTable in a key range, newer than the
+   * sources so far.
+   * @details The iterator keeps the SSTable alive. The SSTable is skipped
+   * if its summary rules out the predicate, but its range tombstones still
+   * delete keys in older sources.
+   * 
+   * @param sstable SSTable.
+   * @param start Start key.
+   * @param end End key.
+   * @param use_block_cache Whether to read through the block cache.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  void addSSTable(
+    SSTablePtr sstable,
+    const key_type& start,
+    const key_type& end,
+    bool use_block_cache = true
+  ) {
+    const auto rank{next_rank_++};
+    add_range_tombstones(rank, sstable->rangeTombstones());
+    if (predicate_ && !sstable->mayMatch(*predicate_)) {
+      return;
+    }
+    auto cursor{sstable->cursor(start, end, predicate_, use_block_cache)};
+    if (!cursor.valid()) {
+      return;
+    }
+    sources_.push_back({SSTableSource{std::move(sstable), std::move(cursor)}});
+    ranks_.push_back(rank);
+    push(sources_.size() - 1);
+  }
+
+  /**
+   * @brief Get the predicate of the merge.
+   * 
+   * @return std::shared_ptr<const KeyPredicate> Predicate, or null if the
+   * merge was given a type-erased filter.
+   */
+  [[nodiscard]] std::shared_ptr<const KeyPredicate> predicate() const noexcept {
+    return predicate_;
+  }
+
+  /**
+   * @brief Get the resource of the merge's bookkeeping.
+   * 
+   * @return std::pmr::memory_resource* Resource.
+   */
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+    return heap_.get_allocator().resource();
+  }
+
+  /**
+   * @brief Get the next entry of the merge.
+   * 
+   * @return std::optional<value_type> The next live entry that passes the
+   * filter, in key order, or std::nullopt once the sources are exhausted.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  [[nodiscard]] std::optional<value_type> next() {
+    while (!heap_.empty()) {
+      if (auto entry{pop_key()}) {
+        return entry;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Get the next entry of the merge, tombstones included.
+   * @details Used by compaction, which has to carry tombstones down to shadow
+   * older values in the layers below.
+   * 
+   * @return std::optional<value_type> The newest entry at the next key that
+   * passes the filter, in key order, or std::nullopt once the sources are
+   * exhausted.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  [[nodiscard]] std::optional<value_type> nextWithTombstones() {
+    while (!heap_.empty()) {
+      if (auto entry{pop_key(true)}) {
+        return entry;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Drain the merge, taking whole SSTables and blocks from their
+   * statistics where possible.
+   * @details An SSTable with a rollup is taken from it, and a block of an
+   * SSTable from its statistics, instead of being decoded if it lies wholly
+   * in the range, no other source has a key that falls among its keys, and
+   * the predicate does not constrain timestamps, so it either matches every
+   * key of a series or none, and no range tombstone of a newer source
+   * overlaps with it. Only iterators built from a predicate take
+   * SSTables and blocks from their statistics.
+   * 
+   * @tparam OnEntry Entry visitor type.
+   * @tparam OnStats Statistics visitor type.
+   * @tparam AcceptBlock Block acceptor type.
+   * @param on_entry Called with each live entry that is decoded.
+   * @param on_stats Called with the statistics of each matching series of
+   * each SSTable or block that is not decoded, and its first timestamp.
+   * @param accept_block Called with the bounds on the timestamps of an
+   * SSTable or block before it is taken from its statistics; it is decoded
+   * if this returns false.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  template <
+    typename OnEntry,
+    typename OnStats,
+    typename AcceptBlock = AcceptAnyBlock
+  >
+  void forEach(
+    OnEntry&& on_entry,
+    OnStats&& on_stats,
+    AcceptBlock&& accept_block = AcceptBlock{}
+  ) {
+    const auto use_stats{predicate_ && !predicate_->constrainsTimestamps()};
+    while (!heap_.empty()) {
+      if (
+        use_stats && (
+          take_rollup(on_stats, accept_block) ||
+          take_block_stats(on_stats, accept_block)
+        )
+      ) {
+        continue;
+      }
+      if (const auto entry{pop_key()}) {
+        on_entry(*entry);
+      }
+    }
+  }
+
+  /**
+   * @brief Drain the merge in batches of contiguous timestamps and values.
+   * @details Decoded entries are collected into a batch, which is handed
+   * over once it is full, before each call to the statistics visitor, so
+   * that batches and statistics arrive in key order, and once the merge is
+   * drained. The batch is reused, so it must not be kept past the call.
+   * 
+   * @tparam OnBatch Batch visitor type.
+   * @tparam OnStats Statistics visitor type.
+   * @tparam AcceptBlock Block acceptor type.
+   * @param on_batch Called with each non-empty batch of live entries.
+   * @param on_stats Called with the statistics of each matching series of
+   * each SSTable or block that is not decoded, and its first timestamp.
+   * @param accept_block Called with the bounds on the timestamps of an
+   * SSTable or block before it is taken from its statistics; it is decoded
+   * if this returns false.
+   * @param batch_size Maximum number of entries in a batch.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   * @throw std::invalid_argument If the batch size is 0.
+   */
+  template <
+    typename OnBatch,
+    typename OnStats,
+    typename AcceptBlock = AcceptAnyBlock
+  >
+  void forEachBatch(
+    OnBatch&& on_batch,
+    OnStats&& on_stats,
+    AcceptBlock&& accept_block = AcceptBlock{},
+    uint64_t batch_size = DEFAULT_VALUE_BATCH_SIZE
+  ) {
+    ValueBatch<TValue> batch{batch_size};
+    const auto flush = [&batch, &on_batch]() {
+      if (!batch.empty()) {
+        on_batch(std::as_const(batch));
+        batch.clear();
+      }
+    };
+    forEach(
+      [&batch, &flush](const auto& entry) {
+        batch.push(entry.first.timestamp(), entry.second.value());
+        if (batch.full()) {
+          flush();
+        }
+      },
+      [&flush, &on_stats](const auto& stats, Timestamp start) {
+        flush();
+        on_stats(stats, start);
+      },
+      accept_block
+    );
+    flush();
+  }
+
+private:
+  /**
+   * @brief Pop every source at the smallest key.
+   * 
+   * @param keep_tombstones Whether to return tombstones.
+   * @return std::optional<value_type> The newest entry at the key, or
+   * std::nullopt if it fails the filter, is a tombstone that is not kept, or
+   * is covered by a range tombstone of a newer source.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  std::optional<value_type> pop_key(bool keep_tombstones = false) {
+    const auto newest{heap_.front()};
+    const auto key{current(newest).first};
+    auto value{current(newest).second};
+    do {
+      const auto source{pop()};
+      advance(source);
+    } while (!heap_.empty() && current(heap_.front()).first == key);
+
+    if (
+      (keep_tombstones || value.has_value()) &&
+      !range_deleted(ranks_[newest], key) &&
+      matches(key)
+    ) {
+      return value_type{key, std::move(value)};
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Check if a key passes the filter.
+   * @details A merge built from a predicate alone checks it directly,
+   * rather than through a type-erased filter.
+   * 
+   * @param key Key.
+   * @return true if the key passes the filter.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool matches(const key_type& key) const noexcept {
+    if constexpr (std::same_as<TFilter, TimeSeriesKeyFilter>) {
+      return filter_ ? filter_(key) : predicate_->matches(key);
+    } else {
+      return filter_(key);
+    }
+  }
+
+  /**
+   * @brief Get the predicate of a filter.
+   * 
+   * @param filter Filter.
+   * @return std::shared_ptr<const KeyPredicate> Predicate of a KeyFilter,
+   * or null for a type-erased filter.
+   */
+  [[nodiscard]] static std::shared_ptr<const KeyPredicate> typed_predicate(
+    const TFilter& filter
+  ) {
+    if constexpr (std::same_as<TFilter, TimeSeriesKeyFilter>) {
+      return nullptr;
+    } else {
+      return std::make_shared<const KeyPredicate>(toPredicate(filter));
+    }
+  }
+
+  /**
+   * @brief Take the SSTable at the top of the heap from its rollup, if
+   * possible.
+   * @details The smallest key of the other sources is at one of the
+   * children of the top of the heap.
+   * 
+   * @tparam OnStats Statistics visitor type.
+   * @tparam AcceptBlock Block acceptor type.
+   * @param on_stats Called with the statistics of each matching series.
+   * @param accept_block Block acceptor.
+   * @return true if the SSTable was taken from its rollup.
+   * @return false if it has to be read.
+   */
+  template <typename OnStats, typename AcceptBlock>
+  bool take_rollup(OnStats& on_stats, AcceptBlock& accept_block) {
+    const auto top{heap_.front()};
+    auto* sstable_source{std::get_if<SSTableSource>(&sources_[top])};
+    if (sstable_source == nullptr) {
+      return false;
+    }
+    auto& cursor{sstable_source->cursor};
+    const auto rollup{cursor.rollup()};
+    if (rollup.empty()) {
+      return false;
+    }
+    for (size_type child{1}; child <= 2 && child < heap_.size(); ++child) {
+      if (!cursor.tableEndsBefore(current(heap_[child]).first)) {
+        return false;
+      }
+    }
+    const auto time_range{cursor.tableTimeRange()};
+    if (range_overlaps(ranks_[top], time_range) || !accept_block(time_range)) {
+      return false;
+    }
+
+    for (size_type series{0}; series < rollup.size(); ++series) {
+      if (rollup[series].count > 0 &&
+          predicate_->matches(cursor.seriesKey(series))) {
+        on_stats(rollup[series], time_range.lower());
+      }
+    }
+    pop();
+    cursor.skipTable();
+    return true;
+  }
+
+  /**
+   * @brief Take the block at the top of the heap from its statistics, if
+   * possible.
+   * @details The smallest key of the other sources is at one of the
+   * children of the top of the heap.
+   * 
+   * @tparam OnStats Statistics visitor type.
+   * @tparam AcceptBlock Block acceptor type.
+   * @param on_stats Called with the statistics of each matching series.
+   * @param accept_block Block acceptor.
+   * @return true if the block was taken from its statistics.
+   * @return false if it has to be decoded.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  template <typename OnStats, typename AcceptBlock>
+  bool take_block_stats(OnStats& on_stats, AcceptBlock& accept_block) {
+    const auto top{heap_.front()};
+    auto* sstable_source{std::get_if<SSTableSource>(&sources_[top])};
+    if (sstable_source == nullptr) {
+      return false;
+    }
+    auto& cursor{sstable_source->cursor};
+    const auto* block_stats{cursor.runStats()};
+    if (block_stats == nullptr) {
+      return false;
+    }
+    for (size_type child{1}; child <= 2 && child < heap_.size(); ++child) {
+      if (!cursor.runEndsBefore(current(heap_[child]).first)) {
+        return false;
+      }
+    }
+    const auto time_range{cursor.runTimeRange()};
+    if (range_overlaps(ranks_[top], time_range) || !accept_block(time_range)) {
+      return false;
+    }
+
+    for (const auto& [series, stats] : block_stats->entries()) {
+      if (predicate_->matches(cursor.seriesKey(series))) {
+        on_stats(stats, time_range.lower());
+      }
+    }
+    pop();
+    cursor.skipRun();
+    if (cursor.valid()) {
+      push(top);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Add the range tombstones of a source.
+   * 
+   * @param rank Rank of the source.
+   * @param range_tombstones Range tombstones.
+   */
+  void add_range_tombstones(
+    size_type rank,
+    const std::vector<RangeTombstone>& range_tombstones
+  ) {
+    for (const auto& range_tombstone : range_tombstones) {
+      range_tombstones_.push_back({partition_start_, rank, range_tombstone});
+    }
+  }
+
+  /**
+   * @brief Check if a range tombstone newer than a source, in the same
+   * partition, covers a key.
+   * 
+   * @param rank Rank of the source.
+   * @param key Key.
+   * @return true if the key is deleted.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool range_deleted(
+    size_type rank,
+    const key_type& key
+  ) const noexcept {
+    return std::ranges::any_of(range_tombstones_, [&](const auto& entry) {
+      return entry.shadows(rank) && entry.range_tombstone.covers(key);
+    });
+  }
+
+  /**
+   * @brief Check if a range tombstone newer than a source, in the same
+   * partition, overlaps with a time range.
+   * 
+   * @param rank Rank of the source.
+   * @param time_range Time range.
+   * @return true if a range tombstone overlaps.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool range_overlaps(
+    size_type rank,
+    const TimeRange& time_range
+  ) const noexcept {
+    return std::ranges::any_of(range_tombstones_, [&](const auto& entry) {
+      return entry.shadows(rank) && entry.range_tombstone.overlaps(time_range);
+    });
+  }
+
+  /**
+   * @brief Range tombstone with the rank it was added at.
+   * 
+   */
+  struct RankedRangeTombstone {
+    /**
+     * @brief Rank at which the partition of the range tombstone starts.
+     * 
+     */
+    size_type partition_start;
+
+    /**
+     * @brief Rank of the range tombstone.
+     * 
+     */
+    size_type rank;
+
+    /**
+     * @brief Range tombstone.
+     * 
+     */
+    RangeTombstone range_tombstone;
+
+    /**
+     * @brief Check if the range tombstone deletes keys of a source.
+     * 
+     * @param source_rank Rank of the source.
+     * @return true if the source is older and in the same partition.
+     * @return false otherwise.
+     */
+    [[nodiscard]] bool shadows(size_type source_rank) const noexcept {
+      return partition_start <= source_rank && source_rank < rank;
+    }
+  };
+
+  /**
+   * @brief In-memory sorted run and the position in it.
+   * 
+   */
+  struct RunSource {
+    Run run;
+    size_type pos;
+  };
+
+  /**
+   * @brief SSTable and a cursor over it.
+   * 
+   */
+  struct SSTableSource {
+    SSTablePtr sstable;
+    typename SSTable<TValue>::Cursor cursor;
+  };
+
+  /**
+   * @brief Source of entries.
+   * 
+   */
+  using Source = std::variant<RunSource, SSTableSource>;
+
+  /**
+   * @brief Get the current entry of a source.
+   * 
+   * @param source Source index.
+   * @return const value_type& Entry.
+   */
+  [[nodiscard]] const value_type& current(size_type source) const noexcept {
+    const auto& from{sources_[source]};
+    if (const auto* run_source{std::get_if<RunSource>(&from)}) {
+      return run_source->run[run_source->pos];
+    }
+    return std::get<SSTableSource>(from).cursor.entry();
+  }
+
+  /**
+   * @brief Advance a source, and push it back onto the heap unless it is
+   * exhausted.
+   * 
+   * @param source Source index.
+   * 
+   * @throw std::runtime_error If an entry of an SSTable is malformed.
+   */
+  void advance(size_type source) {
+    auto& from{sources_[source]};
+    if (auto* run_source{std::get_if<RunSource>(&from)}) {
+      if (++run_source->pos < run_source->run.size()) {
+        push(source);
+      }
+      return;
+    }
+    auto& cursor{std::get<SSTableSource>(from).cursor};
+    cursor.advance();
+    if (cursor.valid()) {
+      push(source);
+    }
+  }
+
+  /**
+   * @brief Push a source onto the heap.
+   * 
+   * @param source Source index.
+   */
+  void push(size_type source) {
+    heap_.push_back(source);
+    std::ranges::push_heap(heap_, heap_order());
+  }
+
+  /**
+   * @brief Pop the top source off the heap.
+   * 
+   * @return size_type Source index.
+   */
+  size_type pop() noexcept {
+    std::ranges::pop_heap(heap_, heap_order());
+    const auto source{heap_.back()};
+    heap_.pop_back();
+    return source;
+  }
+
+  /**
+   * @brief Get the heap order, with the smallest key and then the newest
+   * source on top.
+   * 
+   * @return auto Comparator.
+   */
+  [[nodiscard]] auto heap_order() const noexcept {
+    return [this](const auto lhs, const auto rhs) {
+      const auto& lhs_key{current(lhs).first};
+      const auto& rhs_key{current(rhs).first};
+      if (lhs_key == rhs_key) {
+        return lhs < rhs;
+      }
+      return rhs_key < lhs_key;
+    };
+  }
+
+  /**
+   * @brief Predicate, or null if only an opaque filter is given.
+   * 
+   */
+  std::shared_ptr<const KeyPredicate> predicate_;
+
+  /**
+   * @brief Filter, which is empty if only a predicate is given.
+   * 
+   */
+  TFilter filter_;
+
+  /**
+   * @brief Sources, oldest first.
+   * 
+   */
+  std::pmr::vector<Source> sources_;
+
+  /**
+   * @brief Rank of each source, in the order that sources and range
+   * tombstones were added.
+   * 
+   */
+  std::pmr::vector<size_type> ranks_;
+
+  /**
+   * @brief Range tombstones, each with the rank it was added at.
+   * 
+   */
+  std::pmr::vector<RankedRangeTombstone> range_tombstones_;
+
+  /**
+   * @brief Rank of the next source or range tombstone.
+   * 
+   */
+  size_type next_rank_{0};
+
+  /**
+   * @brief Rank at which the current partition starts.
+   * 
+   */
+  size_type partition_start_{0};
+
+  /**
+   * @brief Heap of the indices of the sources that are not exhausted.
+   * 
+   */
+  std::pmr::vector<size_type> heap_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_MERGE_ITERATOR_H
@@ -0,0 +1,174 @@
+#ifndef STORAGE_RANGE_TOMBSTONE_H
+#define STORAGE_RANGE_TOMBSTONE_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/data_range.h>
+#include <string>
+
+namespace vkdb {
+/**
+ * @brief Deletion of every key of a metric in a time interval.
+ * @details Covers the keys with the metric whose tags include all of the
+ * tombstone's tags and whose timestamps lie in the interval, bounds
+ * included. A tombstone only deletes what was written before it, so it is
+ * only applied to older sources of entries.
+ * 
+ */
+class RangeTombstone {
+public:
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  RangeTombstone() = delete;
+
+  /**
+   * @brief Construct a new RangeTombstone object.
+   * 
+   * @param start Start timestamp.
+   * @param end End timestamp.
+   * @param metric Metric.
+   * @param tags Tags a key must have to be covered.
+   * 
+   * @throw std::invalid_argument If the start timestamp is after the end
+   * timestamp.
+   */
+  RangeTombstone(
+    Timestamp start,
+    Timestamp end,
+    Metric metric,
+    TagTable tags = {}
+  );
+
+  /**
+   * @brief Construct a new RangeTombstone object from its string form.
+   * 
+   * @param str String, as given by str().
+   * 
+   * @throw std::invalid_argument If the string is malformed.
+   */
+  explicit RangeTombstone(const std::string& str);
+
+  /**
+   * @brief Move-construct a RangeTombstone object.
+   * 
+   */
+  RangeTombstone(RangeTombstone&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a RangeTombstone object.
+   * 
+   */
+  RangeTombstone& operator=(RangeTombstone&&) noexcept = default;
+
+  /**
+   * @brief Copy-construct a RangeTombstone object.
+   * 
+   */
+  RangeTombstone(const RangeTombstone&) = default;
+
+  /**
+   * @brief Copy-assign a RangeTombstone object.
+   * 
+   */
+  RangeTombstone& operator=(const RangeTombstone&) = default;
+
+  /**
+   * @brief Destroy the RangeTombstone object.
+   * 
+   */
+  ~RangeTombstone() noexcept = default;
+
+  /**
+   * @brief Equality operator.
+   * 
+   * @param other Other tombstone.
+   * @return true if the tombstones are equal.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool operator==(const RangeTombstone& other) const noexcept
+    = default;
+
+  /**
+   * @brief Check if the tombstone covers a key.
+   * 
+   * @param key Key.
+   * @return true if the key is deleted by the tombstone.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool covers(const TimeSeriesKey& key) const noexcept;
+
+  /**
+   * @brief Check if the interval of the tombstone overlaps a time range.
+   * 
+   * @param time_range Time range.
+   * @return true if they overlap.
+   * @return false otherwise, or if the time range is not set.
+   */
+  [[nodiscard]] bool overlaps(const TimeRange& time_range) const noexcept;
+
+  /**
+   * @brief Get the start timestamp.
+   * 
+   * @return Timestamp Start timestamp.
+   */
+  [[nodiscard]] Timestamp start() const noexcept;
+
+  /**
+   * @brief Get the end timestamp.
+   * 
+   * @return Timestamp End timestamp.
+   */
+  [[nodiscard]] Timestamp end() const noexcept;
+
+  /**
+   * @brief Get the metric.
+   * 
+   * @return const Metric& Metric.
+   */
+  [[nodiscard]] const Metric& metric() const noexcept;
+
+  /**
+   * @brief Get the tags.
+   * 
+   * @return const TagTable& Tags.
+   */
+  [[nodiscard]] const TagTable& tags() const noexcept;
+
+  /**
+   * @brief Convert the tombstone to a string.
+   * @details The string is `{start}{end}{metric}{key:value,...}` and has no
+   * whitespace, as with a TimeSeriesKey.
+   * 
+   * @return std::string String.
+   */
+  [[nodiscard]] std::string str() const;
+
+private:
+  /**
+   * @brief Start timestamp.
+   * 
+   */
+  Timestamp start_;
+
+  /**
+   * @brief End timestamp.
+   * 
+   */
+  Timestamp end_;
+
+  /**
+   * @brief Metric.
+   * 
+   */
+  Metric metric_;
+
+  /**
+   * @brief Tags a key must have to be covered.
+   * 
+   */
+  TagTable tags_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_RANGE_TOMBSTONE_H
@@ -0,0 +1,272 @@
+#ifndef STORAGE_SERIES_DICTIONARY_H
+#define STORAGE_SERIES_DICTIONARY_H
+
+#include <vkdb/time_series_key.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <shared_mutex>
+#include <functional>
+
+namespace vkdb {
+/**
+ * @brief Interned metric and tags shared by every key of a series.
+ * 
+ */
+struct Series {
+  /**
+   * @brief Series ID.
+   * 
+   */
+  SeriesId id;
+
+  /**
+   * @brief Metric.
+   * 
+   */
+  Metric metric;
+
+  /**
+   * @brief Tags.
+   * 
+   */
+  TagTable tags;
+
+  /**
+   * @brief Hash of the metric and tags.
+   * 
+   */
+  size_t hash;
+
+  /**
+   * @brief Number of references held, by keys and otherwise.
+   * 
+   */
+  mutable std::atomic<size_t> references{0};
+
+  /**
+   * @brief Whether references to the series are counted.
+   * @details Only the empty series, which is never removed, is not counted,
+   * so that default-constructed and moved-from keys are free to make.
+   * 
+   */
+  bool counted{true};
+};
+
+/**
+ * @brief Dictionary interning each distinct metric and tag set as a Series.
+ * @details Every TimeSeriesKey refers to its series through the dictionary,
+ * so keys of the same series share one copy of the metric and tags, and can
+ * be compared and hashed by identity. Series are reference-counted, and are
+ * removed once the last key or other holder releases them, so the dictionary
+ * only grows with the series still in use. IDs are assigned in order of
+ * first use, are never reused, and are not stable across runs. The
+ * dictionary is safe to use from multiple threads.
+ * 
+ */
+class SeriesDictionary {
+public:
+  /**
+   * @brief Get the process-wide dictionary.
+   * 
+   * @return SeriesDictionary& Dictionary.
+   */
+  [[nodiscard]] static SeriesDictionary& instance() noexcept;
+
+  /**
+   * @brief Construct a new SeriesDictionary object.
+   * @details Holds only the empty series.
+   * 
+   * @throw std::bad_alloc If interning the empty series fails.
+   */
+  SeriesDictionary();
+
+  /**
+   * @brief Deleted move constructor.
+   * 
+   */
+  SeriesDictionary(SeriesDictionary&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   * 
+   */
+  SeriesDictionary& operator=(SeriesDictionary&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  SeriesDictionary(const SeriesDictionary&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  SeriesDictionary& operator=(const SeriesDictionary&) = delete;
+
+  /**
+   * @brief Destroy the SeriesDictionary object.
+   * 
+   */
+  ~SeriesDictionary() noexcept = default;
+
+  /**
+   * @brief Get the series of a metric and tags, interning it if it is new.
+   * @details The caller is given a reference to the series, which it must
+   * drop with release().
+   * 
+   * @param metric Metric.
+   * @param tags Tags.
+   * @return const Series& Series.
+   * 
+   * @throw std::bad_alloc If interning the series fails.
+   */
+  [[nodiscard]] const Series& intern(Metric&& metric, TagTable&& tags);
+
+  /**
+   * @brief Take another reference to a series that is already held.
+   * 
+   * @param series Series.
+   */
+  static void acquire(const Series& series) noexcept;
+
+  /**
+   * @brief Drop a reference to a series.
+   * @details The series is removed once its last reference is dropped.
+   * 
+   * @param series Series.
+   */
+  void release(const Series& series) noexcept;
+
+  /**
+   * @brief Get a series by ID.
+   * @details The series must be held by the caller, e.g. through a key, for
+   * the reference to stay valid.
+   * 
+   * @param id Series ID.
+   * @return const Series& Series.
+   * 
+   * @throw std::out_of_range If there is no series with the ID.
+   */
+  [[nodiscard]] const Series& at(SeriesId id) const;
+
+  /**
+   * @brief Get the empty series, which has no metric and no tags.
+   * 
+   * @return const Series& Series.
+   */
+  [[nodiscard]] const Series& emptySeries() const noexcept;
+
+  /**
+   * @brief Get the number of interned series, the empty series included.
+   * 
+   * @return size_t Number of series.
+   */
+  [[nodiscard]] size_t size() const noexcept;
+
+  /**
+   * @brief Estimate the memory a series holds in the dictionary.
+   * 
+   * @param series Series.
+   * @return size_t Bytes.
+   */
+  [[nodiscard]] static size_t seriesBytes(const Series& series) noexcept;
+
+  /**
+   * @brief Hash a metric and tags.
+   * @details The hash only depends on the bytes of the metric and tags, so it
+   * is stable across processes and may be persisted, e.g. in Bloom filters.
+   * 
+   * @param metric Metric.
+   * @param tags Tags.
+   * @return size_t Hash.
+   */
+  [[nodiscard]] static size_t hash(
+    const Metric& metric,
+    const TagTable& tags
+  ) noexcept;
+
+private:
+  /**
+   * @brief Metric and tags to look a series up by.
+   * 
+   */
+  struct SeriesRef {
+    const Metric& metric;
+    const TagTable& tags;
+    size_t hash;
+  };
+
+  /**
+   * @brief Transparent hash for series lookups.
+   * 
+   */
+  struct SeriesHash {
+    using is_transparent = void;
+
+    size_t operator()(const Series* series) const noexcept {
+      return series->hash;
+    }
+
+    size_t operator()(const SeriesRef& ref) const noexcept {
+      return ref.hash;
+    }
+  };
+
+  /**
+   * @brief Transparent equality for series lookups.
+   * 
+   */
+  struct SeriesEqual {
+    using is_transparent = void;
+
+    bool operator()(const Series* lhs, const Series* rhs) const noexcept {
+      return lhs == rhs;
+    }
+
+    bool operator()(const SeriesRef& lhs, const Series* rhs) const noexcept {
+      return lhs.metric == rhs->metric && lhs.tags == rhs->tags;
+    }
+
+    bool operator()(const Series* lhs, const SeriesRef& rhs) const noexcept {
+      return (*this)(rhs, lhs);
+    }
+  };
+
+  /**
+   * @brief Mutex guarding the dictionary.
+   * 
+   */
+  mutable std::shared_mutex mutex_;
+
+  /**
+   * @brief Series by ID.
+   * @details Each is allocated on its own, so that it never moves once
+   * interned.
+   * 
+   */
+  std::unordered_map<SeriesId, std::unique_ptr<Series>> series_;
+
+  /**
+   * @brief Series by metric and tags.
+   * 
+   */
+  std::unordered_set<const Series*, SeriesHash, SeriesEqual> index_;
+
+  /**
+   * @brief Empty series.
+   * 
+   */
+  const Series* empty_series_;
+
+  /**
+   * @brief ID of the next series to intern.
+   * 
+   */
+  SeriesId next_id_{0};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_SERIES_DICTIONARY_H
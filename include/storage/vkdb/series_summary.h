@@ -0,0 +1,177 @@
+#ifndef STORAGE_SERIES_SUMMARY_H
+#define STORAGE_SERIES_SUMMARY_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <set>
+#include <unordered_set>
+#include <string>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Summary of the metrics and tags present in a set of keys.
+ * @details Each SSTable keeps a summary of its keys, so a query can rule out
+ * the whole table without reading it. Only the first MAX_VALUES distinct
+ * metrics and tags are kept; past that, the summary saturates and may match
+ * anything. The summary also provides the token masks, a 64-bit sketch of
+ * the metric and tags of a key, that SSTables keep for each block.
+ * 
+ */
+class SeriesSummary {
+public:
+  using size_type = uint64_t;
+  using mask_type = uint64_t;
+
+  /**
+   * @brief Maximum number of distinct metrics and tags kept.
+   * 
+   */
+  static constexpr size_type MAX_VALUES{1024};
+
+  /**
+   * @brief Token mask that may match anything.
+   * 
+   */
+  static constexpr mask_type FULL_MASK{~mask_type{0}};
+
+  /**
+   * @brief Construct a new, empty SeriesSummary object.
+   * 
+   */
+  SeriesSummary() noexcept = default;
+
+  /**
+   * @brief Construct a saturated summary, which may match anything.
+   * @details Used for SSTables whose metadata predates summaries.
+   * 
+   * @return SeriesSummary Saturated summary.
+   */
+  [[nodiscard]] static SeriesSummary saturatedSummary() noexcept;
+
+  /**
+   * @brief Read a binary-encoded summary from a buffer.
+   * @details Advances the position past the summary.
+   * 
+   * @param pos Position in the buffer.
+   * @param end End of the buffer.
+   * @return SeriesSummary Summary.
+   * 
+   * @throw std::runtime_error If the buffer is too short.
+   */
+  [[nodiscard]] static SeriesSummary fromBinary(
+    const char*& pos,
+    const char* end
+  );
+
+  /**
+   * @brief Append the binary encoding of the summary to a buffer.
+   * @details The summary is encoded as a saturation flag, followed by the
+   * counted, length-prefixed metrics and tag keys and values.
+   * 
+   * @param buffer Buffer.
+   * 
+   * @throw std::length_error If a string is too long to encode.
+   */
+  void toBinary(std::string& buffer) const;
+
+  /**
+   * @brief Add the metric and tags of a key to the summary.
+   * @details Keys of a series already seen are skipped without touching the
+   * strings.
+   * 
+   * @param key Key.
+   */
+  void insert(const TimeSeriesKey& key);
+
+  /**
+   * @brief Check if the summary is saturated.
+   * 
+   * @return true if the summary is saturated and may match anything.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool saturated() const noexcept;
+
+  /**
+   * @brief Check if the summary may contain a metric.
+   * 
+   * @param metric Metric.
+   * @return true if a key may have the metric.
+   * @return false if no key has the metric.
+   */
+  [[nodiscard]] bool mayContainMetric(const Metric& metric) const noexcept;
+
+  /**
+   * @brief Check if the summary may contain a tag.
+   * 
+   * @param tag Tag.
+   * @return true if a key may have the tag.
+   * @return false if no key has the tag.
+   */
+  [[nodiscard]] bool mayContainTag(const Tag& tag) const noexcept;
+
+  /**
+   * @brief Get the token mask of a metric.
+   * @details The mask has a single bit set, picked by a hash that is stable
+   * across processes.
+   * 
+   * @param metric Metric.
+   * @return mask_type Token mask.
+   */
+  [[nodiscard]] static mask_type metricMask(const Metric& metric) noexcept;
+
+  /**
+   * @brief Get the token mask of a tag.
+   * @details The mask has a single bit set, picked by a hash that is stable
+   * across processes.
+   * 
+   * @param tag Tag.
+   * @return mask_type Token mask.
+   */
+  [[nodiscard]] static mask_type tagMask(const Tag& tag) noexcept;
+
+  /**
+   * @brief Get the token mask of a key.
+   * @details The union of the masks of its metric and tags.
+   * 
+   * @param key Key.
+   * @return mask_type Token mask.
+   */
+  [[nodiscard]] static mask_type keyMask(const TimeSeriesKey& key) noexcept;
+
+private:
+  /**
+   * @brief Saturate the summary, dropping the values kept so far.
+   * 
+   */
+  void saturate() noexcept;
+
+  /**
+   * @brief Metrics.
+   * 
+   */
+  std::set<Metric> metrics_;
+
+  /**
+   * @brief Tags.
+   * 
+   */
+  std::set<Tag> tags_;
+
+  /**
+   * @brief IDs of the series inserted so far.
+   * @details Series IDs are not stable across runs, so they are never
+   * persisted.
+   * 
+   */
+  std::unordered_set<SeriesId> seen_;
+
+  /**
+   * @brief Whether the summary is saturated.
+   * 
+   */
+  bool saturated_{false};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_SERIES_SUMMARY_H
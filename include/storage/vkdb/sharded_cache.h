@@ -0,0 +1,386 @@
+#ifndef STORAGE_SHARDED_CACHE_H
+#define STORAGE_SHARDED_CACHE_H
+
+#include <vkdb/concepts.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief A thread-safe cache split into independently locked shards.
+ * @details Each key belongs to one shard, picked by its hash. Shards evict
+ * with the CLOCK policy: a hit only sets the reference bit of the slot, so
+ * lookups share the shard's lock and never reorder anything, and eviction
+ * sweeps a hand over the slots, sparing each referenced one once.
+ * 
+ * @tparam TKey Key type.
+ * @tparam TValue Value type.
+ */
+template <RegularNoCVRefQuals TKey, RegularNoCVRefQuals TValue>
+class ShardedCache {
+public:
+  using key_type = TKey;
+  using mapped_type = std::optional<TValue>;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = uint64_t;
+
+  /**
+   * @brief Default number of shards.
+   * 
+   */
+  static constexpr size_type DEFAULT_SHARD_COUNT{16};
+
+  /**
+   * @brief Construct a new ShardedCache object given a capacity.
+   * @details The capacity is split evenly across the shards. There are never
+   * more shards than the capacity.
+   * 
+   * @param capacity Capacity.
+   * @param shard_count Number of shards.
+   * 
+   * @throws std::invalid_argument If the capacity or the number of shards is
+   * 0.
+   */
+  explicit ShardedCache(
+    size_type capacity,
+    size_type shard_count = DEFAULT_SHARD_COUNT
+  ) : capacity_{capacity} {
+    if (capacity == 0) {
+      throw std::invalid_argument{
+        "ShardedCache(): Capacity must be greater than 0."
+      };
+    }
+    if (shard_count == 0) {
+      throw std::invalid_argument{
+        "ShardedCache(): Number of shards must be greater than 0."
+      };
+    }
+    shard_count = std::min(shard_count, capacity);
+    shards_.reserve(shard_count);
+    for (size_type i{0}; i < shard_count; ++i) {
+      shards_.push_back(std::make_unique<Shard>(
+        capacity / shard_count + (i < capacity % shard_count ? 1 : 0)
+      ));
+    }
+  }
+
+  /**
+   * @brief Move-construct a ShardedCache object.
+   * 
+   */
+  ShardedCache(ShardedCache&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a ShardedCache object.
+   * 
+   */
+  ShardedCache& operator=(ShardedCache&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  ShardedCache(const ShardedCache&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  ShardedCache& operator=(const ShardedCache&) = delete;
+
+  /**
+   * @brief Destroy the ShardedCache object.
+   * 
+   */
+  ~ShardedCache() noexcept = default;
+
+  /**
+   * @brief Put a key-value pair into the cache.
+   * @details Evicts a key of the same shard if the shard is full.
+   * 
+   * @param key Key.
+   * @param value Value.
+   * 
+   * @throws std::exception If inserting the key-value pair fails.
+   */
+  void put(const key_type& key, const mapped_type& value) {
+    auto& shard{shard_for(key)};
+    std::unique_lock lock{shard.mutex};
+    auto it{shard.slot_indices.find(key)};
+    if (it != shard.slot_indices.end()) {
+      auto& slot{shard.slots[it->second]};
+      slot.value = value;
+      slot.referenced.store(true, std::memory_order_relaxed);
+      return;
+    }
+
+    size_type index;
+    if (shard.used < shard.capacity) {
+      index = shard.used++;
+    } else {
+      index = shard.evict();
+    }
+    auto& slot{shard.slots[index]};
+    slot.key = key;
+    slot.value = value;
+    slot.referenced.store(true, std::memory_order_relaxed);
+    shard.slot_indices.emplace(key, index);
+  }
+
+  /**
+   * @brief Look up a key and mark it as recently used.
+   * @details Only takes the shard's lock once, and shares it with other
+   * lookups.
+   * 
+   * @param key Key.
+   * @return std::optional<mapped_type> The cached value if the cache contains
+   * the key, std::nullopt otherwise. The cached value is itself std::nullopt
+   * for a cached removal.
+   */
+  [[nodiscard]] std::optional<mapped_type> tryGet(
+    const key_type& key
+  ) const noexcept {
+    const auto& shard{shard_for(key)};
+    std::shared_lock lock{shard.mutex};
+    const auto it{shard.slot_indices.find(key)};
+    if (it == shard.slot_indices.end()) {
+      return std::nullopt;
+    }
+    auto& slot{shard.slots[it->second]};
+    if (!slot.referenced.load(std::memory_order_relaxed)) {
+      slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    return slot.value;
+  }
+
+  /**
+   * @brief Check if the cache contains a key.
+   * @details Does not mark the key as recently used.
+   * 
+   * @param key Key.
+   * @return true if the cache contains the key.
+   * @return false if the cache does not contain the key.
+   */
+  [[nodiscard]] bool contains(const key_type& key) const noexcept {
+    const auto& shard{shard_for(key)};
+    std::shared_lock lock{shard.mutex};
+    return shard.slot_indices.contains(key);
+  }
+
+  /**
+   * @brief Remove a key from the cache.
+   * 
+   * @param key Key.
+   */
+  void erase(const key_type& key) noexcept {
+    auto& shard{shard_for(key)};
+    std::unique_lock lock{shard.mutex};
+    const auto it{shard.slot_indices.find(key)};
+    if (it == shard.slot_indices.end()) {
+      return;
+    }
+    const auto index{it->second};
+    shard.slot_indices.erase(it);
+    shard.release(index);
+  }
+
+  /**
+   * @brief Get the capacity of the cache.
+   * 
+   * @return size_type Capacity.
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return capacity_;
+  }
+
+  /**
+   * @brief Get the number of shards.
+   * 
+   * @return size_type Number of shards.
+   */
+  [[nodiscard]] size_type shardCount() const noexcept {
+    return shards_.size();
+  }
+
+  /**
+   * @brief Get the size of the cache.
+   * @details Each shard is counted under its own lock, so the size may be
+   * stale under concurrent writes.
+   * 
+   * @return size_type Size.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    size_type size{0};
+    for (const auto& shard : shards_) {
+      std::shared_lock lock{shard->mutex};
+      size += shard->used;
+    }
+    return size;
+  }
+
+  /**
+   * @brief Clear the cache.
+   * 
+   */
+  void clear() noexcept {
+    for (auto& shard : shards_) {
+      std::unique_lock lock{shard->mutex};
+      shard->slot_indices.clear();
+      for (size_type i{0}; i < shard->used; ++i) {
+        shard->slots[i].value.reset();
+      }
+      shard->used = 0;
+      shard->hand = 0;
+    }
+  }
+
+private:
+  /**
+   * @brief Cached key-value pair.
+   * @details The reference bit is set by lookups under a shared lock, so it
+   * is atomic.
+   * 
+   */
+  struct Slot {
+    key_type key{};
+    mapped_type value;
+    std::atomic<bool> referenced{false};
+  };
+
+  /**
+   * @brief Independently locked part of the cache.
+   * @details The first used slots are occupied.
+   * 
+   */
+  struct Shard {
+    /**
+     * @brief Construct a new Shard object given a capacity.
+     * 
+     * @param shard_capacity Capacity.
+     */
+    explicit Shard(size_type shard_capacity)
+      : capacity{shard_capacity}
+      , slots{std::make_unique<Slot[]>(shard_capacity)} {
+        slot_indices.reserve(shard_capacity);
+      }
+
+    /**
+     * @brief Evict the key under the CLOCK hand.
+     * @details Referenced slots passed over lose their reference bit. Must be
+     * called with the lock held exclusively on a full shard.
+     * 
+     * @return size_type Index of the freed slot.
+     */
+    [[nodiscard]] size_type evict() noexcept {
+      while (slots[hand].referenced.load(std::memory_order_relaxed)) {
+        slots[hand].referenced.store(false, std::memory_order_relaxed);
+        hand = (hand + 1) % used;
+      }
+      const auto index{hand};
+      slot_indices.erase(slots[index].key);
+      hand = (hand + 1) % used;
+      return index;
+    }
+
+    /**
+     * @brief Free an occupied slot whose key has been unmapped.
+     * @details The last occupied slot is moved into it. Must be called with
+     * the lock held exclusively.
+     * 
+     * @param index Index of the slot.
+     */
+    void release(size_type index) noexcept {
+      const auto last{--used};
+      if (index != last) {
+        auto& slot{slots[index]};
+        auto& last_slot{slots[last]};
+        slot.key = std::move(last_slot.key);
+        slot.value = std::move(last_slot.value);
+        slot.referenced.store(
+          last_slot.referenced.load(std::memory_order_relaxed),
+          std::memory_order_relaxed
+        );
+        slot_indices[slot.key] = index;
+      }
+      slots[last].value.reset();
+      if (hand >= used) {
+        hand = 0;
+      }
+    }
+
+    /**
+     * @brief Capacity.
+     * 
+     */
+    size_type capacity;
+
+    /**
+     * @brief Number of occupied slots.
+     * 
+     */
+    size_type used{0};
+
+    /**
+     * @brief Position of the CLOCK hand.
+     * 
+     */
+    size_type hand{0};
+
+    /**
+     * @brief Slots.
+     * 
+     */
+    std::unique_ptr<Slot[]> slots;
+
+    /**
+     * @brief Index of the slot of each key.
+     * 
+     */
+    std::unordered_map<key_type, size_type> slot_indices;
+
+    /**
+     * @brief Mutex, shared by lookups.
+     * 
+     */
+    mutable std::shared_mutex mutex;
+  };
+
+  /**
+   * @brief Get the shard of a key.
+   * @details The hash is mixed before picking the shard, so the shard does
+   * not depend on the same bits as the buckets of its map.
+   * 
+   * @param key Key.
+   * @return Shard& Shard.
+   */
+  [[nodiscard]] Shard& shard_for(const key_type& key) const noexcept {
+    const auto hash{
+      static_cast<uint64_t>(std::hash<key_type>{}(key)) * 0x9e3779b97f4a7c15ULL
+    };
+    return *shards_[(hash >> 32) % shards_.size()];
+  }
+
+  /**
+   * @brief Capacity.
+   * 
+   */
+  size_type capacity_;
+
+  /**
+   * @brief Shards.
+   * 
+   */
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_SHARDED_CACHE_H
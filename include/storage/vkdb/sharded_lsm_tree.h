@@ -0,0 +1,451 @@
+#ifndef STORAGE_SHARDED_LSM_TREE_H
+#define STORAGE_SHARDED_LSM_TREE_H
+
+#include <vkdb/lsm_tree.h>
+#include <vkdb/concepts.h>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkdb {
+/**
+ * @brief Prefix of the directory of each shard of a sharded LSM tree.
+ * 
+ */
+static const std::string SHARD_DIRECTORY_PREFIX{"shard_"};
+
+/**
+ * @brief LSM trees that hash-partition the series of a table between them.
+ * @details Each series lives in exactly one shard, picked from the hash of
+ * its metric and tags, which is stable across restarts. Each shard is a
+ * whole LSM tree, with its own memtable, WAL, layers and locks, so writers
+ * to different shards never contend. Writes are routed to the shard of
+ * their series, and range removals, which may cover series in any shard,
+ * go to every shard. Reads fan out to the shards and merge, as done by
+ * QueryBuilder.
+ * 
+ * A single shard lives at the path itself, as a lone LSM tree would, and
+ * shard i of several lives at path/shard_i.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class ShardedLSMTree {
+public:
+  using key_type = TimeSeriesKey;
+  using mapped_type = std::optional<TValue>;
+  using size_type = uint64_t;
+
+  /**
+   * @brief Deleted default constructor.
+   * 
+   */
+  ShardedLSMTree() = delete;
+
+  /**
+   * @brief Construct a new ShardedLSMTree object.
+   * @details Opens every shard, as given by LSMTree::LSMTree().
+   * 
+   * @param path Path of the sharded LSM tree.
+   * @param options Options of every shard, with the number of shards.
+   * 
+   * @throw std::invalid_argument If the number of shards is 0, or if any
+   * other option is out of range.
+   */
+  explicit ShardedLSMTree(FilePath path, LSMTreeOptions options = {}) {
+    if (options.shards == 0) {
+      throw std::invalid_argument{
+        "ShardedLSMTree(): Number of shards must be at least 1."
+      };
+    }
+    shards_.reserve(options.shards);
+    if (options.shards == 1) {
+      shards_.emplace_back(std::move(path), std::move(options));
+      return;
+    }
+    for (size_type i{0}; i < options.shards; ++i) {
+      shards_.emplace_back(
+        path / (SHARD_DIRECTORY_PREFIX + std::to_string(i)),
+        options
+      );
+    }
+  }
+
+  /**
+   * @brief Move-construct a ShardedLSMTree object.
+   * @details The shards themselves are not moved, so pointers to them stay
+   * valid.
+   * 
+   */
+  ShardedLSMTree(ShardedLSMTree&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a ShardedLSMTree object.
+   * 
+   */
+  ShardedLSMTree& operator=(ShardedLSMTree&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  ShardedLSMTree(const ShardedLSMTree&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  ShardedLSMTree& operator=(const ShardedLSMTree&) = delete;
+
+  /**
+   * @brief Destroy the ShardedLSMTree object.
+   * 
+   */
+  ~ShardedLSMTree() noexcept = default;
+
+  /**
+   * @brief Get the shard that holds the series of a key.
+   * 
+   * @param key Key.
+   * @param shard_count Number of shards.
+   * @return size_type Shard index.
+   */
+  [[nodiscard]] static size_type shardIndex(
+    const key_type& key,
+    size_type shard_count
+  ) noexcept {
+    return shard_count == 1 ? 0 : key.series().hash % shard_count;
+  }
+
+  /**
+   * @brief Put a key-value pair into the shard of its series.
+   * 
+   * @param key Key.
+   * @param value Value.
+   * @param log Whether to log the operation in the WAL.
+   * 
+   * @throw std::runtime_error If the put fails, as given by LSMTree::put().
+   */
+  void put(const key_type& key, const TValue& value, bool log = true) {
+    shard_of(key).put(key, value, log);
+  }
+
+  /**
+   * @brief Remove a key from the shard of its series.
+   * 
+   * @param key Key.
+   * @param log Whether to log the operation in the WAL.
+   * 
+   * @throw std::runtime_error If the removal fails, as given by
+   * LSMTree::remove().
+   */
+  void remove(const key_type& key, bool log = true) {
+    shard_of(key).remove(key, log);
+  }
+
+  /**
+   * @brief Remove a range of keys from every shard.
+   * 
+   * @param range_tombstone Range tombstone.
+   * @param log Whether to log the operation in the WAL.
+   * 
+   * @throw std::runtime_error If writing the WAL of a shard fails.
+   */
+  void removeRange(const RangeTombstone& range_tombstone, bool log = true) {
+    for (auto& shard : shards_) {
+      shard.removeRange(range_tombstone, log);
+    }
+  }
+
+  /**
+   * @brief Write a batch of entries, split between the shards of their
+   * series.
+   * @details The entries of each shard keep their order, so a bulk load
+   * into the sharded LSM tree is a bulk load into every shard that gets at
+   * least a memtable's worth of its entries.
+   * 
+   * @param entries Entries.
+   * @param log Whether to log the entries in the WAL.
+   * 
+   * @throw std::runtime_error If writing a shard fails, as given by
+   * LSMTree::putBatch().
+   */
+  void putBatch(
+    std::span<const TimeSeriesEntry<TValue>> entries,
+    bool log = true
+  ) {
+    if (shards_.size() == 1) {
+      shards_.front().putBatch(entries, log);
+      return;
+    }
+    std::vector<std::vector<TimeSeriesEntry<TValue>>> batches(shards_.size());
+    for (const auto& entry : entries) {
+      batches[shardIndex(entry.first, shards_.size())].push_back(entry);
+    }
+    for (size_type i{0}; i < shards_.size(); ++i) {
+      if (!batches[i].empty()) {
+        shards_[i].putBatch(batches[i], log);
+      }
+    }
+  }
+
+  /**
+   * @brief Get a value from the shard of its series.
+   * 
+   * @param key Key.
+   * @return mapped_type The value if it exists and is within the retention.
+   * @throw std::runtime_error If reading an SSTable fails, as given by
+   * LSMTree::get().
+   */
+  [[nodiscard]] mapped_type get(const key_type& key) const {
+    return shard_of(key).get(key);
+  }
+
+  /**
+   * @brief Replay the WAL of every shard.
+   * @details Shards are replayed concurrently, each on its own thread.
+   * 
+   * @throw std::runtime_error If replaying a shard fails, as given by
+   * LSMTree::replayWAL().
+   */
+  void replayWAL() {
+    if (shards_.size() == 1) {
+      shards_.front().replayWAL();
+      return;
+    }
+    std::vector<std::exception_ptr> errors(shards_.size());
+    {
+      std::vector<std::jthread> replays;
+      replays.reserve(shards_.size());
+      for (size_type i{0}; i < shards_.size(); ++i) {
+        replays.emplace_back([this, &errors, i] {
+          try {
+            shards_[i].replayWAL();
+          } catch (...) {
+            errors[i] = std::current_exception();
+          }
+        });
+      }
+    }
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  /**
+   * @brief Commit and sync the WAL of every shard.
+   * 
+   * @throw std::runtime_error If a WAL cannot be written or synced.
+   */
+  void syncWAL() {
+    for (auto& shard : shards_) {
+      shard.syncWAL();
+    }
+  }
+
+  /**
+   * @brief Write a checkpoint of every shard, laid out as the shards are.
+   * @details Each shard is cut at its own LSN, one after another, as given
+   * by LSMTree::checkpoint().
+   * 
+   * @param directory Directory of the checkpoint, which is created if it
+   * does not exist.
+   * @return std::vector<uint64_t> LSN of the next WAL record of each shard.
+   * 
+   * @throw std::runtime_error If the directory is not empty, or if a file
+   * cannot be written or copied.
+   * @throw std::filesystem::filesystem_error If a directory cannot be
+   * created, or a file can be neither linked nor copied.
+   */
+  std::vector<uint64_t> checkpoint(const FilePath& directory) {
+    if (shards_.size() == 1) {
+      return {shards_.front().checkpoint(directory)};
+    }
+    std::filesystem::create_directories(directory);
+    if (!std::filesystem::is_empty(directory)) {
+      throw std::runtime_error{
+        "ShardedLSMTree::checkpoint(): Directory " + std::string(directory)
+        + " is not empty."
+      };
+    }
+    std::vector<uint64_t> lsns;
+    lsns.reserve(shards_.size());
+    for (size_type i{0}; i < shards_.size(); ++i) {
+      lsns.push_back(shards_[i].checkpoint(
+        directory / (SHARD_DIRECTORY_PREFIX + std::to_string(i))
+      ));
+    }
+    return lsns;
+  }
+
+  /**
+   * @brief Wait for the background compaction of every shard to catch up.
+   * 
+   * @throw std::exception If a background compaction failed.
+   */
+  void waitForCompaction() {
+    for (auto& shard : shards_) {
+      shard.waitForCompaction();
+    }
+  }
+
+  /**
+   * @brief Check if every shard is empty.
+   * 
+   * @return true if the sharded LSM tree is empty.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return std::ranges::all_of(shards_, [](const auto& shard) {
+      return shard.empty();
+    });
+  }
+
+  /**
+   * @brief Get the options of the sharded LSM tree.
+   * 
+   * @return LSMTreeOptions Options.
+   */
+  [[nodiscard]] LSMTreeOptions options() const noexcept {
+    return shards_.front().options();
+  }
+
+  /**
+   * @brief Get the stats of the sharded LSM tree.
+   * 
+   * @return StorageStats Sum of the stats of the shards.
+   */
+  [[nodiscard]] StorageStats stats() const {
+    StorageStats stats;
+    for (const auto& shard : shards_) {
+      stats += shard.stats();
+    }
+    return stats;
+  }
+
+  /**
+   * @brief Get the memory held by the sharded LSM tree.
+   * 
+   * @return MemoryUsage Sum of the usage of the shards.
+   */
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    MemoryUsage usage;
+    for (const auto& shard : shards_) {
+      usage += shard.memoryUsage();
+    }
+    return usage;
+  }
+
+  /**
+   * @brief Get the epoch of the memory manager at the last read or write.
+   * 
+   * @return size_type Latest epoch of the shards.
+   */
+  [[nodiscard]] size_type lastAccess() const noexcept {
+    size_type last_access{0};
+    for (const auto& shard : shards_) {
+      last_access = std::max(last_access, shard.lastAccess());
+    }
+    return last_access;
+  }
+
+  /**
+   * @brief Flush the memtable of every shard before it is full.
+   * 
+   * @throw std::runtime_error If writing an SSTable or compaction fails.
+   */
+  void flushMemTable() {
+    for (auto& shard : shards_) {
+      shard.flushMemTable();
+    }
+  }
+
+  /**
+   * @brief Release the read cache and Bloom filters of every shard.
+   * 
+   */
+  void releaseMemory() const noexcept {
+    for (const auto& shard : shards_) {
+      shard.releaseMemory();
+    }
+  }
+
+  /**
+   * @brief Get the number of shards.
+   * 
+   * @return size_type Number of shards.
+   */
+  [[nodiscard]] size_type shardCount() const noexcept {
+    return shards_.size();
+  }
+
+  /**
+   * @brief Get a shard.
+   * 
+   * @param i Shard index.
+   * @return LSMTree<TValue>& Shard.
+   * 
+   * @throw std::out_of_range If the shard index is out of range.
+   */
+  [[nodiscard]] LSMTree<TValue>& shard(size_type i) {
+    if (i >= shards_.size()) {
+      throw std::out_of_range{
+        "ShardedLSMTree::shard(): Shard index out of range."
+      };
+    }
+    return shards_[i];
+  }
+
+  /**
+   * @brief Get pointers to every shard, in order of shard index.
+   * 
+   * @return std::vector<LSMTree<TValue>*> Shards.
+   */
+  [[nodiscard]] std::vector<LSMTree<TValue>*> shards() noexcept {
+    std::vector<LSMTree<TValue>*> shards;
+    shards.reserve(shards_.size());
+    for (auto& shard : shards_) {
+      shards.push_back(&shard);
+    }
+    return shards;
+  }
+
+private:
+  /**
+   * @brief Get the shard that holds the series of a key.
+   * 
+   * @param key Key.
+   * @return LSMTree<TValue>& Shard.
+   */
+  [[nodiscard]] LSMTree<TValue>& shard_of(const key_type& key) noexcept {
+    return shards_[shardIndex(key, shards_.size())];
+  }
+
+  /**
+   * @brief Get the shard that holds the series of a key.
+   * 
+   * @param key Key.
+   * @return const LSMTree<TValue>& Shard.
+   */
+  [[nodiscard]] const LSMTree<TValue>& shard_of(
+    const key_type& key
+  ) const noexcept {
+    return shards_[shardIndex(key, shards_.size())];
+  }
+
+  /**
+   * @brief Shards, in order of shard index.
+   * 
+   */
+  std::vector<LSMTree<TValue>> shards_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_SHARDED_LSM_TREE_H
@@ -0,0 +1,276 @@
+#ifndef STORAGE_SKETCH_H
+#define STORAGE_SKETCH_H
+
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Mergeable sketch of a distribution, answering quantiles with a
+ * bounded relative error.
+ * @details A DDSketch: each non-zero value falls into a logarithmically-sized
+ * bucket of its magnitude, one store for positive values and one for
+ * negative values, so a quantile is within the relative accuracy of the
+ * true value. Sketches with the same relative accuracy are merged by adding
+ * their bucket counts. Once a store holds more than MAX_BUCKETS buckets, its
+ * lowest-magnitude buckets are collapsed into one, which only loses accuracy
+ * for values very close to zero. The exact minimum and maximum are kept
+ * too, and estimates are clamped to them.
+ * 
+ */
+class QuantileSketch {
+public:
+  using size_type = uint64_t;
+  using index_type = int32_t;
+
+  /**
+   * @brief Default relative accuracy.
+   * 
+   */
+  static constexpr double DEFAULT_RELATIVE_ACCURACY{0.01};
+
+  /**
+   * @brief Maximum number of buckets in each store.
+   * 
+   */
+  static constexpr size_type MAX_BUCKETS{2'048};
+
+  /**
+   * @brief Construct a new QuantileSketch object given its relative accuracy.
+   * 
+   * @param relative_accuracy Relative accuracy.
+   * 
+   * @throw std::invalid_argument If the relative accuracy is not in (0, 1).
+   */
+  explicit QuantileSketch(
+    double relative_accuracy = DEFAULT_RELATIVE_ACCURACY
+  );
+
+  /**
+   * @brief Add a value.
+   * 
+   * @param value Value.
+   */
+  void add(double value);
+
+  /**
+   * @brief Merge another sketch into this one.
+   * 
+   * @param other Sketch.
+   * 
+   * @throw std::invalid_argument If the relative accuracies differ.
+   */
+  void merge(const QuantileSketch& other);
+
+  /**
+   * @brief Get the value at a quantile.
+   * @details Quantiles 0 and 1 are the exact minimum and maximum.
+   * 
+   * @param quantile Quantile, in [0, 1].
+   * @return double Value, within the relative accuracy of the value at the
+   * quantile.
+   * 
+   * @throw std::invalid_argument If the quantile is not in [0, 1].
+   * @throw std::runtime_error If the sketch is empty.
+   */
+  [[nodiscard]] double quantile(double quantile) const;
+
+  /**
+   * @brief Get the number of values.
+   * 
+   * @return size_type Number of values.
+   */
+  [[nodiscard]] size_type count() const noexcept;
+
+  /**
+   * @brief Get the relative accuracy.
+   * 
+   * @return double Relative accuracy.
+   */
+  [[nodiscard]] double relativeAccuracy() const noexcept;
+
+private:
+  /**
+   * @brief Contiguous bucket counts, starting at some bucket index.
+   * 
+   */
+  struct Store {
+    /**
+     * @brief Add to the count of a bucket.
+     * 
+     * @param index Bucket index.
+     * @param count Count.
+     */
+    void add(index_type index, size_type count);
+
+    /**
+     * @brief Collapse the lowest buckets until at most MAX_BUCKETS remain.
+     * 
+     */
+    void collapse() noexcept;
+
+    /**
+     * @brief Index of the first bucket.
+     * 
+     */
+    index_type offset{0};
+
+    /**
+     * @brief Count of each bucket.
+     * 
+     */
+    std::vector<size_type> counts;
+
+    /**
+     * @brief Total count.
+     * 
+     */
+    size_type total{0};
+  };
+
+  /**
+   * @brief Get the index of the bucket of a positive magnitude.
+   * 
+   * @param magnitude Magnitude.
+   * @return index_type Bucket index.
+   */
+  [[nodiscard]] index_type index_of(double magnitude) const noexcept;
+
+  /**
+   * @brief Get the magnitude that represents a bucket.
+   * 
+   * @param index Bucket index.
+   * @return double Magnitude.
+   */
+  [[nodiscard]] double value_of(index_type index) const noexcept;
+
+  /**
+   * @brief Relative accuracy.
+   * 
+   */
+  double relative_accuracy_;
+
+  /**
+   * @brief Ratio between the bounds of consecutive buckets.
+   * 
+   */
+  double gamma_;
+
+  /**
+   * @brief Natural logarithm of gamma_.
+   * 
+   */
+  double log_gamma_;
+
+  /**
+   * @brief Store of positive values.
+   * 
+   */
+  Store positive_;
+
+  /**
+   * @brief Store of the magnitudes of negative values.
+   * 
+   */
+  Store negative_;
+
+  /**
+   * @brief Number of zeros, including magnitudes too small to bucket.
+   * 
+   */
+  size_type zero_count_{0};
+
+  /**
+   * @brief Minimum value, if there are any values.
+   * 
+   */
+  double min_{0.0};
+
+  /**
+   * @brief Maximum value, if there are any values.
+   * 
+   */
+  double max_{0.0};
+};
+
+/**
+ * @brief Mergeable sketch of a set, answering its number of distinct elements
+ * approximately.
+ * @details A HyperLogLog with 2^PRECISION one-byte registers, using the
+ * linear counting estimate while many registers are still empty. The
+ * standard error is about 1.04 / sqrt(2^PRECISION), so 0.8% by default.
+ * Sketches are merged by taking the maximum of each register.
+ * 
+ */
+class DistinctSketch {
+public:
+  using size_type = uint64_t;
+  using hash_type = uint64_t;
+
+  /**
+   * @brief Number of bits of the hash that pick a register.
+   * 
+   */
+  static constexpr size_type PRECISION{14};
+
+  /**
+   * @brief Number of registers.
+   * 
+   */
+  static constexpr size_type REGISTER_COUNT{size_type{1} << PRECISION};
+
+  /**
+   * @brief Construct a new, empty DistinctSketch object.
+   * 
+   */
+  DistinctSketch();
+
+  /**
+   * @brief Add an element given its 64-bit hash.
+   * 
+   * @param hash Hash.
+   */
+  void addHash(hash_type hash) noexcept;
+
+  /**
+   * @brief Add a value.
+   * @details Zeros of either sign are the same element.
+   * 
+   * @param value Value.
+   */
+  void add(double value) noexcept;
+
+  /**
+   * @brief Add a string.
+   * 
+   * @param str String.
+   */
+  void add(std::string_view str) noexcept;
+
+  /**
+   * @brief Merge another sketch into this one.
+   * 
+   * @param other Sketch.
+   */
+  void merge(const DistinctSketch& other) noexcept;
+
+  /**
+   * @brief Estimate the number of distinct elements.
+   * 
+   * @return size_type Estimate.
+   */
+  [[nodiscard]] size_type estimate() const noexcept;
+
+private:
+  /**
+   * @brief Registers, each the maximum rank seen among the hashes that
+   * picked it.
+   * 
+   */
+  std::vector<uint8_t> registers_;
+};
+}  // namespace vkdb
+
+#endif // STORAGE_SKETCH_H
@@ -3,15 +3,35 @@
 
 #include <vkdb/time_series_key.h>
 #include <vkdb/bloom_filter.h>
+#include <vkdb/block_stats.h>
+#include <vkdb/block_codec.h>
+#include <vkdb/key_predicate.h>
+#include <vkdb/series_summary.h>
 #include <vkdb/data_range.h>
 #include <vkdb/mem_table.h>
+#include <vkdb/range_tombstone.h>
 #include <vkdb/concepts.h>
 #include <vkdb/string.h>
+#include <vkdb/binary.h>
+#include <vkdb/mapped_file.h>
+#include <vkdb/compression.h>
+#include <vkdb/block_cache.h>
+#include <vkdb/io_backend.h>
+#include <vkdb/io_scheduler.h>
+#include <vkdb/storage_stats.h>
+#include <atomic>
 #include <string>
+#include <string_view>
+#include <span>
 #include <fstream>
-#include <sys/mman.h>
-#include <fcntl.h>
-#include <unistd.h>
+#include <sstream>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace vkdb {
 /**
@@ -20,6 +40,76 @@ namespace vkdb {
  */
 using FilePath = std::filesystem::path;
 
+/**
+ * @brief On-disk format of an SSTable's data file.
+ * @details TEXT is the legacy `[key|value]` encoding, which is still readable
+ * for migration. BINARY is the versioned, block-based encoding that all new
+ * SSTables are written in; its blocks are columnar from version 2 on, and
+ * may be compressed from version 3 on.
+ * 
+ */
+enum class SSTableFormat {
+  TEXT,
+  BINARY
+};
+
+/**
+ * @brief Options for writing an SSTable.
+ * 
+ */
+struct SSTableOptions {
+  /**
+   * @brief Whether to keep the statistics of each series over the whole
+   * SSTable.
+   * 
+   */
+  bool keep_rollup{false};
+
+  /**
+   * @brief Codec of the data blocks.
+   * @details Blocks that do not shrink are stored uncompressed.
+   * 
+   */
+  Compression compression{Compression::NONE};
+
+  /**
+   * @brief Cache of decoded blocks, or null for none.
+   * 
+   */
+  std::shared_ptr<BlockCache> block_cache{};
+
+  /**
+   * @brief False positive rate of the Bloom filter.
+   * 
+   */
+  double bloom_filter_false_positive_rate{0.01};
+
+  /**
+   * @brief Whether to sync the data and metadata files to disk once written.
+   * 
+   */
+  bool sync{false};
+
+  /**
+   * @brief Backend that writes the data and metadata files.
+   * 
+   */
+  IOBackend io_backend{IOBackend::POSIX};
+
+  /**
+   * @brief Scheduler that grants the writes of the data and metadata files,
+   * or null to write them at once.
+   * 
+   */
+  std::shared_ptr<IOScheduler> io_scheduler{};
+
+  /**
+   * @brief Priority class of the writes.
+   * 
+   */
+  IOPriority io_priority{IOPriority::FLUSH};
+};
+
 /**
  * @brief Sorted string table for storing key-value pairs.
  * 
@@ -34,11 +124,142 @@ public:
   using size_type = uint64_t;
 
   /**
-   * @brief False positive rate for the Bloom filters.
+   * @brief False positive rate for the Bloom filters rebuilt on load.
+   * @details Written SSTables take theirs from SSTableOptions.
    * 
    */
   static constexpr double BLOOM_FILTER_FALSE_POSITIVE_RATE{0.01};
 
+  /**
+   * @brief Magic bytes at the start of a binary SSTable data file.
+   * 
+   */
+  static constexpr std::string_view BINARY_FORMAT_MAGIC{"VKDBSST\0", 8};
+
+  /**
+   * @brief Version of the binary SSTable format.
+   * @details Blocks are encoded by BlockEncoder, and their payload starts
+   * with the codec they are compressed with.
+   * 
+   */
+  static constexpr uint32_t BINARY_FORMAT_VERSION{3};
+
+  /**
+   * @brief Version of the binary SSTable format whose columnar blocks are
+   * never compressed.
+   * @details Still readable, but no longer written.
+   * 
+   */
+  static constexpr uint32_t COLUMNAR_FORMAT_VERSION{2};
+
+  /**
+   * @brief Version of the binary SSTable format whose blocks hold whole
+   * binary entries back to back.
+   * @details Still readable, but no longer written.
+   * 
+   */
+  static constexpr uint32_t ROW_FORMAT_VERSION{1};
+
+  /**
+   * @brief Size of the binary file header in bytes.
+   * @details Magic bytes, format version, and value width.
+   * 
+   */
+  static constexpr size_type FILE_HEADER_SIZE{
+    BINARY_FORMAT_MAGIC.size() + 2 * sizeof(uint32_t)
+  };
+
+  /**
+   * @brief Size of the header of a compressed block payload in bytes.
+   * @details Codec and decompressed size. Uncompressed payloads only have
+   * the codec.
+   * 
+   */
+  static constexpr size_type COMPRESSED_HEADER_SIZE{
+    sizeof(uint8_t) + sizeof(uint32_t)
+  };
+
+  /**
+   * @brief Size of a binary block header in bytes.
+   * @details Number of entries and payload size of the block.
+   * 
+   */
+  static constexpr size_type BLOCK_HEADER_SIZE{2 * sizeof(uint32_t)};
+
+  /**
+   * @brief Target payload size of a data block in bytes.
+   * 
+   */
+  static constexpr size_type BLOCK_SIZE{4096};
+
+  /**
+   * @brief Maximum number of entries in a data block.
+   * @details Keeps blocks of well-compressed entries small enough for their
+   * token masks and statistics to be selective.
+   * 
+   */
+  static constexpr uint32_t BLOCK_MAX_ENTRIES{512};
+
+  /**
+   * @brief Number of entries per index entry for legacy text SSTables.
+   * @details Text entries are stored back to back, so the per-entry index of
+   * a legacy metadata file is thinned out to one index entry per run.
+   * 
+   */
+  static constexpr uint32_t TEXT_INDEX_INTERVAL{64};
+
+  /**
+   * @brief Tag of the metadata line that precedes a binary Bloom filter.
+   * @details The line is followed by the given number of raw bytes. Legacy
+   * metadata has a textual Bloom filter line instead, which starts with a
+   * digit.
+   * 
+   */
+  static constexpr std::string_view BLOOM_FILTER_TAG{"BLOOM"};
+
+  /**
+   * @brief Tag of the metadata line that precedes the binary index.
+   * @details The line is followed by the given number of raw bytes. Legacy
+   * metadata has the number of index entries instead, followed by one text
+   * line per entry.
+   * 
+   */
+  static constexpr std::string_view INDEX_TAG{"INDEX"};
+
+  /**
+   * @brief Tag of the metadata line that precedes a binary series summary.
+   * @details The line is followed by the given number of raw bytes. Legacy
+   * metadata has no summary, so the SSTable may match any predicate.
+   * 
+   */
+  static constexpr std::string_view SERIES_SUMMARY_TAG{"SUMMARY"};
+
+  /**
+   * @brief Tag of the metadata line that precedes the binary block
+   * statistics.
+   * @details The line is followed by the given number of raw bytes. Legacy
+   * metadata has no statistics, so every block has to be read.
+   * 
+   */
+  static constexpr std::string_view BLOCK_STATS_TAG{"STATS"};
+
+  /**
+   * @brief Tag of the metadata line that precedes the binary rollup.
+   * @details The line is followed by the given number of raw bytes. Only
+   * SSTables written with a rollup have the section.
+   * 
+   */
+  static constexpr std::string_view ROLLUP_TAG{"ROLLUP"};
+
+  /**
+   * @brief Tag of the metadata line that precedes the range tombstones.
+   * @details The line is followed by the given number of bytes, which hold
+   * one tombstone string per line. Only SSTables flushed from a memtable
+   * with range tombstones have the section.
+   * 
+   */
+  static constexpr std::string_view RANGE_TOMBSTONES_TAG{"TOMBSTONES"};
+
   /**
    * @brief Deleted default constructor.
    * 
@@ -49,19 +270,25 @@ public:
    * @brief Construct a new SSTable object given a file path.
    * 
    * @param file_path Path.
+   * @param block_cache Cache of decoded blocks, or null for none.
    * 
    * @throws std::runtime_error If metadata loading fails.
    */
-  explicit SSTable(FilePath file_path)
+  explicit SSTable(
+    FilePath file_path,
+    std::shared_ptr<BlockCache> block_cache = nullptr
+  )
     : file_path_{file_path}
-    , bloom_filter_{
+    , bloom_filter_{std::make_shared<BloomFilter>(
         MemTable<TValue>::C0_LAYER_SSTABLE_MAX_ENTRIES,
         BLOOM_FILTER_FALSE_POSITIVE_RATE
-      }
+      )}
+    , block_cache_{std::move(block_cache)}
   {
     if (!std::filesystem::exists(file_path_)) {
       return;
     }
+    format_ = detect_format();
     load_metadata();
   }
   
@@ -70,34 +297,92 @@ public:
    * 
    * @param file_path Path.
    * @param mem_table Memtable.
+   * @param expected_entries Expected number of entries.
+   * @param options Options.
    * 
-   * @throws std::runtime_error If writing data to disk fails.
+   * @throws std::invalid_argument If the codec is not available.
+   * @throws std::runtime_error If writing data to disk or syncing it fails.
    */
   explicit SSTable(
     FilePath file_path,
-    MemTable<TValue>&& mem_table,
-    size_type expected_entries = MemTable<TValue>::C0_LAYER_SSTABLE_MAX_ENTRIES
+    const MemTable<TValue>& mem_table,
+    size_type expected_entries = MemTable<TValue>::C0_LAYER_SSTABLE_MAX_ENTRIES,
+    SSTableOptions options = {}
   )
     : file_path_{file_path}
-    , bloom_filter_{
+    , bloom_filter_{std::make_shared<BloomFilter>(
         expected_entries,
-        BLOOM_FILTER_FALSE_POSITIVE_RATE
-      }
+        options.bloom_filter_false_positive_rate
+      )}
+    , keep_rollup_{options.keep_rollup}
+    , compression_{options.compression}
+    , block_cache_{std::move(options.block_cache)}
     {
-      writeDataToDisk(std::move(mem_table));
+      writeDataToDisk(
+        mem_table,
+        options.io_backend,
+        options.sync,
+        options.io_scheduler.get(),
+        options.io_priority
+      );
     }
 
   /**
    * @brief Move-construct a SSTable object.
+   * @details The moved-from SSTable is no longer marked as obsolete.
    * 
    */
-  SSTable(SSTable&&) noexcept = default;
+  SSTable(SSTable&& other) noexcept
+    : bloom_filter_{other.bloom_filter_.exchange(nullptr)}
+    , series_summary_{std::move(other.series_summary_)}
+    , series_keys_{std::move(other.series_keys_)}
+    , block_stats_{std::move(other.block_stats_)}
+    , rollup_{std::move(other.rollup_)}
+    , range_tombstones_{std::move(other.range_tombstones_)}
+    , keep_rollup_{other.keep_rollup_}
+    , compression_{other.compression_}
+    , block_cache_{std::move(other.block_cache_)}
+    , cache_owner_{other.cache_owner_}
+    , time_range_{std::move(other.time_range_)}
+    , key_range_{std::move(other.key_range_)}
+    , index_{std::move(other.index_)}
+    , file_path_{std::move(other.file_path_)}
+    , format_{other.format_}
+    , format_version_{other.format_version_}
+    , mapped_file_{std::move(other.mapped_file_)}
+    , mapping_mutex_{std::move(other.mapping_mutex_)}
+    , obsolete_{std::exchange(other.obsolete_, false)} {}
   
   /**
    * @brief Move-assign a SSTable object.
+   * @details Removes the files of this SSTable first if it is obsolete.
    * 
    */
-  SSTable& operator=(SSTable&&) noexcept = default;
+  SSTable& operator=(SSTable&& other) noexcept {
+    if (this != &other) {
+      remove_files_if_obsolete();
+      bloom_filter_.store(other.bloom_filter_.exchange(nullptr));
+      series_summary_ = std::move(other.series_summary_);
+      series_keys_ = std::move(other.series_keys_);
+      block_stats_ = std::move(other.block_stats_);
+      rollup_ = std::move(other.rollup_);
+      range_tombstones_ = std::move(other.range_tombstones_);
+      keep_rollup_ = other.keep_rollup_;
+      compression_ = other.compression_;
+      block_cache_ = std::move(other.block_cache_);
+      cache_owner_ = other.cache_owner_;
+      time_range_ = std::move(other.time_range_);
+      key_range_ = std::move(other.key_range_);
+      index_ = std::move(other.index_);
+      file_path_ = std::move(other.file_path_);
+      format_ = other.format_;
+      format_version_ = other.format_version_;
+      mapped_file_ = std::move(other.mapped_file_);
+      mapping_mutex_ = std::move(other.mapping_mutex_);
+      obsolete_ = std::exchange(other.obsolete_, false);
+    }
+    return *this;
+  }
 
   /**
    * @brief Deleted copy constructor.
@@ -113,9 +398,13 @@ public:
 
   /**
    * @brief Destroy the SSTable object.
+   * @details Removes the data and metadata files if the SSTable has been
+   * marked as obsolete.
    * 
    */
-  ~SSTable() noexcept = default;
+  ~SSTable() noexcept {
+    remove_files_if_obsolete();
+  }
 
   [[nodiscard]] bool operator==(const SSTable& other) const noexcept {
     return file_path_ == other.file_path_;
@@ -123,15 +412,28 @@ public:
 
   /**
    * @brief Write data to disk.
-   * @details Saves the memtable to disk and saves the metadata.
+   * @details Saves the memtable to disk and saves the metadata, along with
+   * the memtable's range tombstones.
    * 
    * @param mem_table Memtable.
+   * @param io_backend Backend that writes the files.
+   * @param sync Whether to sync the files to disk once written.
+   * @param io_scheduler Scheduler that grants the writes, or null to write
+   * them at once.
+   * @param io_priority Priority class of the writes.
    * 
    * @throws std::runtime_error If saving the memtable or metadata fails.
    */
-  void writeDataToDisk(MemTable<TValue>&& mem_table) {
-    save_memtable(std::move(mem_table));
-    save_metadata();
+  void writeDataToDisk(
+    const MemTable<TValue>& mem_table,
+    IOBackend io_backend = IOBackend::POSIX,
+    bool sync = false,
+    IOScheduler* io_scheduler = nullptr,
+    IOPriority io_priority = IOPriority::FLUSH
+  ) {
+    range_tombstones_ = mem_table.rangeTombstones();
+    save_memtable(mem_table, io_backend, sync, io_scheduler, io_priority);
+    save_metadata(io_backend, sync, io_scheduler, io_priority);
   }
 
   /**
@@ -140,50 +442,100 @@ public:
    * @param key Key.
    * @return true if the SSTable may contain the key.
    * @return false if the SSTable does not contain the key.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
    */
-  [[nodiscard]] bool contains(const key_type& key) const noexcept {
+  [[nodiscard]] bool contains(const key_type& key) const {
     return may_contain(key) && in_range(key) && in_index(key);
   }
 
+  /**
+   * @brief Check if the SSTable may contain each of a batch of pre-hashed
+   * keys.
+   * @details Only consults the Bloom filter.
+   * 
+   * @param hashes Hashes of the keys, as given by BloomFilter::hash().
+   * @param results Whether the SSTable may contain each key.
+   */
+  void mayContainBatch(
+    std::span<const BloomFilter::hash_type> hashes,
+    std::span<bool> results
+  ) const noexcept {
+    const auto filter{bloom_filter()};
+    if (!filter) {
+      std::ranges::fill(
+        results.first(std::min(hashes.size(), results.size())),
+        true
+      );
+      return;
+    }
+    filter->mayContainBatch(hashes, results);
+  }
+
+  /**
+   * @brief Check if any key of the SSTable may match a predicate.
+   * @details Only consults the series summary and the time range.
+   * 
+   * @param predicate Predicate.
+   * @return true if a key may match the predicate.
+   * @return false if no key matches the predicate.
+   */
+  [[nodiscard]] bool mayMatch(const KeyPredicate& predicate) const noexcept {
+    return predicate.mayMatch(series_summary_, time_range_);
+  }
+
   /**
    * @brief Get the value associated with a key.
    * 
    * @param key Key.
+   * @param metrics Metrics to count the Bloom filter outcome in, or null.
    * @return mapped_type The value if it exists, std::nullopt otherwise.
    * 
    * @throws std::runtime_error If the position is invalid or the key does not match
    * the entry read.
    */
-  [[nodiscard]] mapped_type get(const key_type& key) const {
-    if (!contains(key)) {
+  [[nodiscard]] mapped_type get(
+    const key_type& key,
+    StorageMetrics* metrics = nullptr
+  ) const {
+    return find(key, metrics).value_or(std::nullopt);
+  }
+
+  /**
+   * @brief Find the entry of a key.
+   * @details Unlike get(), this tells a removal apart from a missing key.
+   * Keys within the range of the SSTable are tested against its Bloom
+   * filter, and the outcome is counted in the metrics, if any.
+   * 
+   * @param key Key.
+   * @param metrics Metrics to count the Bloom filter outcome in, or null.
+   * @return std::optional<mapped_type> The stored value if the key is in the
+   * SSTable, which is std::nullopt for a removal, and std::nullopt otherwise.
+   * 
+   * @throws std::runtime_error If the position is invalid or the key does not match
+   * the entry read.
+   */
+  [[nodiscard]] std::optional<mapped_type> find(
+    const key_type& key,
+    StorageMetrics* metrics = nullptr
+  ) const {
+    if (!in_range(key)) {
       return std::nullopt;
     }
-
-    std::ifstream file{file_path_};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "SSTable::get(): Unable to open file '"
-        + std::string(file_path_) + "'."
-      };
+    if (!may_contain(key)) {
+      if (metrics != nullptr) {
+        metrics->bloom_negatives.add();
+      }
+      return std::nullopt;
     }
-
-    file.seekg(index_.at(key));
-    if (!file) {
-      throw std::runtime_error{
-        "SSTable::get(): Unable to seek to position "
-        + std::to_string(index_.at(key)) + " in file '"
-        + std::string(file_path_) + "'."
-      };
+    auto value{lookup(key)};
+    if (metrics != nullptr) {
+      (value.has_value()
+        ? metrics->bloom_true_positives
+        : metrics->bloom_false_positives).add();
     }
-
-    std::string entry_str;
-    std::getline(file, entry_str, '[');
-    std::getline(file, entry_str, '[');
-    auto [entry_key, entry_value] = entryFromString<TValue>(std::move(entry_str));
-
-    file.close();
-
-    return entry_value;
+    return value;
   }
 
   /**
@@ -192,46 +544,75 @@ public:
    * @param start Start timestamp.
    * @param end End timestamp.
    * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
    */
   [[nodiscard]] std::vector<value_type> getRange(
     const key_type& start,
     const key_type& end
-  ) const noexcept {
+  ) const {
     if (!overlaps_with(start, end)) {
       return {};
     }
 
-    auto start_it{index_.lower_bound(start)};
-    auto end_it{index_.upper_bound(end)};
-    if (start_it == end_it) {
-      return {};
-    }
+    return read_entries(start, end);
+  }
 
-    std::vector<value_type> entries;
-    entries.reserve(std::distance(start_it, end_it));
+  /**
+   * @brief Pull-based cursor over the entries of an SSTable in a key range.
+   * 
+   */
+  class Cursor;
 
-    std::ifstream file{file_path_, std::ios::binary};
-    for (auto it{start_it}; it != end_it; ++it) {
-      const auto& [key, pos] = *it;
-      file.seekg(pos);
-      std::string entry_str;
-      std::getline(file, entry_str, '[');
-      std::getline(file, entry_str, '[');
-      auto [entry_key, entry_value] 
-        = entryFromString<TValue>(std::move(entry_str));
-      entries.emplace_back(entry_key, entry_value);
-    }
-    
-    return entries;
+  /**
+   * @brief Get a cursor over the entries in a key range.
+   * @details Entries are decoded one at a time as the cursor advances. The
+   * cursor keeps the data file mapped, but must not outlive the SSTable.
+   * Given a predicate, the cursor skips the blocks whose token masks rule it
+   * out; the entries it does yield must still be checked against it.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @param predicate Predicate, or null to read every block.
+   * @param use_block_cache Whether to read through the block cache.
+   * @return Cursor Cursor positioned at the first entry in the range.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  [[nodiscard]] Cursor cursor(
+    const key_type& start,
+    const key_type& end,
+    std::shared_ptr<const KeyPredicate> predicate = nullptr,
+    bool use_block_cache = true
+  ) const {
+    return Cursor{*this, start, end, std::move(predicate), use_block_cache};
+  }
+
+  /**
+   * @brief Get the key of each series in the SSTable, at timestamp zero.
+   * @details Empty for SSTables whose metadata predates block statistics,
+   * whose series are only known by reading their entries.
+   *
+   * @return const std::vector<key_type>& Keys.
+   */
+  [[nodiscard]] const std::vector<key_type>& seriesKeys() const noexcept {
+    return series_keys_;
   }
 
   /**
    * @brief Get the entries of the SSTable.
+   * @details Reads around the block cache, so that whole-table reads such as
+   * compactions do not evict hot blocks.
    * 
    * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
    */
-  [[nodiscard]] std::vector<value_type> entries() const noexcept {
-    return getRange(MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY);
+  [[nodiscard]] std::vector<value_type> entries() const {
+    return read_entries(MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, false);
   }
 
   /**
@@ -272,164 +653,1121 @@ public:
     return time_range_;
   }
 
-private:
   /**
-   * @brief Type alias for ordered mapping of keys to stream positions.
+   * @brief Get the time range of the entries and range tombstones of the
+   * SSTable.
    * 
+   * @return TimeRange Time range, which is not set if the SSTable has
+   * neither.
    */
-  using Index = std::map<const key_type, std::streampos>;
+  [[nodiscard]] TimeRange coveredTimeRange() const noexcept {
+    auto time_range{time_range_};
+    for (const auto& tombstone : range_tombstones_) {
+      time_range.updateRange(tombstone.start());
+      time_range.updateRange(tombstone.end());
+    }
+    return time_range;
+  }
 
   /**
-   * @brief Update the metadata with a key and stream position.
+   * @brief Get the time windows that hold the entries of the SSTable.
+   * @details Runs whose bounds lie within one window are taken whole from the
+   * index, and only the entries of runs that straddle windows are read, so a
+   * few late entries cost one run's worth of decoding. Range tombstones are
+   * not included.
    * 
-   * @param key Key.
-   * @param pos Stream position.
+   * @param window_size Window size, which must be at least 1.
+   * @return std::vector<Timestamp> Start of each window, in order.
    * 
-   * @throws std::exception If inserting to index fails.
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
    */
-  void update_metadata(const key_type& key, std::streampos pos) {
-    time_range_.updateRange(key.timestamp());
-    key_range_.updateRange(key);
-    bloom_filter_.insert(key);
-    index_.emplace(key, pos);
+  [[nodiscard]] std::vector<Timestamp> timeWindows(
+    Timestamp window_size
+  ) const {
+    std::vector<Timestamp> windows;
+    const auto add_window{[&](Timestamp timestamp) {
+      const auto window{(timestamp / window_size) * window_size};
+      if (windows.empty() || windows.back() != window) {
+        windows.push_back(window);
+      }
+    }};
+    Cursor it{*this, MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, nullptr, false};
+    while (it.valid()) {
+      const auto bounds{it.runTimeRange()};
+      if (bounds.lower() / window_size == bounds.upper() / window_size) {
+        add_window(bounds.lower());
+        it.skipRun();
+      } else {
+        add_window(it.entry().first.timestamp());
+        it.advance();
+      }
+    }
+    return windows;
   }
 
   /**
-   * @brief Save the memtable to disk.
-   * 
-   * @param mem_table Memtable.
+   * @brief Get the range tombstones of the SSTable.
+   * @details They delete keys in older SSTables, but never the SSTable's own
+   * entries, which are newer.
    * 
-   * @throws std::runtime_error If unable to open file or get current
-   * stream position.
+   * @return const std::vector<RangeTombstone>& Range tombstones, oldest
+   * first.
    */
-  void save_memtable(MemTable<TValue>&& mem_table) {
-    std::ofstream file{file_path_};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "SSTable::save_memtable(): Unable to open file '"
-        + std::string(file_path_) + "'."
-      };
-    }
-
-    file << mem_table.size();
-    for (const auto& [key, value] : mem_table.table()) {
-      auto pos{file.tellp()};
-      if (pos == -1) {
-        throw std::runtime_error{
-          "SSTable::save_memtable(): Unable to get current position "
-          " of filestream for '" + std::string(file_path_) + "'."
-        };
-      }
-      update_metadata(key, pos);
-      file << entryToString<TValue>(value_type{key, value});
-    }
-
-    file.close();
+  [[nodiscard]] const std::vector<RangeTombstone>&
+  rangeTombstones() const noexcept {
+    return range_tombstones_;
   }
 
   /**
-   * @brief Save the metadata to disk.
+   * @brief Check if a range tombstone of the SSTable covers a key.
    * 
-   * @throws std::runtime_error If unable to open file.
+   * @param key Key.
+   * @return true if the key is deleted in older SSTables.
+   * @return false otherwise.
    */
-  void save_metadata() {
-    std::ofstream file{metadataPath()};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "SSTable::save_metadata(): Unable to open file '"
-        + std::string(metadataPath()) + "'."
-      };
-    }
-
-    file << time_range_.str() << "\n";
-    file << key_range_.str() << "\n";
-    file << bloom_filter_.str() << "\n";
-    file << index_.size() << "\n";
-    for (const auto& [key, pos] : index_) {
-      file << key.str() << "^" << pos << "\n";
-    }
-
-    file.close();
+  [[nodiscard]] bool isRangeDeleted(const key_type& key) const noexcept {
+    return std::ranges::any_of(
+      range_tombstones_,
+      [&key](const auto& tombstone) { return tombstone.covers(key); }
+    );
   }
-  
+
   /**
-   * @brief Load the metadata from disk.
+   * @brief Get the on-disk format of the SSTable.
    * 
-   * @throws std::runtime_error If unable to open file or format
-   * is invalid.
+   * @return SSTableFormat Format.
    */
-  void load_metadata() {
-    std::ifstream file{metadataPath()};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "SSTable::load_metadata(): Unable to open file '"
-        + std::string(metadataPath()) + "'."
-      };
-    }
-
-    std::string line;
-    std::getline(file, line);
-    time_range_ = TimeRange{std::move(line)};
-    std::getline(file, line);
-    key_range_ = KeyRange{std::move(line)};
-    std::getline(file, line);
-    bloom_filter_ = BloomFilter{std::move(line)};
-    std::getline(file, line);
-    auto no_of_entries{std::stoull(line)};
-    for (auto i{0}; i < no_of_entries; ++i) {
-      std::getline(file, line);
-      auto caret_pos{line.find('^')};
-      if (caret_pos == std::string::npos) {
-        throw std::runtime_error{
-          "SSTable::load_metadata(): Invalid index entry '" + line + "'."
-        };
-      }
-      key_type key{std::move(line.substr(0, caret_pos))};
-      auto pos{std::stoull(line.substr(caret_pos + 1))};
-      index_.emplace(key, pos);
-    }
-
-    file.close();
+  [[nodiscard]] SSTableFormat format() const noexcept {
+    return format_;
   }
 
   /**
-   * @brief Check if the Bloom filter may contain a key.
+   * @brief Get the number of entries in the sparse index.
+   * @details This is the number of blocks for binary SSTables.
    * 
-   * @param key Key.
-   * @return true if the Bloom filter may contain the key.
-   * @return false if the Bloom filter does not contain the key.
+   * @return size_type Number of index entries.
    */
-  [[nodiscard]] bool may_contain(const key_type& key) const noexcept {
-    return bloom_filter_.mayContain(key);
+  [[nodiscard]] size_type indexSize() const noexcept {
+    return index_.size();
   }
 
   /**
-   * @brief Check if a key is within the valid range.
+   * @brief Get the memory held by the sparse index.
+   * @details Includes the series keys and block statistics, which are
+   * indexed alongside it, but not the heap memory of the keys themselves,
+   * whose series are interned.
    * 
-   * @param key Key.
-   * @return true If the key is within the valid range.
-   * @return false If the key is not within the valid range.
+   * @return size_type Bytes.
    */
-  [[nodiscard]] bool in_range(const key_type& key) const noexcept {
-    return time_range_.inRange(key.timestamp()) && key_range_.inRange(key);
+  [[nodiscard]] size_type indexBytes() const noexcept {
+    return index_.capacity() * sizeof(IndexEntry)
+      + series_keys_.capacity() * sizeof(key_type)
+      + block_stats_.capacity() * sizeof(BlockStats<TValue>);
   }
 
   /**
-   * @brief Check if a key is in the index.
+   * @brief Get the memory held by the Bloom filter.
    * 
-   * @param key Key.
-   * @return true If the key is in the index.
-   * @return false If the key is not in the index.
+   * @return size_type Bytes, or 0 if the Bloom filter is released.
    */
-  [[nodiscard]] bool in_index(const key_type& key) const noexcept {
-    return index_.count(key) > 0;
+  [[nodiscard]] size_type filterBytes() const noexcept {
+    const auto filter{bloom_filter_.load(std::memory_order_acquire)};
+    return filter ? filter->blockCount() * BloomFilter::BLOCK_BITS / 8 : 0;
   }
 
   /**
-   * @brief Check if the SSTable overlaps with the given range.
+   * @brief Release the Bloom filter.
+   * @details The Bloom filter is loaded again from the metadata file on the
+   * next point read. Only SSTables on disk release it, since the others
+   * have nowhere to load it from.
    * 
-   * @param start The start key of the range.
-   * @param end The end key of the range.
+   */
+  void releaseFilter() const noexcept {
+    if (std::filesystem::exists(metadataPath())) {
+      bloom_filter_.store(nullptr, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Check if the SSTable keeps a rollup.
+   * @details The rollup holds the statistics of each series over the whole
+   * SSTable.
+   * 
+   * @return true if the SSTable keeps a rollup.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool hasRollup() const noexcept {
+    return keep_rollup_;
+  }
+
+  /**
+   * @brief Release the memory mapping of the data file.
+   * @details The file is mapped again on the next read. This should be called
+   * before the data file is removed or rewritten.
+   * 
+   */
+  void unmap() const noexcept {
+    std::lock_guard lock{*mapping_mutex_};
+    mapped_file_.reset();
+  }
+
+  /**
+   * @brief Mark the SSTable as obsolete.
+   * @details The files are removed when the SSTable is destroyed, so they
+   * remain readable for as long as anything still holds on to the SSTable.
+   * 
+   */
+  void markObsolete() const noexcept {
+    obsolete_ = true;
+  }
+
+private:
+  /**
+   * @brief Entry of the sparse index.
+   * @details Points at a run of consecutive entries in the data file, and is
+   * keyed by the first key of the run. The token mask is the union of the
+   * token masks of the keys of the run.
+   * 
+   */
+  struct IndexEntry {
+    key_type first_key;
+    size_type offset;
+    uint32_t entry_count;
+    SeriesSummary::mask_type token_mask{SeriesSummary::FULL_MASK};
+  };
+
+  /**
+   * @brief Type alias for the sparse index, sorted by first key.
+   * 
+   */
+  using Index = std::vector<IndexEntry>;
+
+  /**
+   * @brief Token mask and index of a series, while writing an SSTable.
+   * 
+   */
+  struct SeriesInfo {
+    SeriesSummary::mask_type token_mask;
+    uint32_t index;
+  };
+
+  /**
+   * @brief Update the metadata with a key.
+   * 
+   * @param key Key.
+   */
+  void update_metadata(const key_type& key, BloomFilter& bloom_filter) {
+    time_range_.updateRange(key.timestamp());
+    key_range_.updateRange(key);
+    bloom_filter.insert(key);
+    series_summary_.insert(key);
+  }
+
+  /**
+   * @brief Save the memtable to disk.
+   * @details The data file is encoded in memory and written in one go.
+   * 
+   * @param mem_table Memtable.
+   * @param io_backend Backend that writes the file.
+   * @param sync Whether to sync the file to disk once written.
+   * @param io_scheduler Scheduler that grants the write, or null.
+   * @param io_priority Priority class of the write.
+   * 
+   * @throws std::runtime_error If unable to write or sync the file.
+   */
+  void save_memtable(
+    const MemTable<TValue>& mem_table,
+    IOBackend io_backend,
+    bool sync,
+    IOScheduler* io_scheduler,
+    IOPriority io_priority
+  ) {
+    if (!compressionAvailable(compression_)) {
+      throw std::invalid_argument{
+        "SSTable::save_memtable(): Codec is not available."
+      };
+    }
+
+    std::string buffer;
+    append_file_header(buffer);
+
+    index_.clear();
+    series_keys_.clear();
+    block_stats_.clear();
+    rollup_.clear();
+    cache_owner_ = BlockCache::newOwner();
+    BlockEncoder<TValue> block;
+    std::unordered_map<SeriesId, SeriesInfo> series_infos;
+    auto& bloom_filter{*bloom_filter_.load(std::memory_order_relaxed)};
+    mem_table.forEach([&](const auto& key, const auto& value) {
+      update_metadata(key, bloom_filter);
+      if (block.entryCount() == 0) {
+        index_.push_back({key, buffer.size() + BLOCK_HEADER_SIZE, 0, 0});
+        block_stats_.emplace_back();
+      }
+      ++index_.back().entry_count;
+      auto [it, inserted]{series_infos.try_emplace(key.seriesId())};
+      if (inserted) {
+        it->second = {
+          SeriesSummary::keyMask(key),
+          static_cast<uint32_t>(series_keys_.size())
+        };
+        series_keys_.emplace_back(0, key.metric(), key.tags());
+        if (keep_rollup_) {
+          rollup_.emplace_back();
+        }
+      }
+      index_.back().token_mask |= it->second.token_mask;
+      if (value.has_value()) {
+        block_stats_.back().add(it->second.index, value.value());
+        if (keep_rollup_) {
+          rollup_[it->second.index].add(value.value());
+        }
+      }
+      block.add(key, value);
+      if (
+        block.size() >= BLOCK_SIZE ||
+        block.entryCount() == BLOCK_MAX_ENTRIES
+      ) {
+        append_block(buffer, block, compression_);
+      }
+    });
+    if (block.entryCount() > 0) {
+      append_block(buffer, block, compression_);
+    }
+
+    if (io_scheduler != nullptr) {
+      io_scheduler->request(io_priority, buffer.size());
+    }
+    writeFile(io_backend, file_path_, buffer, sync);
+    format_ = SSTableFormat::BINARY;
+    format_version_ = BINARY_FORMAT_VERSION;
+    unmap();
+  }
+
+  /**
+   * @brief Append the binary file header to a buffer.
+   * 
+   * @param buffer Buffer.
+   */
+  static void append_file_header(std::string& buffer) noexcept {
+    buffer.append(BINARY_FORMAT_MAGIC);
+    appendBinary(buffer, BINARY_FORMAT_VERSION);
+    appendBinary(buffer, static_cast<uint32_t>(sizeof(TValue)));
+  }
+
+  /**
+   * @brief Append a block header and payload to a buffer.
+   * @details The payload is the codec, followed by the encoded block if it
+   * is uncompressed, or by its size and the compressed block otherwise.
+   * Resets the block encoder afterwards.
+   * 
+   * @param buffer Buffer.
+   * @param block Block encoder.
+   * @param compression Codec.
+   */
+  static void append_block(
+    std::string& buffer,
+    BlockEncoder<TValue>& block,
+    Compression compression
+  ) {
+    const auto block_entries{block.entryCount()};
+    std::string encoded;
+    block.finish(encoded);
+    std::string payload;
+    if (compression != Compression::NONE) {
+      auto compressed{compress(compression, encoded)};
+      if (compressed.size() + COMPRESSED_HEADER_SIZE < encoded.size() + 1) {
+        appendBinary(payload, static_cast<uint8_t>(compression));
+        appendBinary(payload, static_cast<uint32_t>(encoded.size()));
+        payload.append(compressed);
+      }
+    }
+    if (payload.empty()) {
+      appendBinary(payload, static_cast<uint8_t>(Compression::NONE));
+      payload.append(encoded);
+    }
+    appendBinary(buffer, block_entries);
+    appendBinary(buffer, static_cast<uint32_t>(payload.size()));
+    buffer.append(payload);
+  }
+
+  /**
+   * @brief Create a decoder over the columnar block of a run.
+   * @details Compressed blocks are decompressed into the given buffer, which
+   * must outlive the decoder.
+   * 
+   * @param mapped_file Mapped data file.
+   * @param run Index entry of the run.
+   * @param buffer Buffer.
+   * @return BlockDecoder<TValue> Decoder.
+   * 
+   * @throw std::runtime_error If the block is malformed.
+   */
+  [[nodiscard]] BlockDecoder<TValue> block_decoder(
+    const MappedFile& mapped_file,
+    const IndexEntry& run,
+    std::vector<char>& buffer
+  ) const {
+    const char* end{mapped_file.data() + mapped_file.size()};
+    if (run.offset < BLOCK_HEADER_SIZE || run.offset > mapped_file.size()) {
+      throw std::runtime_error{
+        "SSTable::block_decoder(): Invalid block offset."
+      };
+    }
+    const char* header{
+      mapped_file.data() + run.offset - BLOCK_HEADER_SIZE + sizeof(uint32_t)
+    };
+    const auto payload_size{readBinary<uint32_t>(header, end)};
+    if (payload_size > static_cast<size_type>(end - header)) {
+      throw std::runtime_error{
+        "SSTable::block_decoder(): Block extends past end of file."
+      };
+    }
+    const char* pos{header};
+    end = pos + payload_size;
+    if (format_version_ == COLUMNAR_FORMAT_VERSION) {
+      return BlockDecoder<TValue>{pos, end};
+    }
+
+    const auto compression{
+      static_cast<Compression>(readBinary<uint8_t>(pos, end))
+    };
+    if (compression == Compression::NONE) {
+      return BlockDecoder<TValue>{pos, end};
+    }
+    const auto raw_size{readBinary<uint32_t>(pos, end)};
+    buffer.resize(raw_size);
+    decompress(
+      compression,
+      std::string_view{pos, static_cast<size_t>(end - pos)},
+      buffer
+    );
+    return BlockDecoder<TValue>{buffer.data(), buffer.data() + buffer.size()};
+  }
+
+  /**
+   * @brief Type alias for the decoded entries of a block.
+   * 
+   */
+  using DecodedBlock = std::vector<value_type>;
+
+  /**
+   * @brief Get the decoded entries of the columnar block of a run from the
+   * block cache.
+   * @details The block is decoded and cached on a miss. The SSTable must have
+   * a block cache.
+   * 
+   * @param mapped_file Mapped data file.
+   * @param run Index entry of the run.
+   * @return std::shared_ptr<const DecodedBlock> Decoded entries.
+   * 
+   * @throw std::runtime_error If the block is malformed.
+   */
+  [[nodiscard]] std::shared_ptr<const DecodedBlock> cached_block(
+    const MappedFile& mapped_file,
+    const IndexEntry& run
+  ) const {
+    if (auto block{block_cache_->tryGet(cache_owner_, run.offset)}) {
+      return std::static_pointer_cast<const DecodedBlock>(std::move(block));
+    }
+    std::vector<char> buffer;
+    auto decoder{block_decoder(mapped_file, run, buffer)};
+    auto decoded{std::make_shared<DecodedBlock>()};
+    decoded->reserve(run.entry_count);
+    for (uint32_t i{0}; i < run.entry_count; ++i) {
+      decoded->push_back(decoder.next());
+    }
+    block_cache_->put(
+      cache_owner_,
+      run.offset,
+      decoded,
+      sizeof(DecodedBlock) + decoded->capacity() * sizeof(value_type)
+    );
+    return decoded;
+  }
+
+  /**
+   * @brief Detect the format of the data file.
+   * @details Also reads the version of a binary data file.
+   * 
+   * @return SSTableFormat Format.
+   * 
+   * @throw std::runtime_error If unable to open the file, or if the file is
+   * binary with an unsupported version or value width.
+   */
+  [[nodiscard]] SSTableFormat detect_format() {
+    std::ifstream file{file_path_, std::ios::binary};
+    if (!file.is_open()) {
+      throw std::runtime_error{
+        "SSTable::detect_format(): Unable to open file '"
+        + std::string(file_path_) + "'."
+      };
+    }
+
+    std::string header(FILE_HEADER_SIZE, '\0');
+    file.read(header.data(), header.size());
+    if (
+      file.gcount() != FILE_HEADER_SIZE ||
+      !header.starts_with(BINARY_FORMAT_MAGIC)
+    ) {
+      return SSTableFormat::TEXT;
+    }
+
+    const char* pos{header.data() + BINARY_FORMAT_MAGIC.size()};
+    const char* end{header.data() + header.size()};
+    const auto version{readBinary<uint32_t>(pos, end)};
+    if (version < ROW_FORMAT_VERSION || version > BINARY_FORMAT_VERSION) {
+      throw std::runtime_error{
+        "SSTable::detect_format(): Unsupported format version "
+        + std::to_string(version) + " in file '"
+        + std::string(file_path_) + "'."
+      };
+    }
+    const auto value_width{readBinary<uint32_t>(pos, end)};
+    if (value_width != sizeof(TValue)) {
+      throw std::runtime_error{
+        "SSTable::detect_format(): Value width " + std::to_string(value_width)
+        + " does not match in file '" + std::string(file_path_) + "'."
+      };
+    }
+    format_version_ = version;
+    return SSTableFormat::BINARY;
+  }
+
+  /**
+   * @brief Find the index entry whose run may contain a key.
+   * 
+   * @param key Key.
+   * @return Index::const_iterator Last index entry with a first key not
+   * greater than the key, or the end of the index if there is none.
+   */
+  [[nodiscard]] typename Index::const_iterator find_run(
+    const key_type& key
+  ) const noexcept {
+    auto it{std::upper_bound(
+      index_.begin(),
+      index_.end(),
+      key,
+      [](const auto& target, const auto& entry) {
+        return target < entry.first_key;
+      }
+    )};
+    if (it == index_.begin()) {
+      return index_.end();
+    }
+    return std::prev(it);
+  }
+
+  /**
+   * @brief Look up a key by scanning the run that may contain it.
+   * @details For row-encoded binary SSTables, only the timestamp of each
+   * entry is read until a candidate is found, and only the value of the
+   * match is decoded. Columnar blocks are decoded entry by entry, which
+   * needs no allocations once the series dictionary has been read, unless
+   * the SSTable has a block cache, in which case the decoded block is
+   * binary searched.
+   * 
+   * @param key Key.
+   * @return std::optional<mapped_type> The stored value if the key is in the
+   * SSTable, std::nullopt otherwise.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  [[nodiscard]] std::optional<mapped_type> lookup(const key_type& key) const {
+    const auto run{find_run(key)};
+    if (run == index_.end()) {
+      return std::nullopt;
+    }
+
+    const auto mapping{mapped()};
+    const auto& mapped_file{*mapping};
+    if (format_ == SSTableFormat::TEXT) {
+      auto pos{static_cast<size_type>(run->offset)};
+      for (uint32_t i{0}; i < run->entry_count; ++i) {
+        auto entry{read_text_entry(mapped_file, pos)};
+        if (entry.first == key) {
+          return entry.second;
+        }
+        if (key < entry.first) {
+          break;
+        }
+      }
+      return std::nullopt;
+    }
+
+    const char* pos{mapped_file.data() + run->offset};
+    const char* end{mapped_file.data() + mapped_file.size()};
+    if (format_version_ != ROW_FORMAT_VERSION && block_cache_) {
+      const auto block{cached_block(mapped_file, *run)};
+      const auto it{std::ranges::lower_bound(
+        *block, key, std::less<>{}, &value_type::first
+      )};
+      if (it != block->end() && it->first == key) {
+        return it->second;
+      }
+      return std::nullopt;
+    }
+    if (format_version_ != ROW_FORMAT_VERSION) {
+      std::vector<char> buffer;
+      auto decoder{block_decoder(mapped_file, *run, buffer)};
+      for (uint32_t i{0}; i < run->entry_count; ++i) {
+        auto entry{decoder.next()};
+        if (entry.first == key) {
+          return entry.second;
+        }
+        if (key < entry.first) {
+          break;
+        }
+      }
+      return std::nullopt;
+    }
+    for (uint32_t i{0}; i < run->entry_count; ++i) {
+      const char* timestamp_pos{pos};
+      const auto timestamp{readBinary<Timestamp>(timestamp_pos, end)};
+      if (timestamp > key.timestamp()) {
+        break;
+      }
+      if (timestamp < key.timestamp()) {
+        skipKeyBinary(pos, end);
+        skipValueBinary<TValue>(pos, end);
+        continue;
+      }
+      const auto entry_key{keyFromBinary(pos, end)};
+      if (entry_key == key) {
+        return valueFromBinary<TValue>(pos, end);
+      }
+      if (key < entry_key) {
+        break;
+      }
+      skipValueBinary<TValue>(pos, end);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Read the entries in a key range.
+   * 
+   * @param start Start key.
+   * @param end End key.
+   * @param use_block_cache Whether to read through the block cache.
+   * @return std::vector<value_type> Entries.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  [[nodiscard]] std::vector<value_type> read_entries(
+    const key_type& start,
+    const key_type& end,
+    bool use_block_cache = true
+  ) const {
+    std::vector<value_type> entries;
+    Cursor it{*this, start, end, nullptr, use_block_cache};
+    for (; it.valid(); it.advance()) {
+      entries.push_back(it.entry());
+    }
+    return entries;
+  }
+
+  /**
+   * @brief Read a legacy text entry at a position of the mapped data file.
+   * @details Advances the position to the start of the next entry.
+   * 
+   * @param mapped_file Mapped data file.
+   * @param pos Position of the entry.
+   * @return value_type Entry.
+   * 
+   * @throw std::runtime_error If the position is out of range.
+   */
+  [[nodiscard]] value_type read_text_entry(
+    const MappedFile& mapped_file,
+    size_type& pos
+  ) const {
+    const auto data{mapped_file.view()};
+    if (pos >= data.size()) {
+      throw std::runtime_error{
+        "SSTable::read_text_entry(): Position " + std::to_string(pos)
+        + " out of range in file '" + std::string(file_path_) + "'."
+      };
+    }
+    const auto start{pos + 1};
+    const auto stop{std::min(data.find('[', start), data.size())};
+    pos = stop;
+    return entryFromString<TValue>(std::string{data.substr(start, stop - start)});
+  }
+
+  /**
+   * @brief Get the memory mapping of the data file.
+   * @details Maps the data file on first access. The returned pointer keeps
+   * the mapping alive even if the SSTable is unmapped concurrently.
+   * 
+   * @return std::shared_ptr<const MappedFile> Mapped data file.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped.
+   */
+  [[nodiscard]] std::shared_ptr<const MappedFile> mapped() const {
+    std::lock_guard lock{*mapping_mutex_};
+    if (!mapped_file_) {
+      mapped_file_ = std::make_shared<const MappedFile>(file_path_);
+    }
+    return mapped_file_;
+  }
+
+  /**
+   * @brief Save the metadata to disk.
+   * 
+   * @param io_backend Backend that writes the file.
+   * @param sync Whether to sync the file to disk once written.
+   * @param io_scheduler Scheduler that grants the write, or null.
+   * @param io_priority Priority class of the write.
+   * 
+   * @throws std::runtime_error If unable to write or sync the file.
+   */
+  void save_metadata(
+    IOBackend io_backend,
+    bool sync,
+    IOScheduler* io_scheduler,
+    IOPriority io_priority
+  ) {
+    std::ostringstream file;
+    file << time_range_.str() << "\n";
+    file << key_range_.str() << "\n";
+    std::string bloom_filter;
+    bloom_filter_.load(std::memory_order_relaxed)->toBinary(bloom_filter);
+    file << BLOOM_FILTER_TAG << " " << bloom_filter.size() << "\n";
+    file.write(bloom_filter.data(), bloom_filter.size());
+    file << "\n";
+    std::string index;
+    appendBinary(index, static_cast<uint32_t>(index_.size()));
+    for (const auto& [first_key, offset, entry_count, token_mask] : index_) {
+      keyToBinary(index, first_key);
+      appendBinary(index, static_cast<uint64_t>(offset));
+      appendBinary(index, entry_count);
+      appendBinary(index, token_mask);
+    }
+    file << INDEX_TAG << " " << index.size() << "\n";
+    file.write(index.data(), index.size());
+    file << "\n";
+    std::string series_summary;
+    series_summary_.toBinary(series_summary);
+    file << SERIES_SUMMARY_TAG << " " << series_summary.size() << "\n";
+    file.write(series_summary.data(), series_summary.size());
+    file << "\n";
+    std::string block_stats;
+    appendBinary(block_stats, static_cast<uint32_t>(series_keys_.size()));
+    for (const auto& series_key : series_keys_) {
+      keyToBinary(block_stats, series_key);
+    }
+    appendBinary(block_stats, static_cast<uint32_t>(block_stats_.size()));
+    for (const auto& stats : block_stats_) {
+      stats.toBinary(block_stats);
+    }
+    file << BLOCK_STATS_TAG << " " << block_stats.size() << "\n";
+    file.write(block_stats.data(), block_stats.size());
+    file << "\n";
+    if (keep_rollup_) {
+      std::string rollup;
+      appendBinary(rollup, static_cast<uint32_t>(rollup_.size()));
+      for (const auto& stats : rollup_) {
+        stats.toBinary(rollup);
+      }
+      file << ROLLUP_TAG << " " << rollup.size() << "\n";
+      file.write(rollup.data(), rollup.size());
+      file << "\n";
+    }
+    if (!range_tombstones_.empty()) {
+      std::string tombstones;
+      for (const auto& tombstone : range_tombstones_) {
+        tombstones += tombstone.str() + "\n";
+      }
+      file << RANGE_TOMBSTONES_TAG << " " << tombstones.size() << "\n";
+      file.write(tombstones.data(), tombstones.size());
+      file << "\n";
+    }
+
+    if (io_scheduler != nullptr) {
+      io_scheduler->request(io_priority, file.view().size());
+    }
+    writeFile(io_backend, metadataPath(), file.view(), sync);
+  }
+  
+  /**
+   * @brief Load the metadata from disk.
+   * @details The binary index is followed by the series summary, the block
+   * statistics, the rollup if kept, and the range tombstones if any. Legacy
+   * metadata has a text index of `key^offset^count^mask` lines instead, and
+   * may lack the token masks, which then match anything, the summary, which
+   * is then saturated, and the statistics, which are then unavailable. Older
+   * metadata has one `key^offset` line per entry, which is read as a run of
+   * one entry, and coalesced into runs of TEXT_INDEX_INTERVAL entries for
+   * text SSTables. The Bloom filter of legacy metadata is rebuilt from the
+   * data file.
+   * 
+   * @throws std::runtime_error If unable to open file or format
+   * is invalid.
+   */
+  void load_metadata() {
+    std::ifstream file{metadataPath(), std::ios::binary};
+    if (!file.is_open()) {
+      throw std::runtime_error{
+        "SSTable::load_metadata(): Unable to open file '"
+        + std::string(metadataPath()) + "'."
+      };
+    }
+
+    std::string line;
+    std::getline(file, line);
+    time_range_ = TimeRange{std::move(line)};
+    std::getline(file, line);
+    key_range_ = KeyRange{std::move(line)};
+    std::getline(file, line);
+    const auto legacy_bloom_filter{!line.starts_with(BLOOM_FILTER_TAG)};
+    if (!legacy_bloom_filter) {
+      bloom_filter_.store(
+        std::make_shared<BloomFilter>(load_bloom_filter(file, line)),
+        std::memory_order_release
+      );
+    }
+    std::getline(file, line);
+    index_.clear();
+    if (line.starts_with(INDEX_TAG)) {
+      load_index(read_section(file, line, INDEX_TAG));
+    } else {
+      load_text_index(file, std::stoull(line));
+    }
+
+    series_summary_ = SeriesSummary::saturatedSummary();
+    series_keys_.clear();
+    block_stats_.clear();
+    rollup_.clear();
+    range_tombstones_.clear();
+    keep_rollup_ = false;
+    while (std::getline(file, line)) {
+      if (line.starts_with(SERIES_SUMMARY_TAG)) {
+        const auto bytes{read_section(file, line, SERIES_SUMMARY_TAG)};
+        const auto* pos{bytes.data()};
+        series_summary_ = SeriesSummary::fromBinary(pos, pos + bytes.size());
+      } else if (line.starts_with(BLOCK_STATS_TAG)) {
+        load_block_stats(read_section(file, line, BLOCK_STATS_TAG));
+      } else if (line.starts_with(ROLLUP_TAG)) {
+        load_rollup(read_section(file, line, ROLLUP_TAG));
+      } else if (line.starts_with(RANGE_TOMBSTONES_TAG)) {
+        std::istringstream tombstones{
+          read_section(file, line, RANGE_TOMBSTONES_TAG)
+        };
+        std::string tombstone;
+        while (std::getline(tombstones, tombstone)) {
+          range_tombstones_.emplace_back(tombstone);
+        }
+      }
+    }
+
+    file.close();
+
+    if (legacy_bloom_filter) {
+      bloom_filter_.store(
+        std::make_shared<BloomFilter>(rebuild_bloom_filter()),
+        std::memory_order_release
+      );
+    }
+  }
+
+  /**
+   * @brief Get the Bloom filter, loading it again if it was released.
+   * @details Racing loads are harmless, since they load the same filter.
+   * 
+   * @return std::shared_ptr<const BloomFilter> Bloom filter, or null if it
+   * cannot be loaded.
+   */
+  [[nodiscard]] std::shared_ptr<const BloomFilter> bloom_filter(
+  ) const noexcept {
+    if (auto filter{bloom_filter_.load(std::memory_order_acquire)}) {
+      return filter;
+    }
+    try {
+      std::ifstream file{metadataPath(), std::ios::binary};
+      std::string line;
+      std::getline(file, line);
+      std::getline(file, line);
+      std::getline(file, line);
+      if (!file) {
+        return nullptr;
+      }
+      auto filter{std::make_shared<BloomFilter>(
+        line.starts_with(BLOOM_FILTER_TAG)
+          ? load_bloom_filter(file, line)
+          : rebuild_bloom_filter()
+      )};
+      bloom_filter_.store(filter, std::memory_order_release);
+      return filter;
+    } catch (const std::exception&) {
+      return nullptr;
+    }
+  }
+
+  /**
+   * @brief Load a binary Bloom filter from the metadata file.
+   * 
+   * @param file Metadata file, positioned just after the tag line.
+   * @param tag_line Tag line, which holds the size of the Bloom filter.
+   * @return BloomFilter Bloom filter.
+   * 
+   * @throws std::runtime_error If the Bloom filter is truncated or invalid.
+   */
+  [[nodiscard]] BloomFilter load_bloom_filter(
+    std::ifstream& file,
+    const std::string& tag_line
+  ) const {
+    const auto size{std::stoull(tag_line.substr(BLOOM_FILTER_TAG.size()))};
+    std::string bytes(size, '\0');
+    if (!file.read(bytes.data(), size)) {
+      throw std::runtime_error{
+        "SSTable::load_bloom_filter(): Bloom filter in '"
+        + std::string(metadataPath()) + "' is truncated."
+      };
+    }
+    file.ignore(1);
+    const auto* pos{bytes.data()};
+    return BloomFilter::fromBinary(pos, pos + bytes.size());
+  }
+
+  /**
+   * @brief Load the binary index.
+   * 
+   * @param bytes Raw bytes of the index.
+   * 
+   * @throws std::runtime_error If the index is truncated.
+   */
+  void load_index(const std::string& bytes) {
+    const auto* pos{bytes.data()};
+    const auto* end{pos + bytes.size()};
+    const auto no_of_entries{readBinary<uint32_t>(pos, end)};
+    index_.reserve(no_of_entries);
+    for (uint32_t i{0}; i < no_of_entries; ++i) {
+      auto first_key{keyFromBinary(pos, end)};
+      const auto offset{readBinary<uint64_t>(pos, end)};
+      const auto entry_count{readBinary<uint32_t>(pos, end)};
+      const auto token_mask{readBinary<SeriesSummary::mask_type>(pos, end)};
+      index_.push_back({std::move(first_key), offset, entry_count, token_mask});
+    }
+  }
+
+  /**
+   * @brief Load a legacy text index from the metadata file.
+   * 
+   * @param file Metadata file, positioned just after the entry count line.
+   * @param no_of_entries Number of index lines.
+   * 
+   * @throws std::runtime_error If an index line is invalid.
+   */
+  void load_text_index(std::ifstream& file, size_type no_of_entries) {
+    std::string line;
+    for (size_type i{0}; i < no_of_entries; ++i) {
+      std::getline(file, line);
+      const auto caret_pos{line.find('^')};
+      if (caret_pos == std::string::npos) {
+        throw std::runtime_error{
+          "SSTable::load_text_index(): Invalid index entry '" + line + "'."
+        };
+      }
+      const auto count_pos{line.find('^', caret_pos + 1)};
+      if (count_pos != std::string::npos) {
+        const auto mask_pos{line.find('^', count_pos + 1)};
+        index_.push_back({
+          key_type{line.substr(0, caret_pos)},
+          std::stoull(line.substr(caret_pos + 1, count_pos - caret_pos - 1)),
+          static_cast<uint32_t>(std::stoul(
+            line.substr(count_pos + 1, mask_pos - count_pos - 1)
+          )),
+          mask_pos == std::string::npos
+            ? SeriesSummary::FULL_MASK
+            : std::stoull(line.substr(mask_pos + 1))
+        });
+        continue;
+      }
+      if (
+        format_ == SSTableFormat::TEXT &&
+        !index_.empty() &&
+        index_.back().entry_count < TEXT_INDEX_INTERVAL
+      ) {
+        ++index_.back().entry_count;
+        continue;
+      }
+      index_.push_back({
+        key_type{line.substr(0, caret_pos)},
+        std::stoull(line.substr(caret_pos + 1)),
+        1
+      });
+    }
+  }
+
+  /**
+   * @brief Read a tagged binary section from the metadata file.
+   * 
+   * @param file Metadata file, positioned just after the tag line.
+   * @param tag_line Tag line, which holds the size of the section.
+   * @param tag Tag.
+   * @return std::string Raw bytes of the section.
+   * 
+   * @throws std::runtime_error If the section is truncated.
+   */
+  std::string read_section(
+    std::ifstream& file,
+    const std::string& tag_line,
+    std::string_view tag
+  ) {
+    const auto size{std::stoull(tag_line.substr(tag.size()))};
+    std::string bytes(size, '\0');
+    if (!file.read(bytes.data(), size)) {
+      throw std::runtime_error{
+        "SSTable::read_section(): " + std::string(tag) + " section in '"
+        + std::string(metadataPath()) + "' is truncated."
+      };
+    }
+    file.ignore(1);
+    return bytes;
+  }
+
+  /**
+   * @brief Load the binary block statistics.
+   * 
+   * @param bytes Raw bytes of the statistics.
+   * 
+   * @throws std::runtime_error If the statistics are truncated or do not
+   * match the index.
+   */
+  void load_block_stats(const std::string& bytes) {
+    const auto* pos{bytes.data()};
+    const auto* end{pos + bytes.size()};
+    const auto no_of_series{readBinary<uint32_t>(pos, end)};
+    for (uint32_t i{0}; i < no_of_series; ++i) {
+      series_keys_.push_back(keyFromBinary(pos, end));
+    }
+    const auto no_of_blocks{readBinary<uint32_t>(pos, end)};
+    if (no_of_blocks != index_.size()) {
+      throw std::runtime_error{
+        "SSTable::load_block_stats(): Block statistics in '"
+        + std::string(metadataPath()) + "' do not match the index."
+      };
+    }
+    for (uint32_t i{0}; i < no_of_blocks; ++i) {
+      block_stats_.push_back(BlockStats<TValue>::fromBinary(pos, end));
+      for (const auto& [series, stats] : block_stats_.back().entries()) {
+        if (series >= series_keys_.size()) {
+          throw std::runtime_error{
+            "SSTable::load_block_stats(): Invalid series in '"
+            + std::string(metadataPath()) + "'."
+          };
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Load the binary rollup.
+   * @details Must be called after the block statistics have been loaded,
+   * since the rollup refers to their series.
+   * 
+   * @param bytes Raw bytes of the rollup.
+   * 
+   * @throws std::runtime_error If the rollup is truncated or does not match
+   * the series.
+   */
+  void load_rollup(const std::string& bytes) {
+    const auto* pos{bytes.data()};
+    const auto* end{pos + bytes.size()};
+    const auto no_of_series{readBinary<uint32_t>(pos, end)};
+    if (no_of_series != series_keys_.size()) {
+      throw std::runtime_error{
+        "SSTable::load_rollup(): Rollup in '" + std::string(metadataPath())
+        + "' does not match the series."
+      };
+    }
+    for (uint32_t i{0}; i < no_of_series; ++i) {
+      rollup_.push_back(SeriesStats<TValue>::fromBinary(pos, end));
+    }
+    keep_rollup_ = true;
+  }
+
+  /**
+   * @brief Rebuild the Bloom filter from the entries of the data file.
+   * 
+   * @return BloomFilter Bloom filter.
+   */
+  [[nodiscard]] BloomFilter rebuild_bloom_filter() const {
+    size_type no_of_entries{0};
+    for (const auto& index_entry : index_) {
+      no_of_entries += index_entry.entry_count;
+    }
+    BloomFilter bloom_filter{
+      std::max<size_type>(no_of_entries, 1),
+      BLOOM_FILTER_FALSE_POSITIVE_RATE
+    };
+    for (const auto& [key, value] : entries()) {
+      bloom_filter.insert(key);
+    }
+    return bloom_filter;
+  }
+
+  /**
+   * @brief Remove the data and metadata files if the SSTable is obsolete.
+   * 
+   */
+  void remove_files_if_obsolete() noexcept {
+    if (!obsolete_) {
+      return;
+    }
+    mapped_file_.reset();
+    std::error_code ec;
+    std::filesystem::remove(file_path_, ec);
+    std::filesystem::remove(metadataPath(), ec);
+    obsolete_ = false;
+  }
+
+  /**
+   * @brief Check if the Bloom filter may contain a key.
+   * 
+   * @param key Key.
+   * @return true if the Bloom filter may contain the key.
+   * @return false if the Bloom filter does not contain the key.
+   */
+  [[nodiscard]] bool may_contain(const key_type& key) const noexcept {
+    const auto filter{bloom_filter()};
+    return !filter || filter->mayContain(key);
+  }
+
+  /**
+   * @brief Check if a key is within the valid range.
+   * 
+   * @param key Key.
+   * @return true If the key is within the valid range.
+   * @return false If the key is not within the valid range.
+   */
+  [[nodiscard]] bool in_range(const key_type& key) const noexcept {
+    return time_range_.inRange(key.timestamp()) && key_range_.inRange(key);
+  }
+
+  /**
+   * @brief Check if a key is in the index.
+   * 
+   * @param key Key.
+   * @return true If the key is in the index.
+   * @return false If the key is not in the index.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  [[nodiscard]] bool in_index(const key_type& key) const {
+    return lookup(key).has_value();
+  }
+
+  /**
+   * @brief Check if the SSTable overlaps with the given range.
+   * 
+   * @param start The start key of the range.
+   * @param end The end key of the range.
    * @return true if the range overlaps with the valid ranges.
    * @return false If the range does not overlap with the valid ranges.
    */
@@ -442,10 +1780,71 @@ private:
   }
 
   /**
-   * @brief Bloom filter.
+   * @brief Bloom filter, or null if it was released.
+   * @details Atomic, since it may be released and loaded again while the
+   * SSTable is read.
+   * 
+   */
+  mutable std::atomic<std::shared_ptr<BloomFilter>> bloom_filter_;
+
+  /**
+   * @brief Summary of the metrics and tags of the keys.
+   * 
+   */
+  SeriesSummary series_summary_;
+
+  /**
+   * @brief Key of each series with block statistics, at timestamp zero.
+   * 
+   */
+  std::vector<key_type> series_keys_;
+
+  /**
+   * @brief Statistics of each block, in index order.
+   * @details Empty if the metadata predates block statistics.
+   * 
+   */
+  std::vector<BlockStats<TValue>> block_stats_;
+
+  /**
+   * @brief Statistics of each series over the whole SSTable, by series
+   * index.
+   * @details Empty unless the SSTable keeps a rollup.
+   * 
+   */
+  std::vector<SeriesStats<TValue>> rollup_;
+
+  /**
+   * @brief Range tombstones, oldest first.
+   * 
+   */
+  std::vector<RangeTombstone> range_tombstones_;
+
+  /**
+   * @brief Whether the SSTable keeps a rollup.
+   * 
+   */
+  bool keep_rollup_{false};
+
+  /**
+   * @brief Codec of the data blocks written.
+   * 
+   */
+  Compression compression_{Compression::NONE};
+
+  /**
+   * @brief Cache of decoded blocks, or null for none.
+   * 
+   */
+  std::shared_ptr<BlockCache> block_cache_;
+
+  /**
+   * @brief ID of the SSTable in the block cache.
+   * @details Fresh for every SSTable, so a rewritten data file never hits the
+   * blocks of the previous one.
    * 
    */
-  BloomFilter bloom_filter_;
+  BlockCache::owner_type cache_owner_{BlockCache::newOwner()};
 
   /**
    * @brief Time range.
@@ -460,7 +1859,7 @@ private:
   KeyRange key_range_;
 
   /**
-   * @brief Index.
+   * @brief Sparse index.
    * 
    */
   Index index_;
@@ -470,6 +1869,446 @@ private:
    * 
    */
   FilePath file_path_;
+
+  /**
+   * @brief Format of the data file.
+   * 
+   */
+  SSTableFormat format_{SSTableFormat::BINARY};
+
+  /**
+   * @brief Version of a binary data file.
+   * 
+   */
+  uint32_t format_version_{BINARY_FORMAT_VERSION};
+
+  /**
+   * @brief Memory mapping of the data file.
+   * 
+   */
+  mutable std::shared_ptr<const MappedFile> mapped_file_;
+
+  /**
+   * @brief Mutex guarding the creation and release of the mapping.
+   * 
+   */
+  mutable std::unique_ptr<std::mutex> mapping_mutex_{
+    std::make_unique<std::mutex>()
+  };
+
+  /**
+   * @brief Whether the files should be removed on destruction.
+   * 
+   */
+  mutable bool obsolete_{false};
+};
+
+/**
+ * @brief Pull-based cursor over the entries of an SSTable in a key range.
+ * @details Starts from the run that may contain the start key and decodes
+ * entries one at a time until a key past the end key is reached. Runs whose
+ * token masks rule out the predicate, if any, are skipped without decoding.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class SSTable<TValue>::Cursor {
+public:
+  /**
+   * @brief Construct a new Cursor object over a key range of an SSTable.
+   * 
+   * @param sstable SSTable.
+   * @param start Start key.
+   * @param end End key.
+   * @param predicate Predicate, or null to read every run.
+   * @param use_block_cache Whether to read columnar runs through the block
+   * cache of the SSTable, if it has one.
+   * 
+   * @throw std::runtime_error If the file cannot be mapped or an entry is
+   * malformed.
+   */
+  Cursor(
+    const SSTable& sstable,
+    const key_type& start,
+    const key_type& end,
+    std::shared_ptr<const KeyPredicate> predicate = nullptr,
+    bool use_block_cache = true
+  )
+    : sstable_{&sstable}
+    , start_{start}
+    , end_{end}
+    , predicate_{std::move(predicate)}
+    , use_block_cache_{use_block_cache && sstable.block_cache_ != nullptr} {
+    if (!sstable.overlaps_with(start, end)) {
+      return;
+    }
+    run_ = sstable.find_run(start);
+    if (run_ == sstable.index_.end()) {
+      run_ = sstable.index_.begin();
+    }
+    if (run_ == sstable.index_.end() || end < run_->first_key) {
+      return;
+    }
+    mapping_ = sstable.mapped();
+    start_run();
+    advance();
+  }
+
+  /**
+   * @brief Check if the cursor is at an entry.
+   * 
+   * @return true if the cursor is at an entry.
+   * @return false if the cursor is past the last entry in the range.
+   */
+  [[nodiscard]] bool valid() const noexcept {
+    return entry_.has_value();
+  }
+
+  /**
+   * @brief Get the entry the cursor is at.
+   * 
+   * @return const value_type& Entry.
+   */
+  [[nodiscard]] const value_type& entry() const noexcept {
+    return *entry_;
+  }
+
+  /**
+   * @brief Get the statistics of the run the cursor is at.
+   * @details Only given if the cursor is at the first entry of the run and
+   * the whole run is in the key range, so the statistics stand for the
+   * entries the cursor would yield reading through the run.
+   * 
+   * @return const BlockStats<TValue>* Statistics, or null if they are
+   * unavailable.
+   */
+  [[nodiscard]] const BlockStats<TValue>* runStats() const noexcept {
+    if (!entry_.has_value() || run_pos_ != 1) {
+      return nullptr;
+    }
+    const auto block{static_cast<size_type>(run_ - sstable_->index_.begin())};
+    if (block >= sstable_->block_stats_.size()) {
+      return nullptr;
+    }
+    const auto& stats{sstable_->block_stats_[block]};
+    if (
+      !stats.available() ||
+      !(entry_->first == run_->first_key) ||
+      !run_ends_before(end_, true)
+    ) {
+      return nullptr;
+    }
+    return &stats;
+  }
+
+  /**
+   * @brief Get the rollup of the SSTable.
+   * @details Only given if the whole SSTable is in the key range and the
+   * cursor has not yielded an entry before the one it is at, so the rollup
+   * stands for the entries the cursor would yield reading through the
+   * SSTable. Runs skipped by the predicate hold no matching series, so the
+   * caller must only take the series that match it.
+   * 
+   * @return std::span<const SeriesStats<TValue>> Statistics of each series,
+   * by series index, or an empty span if the rollup is unavailable.
+   */
+  [[nodiscard]] std::span<const SeriesStats<TValue>> rollup() const noexcept {
+    const auto& key_range{sstable_->key_range_};
+    if (
+      !entry_.has_value() || yielded_ || !sstable_->keep_rollup_ ||
+      !key_range.isSet() || key_range.lower() < start_ ||
+      end_ < key_range.upper()
+    ) {
+      return {};
+    }
+    return sstable_->rollup_;
+  }
+
+  /**
+   * @brief Check if every key of the SSTable is less than a key.
+   * 
+   * @param key Key.
+   * @return true if every key of the SSTable is less than the key.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool tableEndsBefore(const key_type& key) const noexcept {
+    const auto& key_range{sstable_->key_range_};
+    return key_range.isSet() && key_range.upper() < key;
+  }
+
+  /**
+   * @brief Get the time range of the SSTable.
+   * 
+   * @return TimeRange Time range.
+   */
+  [[nodiscard]] TimeRange tableTimeRange() const noexcept {
+    return sstable_->time_range_;
+  }
+
+  /**
+   * @brief Exhaust the cursor, skipping the rest of the SSTable.
+   * 
+   */
+  void skipTable() noexcept {
+    entry_.reset();
+    mapping_.reset();
+  }
+
+  /**
+   * @brief Check if every key of the run the cursor is at is less than a
+   * key.
+   * 
+   * @param key Key.
+   * @return true if every key of the run is less than the key.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool runEndsBefore(const key_type& key) const noexcept {
+    return run_ends_before(key, false);
+  }
+
+  /**
+   * @brief Get bounds on the timestamps of the run the cursor is at.
+   * @details The lower bound is the first timestamp of the run, and the
+   * upper bound that of the first key of the next run, or of the last key
+   * of the SSTable.
+   * 
+   * @return TimeRange Bounds on the timestamps.
+   */
+  [[nodiscard]] TimeRange runTimeRange() const noexcept {
+    const auto next{std::next(run_)};
+    const auto upper{
+      next != sstable_->index_.end()
+        ? next->first_key.timestamp()
+        : sstable_->time_range_.upper()
+    };
+    return TimeRange{run_->first_key.timestamp(), upper};
+  }
+
+  /**
+   * @brief Get the key of a series with block statistics.
+   * 
+   * @param series Series index.
+   * @return const key_type& Key of the series, at timestamp zero.
+   */
+  [[nodiscard]] const key_type& seriesKey(
+    typename BlockStats<TValue>::series_index series
+  ) const noexcept {
+    return sstable_->series_keys_[series];
+  }
+
+  /**
+   * @brief Advance the cursor past the rest of the run it is at.
+   * 
+   * @throw std::runtime_error If an entry is malformed.
+   */
+  void skipRun() {
+    if (mapping_) {
+      run_pos_ = run_->entry_count;
+    }
+    advance();
+  }
+
+  /**
+   * @brief Advance the cursor to the next entry in the range.
+   * 
+   * @throw std::runtime_error If an entry is malformed.
+   */
+  void advance() {
+    yielded_ = yielded_ || entry_.has_value();
+    entry_.reset();
+    while (mapping_) {
+      if (run_pos_ == run_->entry_count) {
+        ++run_;
+        if (run_ == sstable_->index_.end() || end_ < run_->first_key) {
+          mapping_.reset();
+          return;
+        }
+        start_run();
+        continue;
+      }
+      if (
+        run_pos_ == 0 && predicate_ &&
+        !predicate_->mayMatch(run_->token_mask)
+      ) {
+        run_pos_ = run_->entry_count;
+        continue;
+      }
+
+      auto entry{read_entry()};
+      ++run_pos_;
+      if (end_ < entry.first) {
+        mapping_.reset();
+        return;
+      }
+      if (start_ <= entry.first) {
+        entry_.emplace(std::move(entry));
+        return;
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Check if every key of the current run is less than, or at most, a
+   * key.
+   * @details The keys of a run are bounded by the first key of the next run,
+   * or by the key range of the SSTable for the last run.
+   * 
+   * @param key Key.
+   * @param inclusive Whether the keys may equal the key.
+   * @return true if every key of the run is bounded by the key.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool run_ends_before(
+    const key_type& key,
+    bool inclusive
+  ) const noexcept {
+    const auto next{std::next(run_)};
+    if (next != sstable_->index_.end()) {
+      return next->first_key <= key;
+    }
+    const auto& key_range{sstable_->key_range_};
+    if (!key_range.isSet()) {
+      return false;
+    }
+    return inclusive ? key_range.upper() <= key : key_range.upper() < key;
+  }
+
+  /**
+   * @brief Position the cursor at the start of the current run.
+   * @details The decoder of a columnar run is only created once the first
+   * entry is read, so skipped runs are never decoded.
+   * 
+   */
+  void start_run() noexcept {
+    run_pos_ = 0;
+    text_pos_ = run_->offset;
+    binary_pos_ = mapping_->data() + run_->offset;
+    decoder_.reset();
+    cached_block_.reset();
+  }
+
+  /**
+   * @brief Read the next entry of the current run.
+   * 
+   * @return value_type Entry.
+   * 
+   * @throw std::runtime_error If the entry is malformed.
+   */
+  [[nodiscard]] value_type read_entry() {
+    const auto* end{mapping_->data() + mapping_->size()};
+    if (sstable_->format_ == SSTableFormat::TEXT) {
+      return sstable_->read_text_entry(*mapping_, text_pos_);
+    }
+    if (sstable_->format_version_ == ROW_FORMAT_VERSION) {
+      return entryFromBinary<TValue>(binary_pos_, end);
+    }
+    if (use_block_cache_) {
+      if (!cached_block_) {
+        cached_block_ = sstable_->cached_block(*mapping_, *run_);
+      }
+      return (*cached_block_)[run_pos_];
+    }
+    if (!decoder_.has_value()) {
+      decoder_.emplace(
+        sstable_->block_decoder(*mapping_, *run_, block_buffer_)
+      );
+    }
+    return decoder_->next();
+  }
+
+  /**
+   * @brief SSTable.
+   * 
+   */
+  const SSTable* sstable_;
+
+  /**
+   * @brief Start key.
+   * 
+   */
+  key_type start_;
+
+  /**
+   * @brief End key.
+   * 
+   */
+  key_type end_;
+
+  /**
+   * @brief Predicate whose ruled-out runs are skipped, or null.
+   * 
+   */
+  std::shared_ptr<const KeyPredicate> predicate_;
+
+  /**
+   * @brief Whether columnar runs are read through the block cache.
+   * 
+   */
+  bool use_block_cache_;
+
+  /**
+   * @brief Mapped data file, or null once the cursor is exhausted.
+   * 
+   */
+  std::shared_ptr<const MappedFile> mapping_;
+
+  /**
+   * @brief Current run.
+   * 
+   */
+  typename Index::const_iterator run_;
+
+  /**
+   * @brief Number of entries of the current run that have been read.
+   * 
+   */
+  uint32_t run_pos_{0};
+
+  /**
+   * @brief Position of the next entry in a text data file.
+   * 
+   */
+  size_type text_pos_{0};
+
+  /**
+   * @brief Position of the next entry in a binary data file.
+   * 
+   */
+  const char* binary_pos_{nullptr};
+
+  /**
+   * @brief Decoder of the current columnar run, once it has been entered.
+   * 
+   */
+  std::optional<BlockDecoder<TValue>> decoder_;
+
+  /**
+   * @brief Decompressed block of the current columnar run.
+   * @details Its storage stays put when the cursor is moved, so it can be
+   * decoded from.
+   * 
+   */
+  std::vector<char> block_buffer_;
+
+  /**
+   * @brief Decoded entries of the current columnar run, if the SSTable has a
+   * block cache and the run has been entered.
+   * 
+   */
+  std::shared_ptr<const DecodedBlock> cached_block_;
+
+  /**
+   * @brief Entry the cursor is at.
+   * 
+   */
+  std::optional<value_type> entry_;
+
+  /**
+   * @brief Whether the cursor has advanced past an entry it yielded.
+   * 
+   */
+  bool yielded_{false};
 };
 }  // namespace vkdb
 
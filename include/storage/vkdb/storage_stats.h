@@ -0,0 +1,247 @@
+#ifndef STORAGE_STORAGE_STATS_H
+#define STORAGE_STORAGE_STATS_H
+
+#include <vkdb/metrics.h>
+#include <vkdb/memory_manager.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Point-in-time copy of the metrics of one or more LSM trees.
+ * @details Counters only ever grow while an LSM tree is open, and start
+ * again from 0 when it is reopened. Stats of several LSM trees, such as the
+ * shards of a table, are combined by adding them.
+ *
+ */
+struct StorageStats {
+  using size_type = uint64_t;
+
+  /**
+   * @brief Number of memtables flushed to C0.
+   * @details Includes the SSTables written by bulk loads.
+   *
+   */
+  size_type flushes{0};
+
+  /**
+   * @brief Number of compactions out of each Ck layer.
+   *
+   */
+  std::vector<size_type> compactions{};
+
+  /**
+   * @brief Bytes of SSTable data and metadata written to each Ck layer.
+   *
+   */
+  std::vector<size_type> bytes_written{};
+
+  /**
+   * @brief Number of SSTables in each Ck layer.
+   *
+   */
+  std::vector<size_type> sstables{};
+
+  /**
+   * @brief Number of point reads of an SSTable that its Bloom filter ruled
+   * out.
+   *
+   */
+  size_type bloom_negatives{0};
+
+  /**
+   * @brief Number of point reads of an SSTable that its Bloom filter let
+   * through, and that found the key.
+   *
+   */
+  size_type bloom_true_positives{0};
+
+  /**
+   * @brief Number of point reads of an SSTable that its Bloom filter let
+   * through, but that did not find the key.
+   *
+   */
+  size_type bloom_false_positives{0};
+
+  /**
+   * @brief Number of point reads answered by the read cache.
+   *
+   */
+  size_type cache_hits{0};
+
+  /**
+   * @brief Number of point reads that missed the read cache.
+   *
+   */
+  size_type cache_misses{0};
+
+  /**
+   * @brief Memory held, as of the snapshot.
+   *
+   */
+  MemoryUsage memory{};
+
+  /**
+   * @brief Latency of WAL appends.
+   * @details One per logged write or batch group.
+   *
+   */
+  HistogramSnapshot wal_append_latency{};
+
+  /**
+   * @brief Latency of memtable flushes.
+   *
+   */
+  HistogramSnapshot flush_latency{};
+
+  /**
+   * @brief Latency of compactions, of any layer.
+   *
+   */
+  HistogramSnapshot compaction_latency{};
+
+  /**
+   * @brief Get the fraction of point reads answered by the read cache.
+   *
+   * @return double Hit ratio, or 0 if there were no point reads.
+   */
+  [[nodiscard]] double cacheHitRatio() const noexcept;
+
+  /**
+   * @brief Get the fraction of Bloom filter positives that were false.
+   *
+   * @return double False positive rate, or 0 if there were no positives.
+   */
+  [[nodiscard]] double bloomFalsePositiveRate() const noexcept;
+
+  /**
+   * @brief Add the stats of another LSM tree.
+   * @details Per-layer stats are added layer by layer.
+   *
+   * @param other Stats.
+   * @return StorageStats& Reference to these stats.
+   */
+  StorageStats& operator+=(const StorageStats& other);
+
+  /**
+   * @brief Convert the stats to a string.
+   * @details One stat per line, as its name and value. Per-layer stats are
+   * named with their layer, as in `compactions.c1`, and latencies are given
+   * as their count, mean, and 50th and 99th percentiles in nanoseconds.
+   *
+   * @return std::string The string representation of the stats.
+   */
+  [[nodiscard]] std::string str() const;
+};
+
+/**
+ * @brief Metrics of an LSM tree, bumped on its hot paths.
+ * @details Every counter and histogram can be updated from any thread
+ * without a lock.
+ *
+ */
+struct StorageMetrics {
+  using size_type = uint64_t;
+
+  /**
+   * @brief Construct a new StorageMetrics object for a number of layers.
+   *
+   * @param layer_count Number of Ck layers.
+   */
+  explicit StorageMetrics(size_type layer_count)
+    : compactions(layer_count), bytes_written(layer_count) {}
+
+  /**
+   * @brief Take a snapshot of the metrics.
+   * @details The SSTable counts and memory are left empty, for the LSM tree
+   * to fill in.
+   *
+   * @return StorageStats Stats.
+   */
+  [[nodiscard]] StorageStats snapshot() const;
+
+  /**
+   * @brief Number of memtables flushed to C0.
+   *
+   */
+  Counter flushes;
+
+  /**
+   * @brief Number of compactions out of each Ck layer.
+   *
+   */
+  std::vector<Counter> compactions;
+
+  /**
+   * @brief Bytes written to each Ck layer.
+   *
+   */
+  std::vector<Counter> bytes_written;
+
+  /**
+   * @brief Number of Bloom filter negatives.
+   *
+   */
+  Counter bloom_negatives;
+
+  /**
+   * @brief Number of Bloom filter true positives.
+   *
+   */
+  Counter bloom_true_positives;
+
+  /**
+   * @brief Number of Bloom filter false positives.
+   *
+   */
+  Counter bloom_false_positives;
+
+  /**
+   * @brief Number of read cache hits.
+   *
+   */
+  Counter cache_hits;
+
+  /**
+   * @brief Number of read cache misses.
+   *
+   */
+  Counter cache_misses;
+
+  /**
+   * @brief Latency of WAL appends.
+   *
+   */
+  LatencyHistogram wal_append_latency;
+
+  /**
+   * @brief Latency of memtable flushes.
+   *
+   */
+  LatencyHistogram flush_latency;
+
+  /**
+   * @brief Latency of compactions.
+   *
+   */
+  LatencyHistogram compaction_latency;
+};
+
+/**
+ * @brief Convert the stats of tables to the Prometheus text exposition
+ * format.
+ * @details Each metric is prefixed with `vkdb_` and labelled with its table,
+ * and per-layer metrics with their layer as well. Latencies are exposed as
+ * histograms in seconds.
+ *
+ * @param tables Stats of each table, by name.
+ * @return std::string Exposition.
+ */
+[[nodiscard]] std::string prometheusText(
+  const std::map<std::string, StorageStats>& tables
+);
+}  // namespace vkdb
+
+#endif // STORAGE_STORAGE_STATS_H
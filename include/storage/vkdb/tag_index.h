@@ -0,0 +1,204 @@
+#ifndef STORAGE_TAG_INDEX_H
+#define STORAGE_TAG_INDEX_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <vkdb/io_backend.h>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Inverted index from each tag to the series that have it.
+ * @details Every series written to an LSM tree is indexed once, under each
+ * of its tags, in a posting list of series IDs kept in ascending order, so
+ * the series with a set of tags are found by intersecting their posting
+ * lists. Series are never removed, even once all their entries are
+ * deleted, so the index may list series that no longer have data, but
+ * never misses one that does. It is thread-safe.
+ * 
+ * Series IDs are only meaningful within a process, so the index is saved as
+ * the metric and tags of each series, and interned again when loaded.
+ * 
+ */
+class TagIndex {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Magic string at the start of a saved index.
+   * 
+   */
+  static constexpr std::string_view MAGIC{"VKDBTAGINDEX"};
+
+  /**
+   * @brief Construct a new, empty TagIndex object.
+   * 
+   */
+  TagIndex();
+
+  /**
+   * @brief Move-construct a TagIndex object.
+   * 
+   */
+  TagIndex(TagIndex&&) noexcept = default;
+
+  /**
+   * @brief Move-assign a TagIndex object.
+   * 
+   */
+  TagIndex& operator=(TagIndex&&) noexcept = default;
+
+  /**
+   * @brief Deleted copy constructor.
+   * 
+   */
+  TagIndex(const TagIndex&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   * 
+   */
+  TagIndex& operator=(const TagIndex&) = delete;
+
+  /**
+   * @brief Destroy the TagIndex object.
+   * 
+   */
+  ~TagIndex() noexcept = default;
+
+  /**
+   * @brief Index the series of a key, if it is not indexed yet.
+   * @details Series that are already indexed only take a shared lock.
+   * 
+   * @param key Key.
+   */
+  void insert(const TimeSeriesKey& key);
+
+  /**
+   * @brief Get the series that have every one of a set of tags.
+   * 
+   * @param tags Tags.
+   * @return std::vector<SeriesId> IDs of the series, in ascending order;
+   * every series if there are no tags.
+   */
+  [[nodiscard]] std::vector<SeriesId> seriesWithTags(
+    const TagTable& tags
+  ) const;
+
+  /**
+   * @brief Check if a series is indexed.
+   * 
+   * @param id Series ID.
+   * @return true if the series is indexed.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool contains(SeriesId id) const noexcept;
+
+  /**
+   * @brief Get the number of indexed series.
+   * 
+   * @return size_type Number of series.
+   */
+  [[nodiscard]] size_type size() const noexcept;
+
+  /**
+   * @brief Get an estimate of the memory held by the index, and by its
+   * series in the series dictionary.
+   * 
+   * @return size_type Bytes.
+   */
+  [[nodiscard]] size_type bytes() const noexcept;
+
+  /**
+   * @brief Check if series were indexed since the index was last saved or
+   * loaded.
+   * 
+   * @return true if the index has unsaved series.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool dirty() const noexcept;
+
+  /**
+   * @brief Remove every series.
+   * 
+   */
+  void clear() noexcept;
+
+  /**
+   * @brief Save the index to a file.
+   * @details Written to a temporary file first, then renamed over the file,
+   * so a crash leaves either the old index or the new one.
+   * 
+   * @param path Path of the file.
+   * @param backend I/O backend.
+   * 
+   * @throw std::runtime_error If the file cannot be written.
+   */
+  void save(const std::filesystem::path& path, IOBackend backend) const;
+
+  /**
+   * @brief Replace the index with one loaded from a file.
+   * 
+   * @param path Path of the file.
+   * @return true if the index was loaded.
+   * @return false if the file does not exist or is malformed, in which case
+   * the index is left empty.
+   */
+  bool load(const std::filesystem::path& path);
+
+private:
+  /**
+   * @brief Index a series. Must be called with the mutex held exclusively.
+   * 
+   * @param series Series.
+   */
+  void insert_locked(const Series& series);
+
+  /**
+   * @brief Mutex guarding the index.
+   * 
+   */
+  std::unique_ptr<std::shared_mutex> mutex_;
+
+  /**
+   * @brief Posting list of each tag.
+   * 
+   */
+  std::map<Tag, std::vector<SeriesId>> postings_;
+
+  /**
+   * @brief IDs of the indexed series, in ascending order.
+   * 
+   */
+  std::vector<SeriesId> series_;
+
+  /**
+   * @brief Indexed series by ID, each held by a key so that it stays in the
+   * series dictionary while it is indexed.
+   * 
+   */
+  std::unordered_map<SeriesId, TimeSeriesKey> indexed_;
+
+  /**
+   * @brief Estimated memory held by the index and its series.
+   * 
+   */
+  size_type bytes_{0};
+
+  /**
+   * @brief Whether series were indexed since the index was last saved or
+   * loaded.
+   * 
+   */
+  mutable bool dirty_{false};
+};
+}  // namespace vkdb
+
+#endif // STORAGE_TAG_INDEX_H
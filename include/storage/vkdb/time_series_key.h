@@ -6,6 +6,7 @@
 #include <optional>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 #include <vkdb/concepts.h>
 
 namespace vkdb {
@@ -33,6 +34,18 @@ using TagKey = std::string;
  */
 using TagValue = std::string;
 
+/**
+ * @brief Type alias for uint32_t.
+ * 
+ */
+using SeriesId = uint32_t;
+
+/**
+ * @brief Interned metric and tags of a series.
+ * 
+ */
+struct Series;
+
 /**
  * @brief Type alias for a pair of tag key and tag value.
  * 
@@ -79,6 +92,11 @@ struct DataPoint {
 
 /**
  * @brief Represents a key in vkdb.
+ * @details The metric and tags are interned in the SeriesDictionary, so a
+ * key is just a timestamp and a pointer to its series. Copying a key never
+ * allocates, and keys of the same series are compared and hashed without
+ * looking at their strings. Each key holds a reference to its series, so a
+ * series is removed from the dictionary once no key refers to it.
  * 
  */
 class TimeSeriesKey {
@@ -97,9 +115,10 @@ public:
 
   /**
    * @brief Construct a new TimeSeriesKey object.
+   * @details The key has timestamp zero, an empty metric, and no tags.
    * 
    */
-  TimeSeriesKey() noexcept = default;
+  TimeSeriesKey() noexcept;
 
   /**
    * @brief Construct a new TimeSeriesKey object from the given string.
@@ -113,49 +132,66 @@ public:
   /**
    * @brief Construct a new Time Series Key objec from the given timestamp,
    * metric, and tags.
+   * @details Interns the metric and tags if they are new.
    * 
    * @param timestamp Timestamp.
    * @param metric Metric.
    * @param tags Tags.
+   * 
+   * @throw std::bad_alloc If interning the metric and tags fails.
    */
   explicit TimeSeriesKey(
     Timestamp timestamp,
     Metric metric,
     TagTable tags
-  ) noexcept;
+  );
+
+  /**
+   * @brief Construct a new TimeSeriesKey object from the given timestamp and
+   * interned series.
+   * 
+   * @param timestamp Timestamp.
+   * @param series Series, as interned by the series dictionary, and held by
+   * the caller.
+   */
+  explicit TimeSeriesKey(Timestamp timestamp, const Series& series) noexcept;
 
   /**
    * @brief Move-construct a new TimeSeriesKey object.
+   * @details The moved-from key is left with the empty series.
    * 
    */
-  TimeSeriesKey(TimeSeriesKey&&) noexcept = default;
+  TimeSeriesKey(TimeSeriesKey&& other) noexcept;
   
   /**
    * @brief Move-assign a new TimeSeriesKey object.
+   * @details Swaps with the moved-from key.
    * 
    */
-  TimeSeriesKey& operator=(TimeSeriesKey&&) noexcept = default;
+  TimeSeriesKey& operator=(TimeSeriesKey&& other) noexcept;
 
   /**
    * @brief Copy-construct a new TimeSeriesKey object.
    * 
    */
-  TimeSeriesKey(const TimeSeriesKey&) noexcept = default;
+  TimeSeriesKey(const TimeSeriesKey& other) noexcept;
   
   /**
    * @brief Copy-assign a new TimeSeriesKey object.
    * 
    */
-  TimeSeriesKey& operator=(const TimeSeriesKey&) noexcept = default;
+  TimeSeriesKey& operator=(const TimeSeriesKey& other) noexcept;
 
   /**
    * @brief Destroy the TimeSeriesKey object.
+   * @details Releases the key's reference to its series.
    * 
    */
-  ~TimeSeriesKey() noexcept = default;
+  ~TimeSeriesKey() noexcept;
 
   /**
    * @brief Equality operator.
+   * @details Compares the timestamps and series identities only.
    * 
    * @param other The other key.
    * 
@@ -178,8 +214,8 @@ public:
    * @brief Less-than operator.
    * @details First, the keys are checked to see if they are the minimum or
    * maximum keys. If they aren't, the comparison is done based on the key's
-   * properties. The comparison is done in the following order:
-   * The comparison is done in the following order:
+   * properties. Metric and tags are only compared if the keys belong to
+   * different series. The comparison is done in the following order:
    * 1. Timestamp.
    * 2. Metric.
    * 3. Tags.
@@ -231,9 +267,9 @@ public:
   /**
    * @brief Get the metric.
    * 
-   * @return Metric The metric.
+   * @return const Metric& The metric.
    */
-  [[nodiscard]] Metric metric() const noexcept;
+  [[nodiscard]] const Metric& metric() const noexcept;
 
   /**
    * @brief Get the tags.
@@ -242,6 +278,28 @@ public:
    */
   [[nodiscard]] const TagTable& tags() const noexcept;
 
+  /**
+   * @brief Get the ID of the key's series.
+   * 
+   * @return SeriesId The series ID.
+   */
+  [[nodiscard]] SeriesId seriesId() const noexcept;
+
+  /**
+   * @brief Get the interned series of the key.
+   * 
+   * @return const Series& The series.
+   */
+  [[nodiscard]] const Series& series() const noexcept;
+
+  /**
+   * @brief Get the hash of the key.
+   * @details Combines the timestamp with the precomputed hash of the series.
+   * 
+   * @return size_t The hash.
+   */
+  [[nodiscard]] size_t hash() const noexcept;
+
   /**
    * @brief Get the string representation of the key.
    * 
@@ -257,16 +315,26 @@ private:
   Timestamp timestamp_;
 
   /**
-   * @brief Metric.
+   * @brief Check if the key is MIN_TIME_SERIES_KEY.
    * 
+   * @return true If the key is the minimum key.
+   * @return false If the key is not the minimum key.
    */
-  Metric metric_;
-  
+  [[nodiscard]] bool is_min() const noexcept;
+
   /**
-   * @brief Tags.
+   * @brief Check if the key is MAX_TIME_SERIES_KEY.
+   * 
+   * @return true If the key is the maximum key.
+   * @return false If the key is not the maximum key.
+   */
+  [[nodiscard]] bool is_max() const noexcept;
+
+  /**
+   * @brief Series.
    * 
    */
-  TagTable tags_;
+  const Series* series_;
 };
 
 /**
@@ -341,7 +409,7 @@ namespace std {
 template <>
 struct hash<vkdb::TimeSeriesKey> {
   size_t operator()(const vkdb::TimeSeriesKey& key) const noexcept {
-    return hash<string>{}(key.str());
+    return key.hash();
   }
 };
 }  // namespace std
@@ -0,0 +1,209 @@
+#ifndef STORAGE_VALUE_BATCH_H
+#define STORAGE_VALUE_BATCH_H
+
+#include <vkdb/block_stats.h>
+#include <vkdb/concepts.h>
+#include <vkdb/time_series_key.h>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define VKDB_HAS_SIMD 1
+#endif
+
+namespace vkdb {
+/**
+ * @brief Default number of entries in a batch.
+ * 
+ */
+static constexpr uint64_t DEFAULT_VALUE_BATCH_SIZE{1024};
+
+/**
+ * @brief Batch of live entries, stored as contiguous columns of timestamps
+ * and values.
+ * @details Scans fill a batch entry by entry, then hand it to aggregate
+ * kernels, which read the value column without touching the keys or the
+ * optionals around each value. The values are kept in an array rather than a
+ * vector, so a batch of bools is not bit-packed.
+ * 
+ * @tparam TValue Value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+class ValueBatch {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Construct a new ValueBatch object given its capacity.
+   * 
+   * @param capacity Maximum number of entries.
+   * 
+   * @throw std::invalid_argument If the capacity is 0.
+   */
+  explicit ValueBatch(size_type capacity = DEFAULT_VALUE_BATCH_SIZE)
+    : capacity_{capacity} {
+    if (capacity == 0) {
+      throw std::invalid_argument{
+        "ValueBatch(): Capacity must be greater than 0."
+      };
+    }
+    timestamps_.reserve(capacity);
+    values_ = std::make_unique<TValue[]>(capacity);
+  }
+
+  /**
+   * @brief Add an entry.
+   * @details The batch must not be full.
+   * 
+   * @param timestamp Timestamp.
+   * @param value Value.
+   */
+  void push(Timestamp timestamp, TValue value) {
+    values_[timestamps_.size()] = value;
+    timestamps_.push_back(timestamp);
+  }
+
+  /**
+   * @brief Remove every entry, keeping the capacity.
+   * 
+   */
+  void clear() noexcept {
+    timestamps_.clear();
+  }
+
+  /**
+   * @brief Get the number of entries.
+   * 
+   * @return size_type Number of entries.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    return timestamps_.size();
+  }
+
+  /**
+   * @brief Check if the batch has no entries.
+   * 
+   * @return true if the batch has no entries.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return timestamps_.empty();
+  }
+
+  /**
+   * @brief Check if the batch is at capacity.
+   * 
+   * @return true if the batch is at capacity.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool full() const noexcept {
+    return timestamps_.size() >= capacity_;
+  }
+
+  /**
+   * @brief Get the timestamp column.
+   * 
+   * @return std::span<const Timestamp> Timestamps, in key order.
+   */
+  [[nodiscard]] std::span<const Timestamp> timestamps() const noexcept {
+    return timestamps_;
+  }
+
+  /**
+   * @brief Get the value column.
+   * 
+   * @return std::span<const TValue> Values, in key order.
+   */
+  [[nodiscard]] std::span<const TValue> values() const noexcept {
+    return {values_.get(), timestamps_.size()};
+  }
+
+private:
+  /**
+   * @brief Maximum number of entries.
+   * 
+   */
+  size_type capacity_;
+
+  /**
+   * @brief Timestamp column.
+   * 
+   */
+  std::vector<Timestamp> timestamps_;
+
+  /**
+   * @brief Value column, of the capacity, with the first size() in use.
+   * 
+   */
+  std::unique_ptr<TValue[]> values_;
+};
+
+/**
+ * @brief Compute the count, sum, minimum, and maximum of a column of values.
+ * @details Where the standard library provides data-parallel types, the
+ * values are processed a native SIMD register at a time, with one
+ * accumulator per lane for each statistic, so the width follows the target
+ * the library is built for (SSE2 by default, AVX2 or AVX-512 with -march,
+ * NEON on ARM). The remaining values, and value types without a SIMD
+ * register, are added one at a time. Floating-point sums are accumulated per
+ * lane, so they may round differently from a sequential sum. Integers
+ * narrower than their StatsSum are summed one at a time, so that the sum
+ * cannot overflow a lane.
+ * 
+ * @tparam TValue Value type.
+ * @param values Values.
+ * @return SeriesStats<TValue> Statistics.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+[[nodiscard]] SeriesStats<TValue> aggregateValues(
+  std::span<const TValue> values
+) noexcept {
+  SeriesStats<TValue> stats;
+  uint64_t i{0};
+#ifdef VKDB_HAS_SIMD
+  if constexpr (!std::is_same_v<TValue, bool>) {
+    namespace stdx = std::experimental;
+    using Vector = stdx::native_simd<TValue>;
+    constexpr auto width{Vector::size()};
+    if (width > 1 && values.size() >= width) {
+      constexpr auto lane_sums{
+        std::is_floating_point_v<TValue>
+        || sizeof(TValue) == sizeof(StatsSum<TValue>)
+      };
+      Vector sum{values.data(), stdx::element_aligned};
+      auto min{sum};
+      auto max{sum};
+      for (i = width; i + width <= values.size(); i += width) {
+        const Vector chunk{values.data() + i, stdx::element_aligned};
+        if constexpr (lane_sums) {
+          sum += chunk;
+        }
+        min = stdx::min(min, chunk);
+        max = stdx::max(max, chunk);
+      }
+      stats.count = i;
+      if constexpr (lane_sums) {
+        stats.sum = stdx::reduce(sum);
+      } else {
+        for (uint64_t j{0}; j < i; ++j) {
+          stats.sum += values[j];
+        }
+      }
+      stats.min = stdx::hmin(min);
+      stats.max = stdx::hmax(max);
+    }
+  }
+#endif
+  for (; i < values.size(); ++i) {
+    stats.add(values[i]);
+  }
+  return stats;
+}
+}  // namespace vkdb
+
+#endif // STORAGE_VALUE_BATCH_H
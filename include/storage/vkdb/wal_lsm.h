@@ -2,6 +2,13 @@
 #define STORAGE_WAL_LSM_H
 
 #include <vkdb/lsm_tree.h>
+#include <vkdb/compression.h>
+#include <vkdb/io_backend.h>
+#include <vkdb/io_scheduler.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
 
 namespace vkdb {
 template <ArithmeticNoCVRefQuals TValue>
@@ -10,13 +17,134 @@ class LSMTree;
 template <ArithmeticNoCVRefQuals TValue>
 class WriteAheadLog;
 
+/**
+ * @brief When the write-ahead log syncs buffered records to disk.
+ * @details NONE hands every record to the OS straight away but never syncs.
+ * EVERY_WRITE syncs each append. INTERVAL and BYTES buffer records in memory,
+ * and commit them with a single write and sync once the interval has passed
+ * or enough bytes are buffered.
+ * 
+ */
+enum class WALSyncPolicy {
+  NONE,
+  EVERY_WRITE,
+  INTERVAL,
+  BYTES
+};
+
+/**
+ * @brief Format of the records of a write-ahead log.
+ * @details TEXT writes each record as a line. BINARY frames each record with
+ * its length and a CRC-32C of its contents, after a magic header, so replay
+ * decodes records without parsing text and stops at the first torn or
+ * corrupt one. Logs of either format are read back whatever the option.
+ * 
+ */
+enum class WALFormat {
+  TEXT,
+  BINARY
+};
+
+/**
+ * @brief Options for a write-ahead log.
+ * 
+ */
+struct WALOptions {
+  /**
+   * @brief Sync policy.
+   * 
+   */
+  WALSyncPolicy sync_policy{WALSyncPolicy::NONE};
+
+  /**
+   * @brief Time between syncs for the INTERVAL policy.
+   * 
+   */
+  std::chrono::milliseconds sync_interval{100};
+
+  /**
+   * @brief Number of buffered bytes that triggers a sync for the BYTES
+   * policy.
+   * 
+   */
+  uint64_t sync_bytes{1 << 20};
+
+  /**
+   * @brief Codec of sealed segments.
+   * @details The active log is never compressed, so appends never pay for
+   * compression. A segment is compressed as it is sealed.
+   * 
+   */
+  Compression compression{Compression::NONE};
+
+  /**
+   * @brief Backend that writes the active log.
+   * @details Under the io_uring backend, a group commit submits its write and
+   * sync together. Falls back to POSIX where io_uring is unavailable.
+   * 
+   */
+  IOBackend io_backend{IOBackend::POSIX};
+
+  /**
+   * @brief Scheduler that grants the writes of the active log, at WAL
+   * priority, or null to write them at once.
+   * @details An LSM tree whose WAL has none gives it its own.
+   * 
+   */
+  std::shared_ptr<IOScheduler> io_scheduler{};
+
+  /**
+   * @brief Whether segments are archived once their memtable is flushed,
+   * instead of being removed.
+   * @details Archived segments keep their records available to followers
+   * until WriteAheadLog::acknowledge() is given a later log sequence number.
+   * 
+   */
+  bool archive{false};
+
+  /**
+   * @brief Format of new records.
+   * @details An active log that already has records keeps its format until
+   * it is sealed.
+   * 
+   */
+  WALFormat format{WALFormat::TEXT};
+
+  /**
+   * @brief Number of threads that decode each log file on replay. 0 or 1
+   * decodes on the replaying thread.
+   * 
+   */
+  uint64_t replay_threads{std::thread::hardware_concurrency()};
+};
+
 /**
  * @brief Type of WAL record.
  * 
  */
 enum class WALRecordType {
   PUT,
-  REMOVE
+  REMOVE,
+  REMOVE_RANGE
+};
+
+/**
+ * @brief Records read from a write-ahead log, as shipped to a follower.
+ * 
+ */
+struct WALChunk {
+  /**
+   * @brief Records, one per line, in the text format of the log, whatever
+   * format they were written in.
+   * 
+   */
+  std::string records;
+
+  /**
+   * @brief Log sequence number just past the last record read.
+   * 
+   */
+  uint64_t next_lsn{0};
 };
 
 /**
@@ -3,6 +3,31 @@
 
 #include <vkdb/lsm_tree.h>
 #include <vkdb/wal_lsm.h>
+#include <vkdb/crc32c.h>
+#include <vkdb/file_sync.h>
+#include <map>
+#include <set>
+#include <fstream>
+#include <functional>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <cstring>
+#include <exception>
+#include <utility>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace vkdb {
 /**
@@ -11,8 +36,71 @@ namespace vkdb {
  */
 const FilePath WAL_FILENAME{"wal.log"};
 
+/**
+ * @brief Filename of the log sequence number the write-ahead log had reached
+ * when it last sealed a segment.
+ * 
+ */
+const FilePath WAL_LSN_FILENAME{"wal.lsn"};
+
+/**
+ * @brief Prefix of the filename of an archived segment, which is followed by
+ * the log sequence number just past its last record.
+ * 
+ */
+inline constexpr std::string_view WAL_ARCHIVE_PREFIX{"wal.archive."};
+
+/**
+ * @brief Magic bytes at the start of a compressed WAL segment.
+ * @details Followed by the codec, the size of the plain segment, and the
+ * compressed segment. Plain segments start with a record type digit instead.
+ * 
+ */
+inline constexpr std::string_view WAL_COMPRESSED_MAGIC{"VKDBWALZ"};
+
+/**
+ * @brief Magic bytes at the start of a log file in the binary format.
+ * @details Followed by records, each as its length and CRC-32C, both 32-bit,
+ * then its type, its 64-bit LSN, and its binary entry or range tombstone.
+ * 
+ */
+inline constexpr std::string_view WAL_BINARY_MAGIC{"VKDBWALB"};
+
+/**
+ * @brief Number of bytes before the contents of a binary record.
+ * 
+ */
+inline constexpr uint64_t WAL_BINARY_HEADER_BYTES{
+  sizeof(uint32_t) + sizeof(uint32_t)
+};
+
+/**
+ * @brief Smallest number of records decoded on their own thread on replay.
+ * 
+ */
+inline constexpr uint64_t WAL_MIN_DECODE_RUN{4'096};
+
 /**
  * @brief Write-ahead log.
+ * @details Records are appended to the active log file through a persistent
+ * file descriptor. Depending on the sync policy, records are either written
+ * straight away or buffered in memory and group-committed, so that many
+ * records share a single write and sync. When a memtable is frozen, the
+ * active log is sealed into a numbered segment, which is removed once the
+ * memtable has been written to an SSTable. Sealed segments may be
+ * compressed.
+ * 
+ * Records are written as text lines or checksummed binary frames, as given
+ * by WALFormat. On replay, each file is split into records, which are
+ * decoded on several threads and applied in batches, a memtable's worth at
+ * a time.
+ * 
+ * Every record carries its log sequence number (LSN), one past that of
+ * the record before it, so that followers can ask for the records from any
+ * LSN on. LSNs survive replays, which log the records again under the same
+ * numbers. When archiving, the segments of flushed memtables are kept as
+ * archives, which clearing the log leaves alone, until followers
+ * acknowledge every record in them.
  * 
  * @tparam TValue Value type.
  */
@@ -28,11 +116,29 @@ public:
   /**
    * @brief Construct a new WriteAheadLog object given the path of the LSM
    * tree.
+   * @details Under the INTERVAL policy, a timer thread commits buffered
+   * records once per interval.
    * 
    * @param lsm_tree_path Path.
+   * @param options Options.
+   * 
+   * @throw std::invalid_argument If the segment codec is not available.
    */
-  explicit WriteAheadLog(FilePath lsm_tree_path) noexcept
-    : path_{lsm_tree_path / WAL_FILENAME} {}
+  explicit WriteAheadLog(FilePath lsm_tree_path, WALOptions options = {})
+    : path_{lsm_tree_path / WAL_FILENAME}
+    , options_{options}
+    , state_{std::make_unique<State>()} {
+      state_->io_scheduler = options_.io_scheduler;
+      if (!compressionAvailable(options_.compression)) {
+        throw std::invalid_argument{
+          "WriteAheadLog(): Segment codec is not available."
+        };
+      }
+      recover();
+      if (options_.sync_policy == WALSyncPolicy::INTERVAL) {
+        start_timer();
+      }
+    }
 
   /**
    * @brief Move-construct a WriteAheadLog object.
@@ -42,9 +148,19 @@ public:
   
   /**
    * @brief Move-assign a WriteAheadLog object.
+   * @details Closes this log before taking over the other one.
    * 
    */
-  WriteAheadLog& operator=(WriteAheadLog&&) noexcept = default;
+  WriteAheadLog& operator=(WriteAheadLog&& other) noexcept {
+    if (this != &other) {
+      close();
+      path_ = std::move(other.path_);
+      options_ = other.options_;
+      state_ = std::move(other.state_);
+      timer_ = std::move(other.timer_);
+    }
+    return *this;
+  }
 
   /**
    * @brief Deleted copy constructor.
@@ -60,81 +176,421 @@ public:
 
   /**
    * @brief Destroy the WriteAheadLog object.
+   * @details Commits any buffered records.
    * 
    */
-  ~WriteAheadLog() noexcept = default;
+  ~WriteAheadLog() noexcept {
+    close();
+  }
 
   /**
    * @brief Append a WAL record to the write-ahead log.
+   * @details The record is committed according to the sync policy.
    * 
    * @param record WAL record.
    * 
-   * @throw std::runtime_error If the file cannot be opened.
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced, including by an earlier timed commit.
    */
   void append(const WALRecord<TValue>& record) {
-    std::ofstream file{path_, std::ios::app};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "WriteAheadLog::append(): Unable to open file "
-        + std::string(path_) + "."
-      };
-    }
-    file << std::to_string(static_cast<int>(record.type));
-    file << " " << entryToString(record.entry) << "\n";
-    file.close();
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    encode(
+      state_->buffer,
+      state_->active_format,
+      record.type,
+      record.entry,
+      state_->next_lsn++
+    );
+    commit_appended();
   }
 
   /**
-   * @brief Replay the write-ahead log on the LSM tree.
+   * @brief Append a range tombstone to the write-ahead log.
+   * @details The record is committed according to the sync policy.
    * 
-   * @param lsm_tree LSM tree.
+   * @param range_tombstone Range tombstone.
    * 
-   * @throw std::runtime_error If the file cannot be opened.
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced, including by an earlier timed commit.
    */
-  void replay(LSMTree<TValue>& lsm_tree) {
-    if (!std::filesystem::exists(path_)) {
+  void appendRangeTombstone(const RangeTombstone& range_tombstone) {
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    encode_range_tombstone(
+      state_->buffer,
+      state_->active_format,
+      range_tombstone,
+      state_->next_lsn++
+    );
+    commit_appended();
+  }
+
+  /**
+   * @brief Append a group of WAL records to the write-ahead log.
+   * @details Entries with a value are logged as puts, and entries without one
+   * as removals. The whole group is committed together according to the sync
+   * policy, so it costs at most one write and one sync.
+   * 
+   * @param entries Entries.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced, including by an earlier timed commit.
+   */
+  void appendGroup(std::span<const TimeSeriesEntry<TValue>> entries) {
+    if (entries.empty()) {
       return;
     }
-    std::ifstream file{path_};
-    if (!file.is_open()) {
-      throw std::runtime_error{
-        "WriteAheadLog::replay(): Unable to open file "
-        + std::string(path_) + "."
-      };
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    for (const auto& entry : entries) {
+      encode(
+        state_->buffer,
+        state_->active_format,
+        entry.second.has_value() ? WALRecordType::PUT : WALRecordType::REMOVE,
+        entry,
+        state_->next_lsn++
+      );
     }
+    commit_appended();
+  }
 
-    std::string line;
-    while (std::getline(file, line)) {
-      std::istringstream iss{line};
+  /**
+   * @brief Commit buffered records and sync the active log to disk.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced, including by an earlier timed commit.
+   */
+  void sync() {
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    commit(true);
+  }
 
-      std::string type_str;
-      iss >> type_str;
-      WALRecordType type{std::stoi(type_str)};
+  /**
+   * @brief Seal the active log into a new segment.
+   * @details The next record is appended to a fresh active log, in the
+   * format of the options. If there is no active log, nothing is written to
+   * the returned path. The segment is compressed if a codec is set, and the
+   * LSN reached is saved.
+   * 
+   * @return FilePath Path of the sealed segment.
+   * 
+   * @throw std::filesystem::filesystem_error If the log cannot be renamed.
+   * @throw std::runtime_error If the segment cannot be compressed, or the
+   * LSN cannot be saved.
+   */
+  FilePath seal() {
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    commit(options_.sync_policy != WALSyncPolicy::NONE);
+    close_file();
+    state_->active_format = options_.format;
+    const auto segments{sealed_segments()};
+    const auto id{segments.empty() ? 0 : segments.rbegin()->first + 1};
+    const FilePath segment_path{path_.string() + "." + std::to_string(id)};
+    if (std::filesystem::exists(path_)) {
+      std::filesystem::rename(path_, segment_path);
+      state_->segment_ends[segment_path] = state_->next_lsn;
+      if (options_.compression != Compression::NONE) {
+        compress_segment(segment_path);
+      }
+      writeFile(
+        options_.io_backend,
+        lsn_path(),
+        std::to_string(state_->next_lsn),
+        options_.sync_policy != WALSyncPolicy::NONE
+      );
+    }
+    return segment_path;
+  }
 
-      std::string entry_str;
-      iss >> entry_str;
-      TimeSeriesEntry<TValue> entry{
-        entryFromString<TValue>(entry_str.substr(1))
-      };
+  /**
+   * @brief Release a sealed segment whose memtable has been flushed.
+   * @details When archiving, the segment is renamed into an archive, and
+   * otherwise removed.
+   * 
+   * @param segment_path Path of the segment, as given by seal().
+   */
+  void release(const FilePath& segment_path) noexcept {
+    std::lock_guard lock{state_->mutex};
+    std::error_code ec;
+    const auto end{state_->segment_ends.find(segment_path)};
+    if (end == state_->segment_ends.end()) {
+      std::filesystem::remove(segment_path, ec);
+      return;
+    }
+    if (options_.archive) {
+      std::filesystem::rename(segment_path, archive_path(end->second), ec);
+    }
+    if (!options_.archive || ec) {
+      std::filesystem::remove(segment_path, ec);
+    }
+    state_->segment_ends.erase(end);
+  }
 
-      switch (type) {
-      case WALRecordType::PUT:
-        lsm_tree.put(entry.first, entry.second.value(), false);
-        break;
-      case WALRecordType::REMOVE:
-        lsm_tree.remove(entry.first, false);
+  /**
+   * @brief Remove the archived segments whose records all come before an
+   * LSN.
+   * 
+   * @param lsn LSN that followers have read up to.
+   * 
+   * @throw std::filesystem::filesystem_error If an archive cannot be
+   * removed.
+   */
+  void acknowledge(uint64_t lsn) {
+    std::lock_guard lock{state_->mutex};
+    for (const auto& [end, archive] : archived_segments()) {
+      if (end > lsn) {
         break;
       }
+      std::filesystem::remove(archive);
     }
-    file.close();
+  }
+
+  /**
+   * @brief Copy the log into a checkpoint, up to the next LSN.
+   * @details Commits buffered records, then, with the log locked so that no
+   * segment is sealed or released, calls pin, which gives the sealed
+   * segments the checkpoint needs. These are hard-linked into the directory,
+   * and the active log is opened and its size noted before the log is
+   * unlocked. Its records are copied afterwards, so appends are only held up
+   * while the segments are linked, and a seal in the meantime leaves the
+   * opened file as it was up to that size.
+   * 
+   * @param directory Directory of the checkpoint, which must exist.
+   * @param pin Function that gives the paths of the sealed segments to keep.
+   * @return uint64_t LSN of the next record, before which every record is in
+   * the checkpoint.
+   * 
+   * @throw std::runtime_error If the log cannot be written, or the active
+   * log cannot be read or copied.
+   * @throw std::filesystem::filesystem_error If a segment can be neither
+   * linked nor copied.
+   */
+  uint64_t checkpoint(
+    const FilePath& directory,
+    const std::function<std::set<FilePath>()>& pin
+  ) {
+    uint64_t lsn;
+    uint64_t active_bytes{0};
+    std::ifstream active_log;
+    {
+      std::lock_guard lock{state_->mutex};
+      rethrow_error();
+      commit(false);
+      for (const auto& segment_path : pin()) {
+        if (std::filesystem::exists(segment_path)) {
+          linkFile(segment_path, directory / segment_path.filename());
+        }
+      }
+      lsn = state_->next_lsn;
+      if (std::filesystem::exists(path_)) {
+        active_bytes = std::filesystem::file_size(path_);
+        active_log.open(path_, std::ios::binary);
+        if (!active_log.is_open()) {
+          throw std::runtime_error{
+            "WriteAheadLog::checkpoint(): Unable to open file "
+            + std::string(path_) + "."
+          };
+        }
+      }
+    }
+
+    if (active_log.is_open()) {
+      std::string contents(active_bytes, '\0');
+      active_log.read(
+        contents.data(),
+        static_cast<std::streamsize>(active_bytes)
+      );
+      if (static_cast<uint64_t>(active_log.gcount()) != active_bytes) {
+        throw std::runtime_error{
+          "WriteAheadLog::checkpoint(): Unable to read file "
+          + std::string(path_) + "."
+        };
+      }
+      writeFile(
+        options_.io_backend, directory / path_.filename(), contents, true
+      );
+    }
+    writeFile(
+      options_.io_backend, directory / WAL_LSN_FILENAME, std::to_string(lsn),
+      true
+    );
+    return lsn;
+  }
+
+  /**
+   * @brief Read the records from an LSN on.
+   * @details Commits buffered records first, without syncing them, then
+   * reads the archives, the sealed segments and the active log, skipping
+   * the files that end before the LSN, until at least max_bytes of records
+   * are read or the log is exhausted.
+   * 
+   * @param lsn LSN of the first record to read.
+   * @param max_bytes Number of bytes of records after which reading stops.
+   * @return WALChunk Records, and the LSN to read from next.
+   * 
+   * @throw std::runtime_error If a file cannot be read or written, or if
+   * records from the LSN on are no longer kept.
+   */
+  [[nodiscard]] WALChunk readFrom(uint64_t lsn, uint64_t max_bytes) {
+    std::lock_guard lock{state_->mutex};
+    rethrow_error();
+    commit(false);
+    WALChunk chunk{{}, lsn};
+    if (lsn >= state_->next_lsn) {
+      return chunk;
+    }
+    std::vector<FilePath> files;
+    for (const auto& [end, archive] : archived_segments()) {
+      if (end > lsn) {
+        files.push_back(archive);
+      }
+    }
+    for (const auto& [id, segment_path] : sealed_segments()) {
+      const auto end{state_->segment_ends.find(segment_path)};
+      if (end == state_->segment_ends.end() || end->second > lsn) {
+        files.push_back(segment_path);
+      }
+    }
+    files.push_back(path_);
+
+    for (const auto& file_path : files) {
+      if (!std::filesystem::exists(file_path)) {
+        continue;
+      }
+      for (const auto& record : decode(
+        read_segment(file_path),
+        options_.replay_threads
+      )) {
+        if (!record.lsn || *record.lsn < chunk.next_lsn) {
+          continue;
+        }
+        if (*record.lsn > chunk.next_lsn) {
+          throw std::runtime_error{
+            "WriteAheadLog::readFrom(): Records from LSN "
+            + std::to_string(chunk.next_lsn) + " are no longer kept."
+          };
+        }
+        encode_text(chunk.records, record);
+        chunk.next_lsn = *record.lsn + 1;
+        if (chunk.records.size() >= max_bytes) {
+          return chunk;
+        }
+      }
+    }
+    return chunk;
+  }
+
+  /**
+   * @brief Get the LSN of the next record to be appended.
+   * 
+   * @return uint64_t LSN.
+   */
+  [[nodiscard]] uint64_t nextLSN() const noexcept {
+    std::lock_guard lock{state_->mutex};
+    return state_->next_lsn;
+  }
+
+  /**
+   * @brief Apply records, as read by readFrom(), to an LSM tree.
+   * @details The records are logged again by the LSM tree, under LSNs of
+   * its own log.
+   * 
+   * @param records Records.
+   * @param lsm_tree LSM tree.
+   * @return uint64_t Number of records applied.
+   * 
+   * @throw std::invalid_argument If a record is malformed.
+   * @throw std::runtime_error If writing to the LSM tree fails.
+   */
+  static uint64_t applyRecords(
+    const std::string& records,
+    LSMTree<TValue>& lsm_tree
+  ) {
+    auto decoded{decode(records, 1)};
+    apply_records(decoded, lsm_tree, [](std::optional<uint64_t>) {});
+    return decoded.size();
+  }
+
+  /**
+   * @brief Get the LSN of a record.
+   * 
+   * @param line Record, as a line of the log.
+   * @return std::optional<uint64_t> LSN, or std::nullopt if the record was
+   * written before records had LSNs.
+   */
+  [[nodiscard]] static std::optional<uint64_t> lsnOf(std::string_view line) {
+    const auto first{line.find(' ')};
+    const auto last{line.rfind(' ')};
+    if (first == std::string_view::npos || first == last) {
+      return std::nullopt;
+    }
+    uint64_t lsn;
+    const auto digits{line.substr(last + 1)};
+    const auto [end, error]{
+      std::from_chars(digits.data(), digits.data() + digits.size(), lsn)
+    };
+    if (error != std::errc{} || end != digits.data() + digits.size()) {
+      return std::nullopt;
+    }
+    return lsn;
+  }
+
+  /**
+   * @brief Replay the write-ahead log on the LSM tree.
+   * @details Seals the active log, then replays every sealed segment from
+   * oldest to newest. Each segment is decoded on the replay threads, then
+   * written in batches with LSMTree::putBatch(). Replayed records are logged
+   * again under their own LSNs, so each segment is removed as soon as it
+   * has been replayed. A binary segment is replayed up to its first torn or
+   * corrupt record, and the rest of it is dropped.
+   * 
+   * @param lsm_tree LSM tree.
+   * 
+   * @throw std::runtime_error If a file cannot be opened.
+   * @throw std::invalid_argument If a text record is malformed.
+   */
+  void replay(LSMTree<TValue>& lsm_tree) {
+    if (!std::filesystem::exists(path_) && sealed_segments().empty()) {
+      return;
+    }
+    seal();
+    const auto next_lsn{nextLSN()};
+    for (const auto& [id, segment_path] : sealed_segments()) {
+      auto records{decode(read_segment(segment_path), options_.replay_threads)};
+      apply_records(records, lsm_tree, [this](std::optional<uint64_t> lsn) {
+        if (lsn) {
+          std::lock_guard lock{state_->mutex};
+          state_->next_lsn = *lsn;
+        }
+      });
+      std::filesystem::remove(segment_path);
+      std::lock_guard lock{state_->mutex};
+      state_->segment_ends.erase(segment_path);
+    }
+    std::lock_guard lock{state_->mutex};
+    state_->next_lsn = std::max(state_->next_lsn, next_lsn);
   }
 
   /**
    * @brief Clear the write-ahead log.
+   * @details Discards buffered records, truncates the active log and removes
+   * all sealed segments. Archived segments and the LSN are kept.
    * 
    * @throw std::runtime_error If the file cannot be opened.
    */
   void clear() {
+    std::lock_guard lock{state_->mutex};
+    state_->buffer.clear();
+    state_->error = nullptr;
+    close_file();
+    for (const auto& [id, segment_path] : sealed_segments()) {
+      std::filesystem::remove(segment_path);
+    }
+    state_->segment_ends.clear();
+    state_->active_format = options_.format;
     std::ofstream file{path_};
     if (!file.is_open()) {
       throw std::runtime_error{
@@ -155,11 +611,849 @@ public:
   }
 
 private:
+  /**
+   * @brief State shared with the timer thread.
+   * 
+   */
+  struct State {
+    std::mutex mutex;
+    std::condition_variable_any changed;
+    int fd{-1};
+    uint64_t offset{0};
+    std::string buffer;
+    bool unsynced{false};
+    std::exception_ptr error;
+    uint64_t next_lsn{0};
+    std::map<FilePath, uint64_t> segment_ends;
+    WALFormat active_format{WALFormat::TEXT};
+    std::shared_ptr<IOScheduler> io_scheduler;
+  };
+
+  /**
+   * @brief Record decoded from a log file.
+   * 
+   */
+  struct Record {
+    /**
+     * @brief LSN, or std::nullopt if written before records had LSNs.
+     * 
+     */
+    std::optional<uint64_t> lsn;
+
+    /**
+     * @brief Entry of a put or removal, or range tombstone.
+     * 
+     */
+    std::variant<TimeSeriesEntry<TValue>, RangeTombstone> payload;
+  };
+
+  /**
+   * @brief Encoded record within a log file.
+   * 
+   */
+  struct EncodedRecord {
+    /**
+     * @brief Line of a text record, or contents of a binary one.
+     * 
+     */
+    std::string_view bytes;
+
+    /**
+     * @brief Checksum of the contents of a binary record.
+     * 
+     */
+    uint32_t checksum{0};
+  };
+
+  /**
+   * @brief Encode a put or removal record.
+   * 
+   * @param buffer Buffer to append to.
+   * @param format Format.
+   * @param type Record type.
+   * @param entry Entry.
+   * @param lsn LSN.
+   */
+  static void encode(
+    std::string& buffer,
+    WALFormat format,
+    WALRecordType type,
+    const TimeSeriesEntry<TValue>& entry,
+    uint64_t lsn
+  ) {
+    if (format == WALFormat::BINARY) {
+      const auto start{begin_binary(buffer, type, lsn)};
+      entryToBinary(buffer, entry);
+      end_binary(buffer, start);
+      return;
+    }
+    buffer += std::to_string(static_cast<int>(type));
+    buffer += " ";
+    buffer += entryToString(entry);
+    buffer += " ";
+    buffer += std::to_string(lsn);
+    buffer += "\n";
+  }
+
+  /**
+   * @brief Encode a range tombstone record.
+   * 
+   * @param buffer Buffer to append to.
+   * @param format Format.
+   * @param range_tombstone Range tombstone.
+   * @param lsn LSN.
+   */
+  static void encode_range_tombstone(
+    std::string& buffer,
+    WALFormat format,
+    const RangeTombstone& range_tombstone,
+    uint64_t lsn
+  ) {
+    if (format == WALFormat::BINARY) {
+      const auto start{begin_binary(buffer, WALRecordType::REMOVE_RANGE, lsn)};
+      appendBinary(buffer, std::string_view{range_tombstone.str()});
+      end_binary(buffer, start);
+      return;
+    }
+    buffer += std::to_string(static_cast<int>(WALRecordType::REMOVE_RANGE));
+    buffer += " ";
+    buffer += range_tombstone.str();
+    buffer += " ";
+    buffer += std::to_string(lsn);
+    buffer += "\n";
+  }
+
+  /**
+   * @brief Encode a decoded record as a line of text.
+   * @details The record must have an LSN.
+   * 
+   * @param buffer Buffer to append to.
+   * @param record Record.
+   */
+  static void encode_text(std::string& buffer, const Record& record) {
+    if (const auto* range_tombstone{
+      std::get_if<RangeTombstone>(&record.payload)
+    }) {
+      encode_range_tombstone(
+        buffer,
+        WALFormat::TEXT,
+        *range_tombstone,
+        *record.lsn
+      );
+      return;
+    }
+    const auto& entry{std::get<TimeSeriesEntry<TValue>>(record.payload)};
+    encode(
+      buffer,
+      WALFormat::TEXT,
+      entry.second.has_value() ? WALRecordType::PUT : WALRecordType::REMOVE,
+      entry,
+      *record.lsn
+    );
+  }
+
+  /**
+   * @brief Start a binary record, leaving room for its header.
+   * 
+   * @param buffer Buffer to append to.
+   * @param type Record type.
+   * @param lsn LSN.
+   * @return size_t Position of the record in the buffer.
+   */
+  static size_t begin_binary(
+    std::string& buffer,
+    WALRecordType type,
+    uint64_t lsn
+  ) {
+    const auto start{buffer.size()};
+    buffer.append(WAL_BINARY_HEADER_BYTES, '\0');
+    appendBinary(buffer, static_cast<uint8_t>(type));
+    appendBinary(buffer, lsn);
+    return start;
+  }
+
+  /**
+   * @brief Finish a binary record by filling in its length and checksum.
+   * 
+   * @param buffer Buffer holding the record at its end.
+   * @param start Position of the record in the buffer.
+   */
+  static void end_binary(std::string& buffer, size_t start) {
+    const auto contents{
+      std::string_view{buffer}.substr(start + WAL_BINARY_HEADER_BYTES)
+    };
+    const auto length{static_cast<uint32_t>(contents.size())};
+    const auto checksum{crc32c(contents)};
+    std::memcpy(buffer.data() + start, &length, sizeof(length));
+    std::memcpy(
+      buffer.data() + start + sizeof(length),
+      &checksum,
+      sizeof(checksum)
+    );
+  }
+
+  /**
+   * @brief Commit freshly appended records according to the sync policy.
+   * @details Must be called with the state mutex held.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced.
+   */
+  void commit_appended() {
+    switch (options_.sync_policy) {
+    case WALSyncPolicy::NONE:
+      commit(false);
+      break;
+    case WALSyncPolicy::EVERY_WRITE:
+      commit(true);
+      break;
+    case WALSyncPolicy::INTERVAL:
+      break;
+    case WALSyncPolicy::BYTES:
+      if (state_->buffer.size() >= options_.sync_bytes) {
+        commit(true);
+      }
+      break;
+    }
+  }
+
+  /**
+   * @brief Start the timer thread that commits buffered records.
+   * 
+   */
+  void start_timer() {
+    timer_ = std::jthread{[
+      state = state_.get(), path = path_, interval = options_.sync_interval,
+      io_backend = options_.io_backend
+    ](std::stop_token stop_token) {
+      std::unique_lock lock{state->mutex};
+      while (!stop_token.stop_requested()) {
+        state->changed.wait_for(lock, stop_token, interval, [] {
+          return false;
+        });
+        if (state->error) {
+          continue;
+        }
+        try {
+          commit(*state, path, io_backend, true);
+        } catch (...) {
+          state->error = std::current_exception();
+        }
+      }
+    }};
+  }
+
+  /**
+   * @brief Commit buffered records to the active log.
+   * @details Must be called with the state mutex held. Opens the active log
+   * if there is anything to write, and starts a new binary log with its
+   * magic bytes.
+   * 
+   * @param state State.
+   * @param path Path of the active log.
+   * @param io_backend Backend that writes the active log.
+   * @param sync Whether to sync the active log to disk.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced.
+   */
+  static void commit(
+    State& state,
+    const FilePath& path,
+    IOBackend io_backend,
+    bool sync
+  ) {
+    if (state.fd == -1 && !state.buffer.empty()) {
+      open_file(state, path);
+    }
+    if (state.offset == 0 && state.active_format == WALFormat::BINARY
+      && !state.buffer.empty() && !state.buffer.starts_with(WAL_BINARY_MAGIC)) {
+      state.buffer.insert(0, WAL_BINARY_MAGIC);
+    }
+    if (!state.buffer.empty() || (sync && state.unsynced)) {
+      write_buffer(state, io_backend, sync);
+    }
+  }
+
+  /**
+   * @brief Commit buffered records to this log's active log.
+   * @details Must be called with the state mutex held.
+   * 
+   * @param sync Whether to sync the active log to disk.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, written or
+   * synced.
+   */
+  void commit(bool sync) {
+    commit(*state_, path_, options_.io_backend, sync);
+  }
+
+  /**
+   * @brief Write the buffer to the end of the active log in a single write,
+   * and sync the active log if asked to.
+   * @details Must be called with the state mutex held. The active log must
+   * be open. Waits for the I/O scheduler, if any, to grant the write.
+   * Whatever was written is dropped from the buffer, even if the write fails
+   * part way.
+   * 
+   * @param state State.
+   * @param io_backend Backend that writes the active log.
+   * @param sync Whether to sync the active log to disk.
+   * 
+   * @throw std::runtime_error If the file cannot be written or synced.
+   */
+  static void write_buffer(State& state, IOBackend io_backend, bool sync) {
+    if (state.io_scheduler && !state.buffer.empty()) {
+      state.io_scheduler->request(IOPriority::WAL, state.buffer.size());
+    }
+    const auto result{
+      writeAt(io_backend, state.fd, state.offset, state.buffer, sync)
+    };
+    state.offset += result.written;
+    state.buffer.erase(0, result.written);
+    if (result.written > 0) {
+      state.unsynced = true;
+    }
+    if (!result) {
+      throw std::runtime_error{
+        state.buffer.empty()
+          ? "WriteAheadLog::write_buffer(): Unable to sync the log."
+          : "WriteAheadLog::write_buffer(): Unable to write to the log."
+      };
+    }
+    if (sync) {
+      state.unsynced = false;
+    }
+  }
+
+  /**
+   * @brief Open the active log for appending.
+   * @details Must be called with the state mutex held. Writes then go to the
+   * end of the log, as tracked by the offset of the state.
+   * 
+   * @param state State.
+   * @param path Path of the active log.
+   * 
+   * @throw std::runtime_error If the file cannot be opened.
+   */
+  static void open_file(State& state, const FilePath& path) {
+    state.fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    const auto end{state.fd == -1 ? -1 : ::lseek(state.fd, 0, SEEK_END)};
+    if (end == -1) {
+      if (state.fd != -1) {
+        ::close(state.fd);
+        state.fd = -1;
+      }
+      throw std::runtime_error{
+        "WriteAheadLog::open_file(): Unable to open file "
+        + std::string(path) + "."
+      };
+    }
+    state.offset = static_cast<uint64_t>(end);
+  }
+
+  /**
+   * @brief Close the active log if it is open.
+   * @details Must be called with the state mutex held.
+   * 
+   */
+  void close_file() noexcept {
+    if (state_->fd != -1) {
+      ::close(state_->fd);
+      state_->fd = -1;
+      state_->unsynced = false;
+    }
+  }
+
+  /**
+   * @brief Stop the timer thread, then commit and close the active log.
+   * @details Errors are ignored, since there is no one to report them to.
+   * 
+   */
+  void close() noexcept {
+    if (!state_) {
+      return;
+    }
+    if (timer_.joinable()) {
+      timer_.request_stop();
+      timer_.join();
+    }
+    std::lock_guard lock{state_->mutex};
+    try {
+      commit(options_.sync_policy != WALSyncPolicy::NONE);
+    } catch (...) {}
+    close_file();
+  }
+
+  /**
+   * @brief Rethrow the error from a failed timed commit, if any.
+   * @details Must be called with the state mutex held. The error is cleared.
+   * 
+   * @throw std::exception Error from the timer thread.
+   */
+  void rethrow_error() {
+    if (state_->error) {
+      std::rethrow_exception(std::exchange(state_->error, nullptr));
+    }
+  }
+
+  /**
+   * @brief Get the sealed segments of the log, ordered by ID.
+   * 
+   * @return std::map<uint64_t, FilePath> Segment paths by ID.
+   */
+  [[nodiscard]] std::map<uint64_t, FilePath> sealed_segments() const {
+    std::map<uint64_t, FilePath> segments;
+    const auto directory{path_.parent_path()};
+    if (!std::filesystem::exists(directory)) {
+      return segments;
+    }
+    const auto prefix{path_.filename().string() + "."};
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+      const auto filename{file.path().filename().string()};
+      if (!file.is_regular_file() || !filename.starts_with(prefix)) {
+        continue;
+      }
+      const auto id_str{filename.substr(prefix.size())};
+      if (
+        id_str.empty() ||
+        !std::all_of(id_str.begin(), id_str.end(), ::isdigit)
+      ) {
+        continue;
+      }
+      segments.emplace(std::stoull(id_str), file.path());
+    }
+    return segments;
+  }
+
+  /**
+   * @brief Get the archived segments of the log, ordered by the LSN just
+   * past their last record.
+   * 
+   * @return std::map<uint64_t, FilePath> Archive paths by end LSN.
+   */
+  [[nodiscard]] std::map<uint64_t, FilePath> archived_segments() const {
+    std::map<uint64_t, FilePath> archives;
+    const auto directory{path_.parent_path()};
+    if (!std::filesystem::exists(directory)) {
+      return archives;
+    }
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+      const auto filename{file.path().filename().string()};
+      if (!file.is_regular_file() || !filename.starts_with(WAL_ARCHIVE_PREFIX)) {
+        continue;
+      }
+      const auto lsn_str{filename.substr(WAL_ARCHIVE_PREFIX.size())};
+      if (
+        lsn_str.empty() ||
+        !std::all_of(lsn_str.begin(), lsn_str.end(), ::isdigit)
+      ) {
+        continue;
+      }
+      archives.emplace(std::stoull(lsn_str), file.path());
+    }
+    return archives;
+  }
+
+  /**
+   * @brief Get the path of an archived segment.
+   * 
+   * @param end_lsn LSN just past the last record of the segment.
+   * @return FilePath Path.
+   */
+  [[nodiscard]] FilePath archive_path(uint64_t end_lsn) const {
+    return path_.parent_path()
+      / (std::string{WAL_ARCHIVE_PREFIX} + std::to_string(end_lsn));
+  }
+
+  /**
+   * @brief Get the path of the saved LSN.
+   * 
+   * @return FilePath Path.
+   */
+  [[nodiscard]] FilePath lsn_path() const {
+    return path_.parent_path() / WAL_LSN_FILENAME;
+  }
+
+  /**
+   * @brief Pick up where the log left off on opening it.
+   * @details Carries on from the LSN saved by the last seal, or one past the
+   * last record of the active log, whichever is greater. An active log that
+   * has records keeps its format, and a binary one is cut short before its
+   * first torn or corrupt record, so that appends follow the last good one.
+   * 
+   * @throw std::runtime_error If the active log cannot be read.
+   * @throw std::filesystem::filesystem_error If the active log cannot be
+   * truncated.
+   */
+  void recover() {
+    uint64_t next_lsn{0};
+    if (std::ifstream file{lsn_path()}; file.is_open()) {
+      file >> next_lsn;
+    }
+    state_->active_format = options_.format;
+    if (std::filesystem::exists(path_)) {
+      const auto contents{read_file(path_)};
+      if (contents.starts_with(WAL_BINARY_MAGIC)) {
+        state_->active_format = WALFormat::BINARY;
+        uint64_t valid_bytes{WAL_BINARY_MAGIC.size()};
+        for (const auto& record : split_binary(contents)) {
+          if (crc32c(record.bytes) != record.checksum) {
+            break;
+          }
+          auto pos{record.bytes.data() + sizeof(uint8_t)};
+          const auto lsn{readBinary<uint64_t>(pos, record.bytes.data()
+            + record.bytes.size())};
+          next_lsn = std::max(next_lsn, lsn + 1);
+          valid_bytes = static_cast<uint64_t>(
+            record.bytes.data() + record.bytes.size() - contents.data()
+          );
+        }
+        if (valid_bytes < contents.size()) {
+          std::filesystem::resize_file(path_, valid_bytes);
+        }
+      } else {
+        if (!contents.empty()) {
+          state_->active_format = WALFormat::TEXT;
+        }
+        std::istringstream file{contents};
+        std::string line;
+        while (std::getline(file, line)) {
+          if (const auto lsn{lsnOf(line)}) {
+            next_lsn = std::max(next_lsn, *lsn + 1);
+          }
+        }
+      }
+    }
+    state_->next_lsn = next_lsn;
+  }
+
+  /**
+   * @brief Read a whole file.
+   * 
+   * @param file_path Path of the file.
+   * @return std::string Contents.
+   * 
+   * @throw std::runtime_error If the file cannot be opened.
+   */
+  [[nodiscard]] static std::string read_file(const FilePath& file_path) {
+    std::ifstream file{file_path, std::ios::binary};
+    if (!file.is_open()) {
+      throw std::runtime_error{
+        "WriteAheadLog::read_file(): Unable to open file "
+        + std::string(file_path) + "."
+      };
+    }
+    return std::string{
+      std::istreambuf_iterator<char>{file},
+      std::istreambuf_iterator<char>{}
+    };
+  }
+
+  /**
+   * @brief Compress a sealed segment in place.
+   * @details The compressed segment is written next to the plain one and
+   * renamed over it, so a crash leaves either of them intact. It is synced
+   * first unless the sync policy is NONE. Segments that do not shrink are
+   * left plain.
+   * 
+   * @param segment_path Path of the segment.
+   * 
+   * @throw std::runtime_error If the segment cannot be read or written.
+   */
+  void compress_segment(const FilePath& segment_path) {
+    const auto plain{read_file(segment_path)};
+    const auto compressed{compress(options_.compression, plain)};
+    std::string contents{WAL_COMPRESSED_MAGIC};
+    appendBinary(contents, static_cast<uint8_t>(options_.compression));
+    appendBinary(contents, static_cast<uint64_t>(plain.size()));
+    if (contents.size() + compressed.size() >= plain.size()) {
+      return;
+    }
+    contents.append(compressed);
+
+    const FilePath temp_path{segment_path.string() + ".tmp"};
+    try {
+      writeFile(
+        options_.io_backend, temp_path, contents,
+        options_.sync_policy != WALSyncPolicy::NONE
+      );
+    } catch (...) {
+      std::filesystem::remove(temp_path);
+      throw;
+    }
+    std::filesystem::rename(temp_path, segment_path);
+  }
+
+  /**
+   * @brief Read a whole log file.
+   * @details Compressed segments are decompressed.
+   * 
+   * @param file_path Path of the log file.
+   * @return std::string Records.
+   * 
+   * @throw std::runtime_error If the file cannot be opened, or if a
+   * compressed segment is malformed.
+   */
+  [[nodiscard]] static std::string read_segment(const FilePath& file_path) {
+    auto contents{read_file(file_path)};
+    if (!contents.starts_with(WAL_COMPRESSED_MAGIC)) {
+      return contents;
+    }
+    const char* pos{contents.data() + WAL_COMPRESSED_MAGIC.size()};
+    const char* end{contents.data() + contents.size()};
+    const auto codec{static_cast<Compression>(readBinary<uint8_t>(pos, end))};
+    const auto plain_size{readBinary<uint64_t>(pos, end)};
+    std::string plain(plain_size, '\0');
+    decompress(
+      codec,
+      std::string_view{pos, static_cast<size_t>(end - pos)},
+      plain
+    );
+    return plain;
+  }
+
+  /**
+   * @brief Split the contents of a binary log file into records.
+   * @details Stops at a record that runs past the end, which a crash tore.
+   * 
+   * @param contents Contents, starting with the magic bytes.
+   * @return std::vector<EncodedRecord> Records.
+   */
+  [[nodiscard]] static std::vector<EncodedRecord> split_binary(
+    std::string_view contents
+  ) {
+    std::vector<EncodedRecord> records;
+    auto pos{contents.data() + WAL_BINARY_MAGIC.size()};
+    const auto end{contents.data() + contents.size()};
+    while (static_cast<uint64_t>(end - pos) >= WAL_BINARY_HEADER_BYTES) {
+      const auto length{readBinary<uint32_t>(pos, end)};
+      const auto checksum{readBinary<uint32_t>(pos, end)};
+      if (length > static_cast<uint64_t>(end - pos)) {
+        break;
+      }
+      records.push_back({std::string_view{pos, length}, checksum});
+      pos += length;
+    }
+    return records;
+  }
+
+  /**
+   * @brief Split the contents of a text log file into records.
+   * 
+   * @param contents Contents.
+   * @return std::vector<EncodedRecord> Records, one per non-empty line.
+   */
+  [[nodiscard]] static std::vector<EncodedRecord> split_text(
+    std::string_view contents
+  ) {
+    std::vector<EncodedRecord> records;
+    while (!contents.empty()) {
+      const auto newline{contents.find('\n')};
+      const auto line{contents.substr(0, newline)};
+      if (!line.empty()) {
+        records.push_back({line});
+      }
+      contents = newline == std::string_view::npos
+        ? std::string_view{}
+        : contents.substr(newline + 1);
+    }
+    return records;
+  }
+
+  /**
+   * @brief Decode the contents of a log file.
+   * @details The file is split into records, which are decoded in runs of
+   * at least WAL_MIN_DECODE_RUN records on up to the given number of
+   * threads. Binary records are decoded up to the first whose checksum does
+   * not match.
+   * 
+   * @param contents Contents, decompressed.
+   * @param threads Number of threads.
+   * @return std::vector<Record> Records, in order.
+   * 
+   * @throw std::invalid_argument If a text record is malformed.
+   * @throw std::runtime_error If a binary record is malformed.
+   */
+  [[nodiscard]] static std::vector<Record> decode(
+    std::string_view contents,
+    uint64_t threads
+  ) {
+    const auto binary{contents.starts_with(WAL_BINARY_MAGIC)};
+    const auto encoded{binary ? split_binary(contents) : split_text(contents)};
+    const auto runs{std::clamp<uint64_t>(
+      encoded.size() / WAL_MIN_DECODE_RUN,
+      1,
+      std::max<uint64_t>(threads, 1)
+    )};
+    const auto bound{[&](uint64_t run) {
+      return encoded.size() * run / runs;
+    }};
+
+    std::vector<std::vector<Record>> decoded(runs);
+    std::vector<std::exception_ptr> errors(runs);
+    const auto decode_run{[&](uint64_t run) {
+      try {
+        decoded[run].reserve(bound(run + 1) - bound(run));
+        for (auto i{bound(run)}; i < bound(run + 1); ++i) {
+          if (binary && crc32c(encoded[i].bytes) != encoded[i].checksum) {
+            return;
+          }
+          decoded[run].push_back(binary
+            ? decode_binary(encoded[i].bytes)
+            : decode_text(encoded[i].bytes)
+          );
+        }
+      } catch (...) {
+        errors[run] = std::current_exception();
+      }
+    }};
+    {
+      std::vector<std::jthread> workers;
+      workers.reserve(runs - 1);
+      for (uint64_t run{1}; run < runs; ++run) {
+        workers.emplace_back(decode_run, run);
+      }
+      decode_run(0);
+    }
+
+    std::vector<Record> records;
+    records.reserve(encoded.size());
+    for (uint64_t run{0}; run < runs; ++run) {
+      for (auto& record : decoded[run]) {
+        records.push_back(std::move(record));
+      }
+      if (errors[run]) {
+        std::rethrow_exception(errors[run]);
+      }
+      if (decoded[run].size() < bound(run + 1) - bound(run)) {
+        break;
+      }
+    }
+    return records;
+  }
+
+  /**
+   * @brief Decode a text record.
+   * 
+   * @param line Line of the record.
+   * @return Record Record.
+   * 
+   * @throw std::invalid_argument If the record is malformed.
+   */
+  [[nodiscard]] static Record decode_text(std::string_view line) {
+    std::istringstream iss{std::string{line}};
+
+    std::string type_str;
+    iss >> type_str;
+    WALRecordType type{std::stoi(type_str)};
+
+    std::string entry_str;
+    iss >> entry_str;
+    if (type == WALRecordType::REMOVE_RANGE) {
+      return {lsnOf(line), RangeTombstone{entry_str}};
+    }
+    return {lsnOf(line), entryFromString<TValue>(entry_str.substr(1))};
+  }
+
+  /**
+   * @brief Decode a binary record.
+   * 
+   * @param bytes Contents of the record.
+   * @return Record Record.
+   * 
+   * @throw std::runtime_error If the record is malformed.
+   */
+  [[nodiscard]] static Record decode_binary(std::string_view bytes) {
+    auto pos{bytes.data()};
+    const auto end{bytes.data() + bytes.size()};
+    const WALRecordType type{readBinary<uint8_t>(pos, end)};
+    const auto lsn{readBinary<uint64_t>(pos, end)};
+    if (type == WALRecordType::REMOVE_RANGE) {
+      return {lsn, RangeTombstone{std::string{readBinaryString(pos, end)}}};
+    }
+    return {lsn, entryFromBinary<TValue>(pos, end)};
+  }
+
+  /**
+   * @brief Apply decoded records to an LSM tree, in order.
+   * @details Runs of puts and removals with consecutive LSNs are written
+   * together with LSMTree::putBatch(), so that each memtable's worth is
+   * logged with one write and applied under one lock.
+   * 
+   * @tparam OnBatch Callable taking the std::optional<uint64_t> LSN of the
+   * first record of each batch, called just before it is written.
+   * @param records Records, which are moved from.
+   * @param lsm_tree LSM tree.
+   * @param on_batch Callable.
+   * 
+   * @throw std::runtime_error If writing to the LSM tree fails.
+   */
+  template <typename OnBatch>
+  static void apply_records(
+    std::vector<Record>& records,
+    LSMTree<TValue>& lsm_tree,
+    OnBatch&& on_batch
+  ) {
+    std::vector<TimeSeriesEntry<TValue>> batch;
+    std::optional<uint64_t> batch_lsn;
+    const auto write_batch{[&] {
+      if (batch.empty()) {
+        return;
+      }
+      on_batch(batch_lsn);
+      lsm_tree.putBatch(batch);
+      batch.clear();
+    }};
+    for (auto& record : records) {
+      if (const auto* range_tombstone{
+        std::get_if<RangeTombstone>(&record.payload)
+      }) {
+        write_batch();
+        on_batch(record.lsn);
+        lsm_tree.removeRange(*range_tombstone);
+        continue;
+      }
+      const auto follows{
+        batch_lsn.has_value() == record.lsn.has_value()
+        && (!batch_lsn || *batch_lsn + batch.size() == *record.lsn)
+      };
+      if (!follows) {
+        write_batch();
+      }
+      if (batch.empty()) {
+        batch_lsn = record.lsn;
+      }
+      batch.push_back(
+        std::move(std::get<TimeSeriesEntry<TValue>>(record.payload))
+      );
+    }
+    write_batch();
+  }
+
   /**
    * @brief Path.
    * 
    */
   FilePath path_;
+
+  /**
+   * @brief Options.
+   * 
+   */
+  WALOptions options_;
+
+  /**
+   * @brief State shared with the timer thread.
+   * 
+   */
+  std::unique_ptr<State> state_;
+
+  /**
+   * @brief Timer thread for the INTERVAL policy.
+   * 
+   */
+  std::jthread timer_;
 };
 }  // namespace vkdb
 
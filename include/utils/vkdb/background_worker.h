@@ -0,0 +1,139 @@
+#ifndef UTILS_BACKGROUND_WORKER_H
+#define UTILS_BACKGROUND_WORKER_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+namespace vkdb {
+/**
+ * @brief Single background thread that runs a task whenever it is scheduled.
+ * @details Scheduling while the task is running makes it run once more
+ * afterwards, so requests are coalesced rather than queued.
+ *
+ */
+class BackgroundWorker {
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * @brief Construct a new BackgroundWorker object.
+   * @details No thread is started until start() is called.
+   *
+   */
+  BackgroundWorker() noexcept;
+
+  /**
+   * @brief Move-construct a BackgroundWorker object.
+   * @details Stops the other worker, since its task may refer to the object
+   * that is being moved. The new worker must be started again.
+   *
+   */
+  BackgroundWorker(BackgroundWorker&& other) noexcept;
+
+  /**
+   * @brief Move-assign a BackgroundWorker object.
+   * @details Stops both workers. This worker must be started again.
+   *
+   */
+  BackgroundWorker& operator=(BackgroundWorker&& other) noexcept;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  BackgroundWorker(const BackgroundWorker&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+  /**
+   * @brief Destroy the BackgroundWorker object.
+   * @details Stops the worker.
+   *
+   */
+  ~BackgroundWorker() noexcept;
+
+  /**
+   * @brief Start the worker thread with the given task.
+   * @details Does nothing if the worker is already running.
+   *
+   * @param task Task.
+   */
+  void start(Task task);
+
+  /**
+   * @brief Schedule the task to run on the worker thread.
+   *
+   */
+  void schedule() noexcept;
+
+  /**
+   * @brief Block until the worker has no scheduled or running task.
+   *
+   */
+  void waitUntilIdle() const noexcept;
+
+  /**
+   * @brief Stop the worker thread.
+   * @details A scheduled task is run before the thread exits.
+   *
+   */
+  void stop() noexcept;
+
+  /**
+   * @brief Check if the worker thread is running.
+   *
+   * @return true if the worker thread is running.
+   * @return false if the worker thread is not running.
+   */
+  [[nodiscard]] bool running() const noexcept;
+
+private:
+  /**
+   * @brief State shared with the worker thread.
+   *
+   */
+  struct State {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool scheduled{false};
+    bool busy{false};
+    bool stopping{false};
+    bool started{false};
+  };
+
+  /**
+   * @brief Run the worker loop.
+   *
+   */
+  void run() noexcept;
+
+  /**
+   * @brief Task.
+   *
+   */
+  Task task_;
+
+  /**
+   * @brief Shared state.
+   *
+   */
+  std::unique_ptr<State> state_;
+
+  /**
+   * @brief Worker thread.
+   * @details Only assigned under the state's mutex; other threads check
+   * State::started instead.
+   *
+   */
+  std::thread thread_;
+};
+}  // namespace vkdb
+
+#endif // UTILS_BACKGROUND_WORKER_H
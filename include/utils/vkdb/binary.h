@@ -0,0 +1,303 @@
+#ifndef UTILS_BINARY_H
+#define UTILS_BINARY_H
+
+#include <vkdb/time_series_key.h>
+#include <vkdb/concepts.h>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <tuple>
+
+namespace vkdb {
+/**
+ * @brief Type alias for the length prefix of binary-encoded strings.
+ *
+ */
+using BinaryLength = uint16_t;
+
+/**
+ * @brief Append the raw bytes of a trivially copyable value to a buffer.
+ *
+ * @tparam T Value type.
+ * @param buffer Buffer.
+ * @param value Value.
+ */
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+void appendBinary(std::string& buffer, const T& value) noexcept {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Append a length-prefixed string to a buffer.
+ *
+ * @param buffer Buffer.
+ * @param str String.
+ *
+ * @throw std::length_error If the string is too long to be length-prefixed.
+ */
+inline void appendBinary(std::string& buffer, std::string_view str) {
+  if (str.size() > std::numeric_limits<BinaryLength>::max()) {
+    throw std::length_error{
+      "appendBinary(): String of length " + std::to_string(str.size())
+      + " is too long to encode."
+    };
+  }
+  appendBinary(buffer, static_cast<BinaryLength>(str.size()));
+  buffer.append(str);
+}
+
+/**
+ * @brief Read the raw bytes of a trivially copyable value from a buffer.
+ * @details Advances the position past the value.
+ *
+ * @tparam T Value type.
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ * @return T Value.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+T readBinary(const char*& pos, const char* end) {
+  if (end - pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+    throw std::runtime_error{"readBinary(): Unexpected end of buffer."};
+  }
+  T value;
+  std::memcpy(&value, pos, sizeof(T));
+  pos += sizeof(T);
+  return value;
+}
+
+/**
+ * @brief Read a length-prefixed string from a buffer without copying.
+ * @details Advances the position past the string. The view is only valid
+ * for as long as the buffer is.
+ *
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ * @return std::string_view View of the string.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+inline std::string_view readBinaryString(const char*& pos, const char* end) {
+  const auto length{readBinary<BinaryLength>(pos, end)};
+  if (end - pos < length) {
+    throw std::runtime_error{"readBinaryString(): Unexpected end of buffer."};
+  }
+  std::string_view str{pos, length};
+  pos += length;
+  return str;
+}
+
+/**
+ * @brief Append an unsigned integer to a buffer as a varint.
+ * @details Seven bits are written per byte, least significant first, with
+ * the high bit set on every byte but the last.
+ *
+ * @param buffer Buffer.
+ * @param value Value.
+ */
+inline void appendVarint(std::string& buffer, uint64_t value) noexcept {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Read a varint from a buffer.
+ * @details Advances the position past the varint.
+ *
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ * @return uint64_t Value.
+ *
+ * @throw std::runtime_error If the buffer is too short or the varint is too
+ * long.
+ */
+inline uint64_t readVarint(const char*& pos, const char* end) {
+  uint64_t value{0};
+  for (uint32_t shift{0}; shift < 64; shift += 7) {
+    if (pos == end) {
+      throw std::runtime_error{"readVarint(): Unexpected end of buffer."};
+    }
+    const auto byte{static_cast<uint8_t>(*pos++)};
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error{"readVarint(): Varint is too long."};
+}
+
+/**
+ * @brief Map a signed integer to an unsigned one, so that values close to
+ * zero become small.
+ *
+ * @param value Value.
+ * @return uint64_t Zigzag-encoded value.
+ */
+[[nodiscard]] constexpr uint64_t zigzagEncode(int64_t value) noexcept {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+/**
+ * @brief Invert zigzagEncode().
+ *
+ * @param value Zigzag-encoded value.
+ * @return int64_t Value.
+ */
+[[nodiscard]] constexpr int64_t zigzagDecode(uint64_t value) noexcept {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Append a binary-encoded TimeSeriesKey to a buffer.
+ * @details The key is encoded as a fixed-width timestamp, followed by the
+ * length-prefixed metric, the tag count, and the length-prefixed tag keys
+ * and values.
+ *
+ * @param buffer Buffer.
+ * @param key Key.
+ *
+ * @throw std::length_error If a string in the key is too long to encode.
+ */
+inline void keyToBinary(std::string& buffer, const TimeSeriesKey& key) {
+  appendBinary(buffer, key.timestamp());
+  appendBinary(buffer, std::string_view{key.metric()});
+  appendBinary(buffer, static_cast<BinaryLength>(key.tags().size()));
+  for (const auto& [tag_key, tag_value] : key.tags()) {
+    appendBinary(buffer, std::string_view{tag_key});
+    appendBinary(buffer, std::string_view{tag_value});
+  }
+}
+
+/**
+ * @brief Read a binary-encoded TimeSeriesKey from a buffer.
+ * @details Advances the position past the key.
+ *
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ * @return TimeSeriesKey Key.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+inline TimeSeriesKey keyFromBinary(const char*& pos, const char* end) {
+  const auto timestamp{readBinary<Timestamp>(pos, end)};
+  Metric metric{readBinaryString(pos, end)};
+  const auto no_of_tags{readBinary<BinaryLength>(pos, end)};
+  TagTable tags;
+  for (BinaryLength i{0}; i < no_of_tags; ++i) {
+    TagKey tag_key{readBinaryString(pos, end)};
+    TagValue tag_value{readBinaryString(pos, end)};
+    tags.emplace(std::move(tag_key), std::move(tag_value));
+  }
+  return TimeSeriesKey{timestamp, std::move(metric), std::move(tags)};
+}
+
+/**
+ * @brief Skip over a binary-encoded TimeSeriesKey in a buffer.
+ * @details Advances the position past the key without allocating.
+ *
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+inline void skipKeyBinary(const char*& pos, const char* end) {
+  std::ignore = readBinary<Timestamp>(pos, end);
+  std::ignore = readBinaryString(pos, end);
+  const auto no_of_tags{readBinary<BinaryLength>(pos, end)};
+  for (BinaryLength i{0}; i < no_of_tags; ++i) {
+    std::ignore = readBinaryString(pos, end);
+    std::ignore = readBinaryString(pos, end);
+  }
+}
+
+/**
+ * @brief Append a binary-encoded TimeSeriesEntry to a buffer.
+ * @details The entry is encoded as its binary key, a presence flag, and the
+ * raw bytes of the value if it is present.
+ *
+ * @tparam TValue Value type.
+ * @param buffer Buffer.
+ * @param entry Entry.
+ *
+ * @throw std::length_error If a string in the key is too long to encode.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+void entryToBinary(std::string& buffer, const TimeSeriesEntry<TValue>& entry) {
+  keyToBinary(buffer, entry.first);
+  appendBinary(buffer, static_cast<uint8_t>(entry.second.has_value()));
+  if (entry.second.has_value()) {
+    appendBinary(buffer, entry.second.value());
+  }
+}
+
+/**
+ * @brief Read the value of a binary-encoded TimeSeriesEntry from a buffer.
+ * @details Advances the position past the value.
+ *
+ * @tparam TValue Value type.
+ * @param pos Position in the buffer, just after the entry's key.
+ * @param end End of the buffer.
+ * @return std::optional<TValue> Value.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+std::optional<TValue> valueFromBinary(const char*& pos, const char* end) {
+  const auto has_value{readBinary<uint8_t>(pos, end)};
+  if (!has_value) {
+    return std::nullopt;
+  }
+  return readBinary<TValue>(pos, end);
+}
+
+/**
+ * @brief Skip over the value of a binary-encoded TimeSeriesEntry in a buffer.
+ * @details Advances the position past the value.
+ *
+ * @tparam TValue Value type.
+ * @param pos Position in the buffer, just after the entry's key.
+ * @param end End of the buffer.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+void skipValueBinary(const char*& pos, const char* end) {
+  const auto has_value{readBinary<uint8_t>(pos, end)};
+  if (has_value) {
+    if (end - pos < static_cast<std::ptrdiff_t>(sizeof(TValue))) {
+      throw std::runtime_error{"skipValueBinary(): Unexpected end of buffer."};
+    }
+    pos += sizeof(TValue);
+  }
+}
+
+/**
+ * @brief Read a binary-encoded TimeSeriesEntry from a buffer.
+ * @details Advances the position past the entry.
+ *
+ * @tparam TValue Value type.
+ * @param pos Position in the buffer.
+ * @param end End of the buffer.
+ * @return TimeSeriesEntry<TValue> Entry.
+ *
+ * @throw std::runtime_error If the buffer is too short.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+TimeSeriesEntry<TValue> entryFromBinary(const char*& pos, const char* end) {
+  auto key{keyFromBinary(pos, end)};
+  auto value{valueFromBinary<TValue>(pos, end)};
+  return {std::move(key), value};
+}
+}  // namespace vkdb
+
+#endif // UTILS_BINARY_H
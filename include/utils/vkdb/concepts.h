@@ -50,11 +50,14 @@ concept ArithmeticNoCVRefQuals = Arithmetic<T> && HasNoCVRefQuals<T>;
  * @brief Concept for types that are all the same as another after
  * removing cv- and ref-qualifiers.
  * 
- * @tparam Ts Types to compare.
+ * @details Used as a type-constraint on a parameter pack, this is checked
+ * for every type in the pack.
+ * 
+ * @tparam T Type to compare.
  * @tparam U Type to compare against.
  */
-template <typename... Ts, typename U>
-concept AllSameNoCVRefQuals = (SameNoCVRefQuals<Ts, U> && ...);
+template <typename T, typename U>
+concept AllSameNoCVRefQuals = SameNoCVRefQuals<T, U>;
 
 /**
  * @brief Concept for a type that is convertible to another and
@@ -71,12 +74,14 @@ concept ConvertibleToNoCVRefQuals
  * @brief Concept for types that are all convertible to another and
  * have no cv- or ref-qualifiers.
  * 
- * @tparam Ts Types to convert.
+ * @details Used as a type-constraint on a parameter pack, this is checked
+ * for every type in the pack.
+ * 
+ * @tparam T Type to convert.
  * @tparam U Type to convert to.
  */
-template <typename... Ts, typename U>
-concept AllConvertibleToNoCVRefQuals
-  = (ConvertibleToNoCVRefQuals<Ts, U> && ...);
+template <typename T, typename U>
+concept AllConvertibleToNoCVRefQuals = ConvertibleToNoCVRefQuals<T, U>;
 
 /**
  * @brief Concept for a type that is constructible to another and
@@ -93,12 +98,14 @@ concept ConstructibleToNoCVRefQuals
  * @brief Concept for types that are all constructible to another and
  * have no cv- or ref-qualifiers.
  * 
- * @tparam Ts Types to construct from.
+ * @details Used as a type-constraint on a parameter pack, this is checked
+ * for every type in the pack.
+ * 
+ * @tparam T Type to construct from.
  * @tparam U Type to construct to.
  */
-template <typename... Ts, typename U>
-concept AllConstructibleToNoCVRefQuals
-  = (ConstructibleToNoCVRefQuals<Ts, U> && ...);
+template <typename T, typename U>
+concept AllConstructibleToNoCVRefQuals = ConstructibleToNoCVRefQuals<T, U>;
 
 
 #endif // UTILS_CONCEPTS_H
\ No newline at end of file
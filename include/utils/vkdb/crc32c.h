@@ -0,0 +1,20 @@
+#ifndef UTILS_CRC32C_H
+#define UTILS_CRC32C_H
+
+#include <string_view>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Compute the CRC-32C (Castagnoli) checksum of some data.
+ * @details Uses the SSE4.2 crc32 instruction where the CPU has it, and a
+ * lookup table otherwise.
+ *
+ * @param data Data.
+ * @param crc Checksum of the data before, to continue from.
+ * @return uint32_t Checksum.
+ */
+[[nodiscard]] uint32_t crc32c(std::string_view data, uint32_t crc = 0) noexcept;
+}  // namespace vkdb
+
+#endif // UTILS_CRC32C_H
@@ -0,0 +1,44 @@
+#ifndef UTILS_FILE_SYNC_H
+#define UTILS_FILE_SYNC_H
+
+#include <filesystem>
+
+namespace vkdb {
+/**
+ * @brief Sync the contents of a file to disk.
+ *
+ * @param path Path of the file.
+ *
+ * @throw std::runtime_error If the file cannot be opened or synced.
+ */
+void syncFile(const std::filesystem::path& path);
+
+/**
+ * @brief Sync a directory to disk, so that files created, renamed or removed
+ * in it are durable.
+ *
+ * @param path Path of the directory.
+ *
+ * @throw std::runtime_error If the directory cannot be opened or synced.
+ */
+void syncDirectory(const std::filesystem::path& path);
+
+/**
+ * @brief Hard-link a file to a new path, or copy it if it cannot be linked,
+ * as when the paths are on different file systems.
+ * @details Only meant for files that are never written again, since a
+ * linked file shares its contents with the original.
+ *
+ * @param from Path of the file.
+ * @param to New path, which must not exist.
+ *
+ * @throw std::filesystem::filesystem_error If the file can be neither linked
+ * nor copied.
+ */
+void linkFile(
+  const std::filesystem::path& from,
+  const std::filesystem::path& to
+);
+}  // namespace vkdb
+
+#endif // UTILS_FILE_SYNC_H
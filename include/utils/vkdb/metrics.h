@@ -0,0 +1,312 @@
+#ifndef UTILS_METRICS_H
+#define UTILS_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Monotonic counter that threads can bump without contending.
+ * @details Split into cache-line-sized stripes, and each thread adds to the
+ * stripe it was assigned on first use, with a relaxed increment. Reading the
+ * counter sums the stripes, so it may miss increments still in flight.
+ *
+ */
+class Counter {
+public:
+  using size_type = uint64_t;
+
+  /**
+   * @brief Number of stripes.
+   *
+   */
+  static constexpr size_type STRIPE_COUNT{8};
+
+  /**
+   * @brief Construct a new Counter object at 0.
+   *
+   */
+  Counter() noexcept = default;
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  Counter(Counter&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  Counter& operator=(Counter&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  Counter(const Counter&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  Counter& operator=(const Counter&) = delete;
+
+  /**
+   * @brief Destroy the Counter object.
+   *
+   */
+  ~Counter() noexcept = default;
+
+  /**
+   * @brief Add to the counter.
+   *
+   * @param amount Amount.
+   */
+  void add(size_type amount = 1) noexcept {
+    stripes_[thread_stripe()].value.fetch_add(
+      amount, std::memory_order_relaxed
+    );
+  }
+
+  /**
+   * @brief Get the value of the counter.
+   *
+   * @return size_type Sum of the stripes.
+   */
+  [[nodiscard]] size_type value() const noexcept;
+
+private:
+  /**
+   * @brief Stripe, padded to its own cache line.
+   *
+   */
+  struct alignas(64) Stripe {
+    std::atomic<size_type> value{0};
+  };
+
+  /**
+   * @brief Get the stripe of the calling thread.
+   * @details Threads are assigned stripes round-robin, so up to
+   * STRIPE_COUNT threads never share one.
+   *
+   * @return size_type Stripe index.
+   */
+  [[nodiscard]] static size_type thread_stripe() noexcept;
+
+  /**
+   * @brief Stripes.
+   *
+   */
+  std::array<Stripe, STRIPE_COUNT> stripes_{};
+};
+
+/**
+ * @brief Point-in-time copy of a latency histogram.
+ * @details Bucket 0 counts latencies of 0 ns, and bucket i counts those in
+ * [2^(i - 1), 2^i) ns.
+ *
+ */
+struct HistogramSnapshot {
+  using size_type = uint64_t;
+
+  /**
+   * @brief Number of buckets.
+   *
+   */
+  static constexpr size_type BUCKET_COUNT{64};
+
+  /**
+   * @brief Number of latencies in each bucket.
+   *
+   */
+  std::array<size_type, BUCKET_COUNT> buckets{};
+
+  /**
+   * @brief Number of latencies recorded.
+   *
+   */
+  size_type count{0};
+
+  /**
+   * @brief Sum of the latencies recorded, in nanoseconds.
+   *
+   */
+  size_type sum{0};
+
+  /**
+   * @brief Get an upper bound of a quantile.
+   *
+   * @param quantile Quantile, between 0 and 1.
+   * @return size_type Exclusive upper bound, in nanoseconds, of the bucket
+   * holding the quantile, or 0 if nothing was recorded.
+   */
+  [[nodiscard]] size_type quantile(double quantile) const noexcept;
+
+  /**
+   * @brief Get the mean latency.
+   *
+   * @return double Mean, in nanoseconds, or 0 if nothing was recorded.
+   */
+  [[nodiscard]] double mean() const noexcept;
+
+  /**
+   * @brief Get the exclusive upper bound of a bucket.
+   *
+   * @param bucket Bucket index.
+   * @return size_type Upper bound, in nanoseconds.
+   */
+  [[nodiscard]] static size_type upperBound(size_type bucket) noexcept;
+
+  /**
+   * @brief Add the latencies of another snapshot.
+   *
+   * @param other Snapshot.
+   * @return HistogramSnapshot& Reference to this snapshot.
+   */
+  HistogramSnapshot& operator+=(const HistogramSnapshot& other) noexcept;
+};
+
+/**
+ * @brief Histogram of latencies in power-of-two buckets of nanoseconds.
+ * @details Recording is a relaxed increment of one bucket and of the sum,
+ * with no lock.
+ *
+ */
+class LatencyHistogram {
+public:
+  using size_type = uint64_t;
+  using duration_type = std::chrono::nanoseconds;
+
+  /**
+   * @brief Construct a new LatencyHistogram object with nothing recorded.
+   *
+   */
+  LatencyHistogram() noexcept = default;
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  LatencyHistogram(LatencyHistogram&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  LatencyHistogram(const LatencyHistogram&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  /**
+   * @brief Destroy the LatencyHistogram object.
+   *
+   */
+  ~LatencyHistogram() noexcept = default;
+
+  /**
+   * @brief Record a latency.
+   *
+   * @param latency Latency, where negative latencies count as 0.
+   */
+  void record(duration_type latency) noexcept;
+
+  /**
+   * @brief Take a snapshot of the histogram.
+   *
+   * @return HistogramSnapshot Snapshot.
+   */
+  [[nodiscard]] HistogramSnapshot snapshot() const noexcept;
+
+private:
+  /**
+   * @brief Number of latencies in each bucket.
+   *
+   */
+  std::array<std::atomic<size_type>, HistogramSnapshot::BUCKET_COUNT>
+    buckets_{};
+
+  /**
+   * @brief Sum of the latencies recorded, in nanoseconds.
+   *
+   */
+  std::atomic<size_type> sum_{0};
+};
+
+/**
+ * @brief Records the time from its construction to its destruction in a
+ * latency histogram.
+ *
+ */
+class LatencyTimer {
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  /**
+   * @brief Construct a new LatencyTimer object, starting the timer.
+   *
+   * @param histogram Histogram, which must outlive the timer.
+   */
+  explicit LatencyTimer(LatencyHistogram& histogram) noexcept
+    : histogram_{histogram}, start_{clock_type::now()} {}
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  LatencyTimer(LatencyTimer&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  LatencyTimer& operator=(LatencyTimer&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  LatencyTimer(const LatencyTimer&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+  /**
+   * @brief Destroy the LatencyTimer object, recording the time elapsed.
+   *
+   */
+  ~LatencyTimer() noexcept {
+    histogram_.record(clock_type::now() - start_);
+  }
+
+private:
+  /**
+   * @brief Histogram.
+   *
+   */
+  LatencyHistogram& histogram_;
+
+  /**
+   * @brief Time the timer started.
+   *
+   */
+  clock_type::time_point start_;
+};
+}  // namespace vkdb
+
+#endif // UTILS_METRICS_H
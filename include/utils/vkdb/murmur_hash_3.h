@@ -10,4 +10,11 @@ void MurmurHash3_x86_32(
   void *out
 );
 
+void MurmurHash3_x64_128(
+  const void *key,
+  const int len,
+  const uint32_t seed,
+  void *out
+);
+
 #endif // UTILS_MURMUR_HASH_3_HPP
@@ -0,0 +1,93 @@
+#ifndef UTILS_QUERY_ARENA_H
+#define UTILS_QUERY_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+namespace vkdb {
+/**
+ * @brief Arena for the short-lived allocations of a single query.
+ * @details Allocations are bumped out of a monotonic buffer and only freed
+ * all at once, when the arena is destroyed, so a short query's scratch
+ * containers never reach the global allocator. Each thread keeps one buffer
+ * of BUFFER_BYTES, which the outermost arena on the thread reuses. An arena
+ * nested in another on the same thread, or one that outgrows the buffer,
+ * falls back to the default resource.
+ *
+ * Nothing allocated from the arena may outlive it, and the arena must only
+ * be used by the thread that created it.
+ *
+ */
+class QueryArena {
+public:
+  /**
+   * @brief Size of the buffer each thread keeps, in bytes.
+   *
+   */
+  static constexpr std::size_t BUFFER_BYTES{64 << 10};
+
+  /**
+   * @brief Construct a new QueryArena object.
+   * @details Takes the buffer of the calling thread if no other arena on it
+   * holds the buffer.
+   *
+   */
+  QueryArena() noexcept;
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  QueryArena(QueryArena&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  QueryArena& operator=(QueryArena&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  QueryArena(const QueryArena&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  QueryArena& operator=(const QueryArena&) = delete;
+
+  /**
+   * @brief Destroy the QueryArena object.
+   * @details Frees everything allocated from the arena, and hands the
+   * buffer back to the thread.
+   *
+   */
+  ~QueryArena() noexcept;
+
+  /**
+   * @brief Get the memory resource of the arena.
+   *
+   * @return std::pmr::memory_resource* Memory resource.
+   */
+  [[nodiscard]] std::pmr::memory_resource* resource() noexcept;
+
+private:
+  /**
+   * @brief Whether the arena holds the buffer of its thread.
+   *
+   */
+  bool owns_buffer_;
+
+  /**
+   * @brief Monotonic resource over the buffer, or over the default resource
+   * alone if the arena does not hold it.
+   *
+   */
+  std::optional<std::pmr::monotonic_buffer_resource> resource_;
+};
+}  // namespace vkdb
+
+#endif // UTILS_QUERY_ARENA_H
@@ -25,9 +25,10 @@ T random(
   if constexpr (std::integral<T>) {
     std::uniform_int_distribution<T> dist{min, max};
     return dist(gen);
+  } else {
+    std::uniform_real_distribution<T> dist{min, max};
+    return dist(gen);
   }
-  std::uniform_real_distribution<T> dist{min, max};
-  return dist(gen);
 }
 }  // namespace vkdb
 
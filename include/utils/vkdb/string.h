@@ -6,6 +6,7 @@
 #include <optional>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 namespace vkdb {
 /**
@@ -0,0 +1,401 @@
+#ifndef UTILS_TASK_H
+#define UTILS_TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <semaphore>
+#include <utility>
+
+namespace vkdb {
+template <typename T>
+class Task;
+
+namespace detail {
+/**
+ * @brief Promise state shared by tasks of every result type.
+ *
+ */
+class TaskPromiseBase {
+public:
+  /**
+   * @brief Awaiter that hands control to the awaiting coroutine once the task
+   * is done.
+   *
+   */
+  struct FinalAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept {
+      return false;
+    }
+
+    template <typename TPromise>
+    [[nodiscard]] std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<TPromise> handle
+    ) const noexcept {
+      return handle.promise().continuation_;
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  /**
+   * @brief Start suspended, so that nothing runs until the task is awaited.
+   *
+   * @return std::suspend_always Awaiter.
+   */
+  [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+    return {};
+  }
+
+  /**
+   * @brief Resume the awaiting coroutine once the task is done.
+   *
+   * @return FinalAwaiter Awaiter.
+   */
+  [[nodiscard]] FinalAwaiter final_suspend() const noexcept {
+    return {};
+  }
+
+  /**
+   * @brief Keep an exception thrown by the task, to be rethrown when its
+   * result is taken.
+   *
+   */
+  void unhandled_exception() noexcept {
+    exception_ = std::current_exception();
+  }
+
+  /**
+   * @brief Set the coroutine to resume once the task is done.
+   *
+   * @param continuation Coroutine.
+   */
+  void setContinuation(std::coroutine_handle<> continuation) noexcept {
+    continuation_ = continuation;
+  }
+
+protected:
+  /**
+   * @brief Rethrow the exception thrown by the task, if any.
+   *
+   */
+  void rethrow_if_failed() const {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  /**
+   * @brief Coroutine to resume once the task is done.
+   *
+   */
+  std::coroutine_handle<> continuation_{std::noop_coroutine()};
+
+  /**
+   * @brief Exception thrown by the task.
+   *
+   */
+  std::exception_ptr exception_;
+};
+
+/**
+ * @brief Promise of a task with a result.
+ *
+ * @tparam T Result type.
+ */
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+  [[nodiscard]] Task<T> get_return_object() noexcept;
+
+  /**
+   * @brief Keep the result of the task.
+   *
+   * @param value Result.
+   */
+  template <typename U = T>
+  void return_value(U&& value) {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  /**
+   * @brief Take the result of the task.
+   *
+   * @return T Result.
+   *
+   * @throw std::exception Whatever the task threw.
+   */
+  [[nodiscard]] T result() {
+    rethrow_if_failed();
+    return std::move(*value_);
+  }
+
+private:
+  /**
+   * @brief Result of the task.
+   *
+   */
+  std::optional<T> value_;
+};
+
+/**
+ * @brief Promise of a task without a result.
+ *
+ */
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+  [[nodiscard]] Task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept {}
+
+  /**
+   * @brief Check that the task succeeded.
+   *
+   * @throw std::exception Whatever the task threw.
+   */
+  void result() const {
+    rethrow_if_failed();
+  }
+};
+
+/**
+ * @brief Coroutine that signals a semaphore once it is done.
+ * @details Used by syncWait() to run a task to completion from a thread that
+ * is not a coroutine.
+ *
+ */
+struct SyncWaiter {
+  struct promise_type {
+    [[nodiscard]] SyncWaiter get_return_object() noexcept {
+      return SyncWaiter{
+        std::coroutine_handle<promise_type>::from_promise(*this)
+      };
+    }
+
+    [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+      return {};
+    }
+
+    [[nodiscard]] auto final_suspend() const noexcept {
+      struct Signal {
+        [[nodiscard]] bool await_ready() const noexcept {
+          return false;
+        }
+
+        void await_suspend(
+          std::coroutine_handle<promise_type> handle
+        ) const noexcept {
+          handle.promise().done->release();
+        }
+
+        void await_resume() const noexcept {}
+      };
+      return Signal{};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() const noexcept {
+      std::terminate();
+    }
+
+    std::binary_semaphore* done{nullptr};
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+}  // namespace detail
+
+/**
+ * @brief Lazily started coroutine with a result.
+ * @details Nothing runs until the task is awaited, and the awaiting
+ * coroutine is resumed straight from the task's final suspension, on
+ * whichever thread finished it. An exception thrown by the task is rethrown
+ * by the co_await.
+ *
+ * @tparam T Result type.
+ */
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+  using promise_type = detail::TaskPromise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  /**
+   * @brief Deleted default constructor.
+   *
+   */
+  Task() = delete;
+
+  /**
+   * @brief Construct a new Task object given its coroutine.
+   *
+   * @param handle Coroutine.
+   */
+  explicit Task(handle_type handle) noexcept : handle_{handle} {}
+
+  /**
+   * @brief Move-construct a Task object.
+   *
+   */
+  Task(Task&& other) noexcept
+    : handle_{std::exchange(other.handle_, nullptr)} {}
+
+  /**
+   * @brief Move-assign a Task object.
+   *
+   */
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  Task(const Task&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  Task& operator=(const Task&) = delete;
+
+  /**
+   * @brief Destroy the Task object, along with its coroutine.
+   *
+   */
+  ~Task() noexcept {
+    destroy();
+  }
+
+  /**
+   * @brief Awaiter that starts the task and resumes the awaiting coroutine
+   * with its result.
+   *
+   */
+  struct Awaiter {
+    [[nodiscard]] bool await_ready() const noexcept {
+      return handle.done();
+    }
+
+    [[nodiscard]] std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> awaiting
+    ) const noexcept {
+      handle.promise().setContinuation(awaiting);
+      return handle;
+    }
+
+    T await_resume() const {
+      return handle.promise().result();
+    }
+
+    handle_type handle;
+  };
+
+  /**
+   * @brief Await the task.
+   *
+   * @return Awaiter Awaiter.
+   */
+  [[nodiscard]] Awaiter operator co_await() const& noexcept {
+    return Awaiter{handle_};
+  }
+
+  /**
+   * @brief Check if the task is done.
+   *
+   * @return true if the task has run to completion.
+   * @return false otherwise.
+   */
+  [[nodiscard]] bool done() const noexcept {
+    return handle_.done();
+  }
+
+private:
+  template <typename U>
+  friend U syncWait(Task<U> task);
+
+  /**
+   * @brief Awaiter that starts the task and resumes the awaiting coroutine
+   * once it is done, leaving its result in place.
+   *
+   */
+  struct CompletionAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept {
+      return handle.done();
+    }
+
+    [[nodiscard]] std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> awaiting
+    ) const noexcept {
+      handle.promise().setContinuation(awaiting);
+      return handle;
+    }
+
+    void await_resume() const noexcept {}
+
+    handle_type handle;
+  };
+
+  /**
+   * @brief Destroy the coroutine, if any.
+   *
+   */
+  void destroy() noexcept {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /**
+   * @brief Coroutine.
+   *
+   */
+  handle_type handle_;
+};
+
+namespace detail {
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+}  // namespace detail
+
+/**
+ * @brief Run a task to completion, blocking the calling thread.
+ * @details For callers that are not coroutines themselves. The task may
+ * finish on another thread.
+ *
+ * @tparam T Result type.
+ * @param task Task.
+ * @return T Result of the task.
+ *
+ * @throw std::exception Whatever the task threw.
+ */
+template <typename T>
+T syncWait(Task<T> task) {
+  std::binary_semaphore done{0};
+  const auto waiter{[](typename Task<T>::CompletionAwaiter completion)
+    -> detail::SyncWaiter {
+    co_await completion;
+  }(typename Task<T>::CompletionAwaiter{task.handle_})};
+  waiter.handle.promise().done = &done;
+  waiter.handle.resume();
+  done.acquire();
+  waiter.handle.destroy();
+  return task.handle_.promise().result();
+}
+}  // namespace vkdb
+
+#endif // UTILS_TASK_H
@@ -0,0 +1,176 @@
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+namespace vkdb {
+/**
+ * @brief Fixed number of threads that run submitted tasks in order.
+ * @details Tasks must not wait on other tasks of the same pool, since every
+ * thread may be busy with a waiting task.
+ *
+ */
+class ThreadPool {
+public:
+  using size_type = uint64_t;
+  using Task = std::function<void()>;
+
+  /**
+   * @brief Deleted default constructor.
+   *
+   */
+  ThreadPool() = delete;
+
+  /**
+   * @brief Construct a new ThreadPool object and start its threads.
+   *
+   * @param thread_count Number of threads.
+   *
+   * @throw std::invalid_argument If the number of threads is 0.
+   * @throw std::system_error If a thread cannot be started.
+   */
+  explicit ThreadPool(size_type thread_count);
+
+  /**
+   * @brief Deleted move constructor.
+   *
+   */
+  ThreadPool(ThreadPool&&) = delete;
+
+  /**
+   * @brief Deleted move assignment operator.
+   *
+   */
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  /**
+   * @brief Deleted copy constructor.
+   *
+   */
+  ThreadPool(const ThreadPool&) = delete;
+
+  /**
+   * @brief Deleted copy assignment operator.
+   *
+   */
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Destroy the ThreadPool object.
+   * @details Runs the tasks still queued, then joins the threads.
+   *
+   */
+  ~ThreadPool() noexcept;
+
+  /**
+   * @brief Submit a task to run on one of the threads.
+   *
+   * @tparam Fn Function type.
+   * @param fn Function.
+   * @return std::future<std::invoke_result_t<Fn>> Future of the result of the
+   * function, which holds any exception it throws.
+   */
+  template <std::invocable Fn>
+  [[nodiscard]] std::future<std::invoke_result_t<Fn>> submit(Fn&& fn) {
+    auto task{std::make_shared<std::packaged_task<std::invoke_result_t<Fn>()>>(
+      std::forward<Fn>(fn)
+    )};
+    auto future{task->get_future()};
+    enqueue([task = std::move(task)] { (*task)(); });
+    return future;
+  }
+
+  /**
+   * @brief Awaiter that resumes the awaiting coroutine on one of the
+   * threads.
+   *
+   */
+  struct ScheduleAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept {
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+      pool.enqueue([handle] { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+
+    ThreadPool& pool;
+  };
+
+  /**
+   * @brief Move the awaiting coroutine onto one of the threads.
+   * @details The coroutine is queued behind the tasks already submitted.
+   *
+   * @return ScheduleAwaiter Awaiter.
+   */
+  [[nodiscard]] ScheduleAwaiter schedule() noexcept {
+    return ScheduleAwaiter{*this};
+  }
+
+  /**
+   * @brief Get the number of threads.
+   *
+   * @return size_type Number of threads.
+   */
+  [[nodiscard]] size_type threadCount() const noexcept;
+
+private:
+  /**
+   * @brief Queue a task.
+   *
+   * @param task Task.
+   */
+  void enqueue(Task task);
+
+  /**
+   * @brief Run tasks until the pool is destroyed.
+   *
+   */
+  void run() noexcept;
+
+  /**
+   * @brief Mutex guarding the queue.
+   *
+   */
+  std::mutex mutex_;
+
+  /**
+   * @brief Notified whenever a task is queued or the pool is stopping.
+   *
+   */
+  std::condition_variable changed_;
+
+  /**
+   * @brief Queued tasks, oldest first.
+   *
+   */
+  std::deque<Task> tasks_;
+
+  /**
+   * @brief Whether the pool is being destroyed.
+   *
+   */
+  bool stopping_{false};
+
+  /**
+   * @brief Threads.
+   *
+   */
+  std::vector<std::thread> threads_;
+};
+}  // namespace vkdb
+
+#endif // UTILS_THREAD_POOL_H
@@ -10,41 +10,166 @@ Database::Database(
   error_callback error,
   runtime_error_callback runtime_error
 )
-  : name_{std::move(name)}
+  : Database{
+      std::move(name),
+      DatabaseOptions{},
+      std::move(error),
+      std::move(runtime_error)
+    } {}
+
+Database::Database(
+  DatabaseName name,
+  DatabaseOptions options,
+  error_callback error,
+  runtime_error_callback runtime_error
+)
+  : block_cache_{
+      options.block_cache_bytes == 0
+        ? nullptr
+        : std::make_shared<BlockCache>(options.block_cache_bytes)
+    }
+  , compaction_pool_{
+      options.compaction_threads == 0
+        ? nullptr
+        : std::make_shared<ThreadPool>(options.compaction_threads)
+    }
+  , read_pool_{
+      options.read_threads == 0
+        ? nullptr
+        : std::make_shared<ThreadPool>(options.read_threads)
+    }
+  , io_scheduler_{
+      options.io_scheduler.bytes_per_second == 0
+        ? nullptr
+        : std::make_shared<IOScheduler>(options.io_scheduler)
+    }
+  , memory_manager_{
+      options.memory_budget_bytes == 0
+        ? nullptr
+        : std::make_shared<MemoryManager>(options.memory_budget_bytes)
+    }
+  , statement_cache_{
+      options.statement_cache_size == 0
+        ? nullptr
+        : std::make_shared<StatementCache>(options.statement_cache_size)
+    }
+  , table_mutex_{std::make_unique<std::mutex>()}
+  , name_{std::move(name)}
+  , query_pool_{
+      options.query_threads == 0
+        ? nullptr
+        : std::make_shared<ThreadPool>(options.query_threads)
+    }
   , callback_{std::move(error)}
   , runtime_callback_{std::move(runtime_error)}
   , had_error_{false}
-  , had_runtime_error_{false} {
+  , had_runtime_error_{false}
+  , output_format_{options.output_format} {
   load();
 }
 
-Table& Database::createTable(const TableName& table_name) {
-  if (table_map_.contains(table_name)) {
+Database::Database(Database&& other) noexcept
+  : block_cache_{std::move(other.block_cache_)}
+  , compaction_pool_{std::move(other.compaction_pool_)}
+  , read_pool_{std::move(other.read_pool_)}
+  , io_scheduler_{std::move(other.io_scheduler_)}
+  , memory_manager_{std::move(other.memory_manager_)}
+  , statement_cache_{std::move(other.statement_cache_)}
+  , table_map_{std::move(other.table_map_)}
+  , unopened_tables_{std::move(other.unopened_tables_)}
+  , memory_consumers_{std::move(other.memory_consumers_)}
+  , table_mutex_{std::move(other.table_mutex_)}
+  , name_{std::move(other.name_)}
+  , query_pool_{std::move(other.query_pool_)}
+  , had_error_{other.had_error_.load()}
+  , had_runtime_error_{other.had_runtime_error_.load()}
+  , callback_{std::move(other.callback_)}
+  , runtime_callback_{std::move(other.runtime_callback_)}
+  , output_format_{other.output_format_} {}
+
+Database& Database::operator=(Database&& other) noexcept {
+  if (this != &other) {
+    for (const auto& [table_name, id] : memory_consumers_) {
+      table_map_.at(table_name).options().memory_manager->untrack(id);
+    }
+    query_pool_ = std::move(other.query_pool_);
+    table_map_ = std::move(other.table_map_);
+    unopened_tables_ = std::move(other.unopened_tables_);
+    memory_consumers_ = std::move(other.memory_consumers_);
+    table_mutex_ = std::move(other.table_mutex_);
+    block_cache_ = std::move(other.block_cache_);
+    compaction_pool_ = std::move(other.compaction_pool_);
+    read_pool_ = std::move(other.read_pool_);
+    io_scheduler_ = std::move(other.io_scheduler_);
+    memory_manager_ = std::move(other.memory_manager_);
+    statement_cache_ = std::move(other.statement_cache_);
+    name_ = std::move(other.name_);
+    had_error_ = other.had_error_.load();
+    had_runtime_error_ = other.had_runtime_error_.load();
+    callback_ = std::move(other.callback_);
+    runtime_callback_ = std::move(other.runtime_callback_);
+    output_format_ = other.output_format_;
+  }
+  return *this;
+}
+
+Database::~Database() noexcept {
+  for (const auto& [table_name, id] : memory_consumers_) {
+    table_map_.at(table_name).options().memory_manager->untrack(id);
+  }
+}
+
+Table& Database::createTable(
+  const TableName& table_name,
+  TableOptions options,
+  ValueType value_type
+) {
+  std::lock_guard lock{*table_mutex_};
+  if (
+    table_map_.contains(table_name) ||
+    unopened_tables_.contains(table_name)
+  ) {
     throw std::runtime_error{
       "Database::createTable(): Table '" + table_name + "' already exists."
     };
   }
-  table_map_.emplace(table_name, Table{path(), table_name});
-  std::filesystem::create_directories(table_map_.at(table_name).path());
-  return table_map_.at(table_name);
+  return open_table(table_name, std::move(options), value_type);
 }
 
 Table& Database::getTable(const TableName& table_name) {
-  if (!table_map_.contains(table_name)) {
+  std::lock_guard lock{*table_mutex_};
+  if (auto it{table_map_.find(table_name)}; it != table_map_.end()) {
+    return it->second;
+  }
+  if (!unopened_tables_.contains(table_name)) {
     throw std::runtime_error{
       "Database::getTable(): Table '" + table_name + "' does not exist."
     };
   }
-  return table_map_.at(table_name);
+  auto& table{open_table(table_name, {})};
+  unopened_tables_.erase(table_name);
+  return table;
 }
 
 void Database::dropTable(const TableName& table_name) {
+  std::lock_guard lock{*table_mutex_};
+  if (unopened_tables_.contains(table_name)) {
+    std::filesystem::remove_all(path() / table_name);
+    unopened_tables_.erase(table_name);
+    return;
+  }
   if (!table_map_.contains(table_name)) {
     throw std::runtime_error{
       "Database::dropTable(): Table '" + table_name + "' does not exist."
     };
   }
-  std::filesystem::remove_all(table_map_.at(table_name).path());
+  auto& table{table_map_.at(table_name)};
+  if (auto it{memory_consumers_.find(table_name)};
+      it != memory_consumers_.end()) {
+    table.options().memory_manager->untrack(it->second);
+    memory_consumers_.erase(it);
+  }
+  std::filesystem::remove_all(table.path());
   table_map_.erase(table_name);
 }
 
@@ -56,39 +181,128 @@ DatabaseName Database::name() const noexcept {
   return name_;
 }
 
+std::shared_ptr<const BlockCache> Database::blockCache() const noexcept {
+  return block_cache_;
+}
+
+std::shared_ptr<MemoryManager> Database::memoryManager() const noexcept {
+  return memory_manager_;
+}
+
 FilePath Database::path() const noexcept {
   return DATABASE_DIRECTORY / name_;
 }
 
 std::vector<TableName> Database::tables() const noexcept {
-  auto tables{std::ranges::views::keys(table_map_)};
-  return {tables.begin(), tables.end()};
+  std::lock_guard lock{*table_mutex_};
+  auto opened_tables{std::ranges::views::keys(table_map_)};
+  std::vector<TableName> tables{opened_tables.begin(), opened_tables.end()};
+  tables.insert(tables.end(), unopened_tables_.begin(), unopened_tables_.end());
+  return tables;
+}
+
+std::map<TableName, StorageStats> Database::stats() const {
+  std::lock_guard lock{*table_mutex_};
+  std::map<TableName, StorageStats> stats;
+  for (const auto& [table_name, table] : table_map_) {
+    stats.emplace(table_name, table.stats());
+  }
+  return stats;
+}
+
+void Database::checkpoint(const FilePath& directory) {
+  std::filesystem::create_directories(directory);
+  if (!std::filesystem::is_empty(directory)) {
+    throw std::runtime_error{
+      "Database::checkpoint(): Directory " + std::string(directory)
+      + " is not empty."
+    };
+  }
+  std::vector<Table*> opened_tables;
+  {
+    std::lock_guard lock{*table_mutex_};
+    for (const auto& table_name : unopened_tables_) {
+      checkpoint_unopened_table(table_name, directory);
+    }
+    for (auto& [table_name, table] : table_map_) {
+      opened_tables.push_back(&table);
+    }
+  }
+  for (auto* table : opened_tables) {
+    table->checkpoint(directory / table->name());
+  }
+  syncDirectory(directory);
 }
 
 Database& Database::run(
   const std::string& source,
   std::ostream& stream
 ) noexcept {
-  Lexer lexer{source};
-  auto tokens{lexer.tokenize()};
-
-  Parser parser{tokens, [this](Token token, const std::string& message) {
-    error(token, message);
-  }};
-  auto expr{parser.parse()};
+  const auto statement{compile(
+    source,
+    [this](Token token, const std::string& message) {
+      error(token, message);
+    }
+  )};
 
-  if (had_error_) {
+  if (had_error_ || !statement) {
     return *this;
   }
   
   Interpreter interpreter{*this, [this](const RuntimeError& error) {
     runtime_error(error);
-  }};
-  interpreter.interpret(expr.value(), stream);
+  }, {}, output_format_};
+  interpreter.interpret(statement->expr(), stream);
+
+  return *this;
+}
+
+std::shared_ptr<const PreparedStatement> Database::prepare(
+  const std::string& source
+) {
+  std::string failure;
+  auto statement{compile(
+    source,
+    [&failure](Token token, const std::string& message) {
+      if (failure.empty()) {
+        failure = "[line " + std::to_string(token.line()) + "] " + message;
+      }
+    }
+  )};
+  if (!statement) {
+    throw std::runtime_error{"Database::prepare(): " + failure};
+  }
+  return statement;
+}
 
+Database& Database::execute(
+  const PreparedStatement& statement,
+  std::span<const Parameter> parameters,
+  std::ostream& stream
+) {
+  if (parameters.size() != statement.parameterCount()) {
+    throw std::invalid_argument{
+      "Database::execute(): Expected "
+      + std::to_string(statement.parameterCount()) + " parameters, got "
+      + std::to_string(parameters.size()) + "."
+    };
+  }
+  Interpreter interpreter{*this, [this](const RuntimeError& error) {
+    runtime_error(error);
+  }, parameters, output_format_};
+  interpreter.interpret(statement.expr(), stream);
   return *this;
 }
 
+Task<> Database::runAsync(std::string source, std::ostream& stream) {
+  if (query_pool_) {
+    co_await query_pool_->schedule();
+  }
+  std::ostringstream output;
+  run(source, output);
+  stream << output.str();
+}
+
 Database& Database::runFile(
   const std::filesystem::path path,
   std::ostream& stream
@@ -134,6 +348,39 @@ Database& Database::runPrompt() noexcept {
   return *this;
 }
 
+std::shared_ptr<const PreparedStatement> Database::compile(
+  const std::string& source,
+  const error_callback& callback
+) {
+  if (statement_cache_) {
+    if (auto cached{statement_cache_->tryGet(source)}; cached && *cached) {
+      return **cached;
+    }
+  }
+
+  Lexer lexer{source};
+  auto tokens{lexer.tokenize()};
+
+  auto failed{false};
+  Parser parser{std::move(tokens), [&](Token token, const std::string& message) {
+    failed = true;
+    callback(token, message);
+  }};
+  auto expr{parser.parse()};
+  if (failed || !expr) {
+    return nullptr;
+  }
+
+  auto statement{std::make_shared<const PreparedStatement>(
+    std::move(*expr),
+    parser.parameterCount()
+  )};
+  if (statement_cache_) {
+    statement_cache_->put(source, statement);
+  }
+  return statement;
+}
+
 void Database::error(Token token, const std::string& message) noexcept {
   if (token.type() == TokenType::END_OF_FILE) {
     report(token.line(), "at end", message);
@@ -167,9 +414,76 @@ void Database::load() {
 
   for (const auto& entry : std::filesystem::directory_iterator(db_path)) {
     if (entry.is_directory()) {
-      auto table_name{entry.path().filename().string()};
-      table_map_.emplace(table_name, Table{path(), table_name});
+      unopened_tables_.insert(entry.path().filename().string());
+    }
+  }
+}
+
+void Database::checkpoint_unopened_table(
+  const TableName& table_name,
+  const FilePath& directory
+) const {
+  const auto table_path{path() / table_name};
+  for (const auto& entry :
+       std::filesystem::recursive_directory_iterator(table_path)) {
+    const auto& file_path{entry.path()};
+    const auto target{
+      directory / table_name / std::filesystem::relative(file_path, table_path)
+    };
+    if (entry.is_directory()) {
+      std::filesystem::create_directories(target);
+      continue;
+    }
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    std::filesystem::create_directories(target.parent_path());
+    const auto extension{file_path.extension()};
+    if (
+      file_path.filename().string().starts_with("sstable_l") &&
+      (extension == ".sst" || extension == ".metadata")
+    ) {
+      linkFile(file_path, target);
+    } else {
+      std::filesystem::copy_file(file_path, target);
+    }
+  }
+}
+
+Table& Database::open_table(
+  const TableName& table_name,
+  TableOptions options,
+  ValueType value_type
+) {
+  if (!options.block_cache) {
+    options.block_cache = block_cache_;
+  }
+  if (!options.compaction_pool) {
+    options.compaction_pool = compaction_pool_;
+  }
+  if (!options.read_pool) {
+    options.read_pool = read_pool_;
+  }
+  if (!options.io_scheduler) {
+    options.io_scheduler = io_scheduler_;
+  }
+  if (!options.memory_manager) {
+    options.memory_manager = memory_manager_;
+  }
+  const auto memory_manager{options.memory_manager};
+  auto& table{table_map_.emplace(
+    table_name,
+    Table{
+      path(), table_name, std::move(options), query_pool_.get(), value_type
     }
+  ).first->second};
+  if (memory_manager) {
+    memory_consumers_.emplace(
+      table_name,
+      memory_manager->track(table.memoryConsumer())
+    );
+    memory_manager->rebalance();
   }
+  return table;
 }
 }  // namespace vkdb
\ No newline at end of file
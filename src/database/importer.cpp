@@ -0,0 +1,320 @@
+#include <vkdb/importer.h>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Smallest run of a chunk sorted on its own thread.
+ * 
+ */
+constexpr uint64_t MIN_SORT_RUN{16 * 1024};
+
+/**
+ * @brief Header of CSV data.
+ * 
+ */
+constexpr std::string_view CSV_HEADER{"timestamp,metric,tags,value"};
+
+/**
+ * @brief Parse a number with std::from_chars.
+ * 
+ * @tparam T Number type.
+ * @param text Text.
+ * @param what What the number is, for the error message.
+ * @return T Number.
+ * 
+ * @throw std::runtime_error If the text is not a number.
+ */
+template <typename T>
+T parseNumber(std::string_view text, std::string_view what) {
+  T number;
+  const auto [end, error]{
+    std::from_chars(text.data(), text.data() + text.size(), number)
+  };
+  if (error != std::errc{} || end != text.data() + text.size()) {
+    throw std::runtime_error{
+      "Invalid " + std::string{what} + " '" + std::string{text} + "'."
+    };
+  }
+  return number;
+}
+
+/**
+ * @brief Split text at the first separator.
+ * 
+ * @param text Text, which is left holding what follows the separator, or
+ * nothing if there is none.
+ * @param separator Separator.
+ * @return std::string_view Text before the separator.
+ */
+std::string_view nextField(std::string_view& text, char separator) noexcept {
+  const auto position{text.find(separator)};
+  const auto field{text.substr(0, position)};
+  text = position == std::string_view::npos
+    ? std::string_view{}
+    : text.substr(position + 1);
+  return field;
+}
+
+/**
+ * @brief Parse a tag as 'key=value' into a tag table.
+ * 
+ * @param tag Tag.
+ * @param tags Tag table.
+ * 
+ * @throw std::runtime_error If the tag is malformed.
+ */
+void parseTag(std::string_view tag, TagTable& tags) {
+  const auto position{tag.find('=')};
+  if (position == std::string_view::npos || position == 0) {
+    throw std::runtime_error{"Invalid tag '" + std::string{tag} + "'."};
+  }
+  tags.insert_or_assign(
+    TagKey{tag.substr(0, position)},
+    TagValue{tag.substr(position + 1)}
+  );
+}
+
+/**
+ * @brief Parse the value of a line protocol field.
+ * 
+ * @param text Text.
+ * @return double Value.
+ * 
+ * @throw std::runtime_error If the value is a string or malformed.
+ */
+double parseFieldValue(std::string_view text) {
+  if (text.empty()) {
+    throw std::runtime_error{"Expected a field value."};
+  }
+  if (text.front() == '"') {
+    throw std::runtime_error{"String fields are not supported."};
+  }
+  if (text == "t" || text == "T" || text == "true" || text == "True"
+    || text == "TRUE") {
+    return 1.0;
+  }
+  if (text == "f" || text == "F" || text == "false" || text == "False"
+    || text == "FALSE") {
+    return 0.0;
+  }
+  if (text.back() == 'i') {
+    return static_cast<double>(
+      parseNumber<int64_t>(text.substr(0, text.size() - 1), "integer")
+    );
+  }
+  if (text.back() == 'u') {
+    return static_cast<double>(
+      parseNumber<uint64_t>(text.substr(0, text.size() - 1), "integer")
+    );
+  }
+  return parseNumber<double>(text, "value");
+}
+}  // namespace
+
+Importer::Importer(Table& table, ImportOptions options)
+  : table_{table}, options_{options} {
+  if (options_.chunk_entries == 0) {
+    throw std::invalid_argument{
+      "Importer::Importer(): Chunk size must be positive."
+    };
+  }
+  if (options_.sort_threads > 1) {
+    sort_pool_ = std::make_unique<ThreadPool>(options_.sort_threads);
+  }
+}
+
+ImportStats Importer::run(std::istream& input) {
+  ImportStats stats;
+  chunk_.clear();
+  chunk_.reserve(options_.chunk_entries);
+  std::string line;
+  auto header_pending{options_.format == ImportFormat::CSV};
+  while (std::getline(input, line)) {
+    ++stats.lines;
+    std::string_view text{line};
+    if (!text.empty() && text.back() == '\r') {
+      text.remove_suffix(1);
+    }
+    if (text.empty() || text.front() == '#') {
+      continue;
+    }
+    try {
+      if (header_pending) {
+        if (text != CSV_HEADER) {
+          throw std::runtime_error{
+            "Expected header '" + std::string{CSV_HEADER} + "'."
+          };
+        }
+        header_pending = false;
+      } else if (options_.format == ImportFormat::CSV) {
+        parse_csv(text);
+      } else {
+        parse_line_protocol(text);
+      }
+    } catch (const std::exception& e) {
+      throw std::runtime_error{
+        "Importer::run(): Line " + std::to_string(stats.lines) + ": "
+        + e.what()
+      };
+    }
+    if (chunk_.size() >= options_.chunk_entries) {
+      write_chunk(stats);
+    }
+  }
+  write_chunk(stats);
+  return stats;
+}
+
+ImportStats Importer::runFile(const std::filesystem::path& path) {
+  std::ifstream file{path};
+  if (!file.is_open()) {
+    throw std::runtime_error{
+      "Importer::runFile(): Unable to open file " + path.string() + "."
+    };
+  }
+  return run(file);
+}
+
+void Importer::parse_line_protocol(std::string_view line) {
+  auto series{nextField(line, ' ')};
+  auto fields{nextField(line, ' ')};
+  const auto timestamp_text{line};
+  if (fields.empty()) {
+    throw std::runtime_error{"Expected fields."};
+  }
+  if (timestamp_text.empty()) {
+    throw std::runtime_error{"Expected a timestamp."};
+  }
+  const auto timestamp{parseNumber<Timestamp>(timestamp_text, "timestamp")};
+
+  const auto measurement{nextField(series, ',')};
+  if (measurement.empty()) {
+    throw std::runtime_error{"Expected a measurement."};
+  }
+  TagTable tags;
+  while (!series.empty()) {
+    parseTag(nextField(series, ','), tags);
+  }
+
+  while (!fields.empty()) {
+    auto field{nextField(fields, ',')};
+    const auto field_key{nextField(field, '=')};
+    if (field_key.empty()) {
+      throw std::runtime_error{"Expected a field key."};
+    }
+    const auto value{parseFieldValue(field)};
+    Metric metric{measurement};
+    if (field_key != "value") {
+      metric += '_';
+      metric += field_key;
+    }
+    chunk_.emplace_back(
+      TimeSeriesKey{timestamp, std::move(metric), tags},
+      value
+    );
+  }
+}
+
+void Importer::parse_csv(std::string_view line) {
+  const auto timestamp{
+    parseNumber<Timestamp>(nextField(line, ','), "timestamp")
+  };
+  const auto metric{nextField(line, ',')};
+  if (metric.empty()) {
+    throw std::runtime_error{"Expected a metric."};
+  }
+  auto tag_list{nextField(line, ',')};
+  TagTable tags;
+  while (!tag_list.empty()) {
+    parseTag(nextField(tag_list, ';'), tags);
+  }
+  const auto value{parseNumber<double>(line, "value")};
+  chunk_.emplace_back(
+    TimeSeriesKey{timestamp, Metric{metric}, std::move(tags)},
+    value
+  );
+}
+
+void Importer::sort_chunk() {
+  const auto by_key{[](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  }};
+  const auto runs{sort_pool_
+    ? std::clamp<size_type>(
+        chunk_.size() / MIN_SORT_RUN,
+        1,
+        sort_pool_->threadCount()
+      )
+    : size_type{1}
+  };
+  const auto bound{[&](const size_type run) {
+    return chunk_.begin()
+      + static_cast<std::ptrdiff_t>(chunk_.size() * run / runs);
+  }};
+
+  if (runs == 1) {
+    std::ranges::stable_sort(chunk_, by_key);
+  } else {
+    std::vector<std::future<void>> sorts;
+    sorts.reserve(runs);
+    for (size_type run{0}; run < runs; ++run) {
+      sorts.push_back(sort_pool_->submit([&, run] {
+        std::stable_sort(bound(run), bound(run + 1), by_key);
+      }));
+    }
+    for (auto& sort : sorts) {
+      sort.get();
+    }
+    for (size_type width{1}; width < runs; width *= 2) {
+      std::vector<std::future<void>> merges;
+      for (size_type run{0}; run + width < runs; run += 2 * width) {
+        merges.push_back(sort_pool_->submit([&, run, width] {
+          std::inplace_merge(
+            bound(run),
+            bound(run + width),
+            bound(std::min(run + 2 * width, runs)),
+            by_key
+          );
+        }));
+      }
+      for (auto& merge : merges) {
+        merge.get();
+      }
+    }
+  }
+
+  auto out{chunk_.begin()};
+  for (auto it{chunk_.begin()}; it != chunk_.end(); ++it) {
+    const auto next{std::next(it)};
+    if (next != chunk_.end() && next->first == it->first) {
+      continue;
+    }
+    if (out != it) {
+      *out = std::move(*it);
+    }
+    ++out;
+  }
+  chunk_.erase(out, chunk_.end());
+}
+
+void Importer::write_chunk(ImportStats& stats) {
+  if (chunk_.empty()) {
+    return;
+  }
+  sort_chunk();
+  std::vector<TimeSeriesEntry<double>> entries;
+  entries.reserve(chunk_.size());
+  for (const auto& [key, value] : chunk_) {
+    entries.emplace_back(key, value);
+  }
+  table_.putBatch(std::span<const TimeSeriesEntry<double>>{entries});
+  stats.entries += entries.size();
+  chunk_.clear();
+}
+}  // namespace vkdb
@@ -1,12 +1,154 @@
 #include <vkdb/table.h>
+#include <array>
+#include <cmath>
 #include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <stdexcept>
+#include <set>
+#include <unordered_set>
+#include <vector>
 
 namespace vkdb {
-Table::Table(const FilePath& db_path, const TableName& name)
+namespace {
+/**
+ * @brief Name of each value type, in the order of ValueType.
+ * 
+ */
+constexpr std::array<std::string_view, 5> VALUE_TYPE_NAMES{
+  "DOUBLE", "INT64", "INT32", "FLOAT", "BOOL"
+};
+
+/**
+ * @brief Type alias for the value type of a storage engine.
+ * 
+ * @tparam TStorageEngine Storage engine type.
+ */
+template <typename TStorageEngine>
+using EngineValue = typename std::remove_cvref_t<
+  TStorageEngine
+>::mapped_type::value_type;
+
+/**
+ * @brief Convert a value to the value type of a table.
+ * @details Integer types take whole numbers in their range, bool takes 0 and
+ * 1, and float takes anything in its range.
+ * 
+ * @tparam TValue Value type.
+ * @param value Value.
+ * @param name Name of the table.
+ * @param value_type Value type of the table.
+ * @return TValue Converted value.
+ * 
+ * @throw std::runtime_error If the value is not one of the value type.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+[[nodiscard]] TValue convert_value(
+  double value,
+  const TableName& name,
+  ValueType value_type
+) {
+  if constexpr (std::is_same_v<TValue, double>) {
+    return value;
+  } else {
+    auto representable{false};
+    if constexpr (std::is_same_v<TValue, bool>) {
+      representable = value == 0 || value == 1;
+    } else if constexpr (std::is_floating_point_v<TValue>) {
+      representable = !std::isfinite(value)
+        || std::abs(value) <= std::numeric_limits<TValue>::max();
+    } else {
+      const auto min{static_cast<double>(std::numeric_limits<TValue>::min())};
+      representable = std::trunc(value) == value
+        && value >= min && value < -min;
+    }
+    if (!representable) {
+      throw std::runtime_error{
+        "Table::putBatch(): Value " + std::to_string(value)
+        + " cannot be stored in table '" + name + "' of "
+        + valueTypeToString(value_type) + " values."
+      };
+    }
+    return static_cast<TValue>(value);
+  }
+}
+
+/**
+ * @brief Read the value of an option.
+ * 
+ * @tparam T Value type.
+ * @param stream Stream positioned at the value.
+ * @param name Name of the option.
+ * @param value Value.
+ * 
+ * @throw std::runtime_error If the value is malformed.
+ */
+template <typename T>
+void read_option(std::istream& stream, const std::string& name, T& value) {
+  if (!(stream >> value)) {
+    throw std::runtime_error{
+      "Table::load_options(): Malformed value for option '" + name + "'."
+    };
+  }
+}
+
+/**
+ * @brief Read the value of an enum option.
+ * 
+ * @tparam TEnum Enum type.
+ * @param stream Stream positioned at the value.
+ * @param name Name of the option.
+ * @param max Largest enumerator.
+ * @param value Value.
+ * 
+ * @throw std::runtime_error If the value is malformed or out of range.
+ */
+template <typename TEnum>
+void read_enum_option(
+  std::istream& stream,
+  const std::string& name,
+  TEnum max,
+  TEnum& value
+) {
+  uint64_t underlying;
+  read_option(stream, name, underlying);
+  if (underlying > static_cast<uint64_t>(max)) {
+    throw std::runtime_error{
+      "Table::load_options(): Value for option '" + name + "' out of range."
+    };
+  }
+  value = static_cast<TEnum>(underlying);
+}
+}  // namespace
+
+std::string valueTypeToString(ValueType value_type) noexcept {
+  return std::string{VALUE_TYPE_NAMES[static_cast<uint8_t>(value_type)]};
+}
+
+ValueType valueTypeFromString(const std::string& name) {
+  for (uint8_t i{0}; i < VALUE_TYPE_NAMES.size(); ++i) {
+    if (VALUE_TYPE_NAMES[i] == name) {
+      return static_cast<ValueType>(i);
+    }
+  }
+  throw std::invalid_argument{
+    "valueTypeFromString(): Unknown value type '" + name + "'."
+  };
+}
+
+Table::Table(
+  const FilePath& db_path,
+  const TableName& name,
+  TableOptions options,
+  ThreadPool* query_pool,
+  ValueType value_type
+)
   : name_{name}
   , db_path_{db_path}
-  , storage_engine_{path()} {
+  , value_type_{value_type}
+  , storage_engine_{open_storage_engine(std::move(options))}
+  , query_pool_{query_pool} {
   load();
 }
 
@@ -54,10 +196,185 @@ Table& Table::removeTagColumn(const TagKey& tag_column) {
 void Table::clear() const noexcept {
   std::filesystem::remove_all(path());
   std::filesystem::create_directories(path());
+  try {
+    save_options(options());
+  } catch (const std::exception&) {
+    // The options are saved again whenever the table is next opened.
+  }
+}
+
+void Table::putBatch(std::span<const DataPoint<double>> datapoints) {
+  std::set<TagTable> validated_tags;
+  for (const auto& datapoint : datapoints) {
+    if (validated_tags.contains(datapoint.tags)) {
+      continue;
+    }
+    for (const auto& [key, value] : datapoint.tags) {
+      if (!tag_columns_.contains(key)) {
+        throw std::runtime_error{
+          "Table::putBatch(): Tag '" + key + "' not in tag columns."
+        };
+      }
+    }
+    validated_tags.insert(datapoint.tags);
+  }
+
+  std::visit([this, datapoints](auto& storage_engine) {
+    using TValue = EngineValue<decltype(storage_engine)>;
+    std::vector<TimeSeriesEntry<TValue>> entries;
+    entries.reserve(datapoints.size());
+    for (const auto& datapoint : datapoints) {
+      entries.emplace_back(
+        TimeSeriesKey{datapoint.timestamp, datapoint.metric, datapoint.tags},
+        convert_value<TValue>(datapoint.value, name_, value_type_)
+      );
+    }
+    storage_engine.putBatch(entries);
+  }, storage_engine_);
+}
+
+void Table::putBatch(
+  const Metric& metric,
+  const TagTable& tags,
+  std::span<const std::pair<Timestamp, double>> rows
+) {
+  for (const auto& [key, value] : tags) {
+    if (!tag_columns_.contains(key)) {
+      throw std::runtime_error{
+        "Table::putBatch(): Tag '" + key + "' not in tag columns."
+      };
+    }
+  }
+
+  const TimeSeriesKey series_key{0, metric, tags};
+  std::visit([this, rows, &series_key](auto& storage_engine) {
+    using TValue = EngineValue<decltype(storage_engine)>;
+    std::vector<TimeSeriesEntry<TValue>> entries;
+    entries.reserve(rows.size());
+    for (const auto& [timestamp, value] : rows) {
+      entries.emplace_back(
+        TimeSeriesKey{timestamp, series_key.series()},
+        convert_value<TValue>(value, name_, value_type_)
+      );
+    }
+    storage_engine.putBatch(entries);
+  }, storage_engine_);
+}
+
+void Table::putBatch(std::span<const TimeSeriesEntry<double>> entries) {
+  std::unordered_set<SeriesId> validated_series;
+  for (const auto& [key, value] : entries) {
+    if (!validated_series.insert(key.seriesId()).second) {
+      continue;
+    }
+    for (const auto& [tag_key, tag_value] : key.tags()) {
+      if (!tag_columns_.contains(tag_key)) {
+        throw std::runtime_error{
+          "Table::putBatch(): Tag '" + tag_key + "' not in tag columns."
+        };
+      }
+    }
+  }
+  std::visit([this, entries](auto& storage_engine) {
+    using TValue = EngineValue<decltype(storage_engine)>;
+    if constexpr (std::is_same_v<TValue, double>) {
+      storage_engine.putBatch(entries);
+    } else {
+      std::vector<TimeSeriesEntry<TValue>> converted;
+      converted.reserve(entries.size());
+      for (const auto& [key, value] : entries) {
+        converted.emplace_back(
+          key,
+          value.has_value()
+            ? std::optional<TValue>{
+                convert_value<TValue>(value.value(), name_, value_type_)
+              }
+            : std::nullopt
+        );
+      }
+      storage_engine.putBatch(converted);
+    }
+  }, storage_engine_);
+}
+
+FriendlyQueryBuilder<double> Table::query() {
+  return query<double>();
+}
+
+ValueType Table::valueType() const noexcept {
+  return value_type_;
+}
+
+uint64_t Table::shardCount() const noexcept {
+  return std::visit([](const auto& storage_engine) {
+    return storage_engine.shardCount();
+  }, storage_engine_);
 }
 
-FriendlyQueryBuilder<double> Table::query() noexcept {
-  return FriendlyQueryBuilder<double>(storage_engine_, tag_columns_);
+StorageStats Table::stats() const {
+  return std::visit([](const auto& storage_engine) {
+    return storage_engine.stats();
+  }, storage_engine_);
+}
+
+MemoryUsage Table::memoryUsage() const {
+  return std::visit([](const auto& storage_engine) {
+    return storage_engine.memoryUsage();
+  }, storage_engine_);
+}
+
+MemoryConsumer Table::memoryConsumer() {
+  return {
+    .usage = [this] { return memoryUsage(); },
+    .last_access = [this] {
+      return std::visit([](const auto& storage_engine) {
+        return storage_engine.lastAccess();
+      }, storage_engine_);
+    },
+    .flush = [this] {
+      std::visit([](auto& storage_engine) {
+        storage_engine.flushMemTable();
+      }, storage_engine_);
+    },
+    .release = [this] {
+      std::visit([](const auto& storage_engine) {
+        storage_engine.releaseMemory();
+      }, storage_engine_);
+    }
+  };
+}
+
+WALChunk Table::readWAL(uint64_t shard, uint64_t lsn, uint64_t max_bytes) {
+  return std::visit([shard, lsn, max_bytes](auto& storage_engine) {
+    return storage_engine.shard(shard).readWAL(lsn, max_bytes);
+  }, storage_engine_);
+}
+
+void Table::acknowledgeWAL(uint64_t shard, uint64_t lsn) {
+  std::visit([shard, lsn](auto& storage_engine) {
+    storage_engine.shard(shard).acknowledgeWAL(lsn);
+  }, storage_engine_);
+}
+
+uint64_t Table::applyWAL(uint64_t shard, const std::string& records) {
+  return std::visit([shard, &records](auto& storage_engine) {
+    auto& lsm_tree{storage_engine.shard(shard)};
+    const auto applied{lsm_tree.applyWAL(records)};
+    lsm_tree.syncWAL();
+    return applied;
+  }, storage_engine_);
+}
+
+std::vector<uint64_t> Table::checkpoint(const FilePath& directory) {
+  auto lsns{std::visit([&directory](auto& storage_engine) {
+    return storage_engine.checkpoint(directory);
+  }, storage_engine_)};
+  for (const auto& file_path : {tag_columns_path(), options_path()}) {
+    if (std::filesystem::exists(file_path)) {
+      std::filesystem::copy_file(file_path, directory / file_path.filename());
+    }
+  }
+  return lsns;
 }
 
 TableName Table::name() const noexcept {
@@ -68,26 +385,45 @@ TagColumns Table::tagColumns() const noexcept {
   return tag_columns_;
 }
 
+TableOptions Table::options() const noexcept {
+  return std::visit([](const auto& storage_engine) {
+    return storage_engine.options();
+  }, storage_engine_);
+}
+
 FilePath Table::path() const noexcept {
   return db_path_ / FilePath{name_};
 }
 
+Table::StorageEngine Table::open_storage_engine(TableOptions options) {
+  options = load_options(std::move(options));
+  switch (value_type_) {
+  case ValueType::INT64:
+    return ShardedLSMTree<int64_t>{path(), std::move(options)};
+  case ValueType::INT32:
+    return ShardedLSMTree<int32_t>{path(), std::move(options)};
+  case ValueType::FLOAT:
+    return ShardedLSMTree<float>{path(), std::move(options)};
+  case ValueType::BOOL:
+    return ShardedLSMTree<bool>{path(), std::move(options)};
+  case ValueType::DOUBLE:
+    break;
+  }
+  return ShardedLSMTree<double>{path(), std::move(options)};
+}
+
 bool Table::been_populated() const noexcept {
-  return !storage_engine_.empty();
+  return std::visit([](const auto& storage_engine) {
+    return !storage_engine.empty();
+  }, storage_engine_);
 }
 
 void Table::save_tag_columns() const {
-  std::ofstream file{tag_columns_path()};
-  if (!file.is_open()) {
-    throw std::runtime_error{
-      "Table::save_tag_columns(): Unable to open file "
-      + std::string(tag_columns_path()) + "."
-    };
-  }
+  std::string contents;
   for (const auto& column : tag_columns_) {
-    file << column << "\n";
+    contents += column + "\n";
   }
-  file.close();
+  writeFile(options().io_backend, tag_columns_path(), contents, false);
 }
 
 void Table::load_tag_columns() {
@@ -115,10 +451,160 @@ FilePath Table::tag_columns_path() const noexcept {
   return path() / TAG_COLUMNS_FILENAME;
 }
 
+void Table::save_options(const TableOptions& options) const {
+  std::filesystem::create_directories(path());
+  std::ofstream file{options_path()};
+  if (!file.is_open()) {
+    throw std::runtime_error{
+      "Table::save_options(): Unable to open file "
+      + std::string(options_path()) + "."
+    };
+  }
+  file << std::setprecision(std::numeric_limits<double>::max_digits10);
+  file << "mem_table_max_entries " << options.mem_table_max_entries << "\n";
+  file << "cache_capacity " << options.cache_capacity << "\n";
+  file << "layer_window_sizes";
+  for (const auto window_size : options.layer_window_sizes) {
+    file << " " << window_size;
+  }
+  file << "\n";
+  file << "layer_table_counts";
+  for (const auto table_count : options.layer_table_counts) {
+    file << " " << table_count;
+  }
+  file << "\n";
+  file << "bloom_filter_false_positive_rate "
+    << options.bloom_filter_false_positive_rate << "\n";
+  file << "sync_sstables " << options.sync_sstables << "\n";
+  file << "retention " << options.retention << "\n";
+  file << "background_compaction " << options.background_compaction << "\n";
+  file << "c0_stall_threshold " << options.c0_stall_threshold << "\n";
+  file << "max_immutable_mem_tables "
+    << options.max_immutable_mem_tables << "\n";
+  file << "mem_table_format "
+    << static_cast<uint64_t>(options.mem_table_format) << "\n";
+  file << "rollups " << options.rollups << "\n";
+  file << "compression "
+    << static_cast<uint64_t>(options.compression) << "\n";
+  file << "wal_sync_policy "
+    << static_cast<uint64_t>(options.wal.sync_policy) << "\n";
+  file << "wal_sync_interval " << options.wal.sync_interval.count() << "\n";
+  file << "wal_sync_bytes " << options.wal.sync_bytes << "\n";
+  file << "wal_compression "
+    << static_cast<uint64_t>(options.wal.compression) << "\n";
+  file << "io_backend "
+    << static_cast<uint64_t>(options.io_backend) << "\n";
+  file << "wal_io_backend "
+    << static_cast<uint64_t>(options.wal.io_backend) << "\n";
+  file << "shards " << options.shards << "\n";
+  file << "wal_archive " << options.wal.archive << "\n";
+  file << "wal_format " << static_cast<uint64_t>(options.wal.format) << "\n";
+  file << "value_type " << static_cast<uint64_t>(value_type_) << "\n";
+  file.close();
+}
+
+TableOptions Table::load_options(TableOptions options) {
+  if (!std::filesystem::exists(options_path())) {
+    save_options(options);
+    return options;
+  }
+  std::ifstream file{options_path()};
+  if (!file.is_open()) {
+    throw std::runtime_error{
+      "Table::load_options(): Unable to open file "
+      + std::string(options_path()) + "."
+    };
+  }
+  value_type_ = ValueType::DOUBLE;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream{line};
+    std::string name;
+    if (!(stream >> name)) {
+      continue;
+    }
+    if (name == "mem_table_max_entries") {
+      read_option(stream, name, options.mem_table_max_entries);
+    } else if (name == "cache_capacity") {
+      read_option(stream, name, options.cache_capacity);
+    } else if (name == "layer_window_sizes") {
+      for (auto& window_size : options.layer_window_sizes) {
+        read_option(stream, name, window_size);
+      }
+    } else if (name == "layer_table_counts") {
+      for (auto& table_count : options.layer_table_counts) {
+        read_option(stream, name, table_count);
+      }
+    } else if (name == "bloom_filter_false_positive_rate") {
+      read_option(stream, name, options.bloom_filter_false_positive_rate);
+    } else if (name == "sync_sstables") {
+      read_option(stream, name, options.sync_sstables);
+    } else if (name == "retention") {
+      read_option(stream, name, options.retention);
+    } else if (name == "background_compaction") {
+      read_option(stream, name, options.background_compaction);
+    } else if (name == "c0_stall_threshold") {
+      read_option(stream, name, options.c0_stall_threshold);
+    } else if (name == "max_immutable_mem_tables") {
+      read_option(stream, name, options.max_immutable_mem_tables);
+    } else if (name == "mem_table_format") {
+      read_enum_option(
+        stream, name, MemTableFormat::SORTED_RUN, options.mem_table_format
+      );
+    } else if (name == "rollups") {
+      read_option(stream, name, options.rollups);
+    } else if (name == "compression") {
+      read_enum_option(
+        stream, name, Compression::ZSTD, options.compression
+      );
+    } else if (name == "wal_sync_policy") {
+      read_enum_option(
+        stream, name, WALSyncPolicy::BYTES, options.wal.sync_policy
+      );
+    } else if (name == "wal_sync_interval") {
+      int64_t milliseconds;
+      read_option(stream, name, milliseconds);
+      options.wal.sync_interval = std::chrono::milliseconds{milliseconds};
+    } else if (name == "wal_sync_bytes") {
+      read_option(stream, name, options.wal.sync_bytes);
+    } else if (name == "wal_compression") {
+      read_enum_option(
+        stream, name, Compression::ZSTD, options.wal.compression
+      );
+    } else if (name == "io_backend") {
+      read_enum_option(
+        stream, name, IOBackend::IO_URING, options.io_backend
+      );
+    } else if (name == "wal_io_backend") {
+      read_enum_option(
+        stream, name, IOBackend::IO_URING, options.wal.io_backend
+      );
+    } else if (name == "shards") {
+      read_option(stream, name, options.shards);
+    } else if (name == "wal_archive") {
+      read_option(stream, name, options.wal.archive);
+    } else if (name == "wal_format") {
+      read_enum_option(
+        stream, name, WALFormat::BINARY, options.wal.format
+      );
+    } else if (name == "value_type") {
+      read_enum_option(stream, name, ValueType::BOOL, value_type_);
+    }
+  }
+  file.close();
+  return options;
+}
+
+FilePath Table::options_path() const noexcept {
+  return path() / TABLE_OPTIONS_FILENAME;
+}
+
 void Table::load() {
   std::filesystem::create_directories(path());
   load_tag_columns();
-  storage_engine_.replayWAL();
+  std::visit([](auto& storage_engine) {
+    storage_engine.replayWAL();
+  }, storage_engine_);
 }
 
 } // namespace vkdb
\ No newline at end of file
@@ -2,6 +2,36 @@
 #include <vkdb/database.h>
 
 namespace vkdb {
+namespace {
+/**
+ * @brief Convert data points of the value type of a table to doubles.
+ * 
+ * @tparam TValue Value type of the table.
+ * @param datapoints Data points.
+ * @return SelectDataResult Data points, with their values as doubles.
+ */
+template <ArithmeticNoCVRefQuals TValue>
+[[nodiscard]] SelectDataResult to_double_datapoints(
+  std::vector<DataPoint<TValue>>&& datapoints
+) {
+  if constexpr (std::is_same_v<TValue, double>) {
+    return std::move(datapoints);
+  } else {
+    SelectDataResult converted;
+    converted.reserve(datapoints.size());
+    for (auto& datapoint : datapoints) {
+      converted.push_back({
+        datapoint.timestamp,
+        std::move(datapoint.metric),
+        std::move(datapoint.tags),
+        static_cast<double>(datapoint.value)
+      });
+    }
+    return converted;
+  }
+}
+}  // namespace
+
 RuntimeError::RuntimeError(Token token, const std::string& message) noexcept
   : token_{token}, message_{message} {}
 
@@ -13,25 +43,53 @@ std::string RuntimeError::message() const noexcept {
   return message_;
 }
 
-Interpreter::Interpreter(Database& database, error_callback callback) noexcept
-  : database_{database}, callback_{callback} {}
+Interpreter::Interpreter(
+  Database& database,
+  error_callback callback,
+  std::span<const Parameter> parameters,
+  OutputFormat format
+) noexcept
+  : database_{database}
+  , callback_{callback}
+  , parameters_{parameters}
+  , format_{format} {}
 
 void Interpreter::interpret(
   const Expr& expr,
   std::ostream& stream
 ) const noexcept {
+  ResultWriter writer{stream, format_};
   try {
-    auto results{visit(expr)};
-    for (const auto& result : results) {
-      if (result.has_value()) {
-        stream << to_string(result.value()) << '\n';
-      }
+    for (const auto& query : expr) {
+      this->stream(query, writer);
     }
   } catch (const RuntimeError& error) {
+    writer.flush();
     callback_(error);
   }
 }
 
+void Interpreter::write(
+  const OutputResult& result,
+  ResultWriter& writer
+) const {
+  const auto select_result{std::get_if<SelectResult>(&result)};
+  const auto datapoints{
+    select_result == nullptr
+      ? nullptr
+      : std::get_if<SelectDataResult>(select_result)
+  };
+  if (datapoints == nullptr) {
+    writer.writeLine(to_string(result));
+    return;
+  }
+  writer.beginDataPoints();
+  for (const auto& datapoint : *datapoints) {
+    writer.writeDataPoint(datapoint);
+  }
+  writer.endDataPoints();
+}
+
 std::string Interpreter::to_string(const OutputResult& result) const {
   return std::visit([this](auto&& result) -> std::string {
     using R = std::decay_t<decltype(result)>;
@@ -39,6 +97,8 @@ std::string Interpreter::to_string(const OutputResult& result) const {
       return to_string(result);
     } else if constexpr (std::is_same_v<R, TablesResult>) {
       return to_string(result);
+    } else if constexpr (std::is_same_v<R, StatsResult>) {
+      return to_string(result);
     }
   }, result);
 }
@@ -52,10 +112,50 @@ std::string Interpreter::to_string(const SelectResult& result) const {
       return std::to_string(result);
     } else if constexpr (std::is_same_v<R, SelectCountResult>) {
       return std::to_string(result);
+    } else if constexpr (std::is_same_v<R, SelectBucketsResult>) {
+      std::string buckets_result{"["};
+      auto first{true};
+      for (const auto& [start, value] : result) {
+        if (!first) {
+          buckets_result += ";";
+        }
+        buckets_result += std::to_string(start) + ":" + std::to_string(value);
+        first = false;
+      }
+      return buckets_result + "]";
+    } else if constexpr (std::is_same_v<R, SelectAggregatesResult>) {
+      return "[" + aggregates_to_string(result) + "]";
+    } else if constexpr (std::is_same_v<R, SelectAggregateBucketsResult>) {
+      std::string buckets_result{"["};
+      auto first{true};
+      for (const auto& [start, values] : result) {
+        if (!first) {
+          buckets_result += ";";
+        }
+        buckets_result += std::to_string(start) + ":" +
+          aggregates_to_string(values);
+        first = false;
+      }
+      return buckets_result + "]";
     }
   }, result);
 }
 
+std::string Interpreter::aggregates_to_string(
+  const std::vector<double>& values
+) {
+  std::string aggregates_result{};
+  auto first{true};
+  for (const auto value : values) {
+    if (!first) {
+      aggregates_result += ",";
+    }
+    aggregates_result += std::to_string(value);
+    first = false;
+  }
+  return aggregates_result;
+}
+
 std::string Interpreter::to_string(const TablesResult& result) const {
   std::string tables_result{};
   auto first{true};
@@ -69,16 +169,115 @@ std::string Interpreter::to_string(const TablesResult& result) const {
   return tables_result;
 }
 
-Results Interpreter::visit(const Expr& expr) const {
+std::string Interpreter::to_string(const StatsResult& result) const {
+  std::string stats_result{};
+  for (const auto& [table_name, stats] : result) {
+    std::istringstream lines{stats.str()};
+    for (std::string line; std::getline(lines, line);) {
+      if (!stats_result.empty()) {
+        stats_result += "\n";
+      }
+      stats_result += table_name + " " + line;
+    }
+  }
+  return stats_result;
+}
+
+template <typename TVisitor>
+decltype(auto) Interpreter::visit_select_builder(
+  const SelectQuery& query,
+  TVisitor&& visitor
+) const {
+  Table* table{nullptr};
   try {
-    Results results{};
-    for (const auto& query : expr) {
-      results.push_back(visit(query));
+    table = &database_.getTable(visit(query.table_name));
+  } catch (const std::exception& e) {
+    throw RuntimeError{query.metric.token, e.what()};
+  }
+  return table->visitQuery([&](auto query_builder) -> decltype(auto) {
+    auto every_clause_result{select_clauses(query_builder, query)};
+    return visitor(query_builder, every_clause_result);
+  });
+}
+
+template <ArithmeticNoCVRefQuals TValue>
+std::optional<EveryClauseResult> Interpreter::select_clauses(
+  FriendlyQueryBuilder<TValue>& query_builder,
+  const SelectQuery& query
+) const {
+  try {
+    auto metric_result{visit(query.metric)};
+    std::ignore = query_builder.whereMetricIs(metric_result);
+    std::optional<EveryClauseResult> every_clause_result;
+    std::visit([&](auto&& select_clause) -> void {
+      using C = std::decay_t<decltype(select_clause)>;
+      if constexpr (std::is_same_v<C, AllClause>) {
+        auto all_clause_result{visit(select_clause)};
+        add_optional_tag_list(query_builder, all_clause_result);
+      } else if constexpr (std::is_same_v<C, BetweenClause>) {
+        auto between_clause_result{visit(select_clause)};
+        std::ignore = query_builder.whereTimestampBetween(
+          std::get<0>(between_clause_result),
+          std::get<1>(between_clause_result)
+        );
+        add_optional_tag_list(
+          query_builder,
+          std::get<2>(between_clause_result)
+        );
+        every_clause_result = std::get<3>(between_clause_result);
+      } else if constexpr (std::is_same_v<C, AtClause>) {
+        auto at_clause_result{visit(select_clause)};
+        std::ignore = query_builder.whereTimestampIs(at_clause_result.first);
+        add_optional_tag_list(query_builder, at_clause_result.second);
+      }
+    }, query.clause);
+    if (query.order_clause.has_value()) {
+      std::ignore = query_builder.orderBy(visit(query.order_clause.value()));
     }
-    return results;
+    if (query.limit_clause.has_value()) {
+      std::ignore = query_builder.limit(visit(query.limit_clause.value()));
+    }
+    return every_clause_result;
   } catch (const RuntimeError& e) {
     throw e;
+  } catch (const std::exception& e) {
+    throw RuntimeError{query.metric.token, e.what()};
+  }
+}
+
+void Interpreter::stream(const Query& query, ResultWriter& writer) const {
+  if (const auto select_query{std::get_if<SelectQuery>(&query)}) {
+    stream(*select_query, writer);
+  } else if (const auto result{visit(query)}; result.has_value()) {
+    write(result.value(), writer);
+  }
+}
+
+void Interpreter::stream(
+  const SelectQuery& query,
+  ResultWriter& writer
+) const {
+  const auto data{std::get_if<SelectTypeDataExpr>(&query.type)};
+  if (data == nullptr) {
+    write(visit(query), writer);
+    return;
   }
+  visit_select_builder(query, [&](auto& query_builder, auto every) {
+    if (every.has_value()) {
+      std::ignore = handle_bucketed_select_type(
+        query_builder, query.type, every.value()
+      );
+    }
+    writer.beginDataPoints();
+    try {
+      query_builder.forEach([&writer](const auto& key, auto value) {
+        writer.writeDataPoint(key, static_cast<double>(value));
+      });
+    } catch (const std::exception& e) {
+      throw RuntimeError{data->token, e.what()};
+    }
+    writer.endDataPoints();
+  });
 }
 
 Result Interpreter::visit(const Query& query) const {
@@ -90,6 +289,9 @@ Result Interpreter::visit(const Query& query) const {
       } else if constexpr (std::is_same_v<Q, PutQuery>) {
         visit(query);
         return std::nullopt;
+      } else if constexpr (std::is_same_v<Q, PutValuesQuery>) {
+        visit(query);
+        return std::nullopt;
       } else if constexpr (std::is_same_v<Q, DeleteQuery>) {
         visit(query);
         return std::nullopt;
@@ -107,6 +309,8 @@ Result Interpreter::visit(const Query& query) const {
         return std::nullopt;
       } else if constexpr (std::is_same_v<Q, TablesQuery>) {
         return visit(query);
+      } else if constexpr (std::is_same_v<Q, StatsQuery>) {
+        return visit(query);
       }
     }, query);
   } catch (const RuntimeError& e) {
@@ -114,8 +318,9 @@ Result Interpreter::visit(const Query& query) const {
   }
 }
 
+template <ArithmeticNoCVRefQuals TValue>
 void Interpreter::add_optional_tag_list(
-  FriendlyQueryBuilder<double> &query_builder,
+  FriendlyQueryBuilder<TValue> &query_builder,
   const std::optional<TagListExprResult>& tag_list
 ) noexcept {
   if (tag_list.has_value()) {
@@ -125,25 +330,72 @@ void Interpreter::add_optional_tag_list(
   }
 }
 
+std::vector<AggregateFunction> Interpreter::aggregate_functions(
+  const SelectTypeAggregatesExpr& type
+) {
+  std::vector<AggregateFunction> functions;
+  for (const auto& function : type.functions) {
+    switch (function.type()) {
+    case TokenType::COUNT:
+      functions.push_back(AggregateFunction::COUNT);
+      break;
+    case TokenType::AVG:
+      functions.push_back(AggregateFunction::AVG);
+      break;
+    case TokenType::SUM:
+      functions.push_back(AggregateFunction::SUM);
+      break;
+    case TokenType::MIN:
+      functions.push_back(AggregateFunction::MIN);
+      break;
+    case TokenType::MAX:
+      functions.push_back(AggregateFunction::MAX);
+      break;
+    default:
+      throw RuntimeError{function, "Expected aggregate function."};
+    }
+  }
+  return functions;
+}
+
+template <ArithmeticNoCVRefQuals TValue>
 SelectResult Interpreter::handle_select_type(
-  FriendlyQueryBuilder<double> &query_builder,
+  FriendlyQueryBuilder<TValue> &query_builder,
   SelectType type
 ) {
   return std::visit([&query_builder](auto&& type) -> SelectResult {
     using T = std::decay_t<decltype(type)>;
     try {
       if constexpr (std::is_same_v<T, SelectTypeDataExpr>) {
-        return query_builder.execute();
+        return to_double_datapoints(query_builder.execute());
+      } else if constexpr (std::is_same_v<T, SelectTypeLastExpr>) {
+        return to_double_datapoints(query_builder.latest());
       } else if constexpr (std::is_same_v<T, SelectTypeCountExpr>) {
         return query_builder.count();
       } else if constexpr (std::is_same_v<T, SelectTypeAvgExpr>) {
         return query_builder.avg();
       } else if constexpr (std::is_same_v<T, SelectTypeSumExpr>) {
-        return query_builder.sum();
+        return static_cast<double>(query_builder.sum());
       } else if constexpr (std::is_same_v<T, SelectTypeMinExpr>) {
-        return query_builder.min();
+        return static_cast<double>(query_builder.min());
       } else if constexpr (std::is_same_v<T, SelectTypeMaxExpr>) {
-        return query_builder.max();
+        return static_cast<double>(query_builder.max());
+      } else if constexpr (std::is_same_v<T, SelectTypePercentileExpr>) {
+        std::vector<double> percentiles;
+        for (const auto& percentile : type.percentiles) {
+          percentiles.push_back(std::stod(percentile.lexeme()));
+        }
+        auto estimates{query_builder.percentiles(percentiles)};
+        if (estimates.size() == 1) {
+          return estimates.front();
+        }
+        return estimates;
+      } else if constexpr (
+        std::is_same_v<T, SelectTypeApproxCountDistinctExpr>
+      ) {
+        return query_builder.approxCountDistinct();
+      } else if constexpr (std::is_same_v<T, SelectTypeAggregatesExpr>) {
+        return query_builder.aggregate(aggregate_functions(type));
       }
     } catch (const std::exception& e) {
       throw RuntimeError{type.token, e.what()};
@@ -151,40 +403,67 @@ SelectResult Interpreter::handle_select_type(
   }, type);
 }
 
+template <ArithmeticNoCVRefQuals TValue>
+SelectResult Interpreter::handle_bucketed_select_type(
+  FriendlyQueryBuilder<TValue> &query_builder,
+  SelectType type,
+  Timestamp width
+) {
+  return std::visit([&query_builder, width](auto&& type) -> SelectResult {
+    using T = std::decay_t<decltype(type)>;
+    if constexpr (std::is_same_v<T, SelectTypeDataExpr>) {
+      throw RuntimeError{type.token, "Cannot bucket DATA."};
+    } else if constexpr (std::is_same_v<T, SelectTypeLastExpr>) {
+      throw RuntimeError{type.token, "Cannot bucket LAST."};
+    } else if constexpr (std::is_same_v<T, SelectTypePercentileExpr>) {
+      throw RuntimeError{type.token, "Cannot bucket PERCENTILE."};
+    } else if constexpr (
+      std::is_same_v<T, SelectTypeApproxCountDistinctExpr>
+    ) {
+      throw RuntimeError{type.token, "Cannot bucket APPROX_COUNT_DISTINCT."};
+    } else if constexpr (std::is_same_v<T, SelectTypeAggregatesExpr>) {
+      const auto functions{aggregate_functions(type)};
+      try {
+        return query_builder.aggregateEvery(functions, width);
+      } catch (const std::exception& e) {
+        throw RuntimeError{type.token, e.what()};
+      }
+    } else {
+      const auto function{[]() -> AggregateFunction {
+        if constexpr (std::is_same_v<T, SelectTypeCountExpr>) {
+          return AggregateFunction::COUNT;
+        } else if constexpr (std::is_same_v<T, SelectTypeAvgExpr>) {
+          return AggregateFunction::AVG;
+        } else if constexpr (std::is_same_v<T, SelectTypeSumExpr>) {
+          return AggregateFunction::SUM;
+        } else if constexpr (std::is_same_v<T, SelectTypeMinExpr>) {
+          return AggregateFunction::MIN;
+        } else {
+          return AggregateFunction::MAX;
+        }
+      }()};
+      try {
+        return query_builder.aggregateEvery(function, width);
+      } catch (const std::exception& e) {
+        throw RuntimeError{type.token, e.what()};
+      }
+    }
+  }, type);
+}
+
 SelectResult Interpreter::visit(const SelectQuery& query) const {
-  try {
-    auto type_result{visit(query.type)};
-    auto metric_result{visit(query.metric)};
-    auto table_name_result{visit(query.table_name)};
-    auto& table{database_.getTable(table_name_result)};
-    auto query_builder{table.query()
-      .whereMetricIs(metric_result)
-    };
-    std::visit([this, &query_builder](auto&& select_clause) -> void {
-      using C = std::decay_t<decltype(select_clause)>;
-      if constexpr (std::is_same_v<C, AllClause>) {
-        auto all_clause_result{visit(select_clause)};
-        add_optional_tag_list(query_builder, all_clause_result);
-      } else if constexpr (std::is_same_v<C, BetweenClause>) {
-        auto between_clause_result{visit(select_clause)};
-        std::ignore = query_builder.whereTimestampBetween(
-          std::get<0>(between_clause_result),
-          std::get<1>(between_clause_result)
+  auto type_result{visit(query.type)};
+  return visit_select_builder(
+    query,
+    [&type_result](auto& query_builder, auto every) -> SelectResult {
+      if (every.has_value()) {
+        return handle_bucketed_select_type(
+          query_builder, type_result, every.value()
         );
-        add_optional_tag_list(
-          query_builder,
-          std::get<2>(between_clause_result)
-        );
-      } else if constexpr (std::is_same_v<C, AtClause>) {
-        auto at_clause_result{visit(select_clause)};
-        std::ignore = query_builder.whereTimestampIs(at_clause_result.first);
-        add_optional_tag_list(query_builder, at_clause_result.second);
       }
-    }, query.clause);
-    return handle_select_type(query_builder, type_result);
-  } catch (const RuntimeError& e) {
-    throw e;
-  }
+      return handle_select_type(query_builder, type_result);
+    }
+  );
 }
 
 PutResult Interpreter::visit(const PutQuery& query) const {
@@ -194,17 +473,36 @@ PutResult Interpreter::visit(const PutQuery& query) const {
     auto value_result{visit(query.value)};
     auto table_name_result{visit(query.table_name)};
 
+    auto tag_list_result{
+      query.tag_list.has_value()
+        ? visit(query.tag_list.value())
+        : TagListExprResult{}
+    };
+
     auto& table{database_.getTable(table_name_result)};
-    if (!query.tag_list.has_value()) {
-      table.query()
-        .put(timestamp_result, metric_result, {}, value_result)
-        .execute();
-    }
+    const std::pair<Timestamp, double> row{timestamp_result, value_result};
+    table.putBatch(metric_result, tag_list_result, {&row, 1});
+  } catch (const std::exception& e) {
+    throw RuntimeError{query.metric.token, e.what()};
+  }
+}
 
-    auto tag_list_result{visit(query.tag_list.value())};
-    table.query()
-      .put(timestamp_result, metric_result, tag_list_result, value_result)
-      .execute();
+PutResult Interpreter::visit(const PutValuesQuery& query) const {
+  try {
+    auto metric_result{visit(query.metric)};
+    auto table_name_result{visit(query.table_name)};
+    auto tag_list_result{
+      query.tag_list.has_value()
+        ? visit(query.tag_list.value())
+        : TagListExprResult{}
+    };
+    std::vector<std::pair<Timestamp, double>> rows;
+    rows.reserve(query.rows.size());
+    for (const auto& row : query.rows) {
+      rows.emplace_back(visit(row.timestamp), visit(row.value));
+    }
+    auto& table{database_.getTable(table_name_result)};
+    table.putBatch(metric_result, tag_list_result, rows);
   } catch (const std::exception& e) {
     throw RuntimeError{query.metric.token, e.what()};
   }
@@ -217,15 +515,35 @@ DeleteResult Interpreter::visit(const DeleteQuery& query) const {
     auto table_name_result{visit(query.table_name)};
     
     auto& table{database_.getTable(table_name_result)};
+    if (query.end_timestamp.has_value()) {
+      auto end_timestamp_result{visit(query.end_timestamp.value())};
+      TagTable tag_list_result;
+      if (query.tag_list.has_value()) {
+        tag_list_result = visit(query.tag_list.value());
+      }
+      table.visitQuery([&](auto query_builder) {
+        query_builder
+          .removeRange(
+            timestamp_result, end_timestamp_result, metric_result,
+            tag_list_result
+          )
+          .execute();
+      });
+      return;
+    }
     if (!query.tag_list.has_value()) {
-      table.query()
-        .remove(timestamp_result, metric_result, {})
-        .execute();
+      table.visitQuery([&](auto query_builder) {
+        query_builder
+          .remove(timestamp_result, metric_result, {})
+          .execute();
+      });
     }
     auto tag_list_result{visit(query.tag_list.value())};
-    table.query()
-      .remove(timestamp_result, metric_result, tag_list_result)
-      .execute();
+    table.visitQuery([&](auto query_builder) {
+      query_builder
+        .remove(timestamp_result, metric_result, tag_list_result)
+        .execute();
+    });
   } catch (const std::exception& e) {
     throw RuntimeError{query.metric.token, e.what()};
   }
@@ -234,7 +552,12 @@ DeleteResult Interpreter::visit(const DeleteQuery& query) const {
 CreateResult Interpreter::visit(const CreateQuery& query) const {
   try {
     auto table_name_result{visit(query.table_name)};
-    database_.createTable(table_name_result);
+    const auto value_type_result{
+      query.value_type.has_value()
+        ? visit(query.value_type.value())
+        : ValueType::DOUBLE
+    };
+    database_.createTable(table_name_result, {}, value_type_result);
     if (query.tag_columns.has_value()) {
       auto tag_columns_result{visit(query.tag_columns.value())};
       database_
@@ -293,6 +616,18 @@ TablesResult Interpreter::visit(const TablesQuery& query) const {
   }
 }
 
+StatsResult Interpreter::visit(const StatsQuery& query) const {
+  if (!query.table_name) {
+    return database_.stats();
+  }
+  try {
+    const auto& table_name{query.table_name->token.lexeme()};
+    return {{table_name, database_.getTable(table_name).stats()}};
+  } catch (const std::exception& e) {
+    throw RuntimeError{query.table_name->token, e.what()};
+  }
+}
+
 AllClauseResult Interpreter::visit(const AllClause& clause) const {
   AllClauseResult all_clause_result{};
   if (clause.where_clause.has_value()) {
@@ -309,6 +644,9 @@ BetweenClauseResult Interpreter::visit(const BetweenClause& clause) const {
     if (clause.where_clause.has_value()) {
       std::get<2>(between_clause_result) = visit(clause.where_clause.value());
     }
+    if (clause.every_clause.has_value()) {
+      std::get<3>(between_clause_result) = visit(clause.every_clause.value());
+    }
     return between_clause_result;
   } catch (const std::exception& e) {
     throw RuntimeError{clause.start.token, e.what()};
@@ -328,6 +666,47 @@ AtClauseResult Interpreter::visit(const AtClause& clause) const {
   }
 }
 
+EveryClauseResult Interpreter::visit(const EveryClause& clause) const {
+  const auto width{visit(clause.width)};
+  if (width == 0) {
+    throw RuntimeError{clause.width.token, "Invalid bucket width."};
+  }
+  return width;
+}
+
+OrderClauseResult Interpreter::visit(
+  const OrderClause& clause
+) const noexcept {
+  const auto descending{
+    clause.direction.has_value() &&
+    clause.direction->type() == TokenType::DESC
+  };
+  if (clause.key.type() == TokenType::VALUE) {
+    return descending ? QueryOrder::VALUE_DESC : QueryOrder::VALUE_ASC;
+  }
+  return descending ? QueryOrder::TIMESTAMP_DESC : QueryOrder::TIMESTAMP_ASC;
+}
+
+LimitClauseResult Interpreter::visit(const LimitClause& clause) const {
+  if (clause.count.type() == TokenType::PLACEHOLDER) {
+    const auto& bound{parameter(clause.count)};
+    const auto value{std::get_if<int64_t>(&bound)};
+    if (value == nullptr || *value < 0) {
+      throw RuntimeError{clause.count, "Invalid limit."};
+    }
+    return static_cast<LimitClauseResult>(*value);
+  }
+  const auto& lexeme{clause.count.lexeme()};
+  if (lexeme.find_first_not_of("0123456789") != std::string::npos) {
+    throw RuntimeError{clause.count, "Invalid limit."};
+  }
+  try {
+    return std::stoull(lexeme);
+  } catch (const std::exception& e) {
+    throw RuntimeError{clause.count, "Invalid limit."};
+  }
+}
+
 WhereClauseResult Interpreter::visit(const WhereClause& clause) const {
   return visit(clause.tag_list);
 }
@@ -352,11 +731,18 @@ TagKeyExprResult Interpreter::visit(const TagKeyExpr& tag_key) const noexcept {
 
 TagValueExprResult Interpreter::visit(
   const TagValueExpr& tag_value
-) const noexcept {
-  return tag_value.token.lexeme();
+) const {
+  if (tag_value.token.type() != TokenType::PLACEHOLDER) {
+    return tag_value.token.lexeme();
+  }
+  const auto& bound{parameter(tag_value.token)};
+  if (const auto value{std::get_if<std::string>(&bound)}) {
+    return *value;
+  }
+  throw RuntimeError{tag_value.token, "Invalid tag value."};
 }
 
-TagExprResult Interpreter::visit(const TagExpr& tag) const noexcept {
+TagExprResult Interpreter::visit(const TagExpr& tag) const {
   auto tag_key_result{visit(tag.key)};
   auto tag_value_result{visit(tag.value)};
   return {tag_key_result, tag_value_result};
@@ -381,6 +767,14 @@ TagColumnsExprResult Interpreter::visit(
 }
 
 TimestampExprResult Interpreter::visit(const TimestampExpr& timestamp) const {
+  if (timestamp.token.type() == TokenType::PLACEHOLDER) {
+    const auto& bound{parameter(timestamp.token)};
+    const auto value{std::get_if<int64_t>(&bound)};
+    if (value == nullptr || *value < 0) {
+      throw RuntimeError{timestamp.token, "Invalid timestamp."};
+    }
+    return static_cast<Timestamp>(*value);
+  }
   try {
     return std::stoull(timestamp.token.lexeme());
   } catch (const std::exception& e) {
@@ -389,10 +783,36 @@ TimestampExprResult Interpreter::visit(const TimestampExpr& timestamp) const {
 }
 
 ValueExprResult Interpreter::visit(const ValueExpr& value) const {
+  if (value.token.type() == TokenType::PLACEHOLDER) {
+    const auto& bound{parameter(value.token)};
+    if (const auto number{std::get_if<double>(&bound)}) {
+      return *number;
+    }
+    if (const auto number{std::get_if<int64_t>(&bound)}) {
+      return static_cast<double>(*number);
+    }
+    throw RuntimeError{value.token, "Invalid value."};
+  }
   try {
     return std::stod(value.token.lexeme());
   } catch (const std::exception& e) {
     throw RuntimeError{value.token, "Invalid value."};
   }
 }
+
+ValueTypeExprResult Interpreter::visit(const ValueTypeExpr& value_type) const {
+  try {
+    return valueTypeFromString(value_type.token.lexeme());
+  } catch (const std::exception& e) {
+    throw RuntimeError{value_type.token, "Invalid value type."};
+  }
+}
+
+const Parameter& Interpreter::parameter(const Token& token) const {
+  const auto index{token.parameter()};
+  if (!index || *index >= parameters_.size()) {
+    throw RuntimeError{token, "Unbound parameter."};
+  }
+  return parameters_[*index];
+}
 }  // namespace vkdb
\ No newline at end of file
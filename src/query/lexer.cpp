@@ -1,7 +1,7 @@
 #include <vkdb/lexer.h>
 
 namespace vkdb {
-Lexer::Lexer(const std::string& input) noexcept
+Lexer::Lexer(std::string_view input) noexcept
   : input_{input}, position_{0}, line_{1}, column_{1} {}
 
 std::vector<Token> Lexer::tokenize() {
@@ -24,6 +24,12 @@ std::vector<Token> Lexer::tokenize() {
       tokens.push_back(lex_comma());
     } else if (peek() == ';') {
       tokens.push_back(lex_semicolon());
+    } else if (peek() == '(') {
+      tokens.push_back(lex_left_paren());
+    } else if (peek() == ')') {
+      tokens.push_back(lex_right_paren());
+    } else if (peek() == '?') {
+      tokens.push_back(lex_placeholder());
     } else {
       tokens.push_back(lex_unknown());
     }
@@ -53,6 +59,9 @@ bool Lexer::chars_remaining() const noexcept {
 }
 
 char Lexer::peek() const {
+  if (!chars_remaining()) {
+    return '\0';
+  }
   return input_[position_];
 }
 
@@ -87,11 +96,8 @@ void Lexer::lex_whitespace() noexcept {
 Token Lexer::lex_word() noexcept {
   auto start{position_};
   advance_while([this](auto ch) { return is_alnum(ch); });
-  auto lexeme{make_lexeme_from(start)};
-  if (WORD_TO_TOKEN_TYPE.contains(lexeme)) {
-    return make_token(WORD_TO_TOKEN_TYPE.at(lexeme), lexeme);
-  }
-  return make_token(TokenType::IDENTIFIER, lexeme);
+  const auto lexeme{make_lexeme_from(start)};
+  return make_token(wordTokenType(lexeme), lexeme);
 }
 
 Token Lexer::lex_number() noexcept {
@@ -126,22 +132,36 @@ Token Lexer::lex_semicolon() noexcept {
   return make_token(TokenType::SEMICOLON, ";");
 }
 
+Token Lexer::lex_left_paren() noexcept {
+  advance();
+  return make_token(TokenType::LEFT_PAREN, "(");
+}
+
+Token Lexer::lex_right_paren() noexcept {
+  advance();
+  return make_token(TokenType::RIGHT_PAREN, ")");
+}
+
+Token Lexer::lex_placeholder() noexcept {
+  advance();
+  return make_token(TokenType::PLACEHOLDER, "?");
+}
+
 Token Lexer::lex_unknown() noexcept {
-  auto unknown{peek()};
   advance();
-  return make_token(TokenType::UNKNOWN, {unknown});
+  return make_token(TokenType::UNKNOWN, {&input_[position_ - 1], 1});
 }
 
 Token Lexer::lex_end_of_file() noexcept {
   return make_token(TokenType::END_OF_FILE, "");
 }
 
-Lexeme Lexer::make_lexeme_from(size_type start) const {
+std::string_view Lexer::make_lexeme_from(size_type start) const noexcept {
   return input_.substr(start, position_ - start);
 }
 
-Token Lexer::make_token(TokenType type, const Lexeme& lexeme) noexcept {
-  return Token{type, lexeme, line_, column_ - lexeme.length()};
+Token Lexer::make_token(TokenType type, std::string_view lexeme) noexcept {
+  return Token{type, Lexeme{lexeme}, line_, column_ - lexeme.length()};
 }
 
 }  // namespace vkdb
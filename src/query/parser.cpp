@@ -3,10 +3,10 @@
 
 namespace vkdb {
 Parser::Parser(
-  const std::vector<Token>& tokens,
+  std::vector<Token> tokens,
   error_callback callback
 ) noexcept
-  : tokens_{tokens}, callback_{callback}, position_{0} {}
+  : tokens_{std::move(tokens)}, callback_{std::move(callback)}, position_{0}, parameter_count_{0} {}
 
 std::optional<Expr> Parser::parse() noexcept {
   try {
@@ -16,7 +16,11 @@ std::optional<Expr> Parser::parse() noexcept {
   }
 }
 
-ParseError Parser::error(Token token, const std::string& message) {
+Parser::size_type Parser::parameterCount() const noexcept {
+  return parameter_count_;
+}
+
+ParseError Parser::error(const Token& token, const std::string& message) {
   callback_(token, message);
   return ParseError{};
 }
@@ -38,15 +42,15 @@ bool Parser::tokens_remaining() const noexcept {
   return position_ < tokens_.size();
 }
 
-Token Parser::peek_back() const {
+const Token& Parser::peek_back() const {
   return tokens_[position_ - 1];
 }
 
-Token Parser::peek() const {
+const Token& Parser::peek() const {
   return tokens_[position_];
 }
 
-Token Parser::advance() noexcept {
+const Token& Parser::advance() noexcept {
   if (tokens_remaining()) {
     ++position_;
   }
@@ -78,6 +82,22 @@ Token Parser::consume(TokenType type, const std::string& message) {
   throw error(peek(), message);
 }
 
+Token Parser::consume_or_placeholder(
+  TokenType type,
+  const std::string& message
+) {
+  if (check(TokenType::PLACEHOLDER)) {
+    const auto& placeholder{advance()};
+    return Token{
+      placeholder.lexeme(),
+      placeholder.line(),
+      placeholder.column(),
+      parameter_count_++
+    };
+  }
+  return consume(type, message);
+}
+
 Expr Parser::parse_expression() {
   Expr expr{};
   do {
@@ -105,6 +125,8 @@ Query Parser::parse_query() {
     return parse_remove_query();
   case TokenType::TABLES:
     return parse_tables_query();
+  case TokenType::SHOW:
+    return parse_stats_query();
   default:
     throw error(peek(), "Expected query base word.");
   }
@@ -117,17 +139,38 @@ SelectQuery Parser::parse_select_query() {
   consume(TokenType::FROM, "Expected FROM.");
   auto table_name{parse_table_name()};
   auto select_clause{parse_select_clause()};
+  std::optional<OrderClause> order_clause;
+  std::optional<LimitClause> limit_clause;
+  if (check(TokenType::ORDER) || check(TokenType::LIMIT)) {
+    if (
+      !std::holds_alternative<SelectTypeDataExpr>(select_type) &&
+      !std::holds_alternative<SelectTypeLastExpr>(select_type)
+    ) {
+      throw error(peek(), "Only DATA or LAST can be ordered or limited.");
+    }
+    if (check(TokenType::ORDER)) {
+      order_clause = parse_order_clause();
+    }
+    if (check(TokenType::LIMIT)) {
+      limit_clause = parse_limit_clause();
+    }
+  }
   return {
     select_type,
     metric,
     table_name,
-    select_clause
+    select_clause,
+    order_clause,
+    limit_clause
   };
 }
 
-PutQuery Parser::parse_put_query() {
+Query Parser::parse_put_query() {
   consume(TokenType::PUT, "Expected PUT");
   auto metric{parse_metric()};
+  if (check(TokenType::INTO)) {
+    return parse_put_values_query(std::move(metric));
+  }
   auto timestamp{parse_timestamp()};
   auto value{parse_value()};
   consume(TokenType::INTO, "Expected INTO.");
@@ -136,7 +179,7 @@ PutQuery Parser::parse_put_query() {
   if (match(TokenType::TAGS)) {
     tag_list = parse_tag_list();
   }
-  return {
+  return PutQuery{
     metric,
     timestamp,
     value,
@@ -145,10 +188,45 @@ PutQuery Parser::parse_put_query() {
   };
 }
 
+PutValuesQuery Parser::parse_put_values_query(MetricExpr metric) {
+  consume(TokenType::INTO, "Expected INTO.");
+  auto table_name{parse_table_name()};
+  std::optional<TagListExpr> tag_list;
+  if (match(TokenType::TAGS)) {
+    tag_list = parse_tag_list();
+  }
+  consume(TokenType::VALUES, "Expected VALUES.");
+  std::vector<ValueRowExpr> rows;
+  do {
+    rows.push_back(parse_value_row());
+  } while (match(TokenType::COMMA));
+  return {
+    std::move(metric),
+    std::move(table_name),
+    std::move(tag_list),
+    std::move(rows)
+  };
+}
+
+ValueRowExpr Parser::parse_value_row() {
+  consume(TokenType::LEFT_PAREN, "Expected '('.");
+  auto timestamp{parse_timestamp()};
+  consume(TokenType::COMMA, "Expected comma.");
+  auto value{parse_value()};
+  consume(TokenType::RIGHT_PAREN, "Expected ')'.");
+  return {std::move(timestamp), std::move(value)};
+}
+
 DeleteQuery Parser::parse_delete_query() {
   consume(TokenType::DELETE, "Expected DELETE.");
   auto metric{parse_metric()};
+  std::optional<TimestampExpr> end_timestamp;
+  const auto is_range{match(TokenType::BETWEEN)};
   auto timestamp{parse_timestamp()};
+  if (is_range) {
+    consume(TokenType::AND, "Expected AND.");
+    end_timestamp = parse_timestamp();
+  }
   consume(TokenType::FROM, "Expected FROM.");
   auto table_name{parse_table_name()};
   TagListExpr tag_list;
@@ -159,7 +237,8 @@ DeleteQuery Parser::parse_delete_query() {
     metric,
     timestamp,
     table_name,
-    tag_list
+    tag_list,
+    end_timestamp
   };
 }
 
@@ -171,9 +250,16 @@ CreateQuery Parser::parse_create_query() {
   if (match(TokenType::TAGS)) {
     tag_columns = parse_tag_columns();
   }
+  std::optional<ValueTypeExpr> value_type;
+  if (match(TokenType::TYPE)) {
+    value_type = ValueTypeExpr{
+      consume(TokenType::IDENTIFIER, "Expected value type.")
+    };
+  }
   return {
     table_name,
-    tag_columns
+    tag_columns,
+    value_type
   };
 }
 
@@ -213,12 +299,25 @@ TablesQuery Parser::parse_tables_query() {
   return {tables};
 }
 
+StatsQuery Parser::parse_stats_query() {
+  auto show{consume(TokenType::SHOW, "Expected SHOW.")};
+  consume(TokenType::STATS, "Expected STATS.");
+  std::optional<TableNameExpr> table_name;
+  if (match(TokenType::FROM)) {
+    table_name = parse_table_name();
+  }
+  return {show, table_name};
+}
+
 SelectType Parser::parse_select_type() {
   auto select_type{[this]() -> SelectType {
     switch (peek().type()) {
       case TokenType::DATA:
         advance();
         return SelectTypeDataExpr{peek()};
+      case TokenType::LAST:
+        advance();
+        return SelectTypeLastExpr{peek_back()};
       case TokenType::COUNT:
         advance();
         return SelectTypeCountExpr{peek()};
@@ -234,11 +333,51 @@ SelectType Parser::parse_select_type() {
       case TokenType::MAX:
         advance();
         return SelectTypeMaxExpr{peek()};
+      case TokenType::PERCENTILE: {
+        const auto token{advance()};
+        std::vector<Token> percentiles;
+        do {
+          percentiles.push_back(
+            consume(TokenType::NUMBER, "Expected percentile.")
+          );
+        } while (match(TokenType::COMMA));
+        return SelectTypePercentileExpr{token, percentiles};
+      }
+      case TokenType::APPROX_COUNT_DISTINCT:
+        advance();
+        return SelectTypeApproxCountDistinctExpr{peek_back()};
       default:
         throw error(peek(), "Expected select type.");
     }
   }()};
-  return select_type;
+  if (!check(TokenType::COMMA)) {
+    return select_type;
+  }
+  if (
+    std::holds_alternative<SelectTypeDataExpr>(select_type) ||
+    std::holds_alternative<SelectTypeLastExpr>(select_type) ||
+    std::holds_alternative<SelectTypeApproxCountDistinctExpr>(select_type)
+  ) {
+    throw error(
+      peek(),
+      "Cannot combine " + peek_back().lexeme() + " with aggregates."
+    );
+  }
+  std::vector<Token> functions{peek_back()};
+  while (match(TokenType::COMMA)) {
+    switch (peek().type()) {
+      case TokenType::COUNT:
+      case TokenType::AVG:
+      case TokenType::SUM:
+      case TokenType::MIN:
+      case TokenType::MAX:
+        functions.push_back(advance());
+        break;
+      default:
+        throw error(peek(), "Expected aggregate function.");
+    }
+  }
+  return SelectTypeAggregatesExpr{functions.front(), functions};
 }
 
 SelectClause Parser::parse_select_clause() {
@@ -268,6 +407,10 @@ BetweenClause Parser::parse_between_clause() {
   auto start_timestamp{parse_timestamp()};
   consume(TokenType::AND, "Expected AND.");
   auto end_timestamp{parse_timestamp()};
+  std::optional<EveryClause> every_clause;
+  if (check(TokenType::EVERY)) {
+    every_clause = parse_every_clause();
+  }
   WhereClause where_clause;
   if (check(TokenType::WHERE)) {
     where_clause = parse_where_clause();
@@ -275,7 +418,8 @@ BetweenClause Parser::parse_between_clause() {
   return {
     start_timestamp,
     end_timestamp,
-    where_clause
+    where_clause,
+    every_clause
   };
 }
 
@@ -292,6 +436,32 @@ AtClause Parser::parse_at_clause() {
   };
 }
 
+EveryClause Parser::parse_every_clause() {
+  consume(TokenType::EVERY, "Expected EVERY.");
+  auto width{parse_timestamp()};
+  return {width};
+}
+
+OrderClause Parser::parse_order_clause() {
+  consume(TokenType::ORDER, "Expected ORDER.");
+  consume(TokenType::BY, "Expected BY.");
+  if (!check(TokenType::TIMESTAMP) && !check(TokenType::VALUE)) {
+    throw error(peek(), "Expected TIMESTAMP or VALUE.");
+  }
+  auto key{advance()};
+  std::optional<Token> direction;
+  if (check(TokenType::ASC) || check(TokenType::DESC)) {
+    direction = advance();
+  }
+  return {key, direction};
+}
+
+LimitClause Parser::parse_limit_clause() {
+  consume(TokenType::LIMIT, "Expected LIMIT.");
+  auto count{consume_or_placeholder(TokenType::NUMBER, "Expected limit.")};
+  return {count};
+}
+
 WhereClause Parser::parse_where_clause() {
   consume(TokenType::WHERE, "Expected WHERE.");
   auto tag_list{parse_tag_list()};
@@ -330,7 +500,9 @@ TagKeyExpr Parser::parse_tag_key() {
 }
 
 TagValueExpr Parser::parse_tag_value() {
-  auto tag_value{consume(TokenType::IDENTIFIER, "Expected tag value.")};
+  auto tag_value{
+    consume_or_placeholder(TokenType::IDENTIFIER, "Expected tag value.")
+  };
   return {tag_value};
 }
 
@@ -345,12 +517,14 @@ TableNameExpr Parser::parse_table_name() {
 }
 
 TimestampExpr Parser::parse_timestamp() {
-  auto timestamp{consume(TokenType::NUMBER, "Expected timestamp.")};
+  auto timestamp{
+    consume_or_placeholder(TokenType::NUMBER, "Expected timestamp.")
+  };
   return {timestamp};
 }
 
 ValueExpr Parser::parse_value() {
-  auto value{consume(TokenType::NUMBER, "Expected value.")};
+  auto value{consume_or_placeholder(TokenType::NUMBER, "Expected value.")};
   return {value};
 }
 } // namespace vkdb
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <vkdb/planner.h>
+#include <algorithm>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Plan point lookups for the keys a predicate pins down.
+ * 
+ * @param start Start of the range.
+ * @param end End of the range.
+ * @param predicate Predicate.
+ * @param timestamps Timestamps the predicate allows.
+ * @param tag_columns Tag columns of the table.
+ * @param max_points Maximum number of point lookups.
+ * @return std::optional<PointPlan> Plan, or std::nullopt if the predicate
+ * does not pin the keys down to at most max_points of them.
+ */
+std::optional<PointPlan> plan_points(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::vector<Timestamp>& timestamps,
+  const std::unordered_set<TagKey>& tag_columns,
+  uint64_t max_points
+) {
+  const auto metrics{predicate.metrics()};
+  if (!metrics) {
+    return std::nullopt;
+  }
+  const auto tags{predicate.requiredTags()};
+  if (!tags || tags->size() != tag_columns.size()) {
+    return std::nullopt;
+  }
+  for (const auto& tag_column : tag_columns) {
+    if (!tags->contains(tag_column)) {
+      return std::nullopt;
+    }
+  }
+  if (timestamps.size() * metrics->size() > max_points) {
+    return std::nullopt;
+  }
+
+  PointPlan plan;
+  for (const auto timestamp : timestamps) {
+    for (const auto& metric : *metrics) {
+      TimeSeriesKey key{timestamp, metric, *tags};
+      if (start <= key && key <= end && predicate.matches(key)) {
+        plan.keys.push_back(std::move(key));
+      }
+    }
+  }
+  return plan;
+}
+
+/**
+ * @brief Get the indexed series that may match a predicate.
+ * 
+ * @param predicate Predicate.
+ * @param tags Tags the predicate requires.
+ * @param tag_indexes Tag indexes.
+ * @return std::vector<const Series*> Series, in ascending order of ID.
+ */
+std::vector<const Series*> matching_series(
+  const KeyPredicate& predicate,
+  const TagTable& tags,
+  std::span<const TagIndex* const> tag_indexes
+) {
+  const auto& dictionary{SeriesDictionary::instance()};
+  std::vector<const Series*> series;
+  for (const auto* tag_index : tag_indexes) {
+    for (const auto id : tag_index->seriesWithTags(tags)) {
+      const auto& candidate{dictionary.at(id)};
+      if (predicate.matchesSeries(candidate)) {
+        series.push_back(&candidate);
+      }
+    }
+  }
+  if (tag_indexes.size() > 1) {
+    std::ranges::sort(series, {}, &Series::id);
+  }
+  return series;
+}
+
+/**
+ * @brief Plan point lookups for the keys of known series.
+ * 
+ * @param start Start of the range.
+ * @param end End of the range.
+ * @param predicate Predicate.
+ * @param timestamps Timestamps the predicate allows.
+ * @param series Series that may match the predicate.
+ * @param max_points Maximum number of point lookups.
+ * @return std::optional<PointPlan> Plan, or std::nullopt if there would be
+ * more than max_points lookups.
+ */
+std::optional<PointPlan> plan_series_points(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::vector<Timestamp>& timestamps,
+  const std::vector<const Series*>& series,
+  uint64_t max_points
+) {
+  if (timestamps.size() * series.size() > max_points) {
+    return std::nullopt;
+  }
+
+  PointPlan plan;
+  for (const auto timestamp : timestamps) {
+    for (const auto* candidate : series) {
+      TimeSeriesKey key{timestamp, *candidate};
+      if (start <= key && key <= end && predicate.matches(key)) {
+        plan.keys.push_back(std::move(key));
+      }
+    }
+  }
+  std::ranges::sort(plan.keys);
+  return plan;
+}
+}  // namespace
+
+QueryPlan planQuery(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::unordered_set<TagKey>& tag_columns,
+  uint64_t max_points,
+  const TagIndex* tag_index
+) {
+  return planQuery(
+    start,
+    end,
+    predicate,
+    tag_columns,
+    max_points,
+    tag_index == nullptr
+      ? std::span<const TagIndex* const>{}
+      : std::span<const TagIndex* const>{&tag_index, 1}
+  );
+}
+
+QueryPlan planQuery(
+  const TimeSeriesKey& start,
+  const TimeSeriesKey& end,
+  const KeyPredicate& predicate,
+  const std::unordered_set<TagKey>& tag_columns,
+  uint64_t max_points,
+  std::span<const TagIndex* const> tag_indexes
+) {
+  const auto tags{predicate.requiredTags()};
+  if (end < start || !tags) {
+    return EmptyPlan{};
+  }
+  if (const auto metrics{predicate.metrics()}; metrics && metrics->empty()) {
+    return EmptyPlan{};
+  }
+  std::optional<std::vector<const Series*>> series;
+  if (!tag_indexes.empty() && predicate.constrainsSeries()) {
+    series = matching_series(predicate, *tags, tag_indexes);
+    if (series->empty()) {
+      return EmptyPlan{};
+    }
+  }
+  const auto timestamps{predicate.timestamps()};
+  if (!timestamps) {
+    return RangePlan{start, end};
+  }
+  if (timestamps->empty()) {
+    return EmptyPlan{};
+  }
+
+  auto points{series ? plan_series_points(
+    start,
+    end,
+    predicate,
+    *timestamps,
+    *series,
+    max_points
+  ) : plan_points(
+    start,
+    end,
+    predicate,
+    *timestamps,
+    tag_columns,
+    max_points
+  )};
+  if (points) {
+    if (points->keys.empty()) {
+      return EmptyPlan{};
+    }
+    return std::move(*points);
+  }
+
+  const TimeSeriesKey earliest{timestamps->front(), MIN_METRIC, {}};
+  const TimeSeriesKey latest{timestamps->back(), MAX_METRIC, {}};
+  RangePlan plan{std::max(start, earliest), std::min(end, latest)};
+  if (plan.end < plan.start) {
+    return EmptyPlan{};
+  }
+  return plan;
+}
+}  // namespace vkdb
@@ -15,6 +15,8 @@ void Printer::visit(const Query& query) noexcept {
       visit(query);
     } else if constexpr (std::is_same_v<Q, PutQuery>) {
       visit(query);
+    } else if constexpr (std::is_same_v<Q, PutValuesQuery>) {
+      visit(query);
     } else if constexpr (std::is_same_v<Q, DeleteQuery>) {
       visit(query);
     } else if constexpr (std::is_same_v<Q, CreateQuery>) {
@@ -27,6 +29,8 @@ void Printer::visit(const Query& query) noexcept {
       visit(query);
     } else if constexpr (std::is_same_v<Q, TablesQuery>) {
       visit(query);
+    } else if constexpr (std::is_same_v<Q, StatsQuery>) {
+      visit(query);
     }
   }, query);
   output_ << ";";
@@ -50,6 +54,14 @@ void Printer::visit(const SelectQuery& query) noexcept {
       visit(select_clause);
     }
   }, query.clause);
+  if (query.order_clause) {
+    output_ << " ";
+    visit(query.order_clause.value());
+  }
+  if (query.limit_clause) {
+    output_ << " ";
+    visit(query.limit_clause.value());
+  }
 }
 
 void Printer::visit(const PutQuery& query) noexcept {
@@ -67,11 +79,42 @@ void Printer::visit(const PutQuery& query) noexcept {
   }
 }
 
+void Printer::visit(const PutValuesQuery& query) noexcept {
+  output_ << "PUT ";
+  visit(query.metric);
+  output_ << " INTO ";
+  visit(query.table_name);
+  if (query.tag_list.has_value() && !query.tag_list->tags.empty()) {
+    output_ << " TAGS ";
+    visit(query.tag_list.value());
+  }
+  output_ << " VALUES ";
+  auto first{true};
+  for (const auto& row : query.rows) {
+    if (!first) {
+      output_ << ", ";
+    }
+    output_ << "(";
+    visit(row.timestamp);
+    output_ << ", ";
+    visit(row.value);
+    output_ << ")";
+    first = false;
+  }
+}
+
 void Printer::visit(const DeleteQuery& query) noexcept {
   output_ << "DELETE ";
   visit(query.metric);
   output_ << " ";
-  visit(query.timestamp);
+  if (query.end_timestamp.has_value()) {
+    output_ << "BETWEEN ";
+    visit(query.timestamp);
+    output_ << " AND ";
+    visit(query.end_timestamp.value());
+  } else {
+    visit(query.timestamp);
+  }
   output_ << " FROM ";
   visit(query.table_name);
   if (query.tag_list.has_value()) {
@@ -87,6 +130,9 @@ void Printer::visit(const CreateQuery& query) noexcept {
     output_ << " TAGS ";
     visit(query.tag_columns.value());
   }
+  if (query.value_type.has_value()) {
+    output_ << " TYPE " << query.value_type->token.lexeme();
+  }
 }
 
 void Printer::visit(const DropQuery& query) noexcept {
@@ -112,6 +158,14 @@ void Printer::visit(const TablesQuery& query) noexcept {
   output_ << "TABLES";
 }
 
+void Printer::visit(const StatsQuery& query) noexcept {
+  output_ << "SHOW STATS";
+  if (query.table_name) {
+    output_ << " FROM ";
+    visit(*query.table_name);
+  }
+}
+
 void Printer::visit(const AllClause& clause) noexcept {
   output_ << "ALL";
   if (clause.where_clause) {
@@ -125,6 +179,10 @@ void Printer::visit(const BetweenClause& clause) noexcept {
   visit(clause.start);
   output_ << " AND ";
   visit(clause.end);
+  if (clause.every_clause) {
+    output_ << " ";
+    visit(clause.every_clause.value());
+  }
   if (clause.where_clause) {
     output_ << " ";
     visit(clause.where_clause.value());
@@ -140,6 +198,22 @@ void Printer::visit(const AtClause& clause) noexcept {
   }
 }
 
+void Printer::visit(const EveryClause& clause) noexcept {
+  output_ << "EVERY ";
+  visit(clause.width);
+}
+
+void Printer::visit(const OrderClause& clause) noexcept {
+  output_ << "ORDER BY " << clause.key.lexeme();
+  if (clause.direction) {
+    output_ << " " << clause.direction->lexeme();
+  }
+}
+
+void Printer::visit(const LimitClause& clause) noexcept {
+  output_ << "LIMIT " << clause.count.lexeme();
+}
+
 void Printer::visit(const WhereClause& clause) noexcept {
   output_ << "WHERE ";
   visit(clause.tag_list);
@@ -150,6 +224,8 @@ void Printer::visit(const SelectType& type) noexcept {
     using T = std::decay_t<decltype(type)>;
     if constexpr (std::is_same_v<T, SelectTypeDataExpr>) {
       output_ << "DATA";
+    } else if constexpr (std::is_same_v<T, SelectTypeLastExpr>) {
+      output_ << "LAST";
     } else if constexpr (std::is_same_v<T, SelectTypeCountExpr>) {
       output_ << "COUNT";
     } else if constexpr (std::is_same_v<T, SelectTypeAvgExpr>) {
@@ -160,6 +236,27 @@ void Printer::visit(const SelectType& type) noexcept {
       output_ << "MIN";
     } else if constexpr (std::is_same_v<T, SelectTypeMaxExpr>) {
       output_ << "MAX";
+    } else if constexpr (std::is_same_v<T, SelectTypePercentileExpr>) {
+      output_ << "PERCENTILE ";
+      auto first{true};
+      for (const auto& percentile : type.percentiles) {
+        if (!first) {
+          output_ << ", ";
+        }
+        output_ << percentile.lexeme();
+        first = false;
+      }
+    } else if constexpr (std::is_same_v<T, SelectTypeApproxCountDistinctExpr>) {
+      output_ << "APPROX_COUNT_DISTINCT";
+    } else if constexpr (std::is_same_v<T, SelectTypeAggregatesExpr>) {
+      auto first{true};
+      for (const auto& function : type.functions) {
+        if (!first) {
+          output_ << ", ";
+        }
+        output_ << function.lexeme();
+        first = false;
+      }
     }
   }, type);
 }
@@ -0,0 +1,112 @@
+#include <vkdb/result_writer.h>
+#include <vkdb/binary.h>
+#include <vkdb/string.h>
+#include <charconv>
+#include <cstdint>
+
+namespace vkdb {
+ResultWriter::ResultWriter(std::ostream& stream, OutputFormat format)
+  : stream_{stream}, format_{format} {
+  buffer_.reserve(CHUNK_BYTES);
+}
+
+ResultWriter::~ResultWriter() noexcept {
+  flush();
+}
+
+void ResultWriter::beginDataPoints() {
+  first_ = true;
+  switch (format_) {
+  case OutputFormat::TEXT:
+    buffer_ += '[';
+    break;
+  case OutputFormat::CSV:
+    buffer_ += "timestamp,metric,tags,value\n";
+    break;
+  case OutputFormat::BINARY:
+    buffer_ += RESULT_MAGIC;
+    break;
+  }
+}
+
+void ResultWriter::writeDataPoint(const TimeSeriesKey& key, double value) {
+  switch (format_) {
+  case OutputFormat::TEXT:
+    if (!first_) {
+      buffer_ += ';';
+    }
+    buffer_ += entryToString(TimeSeriesEntry<double>{key, value});
+    break;
+  case OutputFormat::CSV: {
+    buffer_ += std::to_string(key.timestamp());
+    buffer_ += ',';
+    buffer_ += key.metric();
+    buffer_ += ',';
+    auto first_tag{true};
+    for (const auto& [tag_key, tag_value] : key.tags()) {
+      if (!first_tag) {
+        buffer_ += ';';
+      }
+      buffer_ += tag_key;
+      buffer_ += '=';
+      buffer_ += tag_value;
+      first_tag = false;
+    }
+    buffer_ += ',';
+    char digits[32];
+    const auto result{std::to_chars(digits, digits + sizeof(digits), value)};
+    buffer_.append(digits, result.ptr);
+    buffer_ += '\n';
+    break;
+  }
+  case OutputFormat::BINARY:
+    appendBinary(buffer_, uint8_t{1});
+    keyToBinary(buffer_, key);
+    appendBinary(buffer_, value);
+    break;
+  }
+  first_ = false;
+  flush_if_full();
+}
+
+void ResultWriter::writeDataPoint(const DataPoint<double>& datapoint) {
+  writeDataPoint(
+    TimeSeriesKey{datapoint.timestamp, datapoint.metric, datapoint.tags},
+    datapoint.value
+  );
+}
+
+void ResultWriter::endDataPoints() {
+  switch (format_) {
+  case OutputFormat::TEXT:
+    buffer_ += "]\n";
+    break;
+  case OutputFormat::CSV:
+    break;
+  case OutputFormat::BINARY:
+    appendBinary(buffer_, uint8_t{0});
+    break;
+  }
+  flush_if_full();
+}
+
+void ResultWriter::writeLine(std::string_view line) {
+  buffer_ += line;
+  buffer_ += '\n';
+  flush_if_full();
+}
+
+void ResultWriter::flush() {
+  if (buffer_.empty()) {
+    return;
+  }
+  stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  buffer_.clear();
+}
+
+void ResultWriter::flush_if_full() {
+  if (buffer_.size() >= CHUNK_BYTES) {
+    flush();
+  }
+}
+}  // namespace vkdb
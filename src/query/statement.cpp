@@ -0,0 +1,18 @@
+#include <vkdb/statement.h>
+
+namespace vkdb {
+PreparedStatement::PreparedStatement(
+  Expr expr,
+  size_type parameter_count
+) noexcept
+  : expr_{std::move(expr)}, parameter_count_{parameter_count} {}
+
+const Expr& PreparedStatement::expr() const noexcept {
+  return expr_;
+}
+
+PreparedStatement::size_type
+PreparedStatement::parameterCount() const noexcept {
+  return parameter_count_;
+}
+}  // namespace vkdb
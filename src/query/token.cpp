@@ -3,27 +3,40 @@
 namespace vkdb {
 Token::Token(
   TokenType type,
-  const Lexeme& lexeme,
+  Lexeme lexeme,
   Token::size_type line,
   Token::size_type column
 ) noexcept
   : type_{type}
-  , lexeme_{lexeme}
+  , lexeme_{std::move(lexeme)}
   , line_{line}
   , column_{column} {}
 
+Token::Token(
+  Lexeme lexeme,
+  Token::size_type line,
+  Token::size_type column,
+  Token::size_type parameter
+) noexcept
+  : type_{TokenType::PLACEHOLDER}
+  , lexeme_{std::move(lexeme)}
+  , line_{line}
+  , column_{column}
+  , parameter_{parameter} {}
+
 bool Token::operator==(const Token& other) const noexcept {
   return type_ == other.type() &&
     lexeme_ == other.lexeme() &&
     line_ == other.line() &&
-    column_ == other.column();
+    column_ == other.column() &&
+    parameter_ == other.parameter();
 }
 
 TokenType Token::type() const noexcept {
   return type_;
 }
 
-Lexeme Token::lexeme() const noexcept {
+const Lexeme& Token::lexeme() const noexcept {
   return lexeme_;
 }
 
@@ -35,6 +48,10 @@ Token::size_type Token::column() const noexcept {
   return column_;
 }
 
+std::optional<Token::size_type> Token::parameter() const noexcept {
+  return parameter_;
+}
+
 std::string Token::str() const noexcept {
   auto type_str{TOKEN_TYPE_TO_STRING.at(type_)};
   return type_str + " "
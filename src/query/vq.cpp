@@ -45,7 +45,7 @@ void VQ::run(const std::string& source) noexcept {
   Lexer lexer{source};
   auto tokens{lexer.tokenize()};
 
-  Parser parser{tokens, error};
+  Parser parser{std::move(tokens), error};
   auto expr{parser.parse()};
 
   if (had_error_) {
@@ -0,0 +1,142 @@
+#include <vkdb/client.h>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace vkdb {
+Client::Client(const std::string& host, uint16_t port) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+    throw std::system_error{
+      EINVAL, std::generic_category(),
+      "Client::Client(): Invalid host '" + host + "'."
+    };
+  }
+  fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd_ == -1) {
+    throw std::system_error{
+      errno, std::generic_category(),
+      "Client::Client(): Unable to create socket."
+    };
+  }
+  if (connect(
+    fd_,
+    reinterpret_cast<const sockaddr*>(&address),
+    sizeof(address)
+  ) == -1) {
+    const auto error{errno};
+    ::close(fd_);
+    throw std::system_error{
+      error, std::generic_category(),
+      "Client::Client(): Unable to connect to " + host + ":"
+      + std::to_string(port) + "."
+    };
+  }
+  const int enable{1};
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+Client::~Client() noexcept {
+  ::close(fd_);
+}
+
+uint32_t Client::send(MessageType type, std::string_view payload) {
+  const auto request_id{next_request_id_++};
+  std::string frame;
+  appendFrame(frame, static_cast<uint8_t>(type), request_id, payload);
+  uint64_t written{0};
+  while (written < frame.size()) {
+    const auto count{::send(
+      fd_,
+      frame.data() + written,
+      frame.size() - written,
+      MSG_NOSIGNAL
+    )};
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error{
+        errno, std::generic_category(), "Client::send(): Unable to send."
+      };
+    }
+    written += count;
+  }
+  return request_id;
+}
+
+Frame Client::receive() {
+  Frame response;
+  while (true) {
+    const auto consumed{readFrame(
+      input_,
+      response,
+      std::numeric_limits<uint32_t>::max()
+    )};
+    if (consumed != 0) {
+      input_.erase(0, consumed);
+      return response;
+    }
+    std::array<char, 64 * 1024> chunk;
+    const auto count{recv(fd_, chunk.data(), chunk.size(), 0)};
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error{
+        errno, std::generic_category(), "Client::receive(): Unable to receive."
+      };
+    }
+    if (count == 0) {
+      throw std::runtime_error{"Client::receive(): Connection closed."};
+    }
+    input_.append(chunk.data(), count);
+  }
+}
+
+std::string Client::query(std::string_view source, OutputFormat format) {
+  send(MessageType::QUERY, queryPayload(source, format));
+  return expect_ok();
+}
+
+void Client::putBatch(const PutBatchRequest& request) {
+  std::string payload;
+  putBatchToBinary(payload, request);
+  send(MessageType::PUT_BATCH, payload);
+  expect_ok();
+}
+
+ReplicateResponse Client::replicate(const ReplicateRequest& request) {
+  std::string payload;
+  replicateRequestToBinary(payload, request);
+  send(MessageType::REPLICATE, payload);
+  return replicateResponseFromBinary(expect_ok());
+}
+
+void Client::ping() {
+  send(MessageType::PING, {});
+  expect_ok();
+}
+
+std::string Client::stats() {
+  send(MessageType::STATS, {});
+  return expect_ok();
+}
+
+std::string Client::expect_ok() {
+  auto response{receive()};
+  if (response.type != static_cast<uint8_t>(ResponseStatus::OK)) {
+    throw std::runtime_error{"Client::expect_ok(): " + response.payload};
+  }
+  return std::move(response.payload);
+}
+}  // namespace vkdb
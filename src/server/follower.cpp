@@ -0,0 +1,180 @@
+#include <vkdb/follower.h>
+#include <vkdb/io_backend.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkdb {
+Follower::Follower(Database& database, FollowerOptions options)
+  : database_{database}, options_{std::move(options)} {
+  if (options_.tables.empty()) {
+    throw std::invalid_argument{
+      "Follower::Follower(): Expected at least one table to follow."
+    };
+  }
+}
+
+Follower::~Follower() noexcept {
+  stop();
+}
+
+Follower::size_type Follower::poll() {
+  std::lock_guard lock{mutex_};
+  return poll_tables();
+}
+
+void Follower::start() {
+  std::lock_guard lock{mutex_};
+  if (thread_.joinable()) {
+    throw std::runtime_error{"Follower::start(): Already started."};
+  }
+  stopping_ = false;
+  thread_ = std::thread{[this] { run(); }};
+}
+
+void Follower::stop() noexcept {
+  {
+    std::lock_guard lock{mutex_};
+    if (!thread_.joinable()) {
+      return;
+    }
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  thread_.join();
+}
+
+std::exception_ptr Follower::lastError() const noexcept {
+  std::lock_guard lock{mutex_};
+  return last_error_;
+}
+
+Follower::size_type Follower::poll_tables() {
+  try {
+    if (!client_) {
+      client_ = std::make_unique<Client>(options_.host, options_.port);
+    }
+    size_type applied{0};
+    for (const auto& table_name : options_.tables) {
+      applied += poll_table(*client_, table_name);
+    }
+    return applied;
+  } catch (...) {
+    client_.reset();
+    throw;
+  }
+}
+
+Follower::size_type Follower::poll_table(
+  Client& client,
+  const TableName& table_name
+) {
+  auto lsns_it{lsns_.find(table_name)};
+  if (lsns_it == lsns_.end()) {
+    std::vector<uint64_t> lsns;
+    const auto tables{database_.tables()};
+    if (std::ranges::find(tables, table_name) != tables.end()) {
+      lsns = load_lsns(database_.getTable(table_name));
+    }
+    lsns_it = lsns_.emplace(table_name, std::move(lsns)).first;
+  }
+  auto& lsns{lsns_it->second};
+
+  size_type applied{0};
+  Table* table{nullptr};
+  for (size_type shard{0}; shard == 0 || shard < lsns.size(); ++shard) {
+    while (true) {
+      auto response{client.replicate({
+        options_.name,
+        table_name,
+        shard,
+        shard < lsns.size() ? lsns[shard] : 0
+      })};
+      if (table == nullptr) {
+        table = &local_table(table_name, response);
+        lsns.resize(response.shards, 0);
+      }
+      if (response.chunk.records.empty()) {
+        break;
+      }
+      applied += table->applyWAL(shard, response.chunk.records);
+      lsns[shard] = response.chunk.next_lsn;
+      save_lsns(*table, lsns);
+    }
+  }
+  return applied;
+}
+
+Table& Follower::local_table(
+  const TableName& table_name,
+  const ReplicateResponse& response
+) {
+  const auto tables{database_.tables()};
+  if (std::ranges::find(tables, table_name) == tables.end()) {
+    TableOptions options;
+    options.shards = response.shards;
+    auto& table{
+      database_.createTable(table_name, options, response.value_type)
+    };
+    for (const auto& tag_column : response.tag_columns) {
+      table.addTagColumn(tag_column);
+    }
+    return table;
+  }
+  auto& table{database_.getTable(table_name)};
+  if (table.shardCount() != response.shards) {
+    throw std::runtime_error{
+      "Follower::local_table(): Table '" + table_name + "' has "
+      + std::to_string(table.shardCount()) + " shards, but the leader's has "
+      + std::to_string(response.shards) + "."
+    };
+  }
+  if (table.valueType() != response.value_type) {
+    throw std::runtime_error{
+      "Follower::local_table(): Table '" + table_name + "' holds "
+      + valueTypeToString(table.valueType()) + " values, but the leader's "
+      + "holds " + valueTypeToString(response.value_type) + " values."
+    };
+  }
+  return table;
+}
+
+std::vector<uint64_t> Follower::load_lsns(const Table& table) {
+  std::vector<uint64_t> lsns;
+  std::ifstream file{table.path() / FOLLOWER_LSN_FILENAME};
+  uint64_t lsn;
+  while (file >> lsn) {
+    lsns.push_back(lsn);
+  }
+  return lsns;
+}
+
+void Follower::save_lsns(const Table& table, const std::vector<uint64_t>& lsns) {
+  std::ostringstream stream;
+  for (const auto lsn : lsns) {
+    stream << lsn << "\n";
+  }
+  writeFile(
+    table.options().wal.io_backend,
+    table.path() / FOLLOWER_LSN_FILENAME,
+    std::move(stream).str(),
+    true
+  );
+}
+
+void Follower::run() noexcept {
+  std::unique_lock lock{mutex_};
+  while (!stopping_) {
+    try {
+      poll_tables();
+      last_error_ = nullptr;
+    } catch (...) {
+      last_error_ = std::current_exception();
+    }
+    stop_cv_.wait_for(lock, options_.poll_interval, [this] {
+      return stopping_;
+    });
+  }
+}
+}  // namespace vkdb
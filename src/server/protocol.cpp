@@ -0,0 +1,184 @@
+#include <vkdb/protocol.h>
+#include <vkdb/binary.h>
+#include <limits>
+#include <stdexcept>
+
+namespace vkdb {
+void appendFrame(
+  std::string& buffer,
+  uint8_t type,
+  uint32_t request_id,
+  std::string_view payload
+) {
+  if (payload.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error{
+      "appendFrame(): Payload of length " + std::to_string(payload.size())
+      + " is too long to encode."
+    };
+  }
+  appendBinary(buffer, static_cast<uint32_t>(payload.size()));
+  appendBinary(buffer, type);
+  appendBinary(buffer, request_id);
+  buffer.append(payload);
+}
+
+uint64_t readFrame(
+  std::string_view buffer,
+  Frame& frame,
+  uint64_t max_payload_bytes
+) {
+  if (buffer.size() < FRAME_HEADER_BYTES) {
+    return 0;
+  }
+  auto pos{buffer.data()};
+  const auto end{buffer.data() + buffer.size()};
+  const auto length{readBinary<uint32_t>(pos, end)};
+  if (length > max_payload_bytes) {
+    throw std::runtime_error{
+      "readFrame(): Payload of length " + std::to_string(length)
+      + " is larger than " + std::to_string(max_payload_bytes) + " bytes."
+    };
+  }
+  if (buffer.size() < FRAME_HEADER_BYTES + length) {
+    return 0;
+  }
+  frame.type = readBinary<uint8_t>(pos, end);
+  frame.request_id = readBinary<uint32_t>(pos, end);
+  frame.payload.assign(pos, length);
+  return FRAME_HEADER_BYTES + length;
+}
+
+void putBatchToBinary(std::string& buffer, const PutBatchRequest& request) {
+  appendBinary(buffer, std::string_view{request.table_name});
+  appendVarint(buffer, request.series.size());
+  for (const auto& series : request.series) {
+    appendBinary(buffer, std::string_view{series.metric});
+    appendVarint(buffer, series.tags.size());
+    for (const auto& [tag_key, tag_value] : series.tags) {
+      appendBinary(buffer, std::string_view{tag_key});
+      appendBinary(buffer, std::string_view{tag_value});
+    }
+    appendVarint(buffer, series.rows.size());
+    Timestamp previous{0};
+    for (const auto& [timestamp, value] : series.rows) {
+      const auto delta{static_cast<int64_t>(timestamp - previous)};
+      appendVarint(
+        buffer,
+        (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63)
+      );
+      appendBinary(buffer, value);
+      previous = timestamp;
+    }
+  }
+}
+
+PutBatchRequest putBatchFromBinary(std::string_view payload) {
+  auto pos{payload.data()};
+  const auto end{payload.data() + payload.size()};
+  PutBatchRequest request;
+  request.table_name = TableName{readBinaryString(pos, end)};
+  const auto no_of_series{readVarint(pos, end)};
+  for (uint64_t i{0}; i < no_of_series; ++i) {
+    auto& series{request.series.emplace_back()};
+    series.metric = Metric{readBinaryString(pos, end)};
+    const auto no_of_tags{readVarint(pos, end)};
+    for (uint64_t j{0}; j < no_of_tags; ++j) {
+      TagKey tag_key{readBinaryString(pos, end)};
+      TagValue tag_value{readBinaryString(pos, end)};
+      series.tags.emplace(std::move(tag_key), std::move(tag_value));
+    }
+    const auto no_of_rows{readVarint(pos, end)};
+    if (no_of_rows > static_cast<uint64_t>(end - pos)) {
+      throw std::runtime_error{
+        "putBatchFromBinary(): Row count exceeds the payload."
+      };
+    }
+    series.rows.reserve(no_of_rows);
+    Timestamp previous{0};
+    for (uint64_t j{0}; j < no_of_rows; ++j) {
+      const auto zigzag{readVarint(pos, end)};
+      const auto delta{
+        static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1)
+      };
+      const auto timestamp{previous + static_cast<Timestamp>(delta)};
+      series.rows.emplace_back(timestamp, readBinary<double>(pos, end));
+      previous = timestamp;
+    }
+  }
+  if (pos != end) {
+    throw std::runtime_error{
+      "putBatchFromBinary(): Unexpected bytes after the batch."
+    };
+  }
+  return request;
+}
+
+void replicateRequestToBinary(
+  std::string& buffer,
+  const ReplicateRequest& request
+) {
+  appendBinary(buffer, std::string_view{request.follower});
+  appendBinary(buffer, std::string_view{request.table_name});
+  appendVarint(buffer, request.shard);
+  appendVarint(buffer, request.lsn);
+}
+
+ReplicateRequest replicateRequestFromBinary(std::string_view payload) {
+  auto pos{payload.data()};
+  const auto end{payload.data() + payload.size()};
+  ReplicateRequest request;
+  request.follower = std::string{readBinaryString(pos, end)};
+  request.table_name = TableName{readBinaryString(pos, end)};
+  request.shard = readVarint(pos, end);
+  request.lsn = readVarint(pos, end);
+  if (pos != end) {
+    throw std::runtime_error{
+      "replicateRequestFromBinary(): Unexpected bytes after the request."
+    };
+  }
+  return request;
+}
+
+void replicateResponseToBinary(
+  std::string& buffer,
+  const ReplicateResponse& response
+) {
+  appendVarint(buffer, response.shards);
+  appendVarint(buffer, response.tag_columns.size());
+  for (const auto& tag_column : response.tag_columns) {
+    appendBinary(buffer, std::string_view{tag_column});
+  }
+  appendBinary(buffer, static_cast<uint8_t>(response.value_type));
+  appendVarint(buffer, response.chunk.next_lsn);
+  buffer.append(response.chunk.records);
+}
+
+ReplicateResponse replicateResponseFromBinary(std::string_view payload) {
+  auto pos{payload.data()};
+  const auto end{payload.data() + payload.size()};
+  ReplicateResponse response;
+  response.shards = readVarint(pos, end);
+  const auto no_of_tag_columns{readVarint(pos, end)};
+  for (uint64_t i{0}; i < no_of_tag_columns; ++i) {
+    response.tag_columns.emplace_back(readBinaryString(pos, end));
+  }
+  const auto value_type{readBinary<uint8_t>(pos, end)};
+  if (value_type > static_cast<uint8_t>(ValueType::BOOL)) {
+    throw std::runtime_error{
+      "replicateResponseFromBinary(): Unknown value type."
+    };
+  }
+  response.value_type = static_cast<ValueType>(value_type);
+  response.chunk.next_lsn = readVarint(pos, end);
+  response.chunk.records.assign(pos, end);
+  return response;
+}
+
+std::string queryPayload(std::string_view source, OutputFormat format) {
+  std::string payload;
+  payload.reserve(sizeof(uint8_t) + source.size());
+  appendBinary(payload, static_cast<uint8_t>(format));
+  payload.append(source);
+  return payload;
+}
+}  // namespace vkdb
@@ -0,0 +1,606 @@
+#include <vkdb/server.h>
+#include <vkdb/interpreter.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <ranges>
+#include <sstream>
+#include <system_error>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace vkdb {
+struct Server::Connection {
+  /**
+   * @brief File descriptor of the socket.
+   * 
+   */
+  int fd{-1};
+
+  /**
+   * @brief Bytes read but not yet framed, only touched by the loop.
+   * 
+   */
+  std::string input;
+
+  /**
+   * @brief Whether the socket is polled for writing, only touched by the
+   * loop.
+   * 
+   */
+  bool writing{false};
+
+  /**
+   * @brief Mutex for the members below.
+   * 
+   */
+  std::mutex mutex;
+
+  /**
+   * @brief Requests not yet handled.
+   * 
+   */
+  std::deque<Frame> requests;
+
+  /**
+   * @brief Responses not yet written.
+   * 
+   */
+  std::string output;
+
+  /**
+   * @brief Whether a worker is handling the requests.
+   * 
+   */
+  bool busy{false};
+
+  /**
+   * @brief Whether the connection is closed.
+   * 
+   */
+  bool closed{false};
+};
+
+namespace {
+/**
+ * @brief Number of bytes read from a socket at a time.
+ * 
+ */
+constexpr uint64_t READ_CHUNK_BYTES{64 * 1024};
+
+/**
+ * @brief Check if a query creates, drops, or changes the tags of a table.
+ * 
+ * @param query Query.
+ * @return true if the query changes tables.
+ * @return false otherwise.
+ */
+bool changesTables(const Query& query) noexcept {
+  return std::holds_alternative<CreateQuery>(query)
+    || std::holds_alternative<DropQuery>(query)
+    || std::holds_alternative<AddQuery>(query)
+    || std::holds_alternative<RemoveQuery>(query);
+}
+}  // namespace
+
+Server::Server(Database& database, ServerOptions options)
+  : database_{database}, options_{std::move(options)} {
+  if (options_.worker_threads == 0) {
+    throw std::invalid_argument{
+      "Server::Server(): Number of worker threads must be positive."
+    };
+  }
+}
+
+Server::~Server() noexcept {
+  stop();
+}
+
+void Server::start() {
+  if (loop_.joinable()) {
+    throw std::runtime_error{"Server::start(): Server is already started."};
+  }
+
+  const auto fail{[this](const std::string& what) {
+    const auto error{errno};
+    for (auto fd : {listen_fd_, epoll_fd_, wake_fd_}) {
+      if (fd != -1) {
+        ::close(fd);
+      }
+    }
+    listen_fd_ = epoll_fd_ = wake_fd_ = -1;
+    throw std::system_error{
+      error, std::generic_category(), "Server::start(): " + what
+    };
+  }};
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(options_.port);
+  if (inet_pton(AF_INET, options_.host.c_str(), &address.sin_addr) != 1) {
+    errno = EINVAL;
+    fail("Invalid host '" + options_.host + "'.");
+  }
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd_ == -1) {
+    fail("Unable to create socket.");
+  }
+  const int enable{1};
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  if (bind(
+    listen_fd_,
+    reinterpret_cast<const sockaddr*>(&address),
+    sizeof(address)
+  ) == -1) {
+    fail(
+      "Unable to bind to " + options_.host + ":"
+      + std::to_string(options_.port) + "."
+    );
+  }
+  if (listen(listen_fd_, SOMAXCONN) == -1) {
+    fail("Unable to listen.");
+  }
+  socklen_t length{sizeof(address)};
+  if (getsockname(
+    listen_fd_,
+    reinterpret_cast<sockaddr*>(&address),
+    &length
+  ) == -1) {
+    fail("Unable to get the port.");
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) {
+    fail("Unable to create epoll instance.");
+  }
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ == -1) {
+    fail("Unable to create eventfd.");
+  }
+  for (auto fd : {listen_fd_, wake_fd_}) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+      fail("Unable to poll socket.");
+    }
+  }
+
+  port_ = ntohs(address.sin_port);
+  stopping_ = false;
+  workers_ = std::make_unique<ThreadPool>(options_.worker_threads);
+  loop_ = std::thread{[this] { run_loop(); }};
+}
+
+void Server::stop() noexcept {
+  if (!loop_.joinable()) {
+    return;
+  }
+  stopping_ = true;
+  const uint64_t one{1};
+  static_cast<void>(::write(wake_fd_, &one, sizeof(one)));
+  loop_.join();
+  workers_.reset();
+
+  for (auto fd : {listen_fd_, epoll_fd_, wake_fd_}) {
+    ::close(fd);
+  }
+  listen_fd_ = epoll_fd_ = wake_fd_ = -1;
+  ready_.clear();
+  port_ = 0;
+}
+
+uint16_t Server::port() const noexcept {
+  return port_;
+}
+
+void Server::run_loop() noexcept {
+  std::array<epoll_event, 256> events;
+  while (!stopping_) {
+    const auto count{epoll_wait(
+      epoll_fd_,
+      events.data(),
+      static_cast<int>(events.size()),
+      -1
+    )};
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    for (int i{0}; i < count; ++i) {
+      const auto fd{events[i].data.fd};
+      if (fd == listen_fd_) {
+        accept_connections();
+        continue;
+      }
+
+      if (fd == wake_fd_) {
+        uint64_t wakes;
+        static_cast<void>(::read(wake_fd_, &wakes, sizeof(wakes)));
+        std::vector<std::weak_ptr<Connection>> ready;
+        {
+          std::lock_guard lock{ready_mutex_};
+          ready.swap(ready_);
+        }
+        for (const auto& weak_connection : ready) {
+          auto connection{weak_connection.lock()};
+          if (connection && connections_.contains(connection->fd)
+            && connections_.at(connection->fd) == connection) {
+            write_to(connection);
+          }
+        }
+        continue;
+      }
+
+      const auto it{connections_.find(fd)};
+      if (it == connections_.end()) {
+        continue;
+      }
+      const auto connection{it->second};
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        if (!read_from(connection)) {
+          continue;
+        }
+      }
+      if (events[i].events & EPOLLOUT) {
+        write_to(connection);
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<Connection>> open;
+  for (const auto& [fd, connection] : connections_) {
+    open.push_back(connection);
+  }
+  for (const auto& connection : open) {
+    close(connection);
+  }
+}
+
+void Server::accept_connections() noexcept {
+  while (true) {
+    const auto fd{accept4(
+      listen_fd_,
+      nullptr,
+      nullptr,
+      SOCK_NONBLOCK | SOCK_CLOEXEC
+    )};
+    if (fd == -1) {
+      return;
+    }
+    const int enable{1};
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+      ::close(fd);
+      continue;
+    }
+    auto connection{std::make_shared<Connection>()};
+    connection->fd = fd;
+    connections_.emplace(fd, std::move(connection));
+  }
+}
+
+bool Server::read_from(const std::shared_ptr<Connection>& connection) noexcept {
+  try {
+    std::array<char, READ_CHUNK_BYTES> chunk;
+    while (true) {
+      const auto count{recv(connection->fd, chunk.data(), chunk.size(), 0)};
+      if (count == 0) {
+        close(connection);
+        return false;
+      }
+      if (count == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          break;
+        }
+        if (errno == EINTR) {
+          continue;
+        }
+        close(connection);
+        return false;
+      }
+      connection->input.append(chunk.data(), count);
+    }
+
+    std::deque<Frame> requests;
+    std::string_view input{connection->input};
+    size_type offset{0};
+    while (true) {
+      Frame request;
+      const auto consumed{readFrame(
+        input.substr(offset),
+        request,
+        options_.max_frame_bytes
+      )};
+      if (consumed == 0) {
+        break;
+      }
+      offset += consumed;
+      requests.push_back(std::move(request));
+    }
+    connection->input.erase(0, offset);
+
+    if (requests.empty()) {
+      return true;
+    }
+    auto idle{false};
+    {
+      std::lock_guard lock{connection->mutex};
+      std::ranges::move(requests, std::back_inserter(connection->requests));
+      idle = !connection->busy;
+      connection->busy = true;
+    }
+    if (idle) {
+      static_cast<void>(workers_->submit([this, connection] {
+        drain(connection);
+      }));
+    }
+    return true;
+  } catch (const std::exception&) {
+    close(connection);
+    return false;
+  }
+}
+
+void Server::write_to(const std::shared_ptr<Connection>& connection) noexcept {
+  auto broken{false};
+  auto wants_output{false};
+  {
+    std::lock_guard lock{connection->mutex};
+    auto& output{connection->output};
+    size_type written{0};
+    while (written < output.size()) {
+      const auto count{send(
+        connection->fd,
+        output.data() + written,
+        output.size() - written,
+        MSG_NOSIGNAL
+      )};
+      if (count == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        broken = errno != EAGAIN && errno != EWOULDBLOCK;
+        break;
+      }
+      written += count;
+    }
+    output.erase(0, written);
+    wants_output = !output.empty();
+  }
+
+  if (broken) {
+    close(connection);
+    return;
+  }
+  if (wants_output != connection->writing) {
+    epoll_event event{};
+    event.events = static_cast<uint32_t>(EPOLLIN)
+      | (wants_output ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = connection->fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection->fd, &event);
+    connection->writing = wants_output;
+  }
+}
+
+void Server::close(const std::shared_ptr<Connection>& connection) noexcept {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->fd, nullptr);
+  ::close(connection->fd);
+  connections_.erase(connection->fd);
+  std::lock_guard lock{connection->mutex};
+  connection->closed = true;
+  connection->requests.clear();
+  connection->output.clear();
+}
+
+void Server::drain(std::shared_ptr<Connection> connection) noexcept {
+  while (true) {
+    std::deque<Frame> requests;
+    {
+      std::lock_guard lock{connection->mutex};
+      if (connection->closed || connection->requests.empty()) {
+        connection->busy = false;
+        return;
+      }
+      requests.swap(connection->requests);
+    }
+
+    std::string responses;
+    for (const auto& request : requests) {
+      handle(request, responses);
+    }
+    {
+      std::lock_guard lock{connection->mutex};
+      if (connection->closed) {
+        connection->busy = false;
+        return;
+      }
+      connection->output += responses;
+    }
+    notify(connection);
+  }
+}
+
+void Server::handle(const Frame& request, std::string& response) noexcept {
+  std::string output;
+  auto status{ResponseStatus::OK};
+  try {
+    switch (static_cast<MessageType>(request.type)) {
+    case MessageType::PING:
+      break;
+    case MessageType::QUERY:
+      status = handle_query(request.payload, output);
+      break;
+    case MessageType::PUT_BATCH:
+      status = handle_put_batch(request.payload, output);
+      break;
+    case MessageType::REPLICATE:
+      status = handle_replicate(request.payload, output);
+      break;
+    case MessageType::STATS:
+      output = prometheusText(database_.stats());
+      break;
+    default:
+      status = ResponseStatus::PROTOCOL_ERROR;
+      output = "Unknown message type "
+        + std::to_string(request.type) + ".";
+      break;
+    }
+    appendFrame(
+      response,
+      static_cast<uint8_t>(status),
+      request.request_id,
+      output
+    );
+  } catch (const std::exception& e) {
+    appendFrame(
+      response,
+      static_cast<uint8_t>(ResponseStatus::RUNTIME_ERROR),
+      request.request_id,
+      e.what()
+    );
+  }
+}
+
+ResponseStatus Server::handle_query(
+  std::string_view payload,
+  std::string& output
+) {
+  if (payload.empty()
+    || static_cast<uint8_t>(payload.front())
+      > static_cast<uint8_t>(OutputFormat::BINARY)) {
+    output = "Expected an output format.";
+    return ResponseStatus::PROTOCOL_ERROR;
+  }
+  const auto format{static_cast<OutputFormat>(payload.front())};
+
+  std::shared_ptr<const PreparedStatement> statement;
+  try {
+    statement = database_.prepare(std::string{payload.substr(1)});
+  } catch (const std::exception& e) {
+    output = e.what();
+    return ResponseStatus::PARSE_ERROR;
+  }
+
+  std::string failure;
+  Interpreter interpreter{database_, [&failure](const RuntimeError& error) {
+    failure = "[line " + std::to_string(error.token().line()) + "] "
+      + error.message();
+  }, {}, format};
+  std::ostringstream stream;
+  if (std::ranges::any_of(statement->expr(), changesTables)) {
+    std::unique_lock lock{schema_mutex_};
+    interpreter.interpret(statement->expr(), stream);
+  } else {
+    std::shared_lock lock{schema_mutex_};
+    interpreter.interpret(statement->expr(), stream);
+  }
+
+  if (!failure.empty()) {
+    output = std::move(failure);
+    return ResponseStatus::RUNTIME_ERROR;
+  }
+  output = std::move(stream).str();
+  return ResponseStatus::OK;
+}
+
+ResponseStatus Server::handle_put_batch(
+  std::string_view payload,
+  std::string& output
+) {
+  PutBatchRequest request;
+  try {
+    request = putBatchFromBinary(payload);
+  } catch (const std::exception& e) {
+    output = e.what();
+    return ResponseStatus::PROTOCOL_ERROR;
+  }
+
+  try {
+    std::shared_lock lock{schema_mutex_};
+    auto& table{database_.getTable(request.table_name)};
+    for (const auto& series : request.series) {
+      table.putBatch(series.metric, series.tags, series.rows);
+    }
+  } catch (const std::exception& e) {
+    output = e.what();
+    return ResponseStatus::RUNTIME_ERROR;
+  }
+  return ResponseStatus::OK;
+}
+
+ResponseStatus Server::handle_replicate(
+  std::string_view payload,
+  std::string& output
+) {
+  ReplicateRequest request;
+  try {
+    request = replicateRequestFromBinary(payload);
+  } catch (const std::exception& e) {
+    output = e.what();
+    return ResponseStatus::PROTOCOL_ERROR;
+  }
+
+  try {
+    std::shared_lock lock{schema_mutex_};
+    auto& table{database_.getTable(request.table_name)};
+    ReplicateResponse response;
+    response.shards = table.shardCount();
+    const auto tag_columns{table.tagColumns()};
+    response.tag_columns.assign(tag_columns.begin(), tag_columns.end());
+    response.value_type = table.valueType();
+    response.chunk = table.readWAL(
+      request.shard,
+      request.lsn,
+      REPLICATE_CHUNK_BYTES
+    );
+    const auto acknowledged{acknowledge(
+      request.table_name,
+      request.shard,
+      request.follower,
+      request.lsn
+    )};
+    table.acknowledgeWAL(request.shard, acknowledged);
+    replicateResponseToBinary(output, response);
+  } catch (const std::exception& e) {
+    output = e.what();
+    return ResponseStatus::RUNTIME_ERROR;
+  }
+  return ResponseStatus::OK;
+}
+
+uint64_t Server::acknowledge(
+  const TableName& table_name,
+  uint64_t shard,
+  const std::string& follower,
+  uint64_t lsn
+) {
+  std::lock_guard lock{replication_mutex_};
+  auto& followers{acknowledged_[{table_name, shard}]};
+  followers[follower] = lsn;
+  return std::ranges::min(followers | std::views::values);
+}
+
+void Server::notify(const std::shared_ptr<Connection>& connection) noexcept {
+  {
+    std::lock_guard lock{ready_mutex_};
+    ready_.push_back(connection);
+  }
+  const uint64_t one{1};
+  static_cast<void>(::write(wake_fd_, &one, sizeof(one)));
+}
+}  // namespace vkdb
@@ -0,0 +1,115 @@
+#include <vkdb/block_cache.h>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+namespace vkdb {
+BlockCache::BlockCache(size_type capacity, size_type shard_count)
+  : capacity_{capacity} {
+  if (capacity == 0) {
+    throw std::invalid_argument{
+      "BlockCache(): Capacity must be greater than 0."
+    };
+  }
+  if (shard_count == 0) {
+    throw std::invalid_argument{
+      "BlockCache(): Number of shards must be greater than 0."
+    };
+  }
+  shard_capacity_ = (capacity + shard_count - 1) / shard_count;
+  shards_.reserve(shard_count);
+  for (size_type i{0}; i < shard_count; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+BlockCache::owner_type BlockCache::newOwner() noexcept {
+  static std::atomic<owner_type> next_owner{0};
+  return next_owner.fetch_add(1, std::memory_order_relaxed);
+}
+
+BlockCache::Block BlockCache::tryGet(
+  owner_type owner,
+  size_type offset
+) const {
+  const Key key{owner, offset};
+  auto& shard{shard_for(key)};
+  std::lock_guard lock{shard.mutex};
+  const auto it{shard.positions.find(key)};
+  if (it == shard.positions.end()) {
+    return nullptr;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  return it->second->block;
+}
+
+void BlockCache::put(
+  owner_type owner,
+  size_type offset,
+  Block block,
+  size_type charge
+) {
+  if (charge > shard_capacity_) {
+    return;
+  }
+  const Key key{owner, offset};
+  auto& shard{shard_for(key)};
+  std::lock_guard lock{shard.mutex};
+  const auto it{shard.positions.find(key)};
+  if (it != shard.positions.end()) {
+    shard.usage -= it->second->charge;
+    shard.entries.erase(it->second);
+    shard.positions.erase(it);
+  }
+  while (shard.usage + charge > shard_capacity_) {
+    const auto& victim{shard.entries.back()};
+    shard.usage -= victim.charge;
+    shard.positions.erase(victim.key);
+    shard.entries.pop_back();
+  }
+  shard.entries.push_front({key, std::move(block), charge});
+  shard.positions.emplace(key, shard.entries.begin());
+  shard.usage += charge;
+}
+
+BlockCache::size_type BlockCache::capacity() const noexcept {
+  return capacity_;
+}
+
+BlockCache::size_type BlockCache::usage() const noexcept {
+  size_type usage{0};
+  for (const auto& shard : shards_) {
+    std::lock_guard lock{shard->mutex};
+    usage += shard->usage;
+  }
+  return usage;
+}
+
+BlockCache::size_type BlockCache::size() const noexcept {
+  size_type size{0};
+  for (const auto& shard : shards_) {
+    std::lock_guard lock{shard->mutex};
+    size += shard->entries.size();
+  }
+  return size;
+}
+
+void BlockCache::clear() noexcept {
+  for (auto& shard : shards_) {
+    std::lock_guard lock{shard->mutex};
+    shard->positions.clear();
+    shard->entries.clear();
+    shard->usage = 0;
+  }
+}
+
+size_t BlockCache::KeyHash::operator()(const Key& key) const noexcept {
+  auto hash{key.owner * 0x9e3779b97f4a7c15ULL};
+  hash ^= key.offset + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+BlockCache::Shard& BlockCache::shard_for(const Key& key) const noexcept {
+  return *shards_[(KeyHash{}(key) >> 32) % shards_.size()];
+}
+}  // namespace vkdb
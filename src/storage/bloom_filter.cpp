@@ -1,26 +1,180 @@
 #include <vkdb/bloom_filter.h>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VKDB_BLOOM_FILTER_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON) && \
+  __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define VKDB_BLOOM_FILTER_NEON
+#endif
 
 namespace vkdb {
-BloomFilter::BloomFilter(std::string&& str) noexcept {
-  std::stringstream ss{str};
-  size_type no_of_bits;
-  ss >> no_of_bits;
-  bits_.resize(no_of_bits);
-
-  size_type no_of_hashes;
-  ss >> no_of_hashes;
-  seeds_.resize(no_of_hashes);
-  for (size_type i{0}; i < no_of_hashes; ++i) {
-    ss >> seeds_[i];
-  }
+namespace {
+/**
+ * @brief Mix the bits of a 64-bit value.
+ * @details The finaliser of SplitMix64.
+ * 
+ * @param x Value.
+ * @return uint64_t Mixed value.
+ */
+constexpr uint64_t mix(uint64_t x) noexcept {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+/**
+ * @brief Number of keys ahead of the tested one whose block is prefetched.
+ * 
+ */
+constexpr size_t PREFETCH_DISTANCE{8};
+
+/**
+ * @brief Get the first probe of a hash.
+ * 
+ * @param hash Hash value.
+ * @return uint32_t First probe.
+ */
+constexpr uint32_t first_probe(uint64_t hash) noexcept {
+  return static_cast<uint32_t>(hash);
+}
+
+/**
+ * @brief Get the step between the probes of a hash.
+ * @details The step is odd, so the probes of a key do not repeat within a
+ * block.
+ * 
+ * @param hash Hash value.
+ * @return uint32_t Step.
+ */
+constexpr uint32_t probe_step(uint64_t hash) noexcept {
+  return static_cast<uint32_t>(mix(hash) >> 32) | 1;
+}
 
-  std::string bits;
-  ss >> bits;
-  for (size_type i{0}; i < bits.size(); ++i) {
-    bits_[i] = bits[i] - '0';
+#ifdef VKDB_BLOOM_FILTER_AVX2
+/**
+ * @brief Maximum number of probes that can be tested at once with AVX2.
+ * 
+ */
+constexpr uint32_t AVX2_LANES{8};
+
+/**
+ * @brief Test up to eight probes of a key against a block with AVX2.
+ * @details The probes are computed in 32-bit lanes, the words holding their
+ * bits are gathered from the block, and the bits are tested together.
+ * 
+ * @param words Words of the block.
+ * @param probe First probe.
+ * @param step Step between probes.
+ * @param no_of_probes Number of probes.
+ * @return true if every probed bit is set.
+ * @return false if a probed bit is not set.
+ */
+__attribute__((target("avx2")))
+bool test_block_avx2(
+  const void* words,
+  uint32_t probe,
+  uint32_t step,
+  uint32_t no_of_probes
+) noexcept {
+  const auto lanes{_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)};
+  const auto active{_mm256_cmpgt_epi32(
+    _mm256_set1_epi32(static_cast<int>(no_of_probes)), lanes
+  )};
+  const auto probes{_mm256_add_epi32(
+    _mm256_set1_epi32(static_cast<int>(probe)),
+    _mm256_mullo_epi32(lanes, _mm256_set1_epi32(static_cast<int>(step)))
+  )};
+  const auto bits{_mm256_and_si256(
+    probes, _mm256_set1_epi32(BloomFilter::BLOCK_BITS - 1)
+  )};
+  const auto gathered{_mm256_mask_i32gather_epi32(
+    _mm256_setzero_si256(),
+    static_cast<const int*>(words),
+    _mm256_srli_epi32(bits, 5),
+    active,
+    sizeof(uint32_t)
+  )};
+  const auto masks{_mm256_sllv_epi32(
+    _mm256_set1_epi32(1), _mm256_and_si256(bits, _mm256_set1_epi32(31))
+  )};
+  const auto hits{_mm256_cmpeq_epi32(
+    _mm256_and_si256(gathered, masks), masks
+  )};
+  const auto active_mask{_mm256_movemask_ps(_mm256_castsi256_ps(active))};
+  const auto hit_mask{_mm256_movemask_ps(_mm256_castsi256_ps(hits))};
+  return (hit_mask & active_mask) == active_mask;
+}
+
+/**
+ * @brief Check if the CPU supports AVX2.
+ * 
+ * @return true if the CPU supports AVX2.
+ * @return false if the CPU does not support AVX2.
+ */
+bool has_avx2() noexcept {
+  static const bool supported{__builtin_cpu_supports("avx2") != 0};
+  return supported;
+}
+#endif
+
+#ifdef VKDB_BLOOM_FILTER_NEON
+/**
+ * @brief Test the probes of a key against a block with NEON.
+ * @details The probes are computed four at a time in 32-bit lanes, and the
+ * bits are tested together once the words holding them have been loaded.
+ * 
+ * @param words Words of the block.
+ * @param probe First probe.
+ * @param step Step between probes.
+ * @param no_of_probes Number of probes.
+ * @return true if every probed bit is set.
+ * @return false if a probed bit is not set.
+ */
+bool test_block_neon(
+  const char* words,
+  uint32_t probe,
+  uint32_t step,
+  uint32_t no_of_probes
+) noexcept {
+  static constexpr uint32_t LANE_OFFSETS[4]{0, 1, 2, 3};
+  const auto offsets{vld1q_u32(LANE_OFFSETS)};
+  for (uint32_t i{0}; i < no_of_probes; i += 4) {
+    const auto lanes{vaddq_u32(offsets, vdupq_n_u32(i))};
+    const auto bits{vandq_u32(
+      vmlaq_u32(vdupq_n_u32(probe), lanes, vdupq_n_u32(step)),
+      vdupq_n_u32(BloomFilter::BLOCK_BITS - 1)
+    )};
+    uint32_t word_indices[4];
+    vst1q_u32(word_indices, vshrq_n_u32(bits, 5));
+    uint32_t gathered[4];
+    for (size_t lane{0}; lane < 4; ++lane) {
+      std::memcpy(
+        &gathered[lane],
+        words + word_indices[lane] * sizeof(uint32_t),
+        sizeof(uint32_t)
+      );
+    }
+    const auto masks{vshlq_u32(
+      vdupq_n_u32(1),
+      vreinterpretq_s32_u32(vandq_u32(bits, vdupq_n_u32(31)))
+    )};
+    const auto hits{vtstq_u32(vld1q_u32(gathered), masks)};
+    const auto active{vcltq_u32(lanes, vdupq_n_u32(no_of_probes))};
+    if (vmaxvq_u32(vbicq_u32(active, hits)) != 0) {
+      return false;
+    }
   }
+  return true;
 }
+#endif
+}  // namespace
 
 BloomFilter::BloomFilter(
   size_type expected_no_of_elems,
@@ -41,65 +195,135 @@ BloomFilter::BloomFilter(
   auto log_false_positive_rate{std::log(false_positive_rate)};
   auto log_2_squared{std::log(2) * std::log(2)};
 
-  auto no_of_bits{static_cast<size_type>(
-    -(expected_no_of_elems * log_false_positive_rate) / log_2_squared
-  )};
-  bits_.resize(no_of_bits);
+  auto bits_per_elem{-log_false_positive_rate / log_2_squared};
+  auto no_of_bits{static_cast<size_type>(std::ceil(
+    expected_no_of_elems * bits_per_elem * BLOCKING_OVERHEAD
+  ))};
+  blocks_.resize(std::max<size_type>(
+    1, (no_of_bits + BLOCK_BITS - 1) / BLOCK_BITS
+  ));
 
-  auto no_of_hashes{static_cast<size_type>(
-    (no_of_bits / expected_no_of_elems) * std::log(2)
-  )};
-  initialise_seeds(no_of_hashes);
+  no_of_probes_ = std::max<uint32_t>(
+    1, static_cast<uint32_t>(std::lround(bits_per_elem * std::log(2)))
+  );
+}
+
+BloomFilter::BloomFilter(size_type no_of_blocks, uint32_t no_of_probes)
+  : no_of_probes_{no_of_probes}, blocks_(no_of_blocks) {}
+
+BloomFilter BloomFilter::fromBinary(const char*& pos, const char* end) {
+  const auto no_of_blocks{readBinary<size_type>(pos, end)};
+  const auto no_of_probes{readBinary<uint32_t>(pos, end)};
+  if (no_of_blocks == 0 || no_of_probes == 0) {
+    throw std::runtime_error{
+      "BloomFilter::fromBinary(): Invalid number of blocks or probes."
+    };
+  }
+  if (static_cast<size_type>(end - pos) / sizeof(Block) < no_of_blocks) {
+    throw std::runtime_error{
+      "BloomFilter::fromBinary(): Unexpected end of buffer."
+    };
+  }
+
+  BloomFilter filter{no_of_blocks, no_of_probes};
+  std::memcpy(filter.blocks_.data(), pos, no_of_blocks * sizeof(Block));
+  pos += no_of_blocks * sizeof(Block);
+  return filter;
+}
+
+void BloomFilter::toBinary(std::string& buffer) const {
+  appendBinary(buffer, static_cast<size_type>(blocks_.size()));
+  appendBinary(buffer, no_of_probes_);
+  buffer.append(
+    reinterpret_cast<const char*>(blocks_.data()),
+    blocks_.size() * sizeof(Block)
+  );
 }
 
 void BloomFilter::insert(const key_type& key) noexcept {
-  for (size_type i{0}; i < seeds_.size(); ++i) {
-    bits_[hash(key, i)] = true;
+  const auto key_hash{hash(key)};
+  auto& words{blocks_[block_index(key_hash)].words};
+  auto probe{first_probe(key_hash)};
+  const auto step{probe_step(key_hash)};
+  for (uint32_t i{0}; i < no_of_probes_; ++i) {
+    const auto bit{probe % BLOCK_BITS};
+    words[bit / 64] |= uint64_t{1} << (bit % 64);
+    probe += step;
   }
 }
 
 bool BloomFilter::mayContain(const key_type& key) const noexcept {
-  for (size_type i{0}; i < seeds_.size(); ++i) {
-    if (!bits_[hash(key, i)]) {
-      return false;
-    }
-  }
-  return true;
+  return mayContain(hash(key));
 }
 
-std::string BloomFilter::str() const noexcept {
-  std::stringstream ss;
-  ss << bits_.size() << " ";
-  ss << seeds_.size() << " ";
-  auto first{true};
-  for (const auto& seed : seeds_) {
-    if (!first) {
-      ss << " ";
-    }
-    ss << seed;
-    first = false;
+bool BloomFilter::mayContain(hash_type hash) const noexcept {
+  return test_block(blocks_[block_index(hash)], hash);
+}
+
+void BloomFilter::mayContainBatch(
+  std::span<const hash_type> hashes,
+  std::span<bool> results
+) const noexcept {
+  const auto size{std::min(hashes.size(), results.size())};
+  for (size_t i{0}; i < std::min(size, PREFETCH_DISTANCE); ++i) {
+    __builtin_prefetch(&blocks_[block_index(hashes[i])]);
   }
-  ss << " ";
-  for (const auto& bit : bits_) {
-    ss << bit;
+  for (size_t i{0}; i < size; ++i) {
+    if (i + PREFETCH_DISTANCE < size) {
+      __builtin_prefetch(
+        &blocks_[block_index(hashes[i + PREFETCH_DISTANCE])]
+      );
+    }
+    results[i] = test_block(blocks_[block_index(hashes[i])], hashes[i]);
   }
-  return ss.str();
 }
 
-void BloomFilter::initialise_seeds(size_type no_of_hashes) noexcept {
-  seeds_.resize(no_of_hashes);
-  for (size_type i{0}; i < no_of_hashes; ++i) {
-    seeds_[i] = random<size_type>();
-  }
+BloomFilter::size_type BloomFilter::blockCount() const noexcept {
+  return blocks_.size();
+}
+
+uint32_t BloomFilter::probeCount() const noexcept {
+  return no_of_probes_;
+}
+
+BloomFilter::hash_type BloomFilter::hash(const key_type& key) noexcept {
+  return mix(key.series().hash ^ mix(static_cast<uint64_t>(key.timestamp())));
+}
+
+BloomFilter::size_type BloomFilter::block_index(
+  hash_type hash
+) const noexcept {
+  return static_cast<size_type>(
+    (static_cast<unsigned __int128>(hash) * blocks_.size()) >> 64
+  );
 }
 
-BloomFilter::HashValue BloomFilter::hash(
-  const key_type& key,
-  size_type i
+bool BloomFilter::test_block(
+  const Block& block,
+  hash_type hash
 ) const noexcept {
-  HashValue hash_value{0};
-  auto std_hash_value{std::hash<std::string>{}(key.str())};
-  MurmurHash3_x86_32(&std_hash_value, sizeof(std_hash_value), i, &hash_value);
-  return hash_value % bits_.size();
+  const auto probe{first_probe(hash)};
+  const auto step{probe_step(hash)};
+#if defined(VKDB_BLOOM_FILTER_AVX2)
+  if (no_of_probes_ <= AVX2_LANES && has_avx2()) {
+    return test_block_avx2(block.words.data(), probe, step, no_of_probes_);
+  }
+#elif defined(VKDB_BLOOM_FILTER_NEON)
+  return test_block_neon(
+    reinterpret_cast<const char*>(block.words.data()),
+    probe,
+    step,
+    no_of_probes_
+  );
+#endif
+  auto next_probe{probe};
+  for (uint32_t i{0}; i < no_of_probes_; ++i) {
+    const auto bit{next_probe % BLOCK_BITS};
+    if (!(block.words[bit / 64] & (uint64_t{1} << (bit % 64)))) {
+      return false;
+    }
+    next_probe += step;
+  }
+  return true;
 }
 }  // namespace vkdb
@@ -0,0 +1,324 @@
+#include <vkdb/compression.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+
+#ifdef VKDB_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Minimum length of an LZ4 match.
+ * 
+ */
+constexpr size_t LZ4_MIN_MATCH{4};
+
+/**
+ * @brief Number of bytes at the end of the input that are always literals.
+ * 
+ */
+constexpr size_t LZ4_LAST_LITERALS{5};
+
+/**
+ * @brief Distance from the end of the input past which no match starts.
+ * 
+ */
+constexpr size_t LZ4_MATCH_LIMIT{12};
+
+/**
+ * @brief Largest offset of an LZ4 match.
+ * 
+ */
+constexpr size_t LZ4_MAX_OFFSET{65535};
+
+/**
+ * @brief Number of bits of the hash of four bytes.
+ * 
+ */
+constexpr int LZ4_HASH_BITS{12};
+
+/**
+ * @brief Level of Zstd compression.
+ * 
+ */
+[[maybe_unused]] constexpr int ZSTD_LEVEL{3};
+
+/**
+ * @brief Read four bytes.
+ * 
+ * @param pos Position.
+ * @return uint32_t Bytes.
+ */
+uint32_t read_u32(const char* pos) noexcept {
+  uint32_t value;
+  std::memcpy(&value, pos, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Hash four bytes into a slot of the match table.
+ * 
+ * @param bytes Bytes.
+ * @return uint32_t Slot.
+ */
+uint32_t lz4_hash(uint32_t bytes) noexcept {
+  return (bytes * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+/**
+ * @brief Append an LZ4 length continuation to a buffer.
+ * 
+ * @param out Buffer.
+ * @param length Length beyond the 15 held by the token.
+ */
+void lz4_append_length(std::string& out, size_t length) {
+  while (length >= 255) {
+    out.push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  out.push_back(static_cast<char>(length));
+}
+
+/**
+ * @brief Append an LZ4 sequence to a buffer.
+ * @details The last sequence of a block has literals but no match.
+ * 
+ * @param out Buffer.
+ * @param literals Literals.
+ * @param offset Offset of the match.
+ * @param match_length Length of the match, or 0 if there is none.
+ */
+void lz4_append_sequence(
+  std::string& out,
+  std::string_view literals,
+  size_t offset,
+  size_t match_length
+) {
+  const auto literal_length{literals.size()};
+  const auto match_code{
+    match_length == 0 ? 0 : match_length - LZ4_MIN_MATCH
+  };
+  out.push_back(static_cast<char>(
+    (std::min<size_t>(literal_length, 15) << 4) |
+    std::min<size_t>(match_code, 15)
+  ));
+  if (literal_length >= 15) {
+    lz4_append_length(out, literal_length - 15);
+  }
+  out.append(literals);
+  if (match_length == 0) {
+    return;
+  }
+  out.push_back(static_cast<char>(offset & 0xFF));
+  out.push_back(static_cast<char>(offset >> 8));
+  if (match_code >= 15) {
+    lz4_append_length(out, match_code - 15);
+  }
+}
+
+/**
+ * @brief Compress data into an LZ4 block.
+ * @details Greedy matching on a hash table of four-byte sequences.
+ * 
+ * @param data Data.
+ * @return std::string LZ4 block.
+ */
+std::string lz4_compress(std::string_view data) {
+  std::string out;
+  out.reserve(data.size() / 2 + 16);
+  const auto size{data.size()};
+  size_t anchor{0};
+  if (size > LZ4_MATCH_LIMIT) {
+    auto table{std::make_unique<std::array<uint32_t, 1 << LZ4_HASH_BITS>>()};
+    table->fill(0);
+    const auto match_start_limit{size - LZ4_MATCH_LIMIT};
+    const auto match_end_limit{size - LZ4_LAST_LITERALS};
+    size_t pos{0};
+    while (pos < match_start_limit) {
+      const auto bytes{read_u32(data.data() + pos)};
+      auto& slot{(*table)[lz4_hash(bytes)]};
+      const size_t candidate{slot};
+      slot = static_cast<uint32_t>(pos + 1);
+      if (
+        candidate == 0 ||
+        pos - (candidate - 1) > LZ4_MAX_OFFSET ||
+        read_u32(data.data() + candidate - 1) != bytes
+      ) {
+        ++pos;
+        continue;
+      }
+      const auto match{candidate - 1};
+      auto length{LZ4_MIN_MATCH};
+      while (
+        pos + length < match_end_limit &&
+        data[match + length] == data[pos + length]
+      ) {
+        ++length;
+      }
+      lz4_append_sequence(
+        out, data.substr(anchor, pos - anchor), pos - match, length
+      );
+      pos += length;
+      anchor = pos;
+    }
+  }
+  lz4_append_sequence(out, data.substr(anchor), 0, 0);
+  return out;
+}
+
+/**
+ * @brief Read an LZ4 length continuation.
+ * 
+ * @param pos Position.
+ * @param end End of the block.
+ * @return size_t Length beyond the 15 held by the token.
+ * 
+ * @throw std::runtime_error If the block ends within the length.
+ */
+size_t lz4_read_length(const char*& pos, const char* end) {
+  size_t length{0};
+  uint8_t byte;
+  do {
+    if (pos == end) {
+      throw std::runtime_error{"decompress(): Truncated LZ4 block."};
+    }
+    byte = static_cast<uint8_t>(*pos++);
+    length += byte;
+  } while (byte == 255);
+  return length;
+}
+
+/**
+ * @brief Decompress an LZ4 block.
+ * 
+ * @param data LZ4 block.
+ * @param out Buffer of the decompressed size.
+ * 
+ * @throw std::runtime_error If the block is malformed.
+ */
+void lz4_decompress(std::string_view data, std::span<char> out) {
+  const char* pos{data.data()};
+  const char* end{data.data() + data.size()};
+  size_t written{0};
+  while (pos != end) {
+    const auto token{static_cast<uint8_t>(*pos++)};
+    size_t literal_length{static_cast<size_t>(token >> 4)};
+    if (literal_length == 15) {
+      literal_length += lz4_read_length(pos, end);
+    }
+    if (
+      literal_length > static_cast<size_t>(end - pos) ||
+      literal_length > out.size() - written
+    ) {
+      throw std::runtime_error{"decompress(): Malformed LZ4 literals."};
+    }
+    std::memcpy(out.data() + written, pos, literal_length);
+    pos += literal_length;
+    written += literal_length;
+    if (pos == end) {
+      break;
+    }
+
+    if (end - pos < 2) {
+      throw std::runtime_error{"decompress(): Truncated LZ4 block."};
+    }
+    const auto offset{
+      static_cast<size_t>(static_cast<uint8_t>(pos[0])) |
+      static_cast<size_t>(static_cast<uint8_t>(pos[1])) << 8
+    };
+    pos += 2;
+    size_t match_length{static_cast<size_t>(token & 0x0F)};
+    if (match_length == 15) {
+      match_length += lz4_read_length(pos, end);
+    }
+    match_length += LZ4_MIN_MATCH;
+    if (
+      offset == 0 || offset > written ||
+      match_length > out.size() - written
+    ) {
+      throw std::runtime_error{"decompress(): Malformed LZ4 match."};
+    }
+    for (size_t i{0}; i < match_length; ++i, ++written) {
+      out[written] = out[written - offset];
+    }
+  }
+  if (written != out.size()) {
+    throw std::runtime_error{"decompress(): LZ4 block size does not match."};
+  }
+}
+}  // namespace
+
+bool compressionAvailable(Compression codec) noexcept {
+  switch (codec) {
+    case Compression::NONE:
+    case Compression::LZ4:
+      return true;
+    case Compression::ZSTD:
+#ifdef VKDB_HAS_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+std::string compress(Compression codec, std::string_view data) {
+  switch (codec) {
+    case Compression::NONE:
+      return std::string{data};
+    case Compression::LZ4:
+      return lz4_compress(data);
+    case Compression::ZSTD: {
+#ifdef VKDB_HAS_ZSTD
+      std::string out(ZSTD_compressBound(data.size()), '\0');
+      const auto size{ZSTD_compress(
+        out.data(), out.size(), data.data(), data.size(), ZSTD_LEVEL
+      )};
+      if (ZSTD_isError(size)) {
+        throw std::runtime_error{
+          "compress(): " + std::string{ZSTD_getErrorName(size)}
+        };
+      }
+      out.resize(size);
+      return out;
+#else
+      break;
+#endif
+    }
+  }
+  throw std::invalid_argument{"compress(): Codec is not available."};
+}
+
+void decompress(Compression codec, std::string_view data, std::span<char> out) {
+  switch (codec) {
+    case Compression::NONE:
+      if (data.size() != out.size()) {
+        throw std::runtime_error{"decompress(): Size does not match."};
+      }
+      std::memcpy(out.data(), data.data(), data.size());
+      return;
+    case Compression::LZ4:
+      lz4_decompress(data, out);
+      return;
+    case Compression::ZSTD: {
+#ifdef VKDB_HAS_ZSTD
+      const auto size{ZSTD_decompress(
+        out.data(), out.size(), data.data(), data.size()
+      )};
+      if (ZSTD_isError(size) || size != out.size()) {
+        throw std::runtime_error{"decompress(): Malformed Zstd frame."};
+      }
+      return;
+#else
+      break;
+#endif
+    }
+  }
+  throw std::runtime_error{"decompress(): Codec is not available."};
+}
+}  // namespace vkdb
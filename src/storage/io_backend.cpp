@@ -0,0 +1,406 @@
+#include <vkdb/io_backend.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef VKDB_HAS_IO_URING
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Write data at an offset with blocking system calls.
+ * 
+ * @param fd File descriptor.
+ * @param offset Offset.
+ * @param data Data.
+ * @param sync Whether to sync the file's data once it is written.
+ * @return IOResult Result.
+ */
+IOResult posix_write_at(
+  int fd,
+  uint64_t offset,
+  std::string_view data,
+  bool sync
+) noexcept {
+  IOResult result;
+  while (result.written < data.size()) {
+    const auto written{::pwrite(
+      fd,
+      data.data() + result.written,
+      data.size() - result.written,
+      static_cast<off_t>(offset + result.written)
+    )};
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result.error = errno;
+      return result;
+    }
+    result.written += written;
+  }
+  if (sync && ::fdatasync(fd) == -1) {
+    result.error = errno;
+  }
+  return result;
+}
+
+#ifdef VKDB_HAS_IO_URING
+/**
+ * @brief Number of entries of each submission queue.
+ * 
+ */
+constexpr unsigned RING_ENTRIES{8};
+
+/**
+ * @brief User data of a write completion.
+ * 
+ */
+constexpr uint64_t WRITE_USER_DATA{1};
+
+/**
+ * @brief User data of a sync completion.
+ * 
+ */
+constexpr uint64_t SYNC_USER_DATA{2};
+
+/**
+ * @brief io_uring set up with raw system calls.
+ * @details Only used by the thread that owns it, so the submission queue has
+ * a single producer and the completion queue a single consumer.
+ * 
+ */
+class Ring {
+public:
+  /**
+   * @brief Set up a ring.
+   * 
+   * @return std::unique_ptr<Ring> Ring, or null if io_uring is unavailable.
+   */
+  [[nodiscard]] static std::unique_ptr<Ring> create() noexcept {
+    std::unique_ptr<Ring> ring{new Ring};
+    return ring->setup() ? std::move(ring) : nullptr;
+  }
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  ~Ring() noexcept {
+    if (sqes_ != MAP_FAILED) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  /**
+   * @brief Write data at an offset, linking a sync after the write if asked
+   * to.
+   * @details A short write breaks the link, so the rest is resubmitted with
+   * the sync linked after it again.
+   * 
+   * @param fd File descriptor.
+   * @param offset Offset.
+   * @param data Data.
+   * @param sync Whether to sync the file's data once it is written.
+   * @return IOResult Result.
+   */
+  [[nodiscard]] IOResult writeAt(
+    int fd,
+    uint64_t offset,
+    std::string_view data,
+    bool sync
+  ) noexcept {
+    IOResult result;
+    bool synced{!sync};
+    while (result.written < data.size() || !synced) {
+      iovec iov{
+        const_cast<char*>(data.data()) + result.written,
+        data.size() - result.written
+      };
+      unsigned submitted{0};
+      if (iov.iov_len > 0) {
+        auto& sqe{next_sqe()};
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.fd = fd;
+        sqe.off = offset + result.written;
+        sqe.addr = reinterpret_cast<uint64_t>(&iov);
+        sqe.len = 1;
+        sqe.flags = sync ? IOSQE_IO_LINK : 0;
+        sqe.user_data = WRITE_USER_DATA;
+        ++submitted;
+      }
+      if (sync) {
+        auto& sqe{next_sqe()};
+        sqe.opcode = IORING_OP_FSYNC;
+        sqe.fd = fd;
+        sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe.user_data = SYNC_USER_DATA;
+        ++submitted;
+      }
+      if (const auto error{submit_and_wait(submitted)}; error != 0) {
+        result.error = error;
+        return result;
+      }
+
+      int write_error{0};
+      int sync_error{0};
+      for (unsigned i{0}; i < submitted; ++i) {
+        const auto cqe{pop_cqe()};
+        if (cqe.user_data == WRITE_USER_DATA) {
+          if (cqe.res > 0) {
+            result.written += cqe.res;
+          } else if (cqe.res == 0) {
+            write_error = EIO;
+          } else if (cqe.res != -EINTR && cqe.res != -EAGAIN) {
+            write_error = -cqe.res;
+          }
+        } else if (cqe.res < 0) {
+          sync_error = -cqe.res;
+        } else {
+          synced = true;
+        }
+      }
+      if (write_error != 0) {
+        result.error = write_error;
+        return result;
+      }
+      if (
+        sync_error != 0 && sync_error != ECANCELED &&
+        result.written == data.size()
+      ) {
+        result.error = sync_error;
+        return result;
+      }
+    }
+    return result;
+  }
+
+private:
+  Ring() noexcept = default;
+
+  /**
+   * @brief Set up the ring and map its queues.
+   * 
+   * @return true if the ring is ready.
+   * @return false if io_uring is unavailable.
+   */
+  [[nodiscard]] bool setup() noexcept {
+    io_uring_params params{};
+    fd_ = static_cast<int>(
+      ::syscall(__NR_io_uring_setup, RING_ENTRIES, &params)
+    );
+    if (fd_ == -1) {
+      return false;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap{(params.features & IORING_FEAT_SINGLE_MMAP) != 0};
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = ::mmap(
+      nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING
+    );
+    if (sq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_ : ::mmap(
+      nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING
+    );
+    if (cq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = ::mmap(
+      nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES
+    );
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    auto* sq{static_cast<char*>(sq_ring_)};
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    pending_tail_ = *sq_tail_;
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq{static_cast<char*>(cq_ring_)};
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  /**
+   * @brief Get the next submission queue entry, cleared.
+   * @details The entry is only published by submit_and_wait().
+   * 
+   * @return io_uring_sqe& Entry.
+   */
+  [[nodiscard]] io_uring_sqe& next_sqe() noexcept {
+    const auto index{pending_tail_++ & sq_mask_};
+    auto& sqe{static_cast<io_uring_sqe*>(sqes_)[index]};
+    sqe = io_uring_sqe{};
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  /**
+   * @brief Publish the pending entries, submit them, and wait for as many
+   * completions.
+   * 
+   * @param count Number of pending entries.
+   * @return int Error number, or 0 on success.
+   */
+  [[nodiscard]] int submit_and_wait(unsigned count) noexcept {
+    std::atomic_ref{*sq_tail_}.store(pending_tail_, std::memory_order_release);
+    auto to_submit{count};
+    auto to_complete{count};
+    while (to_complete > 0) {
+      const auto result{::syscall(
+        __NR_io_uring_enter, fd_, to_submit, to_complete,
+        IORING_ENTER_GETEVENTS, nullptr, 0
+      )};
+      if (result == -1) {
+        if (errno == EINTR) {
+          to_submit = 0;
+          to_complete = count - ready();
+          continue;
+        }
+        return errno;
+      }
+      to_submit -= std::min<unsigned>(to_submit, result);
+      to_complete = count - std::min(count, ready());
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Get the number of completions ready to be popped.
+   * 
+   * @return unsigned Number of completions.
+   */
+  [[nodiscard]] unsigned ready() const noexcept {
+    return std::atomic_ref{*cq_tail_}.load(std::memory_order_acquire)
+      - *cq_head_;
+  }
+
+  /**
+   * @brief Pop a completion.
+   * @details A completion must be ready.
+   * 
+   * @return io_uring_cqe Completion.
+   */
+  [[nodiscard]] io_uring_cqe pop_cqe() noexcept {
+    const auto head{*cq_head_};
+    const auto cqe{cqes_[head & cq_mask_]};
+    std::atomic_ref{*cq_head_}.store(head + 1, std::memory_order_release);
+    return cqe;
+  }
+
+  int fd_{-1};
+  void* sq_ring_{MAP_FAILED};
+  void* cq_ring_{MAP_FAILED};
+  void* sqes_{MAP_FAILED};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  size_t sqes_size_{0};
+  unsigned* sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned* sq_array_{nullptr};
+  unsigned* cq_head_{nullptr};
+  unsigned* cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe* cqes_{nullptr};
+  unsigned pending_tail_{0};
+};
+
+/**
+ * @brief Get the ring of the calling thread, setting it up on first use.
+ * 
+ * @return Ring* Ring, or null if io_uring is unavailable.
+ */
+Ring* thread_ring() noexcept {
+  thread_local const auto ring{Ring::create()};
+  return ring.get();
+}
+#endif
+}  // namespace
+
+bool ioBackendAvailable(IOBackend backend) noexcept {
+  switch (backend) {
+    case IOBackend::POSIX:
+      return true;
+    case IOBackend::IO_URING:
+#ifdef VKDB_HAS_IO_URING
+      {
+        static const bool available{Ring::create() != nullptr};
+        return available;
+      }
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+IOResult writeAt(
+  IOBackend backend,
+  int fd,
+  uint64_t offset,
+  std::string_view data,
+  bool sync
+) noexcept {
+#ifdef VKDB_HAS_IO_URING
+  if (backend == IOBackend::IO_URING && ioBackendAvailable(backend)) {
+    if (auto* ring{thread_ring()}) {
+      return ring->writeAt(fd, offset, data, sync);
+    }
+  }
+#endif
+  return posix_write_at(fd, offset, data, sync);
+}
+
+void writeFile(
+  IOBackend backend,
+  const std::filesystem::path& path,
+  std::string_view data,
+  bool sync
+) {
+  const auto fd{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+  if (fd == -1) {
+    throw std::runtime_error{
+      "writeFile(): Unable to open file '" + std::string(path) + "'."
+    };
+  }
+  const auto result{writeAt(backend, fd, 0, data, sync)};
+  const auto closed{::close(fd) == 0};
+  if (!result || !closed) {
+    throw std::runtime_error{
+      "writeFile(): Unable to write to file '" + std::string(path) + "'."
+    };
+  }
+}
+}  // namespace vkdb
@@ -0,0 +1,146 @@
+#include <vkdb/io_scheduler.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace vkdb {
+IOScheduler::IOScheduler(IOSchedulerOptions options)
+  : options_{options}
+  , tokens_{static_cast<double>(options.burst_bytes)}
+  , refilled_{clock_type::now()} {
+  if (options.burst_bytes == 0) {
+    throw std::invalid_argument{
+      "IOScheduler(): Burst must be at least 1 byte."
+    };
+  }
+  if (options.foreground_latency_target.count() < 0) {
+    throw std::invalid_argument{
+      "IOScheduler(): Foreground latency target must not be negative."
+    };
+  }
+  if (!(options.min_compaction_share > 0.0) ||
+      options.min_compaction_share > 1.0) {
+    throw std::invalid_argument{
+      "IOScheduler(): Minimum compaction share must be in (0, 1]."
+    };
+  }
+}
+
+void IOScheduler::request(IOPriority priority, size_type bytes) {
+  const auto index{static_cast<size_type>(priority)};
+  if (options_.bytes_per_second == 0 || bytes == 0) {
+    granted_bytes_[index].fetch_add(bytes, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto start{clock_type::now()};
+  const auto rate{static_cast<double>(options_.bytes_per_second)};
+  const auto burst{static_cast<double>(options_.burst_bytes)};
+  {
+    std::unique_lock lock{mutex_};
+    ++waiting_[index];
+    while (bytes > 0) {
+      const auto chunk{std::min(bytes, options_.burst_bytes)};
+      auto cost{static_cast<double>(chunk)};
+      if (priority == IOPriority::COMPACTION) {
+        adapt(clock_type::now());
+        cost /= compaction_share_.load(std::memory_order_relaxed);
+      }
+      const auto needed{std::min(cost, burst)};
+      while (true) {
+        refill(clock_type::now());
+        if (!outranked(priority) && tokens_ >= needed) {
+          break;
+        }
+        const auto deficit{
+          outranked(priority) ? burst : std::max(needed - tokens_, 1.0)
+        };
+        granted_.wait_for(lock, std::chrono::duration<double>{deficit / rate});
+      }
+      tokens_ -= cost;
+      bytes -= chunk;
+      granted_bytes_[index].fetch_add(chunk, std::memory_order_relaxed);
+    }
+    --waiting_[index];
+  }
+  granted_.notify_all();
+
+  if (priority == IOPriority::WAL || priority == IOPriority::READ) {
+    recordForegroundLatency(clock_type::now() - start);
+  }
+}
+
+void IOScheduler::recordForegroundLatency(duration_type latency) noexcept {
+  const auto sample{static_cast<size_type>(
+    std::max<duration_type::rep>(latency.count(), 0)
+  )};
+  const auto average{foreground_latency_.load(std::memory_order_relaxed)};
+  foreground_latency_.store(
+    average == 0 ? sample : average - average / 8 + sample / 8,
+    std::memory_order_relaxed
+  );
+  foreground_sampled_.store(
+    std::chrono::duration_cast<duration_type>(
+      clock_type::now().time_since_epoch()
+    ).count(),
+    std::memory_order_relaxed
+  );
+}
+
+double IOScheduler::compactionShare() const noexcept {
+  return compaction_share_.load(std::memory_order_relaxed);
+}
+
+IOScheduler::size_type IOScheduler::grantedBytes(
+  IOPriority priority
+) const noexcept {
+  return granted_bytes_[static_cast<size_type>(priority)].load(
+    std::memory_order_relaxed
+  );
+}
+
+IOSchedulerOptions IOScheduler::options() const noexcept {
+  return options_;
+}
+
+void IOScheduler::refill(clock_type::time_point now) noexcept {
+  const std::chrono::duration<double> elapsed{now - refilled_};
+  refilled_ = now;
+  tokens_ = std::min(
+    tokens_ + elapsed.count() * static_cast<double>(options_.bytes_per_second),
+    static_cast<double>(options_.burst_bytes)
+  );
+}
+
+void IOScheduler::adapt(clock_type::time_point now) noexcept {
+  const auto target{options_.foreground_latency_target.count()};
+  if (target == 0) {
+    return;
+  }
+  const auto sampled{foreground_sampled_.load(std::memory_order_relaxed)};
+  const auto since_sampled{
+    std::chrono::duration_cast<duration_type>(now.time_since_epoch()).count()
+      - sampled
+  };
+  const auto pressured{
+    since_sampled < FOREGROUND_LATENCY_WINDOW.count() &&
+    foreground_latency_.load(std::memory_order_relaxed)
+      > static_cast<size_type>(target)
+  };
+  const auto share{compaction_share_.load(std::memory_order_relaxed)};
+  compaction_share_.store(
+    pressured
+      ? std::max(options_.min_compaction_share, share / 2)
+      : std::min(1.0, share + 0.1),
+    std::memory_order_relaxed
+  );
+}
+
+bool IOScheduler::outranked(IOPriority priority) const noexcept {
+  for (size_type i{0}; i < static_cast<size_type>(priority); ++i) {
+    if (waiting_[i] > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace vkdb
@@ -0,0 +1,217 @@
+#include <vkdb/key_predicate.h>
+#include <algorithm>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Helper for visiting a variant with overloaded lambdas.
+ * 
+ * @tparam Ts Lambda types.
+ */
+template <typename... Ts>
+struct Overloaded : Ts... {
+  using Ts::operator()...;
+};
+}  // namespace
+
+KeyPredicate& KeyPredicate::requireAnyMetric(std::vector<Metric> metrics) {
+  mask_type mask{0};
+  for (const auto& metric : metrics) {
+    mask |= SeriesSummary::metricMask(metric);
+  }
+  clauses_.push_back(MetricClause{std::move(metrics), mask});
+  return *this;
+}
+
+KeyPredicate& KeyPredicate::requireAnyTag(std::vector<Tag> tags) {
+  mask_type mask{0};
+  for (const auto& tag : tags) {
+    mask |= SeriesSummary::tagMask(tag);
+  }
+  clauses_.push_back(TagClause{std::move(tags), mask});
+  return *this;
+}
+
+KeyPredicate& KeyPredicate::requireAnyTimestamp(
+  std::vector<Timestamp> timestamps
+) {
+  clauses_.push_back(TimestampClause{std::move(timestamps)});
+  return *this;
+}
+
+KeyPredicate& KeyPredicate::requireAll(const KeyPredicate& other) {
+  if (&other == this) {
+    return *this;
+  }
+  clauses_.insert(clauses_.end(), other.clauses_.begin(), other.clauses_.end());
+  return *this;
+}
+
+bool KeyPredicate::empty() const noexcept {
+  return clauses_.empty();
+}
+
+bool KeyPredicate::constrainsTimestamps() const noexcept {
+  return std::ranges::any_of(clauses_, [](const auto& clause) {
+    return std::holds_alternative<TimestampClause>(clause);
+  });
+}
+
+bool KeyPredicate::constrainsSeries() const noexcept {
+  return std::ranges::any_of(clauses_, [](const auto& clause) {
+    return !std::holds_alternative<TimestampClause>(clause);
+  });
+}
+
+std::optional<std::vector<Timestamp>> KeyPredicate::timestamps() const {
+  std::optional<std::vector<Timestamp>> timestamps;
+  for (const auto& clause : clauses_) {
+    const auto timestamp_clause{std::get_if<TimestampClause>(&clause)};
+    if (timestamp_clause == nullptr) {
+      continue;
+    }
+    auto clause_timestamps{timestamp_clause->timestamps};
+    std::ranges::sort(clause_timestamps);
+    const auto [first, last]{std::ranges::unique(clause_timestamps)};
+    clause_timestamps.erase(first, last);
+    if (!timestamps) {
+      timestamps = std::move(clause_timestamps);
+      continue;
+    }
+    std::vector<Timestamp> intersection;
+    std::ranges::set_intersection(
+      *timestamps,
+      clause_timestamps,
+      std::back_inserter(intersection)
+    );
+    timestamps = std::move(intersection);
+  }
+  return timestamps;
+}
+
+std::optional<std::vector<Metric>> KeyPredicate::metrics() const {
+  std::optional<std::vector<Metric>> metrics;
+  for (const auto& clause : clauses_) {
+    const auto metric_clause{std::get_if<MetricClause>(&clause)};
+    if (metric_clause == nullptr) {
+      continue;
+    }
+    auto clause_metrics{metric_clause->metrics};
+    std::ranges::sort(clause_metrics);
+    const auto [first, last]{std::ranges::unique(clause_metrics)};
+    clause_metrics.erase(first, last);
+    if (!metrics) {
+      metrics = std::move(clause_metrics);
+      continue;
+    }
+    std::vector<Metric> intersection;
+    std::ranges::set_intersection(
+      *metrics,
+      clause_metrics,
+      std::back_inserter(intersection)
+    );
+    metrics = std::move(intersection);
+  }
+  return metrics;
+}
+
+std::optional<TagTable> KeyPredicate::requiredTags() const {
+  TagTable tags;
+  for (const auto& clause : clauses_) {
+    const auto tag_clause{std::get_if<TagClause>(&clause)};
+    if (tag_clause == nullptr || tag_clause->tags.size() != 1) {
+      continue;
+    }
+    const auto& [key, value]{tag_clause->tags.front()};
+    const auto [it, inserted]{tags.emplace(key, value)};
+    if (!inserted && it->second != value) {
+      return std::nullopt;
+    }
+  }
+  return tags;
+}
+
+bool KeyPredicate::matches(const TimeSeriesKey& key) const noexcept {
+  return std::ranges::all_of(clauses_, [&](const auto& clause) {
+    return std::visit(Overloaded{
+      [&](const MetricClause& metric_clause) {
+        return std::ranges::find(metric_clause.metrics, key.metric())
+          != metric_clause.metrics.end();
+      },
+      [&](const TagClause& tag_clause) {
+        const auto& tags{key.tags()};
+        return std::ranges::any_of(tag_clause.tags, [&](const auto& tag) {
+          const auto it{tags.find(tag.first)};
+          return it != tags.end() && it->second == tag.second;
+        });
+      },
+      [&](const TimestampClause& timestamp_clause) {
+        return std::ranges::find(timestamp_clause.timestamps, key.timestamp())
+          != timestamp_clause.timestamps.end();
+      }
+    }, clause);
+  });
+}
+
+bool KeyPredicate::matchesSeries(const Series& series) const noexcept {
+  return std::ranges::all_of(clauses_, [&](const auto& clause) {
+    return std::visit(Overloaded{
+      [&](const MetricClause& metric_clause) {
+        return std::ranges::find(metric_clause.metrics, series.metric)
+          != metric_clause.metrics.end();
+      },
+      [&](const TagClause& tag_clause) {
+        return std::ranges::any_of(tag_clause.tags, [&](const auto& tag) {
+          const auto it{series.tags.find(tag.first)};
+          return it != series.tags.end() && it->second == tag.second;
+        });
+      },
+      [](const TimestampClause&) {
+        return true;
+      }
+    }, clause);
+  });
+}
+
+bool KeyPredicate::mayMatch(
+  const SeriesSummary& summary,
+  const TimeRange& time_range
+) const noexcept {
+  return std::ranges::all_of(clauses_, [&](const auto& clause) {
+    return std::visit(Overloaded{
+      [&](const MetricClause& metric_clause) {
+        return std::ranges::any_of(metric_clause.metrics, [&](const auto& m) {
+          return summary.mayContainMetric(m);
+        });
+      },
+      [&](const TagClause& tag_clause) {
+        return std::ranges::any_of(tag_clause.tags, [&](const auto& tag) {
+          return summary.mayContainTag(tag);
+        });
+      },
+      [&](const TimestampClause& timestamp_clause) {
+        return !time_range.isSet() || std::ranges::any_of(
+          timestamp_clause.timestamps,
+          [&](const auto timestamp) { return time_range.inRange(timestamp); }
+        );
+      }
+    }, clause);
+  });
+}
+
+bool KeyPredicate::mayMatch(mask_type block_mask) const noexcept {
+  return std::ranges::all_of(clauses_, [&](const auto& clause) {
+    return std::visit(Overloaded{
+      [&](const MetricClause& metric_clause) {
+        return (metric_clause.mask & block_mask) != 0;
+      },
+      [&](const TagClause& tag_clause) {
+        return (tag_clause.mask & block_mask) != 0;
+      },
+      [](const TimestampClause&) {
+        return true;
+      }
+    }, clause);
+  });
+}
+}  // namespace vkdb
@@ -0,0 +1,101 @@
+#include <vkdb/layer_index.h>
+#include <algorithm>
+#include <numeric>
+
+namespace vkdb {
+LayerIndex::LayerIndex(std::span<const TimeRange> ranges) {
+  for (size_type i{0}; i < ranges.size(); ++i) {
+    if (ranges[i].isSet()) {
+      positions_.push_back(i);
+    } else {
+      disjoint_ = false;
+    }
+  }
+  std::ranges::stable_sort(positions_, {}, [&](const auto position) {
+    return ranges[position].lower();
+  });
+
+  lowers_.reserve(positions_.size());
+  uppers_.reserve(positions_.size());
+  for (const auto position : positions_) {
+    lowers_.push_back(ranges[position].lower());
+    uppers_.push_back(ranges[position].upper());
+  }
+
+  for (size_type i{1}; i < positions_.size() && disjoint_; ++i) {
+    disjoint_ = positions_[i] == positions_[i - 1] + 1
+      && uppers_[i - 1] < lowers_[i];
+  }
+  if (!disjoint_) {
+    max_uppers_.resize(positions_.size());
+    build_tree(0, positions_.size());
+  }
+}
+
+LayerIndex::Positions LayerIndex::overlapping(
+  Timestamp start,
+  Timestamp end
+) const {
+  Positions positions;
+  if (start > end) {
+    return positions;
+  }
+
+  if (disjoint_) {
+    const auto first{std::ranges::lower_bound(uppers_, start)};
+    const auto last{std::upper_bound(
+      lowers_.begin() + (first - uppers_.begin()), lowers_.end(), end
+    )};
+    for (auto i{first - uppers_.begin()}; i < last - lowers_.begin(); ++i) {
+      positions.push_back(positions_[i]);
+    }
+    return positions;
+  }
+
+  collect(0, positions_.size(), start, end, positions);
+  std::ranges::sort(positions);
+  return positions;
+}
+
+bool LayerIndex::disjoint() const noexcept {
+  return disjoint_;
+}
+
+LayerIndex::size_type LayerIndex::size() const noexcept {
+  return positions_.size();
+}
+
+Timestamp LayerIndex::build_tree(size_type lo, size_type hi) noexcept {
+  if (lo >= hi) {
+    return 0;
+  }
+  const auto mid{lo + (hi - lo) / 2};
+  max_uppers_[mid] = std::max({
+    uppers_[mid], build_tree(lo, mid), build_tree(mid + 1, hi)
+  });
+  return max_uppers_[mid];
+}
+
+void LayerIndex::collect(
+  size_type lo,
+  size_type hi,
+  Timestamp start,
+  Timestamp end,
+  Positions& positions
+) const {
+  while (lo < hi) {
+    const auto mid{lo + (hi - lo) / 2};
+    if (max_uppers_[mid] < start) {
+      return;
+    }
+    collect(lo, mid, start, end, positions);
+    if (lowers_[mid] > end) {
+      return;
+    }
+    if (uppers_[mid] >= start) {
+      positions.push_back(positions_[mid]);
+    }
+    lo = mid + 1;
+  }
+}
+}  // namespace vkdb
@@ -0,0 +1,334 @@
+#include <vkdb/manifest.h>
+#include <vkdb/file_sync.h>
+#include <vkdb/murmur_hash_3.h>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Checksum the body of an edit.
+ * 
+ * @param body Body.
+ * @return uint32_t Checksum.
+ */
+uint32_t checksum(std::string_view body) noexcept {
+  uint32_t hash;
+  MurmurHash3_x86_32(body.data(), static_cast<int>(body.size()), 0, &hash);
+  return hash;
+}
+
+/**
+ * @brief Get the header line of the manifest file.
+ * 
+ * @return std::string Header line, with its newline.
+ */
+std::string header() {
+  return std::string{Manifest::MAGIC} + " "
+    + std::to_string(Manifest::FORMAT_VERSION) + "\n";
+}
+
+/**
+ * @brief Write data to a file descriptor and sync it.
+ * 
+ * @param fd File descriptor.
+ * @param data Data.
+ * @param caller Name of the caller, for error messages.
+ * 
+ * @throw std::runtime_error If the data cannot be written or synced.
+ */
+void write_and_sync(int fd, std::string_view data, const std::string& caller) {
+  while (!data.empty()) {
+    const auto written{::write(fd, data.data(), data.size())};
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error{caller + "(): Unable to write the manifest."};
+    }
+    data.remove_prefix(written);
+  }
+  if (::fdatasync(fd) == -1) {
+    throw std::runtime_error{caller + "(): Unable to sync the manifest."};
+  }
+}
+}  // namespace
+
+Manifest::Manifest(std::filesystem::path directory, size_type layer_count)
+  : directory_{std::move(directory)}
+  , layers_(layer_count)
+  , next_ids_(layer_count, 0) {}
+
+bool Manifest::load() {
+  version_ = 0;
+  layers_.assign(layers_.size(), {});
+  next_ids_.assign(next_ids_.size(), 0);
+  range_tombstones_.clear();
+  edit_count_ = 0;
+  if (!std::filesystem::exists(path())) {
+    return false;
+  }
+
+  std::ifstream file{path(), std::ios::binary};
+  if (!file.is_open()) {
+    throw std::runtime_error{
+      "Manifest::load(): Unable to open file " + std::string(path()) + "."
+    };
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const auto contents{buffer.str()};
+  const auto expected_header{header()};
+  if (!contents.starts_with(expected_header)) {
+    throw std::runtime_error{
+      "Manifest::load(): " + std::string(path())
+      + " is not a manifest of this format."
+    };
+  }
+
+  std::string_view edits{contents};
+  edits.remove_prefix(expected_header.size());
+  auto torn{false};
+  while (!edits.empty()) {
+    const auto end{edits.find('\n')};
+    if (end == std::string_view::npos || !apply_edit(edits.substr(0, end))) {
+      torn = true;
+      break;
+    }
+    ++edit_count_;
+    edits.remove_prefix(end + 1);
+  }
+  if (torn) {
+    rewrite(version_, layers_, next_ids_, range_tombstones_);
+    edit_count_ = 1;
+  }
+  return true;
+}
+
+void Manifest::commit(
+  const Layers& layers,
+  std::span<const size_type> next_ids,
+  const RangeTombstones& range_tombstones
+) {
+  if (layers.size() != layers_.size() || next_ids.size() != next_ids_.size()) {
+    throw std::invalid_argument{
+      "Manifest::commit(): Number of layers does not match."
+    };
+  }
+  const auto version{version_ + 1};
+  if (!std::filesystem::exists(path()) || edit_count_ >= MAX_EDITS) {
+    rewrite(version, layers, next_ids, range_tombstones);
+    edit_count_ = 1;
+  } else {
+    std::vector<bool> changed(layers.size());
+    for (size_type k{0}; k < layers.size(); ++k) {
+      changed[k] = layers[k] != layers_[k];
+    }
+    append(encode_edit(
+      version, layers, next_ids, changed,
+      range_tombstones != range_tombstones_ ? &range_tombstones : nullptr
+    ));
+    ++edit_count_;
+  }
+  version_ = version;
+  layers_ = layers;
+  next_ids_.assign(next_ids.begin(), next_ids.end());
+  range_tombstones_ = range_tombstones;
+}
+
+void Manifest::clear() noexcept {
+  std::error_code ec;
+  std::filesystem::remove(path(), ec);
+  version_ = 0;
+  layers_.assign(layers_.size(), {});
+  next_ids_.assign(next_ids_.size(), 0);
+  range_tombstones_.clear();
+  edit_count_ = 0;
+}
+
+const Manifest::Layers& Manifest::layers() const noexcept {
+  return layers_;
+}
+
+const std::vector<Manifest::size_type>& Manifest::nextIds() const noexcept {
+  return next_ids_;
+}
+
+Manifest::size_type Manifest::version() const noexcept {
+  return version_;
+}
+
+std::filesystem::path Manifest::path() const noexcept {
+  return directory_ / FILENAME;
+}
+
+const Manifest::RangeTombstones&
+Manifest::rangeTombstones() const noexcept {
+  return range_tombstones_;
+}
+
+std::string Manifest::encode_edit(
+  size_type version,
+  const Layers& layers,
+  std::span<const size_type> next_ids,
+  const std::vector<bool>& changed,
+  const RangeTombstones* range_tombstones
+) {
+  std::string body{std::to_string(version)};
+  for (const auto next_id : next_ids) {
+    body += " " + std::to_string(next_id);
+  }
+  for (size_type k{0}; k < layers.size(); ++k) {
+    if (!changed[k]) {
+      continue;
+    }
+    body += " " + std::to_string(k) + " " + std::to_string(layers[k].size());
+    for (const auto& filename : layers[k]) {
+      body += " " + filename;
+    }
+  }
+  if (range_tombstones != nullptr) {
+    body += " " + std::string{RANGE_TOMBSTONES_TOKEN} + " "
+      + std::to_string(range_tombstones->size());
+    for (const auto& [level, range_tombstone] : *range_tombstones) {
+      body += " " + std::to_string(level) + " " + range_tombstone;
+    }
+  }
+  char hex[8];
+  const auto hash{checksum(body)};
+  for (int i{0}; i < 8; ++i) {
+    hex[i] = "0123456789abcdef"[(hash >> (28 - 4 * i)) & 0xF];
+  }
+  return body + " " + std::string{hex, sizeof(hex)} + "\n";
+}
+
+bool Manifest::apply_edit(std::string_view line) {
+  const auto checksum_pos{line.rfind(' ')};
+  if (checksum_pos == std::string_view::npos) {
+    return false;
+  }
+  const auto body{line.substr(0, checksum_pos)};
+  const auto hex{line.substr(checksum_pos + 1)};
+  uint32_t expected;
+  const auto [ptr, ec]{
+    std::from_chars(hex.data(), hex.data() + hex.size(), expected, 16)
+  };
+  if (ec != std::errc{} || ptr != hex.data() + hex.size() ||
+      checksum(body) != expected) {
+    return false;
+  }
+
+  std::istringstream stream{std::string{body}};
+  size_type version;
+  if (!(stream >> version) || version <= version_) {
+    return false;
+  }
+  auto next_ids{next_ids_};
+  for (auto& next_id : next_ids) {
+    if (!(stream >> next_id)) {
+      return false;
+    }
+  }
+  auto layers{layers_};
+  auto range_tombstones{range_tombstones_};
+  std::string token;
+  while (stream >> token) {
+    size_type count;
+    if (token == RANGE_TOMBSTONES_TOKEN) {
+      if (!(stream >> count)) {
+        return false;
+      }
+      range_tombstones.clear();
+      for (size_type i{0}; i < count; ++i) {
+        size_type level;
+        std::string range_tombstone;
+        if (!(stream >> level >> range_tombstone)) {
+          return false;
+        }
+        range_tombstones.emplace_back(level, std::move(range_tombstone));
+      }
+      continue;
+    }
+    size_type k;
+    const auto [k_ptr, k_ec]{
+      std::from_chars(token.data(), token.data() + token.size(), k)
+    };
+    if (
+      k_ec != std::errc{} || k_ptr != token.data() + token.size() ||
+      k >= layers.size() || !(stream >> count)
+    ) {
+      return false;
+    }
+    layers[k].clear();
+    for (size_type i{0}; i < count; ++i) {
+      std::string filename;
+      if (!(stream >> filename)) {
+        return false;
+      }
+      layers[k].push_back(std::move(filename));
+    }
+  }
+  if (!stream.eof()) {
+    return false;
+  }
+  version_ = version;
+  layers_ = std::move(layers);
+  next_ids_ = std::move(next_ids);
+  range_tombstones_ = std::move(range_tombstones);
+  return true;
+}
+
+void Manifest::append(const std::string& edit) const {
+  const auto fd{::open(path().c_str(), O_WRONLY | O_APPEND)};
+  if (fd == -1) {
+    throw std::runtime_error{
+      "Manifest::append(): Unable to open file " + std::string(path()) + "."
+    };
+  }
+  try {
+    write_and_sync(fd, edit, "Manifest::append");
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+}
+
+void Manifest::rewrite(
+  size_type version,
+  const Layers& layers,
+  std::span<const size_type> next_ids,
+  const RangeTombstones& range_tombstones
+) const {
+  auto temp_path{path()};
+  temp_path += ".tmp";
+  const auto fd{::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+  if (fd == -1) {
+    throw std::runtime_error{
+      "Manifest::rewrite(): Unable to open file "
+      + std::string(temp_path) + "."
+    };
+  }
+  try {
+    write_and_sync(
+      fd,
+      header() + encode_edit(
+        version, layers, next_ids, std::vector<bool>(layers.size(), true),
+        range_tombstones.empty() ? nullptr : &range_tombstones
+      ),
+      "Manifest::rewrite"
+    );
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  std::filesystem::rename(temp_path, path());
+  syncDirectory(directory_);
+}
+}  // namespace vkdb
@@ -0,0 +1,72 @@
+#include <vkdb/mapped_file.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace vkdb {
+MappedFile::MappedFile(const std::filesystem::path& path)
+  : data_{nullptr}, size_{0} {
+  const auto fd{::open(path.c_str(), O_RDONLY)};
+  if (fd == -1) {
+    throw std::runtime_error{
+      "MappedFile(): Unable to open file '" + path.string() + "'."
+    };
+  }
+
+  size_ = std::filesystem::file_size(path);
+  if (size_ == 0) {
+    ::close(fd);
+    return;
+  }
+
+  auto* mapping{::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)};
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    size_ = 0;
+    throw std::runtime_error{
+      "MappedFile(): Unable to map file '" + path.string() + "'."
+    };
+  }
+  data_ = static_cast<char*>(mapping);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : data_{std::exchange(other.data_, nullptr)}
+  , size_{std::exchange(other.size_, 0)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() noexcept {
+  unmap();
+}
+
+const char* MappedFile::data() const noexcept {
+  return data_;
+}
+
+MappedFile::size_type MappedFile::size() const noexcept {
+  return size_;
+}
+
+std::string_view MappedFile::view() const noexcept {
+  return {data_, size_};
+}
+
+void MappedFile::unmap() noexcept {
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+}  // namespace vkdb
@@ -0,0 +1,134 @@
+#include <vkdb/memory_manager.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace vkdb {
+MemoryUsage::size_type MemoryUsage::total() const noexcept {
+  return mem_table_bytes + cache_bytes + index_bytes + filter_bytes
+    + series_bytes;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) noexcept {
+  mem_table_bytes += other.mem_table_bytes;
+  cache_bytes += other.cache_bytes;
+  index_bytes += other.index_bytes;
+  filter_bytes += other.filter_bytes;
+  series_bytes += other.series_bytes;
+  return *this;
+}
+
+MemoryManager::MemoryManager(size_type budget_bytes)
+  : budget_{budget_bytes} {
+  if (budget_bytes == 0) {
+    throw std::invalid_argument{
+      "MemoryManager(): Budget must be at least 1 byte."
+    };
+  }
+}
+
+MemoryManager::consumer_id MemoryManager::track(MemoryConsumer consumer) {
+  std::lock_guard lock{mutex_};
+  const auto id{next_id_++};
+  consumers_.emplace(id, std::move(consumer));
+  return id;
+}
+
+void MemoryManager::untrack(consumer_id id) noexcept {
+  std::lock_guard lock{mutex_};
+  consumers_.erase(id);
+}
+
+void MemoryManager::charge(size_type bytes) {
+  const auto slice{std::max<size_type>(budget_ / CHARGE_SLICES, 1)};
+  if (charged_.fetch_add(bytes, std::memory_order_relaxed) + bytes < slice) {
+    return;
+  }
+  std::unique_lock lock{mutex_, std::try_to_lock};
+  if (!lock.owns_lock()) {
+    return;
+  }
+  charged_.store(0, std::memory_order_relaxed);
+  rebalance_locked();
+}
+
+void MemoryManager::rebalance() {
+  std::lock_guard lock{mutex_};
+  charged_.store(0, std::memory_order_relaxed);
+  rebalance_locked();
+}
+
+MemoryUsage MemoryManager::usage() const {
+  std::lock_guard lock{mutex_};
+  MemoryUsage usage;
+  for (const auto& [id, consumer] : consumers_) {
+    usage += consumer.usage();
+  }
+  return usage;
+}
+
+MemoryManager::size_type MemoryManager::budget() const noexcept {
+  return budget_;
+}
+
+MemoryManager::size_type MemoryManager::epoch() const noexcept {
+  return epoch_.load(std::memory_order_relaxed);
+}
+
+MemoryManager::size_type MemoryManager::earlyFlushes() const noexcept {
+  return early_flushes_.load(std::memory_order_relaxed);
+}
+
+MemoryManager::size_type MemoryManager::releases() const noexcept {
+  return releases_.load(std::memory_order_relaxed);
+}
+
+void MemoryManager::rebalance_locked() {
+  epoch_.fetch_add(1, std::memory_order_relaxed);
+  struct Account {
+    MemoryConsumer* consumer;
+    MemoryUsage usage;
+    size_type last_access;
+  };
+  std::vector<Account> accounts;
+  accounts.reserve(consumers_.size());
+  size_type total{0};
+  for (auto& [id, consumer] : consumers_) {
+    accounts.push_back({&consumer, consumer.usage(), consumer.last_access()});
+    total += accounts.back().usage.total();
+  }
+  if (total <= budget_) {
+    return;
+  }
+
+  std::ranges::sort(accounts, std::ranges::greater{}, [](const auto& account) {
+    return account.usage.mem_table_bytes;
+  });
+  for (const auto& account : accounts) {
+    if (total <= budget_ || account.usage.mem_table_bytes == 0) {
+      break;
+    }
+    account.consumer->flush();
+    total -= account.usage.mem_table_bytes;
+    early_flushes_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::ranges::sort(accounts, std::ranges::less{}, [](const auto& account) {
+    return account.last_access;
+  });
+  for (const auto& account : accounts) {
+    if (total <= budget_) {
+      break;
+    }
+    const auto releasable{
+      account.usage.cache_bytes + account.usage.filter_bytes
+    };
+    if (releasable == 0) {
+      continue;
+    }
+    account.consumer->release();
+    total -= releasable;
+    releases_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+}  // namespace vkdb
@@ -0,0 +1,104 @@
+#include <vkdb/range_tombstone.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkdb {
+RangeTombstone::RangeTombstone(
+  Timestamp start,
+  Timestamp end,
+  Metric metric,
+  TagTable tags
+)
+  : start_{start}
+  , end_{end}
+  , metric_{std::move(metric)}
+  , tags_{std::move(tags)} {
+  if (start_ > end_) {
+    throw std::invalid_argument{
+      "RangeTombstone(): Start timestamp is after end timestamp."
+    };
+  }
+}
+
+RangeTombstone::RangeTombstone(const std::string& str) {
+  std::string fields[4];
+  size_t pos{0};
+  for (auto& field : fields) {
+    const auto open{str.find('{', pos)};
+    const auto close{str.find('}', open)};
+    if (open != pos || close == std::string::npos) {
+      throw std::invalid_argument{
+        "RangeTombstone(): Invalid tombstone string '" + str + "'."
+      };
+    }
+    field = str.substr(open + 1, close - open - 1);
+    pos = close + 1;
+  }
+  try {
+    start_ = std::stoull(fields[0]);
+    end_ = std::stoull(fields[1]);
+  } catch (const std::exception&) {
+    throw std::invalid_argument{
+      "RangeTombstone(): Invalid tombstone string '" + str + "'."
+    };
+  }
+  if (pos != str.size() || start_ > end_) {
+    throw std::invalid_argument{
+      "RangeTombstone(): Invalid tombstone string '" + str + "'."
+    };
+  }
+  metric_ = std::move(fields[2]);
+  std::istringstream ss{fields[3]};
+  TagKey key;
+  TagValue value;
+  while (std::getline(ss, key, ':')) {
+    std::getline(ss, value, ',');
+    tags_[key] = value;
+  }
+}
+
+bool RangeTombstone::covers(const TimeSeriesKey& key) const noexcept {
+  if (key.timestamp() < start_ || key.timestamp() > end_ ||
+      key.metric() != metric_) {
+    return false;
+  }
+  const auto& key_tags{key.tags()};
+  return std::ranges::all_of(tags_, [&key_tags](const auto& tag) {
+    const auto it{key_tags.find(tag.first)};
+    return it != key_tags.end() && it->second == tag.second;
+  });
+}
+
+bool RangeTombstone::overlaps(const TimeRange& time_range) const noexcept {
+  return time_range.overlapsWith(start_, end_);
+}
+
+Timestamp RangeTombstone::start() const noexcept {
+  return start_;
+}
+
+Timestamp RangeTombstone::end() const noexcept {
+  return end_;
+}
+
+const Metric& RangeTombstone::metric() const noexcept {
+  return metric_;
+}
+
+const TagTable& RangeTombstone::tags() const noexcept {
+  return tags_;
+}
+
+std::string RangeTombstone::str() const {
+  std::string str{"{" + std::to_string(start_) + "}{"
+    + std::to_string(end_) + "}{" + metric_ + "}{"};
+  for (const auto& [key, value] : tags_) {
+    str += key + ":" + value + ",";
+  }
+  if (!tags_.empty()) {
+    str.pop_back();
+  }
+  return str + "}";
+}
+}  // namespace vkdb
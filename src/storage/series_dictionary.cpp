@@ -0,0 +1,146 @@
+#include <vkdb/series_dictionary.h>
+#include <vkdb/murmur_hash_3.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Mix a hash into a running hash.
+ * 
+ * @param seed Running hash.
+ * @param value Hash to mix in.
+ */
+void hash_combine(size_t& seed, size_t value) noexcept {
+  seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/**
+ * @brief Hash a string with MurmurHash3.
+ * 
+ * @param str String.
+ * @return size_t Hash.
+ */
+size_t hash_string(const std::string& str) noexcept {
+  uint64_t hash[2];
+  MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), 0, hash);
+  return hash[0];
+}
+}  // namespace
+
+SeriesDictionary& SeriesDictionary::instance() noexcept {
+  static SeriesDictionary dictionary;
+  return dictionary;
+}
+
+SeriesDictionary::SeriesDictionary() {
+  auto series{std::make_unique<Series>(next_id_++, Metric{}, TagTable{}, 0)};
+  series->hash = hash(series->metric, series->tags);
+  series->counted = false;
+  empty_series_ = series.get();
+  index_.insert(empty_series_);
+  series_.emplace(series->id, std::move(series));
+}
+
+const Series& SeriesDictionary::intern(Metric&& metric, TagTable&& tags) {
+  const SeriesRef ref{metric, tags, hash(metric, tags)};
+  {
+    std::shared_lock lock{mutex_};
+    const auto it{index_.find(ref)};
+    if (it != index_.end()) {
+      acquire(**it);
+      return **it;
+    }
+  }
+
+  std::unique_lock lock{mutex_};
+  const auto it{index_.find(ref)};
+  if (it != index_.end()) {
+    acquire(**it);
+    return **it;
+  }
+  const auto id{next_id_};
+  const auto series_hash{ref.hash};
+  const auto [series_it, inserted]{series_.emplace(id, std::make_unique<Series>(
+    id, std::move(metric), std::move(tags), series_hash
+  ))};
+  auto& series{*series_it->second};
+  try {
+    index_.insert(&series);
+  } catch (...) {
+    series_.erase(series_it);
+    throw;
+  }
+  ++next_id_;
+  series.references.store(1, std::memory_order_relaxed);
+  return series;
+}
+
+void SeriesDictionary::acquire(const Series& series) noexcept {
+  if (series.counted) {
+    series.references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void SeriesDictionary::release(const Series& series) noexcept {
+  if (!series.counted) {
+    return;
+  }
+  const auto id{series.id};
+  if (series.references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  std::unique_lock lock{mutex_};
+  const auto it{series_.find(id)};
+  if (
+    it == series_.end() ||
+    it->second->references.load(std::memory_order_acquire) != 0
+  ) {
+    return;
+  }
+  index_.erase(it->second.get());
+  series_.erase(it);
+}
+
+const Series& SeriesDictionary::at(SeriesId id) const {
+  std::shared_lock lock{mutex_};
+  const auto it{series_.find(id)};
+  if (it == series_.end()) {
+    throw std::out_of_range{
+      "SeriesDictionary::at(): No series with ID " + std::to_string(id) + "."
+    };
+  }
+  return *it->second;
+}
+
+const Series& SeriesDictionary::emptySeries() const noexcept {
+  return *empty_series_;
+}
+
+size_t SeriesDictionary::size() const noexcept {
+  std::shared_lock lock{mutex_};
+  return series_.size();
+}
+
+size_t SeriesDictionary::hash(
+  const Metric& metric,
+  const TagTable& tags
+) noexcept {
+  auto seed{hash_string(metric)};
+  for (const auto& [key, value] : tags) {
+    hash_combine(seed, hash_string(key));
+    hash_combine(seed, hash_string(value));
+  }
+  return seed;
+}
+
+size_t SeriesDictionary::seriesBytes(const Series& series) noexcept {
+  auto bytes{sizeof(Series) + series.metric.size()};
+  for (const auto& [key, value] : series.tags) {
+    bytes += sizeof(TagTable::value_type) + key.size() + value.size();
+  }
+  return bytes + sizeof(decltype(series_)::value_type) + sizeof(Series*);
+}
+}  // namespace vkdb
@@ -0,0 +1,123 @@
+#include <vkdb/series_summary.h>
+#include <vkdb/murmur_hash_3.h>
+#include <vkdb/binary.h>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Seed of the hash of metrics.
+ * 
+ */
+constexpr uint32_t METRIC_SEED{0x6d657472};
+
+/**
+ * @brief Hash a string with MurmurHash3.
+ * 
+ * @param str String.
+ * @param seed Seed.
+ * @return uint32_t Hash.
+ */
+uint32_t hash_string(const std::string& str, uint32_t seed) noexcept {
+  uint32_t hash;
+  MurmurHash3_x86_32(str.data(), static_cast<int>(str.size()), seed, &hash);
+  return hash;
+}
+
+/**
+ * @brief Get the token mask with the bit picked by a hash.
+ * 
+ * @param hash Hash.
+ * @return SeriesSummary::mask_type Token mask.
+ */
+constexpr SeriesSummary::mask_type bit_mask(uint32_t hash) noexcept {
+  return SeriesSummary::mask_type{1} << (hash % 64);
+}
+}  // namespace
+
+SeriesSummary SeriesSummary::saturatedSummary() noexcept {
+  SeriesSummary summary;
+  summary.saturated_ = true;
+  return summary;
+}
+
+SeriesSummary SeriesSummary::fromBinary(const char*& pos, const char* end) {
+  SeriesSummary summary;
+  summary.saturated_ = readBinary<uint8_t>(pos, end) != 0;
+  const auto no_of_metrics{readBinary<uint32_t>(pos, end)};
+  for (uint32_t i{0}; i < no_of_metrics; ++i) {
+    summary.metrics_.emplace(readBinaryString(pos, end));
+  }
+  const auto no_of_tags{readBinary<uint32_t>(pos, end)};
+  for (uint32_t i{0}; i < no_of_tags; ++i) {
+    TagKey tag_key{readBinaryString(pos, end)};
+    TagValue tag_value{readBinaryString(pos, end)};
+    summary.tags_.emplace(std::move(tag_key), std::move(tag_value));
+  }
+  return summary;
+}
+
+void SeriesSummary::toBinary(std::string& buffer) const {
+  appendBinary(buffer, static_cast<uint8_t>(saturated_));
+  appendBinary(buffer, static_cast<uint32_t>(metrics_.size()));
+  for (const auto& metric : metrics_) {
+    appendBinary(buffer, std::string_view{metric});
+  }
+  appendBinary(buffer, static_cast<uint32_t>(tags_.size()));
+  for (const auto& [tag_key, tag_value] : tags_) {
+    appendBinary(buffer, std::string_view{tag_key});
+    appendBinary(buffer, std::string_view{tag_value});
+  }
+}
+
+void SeriesSummary::insert(const TimeSeriesKey& key) {
+  if (saturated_ || !seen_.insert(key.seriesId()).second) {
+    return;
+  }
+  metrics_.insert(key.metric());
+  for (const auto& tag : key.tags()) {
+    tags_.insert(tag);
+  }
+  if (metrics_.size() + tags_.size() > MAX_VALUES) {
+    saturate();
+  }
+}
+
+bool SeriesSummary::saturated() const noexcept {
+  return saturated_;
+}
+
+bool SeriesSummary::mayContainMetric(const Metric& metric) const noexcept {
+  return saturated_ || metrics_.contains(metric);
+}
+
+bool SeriesSummary::mayContainTag(const Tag& tag) const noexcept {
+  return saturated_ || tags_.contains(tag);
+}
+
+SeriesSummary::mask_type SeriesSummary::metricMask(
+  const Metric& metric
+) noexcept {
+  return bit_mask(hash_string(metric, METRIC_SEED));
+}
+
+SeriesSummary::mask_type SeriesSummary::tagMask(const Tag& tag) noexcept {
+  return bit_mask(hash_string(tag.second, hash_string(tag.first, 0)));
+}
+
+SeriesSummary::mask_type SeriesSummary::keyMask(
+  const TimeSeriesKey& key
+) noexcept {
+  auto mask{metricMask(key.metric())};
+  for (const auto& tag : key.tags()) {
+    mask |= tagMask(tag);
+  }
+  return mask;
+}
+
+void SeriesSummary::saturate() noexcept {
+  saturated_ = true;
+  metrics_.clear();
+  tags_.clear();
+  seen_.clear();
+}
+}  // namespace vkdb
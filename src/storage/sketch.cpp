@@ -0,0 +1,214 @@
+#include <vkdb/sketch.h>
+#include <vkdb/murmur_hash_3.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Hash bytes with MurmurHash3.
+ * 
+ * @param data Bytes.
+ * @param size Number of bytes.
+ * @return uint64_t Hash.
+ */
+uint64_t hash_bytes(const void* data, size_t size) noexcept {
+  uint64_t hash[2];
+  MurmurHash3_x64_128(data, static_cast<int>(size), 0, hash);
+  return hash[0];
+}
+}  // namespace
+
+QuantileSketch::QuantileSketch(double relative_accuracy)
+  : relative_accuracy_{relative_accuracy} {
+  if (!(relative_accuracy > 0.0 && relative_accuracy < 1.0)) {
+    throw std::invalid_argument{
+      "QuantileSketch(): Relative accuracy must be in (0, 1)."
+    };
+  }
+  gamma_ = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+  log_gamma_ = std::log(gamma_);
+}
+
+void QuantileSketch::add(double value) {
+  if (count() == 0) {
+    min_ = value;
+    max_ = value;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  const auto magnitude{std::abs(value)};
+  if (!(magnitude >= std::numeric_limits<double>::min())) {
+    ++zero_count_;
+  } else if (value > 0.0) {
+    positive_.add(index_of(magnitude), 1);
+  } else {
+    negative_.add(index_of(magnitude), 1);
+  }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  if (other.relative_accuracy_ != relative_accuracy_) {
+    throw std::invalid_argument{
+      "QuantileSketch::merge(): Relative accuracies must match."
+    };
+  }
+  const auto merge_store = [](Store& store, const Store& other_store) {
+    for (size_type i{0}; i < other_store.counts.size(); ++i) {
+      if (other_store.counts[i] != 0) {
+        store.add(
+          other_store.offset + static_cast<index_type>(i),
+          other_store.counts[i]
+        );
+      }
+    }
+  };
+  if (other.count() == 0) {
+    return;
+  }
+  if (count() == 0) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  merge_store(positive_, other.positive_);
+  merge_store(negative_, other.negative_);
+  zero_count_ += other.zero_count_;
+}
+
+double QuantileSketch::quantile(double quantile) const {
+  if (!(quantile >= 0.0 && quantile <= 1.0)) {
+    throw std::invalid_argument{
+      "QuantileSketch::quantile(): Quantile must be in [0, 1]."
+    };
+  }
+  if (count() == 0) {
+    throw std::runtime_error{
+      "QuantileSketch::quantile(): Sketch is empty."
+    };
+  }
+  if (quantile == 0.0) {
+    return min_;
+  }
+  if (quantile == 1.0) {
+    return max_;
+  }
+  const auto rank{quantile * static_cast<double>(count() - 1)};
+  const auto estimate{[&]() {
+    size_type seen{0};
+    for (auto i{negative_.counts.size()}; i-- > 0;) {
+      seen += negative_.counts[i];
+      if (static_cast<double>(seen) > rank) {
+        return -value_of(negative_.offset + static_cast<index_type>(i));
+      }
+    }
+    seen += zero_count_;
+    if (static_cast<double>(seen) > rank) {
+      return 0.0;
+    }
+    for (size_type i{0}; i < positive_.counts.size(); ++i) {
+      seen += positive_.counts[i];
+      if (static_cast<double>(seen) > rank) {
+        return value_of(positive_.offset + static_cast<index_type>(i));
+      }
+    }
+    return max_;
+  }()};
+  return std::clamp(estimate, min_, max_);
+}
+
+QuantileSketch::size_type QuantileSketch::count() const noexcept {
+  return positive_.total + negative_.total + zero_count_;
+}
+
+double QuantileSketch::relativeAccuracy() const noexcept {
+  return relative_accuracy_;
+}
+
+void QuantileSketch::Store::add(index_type index, size_type count) {
+  if (counts.empty()) {
+    offset = index;
+    counts.push_back(0);
+  } else if (index < offset) {
+    if (counts.size() >= MAX_BUCKETS) {
+      index = offset;
+    } else {
+      counts.insert(counts.begin(), offset - index, 0);
+      offset = index;
+    }
+  } else if (index - offset >= static_cast<index_type>(counts.size())) {
+    counts.resize(index - offset + 1, 0);
+  }
+  counts[index - offset] += count;
+  total += count;
+  collapse();
+}
+
+void QuantileSketch::Store::collapse() noexcept {
+  if (counts.size() <= MAX_BUCKETS) {
+    return;
+  }
+  const auto excess{counts.size() - MAX_BUCKETS};
+  for (size_type i{0}; i < excess; ++i) {
+    counts[excess] += counts[i];
+  }
+  counts.erase(counts.begin(), counts.begin() + excess);
+  offset += static_cast<index_type>(excess);
+}
+
+QuantileSketch::index_type QuantileSketch::index_of(
+  double magnitude
+) const noexcept {
+  return static_cast<index_type>(std::ceil(std::log(magnitude) / log_gamma_));
+}
+
+double QuantileSketch::value_of(index_type index) const noexcept {
+  return 2.0 * std::pow(gamma_, index) / (gamma_ + 1.0);
+}
+
+DistinctSketch::DistinctSketch() : registers_(REGISTER_COUNT, 0) {}
+
+void DistinctSketch::addHash(hash_type hash) noexcept {
+  const auto index{hash >> (64 - PRECISION)};
+  const auto rest{(hash << PRECISION) | (hash_type{1} << (PRECISION - 1))};
+  const auto rank{static_cast<uint8_t>(std::countl_zero(rest) + 1)};
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+void DistinctSketch::add(double value) noexcept {
+  if (value == 0.0) {
+    value = 0.0;
+  }
+  addHash(hash_bytes(&value, sizeof(value)));
+}
+
+void DistinctSketch::add(std::string_view str) noexcept {
+  addHash(hash_bytes(str.data(), str.size()));
+}
+
+void DistinctSketch::merge(const DistinctSketch& other) noexcept {
+  for (size_type i{0}; i < REGISTER_COUNT; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+DistinctSketch::size_type DistinctSketch::estimate() const noexcept {
+  const auto m{static_cast<double>(REGISTER_COUNT)};
+  auto sum{0.0};
+  size_type zeros{0};
+  for (const auto rank : registers_) {
+    sum += std::ldexp(1.0, -static_cast<int>(rank));
+    zeros += rank == 0;
+  }
+  auto estimate{0.7213 / (1.0 + 1.079 / m) * m * m / sum};
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return static_cast<size_type>(std::llround(estimate));
+}
+}  // namespace vkdb
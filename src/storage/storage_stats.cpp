@@ -0,0 +1,367 @@
+#include <vkdb/storage_stats.h>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <string_view>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Add a vector of per-layer stats to another, layer by layer.
+ *
+ * @param lhs Stats to add to, which grows to the layers of both.
+ * @param rhs Stats.
+ */
+void add_layers(
+  std::vector<StorageStats::size_type>& lhs,
+  const std::vector<StorageStats::size_type>& rhs
+) {
+  if (lhs.size() < rhs.size()) {
+    lhs.resize(rhs.size(), 0);
+  }
+  for (StorageStats::size_type k{0}; k < rhs.size(); ++k) {
+    lhs[k] += rhs[k];
+  }
+}
+
+/**
+ * @brief Get the ratio of two counts.
+ *
+ * @param numerator Numerator.
+ * @param denominator Denominator.
+ * @return double Ratio, or 0 if the denominator is 0.
+ */
+[[nodiscard]] double ratio(
+  StorageStats::size_type numerator,
+  StorageStats::size_type denominator
+) noexcept {
+  return denominator == 0
+    ? 0.0
+    : static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+
+/**
+ * @brief Write the summary of a latency histogram, one stat per line.
+ *
+ * @param ss Stream.
+ * @param name Name of the latency.
+ * @param histogram Histogram.
+ */
+void write_latency(
+  std::ostringstream& ss,
+  std::string_view name,
+  const HistogramSnapshot& histogram
+) {
+  ss << name << ".count " << histogram.count << "\n";
+  ss << name << ".mean_ns " << histogram.mean() << "\n";
+  ss << name << ".p50_ns " << histogram.quantile(0.5) << "\n";
+  ss << name << ".p99_ns " << histogram.quantile(0.99) << "\n";
+}
+
+/**
+ * @brief Escape a Prometheus label value.
+ *
+ * @param value Value.
+ * @return std::string Escaped value.
+ */
+[[nodiscard]] std::string escape_label(std::string_view value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const auto ch : value) {
+    if (ch == '\\' || ch == '"') {
+      escaped += '\\';
+      escaped += ch;
+    } else if (ch == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += ch;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Write the HELP and TYPE lines of a Prometheus metric family.
+ *
+ * @param ss Stream.
+ * @param name Name.
+ * @param type Type.
+ * @param help Help text.
+ */
+void write_family(
+  std::ostringstream& ss,
+  std::string_view name,
+  std::string_view type,
+  std::string_view help
+) {
+  ss << "# HELP " << name << " " << help << "\n";
+  ss << "# TYPE " << name << " " << type << "\n";
+}
+
+/**
+ * @brief Type alias for the stats of each table, by name.
+ *
+ */
+using TableStats = std::map<std::string, StorageStats>;
+
+/**
+ * @brief Write a Prometheus metric family with one sample per table.
+ *
+ * @param ss Stream.
+ * @param tables Stats of each table.
+ * @param name Name.
+ * @param type Type.
+ * @param help Help text.
+ * @param value Function that gives the value of a table's stats.
+ */
+void write_scalar(
+  std::ostringstream& ss,
+  const TableStats& tables,
+  std::string_view name,
+  std::string_view type,
+  std::string_view help,
+  const std::function<StorageStats::size_type(const StorageStats&)>& value
+) {
+  write_family(ss, name, type, help);
+  for (const auto& [table, stats] : tables) {
+    ss << name << "{table=\"" << escape_label(table) << "\"} "
+      << value(stats) << "\n";
+  }
+}
+
+/**
+ * @brief Write a Prometheus metric family with one sample per table and
+ * layer.
+ *
+ * @param ss Stream.
+ * @param tables Stats of each table.
+ * @param name Name.
+ * @param type Type.
+ * @param help Help text.
+ * @param layers Member holding the per-layer values.
+ */
+void write_layers(
+  std::ostringstream& ss,
+  const TableStats& tables,
+  std::string_view name,
+  std::string_view type,
+  std::string_view help,
+  std::vector<StorageStats::size_type> StorageStats::* layers
+) {
+  write_family(ss, name, type, help);
+  for (const auto& [table, stats] : tables) {
+    const auto& values{stats.*layers};
+    for (StorageStats::size_type k{0}; k < values.size(); ++k) {
+      ss << name << "{table=\"" << escape_label(table) << "\",layer=\"c"
+        << k << "\"} " << values[k] << "\n";
+    }
+  }
+}
+
+/**
+ * @brief Write a Prometheus histogram family with one histogram per table.
+ * @details Buckets are cumulative and in seconds, up to the highest one
+ * that holds a latency.
+ *
+ * @param ss Stream.
+ * @param tables Stats of each table.
+ * @param name Name.
+ * @param help Help text.
+ * @param histogram Member holding the histogram.
+ */
+void write_histogram(
+  std::ostringstream& ss,
+  const TableStats& tables,
+  std::string_view name,
+  std::string_view help,
+  HistogramSnapshot StorageStats::* histogram
+) {
+  write_family(ss, name, "histogram", help);
+  for (const auto& [table, stats] : tables) {
+    const auto& snapshot{stats.*histogram};
+    const auto label{escape_label(table)};
+    HistogramSnapshot::size_type last{0};
+    for (HistogramSnapshot::size_type i{0};
+         i + 1 < HistogramSnapshot::BUCKET_COUNT; ++i) {
+      if (snapshot.buckets[i] > 0) {
+        last = i;
+      }
+    }
+    HistogramSnapshot::size_type cumulative{0};
+    for (HistogramSnapshot::size_type i{0}; i <= last; ++i) {
+      cumulative += snapshot.buckets[i];
+      ss << name << "_bucket{table=\"" << label << "\",le=\""
+        << static_cast<double>(HistogramSnapshot::upperBound(i)) / 1e9
+        << "\"} " << cumulative << "\n";
+    }
+    ss << name << "_bucket{table=\"" << label << "\",le=\"+Inf\"} "
+      << snapshot.count << "\n";
+    ss << name << "_sum{table=\"" << label << "\"} "
+      << static_cast<double>(snapshot.sum) / 1e9 << "\n";
+    ss << name << "_count{table=\"" << label << "\"} "
+      << snapshot.count << "\n";
+  }
+}
+}  // namespace
+
+double StorageStats::cacheHitRatio() const noexcept {
+  return ratio(cache_hits, cache_hits + cache_misses);
+}
+
+double StorageStats::bloomFalsePositiveRate() const noexcept {
+  return ratio(
+    bloom_false_positives,
+    bloom_true_positives + bloom_false_positives
+  );
+}
+
+StorageStats& StorageStats::operator+=(const StorageStats& other) {
+  flushes += other.flushes;
+  add_layers(compactions, other.compactions);
+  add_layers(bytes_written, other.bytes_written);
+  add_layers(sstables, other.sstables);
+  bloom_negatives += other.bloom_negatives;
+  bloom_true_positives += other.bloom_true_positives;
+  bloom_false_positives += other.bloom_false_positives;
+  cache_hits += other.cache_hits;
+  cache_misses += other.cache_misses;
+  memory += other.memory;
+  wal_append_latency += other.wal_append_latency;
+  flush_latency += other.flush_latency;
+  compaction_latency += other.compaction_latency;
+  return *this;
+}
+
+std::string StorageStats::str() const {
+  std::ostringstream ss;
+  ss << "flushes " << flushes << "\n";
+  for (size_type k{0}; k < compactions.size(); ++k) {
+    ss << "compactions.c" << k << " " << compactions[k] << "\n";
+  }
+  for (size_type k{0}; k < bytes_written.size(); ++k) {
+    ss << "bytes_written.c" << k << " " << bytes_written[k] << "\n";
+  }
+  for (size_type k{0}; k < sstables.size(); ++k) {
+    ss << "sstables.c" << k << " " << sstables[k] << "\n";
+  }
+  ss << "bloom.negatives " << bloom_negatives << "\n";
+  ss << "bloom.true_positives " << bloom_true_positives << "\n";
+  ss << "bloom.false_positives " << bloom_false_positives << "\n";
+  ss << "cache.hits " << cache_hits << "\n";
+  ss << "cache.misses " << cache_misses << "\n";
+  ss << "cache.hit_ratio " << cacheHitRatio() << "\n";
+  ss << "memory.mem_table_bytes " << memory.mem_table_bytes << "\n";
+  ss << "memory.cache_bytes " << memory.cache_bytes << "\n";
+  ss << "memory.index_bytes " << memory.index_bytes << "\n";
+  ss << "memory.filter_bytes " << memory.filter_bytes << "\n";
+  ss << "memory.series_bytes " << memory.series_bytes << "\n";
+  write_latency(ss, "wal_append", wal_append_latency);
+  write_latency(ss, "flush", flush_latency);
+  write_latency(ss, "compaction", compaction_latency);
+  return ss.str();
+}
+
+StorageStats StorageMetrics::snapshot() const {
+  StorageStats stats;
+  stats.flushes = flushes.value();
+  for (const auto& counter : compactions) {
+    stats.compactions.push_back(counter.value());
+  }
+  for (const auto& counter : bytes_written) {
+    stats.bytes_written.push_back(counter.value());
+  }
+  stats.bloom_negatives = bloom_negatives.value();
+  stats.bloom_true_positives = bloom_true_positives.value();
+  stats.bloom_false_positives = bloom_false_positives.value();
+  stats.cache_hits = cache_hits.value();
+  stats.cache_misses = cache_misses.value();
+  stats.wal_append_latency = wal_append_latency.snapshot();
+  stats.flush_latency = flush_latency.snapshot();
+  stats.compaction_latency = compaction_latency.snapshot();
+  return stats;
+}
+
+std::string prometheusText(const std::map<std::string, StorageStats>& tables) {
+  std::ostringstream ss;
+  write_scalar(
+    ss, tables, "vkdb_flushes_total", "counter",
+    "Memtables flushed to C0.",
+    [](const auto& stats) { return stats.flushes; }
+  );
+  write_layers(
+    ss, tables, "vkdb_compactions_total", "counter",
+    "Compactions out of a layer.", &StorageStats::compactions
+  );
+  write_layers(
+    ss, tables, "vkdb_bytes_written_total", "counter",
+    "Bytes of SSTables written to a layer.", &StorageStats::bytes_written
+  );
+  write_layers(
+    ss, tables, "vkdb_sstables", "gauge",
+    "SSTables in a layer.", &StorageStats::sstables
+  );
+  write_scalar(
+    ss, tables, "vkdb_bloom_negatives_total", "counter",
+    "SSTable point reads ruled out by the Bloom filter.",
+    [](const auto& stats) { return stats.bloom_negatives; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_bloom_true_positives_total", "counter",
+    "SSTable point reads let through by the Bloom filter that found the key.",
+    [](const auto& stats) { return stats.bloom_true_positives; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_bloom_false_positives_total", "counter",
+    "SSTable point reads let through by the Bloom filter that missed.",
+    [](const auto& stats) { return stats.bloom_false_positives; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_cache_hits_total", "counter",
+    "Point reads answered by the read cache.",
+    [](const auto& stats) { return stats.cache_hits; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_cache_misses_total", "counter",
+    "Point reads that missed the read cache.",
+    [](const auto& stats) { return stats.cache_misses; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_mem_table_bytes", "gauge",
+    "Estimated bytes of the active and immutable memtables.",
+    [](const auto& stats) { return stats.memory.mem_table_bytes; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_cache_bytes", "gauge",
+    "Estimated bytes of the read cache.",
+    [](const auto& stats) { return stats.memory.cache_bytes; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_index_bytes", "gauge",
+    "Estimated bytes of the sparse indexes of the SSTables.",
+    [](const auto& stats) { return stats.memory.index_bytes; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_filter_bytes", "gauge",
+    "Bytes of the Bloom filters of the SSTables.",
+    [](const auto& stats) { return stats.memory.filter_bytes; }
+  );
+  write_scalar(
+    ss, tables, "vkdb_series_bytes", "gauge",
+    "Estimated bytes of the tag index and its interned series.",
+    [](const auto& stats) { return stats.memory.series_bytes; }
+  );
+  write_histogram(
+    ss, tables, "vkdb_wal_append_seconds",
+    "Latency of WAL appends.", &StorageStats::wal_append_latency
+  );
+  write_histogram(
+    ss, tables, "vkdb_flush_seconds",
+    "Latency of memtable flushes.", &StorageStats::flush_latency
+  );
+  write_histogram(
+    ss, tables, "vkdb_compaction_seconds",
+    "Latency of compactions.", &StorageStats::compaction_latency
+  );
+  return ss.str();
+}
+}  // namespace vkdb
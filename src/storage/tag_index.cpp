@@ -0,0 +1,159 @@
+#include <vkdb/tag_index.h>
+#include <vkdb/binary.h>
+#include <vkdb/file_sync.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkdb {
+TagIndex::TagIndex() : mutex_{std::make_unique<std::shared_mutex>()} {}
+
+void TagIndex::insert(const TimeSeriesKey& key) {
+  {
+    std::shared_lock lock{*mutex_};
+    if (indexed_.contains(key.seriesId())) {
+      return;
+    }
+  }
+  std::unique_lock lock{*mutex_};
+  insert_locked(key.series());
+}
+
+std::vector<SeriesId> TagIndex::seriesWithTags(const TagTable& tags) const {
+  std::shared_lock lock{*mutex_};
+  if (tags.empty()) {
+    return series_;
+  }
+  std::vector<const std::vector<SeriesId>*> lists;
+  lists.reserve(tags.size());
+  for (const auto& tag : tags) {
+    const auto it{postings_.find(tag)};
+    if (it == postings_.end()) {
+      return {};
+    }
+    lists.push_back(&it->second);
+  }
+  std::ranges::sort(lists, {}, [](const auto* list) { return list->size(); });
+
+  std::vector<SeriesId> result{*lists.front()};
+  std::vector<SeriesId> intersection;
+  for (size_t i{1}; i < lists.size() && !result.empty(); ++i) {
+    intersection.clear();
+    std::ranges::set_intersection(
+      result, *lists[i], std::back_inserter(intersection)
+    );
+    result.swap(intersection);
+  }
+  return result;
+}
+
+bool TagIndex::contains(SeriesId id) const noexcept {
+  std::shared_lock lock{*mutex_};
+  return indexed_.contains(id);
+}
+
+TagIndex::size_type TagIndex::size() const noexcept {
+  std::shared_lock lock{*mutex_};
+  return series_.size();
+}
+
+TagIndex::size_type TagIndex::bytes() const noexcept {
+  std::shared_lock lock{*mutex_};
+  return bytes_;
+}
+
+bool TagIndex::dirty() const noexcept {
+  std::shared_lock lock{*mutex_};
+  return dirty_;
+}
+
+void TagIndex::clear() noexcept {
+  std::unique_lock lock{*mutex_};
+  postings_.clear();
+  series_.clear();
+  indexed_.clear();
+  bytes_ = 0;
+  dirty_ = false;
+}
+
+void TagIndex::save(
+  const std::filesystem::path& path,
+  IOBackend backend
+) const {
+  std::unique_lock lock{*mutex_};
+  std::string buffer{MAGIC};
+  appendBinary(buffer, static_cast<uint32_t>(series_.size()));
+  const auto& dictionary{SeriesDictionary::instance()};
+  for (const auto id : series_) {
+    keyToBinary(buffer, TimeSeriesKey{0, dictionary.at(id)});
+  }
+  auto temp_path{path};
+  temp_path += ".tmp";
+  writeFile(backend, temp_path, buffer, true);
+  std::filesystem::rename(temp_path, path);
+  syncDirectory(path.parent_path());
+  dirty_ = false;
+}
+
+bool TagIndex::load(const std::filesystem::path& path) {
+  clear();
+  if (!std::filesystem::exists(path)) {
+    return false;
+  }
+  std::ifstream file{path, std::ios::binary};
+  if (!file.is_open()) {
+    return false;
+  }
+  std::stringstream stream;
+  stream << file.rdbuf();
+  const auto contents{stream.str()};
+  if (!std::string_view{contents}.starts_with(MAGIC)) {
+    return false;
+  }
+
+  std::vector<TimeSeriesKey> keys;
+  try {
+    auto pos{contents.data() + MAGIC.size()};
+    const auto end{contents.data() + contents.size()};
+    const auto no_of_series{readBinary<uint32_t>(pos, end)};
+    keys.reserve(no_of_series);
+    for (uint32_t i{0}; i < no_of_series; ++i) {
+      keys.push_back(keyFromBinary(pos, end));
+    }
+    if (pos != end) {
+      return false;
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  std::unique_lock lock{*mutex_};
+  for (const auto& key : keys) {
+    if (!indexed_.contains(key.seriesId())) {
+      insert_locked(key.series());
+    }
+  }
+  dirty_ = false;
+  return true;
+}
+
+void TagIndex::insert_locked(const Series& series) {
+  if (!indexed_.try_emplace(series.id, 0, series).second) {
+    return;
+  }
+  const auto insert_sorted = [id = series.id](std::vector<SeriesId>& ids) {
+    ids.insert(std::ranges::upper_bound(ids, id), id);
+  };
+  insert_sorted(series_);
+  for (const auto& tag : series.tags) {
+    insert_sorted(postings_[tag]);
+  }
+  bytes_ += SeriesDictionary::seriesBytes(series)
+    + sizeof(decltype(indexed_)::value_type)
+    + (series.tags.size() + 1) * sizeof(SeriesId);
+  dirty_ = true;
+}
+}  // namespace vkdb
@@ -1,6 +1,46 @@
 #include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
+#include <utility>
 
 namespace vkdb {
+namespace {
+/**
+ * @brief Get the series of MIN_TIME_SERIES_KEY.
+ * @details Interned on first use rather than read from the key, so that it
+ * is safe to use during static initialisation. Its reference is never
+ * released, so it is never removed.
+ * 
+ * @return const Series& Series.
+ */
+const Series& min_series() noexcept {
+  static const Series& series{SeriesDictionary::instance().intern(
+    "MIN_TIME_SERIES_KEY",
+    {{"MIN_TIME_SERIES_KEY", "MIN_TIME_SERIES_KEY"}}
+  )};
+  return series;
+}
+
+/**
+ * @brief Get the series of MAX_TIME_SERIES_KEY.
+ * @details Interned on first use rather than read from the key, so that it
+ * is safe to use during static initialisation. Its reference is never
+ * released, so it is never removed.
+ * 
+ * @return const Series& Series.
+ */
+const Series& max_series() noexcept {
+  static const Series& series{SeriesDictionary::instance().intern(
+    "MAX_TIME_SERIES_KEY",
+    {{"MAX_TIME_SERIES_KEY", "MAX_TIME_SERIES_KEY"}}
+  )};
+  return series;
+}
+}  // namespace
+
+TimeSeriesKey::TimeSeriesKey() noexcept
+  : timestamp_{0}
+  , series_{&SeriesDictionary::instance().emptySeries()} {}
+
 TimeSeriesKey::TimeSeriesKey(std::string&& str) {
   auto timestamp_end{str.find('}')};
   auto metric_start{str.find('{', timestamp_end) + 1};
@@ -9,31 +49,73 @@ TimeSeriesKey::TimeSeriesKey(std::string&& str) {
   auto tags_end{str.find('}', tags_start)};
 
   timestamp_ = std::stoull(str.substr(1, timestamp_end - 1));
-  metric_ = {str.substr(metric_start, metric_end - metric_start)};
+  Metric metric{str.substr(metric_start, metric_end - metric_start)};
   auto tags_str{str.substr(tags_start, tags_end - tags_start)};
 
+  TagTable tags;
   TagKey key;
   TagValue value;
   std::istringstream ss{tags_str};
   while (std::getline(ss, key, ':')) {
     std::getline(ss, value, ',');
-    tags_[key] = value;
+    tags[key] = value;
   }
+  series_ = &SeriesDictionary::instance().intern(
+    std::move(metric), std::move(tags)
+  );
 }
 
 TimeSeriesKey::TimeSeriesKey(
   Timestamp timestamp,
   Metric metric,
   TagTable tags
+)
+  : timestamp_{timestamp}
+  , series_{&SeriesDictionary::instance().intern(
+      std::move(metric), std::move(tags)
+    )} {}
+
+TimeSeriesKey::TimeSeriesKey(
+  Timestamp timestamp,
+  const Series& series
 ) noexcept
   : timestamp_{timestamp}
-  , metric_{std::move(metric)}
-  , tags_{std::move(tags)} {}
+  , series_{&series} {
+  SeriesDictionary::acquire(series);
+}
+
+TimeSeriesKey::TimeSeriesKey(TimeSeriesKey&& other) noexcept
+  : timestamp_{other.timestamp_}
+  , series_{std::exchange(
+      other.series_, &SeriesDictionary::instance().emptySeries()
+    )} {}
+
+TimeSeriesKey& TimeSeriesKey::operator=(TimeSeriesKey&& other) noexcept {
+  std::swap(timestamp_, other.timestamp_);
+  std::swap(series_, other.series_);
+  return *this;
+}
+
+TimeSeriesKey::TimeSeriesKey(const TimeSeriesKey& other) noexcept
+  : timestamp_{other.timestamp_}
+  , series_{other.series_} {
+  SeriesDictionary::acquire(*series_);
+}
+
+TimeSeriesKey& TimeSeriesKey::operator=(const TimeSeriesKey& other) noexcept {
+  SeriesDictionary::acquire(*other.series_);
+  SeriesDictionary::instance().release(*series_);
+  timestamp_ = other.timestamp_;
+  series_ = other.series_;
+  return *this;
+}
+
+TimeSeriesKey::~TimeSeriesKey() noexcept {
+  SeriesDictionary::instance().release(*series_);
+}
 
 bool TimeSeriesKey::operator==(const TimeSeriesKey& other) const noexcept {
-  return timestamp_ == other.timestamp_ &&
-         metric_ == other.metric_ &&
-         tags_ == other.tags_;
+  return timestamp_ == other.timestamp_ && series_ == other.series_;
 }
 
 bool TimeSeriesKey::operator!=(const TimeSeriesKey& other) const noexcept {
@@ -41,25 +123,28 @@ bool TimeSeriesKey::operator!=(const TimeSeriesKey& other) const noexcept {
 }
 
 bool TimeSeriesKey::operator<(const TimeSeriesKey& other) const noexcept {
-  if (other == MIN_TIME_SERIES_KEY) {
+  if (other.is_min()) {
     return false;
   }
-  if (*this == MIN_TIME_SERIES_KEY) {
+  if (is_min()) {
     return true;
   }
-  if (*this == MAX_TIME_SERIES_KEY) {
+  if (is_max()) {
     return false;
   }
-  if (other == MAX_TIME_SERIES_KEY) {
+  if (other.is_max()) {
     return true;
   }
   if (timestamp_ != other.timestamp_) {
     return timestamp_ < other.timestamp_;
   }
-  if (metric_ != other.metric_) {
-    return metric_ < other.metric_;
+  if (series_ == other.series_) {
+    return false;
+  }
+  if (series_->metric != other.series_->metric) {
+    return series_->metric < other.series_->metric;
   }
-  return tags_ < other.tags_;
+  return series_->tags < other.series_->tags;
 }
 
 bool TimeSeriesKey::operator>(const TimeSeriesKey& other) const noexcept {
@@ -78,22 +163,46 @@ Timestamp TimeSeriesKey::timestamp() const noexcept {
   return timestamp_;
 }
 
-Metric TimeSeriesKey::metric() const noexcept {
-  return metric_;
+const Metric& TimeSeriesKey::metric() const noexcept {
+  return series_->metric;
 }
 
 const TagTable& TimeSeriesKey::tags() const noexcept {
-  return tags_;
+  return series_->tags;
+}
+
+SeriesId TimeSeriesKey::seriesId() const noexcept {
+  return series_->id;
+}
+
+const Series& TimeSeriesKey::series() const noexcept {
+  return *series_;
+}
+
+size_t TimeSeriesKey::hash() const noexcept {
+  auto seed{series_->hash};
+  seed ^= std::hash<Timestamp>{}(timestamp_)
+    + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+bool TimeSeriesKey::is_min() const noexcept {
+  return timestamp_ == 0 && series_ == &min_series();
+}
+
+bool TimeSeriesKey::is_max() const noexcept {
+  return timestamp_ == std::numeric_limits<Timestamp>::max() &&
+    series_ == &max_series();
 }
 
 std::string TimeSeriesKey::str() const noexcept {
   std::stringstream ss;
   ss << "{" << std::setw(TIMESTAMP_WIDTH) << std::setfill('0');
-  ss << timestamp_ << "}{" << metric_ << "}{";
-  for (const auto& [key, value] : tags_) {
+  ss << timestamp_ << "}{" << series_->metric << "}{";
+  for (const auto& [key, value] : series_->tags) {
     ss << key << ":" << value << ",";
   }
-  ss.seekp(-!tags_.empty(), std::ios_base::end);
+  ss.seekp(-!series_->tags.empty(), std::ios_base::end);
   ss << "}";
   return ss.str();
 }
@@ -0,0 +1,92 @@
+#include <vkdb/background_worker.h>
+
+namespace vkdb {
+BackgroundWorker::BackgroundWorker() noexcept
+  : state_{std::make_unique<State>()} {}
+
+BackgroundWorker::BackgroundWorker(BackgroundWorker&& other) noexcept
+  : state_{std::make_unique<State>()} {
+  other.stop();
+}
+
+BackgroundWorker& BackgroundWorker::operator=(
+  BackgroundWorker&& other
+) noexcept {
+  if (this != &other) {
+    stop();
+    other.stop();
+  }
+  return *this;
+}
+
+BackgroundWorker::~BackgroundWorker() noexcept {
+  stop();
+}
+
+void BackgroundWorker::start(Task task) {
+  std::lock_guard lock{state_->mutex};
+  if (state_->started) {
+    return;
+  }
+  task_ = std::move(task);
+  state_->stopping = false;
+  thread_ = std::thread{[this] { run(); }};
+  state_->started = true;
+}
+
+void BackgroundWorker::schedule() noexcept {
+  {
+    std::lock_guard lock{state_->mutex};
+    state_->scheduled = true;
+  }
+  state_->changed.notify_all();
+}
+
+void BackgroundWorker::waitUntilIdle() const noexcept {
+  std::unique_lock lock{state_->mutex};
+  state_->changed.wait(lock, [this] {
+    return !state_->started || (!state_->scheduled && !state_->busy);
+  });
+}
+
+void BackgroundWorker::stop() noexcept {
+  {
+    std::lock_guard lock{state_->mutex};
+    if (!state_->started) {
+      return;
+    }
+    state_->stopping = true;
+  }
+  state_->changed.notify_all();
+  thread_.join();
+  {
+    std::lock_guard lock{state_->mutex};
+    state_->started = false;
+  }
+  state_->changed.notify_all();
+}
+
+bool BackgroundWorker::running() const noexcept {
+  std::lock_guard lock{state_->mutex};
+  return state_->started;
+}
+
+void BackgroundWorker::run() noexcept {
+  std::unique_lock lock{state_->mutex};
+  while (true) {
+    state_->changed.wait(lock, [this] {
+      return state_->scheduled || state_->stopping;
+    });
+    if (!state_->scheduled) {
+      break;
+    }
+    state_->scheduled = false;
+    state_->busy = true;
+    lock.unlock();
+    task_();
+    lock.lock();
+    state_->busy = false;
+    state_->changed.notify_all();
+  }
+}
+}  // namespace vkdb
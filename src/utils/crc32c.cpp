@@ -0,0 +1,86 @@
+#include <vkdb/crc32c.h>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define VKDB_CRC32C_SSE42
+#endif
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Reflected CRC-32C polynomial.
+ *
+ */
+constexpr uint32_t POLYNOMIAL{0x82f63b78};
+
+/**
+ * @brief Lookup table of the checksum of each byte.
+ *
+ */
+constexpr auto TABLE{[] {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t byte{0}; byte < table.size(); ++byte) {
+    auto crc{byte};
+    for (auto bit{0}; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (crc & 1 ? POLYNOMIAL : 0);
+    }
+    table[byte] = crc;
+  }
+  return table;
+}()};
+
+/**
+ * @brief Compute a checksum with the lookup table.
+ *
+ * @param data Data.
+ * @param crc Inverted checksum so far.
+ * @return uint32_t Inverted checksum.
+ */
+uint32_t crc32c_table(std::string_view data, uint32_t crc) noexcept {
+  for (const auto c : data) {
+    crc = TABLE[(crc ^ static_cast<uint8_t>(c)) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#ifdef VKDB_CRC32C_SSE42
+/**
+ * @brief Compute a checksum with the SSE4.2 crc32 instruction, eight bytes
+ * at a time.
+ *
+ * @param data Data.
+ * @param crc Inverted checksum so far.
+ * @return uint32_t Inverted checksum.
+ */
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(std::string_view data, uint32_t crc) noexcept {
+  auto pos{data.data()};
+  const auto end{data.data() + data.size()};
+  uint64_t crc64{crc};
+  for (; end - pos >= 8; pos += 8) {
+    uint64_t word;
+    std::memcpy(&word, pos, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; pos != end; ++pos) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*pos));
+  }
+  return crc;
+}
+#endif
+}  // namespace
+
+uint32_t crc32c(std::string_view data, uint32_t crc) noexcept {
+  crc = ~crc;
+#ifdef VKDB_CRC32C_SSE42
+  static const bool supported{__builtin_cpu_supports("sse4.2") != 0};
+  if (supported) {
+    return ~crc32c_sse42(data, crc);
+  }
+#endif
+  return ~crc32c_table(data, crc);
+}
+}  // namespace vkdb
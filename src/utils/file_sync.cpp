@@ -0,0 +1,57 @@
+#include <vkdb/file_sync.h>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Open a path and sync it to disk.
+ *
+ * @param path Path.
+ * @param flags Flags to open the path with.
+ * @param caller Name of the caller, for error messages.
+ *
+ * @throw std::runtime_error If the path cannot be opened or synced.
+ */
+void sync_path(
+  const std::filesystem::path& path,
+  int flags,
+  const std::string& caller
+) {
+  const auto fd{::open(path.c_str(), flags)};
+  if (fd == -1) {
+    throw std::runtime_error{
+      caller + "(): Unable to open " + std::string(path) + "."
+    };
+  }
+  const auto result{::fsync(fd)};
+  ::close(fd);
+  if (result == -1) {
+    throw std::runtime_error{
+      caller + "(): Unable to sync " + std::string(path) + "."
+    };
+  }
+}
+}  // namespace
+
+void syncFile(const std::filesystem::path& path) {
+  sync_path(path, O_RDONLY, "syncFile");
+}
+
+void syncDirectory(const std::filesystem::path& path) {
+  sync_path(path, O_RDONLY | O_DIRECTORY, "syncDirectory");
+}
+
+void linkFile(
+  const std::filesystem::path& from,
+  const std::filesystem::path& to
+) {
+  std::error_code ec;
+  std::filesystem::create_hard_link(from, to, ec);
+  if (ec) {
+    std::filesystem::copy_file(from, to);
+  }
+}
+}  // namespace vkdb
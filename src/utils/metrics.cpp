@@ -0,0 +1,100 @@
+#include <vkdb/metrics.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Next stripe to assign to a thread.
+ *
+ */
+std::atomic<Counter::size_type> next_stripe{0};
+
+/**
+ * @brief Stripe of the calling thread, assigned on first use.
+ *
+ */
+thread_local const Counter::size_type thread_stripe_index{
+  next_stripe.fetch_add(1, std::memory_order_relaxed) % Counter::STRIPE_COUNT
+};
+}  // namespace
+
+Counter::size_type Counter::value() const noexcept {
+  size_type total{0};
+  for (const auto& stripe : stripes_) {
+    total += stripe.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+Counter::size_type Counter::thread_stripe() noexcept {
+  return thread_stripe_index;
+}
+
+HistogramSnapshot::size_type HistogramSnapshot::quantile(
+  double quantile
+) const noexcept {
+  if (count == 0) {
+    return 0;
+  }
+  const auto rank{static_cast<size_type>(
+    std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count))
+  )};
+  size_type seen{0};
+  for (size_type i{0}; i < BUCKET_COUNT; ++i) {
+    seen += buckets[i];
+    if (seen >= std::max<size_type>(rank, 1)) {
+      return upperBound(i);
+    }
+  }
+  return upperBound(BUCKET_COUNT - 1);
+}
+
+double HistogramSnapshot::mean() const noexcept {
+  return count == 0
+    ? 0.0
+    : static_cast<double>(sum) / static_cast<double>(count);
+}
+
+HistogramSnapshot::size_type HistogramSnapshot::upperBound(
+  size_type bucket
+) noexcept {
+  return bucket + 1 >= BUCKET_COUNT
+    ? std::numeric_limits<size_type>::max()
+    : size_type{1} << bucket;
+}
+
+HistogramSnapshot& HistogramSnapshot::operator+=(
+  const HistogramSnapshot& other
+) noexcept {
+  for (size_type i{0}; i < BUCKET_COUNT; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+  count += other.count;
+  sum += other.sum;
+  return *this;
+}
+
+void LatencyHistogram::record(duration_type latency) noexcept {
+  const auto nanoseconds{static_cast<size_type>(
+    std::max<duration_type::rep>(latency.count(), 0)
+  )};
+  const auto bucket{std::min<size_type>(
+    std::bit_width(nanoseconds), HistogramSnapshot::BUCKET_COUNT - 1
+  )};
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const noexcept {
+  HistogramSnapshot snapshot;
+  for (size_type i{0}; i < HistogramSnapshot::BUCKET_COUNT; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+}  // namespace vkdb
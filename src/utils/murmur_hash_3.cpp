@@ -11,6 +11,7 @@
 // Platform-specific functions and macros
 
 #include <stdlib.h>
+#include <stdint.h>
 
 // Microsoft Visual Studio
 
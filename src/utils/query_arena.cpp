@@ -0,0 +1,60 @@
+#include <vkdb/query_arena.h>
+#include <memory>
+#include <new>
+
+namespace vkdb {
+namespace {
+/**
+ * @brief Buffer of the calling thread, allocated on first use.
+ *
+ */
+thread_local std::unique_ptr<std::byte[]> thread_buffer;
+
+/**
+ * @brief Whether an arena on the calling thread holds its buffer.
+ *
+ */
+thread_local bool thread_buffer_claimed{false};
+
+/**
+ * @brief Claim the buffer of the calling thread.
+ *
+ * @return std::byte* Buffer, or null if another arena holds it or it cannot
+ * be allocated.
+ */
+std::byte* claim_thread_buffer() noexcept {
+  if (thread_buffer_claimed) {
+    return nullptr;
+  }
+  if (!thread_buffer) {
+    thread_buffer.reset(new (std::nothrow) std::byte[QueryArena::BUFFER_BYTES]);
+    if (!thread_buffer) {
+      return nullptr;
+    }
+  }
+  thread_buffer_claimed = true;
+  return thread_buffer.get();
+}
+}  // namespace
+
+QueryArena::QueryArena() noexcept {
+  auto* buffer{claim_thread_buffer()};
+  owns_buffer_ = buffer != nullptr;
+  if (owns_buffer_) {
+    resource_.emplace(buffer, BUFFER_BYTES);
+  } else {
+    resource_.emplace();
+  }
+}
+
+QueryArena::~QueryArena() noexcept {
+  resource_.reset();
+  if (owns_buffer_) {
+    thread_buffer_claimed = false;
+  }
+}
+
+std::pmr::memory_resource* QueryArena::resource() noexcept {
+  return &*resource_;
+}
+}  // namespace vkdb
@@ -0,0 +1,66 @@
+#include <vkdb/thread_pool.h>
+#include <stdexcept>
+
+namespace vkdb {
+ThreadPool::ThreadPool(size_type thread_count) {
+  if (thread_count == 0) {
+    throw std::invalid_argument{
+      "ThreadPool(): Number of threads must be at least 1."
+    };
+  }
+  threads_.reserve(thread_count);
+  try {
+    for (size_type i{0}; i < thread_count; ++i) {
+      threads_.emplace_back([this] { run(); });
+    }
+  } catch (...) {
+    {
+      std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    changed_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() noexcept {
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool::size_type ThreadPool::threadCount() const noexcept {
+  return threads_.size();
+}
+
+void ThreadPool::enqueue(Task task) {
+  {
+    std::lock_guard lock{mutex_};
+    tasks_.push_back(std::move(task));
+  }
+  changed_.notify_one();
+}
+
+void ThreadPool::run() noexcept {
+  std::unique_lock lock{mutex_};
+  while (true) {
+    changed_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      break;
+    }
+    auto task{std::move(tasks_.front())};
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+}  // namespace vkdb
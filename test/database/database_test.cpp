@@ -52,11 +52,82 @@ TEST_F(DatabaseTest, CanGetTables) {
   EXPECT_TRUE(tables.contains("table2"));
 }
 
+TEST_F(DatabaseTest, OpensTablesOnFirstUse) {
+  database_->createTable("table1").addTagColumn("region");
+  database_->createTable("table2");
+  database_ = std::make_unique<Database>("test_db");
+
+  const auto tables{database_->tables()};
+  EXPECT_EQ(tables.size(), 2);
+  EXPECT_THROW(database_->createTable("table1"), std::runtime_error);
+
+  auto& table{database_->getTable("table1")};
+  EXPECT_EQ(&table, &database_->getTable("table1"));
+  EXPECT_EQ(table.tagColumns().size(), 1);
+  EXPECT_EQ(database_->tables().size(), 2);
+
+  database_->dropTable("table2");
+  EXPECT_FALSE(std::filesystem::exists(database_->path() / "table2"));
+  EXPECT_THROW(std::ignore = database_->getTable("table2"), std::runtime_error);
+  EXPECT_EQ(database_->tables(), std::vector<TableName>{"table1"});
+}
+
+TEST_F(DatabaseTest, SharesBlockCacheAcrossTables) {
+  ASSERT_NE(database_->blockCache(), nullptr);
+  auto& table1{database_->createTable("table1")};
+  auto& table2{database_->createTable("table2")};
+  std::vector<DataPoint<double>> datapoints;
+  for (Timestamp i{0}; i < 12'000; ++i) {
+    datapoints.push_back({i, "temperature", {}, static_cast<double>(i)});
+  }
+  table1.putBatch(datapoints);
+  table2.putBatch(datapoints);
+
+  const auto query{[](Table& table) {
+    return table.query().whereTimestampBetween(0, 11'999).sum();
+  }};
+  EXPECT_DOUBLE_EQ(query(table1), 11'999.0 * 12'000 / 2);
+  const auto blocks{database_->blockCache()->size()};
+  EXPECT_GT(blocks, 0);
+  EXPECT_DOUBLE_EQ(query(table2), 11'999.0 * 12'000 / 2);
+  EXPECT_GT(database_->blockCache()->size(), blocks);
+}
+
+TEST_F(DatabaseTest, CanDisableBlockCache) {
+  Database database{"test_db", DatabaseOptions{.block_cache_bytes = 0}};
+  EXPECT_EQ(database.blockCache(), nullptr);
+}
+
+TEST_F(DatabaseTest, CanCreateTableWithOptions) {
+  database_->createTable("sensor_data", {.mem_table_max_entries = 50});
+  database_ = std::make_unique<Database>("test_db");
+
+  const auto options{database_->getTable("sensor_data").options()};
+  EXPECT_EQ(options.mem_table_max_entries, 50);
+  EXPECT_EQ(options.block_cache, database_->blockCache());
+}
+
 TEST_F(DatabaseTest, CanRunCreateQuery) {
   database_->run("CREATE TABLE table TAGS tag;");
   EXPECT_NO_THROW(std::ignore = database_->getTable("table"));
 }
 
+TEST_F(DatabaseTest, CanRunCreateQueryWithValueType) {
+  database_->run("CREATE TABLE counters TYPE INT32;");
+  database_ = std::make_unique<Database>("test_db");
+  auto& table{database_->getTable("counters")};
+  EXPECT_EQ(table.valueType(), ValueType::INT32);
+
+  database_->run("PUT requests 1 3 INTO counters;");
+  database_->run("PUT requests 2 4 INTO counters;");
+  std::stringstream result;
+  database_->run("SELECT SUM requests FROM counters ALL;", result);
+  EXPECT_EQ(result.str(), std::to_string(7.0) + "\n");
+
+  database_->run("CREATE TABLE labels TYPE STRING;");
+  EXPECT_THROW(std::ignore = database_->getTable("labels"), std::runtime_error);
+}
+
 TEST_F(DatabaseTest, CanRunDropQuery) {
   database_->run("CREATE TABLE table TAGS tag;");
   database_->run("DROP TABLE table;");
@@ -251,6 +322,90 @@ TEST_F(DatabaseTest, CanRunSelectAggregateAllQuery) {
   EXPECT_DOUBLE_EQ(std::stod(result.str()), 20.0);
 }
 
+TEST_F(DatabaseTest, CanRunQueriesAsync) {
+  database_->createTable("sensor_data");
+  auto& table{database_->getTable("sensor_data")};
+  table.query().put(1, "temperature", {}, 20.0).execute();
+  table.query().put(2, "temperature", {}, 30.0).execute();
+
+  std::stringstream first;
+  std::stringstream second;
+  auto first_run{database_->runAsync(
+    "SELECT MIN temperature FROM sensor_data ALL;", first
+  )};
+  auto second_run{database_->runAsync(
+    "SELECT MAX temperature FROM sensor_data ALL;", second
+  )};
+  syncWait(std::move(first_run));
+  syncWait(std::move(second_run));
+
+  EXPECT_DOUBLE_EQ(std::stod(first.str()), 20.0);
+  EXPECT_DOUBLE_EQ(std::stod(second.str()), 30.0);
+}
+
+TEST_F(DatabaseTest, CanExecutePreparedStatement) {
+  database_->createTable("sensor_data");
+  auto& table{database_->getTable("sensor_data")};
+  table.addTagColumn("id");
+  for (Timestamp i{0}; i < 10; ++i) {
+    table.query()
+      .put(i, "temperature", {{"id", "one"}}, static_cast<double>(i))
+      .execute();
+  }
+
+  const auto statement{database_->prepare(
+    "SELECT SUM temperature FROM sensor_data BETWEEN ? AND ? WHERE id=?;"
+  )};
+  ASSERT_EQ(statement->parameterCount(), 3);
+
+  std::stringstream first;
+  const std::vector<Parameter> first_parameters{0, 4, "one"};
+  database_->execute(*statement, first_parameters, first);
+  EXPECT_DOUBLE_EQ(std::stod(first.str()), 10.0);
+
+  std::stringstream second;
+  const std::vector<Parameter> second_parameters{5, 9, "one"};
+  database_->execute(*statement, second_parameters, second);
+  EXPECT_DOUBLE_EQ(std::stod(second.str()), 35.0);
+
+  std::stringstream put;
+  const std::vector<Parameter> put_parameters{10, 2.5};
+  database_->execute(
+    *database_->prepare("PUT temperature ? ? INTO sensor_data TAGS id=one;"),
+    put_parameters,
+    put
+  );
+  EXPECT_DOUBLE_EQ(
+    table.query().whereTimestampIs(10).whereMetricIs("temperature").sum(),
+    2.5
+  );
+}
+
+TEST_F(DatabaseTest, CachesPreparedStatements) {
+  const auto source{"SELECT DATA temperature FROM sensor_data AT ?;"};
+
+  EXPECT_EQ(database_->prepare(source), database_->prepare(source));
+}
+
+TEST_F(DatabaseTest, ThrowsWhenPreparingInvalidStatement) {
+  EXPECT_THROW(
+    std::ignore = database_->prepare("SELECT DATA FROM sensor_data ALL;"),
+    std::runtime_error
+  );
+}
+
+TEST_F(DatabaseTest, ThrowsWhenExecutingWithWrongParameterCount) {
+  const auto statement{database_->prepare(
+    "SELECT DATA temperature FROM sensor_data AT ?;"
+  )};
+
+  std::stringstream result;
+  EXPECT_THROW(
+    database_->execute(*statement, {}, result),
+    std::invalid_argument
+  );
+}
+
 TEST_F(DatabaseTest, CanRunSelectAggregateAllWhereQuery) {
   database_->createTable("sensor_data");
   auto& table{database_->getTable("sensor_data")};
@@ -341,6 +496,179 @@ TEST_F(DatabaseTest, CanRunSelectAggregateAtWhereQuery) {
   EXPECT_DOUBLE_EQ(std::stod(result.str()), 25.0);
 }
 
+TEST_F(DatabaseTest, CanRunSelectAggregatesAllQuery) {
+  database_->createTable("sensor_data");
+  auto& table{database_->getTable("sensor_data")};
+
+  table.query()
+    .put(1, "temperature", {}, 20.0)
+    .execute();
+
+  table.query()
+    .put(2, "temperature", {}, 25.0)
+    .execute();
+
+  std::stringstream result;
+  database_->run(
+    "SELECT COUNT, AVG, MIN, MAX temperature FROM sensor_data ALL;",
+    result
+  );
+
+  EXPECT_EQ(
+    result.str(),
+    "[" + std::to_string(2.0) + "," + std::to_string(22.5) + ","
+      + std::to_string(20.0) + "," + std::to_string(25.0) + "]\n"
+  );
+}
+
+TEST_F(DatabaseTest, CanRunOrderedAndLimitedSelectDataQueries) {
+  database_->createTable("sensor_data");
+  auto& table{database_->getTable("sensor_data")};
+  for (Timestamp i{1}; i <= 5; ++i) {
+    table.query()
+      .put(i, "temperature", {}, static_cast<double>((i * 3) % 5))
+      .execute();
+  }
+
+  std::stringstream newest;
+  database_->run(
+    "SELECT DATA temperature FROM sensor_data ALL ORDER BY TIMESTAMP DESC "
+    "LIMIT 2;",
+    newest
+  );
+  std::vector<DataPoint<double>> expected_newest{
+    {5, "temperature", {}, 0.0}, {4, "temperature", {}, 2.0}
+  };
+  EXPECT_EQ(
+    newest.str(),
+    datapointsToString<double>(expected_newest) + "\n"
+  );
+
+  std::stringstream highest;
+  database_->run(
+    "SELECT DATA temperature FROM sensor_data BETWEEN 1 AND 5 "
+    "ORDER BY VALUE DESC LIMIT 1;",
+    highest
+  );
+  std::vector<DataPoint<double>> expected_highest{
+    {3, "temperature", {}, 4.0}
+  };
+  EXPECT_EQ(
+    highest.str(),
+    datapointsToString<double>(expected_highest) + "\n"
+  );
+
+  std::stringstream first;
+  database_->run("SELECT DATA temperature FROM sensor_data ALL LIMIT 1;", first);
+  std::vector<DataPoint<double>> expected_first{
+    {1, "temperature", {}, 3.0}
+  };
+  EXPECT_EQ(first.str(), datapointsToString<double>(expected_first) + "\n");
+
+  EXPECT_THROW(
+    std::ignore = database_->prepare(
+      "SELECT AVG temperature FROM sensor_data ALL LIMIT 1;"
+    ),
+    std::runtime_error
+  );
+}
+
+TEST_F(DatabaseTest, CanRunSelectLastQueries) {
+  database_->run("CREATE TABLE sensor_data TAGS city;");
+  auto& table{database_->getTable("sensor_data")};
+  for (Timestamp i{1}; i <= 6; ++i) {
+    const auto city{i % 2 == 0 ? "london" : "paris"};
+    table.query()
+      .put(i, "temperature", {{"city", city}}, static_cast<double>(i))
+      .execute();
+  }
+
+  std::stringstream all;
+  database_->run("SELECT LAST temperature FROM sensor_data ALL;", all);
+  std::vector<DataPoint<double>> expected_all{
+    {5, "temperature", {{"city", "paris"}}, 5.0},
+    {6, "temperature", {{"city", "london"}}, 6.0}
+  };
+  EXPECT_EQ(all.str(), datapointsToString<double>(expected_all) + "\n");
+
+  std::stringstream earlier;
+  database_->run(
+    "SELECT LAST temperature FROM sensor_data BETWEEN 1 AND 4 "
+    "WHERE city=paris;",
+    earlier
+  );
+  std::vector<DataPoint<double>> expected_earlier{
+    {3, "temperature", {{"city", "paris"}}, 3.0}
+  };
+  EXPECT_EQ(
+    earlier.str(),
+    datapointsToString<double>(expected_earlier) + "\n"
+  );
+
+  EXPECT_THROW(
+    std::ignore = database_->prepare(
+      "SELECT LAST, AVG temperature FROM sensor_data ALL;"
+    ),
+    std::runtime_error
+  );
+}
+
+TEST_F(DatabaseTest, CanWriteDataPointsAsCSV) {
+  database_ = std::make_unique<Database>(
+    "test_db", DatabaseOptions{.output_format = OutputFormat::CSV}
+  );
+  database_->createTable("sensor_data");
+  database_->getTable("sensor_data").query()
+    .put(1, "temperature", {}, 20.5)
+    .execute();
+
+  std::stringstream output;
+  database_->run(
+    "SELECT DATA temperature FROM sensor_data ALL;"
+    "SELECT COUNT temperature FROM sensor_data ALL;",
+    output
+  );
+  EXPECT_EQ(
+    output.str(),
+    "timestamp,metric,tags,value\n1,temperature,,20.5\n1\n"
+  );
+}
+
+TEST_F(DatabaseTest, CanRunSelectPercentileAndApproxCountDistinctQueries) {
+  database_->createTable("sensor_data");
+  auto& table{database_->getTable("sensor_data")};
+
+  for (Timestamp i{1}; i <= 100; ++i) {
+    table.query()
+      .put(i, "latency", {}, static_cast<double>(i % 10))
+      .execute();
+  }
+
+  std::stringstream percentile;
+  database_->run(
+    "SELECT PERCENTILE 90 latency FROM sensor_data ALL;",
+    percentile
+  );
+  EXPECT_NEAR(std::stod(percentile.str()), 8.0, 0.08);
+
+  std::stringstream distinct;
+  database_->run(
+    "SELECT APPROX_COUNT_DISTINCT latency FROM sensor_data ALL;",
+    distinct
+  );
+  EXPECT_EQ(distinct.str(), "10\n");
+
+  std::stringstream percentiles;
+  database_->run(
+    "SELECT PERCENTILE 0, 100 latency FROM sensor_data BETWEEN 1 AND 9;",
+    percentiles
+  );
+  EXPECT_EQ(
+    percentiles.str(),
+    "[" + std::to_string(1.0) + "," + std::to_string(9.0) + "]\n"
+  );
+}
+
 TEST_F(DatabaseTest, CanPutDataWithoutTags) {
   database_->createTable("sensor_data");
   database_->run("PUT temperature 10 20.0 INTO sensor_data;");
@@ -367,6 +695,71 @@ TEST_F(DatabaseTest, CanPutDataWithTags) {
   EXPECT_DOUBLE_EQ(result[0].value, 20.0);
 }
 
+TEST_F(DatabaseTest, CanPutManyRowsOfOneSeries) {
+  database_->createTable("sensor_data").addTagColumn("location");
+  database_->run(
+    "PUT temperature INTO sensor_data TAGS location=room1 "
+    "VALUES (1, 20.1), (2, 20.3), (3, 20.5);"
+  );
+
+  auto result{database_->getTable("sensor_data").query()
+    .whereTimestampBetween(1, 3)
+    .whereMetricIs("temperature")
+    .whereTagsContain({"location", "room1"})
+    .execute()
+  };
+
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_DOUBLE_EQ(result[0].value, 20.1);
+  EXPECT_DOUBLE_EQ(result[1].value, 20.3);
+  EXPECT_DOUBLE_EQ(result[2].value, 20.5);
+}
+
+TEST_F(DatabaseTest, CanPutManyRowsWithPlaceholders) {
+  database_->createTable("sensor_data");
+  const auto statement{database_->prepare(
+    "PUT temperature INTO sensor_data VALUES (?, ?), (?, ?);"
+  )};
+  ASSERT_EQ(statement->parameterCount(), 4);
+
+  std::stringstream output;
+  const std::vector<Parameter> parameters{1, 2.5, 2, 3.5};
+  database_->execute(*statement, parameters, output);
+
+  EXPECT_DOUBLE_EQ(
+    database_->getTable("sensor_data").query()
+      .whereTimestampBetween(1, 2)
+      .whereMetricIs("temperature")
+      .sum(),
+    6.0
+  );
+}
+
+TEST_F(DatabaseTest, ThrowsWhenPuttingManyRowsWithInvalidTags) {
+  database_->createTable("sensor_data");
+  std::stringstream output;
+  database_->run(
+    "PUT temperature INTO sensor_data TAGS location=room1 VALUES (1, 20.1);",
+    output
+  );
+
+  EXPECT_TRUE(database_->getTable("sensor_data").query()
+    .whereTimestampIs(1)
+    .execute()
+    .empty()
+  );
+}
+
+TEST_F(DatabaseTest, ReportsRuntimeErrorWhenSelectingFromMissingTable) {
+  std::stringstream output;
+  database_->run(
+    "SELECT DATA temperature FROM missing ALL;"
+    "TABLES;",
+    output
+  );
+  EXPECT_TRUE(output.str().empty());
+}
+
 TEST_F(DatabaseTest, CanDeleteDataWithoutTags) {
   database_->createTable("sensor_data");
   database_->run("PUT temperature 10 20.0 INTO sensor_data;");
@@ -391,4 +784,69 @@ TEST_F(DatabaseTest, CanDeleteDataWithTags) {
   };
 
   EXPECT_TRUE(result.empty());
-}
\ No newline at end of file
+}
+
+TEST_F(DatabaseTest, KeepsTablesWithinMemoryBudget) {
+  database_ = std::make_unique<Database>(
+    "test_db",
+    DatabaseOptions{.memory_budget_bytes = 16 << 10}
+  );
+  const auto manager{database_->memoryManager()};
+  ASSERT_NE(manager, nullptr);
+  std::vector<DataPoint<double>> datapoints;
+  for (Timestamp i{0}; i < 100; ++i) {
+    datapoints.push_back({i, "temperature", {}, static_cast<double>(i)});
+  }
+  for (const auto table_name : {"table1", "table2", "table3", "table4"}) {
+    auto& table{database_->createTable(table_name)};
+    EXPECT_EQ(table.options().memory_manager, manager);
+    for (const auto& datapoint : datapoints) {
+      table.putBatch(std::span{&datapoint, 1});
+    }
+  }
+  EXPECT_GT(manager->earlyFlushes(), 0);
+  EXPECT_LE(manager->usage().mem_table_bytes, manager->budget());
+  EXPECT_GT(database_->stats().at("table1").memory.index_bytes, 0);
+  EXPECT_DOUBLE_EQ(
+    database_->getTable("table1").query()
+      .whereTimestampBetween(0, 99).sum(),
+    99.0 * 100 / 2
+  );
+
+  database_->dropTable("table1");
+  EXPECT_EQ(database_->stats().size(), 3);
+  EXPECT_NO_THROW(manager->rebalance());
+}
+
+TEST_F(DatabaseTest, CanOpenACheckpointAsADatabase) {
+  std::vector<DataPoint<double>> datapoints;
+  for (Timestamp i{0}; i < 2'500; ++i) {
+    datapoints.push_back({i, "temperature", {}, static_cast<double>(i)});
+  }
+  database_->createTable("table1").putBatch(datapoints);
+  database_->createTable("table2").putBatch(std::span{datapoints}.first(10));
+  database_ = std::make_unique<Database>("test_db");
+  auto& table1{database_->getTable("table1")};
+
+  const auto checkpoint_path{DATABASE_DIRECTORY / "test_db_checkpoint"};
+  std::filesystem::remove_all(checkpoint_path);
+  database_->checkpoint(checkpoint_path);
+  table1.putBatch(std::span{datapoints}.first(10));
+  table1.putBatch(std::vector<DataPoint<double>>{
+    {2'500, "temperature", {}, 2'500.0}
+  });
+  EXPECT_THROW(database_->checkpoint(checkpoint_path), std::runtime_error);
+
+  Database checkpoint{"test_db_checkpoint"};
+  EXPECT_EQ(
+    checkpoint.getTable("table1").query()
+      .whereTimestampBetween(0, 10'000).count(),
+    2'500
+  );
+  EXPECT_EQ(
+    checkpoint.getTable("table2").query()
+      .whereTimestampBetween(0, 10'000).count(),
+    10
+  );
+  checkpoint.clear();
+}
@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include <vkdb/importer.h>
+#include <sstream>
+
+using namespace vkdb;
+
+class ImporterTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    table_ = std::make_unique<Table>("test_db", "table");
+    table_->addTagColumn("region");
+  }
+
+  void TearDown() override {
+    table_->clear();
+  }
+
+  std::unique_ptr<Table> table_;
+};
+
+TEST_F(ImporterTest, CanImportLineProtocol) {
+  std::stringstream input{
+    "# weather\n"
+    "weather,region=eu temperature=20.5,humidity=40i 1\n"
+    "weather,region=eu temperature=21.5,humidity=41i 2\n"
+    "\n"
+    "power value=t 1\n"
+  };
+
+  Importer importer{*table_};
+  const auto stats{importer.run(input)};
+  EXPECT_EQ(stats.lines, 5);
+  EXPECT_EQ(stats.entries, 5);
+
+  EXPECT_DOUBLE_EQ(table_->query()
+    .whereTimestampBetween(1, 2)
+    .whereMetricIs("weather_temperature")
+    .whereTagsContain({"region", "eu"})
+    .sum(),
+    42.0
+  );
+  EXPECT_DOUBLE_EQ(table_->query()
+    .whereTimestampIs(2)
+    .whereMetricIs("weather_humidity")
+    .sum(),
+    41.0
+  );
+  EXPECT_DOUBLE_EQ(table_->query()
+    .whereTimestampIs(1)
+    .whereMetricIs("power")
+    .sum(),
+    1.0
+  );
+}
+
+TEST_F(ImporterTest, CanImportCSV) {
+  std::stringstream input{
+    "timestamp,metric,tags,value\n"
+    "1,temperature,region=eu,20.5\n"
+    "2,temperature,,21.5\n"
+  };
+
+  Importer importer{*table_, {.format = ImportFormat::CSV}};
+  EXPECT_EQ(importer.run(input).entries, 2);
+
+  auto result{table_->query()
+    .whereTimestampBetween(1, 2)
+    .whereMetricIs("temperature")
+    .execute()
+  };
+  ASSERT_EQ(result.size(), 2);
+  EXPECT_EQ(result[0].tags, (TagTable{{"region", "eu"}}));
+  EXPECT_DOUBLE_EQ(result[1].value, 21.5);
+}
+
+TEST_F(ImporterTest, CanImportManyChunksInAnyOrder) {
+  std::stringstream input;
+  for (Timestamp i{0}; i < 20'000; ++i) {
+    input << "temperature,region=eu value=1 " << (i * 7'919) % 20'000 << '\n';
+  }
+  input << "temperature,region=eu value=5 0\n";
+
+  Importer importer{*table_, {.chunk_entries = 5'000, .sort_threads = 4}};
+  EXPECT_EQ(importer.run(input).entries, 20'001);
+
+  EXPECT_EQ(table_->query()
+    .whereTimestampBetween(0, 19'999)
+    .whereMetricIs("temperature")
+    .count(),
+    20'000
+  );
+  EXPECT_DOUBLE_EQ(table_->query()
+    .whereTimestampIs(0)
+    .whereMetricIs("temperature")
+    .sum(),
+    5.0
+  );
+}
+
+TEST_F(ImporterTest, KeepsLastOfDuplicateKeysInAChunk) {
+  std::stringstream input{
+    "temperature value=1 1\n"
+    "temperature value=2 1\n"
+  };
+
+  Importer importer{*table_};
+  EXPECT_EQ(importer.run(input).entries, 1);
+  EXPECT_DOUBLE_EQ(table_->query()
+    .whereTimestampIs(1)
+    .whereMetricIs("temperature")
+    .sum(),
+    2.0
+  );
+}
+
+TEST_F(ImporterTest, ThrowsOnMalformedLines) {
+  const auto import{[this](const std::string& data, ImportFormat format) {
+    std::stringstream input{data};
+    Importer importer{*table_, {.format = format}};
+    std::ignore = importer.run(input);
+  }};
+
+  EXPECT_THROW(
+    import("temperature value=1\n", ImportFormat::LINE_PROTOCOL),
+    std::runtime_error
+  );
+  EXPECT_THROW(
+    import("temperature value=\"a\" 1\n", ImportFormat::LINE_PROTOCOL),
+    std::runtime_error
+  );
+  EXPECT_THROW(
+    import("temperature,city=x value=1 1\n", ImportFormat::LINE_PROTOCOL),
+    std::runtime_error
+  );
+  EXPECT_THROW(
+    import("1,temperature,,20.5\n", ImportFormat::CSV),
+    std::runtime_error
+  );
+  EXPECT_THROW(
+    import("timestamp,metric,tags,value\nx,temperature,,1\n", ImportFormat::CSV),
+    std::runtime_error
+  );
+}
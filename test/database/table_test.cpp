@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include <vkdb/table.h>
+#include <atomic>
+#include <thread>
 
 using namespace vkdb;
 
@@ -49,6 +51,57 @@ TEST_F(TableTest, CanQueryData) {
   EXPECT_DOUBLE_EQ(result, 2'500.0);
 }
 
+TEST_F(TableTest, CanPutBatch) {
+  ASSERT_NO_THROW(table_->addTagColumn("region"));
+
+  std::vector<DataPoint<double>> datapoints;
+  for (Timestamp i{0}; i < 10'000; ++i) {
+    datapoints.push_back({i, "temperature", {{"region", "ldn"}}, 0.5 * i});
+  }
+  table_->putBatch(datapoints);
+
+  auto result{table_->query()
+    .whereTimestampBetween(2'500, 7'500)
+    .whereMetricIs("temperature")
+    .whereTagsContain({"region", "ldn"})
+    .avg()
+  };
+
+  EXPECT_DOUBLE_EQ(result, 2'500.0);
+}
+
+TEST_F(TableTest, ThrowsWhenPuttingBatchWithInvalidTags) {
+  std::vector<DataPoint<double>> datapoints{
+    {0, "temperature", {{"tag1", "a"}}, 1.0},
+    {1, "temperature", {{"region", "ldn"}}, 2.0}
+  };
+
+  EXPECT_THROW(table_->putBatch(datapoints), std::runtime_error);
+  EXPECT_TRUE(table_->query().whereTimestampBetween(0, 1).execute().empty());
+}
+
+TEST_F(TableTest, CanPutBatchOfOneSeries) {
+  ASSERT_NO_THROW(table_->addTagColumn("region"));
+
+  std::vector<std::pair<Timestamp, double>> rows;
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    rows.emplace_back(i, 1.0);
+  }
+  table_->putBatch("temperature", TagTable{{"region", "ldn"}}, rows);
+
+  EXPECT_EQ(table_->query()
+    .whereTimestampBetween(0, 999)
+    .whereMetricIs("temperature")
+    .whereTagsContain({"region", "ldn"})
+    .count(),
+    1'000
+  );
+  EXPECT_THROW(
+    table_->putBatch("temperature", TagTable{{"device", "a"}}, rows),
+    std::runtime_error
+  );
+}
+
 TEST_F(TableTest, CanQueryDataWithMultipleMetrics) {
   ASSERT_NO_THROW(table_->addTagColumn("region"));
 
@@ -97,8 +150,186 @@ TEST_F(TableTest, CanQueryDataWithMultipleMetricsAndTags) {
   EXPECT_DOUBLE_EQ(result, 1'875.0);
 }
 
+TEST_F(TableTest, CanQueryDataConcurrently) {
+  ASSERT_NO_THROW(table_->addTagColumn("region"));
+
+  std::atomic<bool> done{false};
+  std::atomic<bool> failed{false};
+  std::thread writer{[&] {
+    for (Timestamp i{0}; i < 5'000; ++i) {
+      table_->query()
+        .put(i, "temperature", {{"region", "ldn"}}, 1.0)
+        .execute();
+    }
+    done = true;
+  }};
+
+  std::vector<std::thread> readers;
+  for (auto r{0}; r < 3; ++r) {
+    readers.emplace_back([&] {
+      while (!done) {
+        try {
+          const auto result{table_->query()
+            .whereMetricIs("temperature")
+            .whereTagsContain({"region", "ldn"})
+            .avg()
+          };
+          if (result != 1.0) {
+            failed = true;
+          }
+        } catch (const std::exception&) {
+          // No data has been written yet.
+        }
+      }
+    });
+  }
+
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_FALSE(failed);
+  EXPECT_DOUBLE_EQ(table_->query().whereMetricIs("temperature").sum(), 5'000.0);
+}
+
+TEST_F(TableTest, CanQueryDataAsync) {
+  ASSERT_NO_THROW(table_->addTagColumn("region"));
+
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    table_->query()
+      .put(i, "temperature", {{"region", "ldn"}}, 1.0)
+      .execute();
+  }
+
+  ThreadPool pool{2};
+  const auto query{[&]() -> Task<size_t> {
+    const auto first{co_await table_->query()
+      .whereTimestampBetween(0, 499)
+      .executeAsync(pool)
+    };
+    const auto second{co_await table_->query()
+      .whereTimestampBetween(500, 999)
+      .executeAsync()
+    };
+    co_return first.size() + second.size();
+  }};
+
+  EXPECT_EQ(syncWait(query()), 1'000);
+}
+
+TEST_F(TableTest, SavesOptionsWithTable) {
+  {
+    Table tuned{"test_db", "tuned", TableOptions{
+      .mem_table_max_entries = 50,
+      .layer_window_sizes = {0, 60, 3600, 86400, 604800, 2592000, 7776000,
+        31536000},
+      .bloom_filter_false_positive_rate = 0.05,
+      .rollups = true,
+      .compression = Compression::LZ4,
+      .wal = {
+        .sync_policy = WALSyncPolicy::BYTES,
+        .sync_bytes = 4'096,
+        .format = WALFormat::BINARY
+      }
+    }};
+  }
+  Table tuned{"test_db", "tuned"};
+  const auto options{tuned.options()};
+  EXPECT_EQ(options.mem_table_max_entries, 50);
+  EXPECT_EQ(options.layer_window_sizes[1], 60);
+  EXPECT_DOUBLE_EQ(options.bloom_filter_false_positive_rate, 0.05);
+  EXPECT_TRUE(options.rollups);
+  EXPECT_EQ(options.compression, Compression::LZ4);
+  EXPECT_EQ(options.wal.sync_policy, WALSyncPolicy::BYTES);
+  EXPECT_EQ(options.wal.sync_bytes, 4'096);
+  EXPECT_EQ(options.wal.format, WALFormat::BINARY);
+  EXPECT_EQ(options.cache_capacity, TableOptions{}.cache_capacity);
+  std::filesystem::remove_all(tuned.path());
+}
+
+TEST_F(TableTest, CanShardSeriesAcrossLSMTrees) {
+  {
+    Table sharded{"test_db", "sharded", TableOptions{.shards = 4}};
+    sharded.addTagColumn("region");
+    for (Timestamp i{0}; i < 1'000; ++i) {
+      for (const auto* region : {"ldn", "nyc", "sfo", "tyo"}) {
+        sharded.query()
+          .put(i, "temperature", {{"region", region}}, 1.0)
+          .execute();
+      }
+    }
+    EXPECT_EQ(sharded.options().shards, 4);
+  }
+  Table sharded{"test_db", "sharded"};
+  EXPECT_EQ(sharded.options().shards, 4);
+  EXPECT_DOUBLE_EQ(sharded.query().whereMetricIs("temperature").sum(), 4'000);
+  EXPECT_DOUBLE_EQ(sharded.query()
+    .whereTimestampBetween(0, 499)
+    .whereTagsContain({"region", "nyc"})
+    .count(),
+    500
+  );
+  EXPECT_THROW(sharded.addTagColumn("device"), std::runtime_error);
+  std::filesystem::remove_all(sharded.path());
+}
+
 TEST_F(TableTest, CanGetTableName) {
   auto name{table_->name()};
 
   EXPECT_EQ(name, "table");
-}
\ No newline at end of file
+}
+
+TEST_F(TableTest, SavesValueTypeWithTable) {
+  {
+    Table counters{"test_db", "counters", {}, nullptr, ValueType::INT64};
+    counters.addTagColumn("host");
+    for (Timestamp i{0}; i < 100; ++i) {
+      counters.query<int64_t>()
+        .put(i, "requests", {{"host", "a"}}, 1'000'000'000'000 + i)
+        .execute();
+    }
+    const std::vector<std::pair<Timestamp, double>> rows{{100, 7}, {101, 8}};
+    counters.putBatch("requests", {{"host", "b"}}, rows);
+  }
+  Table counters{"test_db", "counters"};
+  EXPECT_EQ(counters.valueType(), ValueType::INT64);
+  EXPECT_EQ(
+    counters.query<int64_t>().whereMetricIs("requests").sum(),
+    100 * 1'000'000'000'000 + 99 * 100 / 2 + 15
+  );
+  EXPECT_EQ(
+    counters.query<int64_t>().whereTagsContain({"host", "b"}).max(),
+    8
+  );
+  EXPECT_THROW(std::ignore = counters.query(), std::runtime_error);
+
+  const std::vector<std::pair<Timestamp, double>> fraction{{102, 1.5}};
+  EXPECT_THROW(
+    counters.putBatch("requests", {{"host", "b"}}, fraction),
+    std::runtime_error
+  );
+  std::filesystem::remove_all(counters.path());
+}
+
+TEST_F(TableTest, CanCountTrueValuesOfBoolTable) {
+  Table statuses{"test_db", "statuses", {}, nullptr, ValueType::BOOL};
+  std::vector<std::pair<Timestamp, double>> rows;
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    rows.emplace_back(i, i % 4 == 0 ? 1 : 0);
+  }
+  statuses.putBatch("up", {}, rows);
+
+  const auto [count, trues]{statuses.visitQuery([](auto query_builder) {
+    return std::pair{
+      query_builder.whereMetricIs("up").count(),
+      static_cast<uint64_t>(query_builder.whereMetricIs("up").sum())
+    };
+  })};
+  EXPECT_EQ(count, 1'000);
+  EXPECT_EQ(trues, 250);
+
+  const std::vector<std::pair<Timestamp, double>> invalid{{1'000, 2}};
+  EXPECT_THROW(statuses.putBatch("up", {}, invalid), std::runtime_error);
+  std::filesystem::remove_all(statuses.path());
+}
@@ -1,5 +1,8 @@
 #include "gtest/gtest.h"
+#include <array>
 #include <vkdb/builder.h>
+#include <map>
+#include <numeric>
 
 using namespace vkdb;
 
@@ -59,6 +62,62 @@ TEST_F(QueryBuilderTest, CanRangeQuery) {
   }
 }
 
+TEST_F(QueryBuilderTest, CanRangeQueryAsync) {
+  TimeSeriesKey start{ENTRY_COUNT / 2, "metric", {}};
+  TimeSeriesKey end{ENTRY_COUNT, "metric", {}};
+  ThreadPool pool{2};
+
+  auto result{syncWait(query()
+    .range(start, end)
+    .executeAsync(pool)
+  )};
+
+  EXPECT_EQ(result.size(), ENTRY_COUNT / 2);
+  for (Timestamp i{ENTRY_COUNT / 2}; i < ENTRY_COUNT; ++i) {
+    EXPECT_EQ(result[i - ENTRY_COUNT / 2].second, i);
+  }
+}
+
+TEST_F(QueryBuilderTest, ThrowsWhenAwaitingFailedQuery) {
+  ThreadPool pool{1};
+
+  EXPECT_THROW(syncWait(query().executeAsync(pool)), std::runtime_error);
+}
+
+TEST_F(QueryBuilderTest, CanPlanFiltersIntoPointLookups) {
+  const TagTable tags{{"tag1", "a"}, {"tag2", "b"}, {"tag3", "c"}};
+  lsm_tree_->put(TimeSeriesKey{ENTRY_COUNT / 2, "metric", tags}, -1);
+  lsm_tree_->put(TimeSeriesKey{ENTRY_COUNT / 2, "other", tags}, -2);
+
+  auto result{query()
+    .filterByTimestamp(ENTRY_COUNT / 2)
+    .filterByMetric("metric")
+    .filterByAllTags(Tag{"tag1", "a"}, Tag{"tag2", "b"}, Tag{"tag3", "c"})
+    .execute()
+  };
+
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0].first, (TimeSeriesKey{ENTRY_COUNT / 2, "metric", tags}));
+  EXPECT_EQ(result[0].second, -1);
+
+  EXPECT_EQ(query()
+    .filterByAnyTimestamps(ENTRY_COUNT / 2, ENTRY_COUNT / 2 + 1)
+    .filterByAnyMetrics("metric", "other")
+    .filterByAllTags(Tag{"tag1", "a"}, Tag{"tag2", "b"}, Tag{"tag3", "c"})
+    .sum(), -3);
+}
+
+TEST_F(QueryBuilderTest, CanPlanTimestampFiltersIntoRange) {
+  auto result{query()
+    .filterByAnyTimestamps(ENTRY_COUNT / 4, ENTRY_COUNT / 2)
+    .execute()
+  };
+
+  ASSERT_EQ(result.size(), 2);
+  EXPECT_EQ(result[0].second, ENTRY_COUNT / 4);
+  EXPECT_EQ(result[1].second, ENTRY_COUNT / 2);
+}
+
 TEST_F(QueryBuilderTest, CanFilterByTag) {
   TimeSeriesKey key1{ENTRY_COUNT / 2, "metric", {{"tag1", "value1"}}};
   TimeSeriesKey key2{ENTRY_COUNT / 2 + 1, "metric", {{"tag1", "value1"}}};
@@ -212,6 +271,42 @@ TEST_F(QueryBuilderTest, CanFilterByTagAndMetric) {
   EXPECT_EQ(result[1].second, 3);
 }
 
+TEST_F(QueryBuilderTest, CanVisitEntriesMatchingCompileTimeFilter) {
+  TimeSeriesKey key1{ENTRY_COUNT / 2, "metric1", {{"tag1", "value1"}}};
+  TimeSeriesKey key2{ENTRY_COUNT / 2 + 1, "metric2", {{"tag1", "value1"}}};
+  TimeSeriesKey key3{ENTRY_COUNT / 2 + 2, "metric2", {{"tag1", "value2"}}};
+  TimeSeriesKey key4{ENTRY_COUNT / 2 + 3, "metric2", {{"tag1", "value1"}}};
+
+  lsm_tree_->put(key1, 1);
+  lsm_tree_->put(key2, 2);
+  lsm_tree_->put(key3, 3);
+  lsm_tree_->put(key4, 4);
+
+  std::vector<int> values;
+  query().forEach(
+    MetricEq{"metric2"} && TagEq{"tag1", "value1"},
+    [&values](const auto&, int value) { values.push_back(value); }
+  );
+  EXPECT_EQ(values, (std::vector<int>{2, 4}));
+
+  values.clear();
+  query()
+    .filterByTimestamp(ENTRY_COUNT / 2 + 3)
+    .forEach(MetricEq{"metric2"}, [&values](const auto&, int value) {
+      values.push_back(value);
+    });
+  EXPECT_EQ(values, std::vector<int>{4});
+
+  values.clear();
+  query()
+    .orderBy(QueryOrder::VALUE_DESC)
+    .limit(1)
+    .forEach(MetricEq{"metric2"}, [&values](const auto&, int value) {
+      values.push_back(value);
+    });
+  EXPECT_EQ(values, std::vector<int>{4});
+}
+
 TEST_F(QueryBuilderTest, CanFilterByTagAndMetricAndTimestamp) {
   TimeSeriesKey key1{ENTRY_COUNT / 2, "metric1", {{"tag1", "val1"}}};
   TimeSeriesKey key2{ENTRY_COUNT / 2 + 1, "metric2", {{"tag1", "val1"}}};
@@ -315,6 +410,21 @@ TEST_F(QueryBuilderTest, CanRemove) {
   EXPECT_EQ(result.size(), 0);
 }
 
+TEST_F(QueryBuilderTest, CanRemoveRange) {
+  query()
+    .removeRange(100, 199, "metric")
+    .execute();
+
+  EXPECT_EQ(query().count(), ENTRY_COUNT - 100);
+  EXPECT_EQ(query().range(
+    TimeSeriesKey{100, "metric", {}}, TimeSeriesKey{199, "metric", {}}
+  ).execute().size(), 0);
+  EXPECT_THROW(
+    std::ignore = query().removeRange(0, 1, "metric", {{"tag4", "value"}}),
+    std::runtime_error
+  );
+}
+
 TEST_F(QueryBuilderTest, CanGetCountWithoutFilters) {
   auto result{query()
     .count()
@@ -540,4 +650,351 @@ TEST_F(QueryBuilderTest, ThrowsWhenUsingInvalidTags) {
     query().filterByTag("invalid-tag", "value").execute(),
     std::runtime_error
   );
-}
\ No newline at end of file
+}
+
+TEST_F(QueryBuilderTest, AggregatesMatchDecodedRangeAfterUpdates) {
+  for (Timestamp i{0}; i < ENTRY_COUNT; i += 7) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, -static_cast<int>(i));
+  }
+  for (Timestamp i{0}; i < ENTRY_COUNT; i += 11) {
+    lsm_tree_->remove(TimeSeriesKey{i, "metric", {}});
+  }
+  lsm_tree_->put(TimeSeriesKey{42, "other", {}}, 1'000'000);
+
+  const auto entries{query()
+    .range(TimeSeriesKey{1'000, "metric", {}}, TimeSeriesKey{8'999, "metric", {}})
+    .filterByMetric("metric")
+    .execute()
+  };
+  int sum{0};
+  int min{std::numeric_limits<int>::max()};
+  int max{std::numeric_limits<int>::min()};
+  for (const auto& [key, value] : entries) {
+    sum += value.value();
+    min = std::min(min, value.value());
+    max = std::max(max, value.value());
+  }
+
+  auto aggregate = [this] {
+    auto builder{query()};
+    std::ignore = builder
+      .range(TimeSeriesKey{1'000, "metric", {}}, TimeSeriesKey{8'999, "metric", {}})
+      .filterByMetric("metric");
+    return builder;
+  };
+  EXPECT_EQ(aggregate().count(), entries.size());
+  EXPECT_EQ(aggregate().sum(), sum);
+  EXPECT_EQ(aggregate().min(), min);
+  EXPECT_EQ(aggregate().max(), max);
+  EXPECT_DOUBLE_EQ(
+    aggregate().avg(),
+    static_cast<double>(sum) / entries.size()
+  );
+}
+
+TEST_F(QueryBuilderTest, BucketedAggregatesMatchDecodedRangeAfterUpdates) {
+  for (Timestamp i{0}; i < ENTRY_COUNT; i += 7) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, -static_cast<int>(i));
+  }
+  for (Timestamp i{0}; i < ENTRY_COUNT; i += 11) {
+    lsm_tree_->remove(TimeSeriesKey{i, "metric", {}});
+  }
+
+  static constexpr Timestamp WIDTH{250};
+  const auto entries{query()
+    .range(TimeSeriesKey{1'000, "metric", {}}, TimeSeriesKey{8'999, "metric", {}})
+    .filterByMetric("metric")
+    .execute()
+  };
+  std::map<Timestamp, std::vector<int>> expected;
+  for (const auto& [key, value] : entries) {
+    expected[key.timestamp() - key.timestamp() % WIDTH].push_back(value.value());
+  }
+
+  auto buckets = [this](AggregateFunction function) {
+    auto builder{query()};
+    std::ignore = builder
+      .range(TimeSeriesKey{1'000, "metric", {}}, TimeSeriesKey{8'999, "metric", {}})
+      .filterByMetric("metric");
+    return builder.aggregateEvery(function, WIDTH);
+  };
+  const auto counts{buckets(AggregateFunction::COUNT)};
+  const auto sums{buckets(AggregateFunction::SUM)};
+  const auto mins{buckets(AggregateFunction::MIN)};
+  ASSERT_EQ(counts.size(), expected.size());
+  ASSERT_EQ(sums.size(), expected.size());
+  ASSERT_EQ(mins.size(), expected.size());
+
+  auto i{0};
+  for (const auto& [start, values] : expected) {
+    EXPECT_EQ(counts[i].first, start);
+    EXPECT_EQ(counts[i].second, values.size());
+    EXPECT_EQ(sums[i].second, std::accumulate(values.begin(), values.end(), 0));
+    EXPECT_EQ(mins[i].second, *std::ranges::min_element(values));
+    ++i;
+  }
+}
+
+TEST_F(QueryBuilderTest, CanComputeSeveralAggregatesTogether) {
+  const auto values{query()
+    .aggregate({
+      AggregateFunction::COUNT,
+      AggregateFunction::SUM,
+      AggregateFunction::AVG,
+      AggregateFunction::MIN,
+      AggregateFunction::MAX
+    })
+  };
+
+  ASSERT_EQ(values.size(), 5);
+  EXPECT_EQ(values[0], ENTRY_COUNT);
+  EXPECT_EQ(values[1], ENTRY_COUNT * (ENTRY_COUNT - 1) / 2);
+  EXPECT_DOUBLE_EQ(values[2], (ENTRY_COUNT - 1) / 2.0);
+  EXPECT_EQ(values[3], 0);
+  EXPECT_EQ(values[4], ENTRY_COUNT - 1);
+}
+
+TEST_F(QueryBuilderTest, CanComputeSeveralAggregatesInBuckets) {
+  static constexpr Timestamp WIDTH{1'000};
+  const auto buckets{query()
+    .range(TimeSeriesKey{0, "metric", {}}, TimeSeriesKey{2'999, "metric", {}})
+    .aggregateEvery({AggregateFunction::COUNT, AggregateFunction::MAX}, WIDTH)
+  };
+
+  ASSERT_EQ(buckets.size(), 3);
+  for (size_t i{0}; i < buckets.size(); ++i) {
+    EXPECT_EQ(buckets[i].first, i * WIDTH);
+    ASSERT_EQ(buckets[i].second.size(), 2);
+    EXPECT_EQ(buckets[i].second[0], WIDTH);
+    EXPECT_EQ(buckets[i].second[1], (i + 1) * WIDTH - 1);
+  }
+}
+
+TEST_F(QueryBuilderTest, ThrowsWhenAggregatingWithoutFunctions) {
+  EXPECT_THROW(std::ignore = query().aggregate({}), std::runtime_error);
+}
+
+TEST_F(QueryBuilderTest, CanCountTogetherOnEmptyRangeOnlyIfCountIsAlone) {
+  Metric metric{"non-existent-metric"};
+  EXPECT_EQ(
+    query().filterByMetric(metric).aggregate({AggregateFunction::COUNT}),
+    std::vector<double>{0.0}
+  );
+  EXPECT_THROW(
+    std::ignore = query().filterByMetric(metric).aggregate({
+      AggregateFunction::COUNT, AggregateFunction::AVG
+    }),
+    std::runtime_error
+  );
+}
+
+TEST_F(QueryBuilderTest, CanEstimatePercentiles) {
+  const auto estimates{query().percentiles({50, 95, 99})};
+
+  ASSERT_EQ(estimates.size(), 3);
+  for (size_t i{0}; i < estimates.size(); ++i) {
+    const auto expected{(ENTRY_COUNT - 1) * std::array{0.50, 0.95, 0.99}[i]};
+    EXPECT_NEAR(estimates[i], expected, expected * 0.01 + 1);
+  }
+  EXPECT_DOUBLE_EQ(query().percentile(95), estimates[1]);
+}
+
+TEST_F(QueryBuilderTest, ThrowsWhenEstimatingInvalidPercentile) {
+  EXPECT_THROW(std::ignore = query().percentile(101), std::invalid_argument);
+  EXPECT_THROW(
+    std::ignore = query().filterByMetric("non-existent-metric").percentile(50),
+    std::runtime_error
+  );
+}
+
+TEST_F(QueryBuilderTest, CanEstimateDistinctValues) {
+  const auto estimate{query()
+    .range(TimeSeriesKey{0, "metric", {}}, TimeSeriesKey{999, "metric", {}})
+    .approxCountDistinct()
+  };
+
+  EXPECT_NEAR(static_cast<double>(estimate), 1'000, 30);
+}
+
+TEST_F(QueryBuilderTest, CanEstimateDistinctTagValues) {
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    lsm_tree_->put(
+      TimeSeriesKey{i, "latency", {{"tag1", "host" + std::to_string(i % 50)}}},
+      1
+    );
+  }
+  lsm_tree_->put(TimeSeriesKey{0, "latency", {}}, 1);
+
+  EXPECT_EQ(
+    query().filterByMetric("latency").approxCountDistinct("tag1"),
+    50
+  );
+  EXPECT_THROW(
+    std::ignore = query().approxCountDistinct("non-existent-tag"),
+    std::runtime_error
+  );
+}
+
+TEST_F(QueryBuilderTest, ThrowsWhenBucketWidthIsZero) {
+  EXPECT_THROW(
+    std::ignore = query().range(
+      TimeSeriesKey{0, "metric", {}},
+      TimeSeriesKey{100, "metric", {}}
+    ).aggregateEvery(AggregateFunction::SUM, 0),
+    std::runtime_error
+  );
+}
+
+TEST_F(QueryBuilderTest, CanLimitInKeyOrder) {
+  const auto result{query().filterByMetric("metric").limit(5).execute()};
+
+  ASSERT_EQ(result.size(), 5);
+  for (Timestamp i{0}; i < 5; ++i) {
+    EXPECT_EQ(result[i].first.timestamp(), i);
+  }
+  EXPECT_TRUE(query().filterByMetric("metric").limit(0).execute().empty());
+}
+
+TEST_F(QueryBuilderTest, CanGetNewestEntriesFirst) {
+  const auto result{query()
+    .filterByMetric("metric")
+    .orderBy(QueryOrder::TIMESTAMP_DESC)
+    .limit(3)
+    .execute()
+  };
+
+  ASSERT_EQ(result.size(), 3);
+  for (Timestamp i{0}; i < 3; ++i) {
+    EXPECT_EQ(result[i].first.timestamp(), ENTRY_COUNT - 1 - i);
+  }
+
+  const auto range{query()
+    .range(TimeSeriesKey{10, "metric", {}}, TimeSeriesKey{19, "metric", {}})
+    .orderBy(QueryOrder::TIMESTAMP_DESC)
+    .limit(100)
+    .execute()
+  };
+  ASSERT_EQ(range.size(), 10);
+  EXPECT_EQ(range.front().first.timestamp(), 19);
+  EXPECT_EQ(range.back().first.timestamp(), 10);
+
+  const auto all{query()
+    .filterByMetric("metric")
+    .orderBy(QueryOrder::TIMESTAMP_DESC)
+    .execute()
+  };
+  ASSERT_EQ(all.size(), ENTRY_COUNT);
+  EXPECT_EQ(all.front().first.timestamp(), ENTRY_COUNT - 1);
+}
+
+TEST_F(QueryBuilderTest, CanGetTopValues) {
+  for (Timestamp i{0}; i < 100; ++i) {
+    lsm_tree_->put(
+      TimeSeriesKey{i, "latency", {}},
+      static_cast<int>((i * 37) % 100)
+    );
+  }
+
+  const auto highest{query()
+    .filterByMetric("latency")
+    .orderBy(QueryOrder::VALUE_DESC)
+    .limit(3)
+    .execute()
+  };
+  ASSERT_EQ(highest.size(), 3);
+  EXPECT_EQ(highest[0].second, 99);
+  EXPECT_EQ(highest[1].second, 98);
+  EXPECT_EQ(highest[2].second, 97);
+
+  const auto lowest{query()
+    .filterByMetric("latency")
+    .orderBy(QueryOrder::VALUE_ASC)
+    .execute()
+  };
+  ASSERT_EQ(lowest.size(), 100);
+  EXPECT_TRUE(std::ranges::is_sorted(lowest, {}, [](const auto& entry) {
+    return entry.second.value();
+  }));
+}
+
+TEST_F(QueryBuilderTest, CanGetNewestEntryOfEachSeries) {
+  lsm_tree_->put(TimeSeriesKey{5, "metric", {{"tag1", "a"}}}, 50);
+  lsm_tree_->put(TimeSeriesKey{7, "metric", {{"tag1", "b"}}}, 70);
+
+  const auto result{query().filterByMetric("metric").latest()};
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(result[0].first.timestamp(), 5);
+  EXPECT_EQ(result[0].second, 50);
+  EXPECT_EQ(result[1].first.timestamp(), 7);
+  EXPECT_EQ(result[2].first.timestamp(), ENTRY_COUNT - 1);
+
+  const auto tagged{query().filterByTag("tag1", "b").latest()};
+  ASSERT_EQ(tagged.size(), 1);
+  EXPECT_EQ(tagged[0].second, 70);
+
+  const auto range{query()
+    .range(TimeSeriesKey{0, "metric", {}}, TimeSeriesKey{6, "metric", {}})
+    .latest()
+  };
+  ASSERT_EQ(range.size(), 2);
+  EXPECT_EQ(range[0].second, 50);
+  EXPECT_EQ(range[1].second, 6);
+
+  const auto limited{query()
+    .orderBy(QueryOrder::VALUE_DESC)
+    .limit(1)
+    .latest()
+  };
+  ASSERT_EQ(limited.size(), 1);
+  EXPECT_EQ(limited[0].second, ENTRY_COUNT - 1);
+}
+
+TEST_F(QueryBuilderTest, CanQueryEveryShardOfAShardedLSMTree) {
+  LSMTreeOptions options;
+  options.shards = 4;
+  options.mem_table_max_entries = 100;
+  const FilePath directory{"test_sharded_lsm_tree"};
+  {
+    ShardedLSMTree<int> sharded{directory, options};
+    const auto sharded_query{[&] {
+      return QueryBuilder<int>(sharded, tag_columns_);
+    }};
+    for (Timestamp i{0}; i < 200; ++i) {
+      for (const auto* host : {"a", "b", "c", "d", "e", "f"}) {
+        std::ignore = sharded_query()
+          .put(TimeSeriesKey{i, "metric", {{"tag1", host}}}, 1)
+          .execute();
+      }
+    }
+
+    EXPECT_EQ(sharded_query().filterByMetric("metric").count(), 1200);
+    EXPECT_EQ(sharded_query().filterByTag("tag1", "c").count(), 200);
+    EXPECT_EQ(sharded_query().filterByMetric("metric").latest().size(), 6);
+
+    const auto range{sharded_query()
+      .range(TimeSeriesKey{10, "metric", {}}, TimeSeriesKey{19, MAX_METRIC, {}})
+      .execute()
+    };
+    ASSERT_EQ(range.size(), 60);
+    EXPECT_TRUE(std::ranges::is_sorted(range, {}, [](const auto& entry) {
+      return entry.first;
+    }));
+
+    std::ignore = sharded_query().removeRange(0, 99, "metric").execute();
+    std::ignore = sharded_query()
+      .put(TimeSeriesKey{50, "metric", {{"tag1", "a"}}}, 2)
+      .execute();
+
+    EXPECT_EQ(sharded_query().filterByMetric("metric").count(), 601);
+    EXPECT_EQ(sharded_query().filterByMetric("metric").sum(), 602);
+    const auto newest{sharded_query()
+      .filterByMetric("metric")
+      .orderBy(QueryOrder::TIMESTAMP_DESC)
+      .limit(6)
+      .execute()
+    };
+    ASSERT_EQ(newest.size(), 6);
+    EXPECT_EQ(newest.back().first.timestamp(), 199);
+  }
+  std::filesystem::remove_all(directory);
+}
@@ -104,6 +104,97 @@ TEST_F(InterpreterTest, CanInterpretSelectDataBetweenWhereQuery) {
   EXPECT_EQ(stream.str(), datapointsToString<double>(expected_datapoints) + "\n");
 }
 
+TEST_F(InterpreterTest, CanInterpretSelectAvgBetweenEveryQuery) {
+  database_->createTable("table");
+
+  auto& table{database_->getTable("table")};
+  for (Timestamp i{0}; i < 10; ++i) {
+    table.query().put(i * 100, "metric", {}, static_cast<double>(i)).execute();
+  }
+
+  Expr expr{SelectQuery{
+    SelectTypeAvgExpr{make_token(TokenType::AVG, "AVG")},
+    MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table")},
+    BetweenClause{
+      make_token(TokenType::NUMBER, "0"),
+      make_token(TokenType::NUMBER, "999"),
+      std::nullopt,
+      EveryClause{make_token(TokenType::NUMBER, "300")}
+    }
+  }};
+
+  Interpreter interpreter{*database_};
+  std::ostringstream stream;
+  interpreter.interpret(expr, stream);
+
+  EXPECT_EQ(
+    stream.str(),
+    "[0:" + std::to_string(1.0) + ";300:" + std::to_string(4.0)
+      + ";600:" + std::to_string(7.0) + ";900:" + std::to_string(9.0) + "]\n"
+  );
+}
+
+TEST_F(InterpreterTest, CanInterpretSelectAggregatesBetweenEveryQuery) {
+  database_->createTable("table");
+
+  auto& table{database_->getTable("table")};
+  for (Timestamp i{0}; i < 10; ++i) {
+    table.query().put(i * 100, "metric", {}, static_cast<double>(i)).execute();
+  }
+
+  Expr expr{SelectQuery{
+    SelectTypeAggregatesExpr{
+      make_token(TokenType::COUNT, "COUNT"),
+      {make_token(TokenType::COUNT, "COUNT"), make_token(TokenType::MAX, "MAX")}
+    },
+    MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table")},
+    BetweenClause{
+      make_token(TokenType::NUMBER, "0"),
+      make_token(TokenType::NUMBER, "599"),
+      std::nullopt,
+      EveryClause{make_token(TokenType::NUMBER, "300")}
+    }
+  }};
+
+  Interpreter interpreter{*database_};
+  std::ostringstream stream;
+  interpreter.interpret(expr, stream);
+
+  EXPECT_EQ(
+    stream.str(),
+    "[0:" + std::to_string(3.0) + "," + std::to_string(2.0) + ";300:"
+      + std::to_string(3.0) + "," + std::to_string(5.0) + "]\n"
+  );
+}
+
+TEST_F(InterpreterTest, ThrowsWhenBucketingSelectData) {
+  database_->createTable("table");
+
+  Expr expr{SelectQuery{
+    SelectTypeDataExpr{make_token(TokenType::DATA, "DATA")},
+    MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table")},
+    BetweenClause{
+      make_token(TokenType::NUMBER, "0"),
+      make_token(TokenType::NUMBER, "999"),
+      std::nullopt,
+      EveryClause{make_token(TokenType::NUMBER, "300")}
+    }
+  }};
+
+  std::string error;
+  Interpreter interpreter{*database_, [&error](const RuntimeError& e) {
+    error = e.message();
+  }};
+  std::ostringstream stream;
+  interpreter.interpret(expr, stream);
+
+  EXPECT_TRUE(stream.str().empty());
+  EXPECT_NE(error.find("Cannot bucket DATA."), std::string::npos);
+}
+
 TEST_F(InterpreterTest, CanInterpretSelectDataAtWhereQuery) {
   database_->createTable("table");
 
@@ -220,6 +311,48 @@ TEST_F(InterpreterTest, CanInterpretDeleteQuery) {
   EXPECT_TRUE(result.empty());
 }
 
+TEST_F(InterpreterTest, CanInterpretDeleteBetweenQuery) {
+  database_->createTable("table");
+
+  auto& table{database_->getTable("table")};
+  table.addTagColumn("tag1");
+
+  for (Timestamp i{0}; i < 10; ++i) {
+    table.query()
+      .put(i, "metric", {{"tag1", "value1"}}, static_cast<double>(i))
+      .execute();
+    table.query()
+      .put(i, "metric", {{"tag1", "value2"}}, static_cast<double>(i))
+      .execute();
+  }
+
+  Expr expr{DeleteQuery{
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::NUMBER, "2"),
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table")},
+    TagListExpr{{
+      TagExpr{
+        TagKeyExpr{make_token(TokenType::IDENTIFIER, "tag1")},
+        TagValueExpr{make_token(TokenType::IDENTIFIER, "value1")}
+      }}
+    },
+    TimestampExpr{make_token(TokenType::NUMBER, "7")}
+  }};
+
+  Interpreter interpreter{*database_};
+  interpreter.interpret(expr);
+
+  auto deleted{table.query()
+    .whereTagsContainAllOf(Tag{"tag1", "value1"})
+    .execute()};
+  auto kept{table.query()
+    .whereTagsContainAllOf(Tag{"tag1", "value2"})
+    .execute()};
+
+  EXPECT_EQ(deleted.size(), 4);
+  EXPECT_EQ(kept.size(), 10);
+}
+
 TEST_F(InterpreterTest, CanInterpretCreateQuery) {
   Expr expr{CreateQuery{
     TableNameExpr{make_token(TokenType::IDENTIFIER, "new_table")},
@@ -248,6 +381,38 @@ TEST_F(InterpreterTest, CanInterpretDropQuery) {
   EXPECT_THROW(std::ignore = database_->getTable("table"), std::runtime_error);
 }
 
+TEST_F(InterpreterTest, CanInterpretStatsQuery) {
+  database_->createTable("table");
+  database_->getTable("table").query()
+    .put(1, "metric", {}, 10)
+    .execute();
+
+  Expr expr{StatsQuery{
+    make_token(TokenType::SHOW, "SHOW"),
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table")}
+  }};
+
+  std::string error;
+  Interpreter interpreter{*database_, [&error](const RuntimeError& e) {
+    error = e.message();
+  }};
+  std::ostringstream stream;
+  interpreter.interpret(expr, stream);
+
+  EXPECT_NE(stream.str().find("table flushes 0\n"), std::string::npos);
+  EXPECT_NE(
+    stream.str().find("table wal_append.count 1\n"), std::string::npos
+  );
+  EXPECT_TRUE(error.empty());
+
+  Expr missing_expr{StatsQuery{
+    make_token(TokenType::SHOW, "SHOW"),
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "missing")}
+  }};
+  interpreter.interpret(missing_expr, stream);
+  EXPECT_NE(error.find("does not exist"), std::string::npos);
+}
+
 TEST_F(InterpreterTest, CanInterpretAddQuery) {
   database_->createTable("table");
 
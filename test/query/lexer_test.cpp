@@ -163,4 +163,31 @@ TEST(LexerTest, HandlesComments) {
   EXPECT_EQ(tokens[0], Token(TokenType::SELECT, "SELECT", 1, 1));
   EXPECT_EQ(tokens[1], Token(TokenType::PUT, "PUT", 2, 1));
   EXPECT_EQ(tokens[2], Token(TokenType::END_OF_FILE, "", 2, 4));
-}
\ No newline at end of file
+}
+
+TEST(LexerTest, HandlesPlaceholders) {
+  Lexer lexer{"BETWEEN ? AND ?;"};
+  auto tokens{lexer.tokenize()};
+
+  ASSERT_EQ(tokens.size(), 6);
+  EXPECT_EQ(tokens[0], Token(TokenType::BETWEEN, "BETWEEN", 1, 1));
+  EXPECT_EQ(tokens[1], Token(TokenType::PLACEHOLDER, "?", 1, 9));
+  EXPECT_EQ(tokens[2], Token(TokenType::AND, "AND", 1, 11));
+  EXPECT_EQ(tokens[3], Token(TokenType::PLACEHOLDER, "?", 1, 15));
+  EXPECT_EQ(tokens[4], Token(TokenType::SEMICOLON, ";", 1, 16));
+  EXPECT_EQ(tokens[5], Token(TokenType::END_OF_FILE, "", 1, 17));
+}
+
+TEST(LexerTest, LooksUpEveryReservedWord) {
+  for (const auto& [word, type] : RESERVED_WORDS) {
+    EXPECT_EQ(wordTokenType(word), type) << word;
+    Lexer lexer{word};
+    const auto tokens{lexer.tokenize()};
+    ASSERT_EQ(tokens.size(), 2);
+    EXPECT_EQ(tokens[0].type(), type);
+  }
+  static_assert(wordTokenType("SELECT") == TokenType::SELECT);
+  EXPECT_EQ(wordTokenType("SELECTS"), TokenType::IDENTIFIER);
+  EXPECT_EQ(wordTokenType("SELEC"), TokenType::IDENTIFIER);
+  EXPECT_EQ(wordTokenType("temperature"), TokenType::IDENTIFIER);
+}
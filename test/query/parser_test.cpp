@@ -50,6 +50,30 @@ TEST(ParserTest, CanParseCreateQueryWithTags) {
   EXPECT_EQ(create_query_ptr->tag_columns->keys[1].token.lexeme(), "tag2");
 }
 
+TEST(ParserTest, CanParseCreateQueryWithValueType) {
+  std::vector<Token> tokens{
+    make_token(TokenType::CREATE, "CREATE"),
+    make_token(TokenType::TABLE, "TABLE"),
+    make_token(TokenType::IDENTIFIER, "table_name"),
+    make_token(TokenType::TAGS, "TAGS"),
+    make_token(TokenType::IDENTIFIER, "tag1"),
+    make_token(TokenType::TYPE, "TYPE"),
+    make_token(TokenType::IDENTIFIER, "INT64"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto create_query{parser.parse()};
+  ASSERT_TRUE(create_query.has_value());
+
+  auto create_query_ptr{std::get_if<CreateQuery>(&create_query.value()[0])};
+  ASSERT_NE(create_query_ptr, nullptr);
+  ASSERT_TRUE(create_query_ptr->tag_columns.has_value());
+  EXPECT_EQ(create_query_ptr->tag_columns->keys.size(), 1);
+  ASSERT_TRUE(create_query_ptr->value_type.has_value());
+  EXPECT_EQ(create_query_ptr->value_type->token.lexeme(), "INT64");
+}
+
 TEST(ParserTest, CanParseDropQuery) {
   std::vector<Token> tokens{
     make_token(TokenType::DROP, "DROP"),
@@ -134,6 +158,33 @@ TEST(ParserTest, CanParseTablesQuery) {
   ASSERT_NE(tables_query_ptr, nullptr);
 }
 
+TEST(ParserTest, CanParseStatsQuery) {
+  std::vector<Token> tokens {
+    make_token(TokenType::SHOW, "SHOW"),
+    make_token(TokenType::STATS, "STATS"),
+    make_token(TokenType::SEMICOLON, ";"),
+    make_token(TokenType::SHOW, "SHOW"),
+    make_token(TokenType::STATS, "STATS"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table_name"),
+    make_token(TokenType::SEMICOLON, ";")
+  };
+
+  Parser parser{tokens};
+  auto stats_queries{parser.parse()};
+  ASSERT_TRUE(stats_queries.has_value());
+  ASSERT_EQ(stats_queries->size(), 2);
+
+  auto all_ptr{std::get_if<StatsQuery>(&stats_queries.value()[0])};
+  ASSERT_NE(all_ptr, nullptr);
+  EXPECT_FALSE(all_ptr->table_name.has_value());
+
+  auto table_ptr{std::get_if<StatsQuery>(&stats_queries.value()[1])};
+  ASSERT_NE(table_ptr, nullptr);
+  ASSERT_TRUE(table_ptr->table_name.has_value());
+  EXPECT_EQ(table_ptr->table_name->token.lexeme(), "table_name");
+}
+
 TEST(ParserTest, CanParseSelectDataAllQuery) {
   std::vector<Token> tokens{
     make_token(TokenType::SELECT, "SELECT"),
@@ -190,6 +241,56 @@ TEST(ParserTest, CanParseSelectDataBetweenQuery) {
   EXPECT_EQ(between_clause->end.token.lexeme(), "20");
 }
 
+TEST(ParserTest, CanParsePlaceholders) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::AVG, "AVG"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::BETWEEN, "BETWEEN"),
+    make_token(TokenType::PLACEHOLDER, "?"),
+    make_token(TokenType::AND, "AND"),
+    make_token(TokenType::NUMBER, "20"),
+    make_token(TokenType::WHERE, "WHERE"),
+    make_token(TokenType::IDENTIFIER, "tag"),
+    make_token(TokenType::EQUAL, "="),
+    make_token(TokenType::PLACEHOLDER, "?"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto select_query{parser.parse()};
+  ASSERT_TRUE(select_query.has_value());
+  EXPECT_EQ(parser.parameterCount(), 2);
+
+  auto select_query_ptr{std::get_if<SelectQuery>(&select_query.value()[0])};
+  ASSERT_NE(select_query_ptr, nullptr);
+
+  auto between_clause{std::get_if<BetweenClause>(&select_query_ptr->clause)};
+  ASSERT_NE(between_clause, nullptr);
+  EXPECT_EQ(between_clause->start.token.parameter(), 0);
+  EXPECT_FALSE(between_clause->end.token.parameter().has_value());
+  ASSERT_TRUE(between_clause->where_clause.has_value());
+  const auto& tag{between_clause->where_clause->tag_list.tags[0]};
+  EXPECT_EQ(tag.value.token.parameter(), 1);
+}
+
+TEST(ParserTest, ThrowsWhenPlaceholderIsMetric) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::DATA, "DATA"),
+    make_token(TokenType::PLACEHOLDER, "?"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::ALL, "ALL"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  EXPECT_FALSE(parser.parse().has_value());
+}
+
 TEST(ParserTest, CanParseSelectDataAtQuery) {
   std::vector<Token> tokens{
     make_token(TokenType::SELECT, "SELECT"),
@@ -309,6 +410,144 @@ TEST(ParserTest, CanParseSelectDataBetweenWhereQuery) {
   EXPECT_EQ(tag_list.tags[1].value.token.lexeme(), "value2");
 }
 
+TEST(ParserTest, CanParseSelectAvgBetweenEveryWhereQuery) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::AVG, "AVG"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::BETWEEN, "BETWEEN"),
+    make_token(TokenType::NUMBER, "0"),
+    make_token(TokenType::AND, "AND"),
+    make_token(TokenType::NUMBER, "999"),
+    make_token(TokenType::EVERY, "EVERY"),
+    make_token(TokenType::NUMBER, "300"),
+    make_token(TokenType::WHERE, "WHERE"),
+    make_token(TokenType::IDENTIFIER, "tag1"),
+    make_token(TokenType::EQUAL, "="),
+    make_token(TokenType::IDENTIFIER, "value1"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto select_query{parser.parse()};
+  ASSERT_TRUE(select_query.has_value());
+
+  auto select_query_ptr{std::get_if<SelectQuery>(&select_query.value()[0])};
+  ASSERT_NE(select_query_ptr, nullptr);
+
+  auto between_clause{std::get_if<BetweenClause>(&select_query_ptr->clause)};
+  ASSERT_NE(between_clause, nullptr);
+  EXPECT_EQ(between_clause->start.token.lexeme(), "0");
+  EXPECT_EQ(between_clause->end.token.lexeme(), "999");
+
+  ASSERT_TRUE(between_clause->every_clause.has_value());
+  EXPECT_EQ(between_clause->every_clause->width.token.lexeme(), "300");
+
+  ASSERT_TRUE(between_clause->where_clause.has_value());
+  ASSERT_EQ(between_clause->where_clause->tag_list.tags.size(), 1);
+}
+
+TEST(ParserTest, CanParseSelectAggregatesQuery) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::AVG, "AVG"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::MIN, "MIN"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::MAX, "MAX"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::ALL, "ALL"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto select_query{parser.parse()};
+  ASSERT_TRUE(select_query.has_value());
+
+  auto select_query_ptr{std::get_if<SelectQuery>(&select_query.value()[0])};
+  ASSERT_NE(select_query_ptr, nullptr);
+
+  auto aggregates{std::get_if<SelectTypeAggregatesExpr>(&select_query_ptr->type)};
+  ASSERT_NE(aggregates, nullptr);
+  ASSERT_EQ(aggregates->functions.size(), 3);
+  EXPECT_EQ(aggregates->functions[0].type(), TokenType::AVG);
+  EXPECT_EQ(aggregates->functions[1].type(), TokenType::MIN);
+  EXPECT_EQ(aggregates->functions[2].type(), TokenType::MAX);
+  EXPECT_EQ(select_query_ptr->metric.token.lexeme(), "metric");
+}
+
+TEST(ParserTest, ThrowsWhenCombiningDataWithAggregates) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::DATA, "DATA"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::MIN, "MIN"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::ALL, "ALL"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  EXPECT_FALSE(parser.parse().has_value());
+}
+
+TEST(ParserTest, CanParseSelectDataWithOrderAndLimit) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::DATA, "DATA"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::ALL, "ALL"),
+    make_token(TokenType::ORDER, "ORDER"),
+    make_token(TokenType::BY, "BY"),
+    make_token(TokenType::TIMESTAMP, "TIMESTAMP"),
+    make_token(TokenType::DESC, "DESC"),
+    make_token(TokenType::LIMIT, "LIMIT"),
+    make_token(TokenType::NUMBER, "10"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto select_query{parser.parse()};
+  ASSERT_TRUE(select_query.has_value());
+
+  auto select_query_ptr{std::get_if<SelectQuery>(&select_query.value()[0])};
+  ASSERT_NE(select_query_ptr, nullptr);
+  ASSERT_TRUE(select_query_ptr->order_clause.has_value());
+  EXPECT_EQ(select_query_ptr->order_clause->key.type(), TokenType::TIMESTAMP);
+  ASSERT_TRUE(select_query_ptr->order_clause->direction.has_value());
+  EXPECT_EQ(
+    select_query_ptr->order_clause->direction->type(),
+    TokenType::DESC
+  );
+  ASSERT_TRUE(select_query_ptr->limit_clause.has_value());
+  EXPECT_EQ(select_query_ptr->limit_clause->count.lexeme(), "10");
+}
+
+TEST(ParserTest, ThrowsWhenLimitingAggregates) {
+  std::vector<Token> tokens{
+    make_token(TokenType::SELECT, "SELECT"),
+    make_token(TokenType::AVG, "AVG"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::ALL, "ALL"),
+    make_token(TokenType::LIMIT, "LIMIT"),
+    make_token(TokenType::NUMBER, "10"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  EXPECT_FALSE(parser.parse().has_value());
+}
+
 TEST(ParserTest, CanParseSelectDataAtWhereQuery) {
   std::vector<Token> tokens{
     make_token(TokenType::SELECT, "SELECT"),
@@ -419,6 +658,51 @@ TEST(ParserTest, CanParsePutWithTagsQuery) {
   EXPECT_EQ(tag_list->tags[1].value.token.lexeme(), "value2");
 }
 
+TEST(ParserTest, CanParsePutValuesQuery) {
+  std::vector<Token> tokens{
+    make_token(TokenType::PUT, "PUT"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::INTO, "INTO"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::TAGS, "TAGS"),
+    make_token(TokenType::IDENTIFIER, "tag1"),
+    make_token(TokenType::EQUAL, "="),
+    make_token(TokenType::IDENTIFIER, "value1"),
+    make_token(TokenType::VALUES, "VALUES"),
+    make_token(TokenType::LEFT_PAREN, "("),
+    make_token(TokenType::NUMBER, "1"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::NUMBER, "20.1"),
+    make_token(TokenType::RIGHT_PAREN, ")"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::LEFT_PAREN, "("),
+    make_token(TokenType::NUMBER, "2"),
+    make_token(TokenType::COMMA, ","),
+    make_token(TokenType::NUMBER, "20.3"),
+    make_token(TokenType::RIGHT_PAREN, ")"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto put_query{parser.parse()};
+  ASSERT_TRUE(put_query.has_value());
+
+  auto put_query_ptr{std::get_if<PutValuesQuery>(&put_query.value()[0])};
+  ASSERT_NE(put_query_ptr, nullptr);
+
+  EXPECT_EQ(put_query_ptr->metric.token.lexeme(), "metric");
+  EXPECT_EQ(put_query_ptr->table_name.token.lexeme(), "table");
+  ASSERT_TRUE(put_query_ptr->tag_list.has_value());
+  ASSERT_EQ(put_query_ptr->tag_list->tags.size(), 1);
+  EXPECT_EQ(put_query_ptr->tag_list->tags[0].key.token.lexeme(), "tag1");
+
+  ASSERT_EQ(put_query_ptr->rows.size(), 2);
+  EXPECT_EQ(put_query_ptr->rows[0].timestamp.token.lexeme(), "1");
+  EXPECT_EQ(put_query_ptr->rows[0].value.token.lexeme(), "20.1");
+  EXPECT_EQ(put_query_ptr->rows[1].timestamp.token.lexeme(), "2");
+  EXPECT_EQ(put_query_ptr->rows[1].value.token.lexeme(), "20.3");
+}
+
 TEST(ParserTest, CanParseDeleteQuery) {
   std::vector<Token> tokens{
     make_token(TokenType::DELETE, "DELETE"),
@@ -480,6 +764,39 @@ TEST(ParserTest, CanParseDeleteWithTagsQuery) {
   EXPECT_EQ(tag_list->tags[1].value.token.lexeme(), "value2");
 }
 
+TEST(ParserTest, CanParseDeleteBetweenQuery) {
+  std::vector<Token> tokens{
+    make_token(TokenType::DELETE, "DELETE"),
+    make_token(TokenType::IDENTIFIER, "metric"),
+    make_token(TokenType::BETWEEN, "BETWEEN"),
+    make_token(TokenType::NUMBER, "10"),
+    make_token(TokenType::AND, "AND"),
+    make_token(TokenType::NUMBER, "20"),
+    make_token(TokenType::FROM, "FROM"),
+    make_token(TokenType::IDENTIFIER, "table"),
+    make_token(TokenType::TAGS, "TAGS"),
+    make_token(TokenType::IDENTIFIER, "tag1"),
+    make_token(TokenType::EQUAL, "="),
+    make_token(TokenType::IDENTIFIER, "value1"),
+    make_token(TokenType::SEMICOLON, ";"),
+  };
+
+  Parser parser{tokens};
+  auto delete_query{parser.parse()};
+  ASSERT_TRUE(delete_query.has_value());
+
+  auto delete_query_ptr{std::get_if<DeleteQuery>(&delete_query.value()[0])};
+  ASSERT_NE(delete_query_ptr, nullptr);
+
+  EXPECT_EQ(delete_query_ptr->metric.token.lexeme(), "metric");
+  EXPECT_EQ(delete_query_ptr->timestamp.token.lexeme(), "10");
+  ASSERT_TRUE(delete_query_ptr->end_timestamp.has_value());
+  EXPECT_EQ(delete_query_ptr->end_timestamp->token.lexeme(), "20");
+  EXPECT_EQ(delete_query_ptr->table_name.token.lexeme(), "table");
+  ASSERT_TRUE(delete_query_ptr->tag_list.has_value());
+  ASSERT_EQ(delete_query_ptr->tag_list->tags.size(), 1);
+}
+
 TEST(ParserTest, CanParseMultipleQueries) {
   std::vector<Token> tokens{
     make_token(TokenType::CREATE, "CREATE"),
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include <vkdb/planner.h>
+#include <algorithm>
+
+using namespace vkdb;
+
+class PlannerTest : public ::testing::Test {
+protected:
+  std::unordered_set<TagKey> tag_columns_{"host", "region"};
+};
+
+TEST_F(PlannerTest, ScansWholeRangeWithoutTimestamps) {
+  KeyPredicate predicate;
+  predicate.requireAnyMetric({"cpu"});
+
+  const auto plan{planQuery(
+    MIN_TIME_SERIES_KEY,
+    MAX_TIME_SERIES_KEY,
+    predicate,
+    tag_columns_
+  )};
+
+  const auto range{std::get_if<RangePlan>(&plan)};
+  ASSERT_NE(range, nullptr);
+  EXPECT_EQ(range->start, MIN_TIME_SERIES_KEY);
+  EXPECT_EQ(range->end, MAX_TIME_SERIES_KEY);
+}
+
+TEST_F(PlannerTest, TightensRangeToTimestamps) {
+  KeyPredicate predicate;
+  predicate.requireAnyTimestamp({20, 10}).requireAnyTag({{"host", "a"}});
+
+  const auto plan{planQuery(
+    MIN_TIME_SERIES_KEY,
+    MAX_TIME_SERIES_KEY,
+    predicate,
+    tag_columns_
+  )};
+
+  const auto range{std::get_if<RangePlan>(&plan)};
+  ASSERT_NE(range, nullptr);
+  EXPECT_EQ(range->start.timestamp(), 10);
+  EXPECT_EQ(range->end.timestamp(), 20);
+}
+
+TEST_F(PlannerTest, LooksUpFullyKnownKeys) {
+  KeyPredicate predicate;
+  predicate.requireAnyTimestamp({20, 10})
+    .requireAnyMetric({"mem", "cpu"})
+    .requireAnyTag({{"host", "a"}})
+    .requireAnyTag({{"region", "eu"}});
+
+  const auto plan{planQuery(
+    TimeSeriesKey{0, MIN_METRIC, {}},
+    TimeSeriesKey{15, MAX_METRIC, {}},
+    predicate,
+    tag_columns_
+  )};
+
+  const auto points{std::get_if<PointPlan>(&plan)};
+  ASSERT_NE(points, nullptr);
+  const TagTable tags{{"host", "a"}, {"region", "eu"}};
+  EXPECT_EQ(points->keys, (std::vector<TimeSeriesKey>{
+    TimeSeriesKey{10, "cpu", tags},
+    TimeSeriesKey{10, "mem", tags}
+  }));
+}
+
+TEST_F(PlannerTest, ScansWhenTooManyKeys) {
+  KeyPredicate predicate;
+  predicate.requireAnyTimestamp({1, 2, 3})
+    .requireAnyMetric({"cpu"})
+    .requireAnyTag({{"host", "a"}})
+    .requireAnyTag({{"region", "eu"}});
+
+  const auto plan{planQuery(
+    MIN_TIME_SERIES_KEY,
+    MAX_TIME_SERIES_KEY,
+    predicate,
+    tag_columns_,
+    2
+  )};
+
+  EXPECT_TRUE(std::holds_alternative<RangePlan>(plan));
+}
+
+TEST_F(PlannerTest, PlansNothingForContradictions) {
+  KeyPredicate disjoint_timestamps;
+  disjoint_timestamps.requireAnyTimestamp({1}).requireAnyTimestamp({2});
+  KeyPredicate conflicting_tags;
+  conflicting_tags.requireAnyTag({{"host", "a"}})
+    .requireAnyTag({{"host", "b"}});
+  KeyPredicate out_of_range;
+  out_of_range.requireAnyTimestamp({100});
+
+  for (const auto& predicate : {
+    disjoint_timestamps, conflicting_tags, out_of_range
+  }) {
+    const auto plan{planQuery(
+      TimeSeriesKey{0, MIN_METRIC, {}},
+      TimeSeriesKey{50, MAX_METRIC, {}},
+      predicate,
+      tag_columns_
+    )};
+    EXPECT_TRUE(std::holds_alternative<EmptyPlan>(plan));
+  }
+}
+
+TEST_F(PlannerTest, PlansNothingForUnindexedSeries) {
+  TagIndex tag_index;
+  tag_index.insert(TimeSeriesKey{0, "cpu", {{"host", "a"}}});
+  KeyPredicate predicate;
+  predicate.requireAnyTag({{"host", "b"}});
+
+  const auto plan{planQuery(
+    MIN_TIME_SERIES_KEY,
+    MAX_TIME_SERIES_KEY,
+    predicate,
+    tag_columns_,
+    DEFAULT_MAX_PLANNED_POINTS,
+    &tag_index
+  )};
+
+  EXPECT_TRUE(std::holds_alternative<EmptyPlan>(plan));
+}
+
+TEST_F(PlannerTest, LooksUpIndexedSeriesWithoutEveryTagColumn) {
+  TagIndex tag_index;
+  tag_index.insert(TimeSeriesKey{0, "cpu", {{"host", "a"}, {"region", "eu"}}});
+  tag_index.insert(TimeSeriesKey{0, "cpu", {{"host", "a"}, {"region", "us"}}});
+  tag_index.insert(TimeSeriesKey{0, "cpu", {{"host", "b"}, {"region", "eu"}}});
+  KeyPredicate predicate;
+  predicate.requireAnyTimestamp({20, 10}).requireAnyTag({{"host", "a"}});
+
+  const auto plan{planQuery(
+    MIN_TIME_SERIES_KEY,
+    MAX_TIME_SERIES_KEY,
+    predicate,
+    tag_columns_,
+    DEFAULT_MAX_PLANNED_POINTS,
+    &tag_index
+  )};
+
+  const auto points{std::get_if<PointPlan>(&plan)};
+  ASSERT_NE(points, nullptr);
+  ASSERT_EQ(points->keys.size(), 4);
+  EXPECT_TRUE(std::ranges::is_sorted(points->keys));
+  for (const auto& key : points->keys) {
+    EXPECT_EQ(key.tags().at("host"), "a");
+  }
+  EXPECT_EQ(points->keys.front().timestamp(), 10);
+  EXPECT_EQ(points->keys.back().timestamp(), 20);
+}
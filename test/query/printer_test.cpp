@@ -40,6 +40,28 @@ TEST(PrinterTest, CanPrintPutQuery) {
   EXPECT_EQ(result, "PUT metric 15 10 INTO table_name TAGS tag=value;");
 }
 
+TEST(PrinterTest, CanPrintPutValuesQuery) {
+  Expr put_query{PutValuesQuery{
+    MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table_name")},
+    std::nullopt,
+    {
+      {
+        TimestampExpr{make_token(TokenType::NUMBER, "1")},
+        ValueExpr{make_token(TokenType::NUMBER, "10")}
+      },
+      {
+        TimestampExpr{make_token(TokenType::NUMBER, "2")},
+        ValueExpr{make_token(TokenType::NUMBER, "20")}
+      }
+    }
+  }};
+
+  Printer printer;
+  auto result{printer.print(put_query)};
+  EXPECT_EQ(result, "PUT metric INTO table_name VALUES (1, 10), (2, 20);");
+}
+
 TEST(PrinterTest, CanPrintDeleteQueries) {
   Expr delete_query{DeleteQuery{
     MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
@@ -56,6 +78,26 @@ TEST(PrinterTest, CanPrintDeleteQueries) {
   EXPECT_EQ(result, "DELETE metric 15 FROM table_name TAGS tag=value;");
 }
 
+TEST(PrinterTest, CanPrintDeleteBetweenQuery) {
+  Expr delete_query{DeleteQuery{
+    MetricExpr{make_token(TokenType::IDENTIFIER, "metric")},
+    TimestampExpr{make_token(TokenType::NUMBER, "15")},
+    TableNameExpr{make_token(TokenType::IDENTIFIER, "table_name")},
+    TagListExpr{TagListExpr{
+      {{TagKeyExpr{make_token(TokenType::IDENTIFIER, "tag")},
+      TagValueExpr{make_token(TokenType::IDENTIFIER, "value")}}}
+    }},
+    TimestampExpr{make_token(TokenType::NUMBER, "30")}
+  }};
+
+  Printer printer;
+  auto result{printer.print(delete_query)};
+  EXPECT_EQ(
+    result,
+    "DELETE metric BETWEEN 15 AND 30 FROM table_name TAGS tag=value;"
+  );
+}
+
 TEST(PrinterTest, CanPrintCreateQuery) {
   Expr create_query{CreateQuery{
     TableNameExpr{make_token(TokenType::IDENTIFIER, "table_name")},
@@ -116,6 +158,20 @@ TEST(PrinterTest, CanPrintTablesQuery) {
   EXPECT_EQ(result, "TABLES;");
 }
 
+TEST(PrinterTest, CanPrintStatsQuery) {
+  Expr stats_query{
+    StatsQuery{make_token(TokenType::SHOW, "SHOW"), std::nullopt},
+    StatsQuery{
+      make_token(TokenType::SHOW, "SHOW"),
+      TableNameExpr{make_token(TokenType::IDENTIFIER, "table_name")}
+    }
+  };
+
+  Printer printer;
+  auto result{printer.print(stats_query)};
+  EXPECT_EQ(result, "SHOW STATS;SHOW STATS FROM table_name;");
+}
+
 TEST(PrinterTest, CanPrintMultipleQueries) {
   Expr all_queries{
   SelectQuery{
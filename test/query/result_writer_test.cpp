@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+#include <vkdb/result_writer.h>
+#include <vkdb/binary.h>
+#include <vkdb/string.h>
+#include <sstream>
+
+using namespace vkdb;
+
+TEST(ResultWriterTest, WritesDataPointsAsText) {
+  const std::vector<DataPoint<double>> datapoints{
+    {1, "temperature", {{"city", "london"}}, 10.5},
+    {2, "temperature", {{"city", "paris"}}, 11.0}
+  };
+  std::ostringstream stream;
+  {
+    ResultWriter writer{stream};
+    writer.beginDataPoints();
+    for (const auto& datapoint : datapoints) {
+      writer.writeDataPoint(datapoint);
+    }
+    writer.endDataPoints();
+    writer.beginDataPoints();
+    writer.endDataPoints();
+    writer.writeLine("42");
+  }
+  EXPECT_EQ(
+    stream.str(),
+    datapointsToString<double>(datapoints) + "\n[]\n42\n"
+  );
+}
+
+TEST(ResultWriterTest, WritesDataPointsAsCSV) {
+  std::ostringstream stream;
+  {
+    ResultWriter writer{stream, OutputFormat::CSV};
+    writer.beginDataPoints();
+    writer.writeDataPoint(
+      TimeSeriesKey{1, "temperature", {{"city", "london"}, {"unit", "c"}}},
+      10.5
+    );
+    writer.writeDataPoint(TimeSeriesKey{2, "temperature", {}}, 11.0);
+    writer.endDataPoints();
+  }
+  EXPECT_EQ(
+    stream.str(),
+    "timestamp,metric,tags,value\n"
+    "1,temperature,city=london;unit=c,10.5\n"
+    "2,temperature,,11\n"
+  );
+}
+
+TEST(ResultWriterTest, WritesDataPointsAsBinaryInChunks) {
+  constexpr auto POINTS{10'000};
+  std::ostringstream stream;
+  ResultWriter writer{stream, OutputFormat::BINARY};
+  writer.beginDataPoints();
+  for (Timestamp i{0}; i < POINTS; ++i) {
+    writer.writeDataPoint(TimeSeriesKey{i, "metric", {}}, i * 0.5);
+  }
+  EXPECT_FALSE(stream.str().empty());
+  writer.endDataPoints();
+  writer.flush();
+
+  const auto output{stream.str()};
+  ASSERT_TRUE(std::string_view{output}.starts_with(ResultWriter::RESULT_MAGIC));
+  auto pos{output.data() + ResultWriter::RESULT_MAGIC.size()};
+  const auto end{output.data() + output.size()};
+  for (Timestamp i{0}; i < POINTS; ++i) {
+    ASSERT_EQ(readBinary<uint8_t>(pos, end), 1);
+    EXPECT_EQ(keyFromBinary(pos, end), (TimeSeriesKey{i, "metric", {}}));
+    EXPECT_EQ(readBinary<double>(pos, end), i * 0.5);
+  }
+  EXPECT_EQ(readBinary<uint8_t>(pos, end), 0);
+  EXPECT_EQ(pos, end);
+}
@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include <vkdb/follower.h>
+#include <vkdb/server.h>
+#include <chrono>
+#include <thread>
+
+using namespace vkdb;
+
+class FollowerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    leader_ = std::make_unique<Database>("test_db");
+    follower_db_ = std::make_unique<Database>("test_follower_db");
+    server_ = std::make_unique<Server>(
+      *leader_,
+      ServerOptions{.port = 0, .worker_threads = 2}
+    );
+    server_->start();
+    leader_->createTable("sensors", TableOptions{
+      .mem_table_max_entries = 100,
+      .shards = 2,
+      .wal{.archive = true}
+    }).addTagColumn("region");
+  }
+
+  void TearDown() override {
+    server_.reset();
+    leader_->clear();
+    follower_db_->clear();
+  }
+
+  void put(Timestamp start, Timestamp end) {
+    auto& table{leader_->getTable("sensors")};
+    for (Timestamp i{start}; i < end; ++i) {
+      for (const auto* region : {"ldn", "nyc", "sfo"}) {
+        table.query()
+          .put(i, "temperature", {{"region", region}}, 1.0)
+          .execute();
+      }
+    }
+  }
+
+  [[nodiscard]] FollowerOptions options() const {
+    return FollowerOptions{.port = server_->port(), .tables = {"sensors"}};
+  }
+
+  std::unique_ptr<Database> leader_;
+  std::unique_ptr<Database> follower_db_;
+  std::unique_ptr<Server> server_;
+};
+
+TEST_F(FollowerTest, CanCatchUpWithLeader) {
+  put(0, 300);
+  Follower follower{*follower_db_, options()};
+  EXPECT_EQ(follower.poll(), 900);
+
+  auto& table{follower_db_->getTable("sensors")};
+  EXPECT_EQ(table.shardCount(), 2);
+  EXPECT_EQ(table.tagColumns(), TagColumns{"region"});
+  EXPECT_DOUBLE_EQ(table.query().whereMetricIs("temperature").sum(), 900);
+
+  put(300, 310);
+  leader_->getTable("sensors").query()
+    .remove(0, "temperature", {{"region", "ldn"}})
+    .execute();
+  EXPECT_EQ(follower.poll(), 31);
+  EXPECT_EQ(follower.poll(), 0);
+  EXPECT_DOUBLE_EQ(table.query().whereMetricIs("temperature").sum(), 929);
+}
+
+TEST_F(FollowerTest, ResumesFromSavedLSNs) {
+  put(0, 100);
+  {
+    Follower follower{*follower_db_, options()};
+    EXPECT_EQ(follower.poll(), 300);
+  }
+  put(100, 110);
+  Follower follower{*follower_db_, options()};
+  EXPECT_EQ(follower.poll(), 30);
+  EXPECT_DOUBLE_EQ(
+    follower_db_->getTable("sensors").query()
+      .whereMetricIs("temperature")
+      .count(),
+    330
+  );
+}
+
+TEST_F(FollowerTest, CanFollowInTheBackground) {
+  Follower follower{*follower_db_, {
+    .port = server_->port(),
+    .tables = {"sensors"},
+    .poll_interval = std::chrono::milliseconds{10}
+  }};
+  follower.start();
+  EXPECT_THROW(follower.start(), std::runtime_error);
+  put(0, 10);
+
+  const auto deadline{
+    std::chrono::steady_clock::now() + std::chrono::seconds{10}
+  };
+  while (std::chrono::steady_clock::now() < deadline) {
+    const auto tables{follower_db_->tables()};
+    if (!tables.empty() && follower_db_->getTable("sensors").query()
+      .whereMetricIs("temperature")
+      .count() == 30) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  follower.stop();
+  EXPECT_EQ(follower.lastError(), nullptr);
+  EXPECT_DOUBLE_EQ(
+    follower_db_->getTable("sensors").query()
+      .whereMetricIs("temperature")
+      .count(),
+    30
+  );
+}
+
+TEST_F(FollowerTest, ThrowsWhenShardCountsDiffer) {
+  follower_db_->createTable("sensors", TableOptions{.shards = 3});
+  Follower follower{*follower_db_, options()};
+  EXPECT_THROW(std::ignore = follower.poll(), std::runtime_error);
+}
+
+TEST_F(FollowerTest, ThrowsWithoutTables) {
+  EXPECT_THROW(Follower(*follower_db_, {}), std::invalid_argument);
+}
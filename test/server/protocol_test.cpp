@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include <vkdb/protocol.h>
+
+using namespace vkdb;
+
+TEST(ProtocolTest, CanReadFrameOnceItIsWhole) {
+  std::string buffer;
+  appendFrame(buffer, 2, 7, "payload");
+
+  Frame frame;
+  EXPECT_EQ(readFrame(buffer.substr(0, buffer.size() - 1), frame, 1024), 0);
+  ASSERT_EQ(readFrame(buffer, frame, 1024), buffer.size());
+  EXPECT_EQ(frame.type, 2);
+  EXPECT_EQ(frame.request_id, 7);
+  EXPECT_EQ(frame.payload, "payload");
+}
+
+TEST(ProtocolTest, ThrowsWhenFrameIsTooLarge) {
+  std::string buffer;
+  appendFrame(buffer, 2, 0, std::string(100, 'a'));
+
+  Frame frame;
+  EXPECT_THROW(std::ignore = readFrame(buffer, frame, 99), std::runtime_error);
+}
+
+TEST(ProtocolTest, CanEncodeAndDecodePutBatch) {
+  PutBatchRequest request{"sensors", {
+    {"temperature", {{"region", "eu"}}, {{10, 20.5}, {5, 21.0}, {1'000, 0.0}}},
+    {"humidity", {}, {}}
+  }};
+  std::string payload;
+  putBatchToBinary(payload, request);
+
+  const auto decoded{putBatchFromBinary(payload)};
+  EXPECT_EQ(decoded.table_name, "sensors");
+  ASSERT_EQ(decoded.series.size(), 2);
+  EXPECT_EQ(decoded.series[0].metric, "temperature");
+  EXPECT_EQ(decoded.series[0].tags, request.series[0].tags);
+  EXPECT_EQ(decoded.series[0].rows, request.series[0].rows);
+  EXPECT_EQ(decoded.series[1].metric, "humidity");
+  EXPECT_TRUE(decoded.series[1].rows.empty());
+
+  EXPECT_THROW(
+    std::ignore = putBatchFromBinary(payload.substr(0, payload.size() - 1)),
+    std::runtime_error
+  );
+}
+
+TEST(ProtocolTest, CanEncodeAndDecodeReplicate) {
+  std::string request_payload;
+  replicateRequestToBinary(request_payload, {"replica", "sensors", 3, 42});
+  const auto request{replicateRequestFromBinary(request_payload)};
+  EXPECT_EQ(request.follower, "replica");
+  EXPECT_EQ(request.table_name, "sensors");
+  EXPECT_EQ(request.shard, 3);
+  EXPECT_EQ(request.lsn, 42);
+
+  std::string response_payload;
+  replicateResponseToBinary(
+    response_payload,
+    {4, {"region"}, {"0 [{00000000000000000001}{metric}{}|1] 42\n", 43}}
+  );
+  const auto response{replicateResponseFromBinary(response_payload)};
+  EXPECT_EQ(response.shards, 4);
+  EXPECT_EQ(response.tag_columns, std::vector<TagKey>{"region"});
+  EXPECT_EQ(
+    response.chunk.records,
+    "0 [{00000000000000000001}{metric}{}|1] 42\n"
+  );
+  EXPECT_EQ(response.chunk.next_lsn, 43);
+}
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include <vkdb/server.h>
+#include <vkdb/client.h>
+
+using namespace vkdb;
+
+class ServerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    database_ = std::make_unique<Database>("test_db");
+    server_ = std::make_unique<Server>(
+      *database_,
+      ServerOptions{.port = 0, .worker_threads = 4}
+    );
+    server_->start();
+  }
+
+  void TearDown() override {
+    server_.reset();
+    database_->clear();
+  }
+
+  std::unique_ptr<Database> database_;
+  std::unique_ptr<Server> server_;
+};
+
+TEST_F(ServerTest, CanRunQueries) {
+  Client client{"127.0.0.1", server_->port()};
+  EXPECT_NO_THROW(client.ping());
+
+  client.query("CREATE TABLE sensors TAGS region;");
+  client.query("PUT temperature 1 20.5 INTO sensors TAGS region=eu;");
+  EXPECT_EQ(
+    client.query("SELECT COUNT temperature FROM sensors ALL;"),
+    "1\n"
+  );
+  EXPECT_EQ(
+    client.query("SELECT DATA temperature FROM sensors ALL;", OutputFormat::CSV),
+    "timestamp,metric,tags,value\n1,temperature,region=eu,20.5\n"
+  );
+}
+
+TEST_F(ServerTest, CanPutBatches) {
+  database_->createTable("sensors").addTagColumn("region");
+  Client client{"127.0.0.1", server_->port()};
+
+  PutBatchRequest request{"sensors", {{"temperature", {{"region", "eu"}}, {}}}};
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    request.series[0].rows.emplace_back(i, 1.0);
+  }
+  client.putBatch(request);
+
+  EXPECT_EQ(
+    client.query("SELECT COUNT temperature FROM sensors ALL WHERE region=eu;"),
+    "1000\n"
+  );
+
+  request.table_name = "missing";
+  EXPECT_THROW(client.putBatch(request), std::runtime_error);
+}
+
+TEST_F(ServerTest, CanPipelineRequests) {
+  database_->createTable("sensors");
+  Client client{"127.0.0.1", server_->port()};
+
+  std::vector<uint32_t> request_ids;
+  for (Timestamp i{0}; i < 100; ++i) {
+    request_ids.push_back(client.send(
+      MessageType::QUERY,
+      queryPayload(
+        "PUT temperature " + std::to_string(i) + " 1.0 INTO sensors;",
+        OutputFormat::TEXT
+      )
+    ));
+  }
+  request_ids.push_back(client.send(
+    MessageType::QUERY,
+    queryPayload("SELECT COUNT temperature FROM sensors ALL;", OutputFormat::TEXT)
+  ));
+
+  for (size_t i{0}; i < request_ids.size(); ++i) {
+    const auto response{client.receive()};
+    EXPECT_EQ(response.request_id, request_ids[i]);
+    ASSERT_EQ(response.type, static_cast<uint8_t>(ResponseStatus::OK));
+    if (i + 1 == request_ids.size()) {
+      EXPECT_EQ(response.payload, "100\n");
+    }
+  }
+}
+
+TEST_F(ServerTest, CanServeConcurrentClients) {
+  database_->createTable("sensors");
+
+  std::vector<std::thread> threads;
+  for (uint64_t t{0}; t < 4; ++t) {
+    threads.emplace_back([this, t] {
+      Client client{"127.0.0.1", server_->port()};
+      for (Timestamp i{0}; i < 50; ++i) {
+        client.query(
+          "PUT temperature " + std::to_string(t * 50 + i) + " 1.0 INTO sensors;"
+        );
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Client client{"127.0.0.1", server_->port()};
+  EXPECT_EQ(client.query("SELECT COUNT temperature FROM sensors ALL;"), "200\n");
+}
+
+TEST_F(ServerTest, CanGetStats) {
+  Client client{"127.0.0.1", server_->port()};
+  client.query("CREATE TABLE sensors TAGS region;");
+  client.query("PUT temperature 1 20.5 INTO sensors TAGS region=eu;");
+
+  const auto stats{client.stats()};
+  EXPECT_NE(
+    stats.find("vkdb_wal_append_seconds_count{table=\"sensors\"} 1\n"),
+    std::string::npos
+  );
+  EXPECT_NE(
+    client.query("SHOW STATS FROM sensors;").find("sensors flushes 0\n"),
+    std::string::npos
+  );
+}
+
+TEST_F(ServerTest, ReportsErrors) {
+  Client client{"127.0.0.1", server_->port()};
+
+  client.send(MessageType::QUERY, queryPayload("SELECT;", OutputFormat::TEXT));
+  EXPECT_EQ(
+    client.receive().type,
+    static_cast<uint8_t>(ResponseStatus::PARSE_ERROR)
+  );
+
+  client.send(
+    MessageType::QUERY,
+    queryPayload("SELECT DATA temperature FROM missing ALL;", OutputFormat::TEXT)
+  );
+  EXPECT_EQ(
+    client.receive().type,
+    static_cast<uint8_t>(ResponseStatus::RUNTIME_ERROR)
+  );
+
+  client.send(static_cast<MessageType>(99), {});
+  EXPECT_EQ(
+    client.receive().type,
+    static_cast<uint8_t>(ResponseStatus::PROTOCOL_ERROR)
+  );
+  EXPECT_NO_THROW(client.ping());
+}
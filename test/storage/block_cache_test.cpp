@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include <vkdb/block_cache.h>
+#include <stdexcept>
+
+using namespace vkdb;
+
+static BlockCache::Block make_block(int value) {
+  return std::make_shared<const int>(value);
+}
+
+static int block_value(const BlockCache::Block& block) {
+  return *std::static_pointer_cast<const int>(block);
+}
+
+TEST(BlockCacheTest, CanObtainBlockWhenPut) {
+  BlockCache cache{1'000, 1};
+  cache.put(1, 0, make_block(10), 100);
+  cache.put(2, 0, make_block(20), 100);
+
+  ASSERT_NE(cache.tryGet(1, 0), nullptr);
+  EXPECT_EQ(block_value(cache.tryGet(1, 0)), 10);
+  EXPECT_EQ(block_value(cache.tryGet(2, 0)), 20);
+  EXPECT_EQ(cache.tryGet(1, 8), nullptr);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.usage(), 200);
+}
+
+TEST(BlockCacheTest, EvictsLeastRecentlyUsedBlocksOverBudget) {
+  BlockCache cache{300, 1};
+  cache.put(1, 0, make_block(0), 100);
+  cache.put(1, 1, make_block(1), 100);
+  cache.put(1, 2, make_block(2), 100);
+  static_cast<void>(cache.tryGet(1, 0));
+
+  cache.put(1, 3, make_block(3), 150);
+
+  EXPECT_NE(cache.tryGet(1, 0), nullptr);
+  EXPECT_EQ(cache.tryGet(1, 1), nullptr);
+  EXPECT_EQ(cache.tryGet(1, 2), nullptr);
+  EXPECT_NE(cache.tryGet(1, 3), nullptr);
+  EXPECT_LE(cache.usage(), cache.capacity());
+}
+
+TEST(BlockCacheTest, SkipsBlocksLargerThanAShard) {
+  BlockCache cache{100, 1};
+  cache.put(1, 0, make_block(0), 101);
+
+  EXPECT_EQ(cache.tryGet(1, 0), nullptr);
+  EXPECT_EQ(cache.usage(), 0);
+}
+
+TEST(BlockCacheTest, CanReplaceAndClearBlocks) {
+  BlockCache cache{1'000};
+  cache.put(1, 0, make_block(0), 100);
+  cache.put(1, 0, make_block(1), 50);
+
+  EXPECT_EQ(block_value(cache.tryGet(1, 0)), 1);
+  EXPECT_EQ(cache.usage(), 50);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.tryGet(1, 0), nullptr);
+}
+
+TEST(BlockCacheTest, GivesOutFreshOwners) {
+  EXPECT_NE(BlockCache::newOwner(), BlockCache::newOwner());
+}
+
+TEST(BlockCacheTest, ThrowsWhenCapacityIsZero) {
+  EXPECT_THROW(BlockCache{0}, std::invalid_argument);
+  EXPECT_THROW((BlockCache{1, 0}), std::invalid_argument);
+}
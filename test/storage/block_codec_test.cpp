@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include <vkdb/block_codec.h>
+#include <limits>
+
+using namespace vkdb;
+
+template <typename TValue>
+static std::vector<TimeSeriesEntry<TValue>> round_trip(
+  const std::vector<TimeSeriesEntry<TValue>>& entries
+) {
+  BlockEncoder<TValue> encoder;
+  for (const auto& [key, value] : entries) {
+    encoder.add(key, value);
+  }
+  std::string buffer;
+  encoder.finish(buffer);
+
+  BlockDecoder<TValue> decoder{buffer.data(), buffer.data() + buffer.size()};
+  std::vector<TimeSeriesEntry<TValue>> decoded;
+  for (size_t i{0}; i < entries.size(); ++i) {
+    decoded.push_back(decoder.next());
+  }
+  return decoded;
+}
+
+TEST(BlockCodecTest, CanRoundTripEntriesOfManySeries) {
+  std::vector<TimeSeriesEntry<double>> entries;
+  for (Timestamp i{0}; i < 100; ++i) {
+    entries.emplace_back(TimeSeriesKey{i * 10, "cpu", {{"host", "a"}}}, i / 3.0);
+    entries.emplace_back(TimeSeriesKey{i * 10, "cpu", {{"host", "b"}}}, -1.5);
+    if (i % 7 == 0) {
+      entries.emplace_back(TimeSeriesKey{i * 10 + 3, "mem", {}}, std::nullopt);
+    }
+  }
+
+  EXPECT_EQ(round_trip(entries), entries);
+}
+
+TEST(BlockCodecTest, CanRoundTripExtremeValues) {
+  const std::vector<TimeSeriesEntry<int64_t>> entries{
+    {TimeSeriesKey{0, "metric", {}}, std::numeric_limits<int64_t>::min()},
+    {TimeSeriesKey{1, "metric", {}}, 0},
+    {TimeSeriesKey{1'000'000'000'000, "metric", {}}, -1},
+    {
+      TimeSeriesKey{std::numeric_limits<Timestamp>::max(), "metric", {}},
+      std::numeric_limits<int64_t>::max()
+    },
+  };
+
+  EXPECT_EQ(round_trip(entries), entries);
+}
+
+TEST(BlockCodecTest, CanRoundTripNarrowAndBoolValues) {
+  std::vector<TimeSeriesEntry<int32_t>> counters;
+  std::vector<TimeSeriesEntry<bool>> statuses;
+  std::vector<TimeSeriesEntry<float>> gauges;
+  for (Timestamp i{0}; i < 100; ++i) {
+    const TimeSeriesKey key{i, "metric", {}};
+    counters.emplace_back(
+      key, i % 2 == 0 ? std::numeric_limits<int32_t>::min() + i : -i
+    );
+    statuses.emplace_back(key, i % 3 == 0);
+    gauges.emplace_back(key, i / 7.0f);
+  }
+
+  EXPECT_EQ(round_trip(counters), counters);
+  EXPECT_EQ(round_trip(statuses), statuses);
+  EXPECT_EQ(round_trip(gauges), gauges);
+}
+
+TEST(BlockCodecTest, EncodesIntegersAsDeltas) {
+  BlockEncoder<int64_t> encoder;
+  for (Timestamp i{0}; i < 500; ++i) {
+    encoder.add(TimeSeriesKey{i * 60, "metric", {}}, i % 2 == 0 ? -1 : 1);
+  }
+  std::string buffer;
+  encoder.finish(buffer);
+
+  EXPECT_LT(buffer.size(), 5 * 500);
+}
+
+TEST(BlockCodecTest, EncodesRegularSeriesCompactly) {
+  BlockEncoder<int> encoder;
+  for (Timestamp i{0}; i < 500; ++i) {
+    encoder.add(TimeSeriesKey{1'700'000'000 + i * 60, "metric", {}}, 20 + i % 3);
+  }
+
+  EXPECT_EQ(encoder.entryCount(), 500);
+  EXPECT_LT(encoder.size(), 5 * 500);
+}
+
+TEST(BlockCodecTest, ThrowsWhenBlockIsTruncated) {
+  BlockEncoder<double> encoder;
+  encoder.add(TimeSeriesKey{1, "metric", {}}, 3.14);
+  std::string buffer;
+  encoder.finish(buffer);
+
+  BlockDecoder<double> decoder{buffer.data(), buffer.data() + buffer.size() - 1};
+  EXPECT_THROW(std::ignore = decoder.next(), std::runtime_error);
+  EXPECT_THROW(
+    (BlockDecoder<double>{buffer.data(), buffer.data() + 2}),
+    std::runtime_error
+  );
+}
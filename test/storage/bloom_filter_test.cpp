@@ -100,4 +100,60 @@ TEST_F(BloomFilterTest, ThrowsWhenFalsePositiveRateIsLessThanOrEqualToZero) {
 TEST_F(BloomFilterTest, ThrowsWhenFalsePositiveRateIsGreaterThanOrEqualToOne) {
   EXPECT_THROW((Filter{EXPECTED_NO_OF_ELEMS, 1.1}), std::invalid_argument);
   EXPECT_THROW((Filter{EXPECTED_NO_OF_ELEMS, 1.0}), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+TEST_F(BloomFilterTest, CanSaveAndLoadBinary) {
+  for (Key i{0}; i < EXPECTED_NO_OF_ELEMS; ++i) {
+    auto t_i{static_cast<Timestamp>(i)};
+    TimeSeriesKey key{t_i, "metric", {{"tag", "value"}}};
+    filter_->insert(key);
+  }
+
+  std::string buffer;
+  filter_->toBinary(buffer);
+  const auto* pos{buffer.data()};
+  auto loaded{Filter::fromBinary(pos, buffer.data() + buffer.size())};
+
+  EXPECT_EQ(pos, buffer.data() + buffer.size());
+  EXPECT_EQ(loaded.blockCount(), filter_->blockCount());
+  EXPECT_EQ(loaded.probeCount(), filter_->probeCount());
+  for (Key i{0}; i < 2 * EXPECTED_NO_OF_ELEMS; ++i) {
+    auto t_i{static_cast<Timestamp>(i)};
+    TimeSeriesKey key{t_i, "metric", {{"tag", "value"}}};
+    EXPECT_EQ(loaded.mayContain(key), filter_->mayContain(key));
+  }
+}
+
+TEST_F(BloomFilterTest, ThrowsWhenLoadingTruncatedBinary) {
+  std::string buffer;
+  filter_->toBinary(buffer);
+  buffer.pop_back();
+  const auto* pos{buffer.data()};
+
+  EXPECT_THROW(
+    std::ignore = Filter::fromBinary(pos, buffer.data() + buffer.size()),
+    std::runtime_error
+  );
+}
+
+TEST_F(BloomFilterTest, CanCheckBatchOfHashedKeys) {
+  std::vector<BloomFilter::hash_type> hashes;
+  for (Key i{0}; i < 2 * EXPECTED_NO_OF_ELEMS; ++i) {
+    auto t_i{static_cast<Timestamp>(i)};
+    TimeSeriesKey key{t_i, "metric", {{"tag", "value"}}};
+    if (i < EXPECTED_NO_OF_ELEMS) {
+      filter_->insert(key);
+    }
+    hashes.push_back(Filter::hash(key));
+  }
+
+  const auto results{std::make_unique<bool[]>(hashes.size())};
+  filter_->mayContainBatch(hashes, {results.get(), hashes.size()});
+
+  for (size_t i{0}; i < hashes.size(); ++i) {
+    EXPECT_EQ(results[i], filter_->mayContain(hashes[i]));
+    if (i < EXPECTED_NO_OF_ELEMS) {
+      EXPECT_TRUE(results[i]);
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include <vkdb/compression.h>
+#include <random>
+#include <stdexcept>
+
+using namespace vkdb;
+
+static std::string round_trip(Compression codec, const std::string& data) {
+  const auto compressed{compress(codec, data)};
+  std::string decompressed(data.size(), '\0');
+  decompress(codec, compressed, decompressed);
+  return decompressed;
+}
+
+TEST(CompressionTest, CanRoundTripRepetitiveDataWithLZ4) {
+  std::string data;
+  for (auto i{0}; i < 1'000; ++i) {
+    data += "cpu,host=server-" + std::to_string(i % 10) + " value=0.5\n";
+  }
+
+  const auto compressed{compress(Compression::LZ4, data)};
+
+  EXPECT_LT(compressed.size() * 4, data.size());
+  EXPECT_EQ(round_trip(Compression::LZ4, data), data);
+}
+
+TEST(CompressionTest, CanRoundTripLongRunsAndShortInputsWithLZ4) {
+  EXPECT_EQ(round_trip(Compression::LZ4, ""), "");
+  EXPECT_EQ(round_trip(Compression::LZ4, "abc"), "abc");
+  const std::string run(100'000, 'x');
+  EXPECT_EQ(round_trip(Compression::LZ4, run), run);
+
+  std::mt19937 gen{42};
+  std::string random(5'000, '\0');
+  for (auto& c : random) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_EQ(round_trip(Compression::LZ4, random), random);
+  EXPECT_EQ(round_trip(Compression::LZ4, random + random), random + random);
+}
+
+TEST(CompressionTest, ThrowsWhenDecompressingMalformedData) {
+  const std::string data(1'000, 'y');
+  const auto compressed{compress(Compression::LZ4, data)};
+
+  std::string too_small(data.size() - 1, '\0');
+  EXPECT_THROW(
+    decompress(Compression::LZ4, compressed, too_small),
+    std::runtime_error
+  );
+  std::string out(data.size(), '\0');
+  EXPECT_THROW(
+    decompress(Compression::LZ4, compressed.substr(0, 3), out),
+    std::runtime_error
+  );
+}
+
+TEST(CompressionTest, CanUseZstdOnlyIfAvailable) {
+  const std::string data(1'000, 'z');
+  if (compressionAvailable(Compression::ZSTD)) {
+    EXPECT_EQ(round_trip(Compression::ZSTD, data), data);
+  } else {
+    EXPECT_THROW(
+      static_cast<void>(compress(Compression::ZSTD, data)),
+      std::invalid_argument
+    );
+  }
+}
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include <vkdb/io_backend.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace vkdb;
+
+class IOBackendTest : public ::testing::TestWithParam<IOBackend> {
+protected:
+  void SetUp() override {
+    directory_ = "test_io_backend";
+    std::filesystem::create_directories(directory_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(directory_);
+  }
+
+  static std::string read(const std::filesystem::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, {}};
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST(IOBackendAvailabilityTest, PosixIsAlwaysAvailable) {
+  EXPECT_TRUE(ioBackendAvailable(IOBackend::POSIX));
+}
+
+TEST_P(IOBackendTest, CanWriteAndReplaceFile) {
+  const auto path{directory_ / "file"};
+  std::string data;
+  for (auto i{0}; i < 100'000; ++i) {
+    data += std::to_string(i) + "\n";
+  }
+
+  writeFile(GetParam(), path, data, true);
+  EXPECT_EQ(read(path), data);
+
+  writeFile(GetParam(), path, "short", false);
+  EXPECT_EQ(read(path), "short");
+
+  writeFile(GetParam(), path, "", true);
+  EXPECT_EQ(read(path), "");
+}
+
+TEST_P(IOBackendTest, CanWriteAtOffsets) {
+  const auto path{directory_ / "file"};
+  const auto fd{::open(path.c_str(), O_WRONLY | O_CREAT, 0644)};
+  ASSERT_NE(fd, -1);
+
+  const auto first{writeAt(GetParam(), fd, 0, "hello ", false)};
+  const auto second{writeAt(GetParam(), fd, 6, "world", true)};
+  const auto sync_only{writeAt(GetParam(), fd, 11, "", true)};
+  ::close(fd);
+
+  EXPECT_TRUE(first);
+  EXPECT_EQ(first.written, 6);
+  EXPECT_TRUE(second);
+  EXPECT_EQ(second.written, 5);
+  EXPECT_TRUE(sync_only);
+  EXPECT_EQ(read(path), "hello world");
+}
+
+TEST_P(IOBackendTest, ReportsErrorOfFailedWrite) {
+  const auto path{directory_ / "file"};
+  std::ofstream{path} << "data";
+  const auto fd{::open(path.c_str(), O_RDONLY)};
+  ASSERT_NE(fd, -1);
+
+  const auto result{writeAt(GetParam(), fd, 0, "data", false)};
+  ::close(fd);
+
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.error, EBADF);
+  EXPECT_EQ(result.written, 0);
+}
+
+TEST_P(IOBackendTest, ThrowsWhenUnableToOpenFile) {
+  EXPECT_THROW(
+    writeFile(GetParam(), directory_ / "missing" / "file", "data", false),
+    std::runtime_error
+  );
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  Backends,
+  IOBackendTest,
+  ::testing::Values(IOBackend::POSIX, IOBackend::IO_URING)
+);
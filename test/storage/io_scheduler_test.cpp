@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+#include <vkdb/io_scheduler.h>
+#include <vkdb/lsm_tree.h>
+#include <atomic>
+#include <thread>
+
+using namespace vkdb;
+
+TEST(IOSchedulerTest, GrantsAtOnceWithoutRateLimit) {
+  IOScheduler scheduler;
+  const auto start{std::chrono::steady_clock::now()};
+  scheduler.request(IOPriority::COMPACTION, 1ULL << 40);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{1});
+  EXPECT_EQ(scheduler.grantedBytes(IOPriority::COMPACTION), 1ULL << 40);
+  EXPECT_EQ(scheduler.grantedBytes(IOPriority::WAL), 0);
+}
+
+TEST(IOSchedulerTest, LimitsRate) {
+  IOScheduler scheduler{{
+    .bytes_per_second = 10'000'000,
+    .burst_bytes = 100'000
+  }};
+  const auto start{std::chrono::steady_clock::now()};
+  scheduler.request(IOPriority::FLUSH, 1'100'000);
+  EXPECT_GE(
+    std::chrono::steady_clock::now() - start, std::chrono::milliseconds{90}
+  );
+  EXPECT_EQ(scheduler.grantedBytes(IOPriority::FLUSH), 1'100'000);
+}
+
+TEST(IOSchedulerTest, ServesHigherPrioritiesFirst) {
+  IOScheduler scheduler{{
+    .bytes_per_second = 1'000'000,
+    .burst_bytes = 100'000,
+    .foreground_latency_target = std::chrono::nanoseconds{0}
+  }};
+  scheduler.request(IOPriority::FLUSH, 100'000);
+
+  std::atomic<int> order{0};
+  int compaction_order{0};
+  int wal_order{0};
+  std::thread compaction{[&] {
+    scheduler.request(IOPriority::COMPACTION, 100'000);
+    compaction_order = ++order;
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  std::thread wal{[&] {
+    scheduler.request(IOPriority::WAL, 50'000);
+    wal_order = ++order;
+  }};
+  compaction.join();
+  wal.join();
+
+  EXPECT_EQ(wal_order, 1);
+  EXPECT_EQ(compaction_order, 2);
+}
+
+TEST(IOSchedulerTest, BacksCompactionOffWhileForegroundIsSlow) {
+  IOScheduler scheduler{{
+    .bytes_per_second = 1'000'000'000,
+    .foreground_latency_target = std::chrono::milliseconds{1},
+    .min_compaction_share = 0.25
+  }};
+  scheduler.request(IOPriority::COMPACTION, 1);
+  EXPECT_DOUBLE_EQ(scheduler.compactionShare(), 1.0);
+
+  scheduler.recordForegroundLatency(std::chrono::milliseconds{10});
+  scheduler.request(IOPriority::COMPACTION, 1);
+  EXPECT_DOUBLE_EQ(scheduler.compactionShare(), 0.5);
+  for (auto i{0}; i < 4; ++i) {
+    scheduler.request(IOPriority::COMPACTION, 1);
+  }
+  EXPECT_DOUBLE_EQ(scheduler.compactionShare(), 0.25);
+}
+
+TEST(IOSchedulerTest, ThrowsOnInvalidOptions) {
+  EXPECT_THROW(
+    IOScheduler(IOSchedulerOptions{.burst_bytes = 0}),
+    std::invalid_argument
+  );
+  EXPECT_THROW(
+    IOScheduler(IOSchedulerOptions{.min_compaction_share = 0.0}),
+    std::invalid_argument
+  );
+  EXPECT_THROW(
+    IOScheduler(IOSchedulerOptions{
+      .foreground_latency_target = std::chrono::nanoseconds{-1}
+    }),
+    std::invalid_argument
+  );
+}
+
+TEST(IOSchedulerTest, GrantsLSMTreeWritesByPriority) {
+  const auto scheduler{std::make_shared<IOScheduler>()};
+  {
+    LSMTree<int> lsm_tree{
+      "test_lsm_tree",
+      LSMTreeOptions{.mem_table_max_entries = 10, .io_scheduler = scheduler}
+    };
+    for (Timestamp i{0}; i < 200; ++i) {
+      lsm_tree.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+    }
+    lsm_tree.clear();
+  }
+
+  EXPECT_GT(scheduler->grantedBytes(IOPriority::WAL), 0);
+  EXPECT_GT(scheduler->grantedBytes(IOPriority::FLUSH), 0);
+  EXPECT_GT(scheduler->grantedBytes(IOPriority::COMPACTION), 0);
+  EXPECT_EQ(scheduler->grantedBytes(IOPriority::READ), 0);
+}
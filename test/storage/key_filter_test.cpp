@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include <vkdb/key_filter.h>
+
+using namespace vkdb;
+
+TEST(KeyFilterTest, CanMatchMetricsTagsAndTimestamps) {
+  const TimeSeriesKey key{1, "metric", {{"tag1", "value1"}}};
+
+  EXPECT_TRUE(AnyKey{}(key));
+  EXPECT_TRUE(MetricEq{"metric"}(key));
+  EXPECT_FALSE(MetricEq{"other"}(key));
+  EXPECT_TRUE((TagEq{"tag1", "value1"}(key)));
+  EXPECT_FALSE((TagEq{"tag1", "value2"}(key)));
+  EXPECT_FALSE((TagEq{"tag2", "value1"}(key)));
+  EXPECT_TRUE(TimestampEq{1}(key));
+  EXPECT_FALSE(TimestampEq{2}(key));
+}
+
+TEST(KeyFilterTest, CanComposeFilters) {
+  const TimeSeriesKey key{1, "metric", {{"tag1", "value1"}}};
+  const auto filter{
+    MetricEq{"metric"} && TagEq{"tag1", "value1"} && TimestampEq{1}
+  };
+  static_assert(
+    std::same_as<
+      std::remove_cvref_t<decltype(filter)>,
+      AllOf<MetricEq, TagEq, TimestampEq>
+    >
+  );
+
+  EXPECT_TRUE(filter(key));
+  EXPECT_FALSE(filter(TimeSeriesKey{2, "metric", {{"tag1", "value1"}}}));
+  EXPECT_FALSE(filter(TimeSeriesKey{1, "metric", {{"tag1", "value2"}}}));
+}
+
+TEST(KeyFilterTest, MatchesSameKeysAsItsPredicate) {
+  KeyPredicate runtime;
+  runtime.requireAnyTag({Tag{"tag2", "value2"}});
+  const auto filter{MetricEq{"metric"} && MatchesPredicate{runtime}};
+  const auto predicate{toPredicate(filter)};
+
+  for (const auto& key : {
+    TimeSeriesKey{1, "metric", {{"tag2", "value2"}}},
+    TimeSeriesKey{1, "metric", {{"tag2", "value3"}}},
+    TimeSeriesKey{1, "other", {{"tag2", "value2"}}},
+    TimeSeriesKey{1, "metric", {}}
+  }) {
+    EXPECT_EQ(filter(key), predicate.matches(key));
+  }
+  EXPECT_TRUE(toPredicate(AnyKey{}).empty());
+}
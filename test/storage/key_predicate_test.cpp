@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include <vkdb/key_predicate.h>
+
+using namespace vkdb;
+
+class KeyPredicateTest : public ::testing::Test {
+protected:
+  static SeriesSummary summary_of(const std::vector<TimeSeriesKey>& keys) {
+    SeriesSummary summary;
+    for (const auto& key : keys) {
+      summary.insert(key);
+    }
+    return summary;
+  }
+};
+
+TEST_F(KeyPredicateTest, EmptyPredicateMatchesEverything) {
+  KeyPredicate predicate;
+
+  EXPECT_TRUE(predicate.empty());
+  EXPECT_TRUE(predicate.matches(TimeSeriesKey{1, "metric", {}}));
+  EXPECT_TRUE(predicate.mayMatch(SeriesSummary{}, TimeRange{}));
+  EXPECT_TRUE(predicate.mayMatch(0));
+}
+
+TEST_F(KeyPredicateTest, CanMatchConjunctionOfClauses) {
+  KeyPredicate predicate;
+  predicate.requireAnyMetric({"cpu", "mem"})
+    .requireAnyTag({{"host", "a"}})
+    .requireAnyTimestamp({1, 2});
+
+  EXPECT_FALSE(predicate.empty());
+  EXPECT_TRUE(predicate.matches(TimeSeriesKey{1, "cpu", {{"host", "a"}}}));
+  EXPECT_TRUE(predicate.matches(TimeSeriesKey{2, "mem", {{"host", "a"}}}));
+  EXPECT_FALSE(predicate.matches(TimeSeriesKey{3, "cpu", {{"host", "a"}}}));
+  EXPECT_FALSE(predicate.matches(TimeSeriesKey{1, "disk", {{"host", "a"}}}));
+  EXPECT_FALSE(predicate.matches(TimeSeriesKey{1, "cpu", {{"host", "b"}}}));
+  EXPECT_FALSE(predicate.matches(TimeSeriesKey{1, "cpu", {}}));
+}
+
+TEST_F(KeyPredicateTest, CanRuleOutSummaries) {
+  const auto summary{summary_of({
+    TimeSeriesKey{1, "cpu", {{"host", "a"}}},
+    TimeSeriesKey{2, "cpu", {{"host", "b"}}},
+    TimeSeriesKey{3, "mem", {{"host", "a"}}}
+  })};
+  const TimeRange time_range{1, 3};
+
+  EXPECT_TRUE(KeyPredicate{}.requireAnyMetric({"mem"})
+    .mayMatch(summary, time_range));
+  EXPECT_FALSE(KeyPredicate{}.requireAnyMetric({"disk"})
+    .mayMatch(summary, time_range));
+  EXPECT_TRUE(KeyPredicate{}.requireAnyTag({{"host", "c"}, {"host", "b"}})
+    .mayMatch(summary, time_range));
+  EXPECT_FALSE(KeyPredicate{}.requireAnyTag({{"host", "c"}})
+    .mayMatch(summary, time_range));
+  EXPECT_FALSE(KeyPredicate{}.requireAnyTimestamp({0, 4})
+    .mayMatch(summary, time_range));
+  EXPECT_TRUE(KeyPredicate{}.requireAnyMetric({"disk"})
+    .mayMatch(SeriesSummary::saturatedSummary(), time_range));
+}
+
+TEST_F(KeyPredicateTest, CanRuleOutBlockMasks) {
+  const TimeSeriesKey key{1, "cpu", {{"host", "a"}}};
+  const auto mask{SeriesSummary::keyMask(key)};
+
+  EXPECT_TRUE(KeyPredicate{}.requireAnyMetric({"cpu"}).mayMatch(mask));
+  EXPECT_TRUE(KeyPredicate{}.requireAnyTag({{"host", "a"}}).mayMatch(mask));
+  EXPECT_TRUE(KeyPredicate{}.requireAnyTimestamp({9}).mayMatch(mask));
+  EXPECT_TRUE(KeyPredicate{}.requireAnyMetric({"disk"})
+    .mayMatch(SeriesSummary::FULL_MASK));
+  EXPECT_FALSE(KeyPredicate{}.requireAnyMetric({"cpu"}).mayMatch(
+    ~SeriesSummary::metricMask("cpu")
+  ));
+}
+
+TEST_F(KeyPredicateTest, SummarySaturatesPastMaxValues) {
+  SeriesSummary summary;
+  for (SeriesSummary::size_type i{0}; i <= SeriesSummary::MAX_VALUES; ++i) {
+    summary.insert(TimeSeriesKey{i, "metric" + std::to_string(i), {}});
+  }
+
+  EXPECT_TRUE(summary.saturated());
+  EXPECT_TRUE(summary.mayContainMetric("other"));
+}
+
+TEST_F(KeyPredicateTest, CanSaveAndLoadSummaryBinary) {
+  const auto summary{summary_of({
+    TimeSeriesKey{1, "cpu", {{"host", "a"}, {"region", "eu"}}}
+  })};
+  std::string buffer;
+  summary.toBinary(buffer);
+  const auto* pos{buffer.data()};
+  const auto loaded{SeriesSummary::fromBinary(pos, pos + buffer.size())};
+
+  EXPECT_EQ(pos, buffer.data() + buffer.size());
+  EXPECT_FALSE(loaded.saturated());
+  EXPECT_TRUE(loaded.mayContainMetric("cpu"));
+  EXPECT_FALSE(loaded.mayContainMetric("mem"));
+  EXPECT_TRUE(loaded.mayContainTag({"region", "eu"}));
+  EXPECT_FALSE(loaded.mayContainTag({"region", "us"}));
+
+  const auto* truncated{buffer.data()};
+  EXPECT_THROW(
+    std::ignore = SeriesSummary::fromBinary(truncated, truncated + 3),
+    std::runtime_error
+  );
+}
+
+TEST_F(KeyPredicateTest, CanIntersectClauses) {
+  KeyPredicate predicate;
+  predicate.requireAnyTimestamp({3, 1, 2})
+    .requireAnyTimestamp({2, 3, 4})
+    .requireAnyMetric({"cpu", "mem"})
+    .requireAnyTag({{"host", "a"}})
+    .requireAnyTag({{"region", "eu"}, {"region", "us"}});
+
+  EXPECT_EQ(predicate.timestamps(), (std::vector<Timestamp>{2, 3}));
+  EXPECT_EQ(predicate.metrics(), (std::vector<Metric>{"cpu", "mem"}));
+  EXPECT_EQ(predicate.requiredTags(), (TagTable{{"host", "a"}}));
+}
+
+TEST_F(KeyPredicateTest, UnconstrainedClausesAreUnknown) {
+  KeyPredicate predicate;
+  predicate.requireAnyTag({{"host", "a"}}).requireAnyTag({{"host", "b"}});
+
+  EXPECT_FALSE(predicate.timestamps().has_value());
+  EXPECT_FALSE(predicate.metrics().has_value());
+  EXPECT_FALSE(predicate.requiredTags().has_value());
+}
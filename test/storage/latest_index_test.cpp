@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include <vkdb/latest_index.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace vkdb;
+
+TEST(LatestIndexTest, KeepsTheNewestPutOfEachResolvedSeries) {
+  LatestIndex<int> index;
+  const TimeSeriesKey a{10, "cpu", {{"host", "a"}}};
+  const TimeSeriesKey b{20, "cpu", {{"host", "b"}}};
+  EXPECT_FALSE(index.find(a.seriesId()).has_value());
+
+  const std::vector<SeriesId> series{a.seriesId(), b.seriesId()};
+  ASSERT_TRUE(index.resolve(series, {}, index.epoch()));
+  index.put(a, 1);
+  index.put(TimeSeriesKey{5, "cpu", {{"host", "a"}}}, 2);
+  index.put(TimeSeriesKey{30, "cpu", {{"host", "a"}}}, 3);
+
+  const auto latest_a{index.find(a.seriesId())};
+  ASSERT_TRUE(latest_a.has_value() && latest_a->has_value());
+  EXPECT_EQ((*latest_a)->timestamp, 30);
+  EXPECT_EQ((*latest_a)->value, 3);
+  const auto latest_b{index.find(b.seriesId())};
+  ASSERT_TRUE(latest_b.has_value());
+  EXPECT_FALSE(latest_b->has_value());
+}
+
+TEST(LatestIndexTest, UnresolvesSeriesWhoseNewestValueIsRemoved) {
+  LatestIndex<int> index;
+  const TimeSeriesKey a{10, "cpu", {{"host", "a"}}};
+  const TimeSeriesKey b{20, "cpu", {{"host", "b"}}};
+  const std::vector<SeriesId> series{a.seriesId(), b.seriesId()};
+  ASSERT_TRUE(index.resolve(series, {}, index.epoch()));
+  index.put(a, 1);
+  index.put(b, 2);
+
+  index.remove(TimeSeriesKey{5, "cpu", {{"host", "a"}}});
+  EXPECT_TRUE(index.find(a.seriesId()).has_value());
+  index.remove(a);
+  EXPECT_FALSE(index.find(a.seriesId()).has_value());
+
+  index.removeRange(RangeTombstone{
+    0, 100, "cpu", {}
+  });
+  EXPECT_FALSE(index.find(b.seriesId()).has_value());
+}
+
+TEST(LatestIndexTest, DiscardsResolutionsThatRacedWithARemoval) {
+  LatestIndex<int> index;
+  const TimeSeriesKey a{10, "cpu", {{"host", "a"}}};
+  const std::vector<SeriesId> series{a.seriesId()};
+  const std::unordered_map<SeriesId, LatestValue<int>> found{
+    {a.seriesId(), {10, 1}}
+  };
+
+  const auto epoch{index.epoch()};
+  index.remove(a);
+  EXPECT_FALSE(index.resolve(series, found, epoch));
+  EXPECT_FALSE(index.find(a.seriesId()).has_value());
+
+  index.put(TimeSeriesKey{20, "cpu", {{"host", "a"}}}, 2);
+  EXPECT_TRUE(index.resolve(series, found, index.epoch()));
+  const auto latest{index.find(a.seriesId())};
+  ASSERT_TRUE(latest.has_value() && latest->has_value());
+  EXPECT_EQ((*latest)->timestamp, 20);
+  EXPECT_EQ((*latest)->value, 2);
+}
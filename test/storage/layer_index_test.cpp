@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include <vkdb/layer_index.h>
+#include <vkdb/random.h>
+
+using namespace vkdb;
+
+class LayerIndexTest : public ::testing::Test {
+protected:
+  using Positions = LayerIndex::Positions;
+
+  static Positions brute_force_overlapping(
+    const std::vector<TimeRange>& ranges,
+    Timestamp start,
+    Timestamp end
+  ) {
+    Positions positions;
+    for (LayerIndex::size_type i{0}; i < ranges.size(); ++i) {
+      if (ranges[i].overlapsWith(start, end)) {
+        positions.push_back(i);
+      }
+    }
+    return positions;
+  }
+};
+
+TEST_F(LayerIndexTest, CanFindOverlappingDisjointRanges) {
+  std::vector<TimeRange> ranges{
+    TimeRange{0, 9}, TimeRange{10, 19}, TimeRange{30, 39}, TimeRange{40, 49}
+  };
+  LayerIndex index{ranges};
+
+  EXPECT_TRUE(index.disjoint());
+  EXPECT_EQ(index.size(), 4);
+  EXPECT_EQ(index.overlapping(5, 5), (Positions{0}));
+  EXPECT_EQ(index.overlapping(9, 10), (Positions{0, 1}));
+  EXPECT_EQ(index.overlapping(20, 29), (Positions{}));
+  EXPECT_EQ(index.overlapping(15, 45), (Positions{1, 2, 3}));
+  EXPECT_EQ(index.overlapping(50, 60), (Positions{}));
+  EXPECT_EQ(index.overlapping(10, 5), (Positions{}));
+}
+
+TEST_F(LayerIndexTest, CanFindOverlappingRangesInAnyOrder) {
+  std::vector<TimeRange> ranges;
+  for (auto i{0}; i < 200; ++i) {
+    const auto lower{random<Timestamp>(0, 1'000)};
+    ranges.emplace_back(lower, lower + random<Timestamp>(0, 100));
+  }
+  LayerIndex index{ranges};
+
+  EXPECT_FALSE(index.disjoint());
+  for (auto i{0}; i < 200; ++i) {
+    const auto start{random<Timestamp>(0, 1'100)};
+    const auto end{start + random<Timestamp>(0, 50)};
+    EXPECT_EQ(
+      index.overlapping(start, end),
+      brute_force_overlapping(ranges, start, end)
+    );
+  }
+}
+
+TEST_F(LayerIndexTest, IgnoresUnsetRanges) {
+  std::vector<TimeRange> ranges{TimeRange{0, 9}, TimeRange{}, TimeRange{5, 15}};
+  LayerIndex index{ranges};
+
+  EXPECT_FALSE(index.disjoint());
+  EXPECT_EQ(index.size(), 2);
+  EXPECT_EQ(index.overlapping(0, 100), (Positions{0, 2}));
+}
@@ -101,3 +101,16 @@ TEST_F(LRUCacheTest, ContentsEmptiedWhenCacheCleared) {
 TEST_F(LRUCacheTest, ThrowsWhenCapacityIsZero) {
   EXPECT_THROW((Cache{0}), std::invalid_argument);
 }
+
+TEST_F(LRUCacheTest, CanTryGetAndTouchInOneCall) {
+  cache_->put(1, 1);
+  cache_->put(2, 2);
+  cache_->put(3, 3);
+
+  EXPECT_EQ(cache_->tryGet(1), std::optional<std::optional<Value>>{1});
+  EXPECT_EQ(cache_->tryGet(4), std::nullopt);
+  cache_->put(4, 4);
+
+  EXPECT_TRUE(cache_->contains(1));
+  EXPECT_FALSE(cache_->contains(2));
+}
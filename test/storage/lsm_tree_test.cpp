@@ -1,5 +1,11 @@
 #include "gtest/gtest.h"
 #include <vkdb/lsm_tree.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
 
 using namespace vkdb;
 
@@ -325,3 +331,1169 @@ TEST_F(LSMTreeTest, CanGetRangeWithFlushing) {
   
   EXPECT_EQ(entries.size(), 100'000);
 }
+
+TEST_F(LSMTreeTest, ThrowsWhenStallThresholdIsTooLow) {
+  EXPECT_THROW(
+    (LSMTree<int>{directory_, LSMTreeOptions{.c0_stall_threshold = 10}}),
+    std::invalid_argument
+  );
+}
+
+TEST_F(LSMTreeTest, CanCompactInBackground) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  for (Timestamp i{0}; i < 50'000; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    lsm_tree_->put(key, i);
+    if (i % 5'000 == 0) {
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i / 2, "metric", {}}), i / 2);
+    }
+  }
+  lsm_tree_->waitForCompaction();
+
+  EXPECT_LE(lsm_tree_->sstableCount(0), 10);
+  for (Timestamp i{0}; i < 50'000; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    EXPECT_EQ(lsm_tree_->get(key), i);
+  }
+
+  auto entries{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{100'000, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  EXPECT_EQ(entries.size(), 50'000);
+}
+
+TEST_F(LSMTreeTest, CanReloadAfterBackgroundCompaction) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  for (Timestamp i{0}; i < 20'000; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    lsm_tree_->put(key, i);
+  }
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+
+  for (Timestamp i{0}; i < 20'000; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    EXPECT_EQ(lsm_tree_->get(key), i);
+  }
+}
+
+TEST_F(LSMTreeTest, ThrowsWhenNoImmutableMemTablesAreAllowed) {
+  EXPECT_THROW(
+    (LSMTree<int>{directory_, LSMTreeOptions{.max_immutable_mem_tables = 0}}),
+    std::invalid_argument
+  );
+}
+
+TEST_F(LSMTreeTest, CanReadWhileMemTablesAreFrozen) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  for (Timestamp i{0}; i < 5'500; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    lsm_tree_->put(key, i);
+    EXPECT_EQ(lsm_tree_->get(key), i);
+  }
+
+  auto entries{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{10'000, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  EXPECT_EQ(entries.size(), 5'500);
+
+  lsm_tree_->waitForCompaction();
+  EXPECT_EQ(lsm_tree_->sstableCount(), 5);
+  for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+    EXPECT_FALSE(file.path().filename().string().starts_with("wal.log."));
+  }
+}
+
+TEST_F(LSMTreeTest, CanReplayWriteAheadLogAfterFreezing) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  for (Timestamp i{0}; i < 1'500; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    lsm_tree_->put(key, i);
+  }
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  lsm_tree_->replayWAL();
+
+  for (Timestamp i{0}; i < 1'500; ++i) {
+    TimeSeriesKey key{i, "metric", {}};
+    EXPECT_EQ(lsm_tree_->get(key), i);
+  }
+  EXPECT_EQ(lsm_tree_->sstableCount(), 1);
+}
+
+TEST_F(LSMTreeTest, CanReadAndWriteConcurrently) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  constexpr Timestamp no_of_entries{20'000};
+  std::atomic<Timestamp> written{0};
+  std::atomic<bool> mismatch{false};
+
+  std::thread writer{[&] {
+    for (Timestamp i{0}; i < no_of_entries; ++i) {
+      lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+      written.store(i + 1, std::memory_order_release);
+    }
+  }};
+
+  std::vector<std::thread> readers;
+  for (auto r{0}; r < 4; ++r) {
+    readers.emplace_back([&, r] {
+      while (written.load(std::memory_order_acquire) < no_of_entries) {
+        const auto bound{written.load(std::memory_order_acquire)};
+        if (bound == 0) {
+          continue;
+        }
+        const Timestamp i{(bound * (r + 1) / 5) % bound};
+        if (lsm_tree_->get(TimeSeriesKey{i, "metric", {}}) != i) {
+          mismatch = true;
+        }
+        const auto entries{lsm_tree_->getRange(
+          TimeSeriesKey{0, "metric", {}},
+          TimeSeriesKey{no_of_entries, "metric", {}},
+          [](const auto&) { return true; }
+        )};
+        if (entries.size() < bound) {
+          mismatch = true;
+        }
+      }
+    });
+  }
+
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  lsm_tree_->waitForCompaction();
+
+  EXPECT_FALSE(mismatch);
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+}
+
+TEST_F(LSMTreeTest, FreezingKeepsConcurrentCompactions) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+
+  constexpr Timestamp no_of_entries{50'000};
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->waitForCompaction();
+
+  uint64_t sstable_files{0};
+  for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+    if (file.path().extension() == ".sst") {
+      ++sstable_files;
+    }
+  }
+  EXPECT_EQ(sstable_files, lsm_tree_->sstableCount());
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+}
+
+TEST_F(LSMTreeTest, CanPutBatch) {
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 2'500; ++i) {
+    entries.emplace_back(
+      TimeSeriesKey{(i * 7) % 2'500, "metric", {}},
+      static_cast<int>(i)
+    );
+  }
+  entries.emplace_back(TimeSeriesKey{0, "metric", {}}, std::nullopt);
+  lsm_tree_->putBatch(entries);
+
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{0, "metric", {}}), std::nullopt);
+  for (Timestamp i{1}; i < 2'500; ++i) {
+    EXPECT_EQ(
+      lsm_tree_->get(TimeSeriesKey{(i * 7) % 2'500, "metric", {}}),
+      static_cast<int>(i)
+    );
+  }
+  EXPECT_EQ(lsm_tree_->sstableCount(), 2);
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  lsm_tree_->replayWAL();
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{0, "metric", {}}), std::nullopt);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{7, "metric", {}}), 1);
+}
+
+TEST_F(LSMTreeTest, CanBulkLoadSortedBatch) {
+  lsm_tree_->put(TimeSeriesKey{5, "metric", {}}, -1);
+
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 12'500; ++i) {
+    entries.emplace_back(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->putBatch(entries);
+
+  for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+    if (file.path().filename() == "wal.log") {
+      EXPECT_EQ(std::filesystem::file_size(file.path()), 0);
+    }
+  }
+  for (Timestamp i{0}; i < 12'500; ++i) {
+    EXPECT_EQ(
+      lsm_tree_->get(TimeSeriesKey{i, "metric", {}}),
+      static_cast<int>(i)
+    );
+  }
+  auto range{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{12'500, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  EXPECT_EQ(range.size(), 12'500);
+}
+
+TEST_F(LSMTreeTest, CanBulkLoadSortedBatchInBackground) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.background_compaction = true}
+  );
+  for (Timestamp i{0}; i < 1'500; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, -1);
+  }
+
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 25'000; ++i) {
+    entries.emplace_back(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->putBatch(entries);
+  lsm_tree_->waitForCompaction();
+
+  for (Timestamp i{0}; i < 25'000; i += 97) {
+    EXPECT_EQ(
+      lsm_tree_->get(TimeSeriesKey{i, "metric", {}}),
+      static_cast<int>(i)
+    );
+  }
+}
+
+TEST_F(LSMTreeTest, CanUseSortedRunMemTables) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.mem_table_format = MemTableFormat::SORTED_RUN}
+  );
+
+  for (Timestamp i{0}; i < 2'500; ++i) {
+    const auto t{i % 100 == 99 ? i - 50 : i};
+    lsm_tree_->put(TimeSeriesKey{t, "metric", {}}, static_cast<int>(i));
+  }
+
+  EXPECT_EQ(lsm_tree_->sstableCount(), 2);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{49, "metric", {}}), 99);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{2'449, "metric", {}}), 2'499);
+  auto entries{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{2'500, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  EXPECT_EQ(entries.size(), 2'475);
+}
+
+TEST_F(LSMTreeTest, CanMultiGet) {
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 12'000; ++i) {
+    entries.emplace_back(
+      TimeSeriesKey{i, "metric", {}},
+      static_cast<int>(i)
+    );
+  }
+  lsm_tree_->putBatch(entries);
+  for (Timestamp i{12'000}; i < 12'500; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->remove(TimeSeriesKey{12'100, "metric", {}});
+
+  std::vector<TimeSeriesKey> keys;
+  for (Timestamp i{0}; i < 13'000; i += 7) {
+    keys.emplace_back(i, "metric", TagTable{});
+    keys.emplace_back(i, "other", TagTable{});
+  }
+  keys.emplace_back(12'100, "metric", TagTable{});
+  const auto values{lsm_tree_->multiGet(keys)};
+
+  ASSERT_EQ(values.size(), keys.size());
+  for (size_t i{0}; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i], lsm_tree_->get(keys[i]));
+  }
+  EXPECT_EQ(values[0], 0);
+  EXPECT_EQ(values[1], std::nullopt);
+  EXPECT_EQ(values.back(), std::nullopt);
+}
+
+TEST_F(LSMTreeTest, RemovalsShadowOlderSSTables) {
+  const TimeSeriesKey a{0, "metric", {{"series", "a"}}};
+  const TimeSeriesKey b{0, "metric", {{"series", "b"}}};
+  Timestamp next{1};
+  const auto fill{[&](size_t count) {
+    for (size_t i{0}; i < count; ++i, ++next) {
+      lsm_tree_->put(TimeSeriesKey{next, "filler", {}}, 0);
+    }
+  }};
+  const auto expect_removed{[&](const TimeSeriesKey& key) {
+    lsm_tree_.reset();
+    lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+    EXPECT_EQ(lsm_tree_->multiGet(std::span{&key, 1}).front(), std::nullopt);
+    lsm_tree_.reset();
+    lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+    EXPECT_EQ(lsm_tree_->get(key), std::nullopt);
+    EXPECT_TRUE(
+      lsm_tree_->getRange(key, key, [](const auto&) { return true; }).empty()
+    );
+  }};
+
+  lsm_tree_->put(a, 1);
+  lsm_tree_->put(b, 2);
+  fill(998);
+  lsm_tree_->remove(a);
+  fill(999);
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 2);
+  expect_removed(a);
+
+  while (lsm_tree_->sstableCount(1) == 0) {
+    fill(1'000);
+  }
+  lsm_tree_->remove(b);
+  fill(999);
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 1);
+  expect_removed(a);
+  expect_removed(b);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{1, "filler", {}}), 0);
+}
+
+TEST_F(LSMTreeTest, ThrowsWhenReadingATruncatedSSTable) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_.reset();
+  for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+    if (file.path().extension() == ".sst") {
+      std::filesystem::resize_file(file.path(), file.file_size() / 2);
+    }
+  }
+
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+
+  const std::vector<TimeSeriesKey> keys{
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{1'999, "metric", {}}
+  };
+  EXPECT_THROW(std::ignore = lsm_tree_->get(keys.back()), std::runtime_error);
+  EXPECT_THROW(std::ignore = lsm_tree_->multiGet(keys), std::runtime_error);
+}
+
+TEST_F(LSMTreeTest, CanScanRangeLazily) {
+  for (Timestamp i{0}; i < 5'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  for (Timestamp i{0}; i < 5'000; i += 2) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, -static_cast<int>(i));
+  }
+  for (Timestamp i{0}; i < 5'000; i += 5) {
+    lsm_tree_->remove(TimeSeriesKey{i, "metric", {}});
+  }
+
+  auto scan{lsm_tree_->scan(
+    TimeSeriesKey{1'000, "metric", {}},
+    TimeSeriesKey{3'999, "metric", {}}
+  )};
+  Timestamp previous{0};
+  size_t count{0};
+  while (const auto entry{scan.next()}) {
+    const auto timestamp{entry->first.timestamp()};
+    EXPECT_GT(timestamp, previous);
+    EXPECT_NE(timestamp % 5, 0);
+    const auto expected{static_cast<int>(timestamp)};
+    EXPECT_EQ(entry->second, timestamp % 2 == 0 ? -expected : expected);
+    previous = timestamp;
+    ++count;
+  }
+  EXPECT_EQ(count, 2'400);
+}
+
+TEST_F(LSMTreeTest, CanScanRangeWithPredicate) {
+  for (Timestamp i{0}; i < 5'000; ++i) {
+    const auto host{i < 2'500 ? "a" : "b"};
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {{"host", host}}}, 1);
+  }
+  for (Timestamp i{0}; i < 5'000; i += 10) {
+    lsm_tree_->remove(TimeSeriesKey{i, "metric", {{"host", "b"}}});
+  }
+
+  KeyPredicate predicate;
+  predicate.requireAnyTag({{"host", "b"}});
+  const auto entries{lsm_tree_->getRange(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, predicate
+  )};
+  ASSERT_EQ(entries.size(), 2'250);
+  for (const auto& [key, value] : entries) {
+    EXPECT_EQ(key.tags().at("host"), "b");
+    EXPECT_NE(key.timestamp() % 10, 0);
+  }
+
+  predicate.requireAnyMetric({"other"});
+  EXPECT_TRUE(lsm_tree_->getRange(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, predicate
+  ).empty());
+}
+
+TEST_F(LSMTreeTest, ParallelRangeReadsMatchSequentialReads) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_, LSMTreeOptions{.mem_table_max_entries = 100}
+  );
+  for (Timestamp i{0}; i < 6'000; ++i) {
+    const auto host{i % 2 == 0 ? "a" : "b"};
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {{"host", host}}}, 1);
+  }
+  for (Timestamp i{0}; i < 6'000; i += 7) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {{"host", "a"}}}, 2);
+    lsm_tree_->remove(TimeSeriesKey{i + 1, "metric", {{"host", "b"}}});
+  }
+  lsm_tree_->removeRange(
+    RangeTombstone{1'000, 1'999, "metric", {{"host", "a"}}}
+  );
+  ASSERT_GT(lsm_tree_->sstableCount(1), 1);
+
+  KeyPredicate predicate;
+  predicate.requireAnyTag({{"host", "a"}});
+  const TimeSeriesKey start{500, "metric", {}};
+  const TimeSeriesKey end{5'500, "metric", {}};
+  const auto expected_entries{lsm_tree_->getRange(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, [](const auto&) { return true; }
+  )};
+  const auto expected_range{lsm_tree_->getRange(start, end, predicate)};
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 100,
+      .read_pool = std::make_shared<ThreadPool>(4)
+    }
+  );
+  lsm_tree_->replayWAL();
+
+  EXPECT_EQ(lsm_tree_->getRange(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, [](const auto&) { return true; }
+  ), expected_entries);
+  EXPECT_EQ(lsm_tree_->getRange(start, end, predicate), expected_range);
+  EXPECT_FALSE(expected_range.empty());
+}
+
+TEST_F(LSMTreeTest, CanAggregateFromRollups) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.rollups = true}
+  );
+  for (Timestamp i{0}; i < 12'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i * 10, "metric", {}}, static_cast<int>(i));
+  }
+  ASSERT_GT(lsm_tree_->sstableCount(1), 0);
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  lsm_tree_->put(TimeSeriesKey{50'000, "metric", {}}, -1);
+  lsm_tree_->remove(TimeSeriesKey{70'000, "metric", {}});
+
+  const auto start{TimeSeriesKey{0, "metric", {}}};
+  const auto end{TimeSeriesKey{120'000, "metric", {}}};
+  const auto predicate{KeyPredicate{}.requireAnyMetric({"metric"})};
+  SeriesStats<int> expected;
+  for (const auto& [key, value] : lsm_tree_->getRange(start, end, predicate)) {
+    expected.add(value.value());
+  }
+
+  SeriesStats<int> actual;
+  uint64_t stats_taken{0};
+  lsm_tree_->scan(start, end, predicate).forEach(
+    [&](const auto& entry) { actual.add(entry.second.value()); },
+    [&](const auto& stats, Timestamp) { actual.merge(stats); ++stats_taken; }
+  );
+
+  EXPECT_GT(stats_taken, 0);
+  EXPECT_EQ(actual.count, expected.count);
+  EXPECT_EQ(actual.sum, expected.sum);
+  EXPECT_EQ(actual.min, -1);
+  EXPECT_EQ(actual.max, expected.max);
+}
+
+TEST_F(LSMTreeTest, CanReadCompressedSSTablesAfterCompaction) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.compression = Compression::LZ4}
+  );
+  for (Timestamp i{0}; i < 12'000; ++i) {
+    lsm_tree_->put(
+      TimeSeriesKey{i, "metric", {{"host", std::to_string(i % 16)}}},
+      static_cast<int>(i * 31 % 1'000)
+    );
+  }
+  ASSERT_GT(lsm_tree_->sstableCount(1), 0);
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+
+  EXPECT_EQ(
+    lsm_tree_->get(TimeSeriesKey{4'321, "metric", {{"host", "1"}}}),
+    4'321 * 31 % 1'000
+  );
+  EXPECT_EQ(
+    lsm_tree_->getRange(
+      TimeSeriesKey{0, "metric", {}},
+      TimeSeriesKey{12'000, "metric", {}},
+      KeyPredicate{}
+    ).size(),
+    12'000
+  );
+}
+
+TEST_F(LSMTreeTest, CachedReadsSeeLaterWrites) {
+  const TimeSeriesKey key{5, "metric", {}};
+  for (Timestamp i{0}; i < 10'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->get(key), 5);
+
+  lsm_tree_->put(key, -5);
+  EXPECT_EQ(lsm_tree_->get(key), -5);
+  lsm_tree_->remove(key);
+  EXPECT_EQ(lsm_tree_->multiGet(std::vector{key}).front(), std::nullopt);
+
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 12'500; ++i) {
+    entries.emplace_back(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i * 2));
+  }
+  lsm_tree_->putBatch(entries);
+  EXPECT_EQ(lsm_tree_->get(key), 10);
+}
+
+TEST_F(LSMTreeTest, CanTuneMemTableAndLayerSizes) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 10,
+      .cache_capacity = 4,
+      .layer_table_counts = {2, 100, 100, 1000, 1000, 1000, 10000, 10000},
+      .bloom_filter_false_positive_rate = 0.1
+    }
+  );
+
+  for (Timestamp i{0}; i < 25; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 2);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 0);
+
+  for (Timestamp i{25}; i < 30; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 0);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 1);
+
+  for (Timestamp i{0}; i < 30; ++i) {
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+}
+
+TEST_F(LSMTreeTest, DefersCompactionWhenLoading) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 10,
+      .layer_table_counts = {2, 100, 100, 1000, 1000, 1000, 10000, 10000}
+    }
+  );
+  for (Timestamp i{0}; i < 20; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 2);
+
+  const LSMTreeOptions options{
+    .mem_table_max_entries = 10,
+    .layer_table_counts = {1, 100, 100, 1000, 1000, 1000, 10000, 10000}
+  };
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_, options);
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 2);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+
+  for (Timestamp i{20}; i < 30; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 0);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 1);
+}
+
+TEST_F(LSMTreeTest, CompactsInTheBackgroundAfterLoading) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 10,
+      .layer_table_counts = {2, 100, 100, 1000, 1000, 1000, 10000, 10000}
+    }
+  );
+  for (Timestamp i{0}; i < 20; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 2);
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 10,
+      .layer_table_counts = {1, 100, 100, 1000, 1000, 1000, 10000, 10000},
+      .background_compaction = true
+    }
+  );
+  lsm_tree_->waitForCompaction();
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 0);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 1);
+  for (Timestamp i{0}; i < 20; ++i) {
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+}
+
+TEST_F(LSMTreeTest, ThrowsWhenTuningOptionsAreOutOfRange) {
+  EXPECT_THROW(
+    (LSMTree<int>{directory_, LSMTreeOptions{.mem_table_max_entries = 0}}),
+    std::invalid_argument
+  );
+  EXPECT_THROW(
+    (LSMTree<int>{directory_, LSMTreeOptions{.cache_capacity = 0}}),
+    std::invalid_argument
+  );
+  EXPECT_THROW(
+    (LSMTree<int>{
+      directory_,
+      LSMTreeOptions{.layer_window_sizes = {0, 3600, 1800, 1, 1, 1, 1, 1}}
+    }),
+    std::invalid_argument
+  );
+  EXPECT_THROW(
+    (LSMTree<int>{
+      directory_,
+      LSMTreeOptions{.bloom_filter_false_positive_rate = 1.0}
+    }),
+    std::invalid_argument
+  );
+}
+
+TEST_F(LSMTreeTest, CompactionOnlyRewritesOverlappingSSTables) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 10,
+      .layer_table_counts = {1, 100, 100, 1000, 1000, 1000, 10000, 10000}
+    }
+  );
+  const auto put_window{[this](Timestamp start) {
+    for (Timestamp i{start}; i < start + 20; ++i) {
+      lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+    }
+  }};
+
+  put_window(0);
+  ASSERT_EQ(lsm_tree_->sstableCount(1), 1);
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "sstable_l1_0.sst"));
+
+  put_window(10'000);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 2);
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "sstable_l1_0.sst"));
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "sstable_l1_1.sst"));
+
+  lsm_tree_->remove(TimeSeriesKey{5, "metric", {}});
+  put_window(100);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 2);
+  EXPECT_FALSE(std::filesystem::exists(directory_ / "sstable_l1_0.sst"));
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "sstable_l1_1.sst"));
+
+  for (const Timestamp start : {0, 100, 10'000}) {
+    for (Timestamp i{start}; i < start + 20; ++i) {
+      const auto expected{
+        i == 5 ? std::nullopt : std::optional<int>{static_cast<int>(i)}
+      };
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), expected);
+    }
+  }
+}
+
+TEST_F(LSMTreeTest, CanWriteCompactedWindowsInParallel) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 100,
+      .layer_window_sizes = {0, 10, 3600, 86400, 604800, 2592000, 7776000,
+        31536000},
+      .layer_table_counts = {1, 1000, 100, 1000, 1000, 1000, 10000, 10000},
+      .compaction_pool = std::make_shared<ThreadPool>(4)
+    }
+  );
+
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->remove(TimeSeriesKey{500, "metric", {}});
+  for (Timestamp i{1'000}; i < 1'199; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 0);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 120);
+  for (Timestamp i{0}; i < 1'199; ++i) {
+    const auto expected{
+      i == 500 ? std::nullopt : std::optional<int>{static_cast<int>(i)}
+    };
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), expected);
+  }
+}
+
+TEST_F(LSMTreeTest, RemovesSSTablesMissingFromManifestOnLoad) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_.reset();
+  ASSERT_TRUE(std::filesystem::exists(directory_ / Manifest::FILENAME));
+  const auto orphan_path{directory_ / "sstable_l1_999.sst"};
+  std::ofstream{orphan_path} << "partial";
+  std::ofstream{directory_ / "sstable_l1_999.metadata"} << "partial";
+
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+
+  EXPECT_FALSE(std::filesystem::exists(orphan_path));
+  EXPECT_FALSE(
+    std::filesystem::exists(directory_ / "sstable_l1_999.metadata")
+  );
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    EXPECT_EQ(
+      lsm_tree_->get(TimeSeriesKey{i, "metric", {}}), static_cast<int>(i)
+    );
+  }
+}
+
+TEST_F(LSMTreeTest, KeepsTagIndexAcrossReloads) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    const auto host{"h" + std::to_string(i % 4)};
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {{"host", host}}}, 1);
+  }
+  EXPECT_EQ(lsm_tree_->tagIndex().size(), 4);
+  lsm_tree_.reset();
+  ASSERT_TRUE(std::filesystem::exists(directory_ / TAG_INDEX_FILENAME));
+
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  EXPECT_EQ(lsm_tree_->tagIndex().size(), 4);
+  EXPECT_EQ(lsm_tree_->tagIndex().seriesWithTags({{"host", "h1"}}).size(), 1);
+  lsm_tree_.reset();
+
+  std::filesystem::remove(directory_ / TAG_INDEX_FILENAME);
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  EXPECT_EQ(lsm_tree_->tagIndex().size(), 4);
+  EXPECT_TRUE(std::filesystem::exists(directory_ / TAG_INDEX_FILENAME));
+}
+
+TEST_F(LSMTreeTest, CanGetTheNewestEntryOfEachSeries) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    const auto host{"h" + std::to_string(i % 4)};
+    lsm_tree_->put(
+      TimeSeriesKey{i, "metric", {{"host", host}}}, static_cast<int>(i)
+    );
+  }
+  const auto check_latest{[this](
+    Timestamp end,
+    const KeyPredicate& predicate,
+    const std::vector<Timestamp>& expected
+  ) {
+    const auto entries{lsm_tree_->latest(
+      MIN_TIME_SERIES_KEY, TimeSeriesKey{end, MAX_METRIC, {}}, predicate
+    )};
+    std::vector<Timestamp> timestamps;
+    for (const auto& [key, value] : entries) {
+      EXPECT_EQ(value, static_cast<int>(key.timestamp()));
+      timestamps.push_back(key.timestamp());
+    }
+    EXPECT_EQ(timestamps, expected);
+  }};
+
+  const auto all{MAX_TIME_SERIES_KEY.timestamp()};
+  check_latest(all, {}, {1'996, 1'997, 1'998, 1'999});
+  check_latest(1'000, {}, {997, 998, 999, 1'000});
+  check_latest(all, KeyPredicate{}.requireAnyTag({{"host", "h2"}}), {1'998});
+
+  lsm_tree_->remove(TimeSeriesKey{1'999, "metric", {{"host", "h3"}}});
+  check_latest(all, {}, {1'995, 1'996, 1'997, 1'998});
+  lsm_tree_->removeRange(RangeTombstone{1'990, 1'999, "metric"});
+  check_latest(all, {}, {1'986, 1'987, 1'988, 1'989});
+}
+
+TEST_F(LSMTreeTest, KeepsTheNewestEntryOfEachSeriesAcrossReloads) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    const auto host{"h" + std::to_string(i % 2)};
+    lsm_tree_->put(
+      TimeSeriesKey{i, "metric", {{"host", host}}}, static_cast<int>(i)
+    );
+  }
+  lsm_tree_.reset();
+
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  const auto entries{lsm_tree_->latest(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, {}
+  )};
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].first.timestamp(), 1'998);
+  EXPECT_EQ(entries[1].first.timestamp(), 1'999);
+  EXPECT_EQ(entries[1].second, 1'999);
+}
+
+TEST_F(LSMTreeTest, ClipsReadsToRetention) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_, LSMTreeOptions{.retention = 100}
+  );
+  for (Timestamp i{0}; i < 10; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+
+  lsm_tree_->put(TimeSeriesKey{105, "metric", {}}, 105);
+
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{4, "metric", {}}), std::nullopt);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+  const std::vector<TimeSeriesKey> keys{
+    TimeSeriesKey{0, "metric", {}}, TimeSeriesKey{9, "metric", {}}
+  };
+  EXPECT_EQ(
+    lsm_tree_->multiGet(keys),
+    (std::vector<std::optional<int>>{std::nullopt, 9})
+  );
+  const auto entries{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{200, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  ASSERT_EQ(entries.size(), 6);
+  EXPECT_EQ(entries.front().first.timestamp(), 5);
+  EXPECT_EQ(entries.back().first.timestamp(), 105);
+}
+
+TEST_F(LSMTreeTest, DropsExpiredSSTablesWhole) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.mem_table_max_entries = 10, .retention = 100}
+  );
+  for (Timestamp i{0}; i < 20; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 2);
+
+  for (Timestamp i{105}; i < 115; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 2);
+  EXPECT_FALSE(std::filesystem::exists(directory_ / "sstable_l0_0.sst"));
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "sstable_l0_1.sst"));
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{19, "metric", {}}), 19);
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.mem_table_max_entries = 10, .retention = 100}
+  );
+  EXPECT_EQ(lsm_tree_->sstableCount(0), 2);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{10, "metric", {}}), std::nullopt);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{14, "metric", {}}), 14);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{110, "metric", {}}), 110);
+}
+
+TEST_F(LSMTreeTest, ClearingResetsTheRetentionBoundary) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_, LSMTreeOptions{.retention = 100}
+  );
+  lsm_tree_->put(TimeSeriesKey{1'000, "metric", {}}, 1'000);
+  lsm_tree_->clear();
+
+  lsm_tree_->put(TimeSeriesKey{5, "metric", {}}, 5);
+
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+  const auto entries{lsm_tree_->getRange(
+    TimeSeriesKey{0, "metric", {}},
+    TimeSeriesKey{200, "metric", {}},
+    [](const auto&) { return true; }
+  )};
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries.front().second, 5);
+}
+
+TEST_F(LSMTreeTest, RangeTombstonesOnlyRemoveOlderKeys) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_, LSMTreeOptions{.mem_table_max_entries = 10}
+  );
+  const TagTable a{{"series", "a"}};
+  const TagTable b{{"series", "b"}};
+  for (Timestamp i{0}; i < 20; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", a}, static_cast<int>(i));
+    lsm_tree_->put(TimeSeriesKey{i, "metric", b}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 4);
+  lsm_tree_->put(TimeSeriesKey{25, "metric", a}, 25);
+
+  lsm_tree_->removeRange(RangeTombstone{5, 30, "metric", a});
+  lsm_tree_->put(TimeSeriesKey{10, "metric", a}, 100);
+
+  const auto check{[&] {
+    for (Timestamp i{0}; i < 20; ++i) {
+      const auto expected{
+        i == 10 ? std::optional<int>{100}
+          : i < 5 ? std::optional<int>{static_cast<int>(i)}
+          : std::nullopt
+      };
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", a}), expected);
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "metric", b}), i);
+    }
+    EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{25, "metric", a}), std::nullopt);
+    const std::vector<TimeSeriesKey> keys{
+      TimeSeriesKey{4, "metric", a},
+      TimeSeriesKey{5, "metric", a},
+      TimeSeriesKey{10, "metric", a},
+      TimeSeriesKey{25, "metric", a},
+      TimeSeriesKey{5, "metric", b}
+    };
+    EXPECT_EQ(
+      lsm_tree_->multiGet(keys),
+      (std::vector<std::optional<int>>{4, std::nullopt, 100, std::nullopt, 5})
+    );
+    const auto entries{lsm_tree_->getRange(
+      TimeSeriesKey{0, "metric", {}},
+      TimeSeriesKey{100, "metric", {}},
+      [&a](const auto& key) { return key.tags() == a; }
+    )};
+    ASSERT_EQ(entries.size(), 6);
+    EXPECT_EQ(entries.back().first.timestamp(), 10);
+    EXPECT_EQ(entries.back().second, 100);
+  }};
+
+  check();
+  for (Timestamp i{100}; i < 109; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", b}, static_cast<int>(i));
+  }
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 5);
+  check();
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_, LSMTreeOptions{.mem_table_max_entries = 10}
+  );
+  check();
+}
+
+TEST_F(LSMTreeTest, CanReplayRangeTombstonesFromWAL) {
+  for (Timestamp i{0}; i < 10; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  lsm_tree_->removeRange(RangeTombstone{2, 7, "metric"});
+  lsm_tree_->put(TimeSeriesKey{5, "metric", {}}, 50);
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_);
+  lsm_tree_->replayWAL();
+
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{1, "metric", {}}), 1);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{2, "metric", {}}), std::nullopt);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 50);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{8, "metric", {}}), 8);
+}
+
+TEST_F(LSMTreeTest, CompactionCarriesRangeTombstonesDown) {
+  const LSMTreeOptions options{
+    .mem_table_max_entries = 10,
+    .layer_window_sizes = {0, 10, 100, 1000, 10000, 100000, 1000000,
+      10000000},
+    .layer_table_counts = {1, 1, 1000, 1000, 1000, 1000, 10000, 10000}
+  };
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_, options);
+  for (Timestamp i{0}; i < 100; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "a", {}}, static_cast<int>(i));
+    lsm_tree_->put(TimeSeriesKey{i, "b", {}}, static_cast<int>(i));
+  }
+  ASSERT_GT(lsm_tree_->sstableCount(2), 0);
+
+  lsm_tree_->removeRange(RangeTombstone{20, 59, "a"});
+  lsm_tree_->put(TimeSeriesKey{30, "a", {}}, 300);
+  for (Timestamp i{200}; i < 300; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "b", {}}, static_cast<int>(i));
+  }
+  ASSERT_LE(lsm_tree_->sstableCount(0), 1);
+
+  const auto check{[&] {
+    for (Timestamp i{0}; i < 100; ++i) {
+      const auto expected{
+        i == 30 ? std::optional<int>{300}
+          : i < 20 || i >= 60 ? std::optional<int>{static_cast<int>(i)}
+          : std::nullopt
+      };
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "a", {}}), expected);
+      EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{i, "b", {}}), i);
+    }
+    const auto entries{lsm_tree_->getRange(
+      TimeSeriesKey{0, "a", {}},
+      TimeSeriesKey{99, "a", {}},
+      [](const auto& key) { return key.metric() == "a"; }
+    )};
+    EXPECT_EQ(entries.size(), 61);
+  }};
+
+  check();
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_, options);
+  check();
+}
+
+TEST_F(LSMTreeTest, CountsFlushesCompactionsAndReads) {
+  lsm_tree_ = std::make_unique<LSMTree<int>>(
+    directory_,
+    LSMTreeOptions{.mem_table_max_entries = 10}
+  );
+  for (Timestamp i{0}; i < 200; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{5, "metric", {}}), 5);
+
+  const auto stats{lsm_tree_->stats()};
+  EXPECT_EQ(stats.flushes, 20);
+  EXPECT_GE(stats.compactions[0], 1);
+  EXPECT_GT(stats.bytes_written[0], 0);
+  EXPECT_GT(stats.bytes_written[1], 0);
+  EXPECT_EQ(stats.sstables.size(), LSMTree<int>::LAYER_COUNT);
+  EXPECT_EQ(stats.sstables[0], lsm_tree_->sstableCount(0));
+  EXPECT_EQ(stats.cache_hits, 1);
+  EXPECT_EQ(stats.cache_misses, 1);
+  EXPECT_GE(stats.bloom_true_positives, 1);
+  EXPECT_EQ(stats.wal_append_latency.count, 200);
+  EXPECT_EQ(stats.flush_latency.count, 20);
+}
+
+TEST_F(LSMTreeTest, LateEntriesOnlyRewriteTheirOwnWindows) {
+  LSMTreeOptions options{.mem_table_max_entries = 10};
+  options.layer_table_counts[0] = 0;
+  lsm_tree_ = std::make_unique<LSMTree<int>>(directory_, options);
+  const auto window_size{options.layer_window_sizes[1]};
+  for (Timestamp i{0}; i < 50; ++i) {
+    lsm_tree_->put(
+      TimeSeriesKey{i * window_size, "metric", {}}, static_cast<int>(i)
+    );
+  }
+  lsm_tree_->waitForCompaction();
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 0);
+  ASSERT_EQ(lsm_tree_->sstableCount(1), 50);
+
+  const auto c1_files{[this] {
+    std::set<std::string> files;
+    for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+      const auto name{file.path().filename().string()};
+      if (name.starts_with("sstable_l1_") && name.ends_with(".sst")) {
+        files.insert(name);
+      }
+    }
+    return files;
+  }};
+  const auto before{c1_files()};
+
+  lsm_tree_->put(TimeSeriesKey{1, "metric", {}}, -1);
+  for (Timestamp i{60}; i < 79; ++i) {
+    lsm_tree_->put(
+      TimeSeriesKey{i * window_size, "metric", {}}, static_cast<int>(i)
+    );
+  }
+  lsm_tree_->waitForCompaction();
+  ASSERT_EQ(lsm_tree_->sstableCount(0), 0);
+
+  const auto after{c1_files()};
+  std::vector<std::string> kept;
+  std::ranges::set_intersection(before, after, std::back_inserter(kept));
+  EXPECT_EQ(kept.size(), 49);
+  EXPECT_EQ(lsm_tree_->sstableCount(1), 69);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{1, "metric", {}}), -1);
+  EXPECT_EQ(lsm_tree_->get(TimeSeriesKey{0, "metric", {}}), 0);
+}
+
+TEST_F(LSMTreeTest, CheckpointHoldsAPrefixOfConcurrentWrites) {
+  const FilePath checkpoint_directory{"test_lsm_tree_checkpoint"};
+  std::filesystem::remove_all(checkpoint_directory);
+  for (Timestamp i{0}; i < 2'500; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+
+  std::atomic<bool> checkpointed{false};
+  std::atomic<Timestamp> written{2'500};
+  std::jthread writer{[this, &checkpointed, &written] {
+    while (!checkpointed || written < 5'000) {
+      const auto i{written.load()};
+      lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+      written = i + 1;
+    }
+  }};
+  while (written < 3'000) {
+    std::this_thread::yield();
+  }
+  const auto lsn{lsm_tree_->checkpoint(checkpoint_directory)};
+  checkpointed = true;
+  writer.join();
+
+  for (Timestamp i{0}; i < 100; ++i) {
+    lsm_tree_->put(TimeSeriesKey{i, "metric", {}}, -1);
+  }
+  lsm_tree_->waitForCompaction();
+  lsm_tree_->clear();
+
+  LSMTree<int> checkpoint{checkpoint_directory};
+  checkpoint.replayWAL();
+  EXPECT_EQ(checkpoint.nextLSN(), lsn);
+  Timestamp kept{0};
+  while (checkpoint.get(TimeSeriesKey{kept, "metric", {}})) {
+    ++kept;
+  }
+  EXPECT_GE(kept, 3'000);
+  for (Timestamp i{0}; i < 5'000; ++i) {
+    const auto value{checkpoint.get(TimeSeriesKey{i, "metric", {}})};
+    if (i < kept) {
+      EXPECT_EQ(value, static_cast<int>(i));
+    } else {
+      EXPECT_EQ(value, std::nullopt);
+    }
+  }
+  checkpoint.clear();
+  std::filesystem::remove_all(checkpoint_directory);
+}
+
+TEST_F(LSMTreeTest, ThrowsWhenCheckpointDirectoryIsNotEmpty) {
+  lsm_tree_->put(TimeSeriesKey{0, "metric", {}}, 0);
+  EXPECT_THROW(lsm_tree_->checkpoint(directory_), std::runtime_error);
+}
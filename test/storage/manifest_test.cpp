@@ -0,0 +1,140 @@
+#include "gtest/gtest.h"
+#include <vkdb/manifest.h>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+
+using namespace vkdb;
+
+class ManifestTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    directory_ = "test_manifest";
+    std::filesystem::create_directories(directory_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(directory_);
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(ManifestTest, ReturnsFalseWhenLoadingWithoutFile) {
+  Manifest manifest{directory_, 2};
+
+  EXPECT_FALSE(manifest.load());
+  EXPECT_EQ(manifest.version(), 0);
+}
+
+TEST_F(ManifestTest, CanLoadCommittedLayers) {
+  const std::array<Manifest::size_type, 2> next_ids{3, 1};
+  {
+    Manifest manifest{directory_, 2};
+    manifest.commit({{"sstable_l0_0.sst"}, {}}, next_ids);
+    manifest.commit(
+      {{"sstable_l0_0.sst", "sstable_l0_2.sst"}, {"sstable_l1_0.sst"}},
+      next_ids
+    );
+    manifest.commit({{}, {"sstable_l1_0.sst"}}, next_ids);
+  }
+
+  Manifest manifest{directory_, 2};
+  ASSERT_TRUE(manifest.load());
+  EXPECT_EQ(manifest.version(), 3);
+  EXPECT_EQ(manifest.layers()[0], Manifest::Layer{});
+  EXPECT_EQ(manifest.layers()[1], Manifest::Layer{"sstable_l1_0.sst"});
+  EXPECT_EQ(
+    manifest.nextIds(),
+    (std::vector<Manifest::size_type>{next_ids.begin(), next_ids.end()})
+  );
+}
+
+TEST_F(ManifestTest, IgnoresTornEdit) {
+  const std::array<Manifest::size_type, 1> next_ids{2};
+  {
+    Manifest manifest{directory_, 1};
+    manifest.commit({{"sstable_l0_0.sst"}}, next_ids);
+    manifest.commit({{"sstable_l0_0.sst", "sstable_l0_1.sst"}}, next_ids);
+  }
+  const auto path{directory_ / Manifest::FILENAME};
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+  Manifest manifest{directory_, 1};
+  ASSERT_TRUE(manifest.load());
+  EXPECT_EQ(manifest.version(), 1);
+  EXPECT_EQ(manifest.layers()[0], Manifest::Layer{"sstable_l0_0.sst"});
+
+  manifest.commit({{"sstable_l0_0.sst", "sstable_l0_1.sst"}}, next_ids);
+  Manifest reloaded{directory_, 1};
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_EQ(reloaded.version(), 2);
+  EXPECT_EQ(reloaded.layers()[0].size(), 2);
+}
+
+TEST_F(ManifestTest, RewritesAfterMaxEdits) {
+  const std::array<Manifest::size_type, 1> next_ids{1};
+  Manifest manifest{directory_, 1};
+  for (Manifest::size_type i{0}; i < Manifest::MAX_EDITS; ++i) {
+    manifest.commit({{"sstable_l0_" + std::to_string(i) + ".sst"}}, next_ids);
+  }
+  const auto path{directory_ / Manifest::FILENAME};
+  const auto size_before{std::filesystem::file_size(path)};
+
+  manifest.commit({{"sstable_l0_0.sst"}}, next_ids);
+
+  EXPECT_LT(std::filesystem::file_size(path), size_before);
+  Manifest reloaded{directory_, 1};
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_EQ(reloaded.version(), Manifest::MAX_EDITS + 1);
+  EXPECT_EQ(reloaded.layers()[0], Manifest::Layer{"sstable_l0_0.sst"});
+}
+
+TEST_F(ManifestTest, ThrowsWhenLoadingWithBadHeader) {
+  std::ofstream{directory_ / Manifest::FILENAME} << "NOTAMANIFEST 1\n";
+
+  Manifest manifest{directory_, 1};
+  EXPECT_THROW(static_cast<void>(manifest.load()), std::runtime_error);
+}
+
+TEST_F(ManifestTest, ThrowsWhenCommittingWrongNumberOfLayers) {
+  const std::array<Manifest::size_type, 2> next_ids{0, 0};
+  Manifest manifest{directory_, 2};
+
+  EXPECT_THROW(manifest.commit({{}}, next_ids), std::invalid_argument);
+}
+
+TEST_F(ManifestTest, CanClear) {
+  const std::array<Manifest::size_type, 1> next_ids{1};
+  Manifest manifest{directory_, 1};
+  manifest.commit({{"sstable_l0_0.sst"}}, next_ids);
+
+  manifest.clear();
+
+  EXPECT_FALSE(std::filesystem::exists(manifest.path()));
+  EXPECT_EQ(manifest.version(), 0);
+  EXPECT_TRUE(manifest.layers()[0].empty());
+}
+
+TEST_F(ManifestTest, CanLoadCommittedRangeTombstones) {
+  const std::array<Manifest::size_type, 2> next_ids{1, 1};
+  const Manifest::RangeTombstones range_tombstones{
+    {1, "{0}{10}{metric}{}"}, {1, "{5}{20}{metric}{tag:value}"}
+  };
+  {
+    Manifest manifest{directory_, 2};
+    manifest.commit({{}, {"sstable_l1_0.sst"}}, next_ids, range_tombstones);
+    manifest.commit({{"sstable_l0_0.sst"}, {"sstable_l1_0.sst"}}, next_ids,
+                    range_tombstones);
+  }
+
+  Manifest manifest{directory_, 2};
+  ASSERT_TRUE(manifest.load());
+  EXPECT_EQ(manifest.rangeTombstones(), range_tombstones);
+  EXPECT_EQ(manifest.layers()[0], Manifest::Layer{"sstable_l0_0.sst"});
+
+  manifest.commit({{}, {"sstable_l1_0.sst"}}, next_ids);
+  Manifest reloaded{directory_, 2};
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_TRUE(reloaded.rangeTombstones().empty());
+}
@@ -114,6 +114,78 @@ TEST_F(MemTableTest, CanGetRangeOfEntriesWithKeys) {
   EXPECT_EQ(entries[2].second, 3);
 }
 
+TEST_F(MemTableTest, CanPutAndGetValuesInSortedRun) {
+  Table table{MemTableFormat::SORTED_RUN};
+  TimeSeriesKey key1{1, "metric", {}};
+  TimeSeriesKey key2{2, "metric", {}};
+  TimeSeriesKey key3{3, "metric", {}};
+  TimeSeriesKey key4{4, "metric", {}};
+
+  table.put(key1, 1);
+  table.put(key3, 3);
+  table.put(key4, 4);
+  table.put(key2, 2);
+  table.put(key3, std::nullopt);
+
+  EXPECT_EQ(table.size(), 4);
+  EXPECT_EQ(table.get(key1), 1);
+  EXPECT_EQ(table.get(key2), 2);
+  EXPECT_EQ(table.get(key3), std::nullopt);
+  EXPECT_TRUE(table.contains(key4));
+  EXPECT_FALSE(table.contains(TimeSeriesKey{5, "metric", {}}));
+  EXPECT_THROW(
+    std::ignore = table.get(TimeSeriesKey{5, "metric", {}}),
+    std::invalid_argument
+  );
+
+  auto entries{table.getRange(key2, key4)};
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].first, key2);
+  EXPECT_EQ(entries[1].first, key3);
+
+  std::vector<Timestamp> timestamps;
+  table.forEach([&timestamps](const auto& key, const auto&) {
+    timestamps.push_back(key.timestamp());
+  });
+  EXPECT_EQ(timestamps, (std::vector<Timestamp>{1, 2, 3, 4}));
+}
+
+TEST_F(MemTableTest, KeepsOutOfOrderWritesInSortedRunInOrder) {
+  constexpr Timestamp no_of_entries{3 * Table::SIDE_BUFFER_MAX_ENTRIES};
+  Table table{MemTableFormat::SORTED_RUN, no_of_entries};
+  for (Timestamp i{0}; i < no_of_entries; i += 2) {
+    table.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  for (Timestamp i{no_of_entries - 1}; i < no_of_entries; i -= 2) {
+    table.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  table.put(TimeSeriesKey{1, "metric", {}}, -1);
+  table.put(TimeSeriesKey{2, "metric", {}}, -2);
+
+  EXPECT_EQ(table.size(), no_of_entries);
+  EXPECT_EQ(table.get(TimeSeriesKey{1, "metric", {}}), -1);
+  EXPECT_EQ(table.get(TimeSeriesKey{2, "metric", {}}), -2);
+  EXPECT_EQ(table.get(TimeSeriesKey{3, "metric", {}}), 3);
+
+  const auto entries{table.getRange(
+    TimeSeriesKey{10, "metric", {}},
+    TimeSeriesKey{20, "metric", {}}
+  )};
+  ASSERT_EQ(entries.size(), 10);
+  for (Timestamp i{0}; i < entries.size(); ++i) {
+    EXPECT_EQ(entries[i].first.timestamp(), 10 + i);
+  }
+
+  table.mergeSideBuffer();
+  std::vector<Timestamp> timestamps;
+  table.forEach([&timestamps](const auto& key, const auto&) {
+    timestamps.push_back(key.timestamp());
+  });
+  ASSERT_EQ(timestamps.size(), no_of_entries);
+  EXPECT_TRUE(std::ranges::is_sorted(timestamps));
+  EXPECT_EQ(timestamps.back(), no_of_entries - 1);
+}
+
 TEST_F(MemTableTest, CanUpdateValuesOfKeysWithMultipleTags) {
   TimeSeriesKey key1{1, "metric1", {{"tag1", "value1"}, {"tag2", "value2"}}};
 
@@ -215,4 +287,25 @@ TEST_F(MemTableTest, CanExtractFromStreamWithTags) {
   EXPECT_EQ(value1, 1);
   EXPECT_EQ(value2, 2);
   EXPECT_EQ(value3, 3);
-}
\ No newline at end of file
+}
+
+TEST_F(MemTableTest, CanRemoveRangeOfKeys) {
+  for (Timestamp i{0}; i < 10; ++i) {
+    table_->put(TimeSeriesKey{i, "metric1", {}}, static_cast<int>(i));
+    table_->put(TimeSeriesKey{i, "metric2", {}}, static_cast<int>(i));
+  }
+
+  table_->removeRange(RangeTombstone{2, 5, "metric1"});
+  table_->put(TimeSeriesKey{3, "metric1", {}}, 30);
+
+  EXPECT_EQ(table_->size(), 17);
+  EXPECT_FALSE(table_->contains(TimeSeriesKey{2, "metric1", {}}));
+  EXPECT_EQ(table_->get(TimeSeriesKey{3, "metric1", {}}), 30);
+  EXPECT_TRUE(table_->contains(TimeSeriesKey{2, "metric2", {}}));
+  EXPECT_TRUE(table_->isRangeDeleted(TimeSeriesKey{4, "metric1", {}}));
+  EXPECT_FALSE(table_->isRangeDeleted(TimeSeriesKey{6, "metric1", {}}));
+  ASSERT_EQ(table_->rangeTombstones().size(), 1);
+
+  table_->clear();
+  EXPECT_TRUE(table_->rangeTombstones().empty());
+}
@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+#include <vkdb/memory_manager.h>
+#include <vkdb/lsm_tree.h>
+#include <vector>
+
+using namespace vkdb;
+
+namespace {
+struct FakeConsumer {
+  MemoryUsage usage{};
+  MemoryManager::size_type last_access{0};
+  int flushes{0};
+  int releases{0};
+
+  MemoryConsumer consumer() {
+    return {
+      .usage = [this] { return usage; },
+      .last_access = [this] { return last_access; },
+      .flush = [this] {
+        ++flushes;
+        usage.mem_table_bytes = 0;
+      },
+      .release = [this] {
+        ++releases;
+        usage.cache_bytes = 0;
+        usage.filter_bytes = 0;
+      }
+    };
+  }
+};
+}  // namespace
+
+TEST(MemoryManagerTest, ThrowsOnZeroBudget) {
+  EXPECT_THROW(MemoryManager{0}, std::invalid_argument);
+}
+
+TEST(MemoryManagerTest, DoesNothingWithinBudget) {
+  MemoryManager manager{1'000};
+  FakeConsumer consumer{.usage = {.mem_table_bytes = 600, .index_bytes = 400}};
+  manager.track(consumer.consumer());
+  manager.rebalance();
+  EXPECT_EQ(consumer.flushes, 0);
+  EXPECT_EQ(consumer.releases, 0);
+  EXPECT_EQ(manager.usage().total(), 1'000);
+}
+
+TEST(MemoryManagerTest, FlushesLargestMemTablesFirst) {
+  MemoryManager manager{600};
+  std::vector<FakeConsumer> consumers{
+    {.usage = {.mem_table_bytes = 100}},
+    {.usage = {.mem_table_bytes = 500}},
+    {.usage = {.mem_table_bytes = 300}}
+  };
+  for (auto& consumer : consumers) {
+    manager.track(consumer.consumer());
+  }
+  manager.rebalance();
+  EXPECT_EQ(consumers[0].flushes, 0);
+  EXPECT_EQ(consumers[1].flushes, 1);
+  EXPECT_EQ(consumers[2].flushes, 0);
+  EXPECT_EQ(manager.earlyFlushes(), 1);
+  EXPECT_EQ(manager.usage().total(), 400);
+}
+
+TEST(MemoryManagerTest, ReleasesLeastRecentlyAccessedFirst) {
+  MemoryManager manager{1'000};
+  std::vector<FakeConsumer> consumers{
+    {.usage = {.cache_bytes = 400, .filter_bytes = 200}, .last_access = 3},
+    {.usage = {.cache_bytes = 400, .filter_bytes = 200}, .last_access = 1},
+    {.usage = {.index_bytes = 300, .filter_bytes = 100}, .last_access = 2}
+  };
+  for (auto& consumer : consumers) {
+    manager.track(consumer.consumer());
+  }
+  manager.rebalance();
+  EXPECT_EQ(consumers[0].releases, 0);
+  EXPECT_EQ(consumers[1].releases, 1);
+  EXPECT_EQ(consumers[2].releases, 0);
+  EXPECT_EQ(manager.releases(), 1);
+  EXPECT_EQ(manager.usage().total(), 1'000);
+}
+
+TEST(MemoryManagerTest, RebalancesOnceASliceIsCharged) {
+  MemoryManager manager{MemoryManager::CHARGE_SLICES * 10};
+  FakeConsumer consumer{
+    .usage = {.mem_table_bytes = MemoryManager::CHARGE_SLICES * 20}
+  };
+  manager.track(consumer.consumer());
+  const auto epoch{manager.epoch()};
+  manager.charge(5);
+  EXPECT_EQ(consumer.flushes, 0);
+  manager.charge(5);
+  EXPECT_EQ(consumer.flushes, 1);
+  EXPECT_GT(manager.epoch(), epoch);
+}
+
+TEST(MemoryManagerTest, StopsAccountingForUntrackedConsumers) {
+  MemoryManager manager{100};
+  FakeConsumer consumer{.usage = {.mem_table_bytes = 200}};
+  const auto id{manager.track(consumer.consumer())};
+  manager.untrack(id);
+  manager.rebalance();
+  EXPECT_EQ(consumer.flushes, 0);
+  EXPECT_EQ(manager.usage().total(), 0);
+}
+
+TEST(MemoryManagerTest, FlushesLSMTreeEarly) {
+  const auto manager{std::make_shared<MemoryManager>(
+    100 * LSMTree<int>::ENTRY_BYTES
+  )};
+  LSMTree<int> lsm_tree{"test_memory_manager", {
+    .mem_table_max_entries = 1'000,
+    .memory_manager = manager
+  }};
+  manager->track({
+    .usage = [&] { return lsm_tree.memoryUsage(); },
+    .last_access = [&] { return lsm_tree.lastAccess(); },
+    .flush = [&] { lsm_tree.flushMemTable(); },
+    .release = [&] { lsm_tree.releaseMemory(); }
+  });
+  for (Timestamp i{0}; i < 500; ++i) {
+    lsm_tree.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  EXPECT_GT(manager->earlyFlushes(), 0);
+  EXPECT_GT(lsm_tree.sstableCount(), 0);
+  EXPECT_GT(lsm_tree.lastAccess(), 0);
+  EXPECT_LE(
+    lsm_tree.memoryUsage().mem_table_bytes,
+    100 * LSMTree<int>::ENTRY_BYTES
+  );
+  for (Timestamp i{0}; i < 500; ++i) {
+    EXPECT_EQ(lsm_tree.get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+  lsm_tree.clear();
+}
@@ -0,0 +1,227 @@
+#include "gtest/gtest.h"
+#include <vkdb/merge_iterator.h>
+#include <array>
+#include <memory_resource>
+
+using namespace vkdb;
+
+class MergeIteratorTest : public ::testing::Test {
+protected:
+  using Merge = MergeIterator<int>;
+
+  void TearDown() override {
+    std::remove(FILE_PATH);
+    std::remove(METADATA_FILE_PATH);
+  }
+
+  static std::vector<Merge::value_type> drain(Merge& merge) {
+    std::vector<Merge::value_type> entries;
+    while (auto entry{merge.next()}) {
+      entries.push_back(std::move(*entry));
+    }
+    return entries;
+  }
+
+  static constexpr const char* FILE_PATH{"merge_iterator_test.sst"};
+  static constexpr const char* METADATA_FILE_PATH{
+    "merge_iterator_test.metadata"
+  };
+};
+
+TEST_F(MergeIteratorTest, CanMergeRunsInKeyOrder) {
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 1},
+                {TimeSeriesKey{4, "metric", {}}, 4}});
+  merge.addRun({{TimeSeriesKey{2, "metric", {}}, 2},
+                {TimeSeriesKey{3, "metric", {}}, 3}});
+  merge.addRun({});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 4);
+  for (size_t i{0}; i < entries.size(); ++i) {
+    EXPECT_EQ(entries[i].first.timestamp(), i + 1);
+    EXPECT_EQ(entries[i].second, static_cast<int>(i + 1));
+  }
+}
+
+TEST_F(MergeIteratorTest, TakesBookkeepingFromResource) {
+  std::array<std::byte, 1 << 16> buffer;
+  std::pmr::monotonic_buffer_resource resource{
+    buffer.data(), buffer.size(), std::pmr::null_memory_resource()
+  };
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER, &resource};
+  EXPECT_EQ(merge.resource(), &resource);
+  for (Timestamp i{0}; i < 8; ++i) {
+    merge.addRangeTombstone(RangeTombstone{100 + i, 100 + i, "other", {}});
+    merge.addRun({{TimeSeriesKey{i, "metric", {}}, static_cast<int>(i)}});
+  }
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 8);
+  for (size_t i{0}; i < entries.size(); ++i) {
+    EXPECT_EQ(entries[i].first.timestamp(), i);
+  }
+}
+
+TEST_F(MergeIteratorTest, NewestSourceWinsAndTombstonesAreSkipped) {
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 1},
+                {TimeSeriesKey{2, "metric", {}}, 2},
+                {TimeSeriesKey{3, "metric", {}}, 3}});
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 10},
+                {TimeSeriesKey{2, "metric", {}}, std::nullopt}});
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 100}});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].first.timestamp(), 1);
+  EXPECT_EQ(entries[0].second, 100);
+  EXPECT_EQ(entries[1].first.timestamp(), 3);
+  EXPECT_EQ(entries[1].second, 3);
+}
+
+TEST_F(MergeIteratorTest, CanFilterKeys) {
+  Merge merge{[](const TimeSeriesKey& key) {
+    return key.metric() == "wanted";
+  }};
+  merge.addRun({{TimeSeriesKey{1, "unwanted", {}}, 1},
+                {TimeSeriesKey{1, "wanted", {}}, 2},
+                {TimeSeriesKey{2, "unwanted", {}}, 3}});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].first.metric(), "wanted");
+}
+
+TEST_F(MergeIteratorTest, CanMergeSSTablesWithRuns) {
+  MemTable<int> mem_table;
+  for (Timestamp i{0}; i < 100; ++i) {
+    mem_table.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  auto sstable{std::make_shared<const SSTable<int>>(FILE_PATH, mem_table)};
+
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.addSSTable(
+    std::move(sstable),
+    TimeSeriesKey{10, "metric", {}},
+    TimeSeriesKey{19, "metric", {}}
+  );
+  merge.addRun({{TimeSeriesKey{15, "metric", {}}, std::nullopt},
+                {TimeSeriesKey{16, "metric", {}}, -16}});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 9);
+  EXPECT_EQ(entries.front().first.timestamp(), 10);
+  EXPECT_EQ(entries.back().first.timestamp(), 19);
+  EXPECT_EQ(entries[5].first.timestamp(), 16);
+  EXPECT_EQ(entries[5].second, -16);
+}
+
+TEST_F(MergeIteratorTest, CanTakeBlocksFromStatistics) {
+  MemTable<int> mem_table;
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    const auto metric{i % 2 == 0 ? "even" : "odd"};
+    mem_table.put(TimeSeriesKey{i, metric, {}}, static_cast<int>(i));
+  }
+  auto sstable{std::make_shared<const SSTable<int>>(FILE_PATH, mem_table)};
+  const auto start{TimeSeriesKey{100, "even", {}}};
+  const auto end{TimeSeriesKey{1'899, "odd", {}}};
+  const Merge::Run newer{{TimeSeriesKey{1'000, "even", {}}, std::nullopt},
+                         {TimeSeriesKey{1'002, "even", {}}, -1}};
+  auto make_merge = [&] {
+    Merge merge{KeyPredicate{}.requireAnyMetric({"even"})};
+    merge.addSSTable(sstable, start, end);
+    merge.addRun(Merge::Run{newer});
+    return merge;
+  };
+
+  SeriesStats<int> expected;
+  auto decoded{make_merge()};
+  for (const auto& [key, value] : drain(decoded)) {
+    expected.add(value.value());
+  }
+
+  SeriesStats<int> actual;
+  uint64_t blocks_taken{0};
+  auto merge{make_merge()};
+  merge.forEach(
+    [&](const auto& entry) { actual.add(entry.second.value()); },
+    [&](const auto& stats, Timestamp) { actual.merge(stats); ++blocks_taken; }
+  );
+
+  EXPECT_GT(blocks_taken, 0);
+  EXPECT_EQ(actual.count, expected.count);
+  EXPECT_EQ(actual.sum, expected.sum);
+  EXPECT_EQ(actual.min, -1);
+  EXPECT_EQ(actual.max, expected.max);
+}
+
+TEST_F(MergeIteratorTest, RangeTombstonesOnlyDeleteOlderSources) {
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 1},
+                {TimeSeriesKey{2, "metric", {}}, 2},
+                {TimeSeriesKey{3, "metric", {}}, 3},
+                {TimeSeriesKey{3, "other", {}}, 3}});
+  merge.addRun({{TimeSeriesKey{2, "metric", {}}, 20}},
+               {RangeTombstone{1, 3, "metric"}});
+  merge.addRangeTombstone(RangeTombstone{2, 2, "metric"});
+  merge.addRun({{TimeSeriesKey{3, "metric", {}}, 30}});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].first, (TimeSeriesKey{3, "metric", {}}));
+  EXPECT_EQ(entries[0].second, 30);
+  EXPECT_EQ(entries[1].first, (TimeSeriesKey{3, "other", {}}));
+}
+
+TEST_F(MergeIteratorTest, RangeTombstonesOnlyDeleteSourcesOfTheirPartition) {
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.beginPartition();
+  merge.addRun({{TimeSeriesKey{1, "metric", {{"shard", "a"}}}, 1}});
+  merge.beginPartition();
+  merge.addRun({{TimeSeriesKey{2, "metric", {{"shard", "b"}}}, 2}});
+  merge.addRangeTombstone(RangeTombstone{1, 2, "metric"});
+  merge.addRun({{TimeSeriesKey{3, "metric", {{"shard", "b"}}}, 3}});
+  merge.beginPartition();
+  merge.addRun({}, {RangeTombstone{1, 3, "metric"}});
+
+  const auto entries{drain(merge)};
+
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].first, (TimeSeriesKey{1, "metric", {{"shard", "a"}}}));
+  EXPECT_EQ(entries[1].first, (TimeSeriesKey{3, "metric", {{"shard", "b"}}}));
+}
+
+TEST_F(MergeIteratorTest, CanDrainInBatches) {
+  Merge merge{TRUE_TIME_SERIES_KEY_FILTER};
+  merge.addRun({{TimeSeriesKey{1, "metric", {}}, 1},
+                {TimeSeriesKey{3, "metric", {}}, 3},
+                {TimeSeriesKey{5, "metric", {}}, 5}});
+  merge.addRun({{TimeSeriesKey{2, "metric", {}}, 2},
+                {TimeSeriesKey{4, "metric", {}}, std::nullopt}});
+
+  std::vector<std::vector<Timestamp>> timestamps;
+  std::vector<int> values;
+  merge.forEachBatch(
+    [&](const auto& batch) {
+      timestamps.emplace_back(
+        batch.timestamps().begin(), batch.timestamps().end()
+      );
+      values.insert(values.end(), batch.values().begin(), batch.values().end());
+    },
+    [](const auto&, Timestamp) {},
+    Merge::AcceptAnyBlock{},
+    3
+  );
+
+  ASSERT_EQ(timestamps.size(), 2);
+  EXPECT_EQ(timestamps[0], (std::vector<Timestamp>{1, 2, 3}));
+  EXPECT_EQ(timestamps[1], (std::vector<Timestamp>{5}));
+  EXPECT_EQ(values, (std::vector<int>{1, 2, 3, 5}));
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include <vkdb/range_tombstone.h>
+#include <stdexcept>
+
+using namespace vkdb;
+
+TEST(RangeTombstoneTest, CoversKeysOfSeriesInRange) {
+  const TagTable tags{{"tag1", "value1"}};
+  RangeTombstone tombstone{10, 20, "metric", tags};
+
+  EXPECT_TRUE(tombstone.covers(TimeSeriesKey{10, "metric", tags}));
+  EXPECT_TRUE(tombstone.covers(TimeSeriesKey{
+    20, "metric", {{"tag1", "value1"}, {"tag2", "value2"}}
+  }));
+  EXPECT_FALSE(tombstone.covers(TimeSeriesKey{9, "metric", tags}));
+  EXPECT_FALSE(tombstone.covers(TimeSeriesKey{21, "metric", tags}));
+  EXPECT_FALSE(tombstone.covers(TimeSeriesKey{15, "other", tags}));
+  EXPECT_FALSE(
+    tombstone.covers(TimeSeriesKey{15, "metric", {{"tag1", "value2"}}})
+  );
+  EXPECT_FALSE(tombstone.covers(TimeSeriesKey{15, "metric", {}}));
+}
+
+TEST(RangeTombstoneTest, CanCheckOverlapWithTimeRange) {
+  RangeTombstone tombstone{10, 20, "metric"};
+
+  EXPECT_TRUE(tombstone.overlaps(TimeRange{0, 10}));
+  EXPECT_TRUE(tombstone.overlaps(TimeRange{15, 30}));
+  EXPECT_FALSE(tombstone.overlaps(TimeRange{21, 30}));
+  EXPECT_FALSE(tombstone.overlaps(TimeRange{}));
+}
+
+TEST(RangeTombstoneTest, CanConvertToAndFromString) {
+  RangeTombstone tombstone{
+    10, 20, "metric", {{"tag1", "value1"}, {"tag2", "value2"}}
+  };
+  RangeTombstone untagged{0, 5, "metric"};
+
+  EXPECT_EQ(tombstone.str(), "{10}{20}{metric}{tag1:value1,tag2:value2}");
+  EXPECT_EQ(RangeTombstone{tombstone.str()}, tombstone);
+  EXPECT_EQ(RangeTombstone{untagged.str()}, untagged);
+}
+
+TEST(RangeTombstoneTest, ThrowsWhenStartIsAfterEnd) {
+  EXPECT_THROW((RangeTombstone{20, 10, "metric"}), std::invalid_argument);
+}
+
+TEST(RangeTombstoneTest, ThrowsWhenParsingInvalidString) {
+  EXPECT_THROW(RangeTombstone{"{10}{20}{metric}"}, std::invalid_argument);
+  EXPECT_THROW(RangeTombstone{"{a}{20}{metric}{}"}, std::invalid_argument);
+  EXPECT_THROW(RangeTombstone{"{20}{10}{metric}{}"}, std::invalid_argument);
+  EXPECT_THROW(RangeTombstone{"{10}{20}{metric}{}x"}, std::invalid_argument);
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include <vkdb/series_dictionary.h>
+#include <thread>
+#include <vector>
+
+using namespace vkdb;
+
+class SeriesDictionaryTest : public ::testing::Test {
+protected:
+  SeriesDictionary dictionary_;
+};
+
+TEST_F(SeriesDictionaryTest, CanInternSeries) {
+  const auto& series1{dictionary_.intern("metric", {{"tag1", "value1"}})};
+  const auto& series2{dictionary_.intern("metric", {{"tag1", "value1"}})};
+  const auto& series3{dictionary_.intern("metric", {{"tag1", "value2"}})};
+
+  EXPECT_EQ(&series1, &series2);
+  EXPECT_NE(&series1, &series3);
+  EXPECT_EQ(series1.metric, "metric");
+  EXPECT_EQ(series3.tags.at("tag1"), "value2");
+  EXPECT_EQ(dictionary_.size(), 3);
+}
+
+TEST_F(SeriesDictionaryTest, CanGetSeriesById) {
+  const auto& series{dictionary_.intern("metric", {})};
+
+  EXPECT_EQ(&dictionary_.at(series.id), &series);
+  EXPECT_THROW(std::ignore = dictionary_.at(series.id + 1), std::out_of_range);
+}
+
+TEST_F(SeriesDictionaryTest, RemovesSeriesOnceReleased) {
+  const auto& series1{dictionary_.intern("metric", {})};
+  const auto& series2{dictionary_.intern("metric", {})};
+  const auto id{series1.id};
+
+  dictionary_.release(series1);
+  EXPECT_EQ(&dictionary_.at(id), &series2);
+  dictionary_.release(series2);
+  EXPECT_THROW(std::ignore = dictionary_.at(id), std::out_of_range);
+  EXPECT_EQ(dictionary_.size(), 1);
+  EXPECT_NE(dictionary_.intern("metric", {}).id, id);
+}
+
+TEST_F(SeriesDictionaryTest, NeverRemovesTheEmptySeries) {
+  const auto& series{dictionary_.intern({}, {})};
+
+  EXPECT_EQ(&series, &dictionary_.emptySeries());
+  dictionary_.release(series);
+  dictionary_.release(series);
+  EXPECT_EQ(&dictionary_.at(series.id), &series);
+}
+
+TEST_F(SeriesDictionaryTest, CanInternConcurrently) {
+  std::vector<std::thread> threads;
+  std::vector<const Series*> interned(4);
+  for (auto t{0}; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto i{0}; i < 1'000; ++i) {
+        const auto& series{dictionary_.intern(
+          "metric", {{"tag", std::to_string(i)}}
+        )};
+        if (i == 500) {
+          interned[t] = &series;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(dictionary_.size(), 1'001);
+  for (const auto* series : interned) {
+    EXPECT_EQ(series, interned[0]);
+  }
+}
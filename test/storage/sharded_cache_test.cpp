@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+#include <vkdb/sharded_cache.h>
+#include <thread>
+#include <vector>
+
+using namespace vkdb;
+
+class ShardedCacheTest : public ::testing::Test {
+protected:
+  using Key = int32_t;
+  using Value = int32_t;
+  using Cache = ShardedCache<Key, Value>;
+
+  static constexpr size_t CACHE_CAPACITY{3};
+
+  void SetUp() override {
+    cache_ = std::make_unique<Cache>(CACHE_CAPACITY, 1);
+  }
+
+  std::unique_ptr<Cache> cache_;
+};
+
+TEST_F(ShardedCacheTest, CanObtainValueWhenKeyPut) {
+  cache_->put(1, 1);
+  cache_->put(2, std::nullopt);
+
+  EXPECT_EQ(cache_->tryGet(1), std::optional<std::optional<Value>>{1});
+  EXPECT_EQ(
+    cache_->tryGet(2),
+    std::optional<std::optional<Value>>{std::optional<Value>{}}
+  );
+  EXPECT_EQ(cache_->tryGet(3), std::nullopt);
+}
+
+TEST_F(ShardedCacheTest, CanUpdateValueWhenKeyPut) {
+  cache_->put(1, 1);
+  cache_->put(1, 2);
+
+  EXPECT_EQ(cache_->tryGet(1), std::optional<std::optional<Value>>{2});
+  EXPECT_EQ(cache_->size(), 1);
+}
+
+TEST_F(ShardedCacheTest, EvictsUnreferencedKeysFirst) {
+  cache_->put(1, 1);
+  cache_->put(2, 2);
+  cache_->put(3, 3);
+  cache_->put(4, 4);
+  EXPECT_EQ(cache_->size(), CACHE_CAPACITY);
+  EXPECT_FALSE(cache_->contains(1));
+
+  static_cast<void>(cache_->tryGet(3));
+  cache_->put(5, 5);
+
+  EXPECT_TRUE(cache_->contains(3));
+  EXPECT_TRUE(cache_->contains(5));
+  EXPECT_EQ(cache_->size(), CACHE_CAPACITY);
+}
+
+TEST_F(ShardedCacheTest, CanEraseAndClear) {
+  cache_->put(1, 1);
+  cache_->put(2, 2);
+  cache_->put(3, 3);
+
+  cache_->erase(1);
+  EXPECT_FALSE(cache_->contains(1));
+  EXPECT_EQ(cache_->tryGet(3), std::optional<std::optional<Value>>{3});
+  cache_->put(4, 4);
+  EXPECT_EQ(cache_->size(), CACHE_CAPACITY);
+  EXPECT_TRUE(cache_->contains(2));
+
+  cache_->clear();
+  EXPECT_EQ(cache_->size(), 0);
+  EXPECT_FALSE(cache_->contains(2));
+}
+
+TEST_F(ShardedCacheTest, ThrowsWhenCapacityIsZero) {
+  EXPECT_THROW(Cache{0}, std::invalid_argument);
+  EXPECT_THROW((Cache{1, 0}), std::invalid_argument);
+}
+
+TEST_F(ShardedCacheTest, CanBeUsedFromManyThreads) {
+  Cache cache{1'000};
+  EXPECT_EQ(cache.shardCount(), Cache::DEFAULT_SHARD_COUNT);
+
+  std::vector<std::jthread> threads;
+  for (auto t{0}; t < 4; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (auto i{0}; i < 10'000; ++i) {
+        const auto key{(i * 4 + t) % 2'000};
+        if (auto cached{cache.tryGet(key)}) {
+          EXPECT_EQ(cached->value(), key);
+        } else {
+          cache.put(key, key);
+        }
+      }
+    });
+  }
+  threads.clear();
+
+  EXPECT_LE(cache.size(), cache.capacity());
+}
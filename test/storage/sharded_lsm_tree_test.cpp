@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include <vkdb/sharded_lsm_tree.h>
+#include <set>
+
+using namespace vkdb;
+
+class ShardedLSMTreeTest : public ::testing::Test {
+protected:
+  static constexpr uint64_t SHARD_COUNT{4};
+  static constexpr uint64_t SERIES_COUNT{16};
+
+  void SetUp() override {
+    directory_ = "test_sharded_lsm_tree";
+    options_.shards = SHARD_COUNT;
+    options_.mem_table_max_entries = 10;
+    lsm_tree_ = std::make_unique<ShardedLSMTree<int>>(directory_, options_);
+  }
+
+  void TearDown() override {
+    lsm_tree_.reset();
+    std::filesystem::remove_all(directory_);
+  }
+
+  static TimeSeriesKey key(Timestamp timestamp, uint64_t series) {
+    return TimeSeriesKey{
+      timestamp, "metric", {{"host", "host" + std::to_string(series)}}
+    };
+  }
+
+  FilePath directory_;
+  LSMTreeOptions options_;
+  std::unique_ptr<ShardedLSMTree<int>> lsm_tree_;
+};
+
+TEST_F(ShardedLSMTreeTest, CanRouteWritesToTheShardOfTheirSeries) {
+  std::set<uint64_t> used_shards;
+  for (uint64_t series{0}; series < SERIES_COUNT; ++series) {
+    lsm_tree_->put(key(1, series), static_cast<int>(series));
+    used_shards.insert(ShardedLSMTree<int>::shardIndex(
+      key(1, series), SHARD_COUNT
+    ));
+  }
+
+  EXPECT_EQ(lsm_tree_->shardCount(), SHARD_COUNT);
+  EXPECT_GT(used_shards.size(), 1);
+  for (uint64_t series{0}; series < SERIES_COUNT; ++series) {
+    EXPECT_EQ(lsm_tree_->get(key(1, series)), static_cast<int>(series));
+    const auto owner{
+      ShardedLSMTree<int>::shardIndex(key(1, series), SHARD_COUNT)
+    };
+    for (uint64_t i{0}; i < SHARD_COUNT; ++i) {
+      EXPECT_EQ(lsm_tree_->shard(i).get(key(1, series)).has_value(), i == owner);
+    }
+  }
+  for (uint64_t i{0}; i < SHARD_COUNT; ++i) {
+    EXPECT_TRUE(std::filesystem::exists(
+      directory_ / (SHARD_DIRECTORY_PREFIX + std::to_string(i))
+    ));
+  }
+}
+
+TEST_F(ShardedLSMTreeTest, CanRemoveRangesFromEveryShard) {
+  for (uint64_t series{0}; series < SERIES_COUNT; ++series) {
+    lsm_tree_->put(key(1, series), 1);
+    lsm_tree_->put(key(2, series), 2);
+  }
+
+  lsm_tree_->removeRange(RangeTombstone{1, 1, "metric"});
+
+  for (uint64_t series{0}; series < SERIES_COUNT; ++series) {
+    EXPECT_EQ(lsm_tree_->get(key(1, series)), std::nullopt);
+    EXPECT_EQ(lsm_tree_->get(key(2, series)), 2);
+  }
+}
+
+TEST_F(ShardedLSMTreeTest, CanPutBatchesAndReopen) {
+  std::vector<TimeSeriesEntry<int>> entries;
+  for (Timestamp i{0}; i < 50; ++i) {
+    for (uint64_t series{0}; series < SERIES_COUNT; ++series) {
+      entries.emplace_back(key(i, series), static_cast<int>(i));
+    }
+  }
+  lsm_tree_->putBatch(entries);
+  lsm_tree_->put(key(100, 0), 100);
+  EXPECT_FALSE(lsm_tree_->empty());
+
+  lsm_tree_.reset();
+  lsm_tree_ = std::make_unique<ShardedLSMTree<int>>(directory_, options_);
+  lsm_tree_->replayWAL();
+
+  for (const auto& [key, value] : entries) {
+    EXPECT_EQ(lsm_tree_->get(key), value);
+  }
+  EXPECT_EQ(lsm_tree_->get(key(100, 0)), 100);
+}
+
+TEST_F(ShardedLSMTreeTest, ThrowsWhenGivenNoShards) {
+  LSMTreeOptions options;
+  options.shards = 0;
+  EXPECT_THROW(
+    ShardedLSMTree<int>(directory_ / "none", options),
+    std::invalid_argument
+  );
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include <vkdb/sketch.h>
+#include <vkdb/random.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace vkdb;
+
+TEST(QuantileSketchTest, EstimatesQuantilesWithinRelativeAccuracy) {
+  QuantileSketch sketch;
+  std::vector<double> values;
+  for (int i{0}; i < 10'000; ++i) {
+    values.push_back(random<double>(-1'000.0, 100'000.0));
+    sketch.add(values.back());
+  }
+  std::ranges::sort(values);
+
+  for (const auto quantile : {0.0, 0.5, 0.95, 0.99, 1.0}) {
+    const auto expected{values[static_cast<size_t>(
+      quantile * static_cast<double>(values.size() - 1)
+    )]};
+    EXPECT_NEAR(
+      sketch.quantile(quantile),
+      expected,
+      std::abs(expected) * sketch.relativeAccuracy() + 1e-9
+    );
+  }
+}
+
+TEST(QuantileSketchTest, MergesLikeSingleSketch) {
+  QuantileSketch merged;
+  QuantileSketch single;
+  QuantileSketch other;
+  for (int i{1}; i <= 1'000; ++i) {
+    single.add(i);
+    (i % 2 == 0 ? merged : other).add(i);
+  }
+  merged.merge(other);
+
+  EXPECT_EQ(merged.count(), single.count());
+  for (const auto quantile : {0.1, 0.5, 0.9}) {
+    EXPECT_DOUBLE_EQ(merged.quantile(quantile), single.quantile(quantile));
+  }
+}
+
+TEST(QuantileSketchTest, HandlesZerosAndNegatives) {
+  QuantileSketch sketch;
+  sketch.add(-10.0);
+  sketch.add(0.0);
+  sketch.add(10.0);
+
+  EXPECT_NEAR(sketch.quantile(0.0), -10.0, 0.1);
+  EXPECT_EQ(sketch.quantile(0.5), 0.0);
+  EXPECT_NEAR(sketch.quantile(1.0), 10.0, 0.1);
+}
+
+TEST(QuantileSketchTest, BoundsNumberOfBuckets) {
+  QuantileSketch sketch;
+  for (int exponent{-300}; exponent <= 300; ++exponent) {
+    sketch.add(std::pow(10.0, exponent));
+  }
+
+  EXPECT_EQ(sketch.count(), 601);
+  EXPECT_NEAR(sketch.quantile(1.0), 1e300, 1e300 * sketch.relativeAccuracy());
+}
+
+TEST(QuantileSketchTest, ThrowsWhenQueryingInvalidQuantileOrEmptySketch) {
+  QuantileSketch sketch;
+  EXPECT_THROW(std::ignore = sketch.quantile(0.5), std::runtime_error);
+  sketch.add(1.0);
+  EXPECT_THROW(std::ignore = sketch.quantile(1.5), std::invalid_argument);
+  EXPECT_THROW(QuantileSketch{0.0}, std::invalid_argument);
+  EXPECT_THROW(sketch.merge(QuantileSketch{0.05}), std::invalid_argument);
+}
+
+TEST(DistinctSketchTest, EstimatesDistinctCount) {
+  for (const auto distinct : {0, 10, 1'000, 100'000}) {
+    DistinctSketch sketch;
+    for (int repeat{0}; repeat < 3; ++repeat) {
+      for (int i{0}; i < distinct; ++i) {
+        sketch.add(static_cast<double>(i));
+      }
+    }
+
+    EXPECT_NEAR(
+      static_cast<double>(sketch.estimate()),
+      distinct,
+      distinct * 0.03 + 1
+    );
+  }
+}
+
+TEST(DistinctSketchTest, MergesLikeSingleSketch) {
+  DistinctSketch merged;
+  DistinctSketch single;
+  DistinctSketch other;
+  for (int i{0}; i < 5'000; ++i) {
+    const auto str{"host" + std::to_string(i)};
+    single.add(str);
+    (i < 3'000 ? merged : other).add(str);
+  }
+  merged.merge(other);
+
+  EXPECT_EQ(merged.estimate(), single.estimate());
+}
+
+TEST(DistinctSketchTest, TreatsSignedZerosAsSame) {
+  DistinctSketch sketch;
+  sketch.add(0.0);
+  sketch.add(-0.0);
+
+  EXPECT_EQ(sketch.estimate(), 1);
+}
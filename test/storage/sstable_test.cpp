@@ -34,18 +34,258 @@ TEST_F(SSTableTest, CanWriteMemTableToFile) {
 
   sstable_->writeDataToDisk(std::move(*mem_table_));
 
-  std::ifstream file{file_path_};
-  std::string str;
-  std::getline(file, str);
-
-  auto expected_str{
-    "3"
-    "[{00000000000000000001}{metric1}{}|1]"
-    "[{00000000000000000002}{metric2}{}|2]"
-    "[{00000000000000000003}{metric3}{}|3]"
+  std::ifstream file{file_path_, std::ios::binary};
+  std::string magic(SSTable<int>::BINARY_FORMAT_MAGIC.size(), '\0');
+  file.read(magic.data(), magic.size());
+
+  EXPECT_EQ(magic, SSTable<int>::BINARY_FORMAT_MAGIC);
+  EXPECT_EQ(sstable_->format(), SSTableFormat::BINARY);
+}
+
+TEST_F(SSTableTest, CanReloadBinarySSTableFromFile) {
+  TimeSeriesKey key1{1, "metric1", {{"tag1", "value1"}}};
+  TimeSeriesKey key2{2, "metric2", {}};
+  TimeSeriesKey key3{3, "metric3", {{"tag1", "value1"}, {"tag2", "value2"}}};
+
+  mem_table_->put(key1, 1);
+  mem_table_->put(key2, std::nullopt);
+  mem_table_->put(key3, 3);
+
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+
+  SSTable<int> reloaded{file_path_};
+  auto entries{reloaded.entries()};
+
+  EXPECT_EQ(reloaded.format(), SSTableFormat::BINARY);
+  ASSERT_EQ(entries.size(), 3);
+  EXPECT_EQ(entries[0].first, key1);
+  EXPECT_EQ(entries[0].second, 1);
+  EXPECT_EQ(entries[1].first, key2);
+  EXPECT_EQ(entries[1].second, std::nullopt);
+  EXPECT_EQ(entries[2].first, key3);
+  EXPECT_EQ(entries[2].second, 3);
+  EXPECT_EQ(reloaded.get(key3), 3);
+}
+
+TEST_F(SSTableTest, CanSpanMultipleBlocks) {
+  const auto no_of_entries{
+    3 * SSTable<int>::BLOCK_SIZE / sizeof(Timestamp)
+  };
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+
+  SSTable<int> sstable{file_path_, std::move(*mem_table_), no_of_entries};
+
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    EXPECT_EQ(sstable.get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+  EXPECT_EQ(sstable.entries().size(), no_of_entries);
+}
+
+TEST_F(SSTableTest, IndexScalesWithBlocks) {
+  const auto no_of_entries{
+    3 * SSTable<int>::BLOCK_SIZE / sizeof(Timestamp)
+  };
+  for (Timestamp i{0}; i < no_of_entries; i += 2) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+
+  SSTable<int> sstable{file_path_, std::move(*mem_table_), no_of_entries};
+  SSTable<int> reloaded{file_path_};
+
+  EXPECT_GT(sstable.indexSize(), 1);
+  EXPECT_LT(sstable.indexSize(), no_of_entries / 64);
+  EXPECT_EQ(reloaded.indexSize(), sstable.indexSize());
+  EXPECT_EQ(reloaded.get(TimeSeriesKey{1, "metric", {}}), std::nullopt);
+  EXPECT_FALSE(reloaded.contains(TimeSeriesKey{3, "metric", {}}));
+
+  auto entries{reloaded.getRange(
+    TimeSeriesKey{1, "metric", {}},
+    TimeSeriesKey{no_of_entries - 1, "metric", {}}
+  )};
+  ASSERT_EQ(entries.size(), no_of_entries / 2 - 1);
+  for (const auto& [key, value] : entries) {
+    EXPECT_EQ(key.timestamp() % 2, 0);
+    EXPECT_EQ(value, key.timestamp());
+  }
+}
+
+TEST_F(SSTableTest, ThrowsWhenReadingATruncatedFile) {
+  const auto no_of_entries{
+    3 * SSTable<int>::BLOCK_SIZE / sizeof(Timestamp)
+  };
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+  std::filesystem::resize_file(
+    file_path_,
+    std::filesystem::file_size(file_path_) / 2
+  );
+
+  SSTable<int> reloaded{file_path_};
+  const TimeSeriesKey last{no_of_entries - 1, "metric", {}};
+  EXPECT_THROW(
+    std::ignore = reloaded.getRange(TimeSeriesKey{0, "metric", {}}, last),
+    std::runtime_error
+  );
+  EXPECT_THROW(std::ignore = reloaded.entries(), std::runtime_error);
+  EXPECT_THROW(std::ignore = reloaded.get(last), std::runtime_error);
+  EXPECT_THROW(std::ignore = reloaded.contains(last), std::runtime_error);
+}
+
+TEST_F(SSTableTest, CanReadLegacyTextFormat) {
+  TimeSeriesKey key1{1, "metric1", {}};
+  TimeSeriesKey key2{2, "metric2", {}};
+
+  std::string data{"2"};
+  const auto pos1{data.size()};
+  data += entryToString<int>({key1, 1});
+  const auto pos2{data.size()};
+  data += entryToString<int>({key2, std::nullopt});
+
+  std::ofstream data_file{file_path_};
+  data_file << data;
+  data_file.close();
+
+  std::ofstream metadata_file{metadata_file_path_};
+  metadata_file << TimeRange{1, 2}.str() << "\n";
+  metadata_file << KeyRange{key1, key2}.str() << "\n";
+  metadata_file << "19 1 42 0000000000000000000" << "\n";
+  metadata_file << 2 << "\n";
+  metadata_file << key1.str() << "^" << pos1 << "\n";
+  metadata_file << key2.str() << "^" << pos2 << "\n";
+  metadata_file.close();
+
+  SSTable<int> legacy{file_path_};
+  auto entries{legacy.entries()};
+
+  EXPECT_EQ(legacy.format(), SSTableFormat::TEXT);
+  EXPECT_EQ(legacy.indexSize(), 1);
+  EXPECT_EQ(legacy.get(key1), 1);
+  EXPECT_EQ(legacy.get(key2), std::nullopt);
+  EXPECT_TRUE(legacy.mayMatch(KeyPredicate{}.requireAnyMetric({"other"})));
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].second, 1);
+  EXPECT_EQ(entries[1].second, std::nullopt);
+}
+
+TEST_F(SSTableTest, CanReadRowBinaryFormat) {
+  TimeSeriesKey key1{1, "metric1", {}};
+  TimeSeriesKey key2{2, "metric2", {{"tag", "value"}}};
+
+  std::string data{SSTable<int>::BINARY_FORMAT_MAGIC};
+  appendBinary(data, SSTable<int>::ROW_FORMAT_VERSION);
+  appendBinary(data, static_cast<uint32_t>(sizeof(int)));
+  std::string block;
+  entryToBinary<int>(block, {key1, 1});
+  entryToBinary<int>(block, {key2, std::nullopt});
+  appendBinary(data, uint32_t{2});
+  appendBinary(data, static_cast<uint32_t>(block.size()));
+  const auto offset{data.size()};
+  data += block;
+
+  std::ofstream data_file{file_path_, std::ios::binary};
+  data_file << data;
+  data_file.close();
+
+  std::ofstream metadata_file{metadata_file_path_};
+  metadata_file << TimeRange{1, 2}.str() << "\n";
+  metadata_file << KeyRange{key1, key2}.str() << "\n";
+  metadata_file << "19 1 42 0000000000000000000" << "\n";
+  metadata_file << 1 << "\n";
+  metadata_file << key1.str() << "^" << offset << "^" << 2 << "\n";
+  metadata_file.close();
+
+  SSTable<int> row{file_path_};
+  auto entries{row.entries()};
+
+  EXPECT_EQ(row.format(), SSTableFormat::BINARY);
+  EXPECT_EQ(row.get(key1), 1);
+  EXPECT_EQ(row.get(key2), std::nullopt);
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[1].first, key2);
+  EXPECT_EQ(entries[1].second, std::nullopt);
+}
+
+TEST_F(SSTableTest, WritesCompactColumnarBlocks) {
+  constexpr Timestamp no_of_entries{10'000};
+  for (Timestamp i{0}; i < no_of_entries; ++i) {
+    mem_table_->put(
+      TimeSeriesKey{1'700'000'000 + i * 10, "temperature", {{"city", "london"}}},
+      static_cast<int>(i % 5)
+    );
+  }
+  std::string row;
+  mem_table_->forEach([&row](const auto& key, const auto& value) {
+    entryToBinary<int>(row, {key, value});
+  });
+
+  sstable_->writeDataToDisk(*mem_table_);
+
+  EXPECT_LT(std::filesystem::file_size(file_path_) * 10, row.size());
+  SSTable<int> reloaded{file_path_};
+  EXPECT_EQ(reloaded.entries().size(), no_of_entries);
+  EXPECT_EQ(
+    reloaded.get(TimeSeriesKey{1'700'000'120, "temperature", {{"city", "london"}}}),
+    2
+  );
+}
+
+TEST_F(SSTableTest, CanReadCompressedBlocks) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    const auto host{"host-with-a-long-name-" + std::to_string(i % 40)};
+    mem_table_->put(
+      TimeSeriesKey{i, "requests", {{"host", host}, {"region", "eu-west"}}},
+      static_cast<int>(i * 7'919 % 10'007)
+    );
+  }
+  sstable_->writeDataToDisk(*mem_table_);
+  const auto plain_size{std::filesystem::file_size(file_path_)};
+  const auto plain_entries{sstable_->entries()};
+
+  SSTable<int> compressed{
+    file_path_,
+    *mem_table_,
+    mem_table_->size(),
+    {.compression = Compression::LZ4}
   };
+  EXPECT_LT(std::filesystem::file_size(file_path_), plain_size);
+
+  SSTable<int> reloaded{file_path_};
+  EXPECT_EQ(reloaded.entries(), plain_entries);
+  const TimeSeriesKey key{
+    1'234,
+    "requests",
+    {{"host", "host-with-a-long-name-34"}, {"region", "eu-west"}}
+  };
+  EXPECT_EQ(reloaded.get(key), 1'234 * 7'919 % 10'007);
+}
+
+TEST_F(SSTableTest, CanReadThroughBlockCache) {
+  for (Timestamp i{0}; i < 2'000; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  sstable_->writeDataToDisk(*mem_table_);
+  const auto entries{sstable_->entries()};
+
+  const auto block_cache{std::make_shared<BlockCache>(1 << 20)};
+  SSTable<int> cached{file_path_, block_cache};
+  EXPECT_EQ(cached.entries(), entries);
+  EXPECT_EQ(block_cache->size(), 0);
 
-  EXPECT_EQ(str, expected_str);
+  EXPECT_EQ(cached.get(TimeSeriesKey{1'234, "metric", {}}), 1'234);
+  EXPECT_EQ(cached.get(TimeSeriesKey{1'234, "other", {}}), std::nullopt);
+  EXPECT_EQ(block_cache->size(), 1);
+
+  const auto start{TimeSeriesKey{0, "metric", {}}};
+  const auto end{TimeSeriesKey{2'000, "metric", {}}};
+  EXPECT_EQ(cached.getRange(start, end), entries);
+  const auto blocks{block_cache->size()};
+  EXPECT_GT(blocks, 1);
+  EXPECT_EQ(cached.getRange(start, end), entries);
+  EXPECT_EQ(block_cache->size(), blocks);
 }
 
 TEST_F(SSTableTest, CanCheckContains) {
@@ -116,4 +356,219 @@ TEST_F(SSTableTest, CanGetRangeFromSSTable) {
   EXPECT_EQ(entries[0].second, std::nullopt);
   EXPECT_EQ(entries[1].second, 3);
   EXPECT_EQ(entries[2].second, 3);
-}
\ No newline at end of file
+}
+
+TEST_F(SSTableTest, CanReadAgainAfterUnmapping) {
+  TimeSeriesKey key1{1, "metric1", {{"tag1", "value1"}}};
+  TimeSeriesKey key2{2, "metric1", {{"tag1", "value1"}}};
+
+  mem_table_->put(key1, 1);
+  mem_table_->put(key2, std::nullopt);
+
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+
+  EXPECT_EQ(sstable_->get(key1), 1);
+  sstable_->unmap();
+  EXPECT_EQ(sstable_->get(key1), 1);
+  EXPECT_EQ(sstable_->get(key2), std::nullopt);
+  EXPECT_EQ(sstable_->entries().size(), 2);
+}
+
+TEST_F(SSTableTest, CanRewriteMappedSSTable) {
+  TimeSeriesKey key1{1, "metric1", {}};
+  TimeSeriesKey key2{2, "metric2", {}};
+
+  mem_table_->put(key1, 1);
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+  EXPECT_EQ(sstable_->get(key1), 1);
+
+  MemTable<int> mem_table;
+  mem_table.put(key1, 10);
+  mem_table.put(key2, 20);
+  sstable_->writeDataToDisk(std::move(mem_table));
+
+  EXPECT_EQ(sstable_->get(key1), 10);
+  EXPECT_EQ(sstable_->get(key2), 20);
+}
+
+TEST_F(SSTableTest, CanIterateRangeWithCursor) {
+  for (Timestamp i{0}; i < 500; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+
+  auto cursor{sstable_->cursor(
+    TimeSeriesKey{100, "metric", {}}, TimeSeriesKey{399, "metric", {}}
+  )};
+  Timestamp expected{100};
+  for (; cursor.valid(); cursor.advance()) {
+    EXPECT_EQ(cursor.entry().first.timestamp(), expected);
+    EXPECT_EQ(cursor.entry().second, static_cast<int>(expected));
+    ++expected;
+  }
+  EXPECT_EQ(expected, 400);
+
+  auto empty_cursor{sstable_->cursor(
+    TimeSeriesKey{1'000, "metric", {}}, TimeSeriesKey{2'000, "metric", {}}
+  )};
+  EXPECT_FALSE(empty_cursor.valid());
+}
+
+TEST_F(SSTableTest, CanSkipBlocksRuledOutByPredicate) {
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    const auto metric{i < 500 ? "metric1" : "metric2"};
+    mem_table_->put(TimeSeriesKey{i, metric, {{"host", "a"}}}, 1);
+  }
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+  SSTable<int> reloaded{file_path_};
+
+  const auto predicate{std::make_shared<const KeyPredicate>(
+    KeyPredicate{}.requireAnyMetric({"metric1"})
+  )};
+  EXPECT_TRUE(reloaded.mayMatch(*predicate));
+  EXPECT_FALSE(reloaded.mayMatch(KeyPredicate{}.requireAnyMetric({"other"})));
+  EXPECT_FALSE(reloaded.mayMatch(
+    KeyPredicate{}.requireAnyTag({{"host", "b"}})
+  ));
+  EXPECT_FALSE(reloaded.mayMatch(
+    KeyPredicate{}.requireAnyTimestamp({1'000, 2'000})
+  ));
+
+  uint64_t matching{0};
+  uint64_t read{0};
+  for (
+    auto cursor{reloaded.cursor(
+      MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY, predicate
+    )};
+    cursor.valid();
+    cursor.advance()
+  ) {
+    matching += predicate->matches(cursor.entry().first);
+    ++read;
+  }
+  EXPECT_EQ(matching, 500);
+  EXPECT_LT(read, 1'000);
+}
+
+TEST_F(SSTableTest, CanReloadBlockStatistics) {
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  mem_table_->put(TimeSeriesKey{1'000, "metric", {}}, std::nullopt);
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+  SSTable<int> reloaded{file_path_};
+
+  uint64_t count{0};
+  int64_t sum{0};
+  auto cursor{reloaded.cursor(MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY)};
+  while (cursor.valid()) {
+    const auto* block_stats{cursor.runStats()};
+    ASSERT_NE(block_stats, nullptr);
+    ASSERT_EQ(block_stats->entries().size(), 1);
+    const auto& [series, stats]{block_stats->entries().front()};
+    EXPECT_EQ(cursor.seriesKey(series).metric(), "metric");
+    EXPECT_EQ(stats.min, cursor.entry().second);
+    count += stats.count;
+    sum += stats.sum;
+    cursor.skipRun();
+  }
+  EXPECT_EQ(count, 1'000);
+  EXPECT_EQ(sum, 999 * 1'000 / 2);
+
+  auto partial{reloaded.cursor(
+    TimeSeriesKey{10, "metric", {}}, TimeSeriesKey{20, "metric", {}}
+  )};
+  EXPECT_EQ(partial.runStats(), nullptr);
+}
+
+TEST_F(SSTableTest, CanReloadRollup) {
+  for (Timestamp i{0}; i < 1'000; ++i) {
+    const auto metric{i % 2 == 0 ? "even" : "odd"};
+    mem_table_->put(TimeSeriesKey{i, metric, {}}, static_cast<int>(i));
+  }
+  mem_table_->put(TimeSeriesKey{1'000, "even", {}}, std::nullopt);
+  SSTable<int> written{
+    file_path_, *mem_table_, mem_table_->size(), {.keep_rollup = true}
+  };
+  SSTable<int> reloaded{file_path_};
+  ASSERT_TRUE(reloaded.hasRollup());
+
+  auto cursor{reloaded.cursor(MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY)};
+  const auto rollup{cursor.rollup()};
+  ASSERT_EQ(rollup.size(), 2);
+  for (uint32_t series{0}; series < rollup.size(); ++series) {
+    const auto even{cursor.seriesKey(series).metric() == "even"};
+    EXPECT_EQ(rollup[series].count, 500);
+    EXPECT_EQ(rollup[series].min, even ? 0 : 1);
+    EXPECT_EQ(rollup[series].max, even ? 998 : 999);
+  }
+  EXPECT_EQ(rollup[0].sum + rollup[1].sum, 999 * 1'000 / 2);
+
+  cursor.advance();
+  EXPECT_TRUE(cursor.rollup().empty());
+  cursor.skipTable();
+  EXPECT_FALSE(cursor.valid());
+
+  auto partial{reloaded.cursor(
+    TimeSeriesKey{10, "even", {}}, TimeSeriesKey{20, "even", {}}
+  )};
+  EXPECT_TRUE(partial.rollup().empty());
+
+  sstable_->writeDataToDisk(*mem_table_);
+  SSTable<int> without_rollup{file_path_};
+  EXPECT_FALSE(without_rollup.hasRollup());
+  EXPECT_TRUE(without_rollup.cursor(
+    MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY
+  ).rollup().empty());
+}
+
+TEST_F(SSTableTest, CanReloadRangeTombstones) {
+  mem_table_->put(TimeSeriesKey{1, "metric", {}}, 1);
+  mem_table_->removeRange(RangeTombstone{0, 100, "metric", {{"tag", "a"}}});
+  mem_table_->removeRange(RangeTombstone{150, 200, "other"});
+
+  sstable_->writeDataToDisk(*mem_table_);
+  SSTable<int> reloaded{file_path_};
+
+  ASSERT_EQ(reloaded.rangeTombstones(), mem_table_->rangeTombstones());
+  EXPECT_TRUE(
+    reloaded.isRangeDeleted(TimeSeriesKey{50, "metric", {{"tag", "a"}}})
+  );
+  EXPECT_FALSE(reloaded.isRangeDeleted(TimeSeriesKey{50, "metric", {}}));
+  EXPECT_EQ(reloaded.get(TimeSeriesKey{1, "metric", {}}), 1);
+  EXPECT_EQ(reloaded.timeRange().upper(), 1);
+  EXPECT_EQ(reloaded.coveredTimeRange().lower(), 0);
+  EXPECT_EQ(reloaded.coveredTimeRange().upper(), 200);
+}
+
+TEST_F(SSTableTest, CanWriteSSTableWithOnlyRangeTombstones) {
+  mem_table_->removeRange(RangeTombstone{10, 20, "metric"});
+
+  SSTable<int> sstable{file_path_, *mem_table_, 1};
+  SSTable<int> reloaded{file_path_};
+
+  EXPECT_TRUE(reloaded.entries().empty());
+  EXPECT_FALSE(reloaded.timeRange().isSet());
+  EXPECT_EQ(reloaded.rangeTombstones().size(), 1);
+  EXPECT_EQ(reloaded.coveredTimeRange().lower(), 10);
+  EXPECT_EQ(reloaded.get(TimeSeriesKey{15, "metric", {}}), std::nullopt);
+  EXPECT_FALSE(
+    reloaded.cursor(MIN_TIME_SERIES_KEY, MAX_TIME_SERIES_KEY).valid()
+  );
+}
+
+TEST_F(SSTableTest, CanReleaseAndReloadBloomFilter) {
+  for (Timestamp i{0}; i < 100; ++i) {
+    mem_table_->put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+  }
+  sstable_->writeDataToDisk(std::move(*mem_table_));
+  const auto filter_bytes{sstable_->filterBytes()};
+  ASSERT_GT(filter_bytes, 0);
+  EXPECT_GT(sstable_->indexBytes(), 0);
+
+  sstable_->releaseFilter();
+  EXPECT_EQ(sstable_->filterBytes(), 0);
+  EXPECT_EQ(sstable_->get(TimeSeriesKey{42, "metric", {}}), 42);
+  EXPECT_EQ(sstable_->filterBytes(), filter_bytes);
+  EXPECT_FALSE(sstable_->contains(TimeSeriesKey{42, "other", {}}));
+}
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include <vkdb/storage_stats.h>
+#include <thread>
+#include <vector>
+
+using namespace vkdb;
+
+TEST(StorageStatsTest, CounterSumsAddsFromManyThreads) {
+  Counter counter;
+  std::vector<std::thread> threads;
+  for (auto i{0}; i < 16; ++i) {
+    threads.emplace_back([&counter] {
+      for (auto j{0}; j < 1'000; ++j) {
+        counter.add();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  counter.add(5);
+
+  EXPECT_EQ(counter.value(), 16'005);
+}
+
+TEST(StorageStatsTest, HistogramBucketsLatenciesByPowersOfTwo) {
+  LatencyHistogram histogram;
+  for (auto i{0}; i < 99; ++i) {
+    histogram.record(std::chrono::nanoseconds{100});
+  }
+  histogram.record(std::chrono::microseconds{10});
+  histogram.record(std::chrono::nanoseconds{-1});
+
+  const auto snapshot{histogram.snapshot()};
+  EXPECT_EQ(snapshot.count, 101);
+  EXPECT_EQ(snapshot.sum, 99 * 100 + 10'000);
+  EXPECT_EQ(snapshot.buckets[0], 1);
+  EXPECT_EQ(snapshot.buckets[7], 99);
+  EXPECT_EQ(snapshot.quantile(0.5), 128);
+  EXPECT_EQ(snapshot.quantile(1.0), 16'384);
+  EXPECT_EQ(HistogramSnapshot{}.quantile(0.5), 0);
+}
+
+TEST(StorageStatsTest, AddsStatsLayerByLayer) {
+  StorageStats lhs;
+  lhs.flushes = 1;
+  lhs.compactions = {1, 2};
+  lhs.cache_hits = 3;
+  lhs.cache_misses = 1;
+
+  StorageStats rhs;
+  rhs.flushes = 2;
+  rhs.compactions = {1, 1, 1};
+  rhs.bloom_true_positives = 3;
+  rhs.bloom_false_positives = 1;
+
+  lhs += rhs;
+  EXPECT_EQ(lhs.flushes, 3);
+  EXPECT_EQ(lhs.compactions, (std::vector<StorageStats::size_type>{2, 3, 1}));
+  EXPECT_DOUBLE_EQ(lhs.cacheHitRatio(), 0.75);
+  EXPECT_DOUBLE_EQ(lhs.bloomFalsePositiveRate(), 0.25);
+  EXPECT_NE(lhs.str().find("compactions.c1 3\n"), std::string::npos);
+}
+
+TEST(StorageStatsTest, CanConvertToPrometheusText) {
+  StorageMetrics metrics{2};
+  metrics.flushes.add(4);
+  metrics.compactions[0].add();
+  metrics.flush_latency.record(std::chrono::nanoseconds{3});
+  auto stats{metrics.snapshot()};
+  stats.sstables = {1, 2};
+
+  const auto text{prometheusText({{"sensors", stats}})};
+  EXPECT_NE(
+    text.find("# TYPE vkdb_flushes_total counter\n"), std::string::npos
+  );
+  EXPECT_NE(
+    text.find("vkdb_flushes_total{table=\"sensors\"} 4\n"), std::string::npos
+  );
+  EXPECT_NE(
+    text.find("vkdb_compactions_total{table=\"sensors\",layer=\"c0\"} 1\n"),
+    std::string::npos
+  );
+  EXPECT_NE(
+    text.find("vkdb_sstables{table=\"sensors\",layer=\"c1\"} 2\n"),
+    std::string::npos
+  );
+  EXPECT_NE(
+    text.find("vkdb_flush_seconds_bucket{table=\"sensors\",le=\"+Inf\"} 1\n"),
+    std::string::npos
+  );
+  EXPECT_NE(
+    text.find("vkdb_flush_seconds_count{table=\"sensors\"} 1\n"),
+    std::string::npos
+  );
+}
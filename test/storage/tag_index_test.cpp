@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include <vkdb/tag_index.h>
+#include <algorithm>
+#include <fstream>
+
+using namespace vkdb;
+
+class TagIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    directory_ = "test_tag_index";
+    std::filesystem::create_directories(directory_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(directory_);
+  }
+
+  [[nodiscard]] std::filesystem::path path() const {
+    return directory_ / "tag_index.metadata";
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(TagIndexTest, CanFindSeriesWithAllTags) {
+  TagIndex index;
+  const TimeSeriesKey a_eu{0, "cpu", {{"host", "a"}, {"region", "eu"}}};
+  const TimeSeriesKey b_eu{0, "cpu", {{"host", "b"}, {"region", "eu"}}};
+  const TimeSeriesKey a_us{0, "mem", {{"host", "a"}, {"region", "us"}}};
+  index.insert(a_eu);
+  index.insert(b_eu);
+  index.insert(a_us);
+  index.insert(TimeSeriesKey{10, "cpu", {{"host", "a"}, {"region", "eu"}}});
+
+  EXPECT_EQ(index.size(), 3);
+  EXPECT_EQ(
+    index.seriesWithTags({{"host", "a"}, {"region", "eu"}}),
+    std::vector<SeriesId>{a_eu.seriesId()}
+  );
+  const auto hosts_a{index.seriesWithTags({{"host", "a"}})};
+  EXPECT_EQ(hosts_a.size(), 2);
+  EXPECT_TRUE(std::ranges::is_sorted(hosts_a));
+  EXPECT_TRUE(index.seriesWithTags({{"host", "c"}}).empty());
+  EXPECT_TRUE(index.seriesWithTags({{"host", "b"}, {"region", "us"}}).empty());
+  EXPECT_EQ(index.seriesWithTags({}).size(), 3);
+}
+
+TEST_F(TagIndexTest, HoldsItsSeriesUntilCleared) {
+  const auto& dictionary{SeriesDictionary::instance()};
+  const auto size{dictionary.size()};
+  TagIndex index;
+  SeriesId id;
+  {
+    const TimeSeriesKey key{0, "held_metric", {{"host", "a"}}};
+    index.insert(key);
+    id = key.seriesId();
+  }
+
+  EXPECT_EQ(dictionary.at(id).metric, "held_metric");
+  EXPECT_GT(index.bytes(), 0);
+  index.clear();
+  EXPECT_EQ(index.bytes(), 0);
+  EXPECT_EQ(dictionary.size(), size);
+}
+
+TEST_F(TagIndexTest, CanSaveAndLoad) {
+  const TimeSeriesKey key{0, "cpu", {{"host", "a"}}};
+  {
+    TagIndex index;
+    index.insert(key);
+    index.insert(TimeSeriesKey{0, "cpu", {{"host", "b"}}});
+    EXPECT_TRUE(index.dirty());
+    index.save(path(), IOBackend::POSIX);
+    EXPECT_FALSE(index.dirty());
+  }
+
+  TagIndex index;
+  ASSERT_TRUE(index.load(path()));
+  EXPECT_FALSE(index.dirty());
+  EXPECT_EQ(index.size(), 2);
+  EXPECT_TRUE(index.contains(key.seriesId()));
+  EXPECT_EQ(
+    index.seriesWithTags({{"host", "a"}}),
+    std::vector<SeriesId>{key.seriesId()}
+  );
+}
+
+TEST_F(TagIndexTest, ReturnsFalseWhenLoadingMissingOrMalformedFile) {
+  TagIndex index;
+  index.insert(TimeSeriesKey{0, "cpu", {{"host", "a"}}});
+
+  EXPECT_FALSE(index.load(path()));
+  EXPECT_EQ(index.size(), 0);
+
+  {
+    std::ofstream file{path(), std::ios::binary};
+    file << TagIndex::MAGIC << "\x05";
+  }
+  EXPECT_FALSE(index.load(path()));
+  EXPECT_EQ(index.size(), 0);
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include <vkdb/time_series_key.h>
+#include <vkdb/series_dictionary.h>
 
 using namespace vkdb;
 
@@ -43,6 +44,55 @@ TEST_F(TimeSeriesKeyTest, CanTotallyOrderKeys) {
   EXPECT_GT(key3, key4);
 }
 
+TEST_F(TimeSeriesKeyTest, KeysOfSameSeriesShareSeries) {
+  TimeSeriesKey key1{1, "metric1", tags_};
+  TimeSeriesKey key2{2, "metric1", tags_};
+  TimeSeriesKey key3{1, "metric2", tags_};
+
+  EXPECT_EQ(key1.seriesId(), key2.seriesId());
+  EXPECT_EQ(&key1.metric(), &key2.metric());
+  EXPECT_NE(key1.seriesId(), key3.seriesId());
+  EXPECT_EQ(TimeSeriesKey{key1.str()}.seriesId(), key1.seriesId());
+}
+
+TEST_F(TimeSeriesKeyTest, SeriesAreReleasedWithTheirLastKey) {
+  const auto& dictionary{SeriesDictionary::instance()};
+  const auto size{dictionary.size()};
+  SeriesId id;
+  {
+    TimeSeriesKey key{1, "released_metric", tags_};
+    auto copy{key};
+    const auto moved{std::move(copy)};
+    copy = key;
+    id = key.seriesId();
+    EXPECT_EQ(dictionary.size(), size + 1);
+  }
+
+  EXPECT_EQ(dictionary.size(), size);
+  EXPECT_THROW(std::ignore = dictionary.at(id), std::out_of_range);
+  EXPECT_NE(TimeSeriesKey(1, "released_metric", tags_).seriesId(), id);
+}
+
+TEST_F(TimeSeriesKeyTest, CanHashKeys) {
+  TimeSeriesKey key1{1, "metric1", tags_};
+  TimeSeriesKey key2{1, "metric1", tags_};
+  TimeSeriesKey key3{2, "metric1", tags_};
+
+  std::hash<TimeSeriesKey> hash;
+  EXPECT_EQ(hash(key1), hash(key2));
+  EXPECT_NE(hash(key1), hash(key3));
+}
+
+TEST_F(TimeSeriesKeyTest, CanOrderAgainstMinAndMaxKeys) {
+  TimeSeriesKey key{0, "metric1", tags_};
+
+  EXPECT_LT(MIN_TIME_SERIES_KEY, key);
+  EXPECT_LT(key, MAX_TIME_SERIES_KEY);
+  EXPECT_FALSE(MIN_TIME_SERIES_KEY < MIN_TIME_SERIES_KEY);
+  EXPECT_FALSE(MAX_TIME_SERIES_KEY < MAX_TIME_SERIES_KEY);
+  EXPECT_EQ(TimeSeriesKey{}.metric(), "");
+}
+
 TEST_F(TimeSeriesKeyTest, CanObtainTimestamp) {
   TimeSeriesKey key{1, "metric1", tags_};
 
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include <vkdb/value_batch.h>
+#include <vkdb/random.h>
+
+using namespace vkdb;
+
+class ValueBatchTest : public ::testing::Test {
+protected:
+  template <typename TValue>
+  static SeriesStats<TValue> aggregate_sequentially(
+    const std::vector<TValue>& values
+  ) {
+    SeriesStats<TValue> stats;
+    for (const auto value : values) {
+      stats.add(value);
+    }
+    return stats;
+  }
+};
+
+TEST_F(ValueBatchTest, CanCollectEntries) {
+  ValueBatch<int> batch{2};
+
+  batch.push(1, 10);
+  EXPECT_FALSE(batch.full());
+  batch.push(2, 20);
+
+  EXPECT_TRUE(batch.full());
+  EXPECT_EQ(batch.size(), 2);
+  EXPECT_EQ(batch.timestamps()[1], 2);
+  EXPECT_EQ(batch.values()[1], 20);
+
+  batch.clear();
+
+  EXPECT_TRUE(batch.empty());
+}
+
+TEST_F(ValueBatchTest, ThrowsWhenCapacityIsZero) {
+  EXPECT_THROW(ValueBatch<int>{0}, std::invalid_argument);
+}
+
+TEST_F(ValueBatchTest, AggregatesNothingWhenEmpty) {
+  const auto stats{aggregateValues(std::span<const double>{})};
+
+  EXPECT_EQ(stats.count, 0);
+  EXPECT_EQ(stats.sum, 0.0);
+}
+
+TEST_F(ValueBatchTest, AggregatesIntegersLikeSequentialLoop) {
+  for (const auto size : {1, 7, 1000}) {
+    std::vector<int> values;
+    for (int i{0}; i < size; ++i) {
+      values.push_back(random<int>(-1000, 1000));
+    }
+
+    const auto expected{aggregate_sequentially(values)};
+    const auto actual{aggregateValues(std::span<const int>{values})};
+
+    EXPECT_EQ(actual.count, expected.count);
+    EXPECT_EQ(actual.sum, expected.sum);
+    EXPECT_EQ(actual.min, expected.min);
+    EXPECT_EQ(actual.max, expected.max);
+  }
+}
+
+TEST_F(ValueBatchTest, AggregatesDoublesLikeSequentialLoop) {
+  for (const auto size : {1, 7, 1000}) {
+    std::vector<double> values;
+    for (int i{0}; i < size; ++i) {
+      values.push_back(random<double>(-1000.0, 1000.0));
+    }
+
+    const auto expected{aggregate_sequentially(values)};
+    const auto actual{aggregateValues(std::span<const double>{values})};
+
+    EXPECT_EQ(actual.count, expected.count);
+    EXPECT_NEAR(actual.sum, expected.sum, 1e-6);
+    EXPECT_EQ(actual.min, expected.min);
+    EXPECT_EQ(actual.max, expected.max);
+  }
+}
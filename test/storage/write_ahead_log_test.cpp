@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include <vkdb/write_ahead_log.h>
+#include <chrono>
+#include <thread>
 
 using namespace vkdb;
 
@@ -7,6 +9,7 @@ class WriteAheadLogTest : public ::testing::Test {
 protected:
   void SetUp() override {
     lsm_tree_path_ = "test_lsm_tree";
+    std::filesystem::remove_all(lsm_tree_path_);
     std::filesystem::create_directories(lsm_tree_path_);
     wal_ = std::make_unique<WriteAheadLog<int>>(lsm_tree_path_);
   }
@@ -29,7 +32,7 @@ TEST_F(WriteAheadLogTest, CanAppendRecord) {
   std::string line;
   std::getline(file, line);
 
-  EXPECT_EQ(line, "0 [{00000000000000000001}{metric}{}|1]");
+  EXPECT_EQ(line, "0 [{00000000000000000001}{metric}{}|1] 0");
   file.close();
 }
 
@@ -45,6 +48,362 @@ TEST_F(WriteAheadLogTest, CanReplayRecord) {
   EXPECT_EQ(entry.value(), 1);
 }
 
+TEST_F(WriteAheadLogTest, CanSealLog) {
+  TimeSeriesKey key{1, "metric", {}};
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 1}});
+
+  const auto segment_path{wal_->seal()};
+  EXPECT_TRUE(std::filesystem::exists(segment_path));
+  EXPECT_FALSE(std::filesystem::exists(wal_->path()));
+
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 2}});
+  EXPECT_NE(wal_->seal(), segment_path);
+}
+
+TEST_F(WriteAheadLogTest, CanReplaySealedSegmentsInOrder) {
+  TimeSeriesKey key1{1, "metric", {}};
+  TimeSeriesKey key2{2, "metric", {}};
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key1, 1}});
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key2, 2}});
+  const auto segment_path{wal_->seal()};
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key1, 3}});
+  wal_->append({WALRecordType::REMOVE, TimeSeriesEntry<int>{key2, {}}});
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  wal_->replay(lsm_tree);
+
+  EXPECT_EQ(lsm_tree.get(key1), 3);
+  EXPECT_EQ(lsm_tree.get(key2), std::nullopt);
+  EXPECT_FALSE(std::filesystem::exists(segment_path));
+}
+
+TEST_F(WriteAheadLogTest, CanReplayCompressedSegments) {
+  std::filesystem::remove(wal_->path());
+  WriteAheadLog<int> wal{
+    lsm_tree_path_, WALOptions{.compression = Compression::LZ4}
+  };
+  for (Timestamp i{0}; i < 100; ++i) {
+    wal.append({
+      WALRecordType::PUT,
+      {TimeSeriesKey{i, "metric", {}}, static_cast<int>(i)}
+    });
+  }
+  const auto plain_size{std::filesystem::file_size(wal.path())};
+  const auto segment_path{wal.seal()};
+  EXPECT_LT(std::filesystem::file_size(segment_path), plain_size);
+  wal.append({WALRecordType::REMOVE, {TimeSeriesKey{0, "metric", {}}, {}}});
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  wal.replay(lsm_tree);
+
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{0, "metric", {}}), std::nullopt);
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{99, "metric", {}}), 99);
+  EXPECT_FALSE(std::filesystem::exists(segment_path));
+}
+
+TEST_F(WriteAheadLogTest, CanSyncEveryWrite) {
+  WriteAheadLog<int> wal{
+    lsm_tree_path_, WALOptions{.sync_policy = WALSyncPolicy::EVERY_WRITE}
+  };
+  TimeSeriesKey key{1, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 1}});
+
+  EXPECT_GT(std::filesystem::file_size(wal.path()), 0);
+}
+
+TEST_F(WriteAheadLogTest, CanSyncEveryWriteWithIOUring) {
+  std::filesystem::remove(wal_->path());
+  {
+    WriteAheadLog<int> wal{
+      lsm_tree_path_,
+      WALOptions{
+        .sync_policy = WALSyncPolicy::EVERY_WRITE,
+        .io_backend = IOBackend::IO_URING
+      }
+    };
+    for (auto i{0}; i < 3; ++i) {
+      TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+      wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+    }
+  }
+  WriteAheadLog<int> wal{
+    lsm_tree_path_, WALOptions{.io_backend = IOBackend::IO_URING}
+  };
+  TimeSeriesKey key{3, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 3}});
+
+  std::ifstream file{wal.path()};
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  ASSERT_EQ(lines.size(), 4);
+  EXPECT_EQ(lines[0], "0 [{00000000000000000000}{metric}{}|0] 0");
+  EXPECT_EQ(lines[3], "0 [{00000000000000000003}{metric}{}|3] 3");
+}
+
+TEST_F(WriteAheadLogTest, CanGroupCommitByBytes) {
+  std::filesystem::remove(wal_->path());
+  WriteAheadLog<int> wal{
+    lsm_tree_path_,
+    WALOptions{.sync_policy = WALSyncPolicy::BYTES, .sync_bytes = 100}
+  };
+  TimeSeriesKey key{1, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 1}});
+  EXPECT_FALSE(std::filesystem::exists(wal.path()));
+
+  for (auto i{0}; i < 3; ++i) {
+    wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+  }
+  ASSERT_TRUE(std::filesystem::exists(wal.path()));
+  const auto committed_size{std::filesystem::file_size(wal.path())};
+  EXPECT_GE(committed_size, 100);
+
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 4}});
+  EXPECT_EQ(std::filesystem::file_size(wal.path()), committed_size);
+  wal.sync();
+  EXPECT_GT(std::filesystem::file_size(wal.path()), committed_size);
+}
+
+TEST_F(WriteAheadLogTest, CanGroupCommitByInterval) {
+  std::filesystem::remove(wal_->path());
+  WriteAheadLog<int> wal{
+    lsm_tree_path_,
+    WALOptions{
+      .sync_policy = WALSyncPolicy::INTERVAL,
+      .sync_interval = std::chrono::milliseconds{10}
+    }
+  };
+  TimeSeriesKey key{1, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 1}});
+
+  for (auto i{0}; i < 500 && !std::filesystem::exists(wal.path()); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  ASSERT_TRUE(std::filesystem::exists(wal.path()));
+  EXPECT_GT(std::filesystem::file_size(wal.path()), 0);
+}
+
+TEST_F(WriteAheadLogTest, CanReplayBufferedRecords) {
+  {
+    LSMTree<int> lsm_tree{
+      lsm_tree_path_,
+      LSMTreeOptions{.wal{.sync_policy = WALSyncPolicy::BYTES}}
+    };
+    for (Timestamp i{0}; i < 10; ++i) {
+      lsm_tree.put(TimeSeriesKey{i, "metric", {}}, static_cast<int>(i));
+    }
+  }
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  lsm_tree.replayWAL();
+  for (Timestamp i{0}; i < 10; ++i) {
+    EXPECT_EQ(lsm_tree.get(TimeSeriesKey{i, "metric", {}}), i);
+  }
+}
+
+TEST_F(WriteAheadLogTest, CanReadRecordsFromLSN) {
+  for (auto i{0}; i < 3; ++i) {
+    TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+    wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+  }
+
+  const auto chunk{wal_->readFrom(1, 1 << 20)};
+  EXPECT_EQ(chunk.next_lsn, 3);
+
+  LSMTree<int> lsm_tree{lsm_tree_path_ / "follower"};
+  EXPECT_EQ(WriteAheadLog<int>::applyRecords(chunk.records, lsm_tree), 2);
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{0, "metric", {}}).has_value());
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{1, "metric", {}}), 1);
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{2, "metric", {}}), 2);
+}
+
+TEST_F(WriteAheadLogTest, CanReadArchivedSegmentsUntilAcknowledged) {
+  std::filesystem::remove(wal_->path());
+  WriteAheadLog<int> wal{lsm_tree_path_, WALOptions{.archive = true}};
+  for (auto i{0}; i < 2; ++i) {
+    TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+    wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+  }
+  wal.release(wal.seal());
+  TimeSeriesKey key{2, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 2}});
+
+  EXPECT_EQ(wal.readFrom(0, 1 << 20).next_lsn, 3);
+
+  wal.acknowledge(2);
+  EXPECT_THROW(std::ignore = wal.readFrom(0, 1 << 20), std::runtime_error);
+  EXPECT_EQ(wal.readFrom(2, 1 << 20).next_lsn, 3);
+}
+
+TEST_F(WriteAheadLogTest, StopsReadingAfterMaxBytes) {
+  for (auto i{0}; i < 3; ++i) {
+    TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+    wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+  }
+
+  const auto chunk{wal_->readFrom(0, 1)};
+  EXPECT_EQ(chunk.next_lsn, 1);
+  EXPECT_EQ(chunk.records, "0 [{00000000000000000000}{metric}{}|0] 0\n");
+}
+
+TEST_F(WriteAheadLogTest, KeepsLSNsAfterSegmentsAreRemoved) {
+  for (auto i{0}; i < 2; ++i) {
+    TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+    wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+  }
+  wal_->release(wal_->seal());
+  wal_.reset();
+
+  WriteAheadLog<int> wal{lsm_tree_path_};
+  EXPECT_EQ(wal.nextLSN(), 2);
+}
+
+TEST_F(WriteAheadLogTest, CanReplayRecordsWithoutLSNs) {
+  {
+    std::ofstream file{wal_->path()};
+    file << "0 [{00000000000000000001}{metric}{}|1]\n";
+  }
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  lsm_tree.replayWAL();
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{1, "metric", {}}), 1);
+}
+
+TEST_F(WriteAheadLogTest, CanReplayBinaryRecordsOnSeveralThreads) {
+  std::filesystem::remove(wal_->path());
+  {
+    WriteAheadLog<int> wal{
+      lsm_tree_path_,
+      WALOptions{.format = WALFormat::BINARY}
+    };
+    for (auto i{0}; i < 20'000; ++i) {
+      TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {{"tag", "a"}}};
+      wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+    }
+    wal.appendRangeTombstone(RangeTombstone{100, 199, "metric"});
+    TimeSeriesKey key{150, "metric", {{"tag", "a"}}};
+    wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 1}});
+    wal.append({
+      WALRecordType::REMOVE,
+      TimeSeriesEntry<int>{key, std::nullopt}
+    });
+  }
+
+  LSMTree<int> lsm_tree{
+    lsm_tree_path_,
+    LSMTreeOptions{
+      .mem_table_max_entries = 1'000,
+      .wal{.format = WALFormat::BINARY, .replay_threads = 4}
+    }
+  };
+  lsm_tree.replayWAL();
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{99, "metric", {{"tag", "a"}}}), 99);
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{120, "metric", {{"tag", "a"}}}));
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{150, "metric", {{"tag", "a"}}}));
+  EXPECT_EQ(
+    lsm_tree.get(TimeSeriesKey{19'999, "metric", {{"tag", "a"}}}),
+    19'999
+  );
+  EXPECT_EQ(lsm_tree.nextLSN(), 20'003);
+}
+
+TEST_F(WriteAheadLogTest, StopsReplayAtCorruptBinaryRecord) {
+  std::filesystem::remove(wal_->path());
+  {
+    WriteAheadLog<int> wal{
+      lsm_tree_path_,
+      WALOptions{.format = WALFormat::BINARY}
+    };
+    for (auto i{0}; i < 3; ++i) {
+      TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+      wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+    }
+  }
+  const auto record_size{
+    (std::filesystem::file_size(wal_->path()) - WAL_BINARY_MAGIC.size()) / 3
+  };
+  {
+    std::fstream file{
+      wal_->path(),
+      std::ios::in | std::ios::out | std::ios::binary
+    };
+    file.seekp(WAL_BINARY_MAGIC.size() + record_size + record_size / 2);
+    file.put('\x7f');
+  }
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  lsm_tree.replayWAL();
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{0, "metric", {}}), 0);
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{1, "metric", {}}));
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{2, "metric", {}}));
+}
+
+TEST_F(WriteAheadLogTest, TruncatesTornBinaryRecordOnOpening) {
+  std::filesystem::remove(wal_->path());
+  {
+    WriteAheadLog<int> wal{
+      lsm_tree_path_,
+      WALOptions{.format = WALFormat::BINARY}
+    };
+    for (auto i{0}; i < 2; ++i) {
+      TimeSeriesKey key{static_cast<Timestamp>(i), "metric", {}};
+      wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, i}});
+    }
+  }
+  std::filesystem::resize_file(
+    wal_->path(),
+    std::filesystem::file_size(wal_->path()) - 3
+  );
+
+  {
+    WriteAheadLog<int> wal{lsm_tree_path_};
+    EXPECT_EQ(wal.nextLSN(), 1);
+    TimeSeriesKey key{5, "metric", {}};
+    wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 5}});
+  }
+
+  LSMTree<int> lsm_tree{lsm_tree_path_};
+  lsm_tree.replayWAL();
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{0, "metric", {}}), 0);
+  EXPECT_FALSE(lsm_tree.get(TimeSeriesKey{1, "metric", {}}));
+  EXPECT_EQ(lsm_tree.get(TimeSeriesKey{5, "metric", {}}), 5);
+}
+
+TEST_F(WriteAheadLogTest, SwitchesFormatWhenSealed) {
+  TimeSeriesKey text_key{1, "metric", {}};
+  wal_->append({WALRecordType::PUT, TimeSeriesEntry<int>{text_key, 1}});
+  wal_.reset();
+
+  WriteAheadLog<int> wal{
+    lsm_tree_path_,
+    WALOptions{.format = WALFormat::BINARY}
+  };
+  TimeSeriesKey key{2, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 2}});
+  {
+    std::ifstream file{wal.path()};
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "0 [{00000000000000000001}{metric}{}|1] 0");
+  }
+  wal.seal();
+  key = TimeSeriesKey{3, "metric", {}};
+  wal.append({WALRecordType::PUT, TimeSeriesEntry<int>{key, 3}});
+  {
+    std::ifstream file{wal.path(), std::ios::binary};
+    std::string magic(WAL_BINARY_MAGIC.size(), '\0');
+    file.read(magic.data(), magic.size());
+    EXPECT_EQ(magic, WAL_BINARY_MAGIC);
+  }
+
+  EXPECT_EQ(
+    wal.readFrom(1, 1 << 20).records,
+    "0 [{00000000000000000002}{metric}{}|2] 1\n"
+    "0 [{00000000000000000003}{metric}{}|3] 2\n"
+  );
+}
+
 TEST_F(WriteAheadLogTest, ThrowsWhenUnableToOpenFileAndFileExists) {
   std::ofstream wal_file{wal_->path()};
   ASSERT_TRUE(wal_file.is_open());
@@ -0,0 +1,70 @@
+#include <vkdb/database.h>
+#include <vkdb/importer.h>
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+namespace {
+void usage() {
+  std::cerr << "\033[1;32mUsage: vkdb_import <database> <table> "
+    "[--format line|csv] [--chunk <entries>] [--threads <count>] "
+    "[<file>]\033[0m\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    usage();
+    return 64;
+  }
+
+  vkdb::ImportOptions options;
+  std::optional<std::filesystem::path> path;
+  try {
+    for (int i{3}; i < argc; ++i) {
+      const std::string_view arg{argv[i]};
+      if (!arg.starts_with("--")) {
+        if (path.has_value()) {
+          usage();
+          return 64;
+        }
+        path = arg;
+        continue;
+      }
+      if (i + 1 == argc) {
+        usage();
+        return 64;
+      }
+      const std::string_view value{argv[++i]};
+      if (arg == "--format" && value == "line") {
+        options.format = vkdb::ImportFormat::LINE_PROTOCOL;
+      } else if (arg == "--format" && value == "csv") {
+        options.format = vkdb::ImportFormat::CSV;
+      } else if (arg == "--chunk") {
+        options.chunk_entries = std::stoull(std::string{value});
+      } else if (arg == "--threads") {
+        options.sort_threads = std::stoull(std::string{value});
+      } else {
+        usage();
+        return 64;
+      }
+    }
+  } catch (const std::exception&) {
+    usage();
+    return 64;
+  }
+
+  try {
+    vkdb::Database database{argv[1]};
+    vkdb::Importer importer{database.getTable(argv[2]), options};
+    const auto stats{
+      path.has_value() ? importer.runFile(path.value()) : importer.run(std::cin)
+    };
+    std::cout << "\033[1;31mImported " << stats.entries << " entries from "
+      << stats.lines << " lines into '" << argv[2] << "'.\033[0m\n";
+  } catch (const std::exception& e) {
+    std::cerr << "\033[1;32m" << e.what() << "\033[0m\n";
+    return 65;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <vkdb/database.h>
+#include <vkdb/server.h>
+#include <vkdb/follower.h>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace {
+void usage() {
+  std::cerr << "\033[1;32mUsage: vkdb_server <database> [--host <address>] "
+    "[--port <port>] [--threads <count>] [--follow <host>:<port> "
+    "--tables <table>[,<table>...] [--name <follower>]]\033[0m\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc % 2 != 0) {
+    usage();
+    return 64;
+  }
+
+  vkdb::ServerOptions options;
+  std::optional<vkdb::FollowerOptions> follower_options;
+  const auto follow{[&follower_options]() -> vkdb::FollowerOptions& {
+    if (!follower_options) {
+      follower_options.emplace();
+    }
+    return *follower_options;
+  }};
+  try {
+    for (int i{2}; i < argc; i += 2) {
+      const std::string_view flag{argv[i]};
+      const std::string value{argv[i + 1]};
+      if (flag == "--host") {
+        options.host = value;
+      } else if (flag == "--port") {
+        options.port = static_cast<uint16_t>(std::stoul(value));
+      } else if (flag == "--threads") {
+        options.worker_threads = std::stoull(value);
+      } else if (flag == "--follow") {
+        const auto colon{value.rfind(':')};
+        if (colon == std::string::npos) {
+          usage();
+          return 64;
+        }
+        follow().host = value.substr(0, colon);
+        follow().port = static_cast<uint16_t>(
+          std::stoul(value.substr(colon + 1))
+        );
+      } else if (flag == "--tables") {
+        for (std::string_view tables{value}; !tables.empty();) {
+          const auto comma{tables.find(',')};
+          follow().tables.emplace_back(tables.substr(0, comma));
+          tables = comma == std::string_view::npos
+            ? std::string_view{}
+            : tables.substr(comma + 1);
+        }
+      } else if (flag == "--name") {
+        follow().name = value;
+      } else {
+        usage();
+        return 64;
+      }
+    }
+  } catch (const std::exception&) {
+    usage();
+    return 64;
+  }
+
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  try {
+    vkdb::Database database{argv[1]};
+    std::unique_ptr<vkdb::Follower> follower;
+    if (follower_options) {
+      follower = std::make_unique<vkdb::Follower>(
+        database,
+        std::move(*follower_options)
+      );
+      follower->poll();
+      follower->start();
+    }
+    vkdb::Server server{database, options};
+    server.start();
+    std::cout << "\033[1;31mvkdb_server on database '" << argv[1]
+      << "' listening on " << options.host << ":" << server.port()
+      << "\033[0m\n";
+
+    int signal;
+    sigwait(&signals, &signal);
+    server.stop();
+    if (follower) {
+      follower->stop();
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "\033[1;32m" << e.what() << "\033[0m\n";
+    return 70;
+  }
+  return 0;
+}